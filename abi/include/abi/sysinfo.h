@@ -68,6 +68,9 @@ typedef struct {
 	uint16_t frequency_mhz;  /**< Frequency in MHz */
 	uint64_t idle_cycles;    /**< Number of idle cycles */
 	uint64_t busy_cycles;    /**< Number of busy cycles */
+	uint64_t steals;         /**< Number of threads stolen by the CPU */
+	uint64_t migrations;     /**< Number of threads migrated to the CPU */
+	uint64_t handoffs;       /**< Number of direct handoffs to the CPU */
 } stats_cpu_t;
 
 /** Physical memory statistics
@@ -53,6 +53,7 @@
 #define CR0_MP		(1 << 1)
 #define CR0_EM		(1 << 2)
 #define CR0_TS		(1 << 3)
+#define CR0_WP		(1 << 16)
 #define CR0_AM		(1 << 18)
 #define CR0_PG		(1 << 31)
 
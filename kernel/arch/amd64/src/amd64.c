@@ -113,6 +113,8 @@ void amd64_pre_mm_init(void)
 	write_rflags(read_rflags() & ~(RFLAGS_IOPL | RFLAGS_NT));
 	/* Disable alignment check */
 	write_cr0(read_cr0() & ~CR0_AM);
+	/* Make kernel writes honour read-only user mappings */
+	write_cr0(read_cr0() | CR0_WP);
 
 	if (config.cpu_active == 1) {
 		interrupt_init();
@@ -110,6 +110,9 @@ typedef union {
 /** User mode: read/write, privileged mode: read/write. */
 #define PTE_AP_USER_RW_KERNEL_RW	3
 
+/** Pages read-only for user mode remain writable in privileged mode. */
+#define PAGE_USER_RO_KERNEL_RW
+
 
 /* pte_level0_t and pte_level1_t descriptor_type flags */
 
@@ -44,6 +44,7 @@
 
 #define CR0_PE		(1 << 0)
 #define CR0_TS		(1 << 3)
+#define CR0_WP		(1 << 16)
 #define CR0_AM		(1 << 18)
 #define CR0_NW		(1 << 29)
 #define CR0_CD		(1 << 30)
@@ -307,6 +307,9 @@ void pm_init(void)
 
 	/* Disable alignment check */
 	write_cr0(read_cr0() & ~CR0_AM);
+
+	/* Make kernel writes honour read-only user mappings */
+	write_cr0(read_cr0() | CR0_WP);
 }
 
 /** @}
@@ -121,5 +121,27 @@ void ipi_broadcast_arch(int ipi)
 	ipi_brodcast_to(func, ipi_cpu_list[CPU->arch.id], idx);
 }
 
+/*
+ * Deliver IPI to one processor.
+ *
+ * We assume that interrupts are disabled.
+ *
+ * @param cpu_id Destination cpu id (index into cpus array). Must not
+ *               be the current cpu.
+ * @param ipi    IPI number.
+ */
+void ipi_unicast_arch(unsigned int cpu_id, int ipi)
+{
+	switch (ipi) {
+	case IPI_TLB_SHOOTDOWN:
+		ipi_unicast_to(tlb_shootdown_ipi_recv,
+		    (uint16_t) cpus[cpu_id].id);
+		break;
+	default:
+		panic("Unknown IPI (%d).\n", ipi);
+		break;
+	}
+}
+
 /** @}
  */
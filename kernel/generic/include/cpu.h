@@ -36,8 +36,10 @@
 #define KERN_CPU_H_
 
 #include <mm/tlb.h>
+#include <mm/frame_types.h>
 #include <synch/spinlock.h>
 #include <synch/rcu_types.h>
+#include <time/timeout_types.h>
 #include <proc/scheduler.h>
 #include <arch/cpu.h>
 #include <arch/context.h>
@@ -60,11 +62,39 @@ typedef struct cpu {
 	context_t saved_context;
 
 	atomic_t nrdy;
+
+	/** Lock protecting the run queues and rq_map. */
+	IRQ_SPINLOCK_DECLARE(rq_lock);
 	runq_t rq[RQ_COUNT];
+
+	/** Bitmap of non-empty run queues (bit i stands for rq[i]). */
+	uint32_t rq_map;
+
 	volatile size_t needs_relink;
 
+	/**
+	 * Number of threads this CPU stole from the run queues of other
+	 * CPUs when it ran out of ready threads.
+	 */
+	atomic_t steals;
+
+	/**
+	 * Number of threads the load balancer of this CPU migrated
+	 * from other CPUs.
+	 */
+	atomic_t migrations;
+
+	/**
+	 * Number of threads handed this CPU over directly by a waking
+	 * thread, see thread_ready_handoff(). Protected by rq_lock.
+	 */
+	uint64_t handoffs;
+
 	IRQ_SPINLOCK_DECLARE(timeoutlock);
-	list_t timeout_active_list;
+	timeout_wheel_t timeout_wheel;
+
+	/** Cache of single frames, see frame_alloc_generic(). */
+	frame_cache_t frame_cache;
 
 	/**
 	 * When system clock loses a tick, it is
@@ -82,6 +82,12 @@
 /** The page fault was not resolved by as_page_fault(). Non-verbose version. */
 #define AS_PF_SILENT 3
 
+/** Default number of pages in the fault-around window. */
+#define AS_FAULT_AROUND_DEFAULT  16
+
+/** Maximum number of pages in the fault-around window. */
+#define AS_FAULT_AROUND_MAX  256
+
 /** Address space structure.
  *
  * as_t contains the list of as_areas of userspace accessible
@@ -101,6 +107,16 @@ typedef struct as {
 	 */
 	size_t cpu_refcount;
 
+	/**
+	 * Processors on which this address space is installed, processors
+	 * which have installed it and processors which must invalidate its
+	 * ASID before installing it again. NULL for the kernel address
+	 * space. Protected by asidlock.
+	 */
+	struct cpu_mask *cpus_active;
+	struct cpu_mask *cpus_used;
+	struct cpu_mask *cpus_stale;
+
 	/** Address space identifier.
 	 *
 	 * Constant on architectures that do not
@@ -117,6 +133,9 @@ typedef struct as {
 	/** B+tree of address space areas. */
 	btree_t as_area_btree;
 
+	/** Number of page faults resolved by backends. Protected by lock. */
+	size_t page_faults;
+
 	/** Non-generic content. */
 	as_genarch_t genarch;
 
@@ -253,6 +272,8 @@ typedef struct mem_backend {
 
 extern as_t *AS_KERNEL;
 
+extern size_t as_fault_around;
+
 extern as_operations_t *as_operations;
 extern list_t inactive_as_with_asid_list;
 
@@ -275,6 +296,7 @@ extern errno_t as_area_change_flags(as_t *, unsigned int, uintptr_t);
 
 extern unsigned int as_area_get_flags(as_area_t *);
 extern bool as_area_check_access(as_area_t *, pf_access_t);
+extern size_t as_area_fault_around(as_area_t *, uintptr_t, uintptr_t *);
 extern size_t as_area_get_size(uintptr_t);
 extern bool used_space_insert(as_area_t *, uintptr_t, size_t);
 extern bool used_space_remove(as_area_t *, uintptr_t, size_t);
@@ -303,6 +325,10 @@ extern void as_deinstall_arch(as_t *);
 
 /* Backend declarations and functions. */
 extern mem_backend_t anon_backend;
+
+extern void anon_init(void);
+extern bool anon_frame_is_zero(uintptr_t);
+
 extern mem_backend_t elf_backend;
 extern mem_backend_t phys_backend;
 extern mem_backend_t user_backend;
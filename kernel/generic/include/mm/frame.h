@@ -43,6 +43,7 @@
 #include <synch/spinlock.h>
 #include <arch/mm/page.h>
 #include <arch/mm/frame.h>
+#include <mm/frame_types.h>
 
 /** Maximum number of zones in the system. */
 #define ZONES_MAX  32
@@ -139,6 +140,10 @@ extern void frame_free_noreserve(uintptr_t, size_t);
 extern void frame_reference_add(pfn_t);
 extern size_t frame_total_free_get(void);
 
+extern void frame_cache_initialize(frame_cache_t *);
+extern size_t frame_cache_reclaim(void);
+extern void frame_stats_init(void);
+
 extern size_t find_zone(pfn_t, size_t, size_t);
 extern size_t zone_create(pfn_t, size_t, pfn_t, zone_flags_t);
 extern void *frame_get_parent(pfn_t, size_t);
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup genericmm
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_FRAME_TYPES_H_
+#define KERN_FRAME_TYPES_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <synch/spinlock.h>
+#include <typedefs.h>
+
+/** Maximum number of frames in each list of a per-CPU frame cache */
+#define FRAME_CACHE_MAX  256
+
+/** Per-CPU cache of single frames.
+ *
+ * Frames in the cache stay allocated in their zones, so that single
+ * frames can be allocated and freed without touching the zones. The
+ * cache is refilled from and drained to the zones in batches.
+ */
+typedef struct {
+	IRQ_SPINLOCK_DECLARE(lock);
+
+	/** Number of frames the cache holds at most (high watermark). */
+	size_t high;
+	/** Number of frames taken from the zones at once. */
+	size_t batch;
+	/** Preferred zone for refills. */
+	size_t zone;
+
+	/** Number of free frames ready for allocation. */
+	size_t avail_count;
+	/** Free frames ready for allocation. */
+	pfn_t avail[FRAME_CACHE_MAX];
+
+	/** Number of freed frames not yet returned to their zones. */
+	size_t freed_count;
+	/** Frames freed but not yet returned to their zones. */
+	pfn_t freed[FRAME_CACHE_MAX];
+	/** Whether the freed frame was not reserved. */
+	bool freed_noreserve[FRAME_CACHE_MAX];
+
+	/** Number of frames allocated from the cache. */
+	uint64_t hits;
+	/** Number of batches taken from the zones. */
+	uint64_t refills;
+	/** Number of batches of freed frames returned to the zones. */
+	uint64_t drains;
+} frame_cache_t;
+
+#endif
+
+/** @}
+ */
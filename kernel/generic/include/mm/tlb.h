@@ -44,6 +44,12 @@
  */
 #define TLB_MESSAGE_QUEUE_LEN	10
 
+/**
+ * Number of page ranges that can be invalidated in one shootdown round.
+ * Further ranges are merged with the last one.
+ */
+#define TLB_SHOOTDOWN_BATCH_LEN	8
+
 /** Type of TLB shootdown message. */
 typedef enum {
 	/** Invalid type. */
@@ -64,16 +70,38 @@ typedef struct {
 	size_t count;			/**< Number of pages to invalidate. */
 } tlb_shootdown_msg_t;
 
+/** Page ranges of one address space invalidated in one shootdown round. */
+typedef struct {
+	/** Number of valid entries in ranges. */
+	size_t count;
+	struct {
+		uintptr_t page;	/**< Address of the first page. */
+		size_t count;	/**< Number of pages. */
+	} ranges[TLB_SHOOTDOWN_BATCH_LEN];
+} tlb_shootdown_batch_t;
+
+struct as;
+
 extern void tlb_init(void);
+extern void tlb_stats_init(void);
+
+extern void tlb_shootdown_batch_init(tlb_shootdown_batch_t *);
+extern void tlb_shootdown_batch_add(tlb_shootdown_batch_t *, uintptr_t,
+    size_t);
+extern void tlb_shootdown_batch_invalidate(asid_t, tlb_shootdown_batch_t *);
 
 #ifdef CONFIG_SMP
 extern ipl_t tlb_shootdown_start(tlb_invalidate_type_t, asid_t, uintptr_t,
     size_t);
 extern void tlb_shootdown_finalize(ipl_t);
+extern ipl_t tlb_shootdown_start_batch(struct as *, tlb_shootdown_batch_t *);
+extern void tlb_shootdown_finalize_batch(ipl_t);
 extern void tlb_shootdown_ipi_recv(void);
 #else
 #define tlb_shootdown_start(w, x, y, z)	interrupts_disable()
 #define tlb_shootdown_finalize(i)	(interrupts_restore(i));
+#define tlb_shootdown_start_batch(as, b)	interrupts_disable()
+#define tlb_shootdown_finalize_batch(i)	(interrupts_restore(i));
 #define tlb_shootdown_ipi_recv()
 #endif /* CONFIG_SMP */
 
@@ -44,9 +44,12 @@
 #define RQ_COUNT          16
 #define NEEDS_RELINK_MAX  (HZ)
 
-/** Scheduler run queue structure. */
+/** Scheduler run queue structure.
+ *
+ * The run queues of a CPU are protected by the rq_lock of the CPU.
+ *
+ */
 typedef struct {
-	IRQ_SPINLOCK_DECLARE(lock);
 	list_t rq;			/**< List of ready threads. */
 	size_t n;			/**< Number of threads in rq_ready. */
 } runq_t;
@@ -180,6 +180,8 @@ typedef struct thread {
 
 	/** Ticks before preemption. */
 	uint64_t ticks;
+	/** Ticks handed over by the thread which woke this thread up. */
+	uint64_t handoff_ticks;
 
 	/** Thread accounting. */
 	uint64_t ucycles;
@@ -241,6 +243,7 @@ extern thread_t *thread_create(void (*)(void *), void *, task_t *,
 extern void thread_wire(thread_t *, cpu_t *);
 extern void thread_attach(thread_t *, task_t *);
 extern void thread_ready(thread_t *);
+extern void thread_ready_handoff(thread_t *);
 extern void thread_exit(void) __attribute__((noreturn));
 extern void thread_interrupt(thread_t *);
 extern bool thread_interrupted(thread_t *);
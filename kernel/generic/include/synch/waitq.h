@@ -42,7 +42,9 @@
 
 typedef enum {
 	WAKEUP_FIRST = 0,
-	WAKEUP_ALL
+	WAKEUP_ALL,
+	/** Wake up the first thread and hand the current CPU over to it. */
+	WAKEUP_HANDOFF
 } wakeup_mode_t;
 
 /** Wait queue structure.
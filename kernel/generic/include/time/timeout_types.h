@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup time
+ * @{
+ */
+/** @file
+ */
+
+#ifndef KERN_TIMEOUT_TYPES_H_
+#define KERN_TIMEOUT_TYPES_H_
+
+#include <adt/list.h>
+#include <stdint.h>
+
+/** Number of bits of the clock tick resolved by one wheel level */
+#define TIMEOUT_WHEEL_BITS    6
+#define TIMEOUT_WHEEL_SLOTS   (1 << TIMEOUT_WHEEL_BITS)
+#define TIMEOUT_WHEEL_MASK    (TIMEOUT_WHEEL_SLOTS - 1)
+#define TIMEOUT_WHEEL_LEVELS  4
+
+/** Number of clock ticks covered by the whole wheel */
+#define TIMEOUT_WHEEL_RANGE \
+	(UINT64_C(1) << (TIMEOUT_WHEEL_BITS * TIMEOUT_WHEEL_LEVELS))
+
+/** Hierarchical timing wheel of active timeouts.
+ *
+ * Slot i of level l holds the timeouts expiring in the i-th span of
+ * TIMEOUT_WHEEL_SLOTS^l ticks (modulo the size of the level). Whenever
+ * the clock reaches the beginning of such a span, the slot is cascaded
+ * to the lower levels, so that level 0 always contains the timeouts
+ * expiring within the next TIMEOUT_WHEEL_SLOTS ticks, one tick per slot.
+ */
+typedef struct {
+	/** Clock tick which is going to be processed next. */
+	uint64_t now;
+	/** Number of active timeouts. */
+	size_t count;
+	/** Lists of timeouts of each slot of each level. */
+	list_t slot[TIMEOUT_WHEEL_LEVELS][TIMEOUT_WHEEL_SLOTS];
+} timeout_wheel_t;
+
+#endif
+
+/** @}
+ */
@@ -82,11 +82,12 @@ void cpu_init(void)
 			cpus[i].id = i;
 
 			irq_spinlock_initialize(&cpus[i].lock, "cpus[].lock");
+			irq_spinlock_initialize(&cpus[i].rq_lock, "cpus[].rq_lock");
 
-			for (unsigned int j = 0; j < RQ_COUNT; j++) {
-				irq_spinlock_initialize(&cpus[i].rq[j].lock, "cpus[].rq[].lock");
+			for (unsigned int j = 0; j < RQ_COUNT; j++)
 				list_initialize(&cpus[i].rq[j].rq);
-			}
+
+			frame_cache_initialize(&cpus[i].frame_cache);
 		}
 
 #ifdef CONFIG_SMP
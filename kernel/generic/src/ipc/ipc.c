@@ -60,6 +60,7 @@
 #include <arch/interrupt.h>
 #include <ipc/irq.h>
 #include <cap/cap.h>
+#include <cpu.h>
 
 static void ipc_forget_call(call_t *);
 
@@ -207,6 +208,28 @@ void ipc_phone_init(phone_t *phone, task_t *caller)
 	phone->kobject = NULL;
 }
 
+/** Choose how to wake up a thread waiting for a call or an answer.
+ *
+ * The current thread usually waits for the answer right after sending a
+ * call and the server usually waits for another call right after sending
+ * an answer. If the current CPU has nothing else to run, the woken up
+ * thread is therefore handed the CPU directly instead of being readied on
+ * the CPU it last ran on, which might be idle until its next clock tick.
+ * The woken up thread also takes over the rest of the timeslice of the
+ * current thread, so that it does not wait for more than a clock tick
+ * should the current thread keep running instead of blocking.
+ *
+ * @return Wakeup mode to use.
+ *
+ */
+static wakeup_mode_t ipc_wakeup_mode(void)
+{
+	if ((THREAD != NULL) && (atomic_get(&CPU->nrdy) == 0))
+		return WAKEUP_HANDOFF;
+
+	return WAKEUP_FIRST;
+}
+
 /** Helper function to facilitate synchronous calls.
  *
  * @param phone   Destination kernel phone structure.
@@ -326,7 +349,7 @@ void _ipc_answer_free_call(call_t *call, bool selflocked)
 	if (do_lock)
 		irq_spinlock_unlock(&callerbox->lock, true);
 
-	waitq_wakeup(&callerbox->wq, WAKEUP_FIRST);
+	waitq_wakeup(&callerbox->wq, ipc_wakeup_mode());
 }
 
 /** Answer a message which is in a callee queue.
@@ -416,7 +439,7 @@ static void _ipc_call(phone_t *phone, answerbox_t *box, call_t *call,
 	list_append(&call->ab_link, &box->calls);
 	irq_spinlock_unlock(&box->lock, true);
 
-	waitq_wakeup(&box->wq, WAKEUP_FIRST);
+	waitq_wakeup(&box->wq, ipc_wakeup_mode());
 }
 
 /** Send an asynchronous request using a phone to an answerbox.
@@ -299,6 +299,8 @@ void main_bsp_separated_stack(void)
 	kio_init();
 	log_init();
 	stats_init();
+	tlb_stats_init();
+	frame_stats_init();
 
 	/*
 	 * Create kernel task.
@@ -52,6 +52,7 @@
 #include <mm/frame.h>
 #include <mm/slab.h>
 #include <mm/tlb.h>
+#include <cpu/cpu_mask.h>
 #include <arch/mm/page.h>
 #include <genarch/mm/page_pt.h>
 #include <genarch/mm/page_ht.h>
@@ -79,6 +80,8 @@
 #include <syscall/copy.h>
 #include <arch/interrupt.h>
 #include <interrupt.h>
+#include <str.h>
+#include <sysinfo/sysinfo.h>
 
 /**
  * Each architecture decides what functions will be used to carry out
@@ -110,6 +113,16 @@ LIST_INITIALIZE(inactive_as_with_asid_list);
 /** Kernel address space. */
 as_t *AS_KERNEL = NULL;
 
+/**
+ * Number of pages in the fault-around window. The backends may map the
+ * pages of the window surrounding the faulting page in advance, zero
+ * disables this. Set by the fault_around=<pages> boot argument.
+ */
+size_t as_fault_around = AS_FAULT_AROUND_DEFAULT;
+
+/** Boot argument setting the fault-around window. */
+#define FAULT_AROUND_ARG  "fault_around="
+
 NO_TRACE static errno_t as_constructor(void *obj, unsigned int flags)
 {
 	as_t *as = (as_t *) obj;
@@ -125,6 +138,38 @@ NO_TRACE static size_t as_destructor(void *obj)
 	return as_destructor_arch((as_t *) obj);
 }
 
+/** Set the fault-around window from the boot arguments.
+ *
+ * The window is published in sysinfo as mm.fault_around.
+ */
+static void as_fault_around_init(void)
+{
+	size_t len = str_length(FAULT_AROUND_ARG);
+	const char *arg = bargs;
+
+	while (arg != NULL) {
+		if (str_lcmp(arg, FAULT_AROUND_ARG, len) == 0) {
+			char *end;
+			uint64_t pages;
+			errno_t rc = str_uint64_t(arg + len, &end, 10, false,
+			    &pages);
+			if ((rc == EOK) && ((*end == 0) || (*end == ' '))) {
+				as_fault_around = min(pages,
+				    (uint64_t) AS_FAULT_AROUND_MAX);
+			} else {
+				printf("Invalid boot argument %s\n",
+				    FAULT_AROUND_ARG);
+			}
+		}
+
+		arg = str_chr(arg, ' ');
+		if (arg != NULL)
+			arg++;
+	}
+
+	sysinfo_set_item_val("mm.fault_around", NULL, as_fault_around);
+}
+
 /** Initialize address space subsystem. */
 void as_init(void)
 {
@@ -142,6 +187,9 @@ void as_init(void)
 	 * reference count never drops to zero.
 	 */
 	as_hold(AS_KERNEL);
+
+	anon_init();
+	as_fault_around_init();
 }
 
 /** Create address space.
@@ -164,6 +212,27 @@ as_t *as_create(unsigned int flags)
 
 	atomic_set(&as->refcount, 0);
 	as->cpu_refcount = 0;
+	as->page_faults = 0;
+
+	/*
+	 * Without the CPU masks, TLB shootdowns of the address space
+	 * are delivered to all processors.
+	 */
+	as->cpus_active = NULL;
+	as->cpus_used = NULL;
+	as->cpus_stale = NULL;
+	if (!(flags & FLAG_AS_KERNEL)) {
+		size_t size = cpu_mask_size();
+		uint8_t *masks = malloc(3 * size);
+		if (masks) {
+			as->cpus_active = (cpu_mask_t *) masks;
+			as->cpus_used = (cpu_mask_t *) (masks + size);
+			as->cpus_stale = (cpu_mask_t *) (masks + 2 * size);
+			cpu_mask_none(as->cpus_active);
+			cpu_mask_none(as->cpus_used);
+			cpu_mask_none(as->cpus_stale);
+		}
+	}
 
 #ifdef AS_PAGE_TABLE
 	as->genarch.page_table = page_table_create(flags);
@@ -253,6 +322,9 @@ retry:
 	page_table_destroy(NULL);
 #endif
 
+	/* The masks are allocated in one block. */
+	free(as->cpus_active);
+
 	slab_free(as_cache, as);
 }
 
@@ -829,13 +901,81 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 		page_table_lock(as, false);
 
 		/*
-		 * Remove frames belonging to used space starting from
-		 * the highest addresses downwards until an overlap with
-		 * the resized address space area is found. Note that this
-		 * is also the right way to remove part of the used_space
-		 * B+tree leaf list.
+		 * Unmap the pages beyond the new end of the area and free
+		 * their frames in one TLB shootdown round. The used_space
+		 * B+tree is only read here. Its update may use a blocking
+		 * memory allocation and blocking while holding the tlblock
+		 * spinlock is forbidden, so it is done after the sequence.
 		 */
+		tlb_shootdown_batch_t batch;
+		tlb_shootdown_batch_init(&batch);
+		tlb_shootdown_batch_add(&batch, start_free,
+		    area->pages - pages);
+
+		ipl_t ipl = tlb_shootdown_start_batch(as, &batch);
+
 		bool cond = true;
+		list_foreach_rev(area->used_space.leaf_list, leaf_link,
+		    btree_node_t, node) {
+			for (btree_key_t k = node->keys; cond && (k > 0); k--) {
+				uintptr_t ptr = node->key[k - 1];
+				size_t node_size = (size_t) node->value[k - 1];
+
+				if (ptr + P2SZ(node_size) <= start_free) {
+					cond = false;
+					break;
+				}
+
+				size_t i = (ptr < start_free) ?
+				    (start_free - ptr) >> PAGE_WIDTH : 0;
+
+				for (; i < node_size; i++) {
+					pte_t pte;
+					bool found = page_mapping_find(as,
+					    ptr + P2SZ(i), false, &pte);
+
+					assert(found);
+					assert(PTE_VALID(&pte));
+					assert(PTE_PRESENT(&pte));
+
+					if ((area->backend) &&
+					    (area->backend->frame_free)) {
+						area->backend->frame_free(area,
+						    ptr + P2SZ(i),
+						    PTE_GET_FRAME(&pte));
+					}
+
+					page_mapping_remove(as, ptr + P2SZ(i));
+				}
+			}
+
+			if (!cond)
+				break;
+		}
+
+		/*
+		 * Finish TLB shootdown sequence.
+		 */
+
+		tlb_shootdown_batch_invalidate(as->asid, &batch);
+
+		/*
+		 * Invalidate software translation caches
+		 * (e.g. TSB on sparc64, PHT on ppc32).
+		 */
+		as_invalidate_translation_cache(as, start_free,
+		    area->pages - pages);
+		tlb_shootdown_finalize_batch(ipl);
+
+		page_table_unlock(as, false);
+
+		/*
+		 * Remove the unmapped used space starting from the highest
+		 * addresses downwards until an overlap with the resized
+		 * address space area is found. Note that this is also the
+		 * right way to remove part of the used_space B+tree leaf list.
+		 */
+		cond = true;
 		while (cond) {
 			assert(!list_empty(&area->used_space.leaf_list));
 
@@ -847,7 +987,6 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 				uintptr_t ptr = node->key[node->keys - 1];
 				size_t node_size =
 				    (size_t) node->value[node->keys - 1];
-				size_t i = 0;
 
 				if (overlaps(ptr, P2SZ(node_size), area->base,
 				    P2SZ(pages))) {
@@ -869,7 +1008,8 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 
 					/* We are almost done */
 					cond = false;
-					i = (start_free - ptr) >> PAGE_WIDTH;
+					size_t i =
+					    (start_free - ptr) >> PAGE_WIDTH;
 					if (!used_space_remove(area, start_free,
 					    node_size - i))
 						panic("Cannot remove used space.");
@@ -881,61 +1021,8 @@ errno_t as_area_resize(as_t *as, uintptr_t address, size_t size, unsigned int fl
 					if (!used_space_remove(area, ptr, node_size))
 						panic("Cannot remove used space.");
 				}
-
-				/*
-				 * Start TLB shootdown sequence.
-				 *
-				 * The sequence is rather short and can be
-				 * repeated multiple times. The reason is that
-				 * we don't want to have used_space_remove()
-				 * inside the sequence as it may use a blocking
-				 * memory allocation for its B+tree. Blocking
-				 * while holding the tlblock spinlock is
-				 * forbidden and would hit a kernel assertion.
-				 */
-
-				ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES,
-				    as->asid, area->base + P2SZ(pages),
-				    area->pages - pages);
-
-				for (; i < node_size; i++) {
-					pte_t pte;
-					bool found = page_mapping_find(as,
-					    ptr + P2SZ(i), false, &pte);
-
-					assert(found);
-					assert(PTE_VALID(&pte));
-					assert(PTE_PRESENT(&pte));
-
-					if ((area->backend) &&
-					    (area->backend->frame_free)) {
-						area->backend->frame_free(area,
-						    ptr + P2SZ(i),
-						    PTE_GET_FRAME(&pte));
-					}
-
-					page_mapping_remove(as, ptr + P2SZ(i));
-				}
-
-				/*
-				 * Finish TLB shootdown sequence.
-				 */
-
-				tlb_invalidate_pages(as->asid,
-				    area->base + P2SZ(pages),
-				    area->pages - pages);
-
-				/*
-				 * Invalidate software translation caches
-				 * (e.g. TSB on sparc64, PHT on ppc32).
-				 */
-				as_invalidate_translation_cache(as,
-				    area->base + P2SZ(pages),
-				    area->pages - pages);
-				tlb_shootdown_finalize(ipl);
 			}
 		}
-		page_table_unlock(as, false);
 	} else {
 		/*
 		 * Growing the area.
@@ -999,8 +1086,11 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	/*
 	 * Start TLB shootdown sequence.
 	 */
-	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as->asid, area->base,
-	    area->pages);
+	tlb_shootdown_batch_t batch;
+	tlb_shootdown_batch_init(&batch);
+	tlb_shootdown_batch_add(&batch, area->base, area->pages);
+
+	ipl_t ipl = tlb_shootdown_start_batch(as, &batch);
 
 	/*
 	 * Visit only the pages mapped by used_space B+tree.
@@ -1038,14 +1128,14 @@ errno_t as_area_destroy(as_t *as, uintptr_t address)
 	 * Finish TLB shootdown sequence.
 	 */
 
-	tlb_invalidate_pages(as->asid, area->base, area->pages);
+	tlb_shootdown_batch_invalidate(as->asid, &batch);
 
 	/*
 	 * Invalidate potential software translation caches
 	 * (e.g. TSB on sparc64, PHT on ppc32).
 	 */
 	as_invalidate_translation_cache(as, area->base, area->pages);
-	tlb_shootdown_finalize(ipl);
+	tlb_shootdown_finalize_batch(ipl);
 
 	page_table_unlock(as, false);
 
@@ -1218,6 +1308,37 @@ NO_TRACE bool as_area_check_access(as_area_t *area, pf_access_t access)
 	return true;
 }
 
+/** Compute the fault-around window of a page.
+ *
+ * The window is aligned to its size and clipped to the address space area.
+ *
+ * @param area  Address space area.
+ * @param page  Faulting page.
+ * @param start Place to store the first page of the window.
+ *
+ * @return Number of pages in the window or zero if fault-around is
+ *         disabled.
+ *
+ */
+NO_TRACE size_t as_area_fault_around(as_area_t *area, uintptr_t page,
+    uintptr_t *start)
+{
+	assert(mutex_locked(&area->lock));
+
+	size_t window = as_fault_around;
+	if (window <= 1)
+		return 0;
+
+	/* Work with page numbers to avoid overflow at the top of memory. */
+	uintptr_t pfn = page >> PAGE_WIDTH;
+	uintptr_t first = max(pfn - pfn % window, area->base >> PAGE_WIDTH);
+	uintptr_t last = min(pfn - pfn % window + window,
+	    (area->base >> PAGE_WIDTH) + area->pages);
+
+	*start = P2SZ(first);
+	return last - first;
+}
+
 /** Convert address space area flags to page flags.
  *
  * @param aflags Flags of some address space area.
@@ -1314,8 +1435,11 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	/*
 	 * Start TLB shootdown sequence.
 	 */
-	ipl_t ipl = tlb_shootdown_start(TLB_INVL_PAGES, as->asid, area->base,
-	    area->pages);
+	tlb_shootdown_batch_t batch;
+	tlb_shootdown_batch_init(&batch);
+	tlb_shootdown_batch_add(&batch, area->base, area->pages);
+
+	ipl_t ipl = tlb_shootdown_start_batch(as, &batch);
 
 	/*
 	 * Remove used pages from page tables and remember their frame
@@ -1352,14 +1476,14 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 	 * Finish TLB shootdown sequence.
 	 */
 
-	tlb_invalidate_pages(as->asid, area->base, area->pages);
+	tlb_shootdown_batch_invalidate(as->asid, &batch);
 
 	/*
 	 * Invalidate potential software translation caches
 	 * (e.g. TSB on sparc64, PHT on ppc32).
 	 */
 	as_invalidate_translation_cache(as, area->base, area->pages);
-	tlb_shootdown_finalize(ipl);
+	tlb_shootdown_finalize_batch(ipl);
 
 	page_table_unlock(as, false);
 
@@ -1386,9 +1510,14 @@ errno_t as_area_change_flags(as_t *as, unsigned int flags, uintptr_t address)
 			for (size = 0; size < (size_t) node->value[i]; size++) {
 				page_table_lock(as, false);
 
-				/* Insert the new mapping */
+				/*
+				 * Insert the new mapping. The shared zero
+				 * page must stay read-only.
+				 */
+				uintptr_t frame = old_frame[frame_idx++];
 				page_mapping_insert(as, ptr + P2SZ(size),
-				    old_frame[frame_idx++], page_flags);
+				    frame, anon_frame_is_zero(frame) ?
+				    (page_flags & ~PAGE_WRITE) : page_flags);
 
 				page_table_unlock(as, false);
 			}
@@ -1494,6 +1623,8 @@ int as_page_fault(uintptr_t address, pf_access_t access, istate_t *istate)
 		goto page_fault;
 	}
 
+	AS->page_faults++;
+
 	page_table_unlock(AS, false);
 	mutex_unlock(&area->lock);
 	mutex_unlock(&AS->lock);
@@ -1571,6 +1702,9 @@ retry:
 			    &inactive_as_with_asid_list);
 		}
 
+		if (old_as->cpus_active)
+			cpu_mask_reset(old_as->cpus_active, CPU->id);
+
 		/*
 		 * Perform architecture-specific tasks when the address space
 		 * is being removed from the CPU.
@@ -1588,6 +1722,20 @@ retry:
 			new_as->asid = asid_get();
 	}
 
+	if (new_as->cpus_active) {
+		/*
+		 * Complete a TLB shootdown which was deferred while
+		 * this processor was not running the address space.
+		 */
+		if (cpu_mask_is_set(new_as->cpus_stale, CPU->id)) {
+			cpu_mask_reset(new_as->cpus_stale, CPU->id);
+			tlb_invalidate_asid(new_as->asid);
+		}
+
+		cpu_mask_set(new_as->cpus_active, CPU->id);
+		cpu_mask_set(new_as->cpus_used, CPU->id);
+	}
+
 #ifdef AS_PAGE_TABLE
 	SET_PTL0_ADDRESS(new_as->genarch.page_table);
 #endif
@@ -45,6 +45,7 @@
 #include <mm/frame.h>
 #include <mm/slab.h>
 #include <mm/km.h>
+#include <mm/tlb.h>
 #include <synch/mutex.h>
 #include <adt/list.h>
 #include <adt/btree.h>
@@ -81,6 +82,92 @@ mem_backend_t anon_backend = {
 	.destroy_shared_data = NULL
 };
 
+/**
+ * Frame filled with zeros. It is mapped read-only to the pages of private
+ * anonymous areas which have been read but not yet written to. This relies
+ * on the kernel writes to user memory faulting on read-only mappings too.
+ */
+static uintptr_t anon_zero_frame;
+
+/*
+ * Where the kernel ignores the write protection of user pages, writes
+ * through copy_to_uspace() would end up in the shared zero frame, so
+ * each page gets a frame of its own even if it is only read.
+ */
+#ifdef PAGE_USER_RO_KERNEL_RW
+#define ANON_ZERO_FRAME  false
+#else
+#define ANON_ZERO_FRAME  true
+#endif
+
+/** Initialize the anonymous memory backend. */
+void anon_init(void)
+{
+	anon_zero_frame = frame_alloc(1, FRAME_LOWMEM | FRAME_NO_RESERVE, 0);
+	memsetb((void *) PA2KA(anon_zero_frame), FRAME_SIZE, 0);
+}
+
+/** Check whether a frame is the shared zero frame.
+ *
+ * @param frame Frame to check.
+ *
+ * @return True if @a frame is the shared zero frame.
+ */
+bool anon_frame_is_zero(uintptr_t frame)
+{
+	return frame == anon_zero_frame;
+}
+
+/** Allocate a zeroed frame.
+ *
+ * @param frame Place to store the frame.
+ * @param flags Additional frame allocation flags.
+ *
+ * @return True on success, false if FRAME_ATOMIC was specified and
+ *         there is no free frame.
+ */
+static bool anon_frame_alloc(uintptr_t *frame, frame_flags_t flags)
+{
+	uintptr_t kpage = km_temporary_page_get(frame,
+	    FRAME_NO_RESERVE | flags);
+	if (!kpage)
+		return false;
+
+	memsetb((void *) kpage, PAGE_SIZE, 0);
+	km_temporary_page_put(kpage);
+	return true;
+}
+
+/** Replace the shared zero frame mapped at a page by a private frame.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area  Address space area.
+ * @param upage Virtual page mapped to the shared zero frame.
+ * @param frame Frame to map instead.
+ */
+static void anon_zero_page_replace(as_area_t *area, uintptr_t upage,
+    uintptr_t frame)
+{
+	as_t *as = area->as;
+
+	/*
+	 * Other processors may still have the read-only translation
+	 * cached in their TLBs.
+	 */
+	tlb_shootdown_batch_t batch;
+	tlb_shootdown_batch_init(&batch);
+	tlb_shootdown_batch_add(&batch, upage, 1);
+
+	ipl_t ipl = tlb_shootdown_start_batch(as, &batch);
+	page_mapping_remove(as, upage);
+	tlb_invalidate_pages(as->asid, upage, 1);
+	as_invalidate_translation_cache(as, upage, 1);
+	tlb_shootdown_finalize_batch(ipl);
+
+	page_mapping_insert(as, upage, frame, as_area_get_flags(area));
+}
+
 bool anon_create(as_area_t *area)
 {
 	if (area->flags & AS_AREA_LATE_RESERVE)
@@ -142,13 +229,24 @@ void anon_share(as_area_t *area)
 				assert(PTE_VALID(&pte));
 				assert(PTE_PRESENT(&pte));
 
+				uintptr_t frame = PTE_GET_FRAME(&pte);
+				if (anon_frame_is_zero(frame)) {
+					/*
+					 * The page has been only read so far.
+					 * Give it its own frame as the shared
+					 * mapping may be writable.
+					 */
+					(void) anon_frame_alloc(&frame, 0);
+					anon_zero_page_replace(area,
+					    base + P2SZ(j), frame);
+				}
+
 				btree_insert(&area->sh_info->pagemap,
 				    (base + P2SZ(j)) - area->base,
-				    (void *) PTE_GET_FRAME(&pte), NULL);
+				    (void *) frame, NULL);
 				page_table_unlock(area->as, false);
 
-				pfn_t pfn = ADDR2PFN(PTE_GET_FRAME(&pte));
-				frame_reference_add(pfn);
+				frame_reference_add(ADDR2PFN(frame));
 			}
 
 		}
@@ -174,6 +272,68 @@ bool anon_is_shareable(as_area_t *area)
 	return !(area->flags & AS_AREA_LATE_RESERVE);
 }
 
+/** Map pages surrounding a faulting page in advance.
+ *
+ * In shared areas, only the pages already present in the pagemap are mapped.
+ * In private areas, the pages surrounding a page being read are mapped to the
+ * shared zero frame. The pages surrounding a page being written to get their
+ * own frames, provided that the memory for the whole area has been reserved
+ * in advance.
+ *
+ * The address space area, its share info and page tables must be already
+ * locked.
+ *
+ * @param area   Pointer to the address space area.
+ * @param upage  Faulting virtual page.
+ * @param access Access mode that caused the fault.
+ */
+static void anon_fault_around(as_area_t *area, uintptr_t upage,
+    pf_access_t access)
+{
+	bool shared = area->sh_info->shared;
+	uintptr_t page;
+	size_t count;
+
+	if (!shared && ((access == PF_ACCESS_WRITE) || !ANON_ZERO_FRAME) &&
+	    (area->flags & AS_AREA_LATE_RESERVE))
+		return;
+
+	count = as_area_fault_around(area, upage, &page);
+	for (; count > 0; count--, page += PAGE_SIZE) {
+		unsigned int flags = as_area_get_flags(area);
+		uintptr_t frame;
+		pte_t pte;
+
+		if (page == upage)
+			continue;
+
+		if (page_mapping_find(AS, page, false, &pte) &&
+		    PTE_VALID(&pte))
+			continue;
+
+		if (shared) {
+			btree_node_t *leaf;
+
+			frame = (uintptr_t) btree_search(
+			    &area->sh_info->pagemap, page - area->base, &leaf);
+			if (!frame)
+				continue;
+
+			frame_reference_add(ADDR2PFN(frame));
+		} else if (ANON_ZERO_FRAME && (access != PF_ACCESS_WRITE)) {
+			frame = anon_zero_frame;
+			flags &= ~PAGE_WRITE;
+		} else {
+			if (!anon_frame_alloc(&frame, FRAME_ATOMIC))
+				break;
+		}
+
+		page_mapping_insert(AS, page, frame, flags);
+		if (!used_space_insert(area, page, 1))
+			panic("Cannot insert used space.");
+	}
+}
+
 /** Service a page fault in the anonymous memory address space area.
  *
  * The address space area and page tables must be already locked.
@@ -187,6 +347,7 @@ bool anon_is_shareable(as_area_t *area)
  */
 int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 {
+	unsigned int flags = as_area_get_flags(area);
 	uintptr_t kpage;
 	uintptr_t frame;
 
@@ -240,6 +401,31 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		}
 		frame_reference_add(ADDR2PFN(frame));
 	} else {
+		pte_t pte;
+
+		if (page_mapping_find(AS, upage, false, &pte) &&
+		    PTE_PRESENT(&pte)) {
+			/*
+			 * The only mapping present at the time of a fault
+			 * is the read-only shared zero frame and the page
+			 * is being written to now.
+			 */
+			if (!anon_frame_is_zero(PTE_GET_FRAME(&pte))) {
+				mutex_unlock(&area->sh_info->lock);
+				return AS_PF_FAULT;
+			}
+
+			if ((area->flags & AS_AREA_LATE_RESERVE) &&
+			    (!reserve_try_alloc(1))) {
+				mutex_unlock(&area->sh_info->lock);
+				return AS_PF_SILENT;
+			}
+
+			(void) anon_frame_alloc(&frame, 0);
+			anon_zero_page_replace(area, upage, frame);
+			mutex_unlock(&area->sh_info->lock);
+			return AS_PF_OK;
+		}
 
 		/*
 		 * In general, there can be several reasons that
@@ -256,31 +442,42 @@ int anon_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 		 *   the different causes
 		 */
 
-		if (area->flags & AS_AREA_LATE_RESERVE) {
+		if (ANON_ZERO_FRAME && (access != PF_ACCESS_WRITE)) {
 			/*
-			 * Reserve the memory for this page now.
+			 * Nothing has been written to the page yet, so it can
+			 * be backed by the shared zero frame until it is.
 			 */
-			if (!reserve_try_alloc(1)) {
-				mutex_unlock(&area->sh_info->lock);
-				return AS_PF_SILENT;
+			frame = anon_zero_frame;
+			flags &= ~PAGE_WRITE;
+		} else {
+			if (area->flags & AS_AREA_LATE_RESERVE) {
+				/*
+				 * Reserve the memory for this page now.
+				 */
+				if (!reserve_try_alloc(1)) {
+					mutex_unlock(&area->sh_info->lock);
+					return AS_PF_SILENT;
+				}
 			}
-		}
 
-		kpage = km_temporary_page_get(&frame, FRAME_NO_RESERVE);
-		memsetb((void *) kpage, PAGE_SIZE, 0);
-		km_temporary_page_put(kpage);
+			kpage = km_temporary_page_get(&frame, FRAME_NO_RESERVE);
+			memsetb((void *) kpage, PAGE_SIZE, 0);
+			km_temporary_page_put(kpage);
+		}
 	}
-	mutex_unlock(&area->sh_info->lock);
 
 	/*
 	 * Map 'upage' to 'frame'.
 	 * Note that TLB shootdown is not attempted as only new information is
 	 * being inserted into page tables.
 	 */
-	page_mapping_insert(AS, upage, frame, as_area_get_flags(area));
+	page_mapping_insert(AS, upage, frame, flags);
 	if (!used_space_insert(area, upage, 1))
 		panic("Cannot insert used space.");
 
+	anon_fault_around(area, upage, access);
+	mutex_unlock(&area->sh_info->lock);
+
 	return AS_PF_OK;
 }
 
@@ -297,6 +494,10 @@ void anon_frame_free(as_area_t *area, uintptr_t page, uintptr_t frame)
 	assert(page_table_locked(area->as));
 	assert(mutex_locked(&area->lock));
 
+	/* The shared zero frame is never freed. */
+	if (anon_frame_is_zero(frame))
+		return;
+
 	if (area->flags & AS_AREA_LATE_RESERVE) {
 		/*
 		 * In case of the late reserve areas, physical memory will not
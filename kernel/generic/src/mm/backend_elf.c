@@ -236,6 +236,84 @@ bool elf_is_shareable(as_area_t *area)
 }
 
 
+/** Map pages surrounding a faulting page in advance.
+ *
+ * Only the pages which need not be copied are mapped, i.e. the pages already
+ * present in the pagemap of a shared area and the pages of a read-only segment
+ * backed directly by the ELF image.
+ *
+ * The address space area and page tables must be already locked.
+ *
+ * @param area		Pointer to the address space area.
+ * @param upage		Faulting virtual page.
+ */
+static void elf_fault_around(as_area_t *area, uintptr_t upage)
+{
+	elf_header_t *elf = area->backend_data.elf;
+	elf_segment_header_t *entry = area->backend_data.segment;
+	uintptr_t start_anon = entry->p_vaddr + entry->p_filesz;
+	uintptr_t base = (uintptr_t)
+	    (((void *) elf) + ALIGN_DOWN(entry->p_offset, PAGE_SIZE));
+	uintptr_t page;
+	size_t count;
+
+	count = as_area_fault_around(area, upage, &page);
+	if (count == 0)
+		return;
+
+	mutex_lock(&area->sh_info->lock);
+	for (; count > 0; count--, page += PAGE_SIZE) {
+		uintptr_t frame = 0;
+		bool map = false;
+		pte_t pte;
+
+		if (page == upage)
+			continue;
+
+		if ((page < ALIGN_DOWN(entry->p_vaddr, PAGE_SIZE)) ||
+		    (page >= entry->p_vaddr + entry->p_memsz))
+			continue;
+
+		if (page_mapping_find(AS, page, false, &pte) &&
+		    PTE_VALID(&pte))
+			continue;
+
+		if (area->sh_info->shared) {
+			btree_node_t *leaf;
+
+			frame = (uintptr_t) btree_search(
+			    &area->sh_info->pagemap, page - area->base, &leaf);
+			if (frame) {
+				frame_reference_add(ADDR2PFN(frame));
+				map = true;
+			}
+		}
+
+		if ((!map) && (!(entry->p_flags & PF_W)) &&
+		    (page >= entry->p_vaddr) &&
+		    (page + PAGE_SIZE <= start_anon)) {
+			size_t i = (page - ALIGN_DOWN(entry->p_vaddr,
+			    PAGE_SIZE)) >> PAGE_WIDTH;
+			bool found = page_mapping_find(AS_KERNEL,
+			    base + i * FRAME_SIZE, true, &pte);
+
+			assert(found);
+			assert(PTE_PRESENT(&pte));
+
+			frame = PTE_GET_FRAME(&pte);
+			map = true;
+		}
+
+		if (!map)
+			continue;
+
+		page_mapping_insert(AS, page, frame, as_area_get_flags(area));
+		if (!used_space_insert(area, page, 1))
+			panic("Cannot insert used space.");
+	}
+	mutex_unlock(&area->sh_info->lock);
+}
+
 /** Service a page fault in the ELF backend address space area.
  *
  * The address space area and page tables must be already locked.
@@ -311,6 +389,7 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 			if (!used_space_insert(area, upage, 1))
 				panic("Cannot insert used space.");
 			mutex_unlock(&area->sh_info->lock);
+			elf_fault_around(area, upage);
 			return AS_PF_OK;
 		}
 	}
@@ -405,6 +484,8 @@ int elf_page_fault(as_area_t *area, uintptr_t upage, pf_access_t access)
 	if (!used_space_insert(area, upage, 1))
 		panic("Cannot insert used space.");
 
+	elf_fault_around(area, upage);
+
 	return AS_PF_OK;
 }
 
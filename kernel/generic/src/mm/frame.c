@@ -38,6 +38,8 @@
  *
  * This file contains the physical frame allocator and memory zone management.
  * The frame allocator is built on top of the two-level bitmap structure.
+ * Single frames are allocated and freed through per-CPU frame caches,
+ * which exchange frames with the zones in batches.
  *
  */
 
@@ -60,6 +62,8 @@
 #include <macros.h>
 #include <config.h>
 #include <str.h>
+#include <cpu.h>
+#include <sysinfo/sysinfo.h>
 #include <proc/thread.h> /* THREAD */
 
 zones_t zones;
@@ -73,6 +77,18 @@ static condvar_t mem_avail_cv;
 static size_t mem_avail_req = 0;  /**< Number of frames requested. */
 static size_t mem_avail_gen = 0;  /**< Generation counter. */
 
+/** Zone flags of the allocations served by the frame caches. */
+#define FRAME_CACHE_ZONE_FLAGS  FRAME_TO_ZONE_FLAGS(FRAME_NONE)
+
+/** Frame cache watermark limits. */
+#define FRAME_CACHE_HIGH_MIN  16
+
+/**
+ * The frame caches of all CPUs together are allowed to hold about
+ * 1/FRAME_CACHE_SHARE of free memory.
+ */
+#define FRAME_CACHE_SHARE  128
+
 /** Initialize frame structure.
  *
  * @param frame Frame structure to be initialized.
@@ -780,6 +796,294 @@ size_t zone_create(pfn_t start, size_t count, pfn_t confframe,
 	return znum;
 }
 
+/*************************/
+/* Frame cache functions */
+/*************************/
+
+/** Signal that frames have been freed.
+ *
+ * Wakes up threads waiting for memory and returns the reservations of
+ * the freed frames.
+ *
+ * @param freed      Number of freed frames.
+ * @param unreserved Number of freed frames to unreserve.
+ *
+ */
+NO_TRACE static void frames_freed(size_t freed, size_t unreserved)
+{
+	/*
+	 * Since the mem_avail_mtx is an active mutex,
+	 * we need to disable interrupts to prevent deadlock
+	 * with TLB shootdown.
+	 */
+
+	ipl_t ipl = interrupts_disable();
+	mutex_lock(&mem_avail_mtx);
+
+	if (mem_avail_req > 0)
+		mem_avail_req -= min(mem_avail_req, freed);
+
+	if (mem_avail_req == 0) {
+		mem_avail_gen++;
+		condvar_broadcast(&mem_avail_cv);
+	}
+
+	mutex_unlock(&mem_avail_mtx);
+	interrupts_restore(ipl);
+
+	if (unreserved > 0)
+		reserve_free(unreserved);
+}
+
+/** Initialize frame cache of a CPU.
+ *
+ * The watermarks are derived from the amount of free memory, so that
+ * the caches do not hold more than a small fraction of it.
+ *
+ * @param cache Frame cache to initialize.
+ *
+ */
+void frame_cache_initialize(frame_cache_t *cache)
+{
+	irq_spinlock_initialize(&cache->lock, "cpus[].frame_cache.lock");
+
+	size_t high = frame_total_free_get() /
+	    (config.cpu_count * FRAME_CACHE_SHARE);
+
+	cache->high = min(max(high, FRAME_CACHE_HIGH_MIN), FRAME_CACHE_MAX);
+	cache->batch = cache->high / 4;
+	cache->zone = 0;
+	cache->avail_count = 0;
+	cache->freed_count = 0;
+	cache->hits = 0;
+	cache->refills = 0;
+	cache->drains = 0;
+}
+
+/** Return freed frames from cache to their zones.
+ *
+ * Frames which are no longer referenced can be kept in the cache for
+ * allocation while there is room for them. Assume interrupts are
+ * disabled and the cache and the zones lock are locked.
+ *
+ * @param cache      Frame cache.
+ * @param recycle    Keep free frames in the cache.
+ * @param freed      Incremented by the number of freed frames.
+ * @param unreserved Incremented by the number of frames to unreserve.
+ *
+ */
+NO_TRACE static void frame_cache_drain(frame_cache_t *cache, bool recycle,
+    size_t *freed, size_t *unreserved)
+{
+	size_t hint = cache->zone;
+
+	for (size_t i = 0; i < cache->freed_count; i++) {
+		pfn_t pfn = cache->freed[i];
+		size_t znum = find_zone(pfn, 1, hint);
+
+		assert(znum != (size_t) -1);
+		hint = znum;
+
+		zone_t *zone = &zones.info[znum];
+		frame_t *frame = zone_get_frame(zone, pfn - zone->base);
+
+		assert(frame->refcount > 0);
+
+		if (--frame->refcount > 0)
+			continue;
+
+		(*freed)++;
+		if (!cache->freed_noreserve[i])
+			(*unreserved)++;
+
+		if ((recycle) && (cache->avail_count < cache->high) &&
+		    (ZONE_FLAGS_MATCH(zone->flags, FRAME_CACHE_ZONE_FLAGS)) &&
+		    (!is_high_priority(pfn, 1))) {
+			/* Recycle the frame without touching the bitmap */
+			frame->refcount = 1;
+			cache->avail[cache->avail_count++] = pfn;
+		} else {
+			bitmap_set(&zone->bitmap, pfn - zone->base, 0);
+
+			/* Update zone information. */
+			zone->free_count++;
+			zone->busy_count--;
+		}
+	}
+
+	if (cache->freed_count > 0)
+		cache->drains++;
+
+	cache->freed_count = 0;
+}
+
+/** Refill frame cache from the zones.
+ *
+ * A contiguous run of frames is preferred, as it is found by a single
+ * bitmap search. Assume interrupts are disabled and the cache and the
+ * zones lock are locked.
+ *
+ * @param cache Frame cache.
+ *
+ */
+NO_TRACE static void frame_cache_refill(frame_cache_t *cache)
+{
+	size_t count = min(cache->batch, cache->high - cache->avail_count);
+	size_t znum = find_free_zone(count, FRAME_CACHE_ZONE_FLAGS, 0,
+	    cache->zone);
+
+	if (znum != (size_t) -1) {
+		pfn_t pfn = zone_frame_alloc(&zones.info[znum], count, 0) +
+		    zones.info[znum].base;
+
+		/* Frames are taken from the end, hand them out in order */
+		for (size_t i = count; i > 0; i--)
+			cache->avail[cache->avail_count++] = pfn + i - 1;
+	} else {
+		while (cache->avail_count < count) {
+			znum = find_free_zone(1, FRAME_CACHE_ZONE_FLAGS, 0,
+			    cache->zone);
+			if (znum == (size_t) -1)
+				break;
+
+			cache->avail[cache->avail_count++] =
+			    zone_frame_alloc(&zones.info[znum], 1, 0) +
+			    zones.info[znum].base;
+		}
+	}
+
+	if (znum != (size_t) -1)
+		cache->zone = znum;
+
+	cache->refills++;
+}
+
+/** Allocate single frame from the cache of the current CPU.
+ *
+ * @return Frame number or 0 if there is no free frame to refill the cache.
+ *
+ */
+NO_TRACE static pfn_t frame_cache_alloc(void)
+{
+	/*
+	 * The thread may migrate before the lock is taken, in which case
+	 * it just uses the cache of another CPU.
+	 */
+	frame_cache_t *cache = &CPU->frame_cache;
+	size_t freed = 0;
+	size_t unreserved = 0;
+	pfn_t pfn = 0;
+
+	irq_spinlock_lock(&cache->lock, true);
+
+	if (cache->avail_count == 0) {
+		irq_spinlock_lock(&zones.lock, false);
+
+		frame_cache_drain(cache, true, &freed, &unreserved);
+		if (cache->avail_count == 0)
+			frame_cache_refill(cache);
+
+		irq_spinlock_unlock(&zones.lock, false);
+	}
+
+	if (cache->avail_count > 0) {
+		pfn = cache->avail[--cache->avail_count];
+		cache->hits++;
+	}
+
+	irq_spinlock_unlock(&cache->lock, true);
+
+	if (freed > 0)
+		frames_freed(freed, unreserved);
+
+	return pfn;
+}
+
+/** Free single frame to the cache of the current CPU.
+ *
+ * The frame reference is dropped only once the cache is drained.
+ *
+ * @param pfn   Frame to free.
+ * @param flags Flags to control memory reservation.
+ *
+ */
+NO_TRACE static void frame_cache_free(pfn_t pfn, frame_flags_t flags)
+{
+	frame_cache_t *cache = &CPU->frame_cache;
+	size_t freed = 0;
+	size_t unreserved = 0;
+
+	irq_spinlock_lock(&cache->lock, true);
+
+	cache->freed[cache->freed_count] = pfn;
+	cache->freed_noreserve[cache->freed_count] =
+	    (flags & FRAME_NO_RESERVE) != 0;
+	cache->freed_count++;
+
+	if (cache->freed_count == cache->high) {
+		irq_spinlock_lock(&zones.lock, false);
+		frame_cache_drain(cache, true, &freed, &unreserved);
+		irq_spinlock_unlock(&zones.lock, false);
+	}
+
+	irq_spinlock_unlock(&cache->lock, true);
+
+	if (freed > 0)
+		frames_freed(freed, unreserved);
+}
+
+/** Return all frames held by frame caches to the zones.
+ *
+ * @return Number of frames returned.
+ *
+ */
+size_t frame_cache_reclaim(void)
+{
+	size_t returned = 0;
+	size_t freed = 0;
+	size_t unreserved = 0;
+
+	if (cpus == NULL)
+		return 0;
+
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		frame_cache_t *cache = &cpus[i].frame_cache;
+
+		irq_spinlock_lock(&cache->lock, true);
+		irq_spinlock_lock(&zones.lock, false);
+
+		frame_cache_drain(cache, false, &freed, &unreserved);
+
+		for (size_t j = 0; j < cache->avail_count; j++) {
+			pfn_t pfn = cache->avail[j];
+			size_t znum = find_zone(pfn, 1, cache->zone);
+
+			assert(znum != (size_t) -1);
+
+			(void) zone_frame_free(&zones.info[znum],
+			    pfn - zones.info[znum].base);
+		}
+
+		returned += cache->avail_count;
+		cache->avail_count = 0;
+
+		irq_spinlock_unlock(&zones.lock, false);
+		irq_spinlock_unlock(&cache->lock, true);
+	}
+
+	if (freed > 0)
+		frames_freed(freed, unreserved);
+
+	return freed + returned;
+}
+
+/** Whether the frame caches can be used for an allocation or free. */
+NO_TRACE static bool frame_cache_usable(size_t count, frame_flags_t flags)
+{
+	return (count == 1) && (CPU != NULL) &&
+	    (FRAME_TO_ZONE_FLAGS(flags) == FRAME_CACHE_ZONE_FLAGS);
+}
+
 /*******************/
 /* Frame functions */
 /*******************/
@@ -840,6 +1144,16 @@ uintptr_t frame_alloc_generic(size_t count, frame_flags_t flags,
 	if (!(flags & FRAME_NO_RESERVE))
 		reserve_force_alloc(count);
 
+	/*
+	 * Single frames are preferably taken from the frame cache.
+	 */
+	if ((frame_constraint == 0) && (pzone == NULL) &&
+	    (frame_cache_usable(count, flags))) {
+		pfn_t pfn = frame_cache_alloc();
+		if (pfn != 0)
+			return PFN2ADDR(pfn);
+	}
+
 loop:
 	irq_spinlock_lock(&zones.lock, true);
 
@@ -849,6 +1163,19 @@ loop:
 	size_t znum = find_free_zone(count, FRAME_TO_ZONE_FLAGS(flags),
 	    frame_constraint, hint);
 
+	/*
+	 * If no memory, return the frames held by frame caches.
+	 */
+	if (znum == (size_t) -1) {
+		irq_spinlock_unlock(&zones.lock, true);
+		size_t returned = frame_cache_reclaim();
+		irq_spinlock_lock(&zones.lock, true);
+
+		if (returned > 0)
+			znum = find_free_zone(count, FRAME_TO_ZONE_FLAGS(flags),
+			    frame_constraint, hint);
+	}
+
 	/*
 	 * If no memory, reclaim some slab memory,
 	 * if it does not help, reclaim all.
@@ -960,6 +1287,15 @@ void frame_free_generic(uintptr_t start, size_t count, frame_flags_t flags)
 {
 	size_t freed = 0;
 
+	/*
+	 * Frames in the frame caches cannot satisfy threads waiting
+	 * for memory, so bypass them while there are any.
+	 */
+	if ((mem_avail_req == 0) && (frame_cache_usable(count, flags))) {
+		frame_cache_free(ADDR2PFN(start), flags);
+		return;
+	}
+
 	irq_spinlock_lock(&zones.lock, true);
 
 	for (size_t i = 0; i < count; i++) {
@@ -979,27 +1315,8 @@ void frame_free_generic(uintptr_t start, size_t count, frame_flags_t flags)
 
 	/*
 	 * Signal that some memory has been freed.
-	 * Since the mem_avail_mtx is an active mutex,
-	 * we need to disable interruptsto prevent deadlock
-	 * with TLB shootdown.
 	 */
-
-	ipl_t ipl = interrupts_disable();
-	mutex_lock(&mem_avail_mtx);
-
-	if (mem_avail_req > 0)
-		mem_avail_req -= min(mem_avail_req, freed);
-
-	if (mem_avail_req == 0) {
-		mem_avail_gen++;
-		condvar_broadcast(&mem_avail_cv);
-	}
-
-	mutex_unlock(&mem_avail_mtx);
-	interrupts_restore(ipl);
-
-	if (!(flags & FRAME_NO_RESERVE))
-		reserve_free(freed);
+	frames_freed(freed, (flags & FRAME_NO_RESERVE) ? 0 : freed);
 }
 
 void frame_free(uintptr_t frame, size_t count)
@@ -1175,6 +1492,73 @@ void zones_stats(uint64_t *total, uint64_t *unavail, uint64_t *busy,
 	}
 
 	irq_spinlock_unlock(&zones.lock, true);
+
+	/*
+	 * Frames held by the frame caches are ready to be allocated,
+	 * report them as free.
+	 */
+	if (cpus != NULL) {
+		uint64_t cached = 0;
+
+		for (unsigned int i = 0; i < config.cpu_count; i++)
+			cached += cpus[i].frame_cache.avail_count;
+
+		cached = min(FRAMES2SIZE(cached), *busy);
+		*busy -= cached;
+		*free += cached;
+	}
+}
+
+/** Frame cache statistics exported in sysinfo. */
+typedef enum {
+	FRAME_CACHE_STAT_HITS,
+	FRAME_CACHE_STAT_REFILLS,
+	FRAME_CACHE_STAT_DRAINS,
+	FRAME_CACHE_STAT_FRAMES
+} frame_cache_stat_t;
+
+static sysarg_t frame_cache_stats_get(sysinfo_item_t *item, void *data)
+{
+	frame_cache_stat_t stat = (frame_cache_stat_t) (uintptr_t) data;
+	uint64_t sum = 0;
+
+	if (cpus == NULL)
+		return 0;
+
+	/* The counters are only read, an imprecise result is fine */
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		frame_cache_t *cache = &cpus[i].frame_cache;
+
+		switch (stat) {
+		case FRAME_CACHE_STAT_HITS:
+			sum += cache->hits;
+			break;
+		case FRAME_CACHE_STAT_REFILLS:
+			sum += cache->refills;
+			break;
+		case FRAME_CACHE_STAT_DRAINS:
+			sum += cache->drains;
+			break;
+		case FRAME_CACHE_STAT_FRAMES:
+			sum += cache->avail_count;
+			break;
+		}
+	}
+
+	return (sysarg_t) sum;
+}
+
+/** Export frame cache statistics in sysinfo. */
+void frame_stats_init(void)
+{
+	sysinfo_set_item_gen_val("frame.cache.hits", NULL,
+	    frame_cache_stats_get, (void *) FRAME_CACHE_STAT_HITS);
+	sysinfo_set_item_gen_val("frame.cache.refills", NULL,
+	    frame_cache_stats_get, (void *) FRAME_CACHE_STAT_REFILLS);
+	sysinfo_set_item_gen_val("frame.cache.drains", NULL,
+	    frame_cache_stats_get, (void *) FRAME_CACHE_STAT_DRAINS);
+	sysinfo_set_item_gen_val("frame.cache.frames", NULL,
+	    frame_cache_stats_get, (void *) FRAME_CACHE_STAT_FRAMES);
 }
 
 /** Prints list of zones.
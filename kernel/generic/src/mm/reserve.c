@@ -79,12 +79,13 @@ bool reserve_try_alloc(size_t size)
 		reserved = true;
 	} else {
 		/*
-		 * Some reservable frames may be cached by the slab allocator.
-		 * Try to reclaim some reservable memory. Try to be gentle for
-		 * the first time. If it does not help, try to reclaim
-		 * everything.
+		 * Some reservable frames may be cached by the frame caches
+		 * and the slab allocator. Try to reclaim some reservable
+		 * memory. Try to be gentle for the first time. If it does not
+		 * help, try to reclaim everything.
 		 */
 		irq_spinlock_unlock(&reserve_lock, true);
+		frame_cache_reclaim();
 		slab_reclaim(0);
 		irq_spinlock_lock(&reserve_lock, true);
 		if (reserve >= 0 && (size_t) reserve >= size) {
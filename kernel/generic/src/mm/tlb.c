@@ -36,11 +36,19 @@
  *
  * The algorithm implemented here is based on the CMU TLB shootdown
  * algorithm and is further simplified (e.g. all CPUs receive all TLB
- * shootdown messages).
+ * shootdown messages for the kernel address space and for ASID
+ * recycling).
+ *
+ * Shootdowns of user address spaces are targeted only at the CPUs on
+ * which the address space is installed. CPUs which ran the address space
+ * before, and may therefore still cache its translations, invalidate its
+ * ASID lazily when they install the address space again.
  */
 
 #include <mm/tlb.h>
 #include <mm/asid.h>
+#include <mm/as.h>
+#include <mm/page.h>
 #include <arch/mm/tlb.h>
 #include <assert.h>
 #include <smp/ipi.h>
@@ -51,12 +59,101 @@
 #include <arch.h>
 #include <panic.h>
 #include <cpu.h>
+#include <cpu/cpu_mask.h>
+#include <sysinfo/sysinfo.h>
+#include <macros.h>
+
+/*
+ * Shootdown statistics. Protected by tlblock.
+ */
+
+/** Number of shootdown rounds. */
+static size_t tlb_shootdowns = 0;
+
+/** Number of CPUs interrupted by shootdown rounds. */
+static size_t tlb_shootdown_ipis = 0;
+
+/** Number of CPUs whose invalidation was deferred until they switch. */
+static size_t tlb_shootdown_deferred = 0;
 
 void tlb_init(void)
 {
 	tlb_arch_init();
 }
 
+static sysarg_t tlb_stats_get(sysinfo_item_t *item, void *data)
+{
+	return *((size_t *) data);
+}
+
+/** Export shootdown statistics in sysinfo. */
+void tlb_stats_init(void)
+{
+	sysinfo_set_item_gen_val("tlb.shootdowns", NULL, tlb_stats_get,
+	    &tlb_shootdowns);
+	sysinfo_set_item_gen_val("tlb.ipis", NULL, tlb_stats_get,
+	    &tlb_shootdown_ipis);
+	sysinfo_set_item_gen_val("tlb.deferred", NULL, tlb_stats_get,
+	    &tlb_shootdown_deferred);
+}
+
+/** Initialize an empty shootdown batch. */
+void tlb_shootdown_batch_init(tlb_shootdown_batch_t *batch)
+{
+	batch->count = 0;
+}
+
+/** Add a page range to a shootdown batch.
+ *
+ * A range adjacent to the last one extends it. When the batch is full,
+ * the last range is widened to cover the new one as well.
+ *
+ * @param batch Shootdown batch.
+ * @param page  Address of the first page.
+ * @param count Number of pages.
+ *
+ */
+void tlb_shootdown_batch_add(tlb_shootdown_batch_t *batch, uintptr_t page,
+    size_t count)
+{
+	if (count == 0)
+		return;
+
+	if (batch->count > 0) {
+		size_t last = batch->count - 1;
+		uintptr_t base = batch->ranges[last].page;
+		uintptr_t end = base + P2SZ(batch->ranges[last].count);
+
+		if ((page == end) ||
+		    (batch->count == TLB_SHOOTDOWN_BATCH_LEN)) {
+			uintptr_t nbase = min(base, page);
+			uintptr_t nend = max(end, page + P2SZ(count));
+
+			batch->ranges[last].page = nbase;
+			batch->ranges[last].count =
+			    (nend - nbase) >> PAGE_WIDTH;
+			return;
+		}
+	}
+
+	batch->ranges[batch->count].page = page;
+	batch->ranges[batch->count].count = count;
+	batch->count++;
+}
+
+/** Invalidate the page ranges of a shootdown batch in the local TLB.
+ *
+ * @param asid  Address space identifier.
+ * @param batch Shootdown batch.
+ *
+ */
+void tlb_shootdown_batch_invalidate(asid_t asid, tlb_shootdown_batch_t *batch)
+{
+	for (size_t i = 0; i < batch->count; i++)
+		tlb_invalidate_pages(asid, batch->ranges[i].page,
+		    batch->ranges[i].count);
+}
+
 #ifdef CONFIG_SMP
 
 /**
@@ -67,6 +164,43 @@ void tlb_init(void)
  */
 IRQ_SPINLOCK_STATIC_INITIALIZE(tlblock);
 
+/** Enqueue TLB shootdown message for a processor.
+ *
+ * @param cpu   Recipient processor.
+ * @param type  Type describing scope of shootdown.
+ * @param asid  Address space, if required by type.
+ * @param page  Virtual page address, if required by type.
+ * @param count Number of pages, if required by type.
+ *
+ */
+static void tlb_message_enqueue(cpu_t *cpu, tlb_invalidate_type_t type,
+    asid_t asid, uintptr_t page, size_t count)
+{
+	irq_spinlock_lock(&cpu->lock, false);
+	if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
+		/*
+		 * The message queue is full.
+		 * Erase the queue and store one TLB_INVL_ALL message.
+		 */
+		cpu->tlb_messages_count = 1;
+		cpu->tlb_messages[0].type = TLB_INVL_ALL;
+		cpu->tlb_messages[0].asid = ASID_INVALID;
+		cpu->tlb_messages[0].page = 0;
+		cpu->tlb_messages[0].count = 0;
+	} else if ((cpu->tlb_messages_count == 0) ||
+	    (cpu->tlb_messages[0].type != TLB_INVL_ALL)) {
+		/*
+		 * Enqueue the message.
+		 */
+		size_t idx = cpu->tlb_messages_count++;
+		cpu->tlb_messages[idx].type = type;
+		cpu->tlb_messages[idx].asid = asid;
+		cpu->tlb_messages[idx].page = page;
+		cpu->tlb_messages[idx].count = count;
+	}
+	irq_spinlock_unlock(&cpu->lock, false);
+}
+
 /** Send TLB shootdown message.
  *
  * This function attempts to deliver TLB shootdown message
@@ -92,32 +226,11 @@ ipl_t tlb_shootdown_start(tlb_invalidate_type_t type, asid_t asid,
 		if (i == CPU->id)
 			continue;
 
-		cpu_t *cpu = &cpus[i];
-
-		irq_spinlock_lock(&cpu->lock, false);
-		if (cpu->tlb_messages_count == TLB_MESSAGE_QUEUE_LEN) {
-			/*
-			 * The message queue is full.
-			 * Erase the queue and store one TLB_INVL_ALL message.
-			 */
-			cpu->tlb_messages_count = 1;
-			cpu->tlb_messages[0].type = TLB_INVL_ALL;
-			cpu->tlb_messages[0].asid = ASID_INVALID;
-			cpu->tlb_messages[0].page = 0;
-			cpu->tlb_messages[0].count = 0;
-		} else {
-			/*
-			 * Enqueue the message.
-			 */
-			size_t idx = cpu->tlb_messages_count++;
-			cpu->tlb_messages[idx].type = type;
-			cpu->tlb_messages[idx].asid = asid;
-			cpu->tlb_messages[idx].page = page;
-			cpu->tlb_messages[idx].count = count;
-		}
-		irq_spinlock_unlock(&cpu->lock, false);
+		tlb_message_enqueue(&cpus[i], type, asid, page, count);
 	}
 
+	tlb_shootdowns++;
+	tlb_shootdown_ipis += config.cpu_count - 1;
 	tlb_shootdown_ipi_send();
 
 busy_wait:
@@ -141,6 +254,91 @@ void tlb_shootdown_finalize(ipl_t ipl)
 	interrupts_restore(ipl);
 }
 
+/** Send a batch of TLB shootdown messages for an address space.
+ *
+ * The messages are delivered only to the processors on which the address
+ * space is installed. Other processors which have run the address space
+ * are marked to invalidate its ASID before they install it again.
+ *
+ * The address space cannot be installed on any processor until the
+ * sequence is finished by tlb_shootdown_finalize_batch().
+ *
+ * @param as    Address space.
+ * @param batch Page ranges to invalidate.
+ *
+ * @return The interrupt priority level as it existed prior to this call.
+ *
+ */
+ipl_t tlb_shootdown_start_batch(as_t *as, tlb_shootdown_batch_t *batch)
+{
+	ipl_t ipl = interrupts_disable();
+	CPU->tlb_active = false;
+	spinlock_lock(&asidlock);
+	irq_spinlock_lock(&tlblock, false);
+
+	size_t targets = 0;
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		if (i == CPU->id)
+			continue;
+
+		if ((as->cpus_active != NULL) &&
+		    !cpu_mask_is_set(as->cpus_active, i)) {
+			if (cpu_mask_is_set(as->cpus_used, i)) {
+				cpu_mask_set(as->cpus_stale, i);
+				tlb_shootdown_deferred++;
+			}
+			continue;
+		}
+
+		for (size_t j = 0; j < batch->count; j++) {
+			tlb_message_enqueue(&cpus[i], TLB_INVL_PAGES, as->asid,
+			    batch->ranges[j].page, batch->ranges[j].count);
+		}
+		targets++;
+	}
+
+	if (targets == 0)
+		return ipl;
+
+	tlb_shootdowns++;
+	tlb_shootdown_ipis += targets;
+
+	if (targets == config.cpu_count - 1) {
+		tlb_shootdown_ipi_send();
+	} else {
+		for (unsigned int i = 0; i < config.cpu_count; i++) {
+			if ((i != CPU->id) &&
+			    cpu_mask_is_set(as->cpus_active, i))
+				ipi_unicast(i, VECTOR_TLB_SHOOTDOWN_IPI);
+		}
+	}
+
+busy_wait:
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		if ((as->cpus_active != NULL) &&
+		    !cpu_mask_is_set(as->cpus_active, i))
+			continue;
+
+		if (cpus[i].tlb_active)
+			goto busy_wait;
+	}
+
+	return ipl;
+}
+
+/** Finish TLB shootdown sequence started by tlb_shootdown_start_batch().
+ *
+ * @param ipl Previous interrupt priority level.
+ *
+ */
+void tlb_shootdown_finalize_batch(ipl_t ipl)
+{
+	irq_spinlock_unlock(&tlblock, false);
+	spinlock_unlock(&asidlock);
+	CPU->tlb_active = true;
+	interrupts_restore(ipl);
+}
+
 void tlb_shootdown_ipi_send(void)
 {
 	ipi_broadcast(VECTOR_TLB_SHOOTDOWN_IPI);
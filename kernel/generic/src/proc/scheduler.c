@@ -35,7 +35,8 @@
  * @brief Scheduler and load balancing.
  *
  * This file contains the scheduler and kcpulb kernel thread which
- * performs load-balancing of per-CPU run queues.
+ * performs load-balancing of per-CPU run queues. A CPU which runs out
+ * of ready threads steals one from the busiest CPU right away.
  */
 
 #include <assert.h>
@@ -51,6 +52,7 @@
 #include <arch/faddr.h>
 #include <arch/cycle.h>
 #include <atomic.h>
+#include <bitops.h>
 #include <synch/spinlock.h>
 #include <synch/workqueue.h>
 #include <synch/rcu.h>
@@ -188,6 +190,149 @@ void scheduler_init(void)
 {
 }
 
+/** Remove a ready thread from a run queue
+ *
+ * The rq_lock of the CPU must be held.
+ *
+ * @param cpu    CPU owning the run queue.
+ * @param thread Thread to be removed.
+ * @param i      Index of the run queue the thread is linked to.
+ *
+ */
+static void runq_remove(cpu_t *cpu, thread_t *thread, unsigned int i)
+{
+	assert(irq_spinlock_locked(&cpu->rq_lock));
+
+	list_remove(&thread->rq_link);
+
+	cpu->rq[i].n--;
+	if (cpu->rq[i].n == 0)
+		cpu->rq_map &= ~(1U << i);
+
+	atomic_dec(&cpu->nrdy);
+	atomic_dec(&nrdy);
+}
+
+/** Get the highest-priority run queue in a non-empty run queue bitmap
+ *
+ * @param map Bitmap of non-empty run queues.
+ *
+ * @return Index of the first non-empty run queue.
+ *
+ */
+static inline unsigned int runq_first(uint32_t map)
+{
+	assert(map != 0);
+
+	/* Isolate the lowest set bit */
+	return fnzb32(map & (~map + 1));
+}
+
+/** Prepare a thread taken from a run queue for running on this CPU
+ *
+ * @param thread Thread taken from a run queue, locked.
+ * @param i      Index of the run queue the thread was taken from.
+ *
+ * @return The thread, unlocked.
+ *
+ */
+static thread_t *take_thread(thread_t *thread, unsigned int i)
+{
+	assert(irq_spinlock_locked(&thread->lock));
+
+	thread->cpu = CPU;
+	thread->priority = i;  /* Correct rq index */
+
+	/* Use the rest of the timeslice handed over to the thread, if any. */
+	if (thread->handoff_ticks > 0) {
+		thread->ticks = thread->handoff_ticks;
+		thread->handoff_ticks = 0;
+	} else {
+		thread->ticks = us2ticks((i + 1) * 10000);
+	}
+
+	/*
+	 * Clear the stolen flag so that it can be migrated
+	 * when load balancing needs emerge.
+	 */
+	thread->stolen = false;
+	irq_spinlock_unlock(&thread->lock, false);
+
+	return thread;
+}
+
+#ifdef CONFIG_SMP
+/** Steal a ready thread from another CPU
+ *
+ * Called by a CPU which ran out of ready threads, so that it
+ * does not need to sit idle until kcpulb migrates some work to it.
+ * The victim is the CPU with the most ready threads. Its run queues
+ * are searched from the highest priority, each from the back.
+ *
+ * @param[out] rq Index of the run queue the thread was taken from.
+ *
+ * @return Stolen thread, locked, or NULL if there is nothing to steal.
+ *
+ */
+static thread_t *steal_thread(unsigned int *rq)
+{
+	cpu_t *victim = NULL;
+	atomic_count_t victim_nrdy = 0;
+
+	size_t acpu;
+	for (acpu = 1; acpu < config.cpu_active; acpu++) {
+		cpu_t *cpu = &cpus[(CPU->id + acpu) % config.cpu_active];
+		atomic_count_t rdy = atomic_get(&cpu->nrdy);
+
+		if (rdy > victim_nrdy) {
+			victim = cpu;
+			victim_nrdy = rdy;
+		}
+	}
+
+	if (victim == NULL)
+		return NULL;
+
+	irq_spinlock_lock(&victim->rq_lock, false);
+
+	uint32_t map = victim->rq_map;
+	while (map != 0) {
+		unsigned int i = runq_first(map);
+		map &= ~(1U << i);
+
+		link_t *link = victim->rq[i].rq.head.prev;
+		while (link != &victim->rq[i].rq.head) {
+			thread_t *thread = list_get_instance(link, thread_t,
+			    rq_link);
+
+			/*
+			 * Do not steal CPU-wired threads, threads already
+			 * stolen, threads for which migration was temporarily
+			 * disabled or threads whose FPU context is still in
+			 * the CPU.
+			 */
+			irq_spinlock_lock(&thread->lock, false);
+
+			if ((!thread->wired) && (!thread->stolen) &&
+			    (!thread->nomigrate) &&
+			    (!thread->fpu_context_engaged)) {
+				runq_remove(victim, thread, i);
+				irq_spinlock_unlock(&victim->rq_lock, false);
+
+				*rq = i;
+				return thread;
+			}
+
+			irq_spinlock_unlock(&thread->lock, false);
+			link = link->prev;
+		}
+	}
+
+	irq_spinlock_unlock(&victim->rq_lock, false);
+	return NULL;
+}
+#endif /* CONFIG_SMP */
+
 /** Get thread to be scheduled
  *
  * Get the optimal thread to be scheduled
@@ -204,6 +349,19 @@ static thread_t *find_best_thread(void)
 loop:
 
 	if (atomic_get(&CPU->nrdy) == 0) {
+#ifdef CONFIG_SMP
+		/*
+		 * Before going to sleep, try to take over some work
+		 * from a busier CPU.
+		 */
+		unsigned int rq;
+		thread_t *thread = steal_thread(&rq);
+		if (thread != NULL) {
+			atomic_inc(&CPU->steals);
+			return take_thread(thread, rq);
+		}
+#endif /* CONFIG_SMP */
+
 		/*
 		 * For there was nothing to run, the CPU goes to sleep
 		 * until a hardware interrupt or an IPI comes.
@@ -226,45 +384,29 @@ loop:
 
 	assert(!CPU->idle);
 
-	unsigned int i;
-	for (i = 0; i < RQ_COUNT; i++) {
-		irq_spinlock_lock(&(CPU->rq[i].lock), false);
-		if (CPU->rq[i].n == 0) {
-			/*
-			 * If this queue is empty, try a lower-priority queue.
-			 */
-			irq_spinlock_unlock(&(CPU->rq[i].lock), false);
-			continue;
-		}
-
-		atomic_dec(&CPU->nrdy);
-		atomic_dec(&nrdy);
-		CPU->rq[i].n--;
+	irq_spinlock_lock(&CPU->rq_lock, false);
 
+	if (CPU->rq_map == 0) {
 		/*
-		 * Take the first thread from the queue.
+		 * The ready threads have been stolen by
+		 * another CPU in the meantime.
 		 */
-		thread_t *thread = list_get_instance(
-		    list_first(&CPU->rq[i].rq), thread_t, rq_link);
-		list_remove(&thread->rq_link);
-
-		irq_spinlock_pass(&(CPU->rq[i].lock), &thread->lock);
+		irq_spinlock_unlock(&CPU->rq_lock, false);
+		goto loop;
+	}
 
-		thread->cpu = CPU;
-		thread->ticks = us2ticks((i + 1) * 10000);
-		thread->priority = i;  /* Correct rq index */
+	unsigned int i = runq_first(CPU->rq_map);
 
-		/*
-		 * Clear the stolen flag so that it can be migrated
-		 * when load balancing needs emerge.
-		 */
-		thread->stolen = false;
-		irq_spinlock_unlock(&thread->lock, false);
+	/*
+	 * Take the first thread from the queue.
+	 */
+	thread_t *thread = list_get_instance(
+	    list_first(&CPU->rq[i].rq), thread_t, rq_link);
+	runq_remove(CPU, thread, i);
 
-		return thread;
-	}
+	irq_spinlock_pass(&CPU->rq_lock, &thread->lock);
 
-	goto loop;
+	return take_thread(thread, i);
 }
 
 /** Prevent rq starvation
@@ -280,30 +422,28 @@ loop:
  */
 static void relink_rq(int start)
 {
-	list_t list;
-
-	list_initialize(&list);
 	irq_spinlock_lock(&CPU->lock, false);
 
 	if (CPU->needs_relink > NEEDS_RELINK_MAX) {
+		irq_spinlock_lock(&CPU->rq_lock, false);
+
 		int i;
 		for (i = start; i < RQ_COUNT - 1; i++) {
-			/* Remember and empty rq[i + 1] */
-
-			irq_spinlock_lock(&CPU->rq[i + 1].lock, false);
-			list_concat(&list, &CPU->rq[i + 1].rq);
-			size_t n = CPU->rq[i + 1].n;
-			CPU->rq[i + 1].n = 0;
-			irq_spinlock_unlock(&CPU->rq[i + 1].lock, false);
-
 			/* Append rq[i + 1] to rq[i] */
+			list_concat(&CPU->rq[i].rq, &CPU->rq[i + 1].rq);
+			CPU->rq[i].n += CPU->rq[i + 1].n;
+			CPU->rq[i + 1].n = 0;
 
-			irq_spinlock_lock(&CPU->rq[i].lock, false);
-			list_concat(&CPU->rq[i].rq, &list);
-			CPU->rq[i].n += n;
-			irq_spinlock_unlock(&CPU->rq[i].lock, false);
+			if (CPU->rq[i].n > 0)
+				CPU->rq_map |= 1U << i;
+			else
+				CPU->rq_map &= ~(1U << i);
 		}
 
+		if (CPU->rq[RQ_COUNT - 1].n == 0)
+			CPU->rq_map &= ~(1U << (RQ_COUNT - 1));
+
+		irq_spinlock_unlock(&CPU->rq_lock, false);
 		CPU->needs_relink = 0;
 	}
 
@@ -617,9 +757,9 @@ not_satisfied:
 			if (atomic_get(&cpu->nrdy) <= average)
 				continue;
 
-			irq_spinlock_lock(&(cpu->rq[rq].lock), true);
+			irq_spinlock_lock(&cpu->rq_lock, true);
 			if (cpu->rq[rq].n == 0) {
-				irq_spinlock_unlock(&(cpu->rq[rq].lock), true);
+				irq_spinlock_unlock(&cpu->rq_lock, true);
 				continue;
 			}
 
@@ -649,12 +789,7 @@ not_satisfied:
 					irq_spinlock_unlock(&thread->lock,
 					    false);
 
-					atomic_dec(&cpu->nrdy);
-					atomic_dec(&nrdy);
-
-					cpu->rq[rq].n--;
-					list_remove(&thread->rq_link);
-
+					runq_remove(cpu, thread, rq);
 					break;
 				}
 
@@ -669,7 +804,7 @@ not_satisfied:
 				 * Ready thread on local CPU
 				 */
 
-				irq_spinlock_pass(&(cpu->rq[rq].lock),
+				irq_spinlock_pass(&cpu->rq_lock,
 				    &thread->lock);
 
 #ifdef KCPULB_VERBOSE
@@ -686,6 +821,12 @@ not_satisfied:
 				irq_spinlock_unlock(&thread->lock, true);
 				thread_ready(thread);
 
+				/*
+				 * Migrations are accounted by the
+				 * wired kcpulb of this CPU only.
+				 */
+				atomic_inc(&CPU->migrations);
+
 				if (--count == 0)
 					goto satisfied;
 
@@ -698,7 +839,7 @@ not_satisfied:
 
 				continue;
 			} else
-				irq_spinlock_unlock(&(cpu->rq[rq].lock), true);
+				irq_spinlock_unlock(&cpu->rq_lock, true);
 
 		}
 	}
@@ -737,17 +878,19 @@ void sched_print_list(void)
 
 		irq_spinlock_lock(&cpus[cpu].lock, true);
 
-		printf("cpu%u: address=%p, nrdy=%" PRIua ", needs_relink=%zu\n",
+		printf("cpu%u: address=%p, nrdy=%" PRIua ", needs_relink=%zu, "
+		    "steals=%" PRIua ", migrations=%" PRIua ", "
+		    "handoffs=%" PRIu64 "\n",
 		    cpus[cpu].id, &cpus[cpu], atomic_get(&cpus[cpu].nrdy),
-		    cpus[cpu].needs_relink);
+		    cpus[cpu].needs_relink, atomic_get(&cpus[cpu].steals),
+		    atomic_get(&cpus[cpu].migrations), cpus[cpu].handoffs);
+
+		irq_spinlock_lock(&cpus[cpu].rq_lock, false);
 
 		unsigned int i;
 		for (i = 0; i < RQ_COUNT; i++) {
-			irq_spinlock_lock(&(cpus[cpu].rq[i].lock), false);
-			if (cpus[cpu].rq[i].n == 0) {
-				irq_spinlock_unlock(&(cpus[cpu].rq[i].lock), false);
+			if (cpus[cpu].rq[i].n == 0)
 				continue;
-			}
 
 			printf("\trq[%u]: ", i);
 			list_foreach(cpus[cpu].rq[i].rq, rq_link, thread_t,
@@ -756,10 +899,10 @@ void sched_print_list(void)
 				    thread_states[thread->state]);
 			}
 			printf("\n");
-
-			irq_spinlock_unlock(&(cpus[cpu].rq[i].lock), false);
 		}
 
+		irq_spinlock_unlock(&cpus[cpu].rq_lock, false);
+
 		irq_spinlock_unlock(&cpus[cpu].lock, true);
 	}
 }
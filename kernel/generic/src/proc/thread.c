@@ -307,7 +307,7 @@ void thread_ready(thread_t *thread)
 
 	thread->state = Ready;
 
-	irq_spinlock_pass(&thread->lock, &(cpu->rq[i].lock));
+	irq_spinlock_pass(&thread->lock, &cpu->rq_lock);
 
 	/*
 	 * Append thread to respective ready queue
@@ -316,12 +316,66 @@ void thread_ready(thread_t *thread)
 
 	list_append(&thread->rq_link, &cpu->rq[i].rq);
 	cpu->rq[i].n++;
-	irq_spinlock_unlock(&(cpu->rq[i].lock), true);
+	cpu->rq_map |= 1U << i;
+	irq_spinlock_unlock(&cpu->rq_lock, true);
 
 	atomic_inc(&nrdy);
 	atomic_inc(&cpu->nrdy);
 }
 
+/** Make thread ready to run next on the current CPU
+ *
+ * The thread is put in front of the other ready threads of the same
+ * priority on the current CPU, so that it runs as soon as the current
+ * thread blocks. The priority is adjusted just like by thread_ready().
+ * This is meant for a thread woken up by the current thread, which is
+ * about to wait for it, e.g. a server thread receiving a request or a
+ * client receiving the answer. The rest of the timeslice of the current
+ * thread is handed over to the thread, so the current thread is preempted
+ * on the next clock tick if it does not block by then. Threads which
+ * cannot run on the current CPU are readied as usual.
+ *
+ * @param thread Thread to make ready.
+ *
+ */
+void thread_ready_handoff(thread_t *thread)
+{
+	irq_spinlock_lock(&thread->lock, true);
+
+	assert(thread->state != Ready);
+
+	if ((thread->wired || thread->nomigrate ||
+	    thread->fpu_context_engaged) && (thread->cpu != CPU)) {
+		irq_spinlock_unlock(&thread->lock, true);
+		thread_ready(thread);
+		return;
+	}
+
+	before_thread_is_ready(thread);
+
+	int i = (thread->priority < RQ_COUNT - 1) ?
+	    ++thread->priority : thread->priority;
+
+	thread->cpu = CPU;
+	thread->state = Ready;
+
+	irq_spinlock_pass(&thread->lock, &CPU->rq_lock);
+
+	if (THREAD != NULL) {
+		thread->handoff_ticks = THREAD->ticks;
+		THREAD->ticks = 0;
+	}
+
+	list_prepend(&thread->rq_link, &CPU->rq[i].rq);
+	CPU->rq[i].n++;
+	CPU->rq_map |= 1U << i;
+	CPU->handoffs++;
+	irq_spinlock_unlock(&CPU->rq_lock, true);
+
+	atomic_inc(&nrdy);
+	atomic_inc(&CPU->nrdy);
+}
+
 /** Create new thread
  *
  * Create a new thread.
@@ -366,6 +420,7 @@ thread_t *thread_create(void (*func)(void *), void *arg, task_t *task,
 	thread->thread_code = func;
 	thread->thread_arg = arg;
 	thread->ticks = -1;
+	thread->handoff_ticks = 0;
 	thread->ucycles = 0;
 	thread->kcycles = 0;
 	thread->uncounted =
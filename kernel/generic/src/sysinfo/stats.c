@@ -115,6 +115,9 @@ static void *get_stats_cpus(struct sysinfo_item *item, size_t *size,
 		stats_cpus[i].frequency_mhz = cpus[i].frequency_mhz;
 		stats_cpus[i].busy_cycles = cpus[i].busy_cycles;
 		stats_cpus[i].idle_cycles = cpus[i].idle_cycles;
+		stats_cpus[i].steals = atomic_get(&cpus[i].steals);
+		stats_cpus[i].migrations = atomic_get(&cpus[i].migrations);
+		stats_cpus[i].handoffs = cpus[i].handoffs;
 
 		irq_spinlock_unlock(&cpus[i].lock, true);
 	}
@@ -53,7 +53,15 @@
 void timeout_init(void)
 {
 	irq_spinlock_initialize(&CPU->timeoutlock, "cpu.timeoutlock");
-	list_initialize(&CPU->timeout_active_list);
+
+	timeout_wheel_t *wheel = &CPU->timeout_wheel;
+	wheel->now = 0;
+	wheel->count = 0;
+
+	for (unsigned int level = 0; level < TIMEOUT_WHEEL_LEVELS; level++) {
+		for (unsigned int slot = 0; slot < TIMEOUT_WHEEL_SLOTS; slot++)
+			list_initialize(&wheel->slot[level][slot]);
+	}
 }
 
 /** Reinitialize timeout
@@ -66,7 +74,7 @@ void timeout_init(void)
 void timeout_reinitialize(timeout_t *timeout)
 {
 	timeout->cpu = NULL;
-	timeout->ticks = 0;
+	timeout->deadline = 0;
 	timeout->handler = NULL;
 	timeout->arg = NULL;
 	link_initialize(&timeout->link);
@@ -85,12 +93,81 @@ void timeout_initialize(timeout_t *timeout)
 	timeout_reinitialize(timeout);
 }
 
+/** Insert timeout into the slot of the wheel matching its deadline
+ *
+ * The level is chosen by the distance of the deadline from the current
+ * tick, the slot by the bits of the deadline resolved by the level.
+ * Timeouts which are already due go to the slot of the current tick,
+ * timeouts beyond the range of the wheel go to the last slot of the
+ * top level and are reinserted as the wheel turns.
+ *
+ * The caller must hold the timeoutlock of the CPU owning the wheel.
+ *
+ * @param wheel   Timeout wheel.
+ * @param timeout Timeout to insert.
+ *
+ */
+static void timeout_wheel_insert(timeout_wheel_t *wheel, timeout_t *timeout)
+{
+	uint64_t expires = timeout->deadline;
+	if (expires < wheel->now)
+		expires = wheel->now;
+
+	uint64_t delta = expires - wheel->now;
+	if (delta >= TIMEOUT_WHEEL_RANGE) {
+		delta = TIMEOUT_WHEEL_RANGE - 1;
+		expires = wheel->now + delta;
+	}
+
+	unsigned int level = 0;
+	while ((delta >> (TIMEOUT_WHEEL_BITS * (level + 1))) != 0)
+		level++;
+
+	size_t slot = (expires >> (TIMEOUT_WHEEL_BITS * level)) &
+	    TIMEOUT_WHEEL_MASK;
+	list_append(&timeout->link, &wheel->slot[level][slot]);
+}
+
+/** Cascade timeouts of the spans starting in the current tick
+ *
+ * Each level whose span starts in the current tick has the timeouts of
+ * that span redistributed to the lower levels. Every timeout is
+ * cascaded at most TIMEOUT_WHEEL_LEVELS - 1 times during its life.
+ *
+ * The caller must hold the timeoutlock of the CPU owning the wheel.
+ *
+ * @param wheel Timeout wheel.
+ *
+ */
+static void timeout_wheel_cascade(timeout_wheel_t *wheel)
+{
+	for (unsigned int level = 1; level < TIMEOUT_WHEEL_LEVELS; level++) {
+		unsigned int shift = TIMEOUT_WHEEL_BITS * level;
+
+		if ((wheel->now & ((UINT64_C(1) << shift) - 1)) != 0)
+			break;
+
+		size_t slot = (wheel->now >> shift) & TIMEOUT_WHEEL_MASK;
+		list_t *list = &wheel->slot[level][slot];
+
+		link_t *cur;
+		while ((cur = list_first(list)) != NULL) {
+			list_remove(cur);
+			timeout_wheel_insert(wheel,
+			    list_get_instance(cur, timeout_t, link));
+		}
+	}
+}
+
 /** Register timeout
  *
  * Insert timeout handler f (with argument arg)
- * to timeout list and make it execute in
+ * to the timeout wheel and make it execute in
  * time microseconds (or slightly more).
  *
+ * The insertion takes constant time regardless
+ * of the number of active timeouts.
+ *
  * @param timeout Timeout structure.
  * @param time    Number of usec in the future to execute the handler.
  * @param handler Timeout handler function.
@@ -106,50 +183,16 @@ void timeout_register(timeout_t *timeout, uint64_t time,
 	if (timeout->cpu)
 		panic("Unexpected: timeout->cpu != 0.");
 
+	timeout_wheel_t *wheel = &CPU->timeout_wheel;
+
 	timeout->cpu = CPU;
-	timeout->ticks = us2ticks(time);
+	timeout->deadline = wheel->now + us2ticks(time);
 
 	timeout->handler = handler;
 	timeout->arg = arg;
 
-	/*
-	 * Insert timeout into the active timeouts list according to timeout->ticks.
-	 */
-	uint64_t sum = 0;
-	timeout_t *target = NULL;
-	link_t *cur;
-	for (cur = CPU->timeout_active_list.head.next;
-	    cur != &CPU->timeout_active_list.head; cur = cur->next) {
-		target = list_get_instance(cur, timeout_t, link);
-		irq_spinlock_lock(&target->lock, false);
-
-		if (timeout->ticks < sum + target->ticks) {
-			irq_spinlock_unlock(&target->lock, false);
-			break;
-		}
-
-		sum += target->ticks;
-		irq_spinlock_unlock(&target->lock, false);
-	}
-
-	/* Avoid using cur->prev directly */
-	link_t *prev = cur->prev;
-	list_insert_after(&timeout->link, prev);
-
-	/*
-	 * Adjust timeout->ticks according to ticks
-	 * accumulated in target's predecessors.
-	 */
-	timeout->ticks -= sum;
-
-	/*
-	 * Decrease ticks of timeout's immediate succesor by timeout->ticks.
-	 */
-	if (cur != &CPU->timeout_active_list.head) {
-		irq_spinlock_lock(&target->lock, false);
-		target->ticks -= timeout->ticks;
-		irq_spinlock_unlock(&target->lock, false);
-	}
+	timeout_wheel_insert(wheel, timeout);
+	wheel->count++;
 
 	irq_spinlock_unlock(&timeout->lock, false);
 	irq_spinlock_unlock(&CPU->timeoutlock, true);
@@ -157,7 +200,7 @@ void timeout_register(timeout_t *timeout, uint64_t time,
 
 /** Unregister timeout
  *
- * Remove timeout from timeout list.
+ * Remove timeout from the timeout wheel.
  *
  * @param timeout Timeout to unregister.
  *
@@ -183,18 +226,11 @@ grab_locks:
 
 	/*
 	 * Now we know for sure that timeout hasn't been activated yet
-	 * and is lurking in timeout->cpu->timeout_active_list.
+	 * and is lurking in a slot of timeout->cpu->timeout_wheel.
 	 */
 
-	link_t *cur = timeout->link.next;
-	if (cur != &timeout->cpu->timeout_active_list.head) {
-		timeout_t *tmp = list_get_instance(cur, timeout_t, link);
-		irq_spinlock_lock(&tmp->lock, false);
-		tmp->ticks += timeout->ticks;
-		irq_spinlock_unlock(&tmp->lock, false);
-	}
-
 	list_remove(&timeout->link);
+	timeout->cpu->timeout_wheel.count--;
 	irq_spinlock_unlock(&timeout->cpu->timeoutlock, false);
 
 	timeout_reinitialize(timeout);
@@ -203,5 +239,55 @@ grab_locks:
 	return true;
 }
 
+/** Run expired timeouts
+ *
+ * Execute the handlers of all timeouts expiring in the current
+ * clock tick of the current CPU and advance its timeout wheel
+ * by one tick. Called from clock() with interrupts disabled.
+ *
+ * To avoid lock ordering problems, the handlers are run
+ * as the timeouts are visited.
+ *
+ */
+void timeout_expire(void)
+{
+	timeout_wheel_t *wheel = &CPU->timeout_wheel;
+
+	irq_spinlock_lock(&CPU->timeoutlock, false);
+
+	timeout_wheel_cascade(wheel);
+
+	/*
+	 * Handlers may register new timeouts expiring in this very tick,
+	 * these are appended to the list and run by this loop as well.
+	 */
+	list_t *expired = &wheel->slot[0][wheel->now & TIMEOUT_WHEEL_MASK];
+
+	link_t *cur;
+	while ((cur = list_first(expired)) != NULL) {
+		timeout_t *timeout = list_get_instance(cur, timeout_t, link);
+
+		irq_spinlock_lock(&timeout->lock, false);
+
+		list_remove(cur);
+		wheel->count--;
+
+		timeout_handler_t handler = timeout->handler;
+		void *arg = timeout->arg;
+		timeout_reinitialize(timeout);
+
+		irq_spinlock_unlock(&timeout->lock, false);
+		irq_spinlock_unlock(&CPU->timeoutlock, false);
+
+		handler(arg);
+
+		irq_spinlock_lock(&CPU->timeoutlock, false);
+	}
+
+	wheel->now++;
+
+	irq_spinlock_unlock(&CPU->timeoutlock, false);
+}
+
 /** @}
  */
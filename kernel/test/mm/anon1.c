@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <print.h>
+#include <test.h>
+#include <mm/as.h>
+#include <mm/page.h>
+#include <syscall/copy.h>
+#include <typedefs.h>
+#include <errno.h>
+#include <macros.h>
+#include <arch.h>
+
+/*
+ * Measure the number of page faults needed to access anonymous memory
+ * with fault-around disabled and enabled.
+ */
+
+#define TEST_MIB   8
+#define TEST_SIZE  (TEST_MIB * 1024 * 1024)
+
+static size_t page_faults_get(void)
+{
+	mutex_lock(&AS->lock);
+	size_t faults = AS->page_faults;
+	mutex_unlock(&AS->lock);
+
+	return faults;
+}
+
+static uint8_t pattern(uintptr_t offset)
+{
+	return (uint8_t) ((offset >> PAGE_WIDTH) ^ 0x5a);
+}
+
+/** Touch every page of an area.
+ *
+ * @param base   Base address of the area.
+ * @param write  Write the pattern if true, read if false.
+ * @param zero   When reading, expect zeros instead of the pattern.
+ * @param faults Place to store the number of page faults per MiB.
+ *
+ * @return NULL on success or an error message.
+ */
+static const char *touch(uintptr_t base, bool write, bool zero,
+    size_t *faults)
+{
+	size_t before = page_faults_get();
+
+	for (uintptr_t offset = 0; offset < TEST_SIZE; offset += PAGE_SIZE) {
+		uint8_t expected = zero ? 0 : pattern(offset);
+		uint8_t byte = pattern(offset);
+		errno_t rc;
+
+		if (write) {
+			rc = copy_to_uspace((void *) (base + offset), &byte, 1);
+		} else {
+			rc = copy_from_uspace(&byte, (void *) (base + offset),
+			    1);
+		}
+
+		if (rc != EOK)
+			return "Cannot access anonymous memory";
+
+		if ((!write) && (byte != expected))
+			return "Unexpected memory contents";
+	}
+
+	*faults = (page_faults_get() - before) / TEST_MIB;
+	return NULL;
+}
+
+/** Access a fresh anonymous area.
+ *
+ * @param read_first Read the whole area before writing to it.
+ * @param rfaults    Place to store the number of faults per MiB of reading.
+ * @param wfaults    Place to store the number of faults per MiB of writing.
+ *
+ * @return NULL on success or an error message.
+ */
+static const char *run(bool read_first, size_t *rfaults, size_t *wfaults)
+{
+	uintptr_t base = (uintptr_t) AS_AREA_ANY;
+	as_area_t *area = as_area_create(AS,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE, TEST_SIZE,
+	    AS_AREA_ATTR_NONE, &anon_backend, NULL, &base,
+	    USER_ADDRESS_SPACE_START + PAGE_SIZE);
+	if (!area)
+		return "Cannot create anonymous area";
+
+	const char *err = NULL;
+	size_t faults;
+
+	*rfaults = 0;
+	if (read_first)
+		err = touch(base, false, true, rfaults);
+
+	if (err == NULL)
+		err = touch(base, true, false, wfaults);
+
+	/* Read back what has been written. */
+	if (err == NULL)
+		err = touch(base, false, false, &faults);
+
+	if (as_area_destroy(AS, base) != EOK && err == NULL)
+		err = "Cannot destroy anonymous area";
+
+	return err;
+}
+
+const char *test_anon1(void)
+{
+	size_t saved = as_fault_around;
+	size_t windows[] = { 0, AS_FAULT_AROUND_DEFAULT };
+	size_t rfaults[2];
+	size_t wfaults[2];
+	size_t fresh[2];
+	size_t dummy;
+	const char *err = NULL;
+
+	for (size_t i = 0; i < sizeof(windows) / sizeof(windows[0]); i++) {
+		as_fault_around = windows[i];
+
+		err = run(false, &dummy, &fresh[i]);
+		if (err != NULL)
+			break;
+
+		err = run(true, &rfaults[i], &wfaults[i]);
+		if (err != NULL)
+			break;
+
+		TPRINTF("Fault-around %zu pages, faults per MiB: "
+		    "write %zu, read %zu, write after read %zu\n",
+		    windows[i], fresh[i], rfaults[i], wfaults[i]);
+	}
+
+	as_fault_around = saved;
+
+	if (err != NULL)
+		return err;
+
+	if ((fresh[1] >= fresh[0]) || (rfaults[1] >= rfaults[0]))
+		return "Fault-around did not reduce the number of faults";
+
+	return NULL;
+}
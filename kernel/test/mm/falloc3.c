@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <print.h>
+#include <test.h>
+#include <mm/frame.h>
+#include <arch/cycle.h>
+#include <atomic.h>
+#include <config.h>
+#include <cpu.h>
+#include <proc/thread.h>
+#include <typedefs.h>
+
+/** Number of frames allocated before they are freed again */
+#define BURST_FRAMES  64
+
+/** Number of allocation and deallocation rounds per thread */
+#define ROUNDS        2000
+
+static atomic_t thread_count;
+static atomic_t thread_fail;
+
+/** Allocate and free single frames on the CPU the thread is wired to.
+ *
+ * Each frame is tagged with the thread ID while it is allocated, so that
+ * a frame handed out twice is detected.
+ *
+ */
+static void falloc(void *arg)
+{
+	uintptr_t frames[BURST_FRAMES];
+	uint64_t cycles = 0;
+	uint64_t count = 0;
+
+	for (unsigned int run = 0; run < ROUNDS; run++) {
+		size_t allocated = 0;
+
+		uint64_t start = get_cycle();
+		while (allocated < BURST_FRAMES) {
+			frames[allocated] = frame_alloc(1, FRAME_ATOMIC, 0);
+			if (frames[allocated] == 0)
+				break;
+			allocated++;
+		}
+		cycles += get_cycle() - start;
+
+		for (size_t i = 0; i < allocated; i++)
+			*((uint64_t *) PA2KA(frames[i])) = THREAD->tid;
+
+		for (size_t i = 0; i < allocated; i++) {
+			if (*((uint64_t *) PA2KA(frames[i])) != THREAD->tid) {
+				TPRINTF("Thread #%" PRIu64 " (cpu%u): "
+				    "Frame %p allocated twice\n", THREAD->tid,
+				    CPU->id, (void *) frames[i]);
+				atomic_inc(&thread_fail);
+			}
+		}
+
+		start = get_cycle();
+		for (size_t i = 0; i < allocated; i++)
+			frame_free(frames[i], 1);
+		cycles += get_cycle() - start;
+
+		count += allocated;
+	}
+
+	if (count > 0) {
+		TPRINTF("Thread #%" PRIu64 " (cpu%u): %" PRIu64 " frames, "
+		    "%" PRIu64 " cycles per allocation and free\n", THREAD->tid,
+		    CPU->id, count, cycles / count);
+	}
+
+	atomic_dec(&thread_count);
+}
+
+const char *test_falloc3(void)
+{
+	atomic_set(&thread_count, 0);
+	atomic_set(&thread_fail, 0);
+
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		if (!cpus[i].active)
+			continue;
+
+		thread_t *thrd = thread_create(falloc, NULL, TASK,
+		    THREAD_FLAG_NONE, "falloc3");
+		if (!thrd) {
+			TPRINTF("Could not create thread %u\n", i);
+			break;
+		}
+
+		thread_wire(thrd, &cpus[i]);
+		atomic_inc(&thread_count);
+		thread_ready(thrd);
+	}
+
+	while (atomic_get(&thread_count) > 0)
+		thread_sleep(1);
+
+	uint64_t hits = 0;
+	uint64_t refills = 0;
+	uint64_t drains = 0;
+
+	for (unsigned int i = 0; i < config.cpu_count; i++) {
+		hits += cpus[i].frame_cache.hits;
+		refills += cpus[i].frame_cache.refills;
+		drains += cpus[i].frame_cache.drains;
+	}
+
+	TPRINTF("Frame caches: %" PRIu64 " hits, %" PRIu64 " refills, "
+	    "%" PRIu64 " drains, %zu frames returned\n", hits, refills,
+	    drains, frame_cache_reclaim());
+
+	if (atomic_get(&thread_fail) == 0)
+		return NULL;
+
+	return "Test failed";
+}
@@ -45,8 +45,10 @@ test_t tests[] = {
 #include <cht/cht1.def>
 #include <debug/mips1.def>
 #include <fault/fault1.def>
+#include <mm/anon1.def>
 #include <mm/falloc1.def>
 #include <mm/falloc2.def>
+#include <mm/falloc3.def>
 #include <mm/mapping1.def>
 #include <mm/slab1.def>
 #include <mm/slab2.def>
@@ -61,6 +63,7 @@ test_t tests[] = {
 #include <print/print4.def>
 #include <print/print5.def>
 #include <thread/thread1.def>
+#include <time/timeout1.def>
 #include <smpcall/smpcall1.def>
 	{
 		.name = NULL,
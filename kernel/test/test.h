@@ -61,8 +61,10 @@ extern const char *test_btree1(void);
 extern const char *test_cht1(void);
 extern const char *test_mips1(void);
 extern const char *test_fault1(void);
+extern const char *test_anon1(void);
 extern const char *test_falloc1(void);
 extern const char *test_falloc2(void);
+extern const char *test_falloc3(void);
 extern const char *test_mapping1(void);
 extern const char *test_purge1(void);
 extern const char *test_slab1(void);
@@ -75,6 +77,7 @@ extern const char *test_print3(void);
 extern const char *test_print4(void);
 extern const char *test_print5(void);
 extern const char *test_thread1(void);
+extern const char *test_timeout1(void);
 extern const char *test_smpcall1(void);
 extern const char *test_workqueue_all(void);
 extern const char *test_workqueue3(void);
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <print.h>
+#include <test.h>
+#include <arch/asm.h>
+#include <arch/cycle.h>
+#include <atomic.h>
+#include <cpu.h>
+#include <mm/slab.h>
+#include <proc/thread.h>
+#include <time/timeout.h>
+#include <typedefs.h>
+
+/** Number of timeouts kept pending during the measurement */
+#define PENDING_COUNT  100000
+
+/** Number of timeouts allocated at once */
+#define CHUNK_COUNT    1024
+#define CHUNKS         ((PENDING_COUNT + CHUNK_COUNT - 1) / CHUNK_COUNT)
+
+/** Number of timeouts registered against the full wheel */
+#define PROBE_COUNT    1000
+
+/** Pending timeouts expire 100 to 1000 seconds in the future. */
+#define PENDING_MIN    100000000
+#define PENDING_SPAN   900000000
+
+/**
+ * Number and spacing of the timeouts which are let to expire. They span
+ * several slots of the second wheel level, so they need to be cascaded.
+ */
+#define EXPIRE_COUNT   16
+#define EXPIRE_STEP    130000
+
+/** Number of clock ticks a timeout may expire late */
+#define EXPIRE_SLACK   1
+
+static timeout_t *chunks[CHUNKS];
+static timeout_t probes[PROBE_COUNT];
+static timeout_t expiring[EXPIRE_COUNT];
+static uint64_t expiring_deadline[EXPIRE_COUNT];
+static uint64_t expiring_tick[EXPIRE_COUNT];
+
+static atomic_t fired;
+
+static uint32_t seed = 1;
+
+static uint32_t random_time(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return PENDING_MIN + (seed >> 1) % PENDING_SPAN;
+}
+
+static timeout_t *pending_timeout(size_t i)
+{
+	return &chunks[i / CHUNK_COUNT][i % CHUNK_COUNT];
+}
+
+static void timeout_handler(void *arg)
+{
+	atomic_inc(&fired);
+}
+
+static void expire_handler(void *arg)
+{
+	size_t i = (size_t) arg;
+
+	expiring_tick[i] = CPU->timeout_wheel.now;
+	atomic_inc(&fired);
+}
+
+static void print_latency(const char *what, uint64_t total, uint64_t max,
+    size_t count)
+{
+	TPRINTF("%s: %" PRIu64 " cycles average, %" PRIu64 " cycles max\n",
+	    what, total / count, max);
+}
+
+/** Register timeouts and measure the latency of each registration
+ *
+ * @param timeouts Function returning the i-th timeout.
+ * @param count    Number of timeouts to register.
+ * @param what     Description of the measurement.
+ *
+ */
+static void register_timeouts(timeout_t *(*timeouts)(size_t), size_t count,
+    const char *what)
+{
+	uint64_t total = 0;
+	uint64_t max = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		timeout_t *timeout = timeouts(i);
+		uint32_t time = random_time();
+
+		uint64_t start = get_cycle();
+		timeout_register(timeout, time, timeout_handler, NULL);
+		uint64_t cycles = get_cycle() - start;
+
+		total += cycles;
+		if (cycles > max)
+			max = cycles;
+	}
+
+	print_latency(what, total, max, count);
+}
+
+/** Unregister timeouts and measure the latency of each unregistration
+ *
+ * @param timeouts Function returning the i-th timeout.
+ * @param count    Number of timeouts to unregister.
+ * @param what     Description of the measurement.
+ *
+ * @return Number of timeouts which were still pending.
+ *
+ */
+static size_t unregister_timeouts(timeout_t *(*timeouts)(size_t),
+    size_t count, const char *what)
+{
+	uint64_t total = 0;
+	uint64_t max = 0;
+	size_t pending = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		timeout_t *timeout = timeouts(i);
+
+		uint64_t start = get_cycle();
+		if (timeout_unregister(timeout))
+			pending++;
+		uint64_t cycles = get_cycle() - start;
+
+		total += cycles;
+		if (cycles > max)
+			max = cycles;
+	}
+
+	print_latency(what, total, max, count);
+	return pending;
+}
+
+static timeout_t *probe_timeout(size_t i)
+{
+	return &probes[i];
+}
+
+/** Check that short timeouts expire neither early nor late. */
+static const char *check_expire(void)
+{
+	atomic_set(&fired, 0);
+
+	for (size_t i = 0; i < EXPIRE_COUNT; i++) {
+		timeout_initialize(&expiring[i]);
+
+		/* Do not let the timeout expire before its deadline is read. */
+		ipl_t ipl = interrupts_disable();
+		timeout_register(&expiring[i], (i + 1) * EXPIRE_STEP,
+		    expire_handler, (void *) i);
+		expiring_deadline[i] = expiring[i].deadline;
+		interrupts_restore(ipl);
+	}
+
+	thread_usleep(EXPIRE_COUNT * EXPIRE_STEP + 100000);
+
+	if (atomic_get(&fired) != EXPIRE_COUNT) {
+		for (size_t i = 0; i < EXPIRE_COUNT; i++)
+			timeout_unregister(&expiring[i]);
+
+		return "Timeouts did not expire in time";
+	}
+
+	for (size_t i = 0; i < EXPIRE_COUNT; i++) {
+		if (expiring_tick[i] < expiring_deadline[i])
+			return "Timeout expired early";
+
+		if (expiring_tick[i] > expiring_deadline[i] + EXPIRE_SLACK) {
+			TPRINTF("Timeout %zu expired %" PRIu64 " ticks late\n",
+			    i, expiring_tick[i] - expiring_deadline[i]);
+			return "Timeout expired late";
+		}
+	}
+
+	return NULL;
+}
+
+const char *test_timeout1(void)
+{
+	const char *err = NULL;
+	size_t chunks_allocated;
+
+	for (chunks_allocated = 0; chunks_allocated < CHUNKS;
+	    chunks_allocated++) {
+		chunks[chunks_allocated] =
+		    malloc(CHUNK_COUNT * sizeof(timeout_t));
+		if (chunks[chunks_allocated] == NULL) {
+			err = "Unable to allocate timeouts";
+			goto out;
+		}
+	}
+
+	for (size_t i = 0; i < PENDING_COUNT; i++)
+		timeout_initialize(pending_timeout(i));
+	for (size_t i = 0; i < PROBE_COUNT; i++)
+		timeout_initialize(&probes[i]);
+
+	atomic_set(&fired, 0);
+
+	TPRINTF("Registering %d timeouts...\n", PENDING_COUNT);
+	register_timeouts(pending_timeout, PENDING_COUNT, "Fill");
+
+	TPRINTF("Registering %d timeouts with %d pending...\n", PROBE_COUNT,
+	    PENDING_COUNT);
+	register_timeouts(probe_timeout, PROBE_COUNT, "Register");
+
+	size_t pending = unregister_timeouts(probe_timeout, PROBE_COUNT,
+	    "Unregister");
+	pending += unregister_timeouts(pending_timeout, PENDING_COUNT,
+	    "Drain");
+
+	if (pending + atomic_get(&fired) != PENDING_COUNT + PROBE_COUNT)
+		err = "Lost timeouts";
+	else if (atomic_get(&fired) != 0)
+		err = "Timeouts expired early";
+
+	if (err == NULL)
+		err = check_expire();
+
+out:
+	while (chunks_allocated > 0)
+		free(chunks[--chunks_allocated]);
+
+	return err;
+}
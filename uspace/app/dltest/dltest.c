@@ -36,11 +36,18 @@
  */
 
 #include <dlfcn.h>
+#include <errno.h>
 #include <libdltest.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
+#include <str_error.h>
+#include <sys/time.h>
+#include <task.h>
+
+/** Number of program starts measured by the startup benchmark */
+#define STARTUP_RUNS  100
 
 /** libdltest library handle */
 static void *handle;
@@ -947,14 +954,88 @@ static int test_lnk(void)
 
 #endif /* DLTEST_LINKED */
 
+/** Measure how long it takes to start a dynamically linked program.
+ *
+ * The program is this very binary, started with the -s option so that
+ * it exits right after it has been loaded and linked.
+ *
+ * @param name Name this binary was started with
+ * @return Zero on success, non-zero on failure
+ */
+static int startup_bench(const char *name)
+{
+	char *path;
+	suseconds_t total = 0;
+	suseconds_t min = 0;
+	suseconds_t max = 0;
+	int len;
+
+	/* Commands started by name are looked up in /app */
+	if (name[0] == '/')
+		len = asprintf(&path, "%s", name);
+	else
+		len = asprintf(&path, "/app/%s", name);
+	if (len < 0) {
+		printf("Out of memory\n");
+		return 1;
+	}
+
+	printf("Starting '%s -s' %d times...\n", path, STARTUP_RUNS);
+
+	for (int i = 0; i < STARTUP_RUNS; i++) {
+		struct timeval start;
+		struct timeval end;
+		task_wait_t wait;
+		task_exit_t texit;
+		int retval;
+
+		gettimeofday(&start, NULL);
+
+		errno_t rc = task_spawnl(NULL, &wait, path, path, "-s", NULL);
+		if (rc != EOK) {
+			printf("FAILED to spawn '%s': %s\n", path,
+			    str_error(rc));
+			free(path);
+			return 1;
+		}
+
+		rc = task_wait(&wait, &texit, &retval);
+		if ((rc != EOK) || (texit != TASK_EXIT_NORMAL) ||
+		    (retval != 0)) {
+			printf("FAILED, '%s' did not exit normally\n", path);
+			free(path);
+			return 1;
+		}
+
+		gettimeofday(&end, NULL);
+
+		suseconds_t usec = tv_sub_diff(&end, &start);
+		total += usec;
+		if ((i == 0) || (usec < min))
+			min = usec;
+		if (usec > max)
+			max = usec;
+	}
+
+	printf("Startup time: %ld us average, %ld us min, %ld us max\n",
+	    (long) (total / STARTUP_RUNS), (long) min, (long) max);
+	free(path);
+	return 0;
+}
+
 static void print_syntax(void)
 {
-	fprintf(stderr, "syntax: dltest [-n]\n");
+	fprintf(stderr, "syntax: dltest [-n | -b | -s]\n");
 	fprintf(stderr, "\t-n Do not run dlfcn tests\n");
+	fprintf(stderr, "\t-b Measure program startup time\n");
+	fprintf(stderr, "\t-s Exit right after startup\n");
 }
 
 int main(int argc, char *argv[])
 {
+	if ((argc == 2) && (str_cmp(argv[1], "-s") == 0))
+		return 0;
+
 	printf("Dynamic linking test\n");
 
 	if (argc > 1) {
@@ -965,6 +1046,8 @@ int main(int argc, char *argv[])
 
 		if (str_cmp(argv[1], "-n") == 0) {
 			no_dlfcn = true;
+		} else if (str_cmp(argv[1], "-b") == 0) {
+			return startup_bench(argv[0]);
 		} else {
 			print_syntax();
 			return 1;
@@ -34,16 +34,24 @@
 
 #include <errno.h>
 #include <gzip.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
+/** Size of the input and output buffers */
+#define BUFFER_SIZE  65536
+
 int main(int argc, char *argv[])
 {
 	errno_t rc;
-	void *data, *ddata;
-	size_t size, dsize;
-	size_t nread, nwr;
-	long len;
+	gzip_reader_t *reader;
+	uint8_t *data;
+	void *ddata;
+	size_t size, pos;
+	size_t used, dsize;
+	size_t nwr;
+	bool eof;
 	FILE *f, *wf;
 
 	if (argc != 3) {
@@ -57,61 +65,71 @@ int main(int argc, char *argv[])
 		return 1;
 	}
 
-	if (fseek(f, 0, SEEK_END) < 0) {
-		printf("Error determining size of '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	len = ftell(f);
-	if (len < 0) {
-		printf("Error determining size of '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	if (fseek(f, 0, SEEK_SET) < 0) {
-		printf ("Error rewinding '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
-	}
-
-	data = malloc(len);
-	if (data == NULL) {
-		printf("Error allocating %ld bytes.\n", len);
+	wf = fopen(argv[2], "wb");
+	if (wf == NULL) {
+		printf("Error creating file '%s'\n", argv[2]);
 		fclose(f);
 		return 1;
 	}
 
-	nread = fread(data, 1, len, f);
-	if (nread != (size_t)len) {
-		printf("Error reading '%s'\n", argv[1]);
-		fclose(f);
-		return 1;
+	data = malloc(BUFFER_SIZE);
+	ddata = malloc(BUFFER_SIZE);
+	if ((data == NULL) || (ddata == NULL)) {
+		printf("Error allocating buffers.\n");
+		goto error;
 	}
 
-	fclose(f);
-
-	size = (size_t) len;
-
-	rc = gzip_expand(data, size, &ddata, &dsize);
+	rc = gzip_reader_create(&reader);
 	if (rc != EOK) {
-		printf("Error decompressing data.\n");
-		return 1;
+		printf("Error initializing decompression.\n");
+		goto error;
 	}
 
-	wf = fopen(argv[2], "wb");
-	if (wf == NULL) {
-		printf("Error creating file '%s'\n", argv[2]);
-		return 1;
-	}
-
-	nwr = fwrite(ddata, 1, dsize, wf);
-	if (nwr != dsize) {
-		printf("Error writing '%s'\n", argv[2]);
-		fclose(wf);
-		return 1;
-	}
+	/* Decompress the file chunk by chunk */
+	size = 0;
+	pos = 0;
+	eof = false;
+
+	do {
+		if ((pos == size) && (!eof)) {
+			size = fread(data, 1, BUFFER_SIZE, f);
+			pos = 0;
+
+			if (size == 0) {
+				if (ferror(f)) {
+					printf("Error reading '%s'\n", argv[1]);
+					goto error_reader;
+				}
+
+				eof = true;
+			}
+		}
+
+		rc = gzip_read(reader, data + pos, size - pos, &used, ddata,
+		    BUFFER_SIZE, &dsize);
+		if ((rc != EOK) && (rc != EAGAIN)) {
+			printf("Error decompressing data.\n");
+			goto error_reader;
+		}
+
+		pos += used;
+
+		nwr = fwrite(ddata, 1, dsize, wf);
+		if (nwr != dsize) {
+			printf("Error writing '%s'\n", argv[2]);
+			goto error_reader;
+		}
+
+		if ((rc == EAGAIN) && (used == 0) && (dsize == 0) && (eof)) {
+			printf("Error decompressing data (truncated).\n");
+			goto error_reader;
+		}
+	} while (rc != EOK);
+
+	gzip_reader_destroy(reader);
+	free(data);
+	free(ddata);
+	fclose(f);
 
 	if (fclose(wf) != 0) {
 		printf("Error writing '%s'\n", argv[2]);
@@ -119,6 +137,15 @@ int main(int argc, char *argv[])
 	}
 
 	return 0;
+
+error_reader:
+	gzip_reader_destroy(reader);
+error:
+	free(data);
+	free(ddata);
+	fclose(f);
+	fclose(wf);
+	return 1;
 }
 
 /** @}
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup hashsum
+ * @brief Compute and check cryptographic hashes of files.
+ * @{
+ */
+/**
+ * @file
+ */
+
+#include <crypto.h>
+#include <errno.h>
+#include <getopt.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+
+#define NAME  "hashsum"
+
+/** Size of the buffer the files are read in */
+#define BUFFER_SIZE  65536
+
+/** Maximum length of a line of checksum list */
+#define LINE_SIZE  1024
+
+typedef struct {
+	const char *name;
+	hash_func_t func;
+} hash_alg_t;
+
+static hash_alg_t hash_algs[] = {
+	{ "md5", HASH_MD5 },
+	{ "sha1", HASH_SHA1 },
+	{ "sha256", HASH_SHA256 },
+	{ "sha512", HASH_SHA512 }
+};
+
+static uint8_t *buffer;
+
+static void print_usage(void)
+{
+	printf("Usage: %s [-a <algorithm>] <file>...\n", NAME);
+	printf("       %s [-a <algorithm>] -c <list>...\n", NAME);
+	printf("Print or check cryptographic hashes of files.\n\n");
+	printf("  -a <algorithm>  md5, sha1, sha256 (default) or sha512\n");
+	printf("  -c              Check hashes listed in files "
+	    "(\"<hash>  <file>\" lines)\n");
+	printf("  -h              Print this help\n");
+}
+
+/** Find hash algorithm by name. */
+static hash_alg_t *alg_by_name(const char *name)
+{
+	for (size_t i = 0; i < sizeof(hash_algs) / sizeof(hash_alg_t); i++) {
+		if (str_cmp(hash_algs[i].name, name) == 0)
+			return &hash_algs[i];
+	}
+
+	return NULL;
+}
+
+/** Find hash algorithm by the length of its hexadecimal digest. */
+static hash_alg_t *alg_by_hex_length(size_t length)
+{
+	for (size_t i = 0; i < sizeof(hash_algs) / sizeof(hash_alg_t); i++) {
+		if (hash_algs[i].func * 2 == length)
+			return &hash_algs[i];
+	}
+
+	return NULL;
+}
+
+/** Compute hash of a file.
+ *
+ * The file is read by chunks and fed into the hash context, thus
+ * it is never held in memory as a whole.
+ *
+ * @param fname  File name.
+ * @param func   Hash function selector.
+ * @param digest Place to store the hash.
+ *
+ * @return EOK on success or an error code.
+ */
+static errno_t hash_file(const char *fname, hash_func_t func,
+    uint8_t *digest)
+{
+	hash_ctx_t ctx;
+	size_t nread;
+	FILE *f;
+
+	f = fopen(fname, "rb");
+	if (f == NULL) {
+		fprintf(stderr, "%s: Error opening '%s'.\n", NAME, fname);
+		return EIO;
+	}
+
+	hash_init(&ctx, func);
+
+	do {
+		nread = fread(buffer, 1, BUFFER_SIZE, f);
+		hash_update(&ctx, buffer, nread);
+	} while (nread == BUFFER_SIZE);
+
+	if (ferror(f)) {
+		fprintf(stderr, "%s: Error reading '%s'.\n", NAME, fname);
+		fclose(f);
+		return EIO;
+	}
+
+	fclose(f);
+	hash_final(&ctx, digest);
+	return EOK;
+}
+
+/** Convert digest to hexadecimal string. */
+static void digest_to_hex(const uint8_t *digest, size_t size, char *hex)
+{
+	static const char digits[] = "0123456789abcdef";
+
+	for (size_t i = 0; i < size; i++) {
+		hex[2 * i] = digits[digest[i] >> 4];
+		hex[2 * i + 1] = digits[digest[i] & 0x0f];
+	}
+
+	hex[2 * size] = '\0';
+}
+
+/** Print hash of a file.
+ *
+ * @return EOK on success or an error code.
+ */
+static errno_t print_hash(const char *fname, hash_func_t func)
+{
+	uint8_t digest[HASH_MAX_LENGTH];
+	char hex[2 * HASH_MAX_LENGTH + 1];
+	errno_t rc;
+
+	rc = hash_file(fname, func, digest);
+	if (rc != EOK)
+		return rc;
+
+	digest_to_hex(digest, func, hex);
+	printf("%s  %s\n", hex, fname);
+	return EOK;
+}
+
+/** Check hashes listed in a file.
+ *
+ * Each line contains the hexadecimal hash and the file name separated
+ * by two spaces (or a space and an asterisk), as produced by this tool.
+ * Without an explicit algorithm, it is derived from the length of
+ * the hash.
+ *
+ * @param lname Name of the file with the list.
+ * @param alg   Hash algorithm or @c NULL.
+ *
+ * @return EOK if all listed files match, an error code otherwise.
+ */
+static errno_t check_list(const char *lname, hash_alg_t *alg)
+{
+	uint8_t digest[HASH_MAX_LENGTH];
+	char hex[2 * HASH_MAX_LENGTH + 1];
+	char line[LINE_SIZE];
+	errno_t result = EOK;
+	FILE *f;
+
+	f = fopen(lname, "rt");
+	if (f == NULL) {
+		fprintf(stderr, "%s: Error opening '%s'.\n", NAME, lname);
+		return EIO;
+	}
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		/* Strip the line terminator */
+		size_t len = str_size(line);
+		while ((len > 0) && ((line[len - 1] == '\n') ||
+		    (line[len - 1] == '\r')))
+			line[--len] = '\0';
+
+		if (len == 0)
+			continue;
+
+		char *sep = str_chr(line, ' ');
+		if ((sep == NULL) || ((sep[1] != ' ') && (sep[1] != '*'))) {
+			fprintf(stderr, "%s: Malformed line in '%s'.\n",
+			    NAME, lname);
+			result = EINVAL;
+			continue;
+		}
+
+		*sep = '\0';
+		const char *fname = sep + 2;
+
+		hash_alg_t *line_alg = alg;
+		if (line_alg == NULL)
+			line_alg = alg_by_hex_length(str_size(line));
+
+		if ((line_alg == NULL) ||
+		    (str_size(line) != line_alg->func * 2)) {
+			fprintf(stderr, "%s: Malformed hash of '%s'.\n",
+			    NAME, fname);
+			result = EINVAL;
+			continue;
+		}
+
+		if (hash_file(fname, line_alg->func, digest) != EOK) {
+			result = EIO;
+			continue;
+		}
+
+		digest_to_hex(digest, line_alg->func, hex);
+
+		if (str_casecmp(hex, line) == 0) {
+			printf("%s: OK\n", fname);
+		} else {
+			printf("%s: FAILED\n", fname);
+			result = EINVAL;
+		}
+	}
+
+	if (ferror(f)) {
+		fprintf(stderr, "%s: Error reading '%s'.\n", NAME, lname);
+		result = EIO;
+	}
+
+	fclose(f);
+	return result;
+}
+
+int main(int argc, char *argv[])
+{
+	hash_alg_t *alg = NULL;
+	bool check = false;
+	int optres, errflg = 0;
+	errno_t rc;
+	int ret = 0;
+
+	while ((optres = getopt(argc, argv, ":a:ch")) != -1) {
+		switch (optres) {
+		case 'h':
+			print_usage();
+			return 0;
+
+		case 'a':
+			alg = alg_by_name(optarg);
+			if (alg == NULL) {
+				fprintf(stderr, "Unknown algorithm: %s\n",
+				    optarg);
+				errflg++;
+			}
+			break;
+
+		case 'c':
+			check = true;
+			break;
+
+		case ':':
+			fprintf(stderr, "Option -%c requires an operand\n",
+			    optopt);
+			errflg++;
+			break;
+
+		case '?':
+			fprintf(stderr, "Unrecognized option: -%c\n", optopt);
+			errflg++;
+			break;
+
+		default:
+			fprintf(stderr,
+			    "Unknown error while parsing command line options");
+			errflg++;
+			break;
+		}
+	}
+
+	if (optind >= argc) {
+		fprintf(stderr, "No input files\n");
+		errflg++;
+	}
+
+	if (errflg) {
+		print_usage();
+		return 1;
+	}
+
+	buffer = malloc(BUFFER_SIZE);
+	if (buffer == NULL) {
+		fprintf(stderr, "%s: Out of memory.\n", NAME);
+		return 1;
+	}
+
+	for (int i = optind; i < argc; i++) {
+		if (check)
+			rc = check_list(argv[i], alg);
+		else
+			rc = print_hash(argv[i], alg != NULL ? alg->func :
+			    HASH_SHA256);
+
+		if (rc != EOK)
+			ret = 1;
+	}
+
+	free(buffer);
+	return ret;
+}
+
+/** @}
+ */
@@ -140,7 +140,8 @@ static void list_cpus(void)
 		return;
 	}
 
-	printf("[id] [MHz     ] [busy cycles] [idle cycles]\n");
+	printf("[id] [MHz     ] [busy cycles] [idle cycles] [steals ] "
+	    "[migrated] [handoffs]\n");
 
 	size_t i;
 	for (i = 0; i < count; i++) {
@@ -152,9 +153,11 @@ static void list_cpus(void)
 			order_suffix(cpus[i].busy_cycles, &bcycles, &bsuffix);
 			order_suffix(cpus[i].idle_cycles, &icycles, &isuffix);
 
-			printf("%10" PRIu16 " %12" PRIu64 "%c %12" PRIu64 "%c\n",
+			printf("%10" PRIu16 " %12" PRIu64 "%c %12" PRIu64 "%c "
+			    "%9" PRIu64 " %10" PRIu64 " %10" PRIu64 "\n",
 			    cpus[i].frequency_mhz, bcycles, bsuffix,
-			    icycles, isuffix);
+			    icycles, isuffix, cpus[i].steals,
+			    cpus[i].migrations, cpus[i].handoffs);
 		} else
 			printf("inactive\n");
 	}
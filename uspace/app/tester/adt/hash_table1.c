@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/hash_table.h>
+#include <inttypes.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+/** Number of items inserted into the table, enough for many resizes */
+#define ITEM_COUNT  200000
+
+/** Operation latencies are counted in buckets of one microsecond */
+#define LATENCY_BUCKETS  1000
+
+typedef struct {
+	ht_link_t link;
+	size_t key;
+} item_t;
+
+/** Operation latency histogram, the last bucket counts the outliers */
+static uint64_t latency[LATENCY_BUCKETS + 1];
+
+/** Longest operation latency */
+static suseconds_t latency_max;
+
+static size_t item_key_hash(void *key)
+{
+	size_t hash = *(size_t *) key;
+
+	/* Scatter consecutive keys over the buckets. */
+	return hash * 2654435761U;
+}
+
+static size_t item_hash(const ht_link_t *link)
+{
+	item_t *item = hash_table_get_inst(link, item_t, link);
+	return item_key_hash(&item->key);
+}
+
+static bool item_key_equal(void *key, const ht_link_t *link)
+{
+	item_t *item = hash_table_get_inst(link, item_t, link);
+	return item->key == *(size_t *) key;
+}
+
+static hash_table_ops_t item_ops = {
+	.hash = item_hash,
+	.key_hash = item_key_hash,
+	.key_equal = item_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static void latency_reset(void)
+{
+	memset(latency, 0, sizeof(latency));
+	latency_max = 0;
+}
+
+static void latency_record(struct timeval *start)
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+
+	suseconds_t usec = tv_sub_diff(&now, start);
+	if (usec > latency_max)
+		latency_max = usec;
+
+	if (usec < LATENCY_BUCKETS)
+		latency[usec]++;
+	else
+		latency[LATENCY_BUCKETS]++;
+}
+
+/** Get the latency below which a fraction of samples fall
+ *
+ * @param count    Total number of samples.
+ * @param permille Fraction of samples in permille.
+ *
+ * @return Latency in microseconds, LATENCY_BUCKETS if it is larger.
+ *
+ */
+static unsigned int latency_percentile(uint64_t count, unsigned int permille)
+{
+	uint64_t limit = (count * permille + 999) / 1000;
+	uint64_t sum = 0;
+
+	for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+		sum += latency[i];
+		if (sum >= limit)
+			return i;
+	}
+
+	return LATENCY_BUCKETS;
+}
+
+static void print_percentile(const char *name, uint64_t count,
+    unsigned int permille)
+{
+	unsigned int usec = latency_percentile(count, permille);
+
+	if (usec < LATENCY_BUCKETS)
+		TPRINTF("  %s: %u us\n", name, usec);
+	else
+		TPRINTF("  %s: >= %u us\n", name, LATENCY_BUCKETS);
+}
+
+static void print_latency(const char *op)
+{
+	TPRINTF("%s latency:\n", op);
+	print_percentile("50%", ITEM_COUNT, 500);
+	print_percentile("90%", ITEM_COUNT, 900);
+	print_percentile("99%", ITEM_COUNT, 990);
+	print_percentile("99.9%", ITEM_COUNT, 999);
+	TPRINTF("  max: %ld us\n", (long) latency_max);
+}
+
+const char *test_hash_table1(void)
+{
+	hash_table_t ht;
+	struct timeval start;
+	const char *err = NULL;
+
+	item_t *items = calloc(ITEM_COUNT, sizeof(item_t));
+	if (items == NULL)
+		return "Failed to allocate items";
+
+	if (!hash_table_create(&ht, 0, 0, &item_ops)) {
+		free(items);
+		return "Failed to create hash table";
+	}
+
+	TPRINTF("Inserting %d items...\n", ITEM_COUNT);
+	latency_reset();
+
+	for (size_t i = 0; i < ITEM_COUNT; i++) {
+		items[i].key = i;
+
+		gettimeofday(&start, NULL);
+		hash_table_insert(&ht, &items[i].link);
+		latency_record(&start);
+	}
+
+	print_latency("Insert");
+
+	TPRINTF("Looking up %d items...\n", ITEM_COUNT);
+	latency_reset();
+
+	for (size_t i = 0; i < ITEM_COUNT; i++) {
+		gettimeofday(&start, NULL);
+		ht_link_t *link = hash_table_find(&ht, &i);
+		latency_record(&start);
+
+		if (link != &items[i].link) {
+			err = "Item not found";
+			goto out;
+		}
+	}
+
+	print_latency("Lookup");
+
+	TPRINTF("Removing %d items...\n", ITEM_COUNT);
+	latency_reset();
+
+	for (size_t i = 0; i < ITEM_COUNT; i++) {
+		gettimeofday(&start, NULL);
+		size_t removed = hash_table_remove(&ht, &i);
+		latency_record(&start);
+
+		if (removed != 1) {
+			err = "Item not removed";
+			goto out;
+		}
+	}
+
+	print_latency("Remove");
+
+out:
+	hash_table_destroy(&ht);
+	free(items);
+	return err;
+}
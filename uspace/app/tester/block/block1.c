@@ -0,0 +1,252 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <bd_srv.h>
+#include <block.h>
+#include <errno.h>
+#include <fibril.h>
+#include <loc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <str_error.h>
+#include "../tester.h"
+
+/*
+ * The test serves a small block device from within the tester task and
+ * reads it sequentially through the libblock cache. It checks that the
+ * read-ahead covers the last block of the device and that a failed
+ * read-ahead does not fail the readers of the affected blocks.
+ */
+
+#define NAME         "tester"
+#define TEST_DEVICE  "tester/block1"
+
+#define BLOCK_SIZE   512
+#define BLOCK_COUNT  32
+
+/** Block on which the read-ahead fails or BLOCK_COUNT for none */
+static aoff64_t fail_ba;
+/** Number of failed read-ahead requests */
+static unsigned fail_cnt;
+
+static bd_srvs_t bd_srvs;
+
+static errno_t tbd_open(bd_srvs_t *, bd_srv_t *);
+static errno_t tbd_close(bd_srv_t *);
+static errno_t tbd_read_blocks(bd_srv_t *, aoff64_t, size_t, void *, size_t);
+static errno_t tbd_write_blocks(bd_srv_t *, aoff64_t, size_t, const void *,
+    size_t);
+static errno_t tbd_get_block_size(bd_srv_t *, size_t *);
+static errno_t tbd_get_num_blocks(bd_srv_t *, aoff64_t *);
+
+static bd_ops_t tbd_ops = {
+	.open = tbd_open,
+	.close = tbd_close,
+	.read_blocks = tbd_read_blocks,
+	.write_blocks = tbd_write_blocks,
+	.get_block_size = tbd_get_block_size,
+	.get_num_blocks = tbd_get_num_blocks
+};
+
+static uint8_t block_byte(aoff64_t ba, size_t i)
+{
+	return (uint8_t) (ba * 7 + i);
+}
+
+static void tbd_client_conn(ipc_call_t *icall, void *arg)
+{
+	bd_conn(icall, &bd_srvs);
+}
+
+static errno_t tbd_open(bd_srvs_t *bds, bd_srv_t *bd)
+{
+	return EOK;
+}
+
+static errno_t tbd_close(bd_srv_t *bd)
+{
+	return EOK;
+}
+
+static errno_t tbd_read_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
+    void *buf, size_t size)
+{
+	if ((ba + cnt > BLOCK_COUNT) || (size < cnt * BLOCK_SIZE))
+		return ELIMIT;
+
+	/*
+	 * Fail the first multi-block read covering fail_ba, but only after
+	 * a while so that the reader finds the blocks being read ahead.
+	 */
+	if ((cnt > 1) && (fail_ba >= ba) && (fail_ba < ba + cnt)) {
+		fail_ba = BLOCK_COUNT;
+		fail_cnt++;
+		fibril_usleep(10000);
+		return EIO;
+	}
+
+	uint8_t *data = buf;
+	for (size_t i = 0; i < cnt * BLOCK_SIZE; i++)
+		data[i] = block_byte(ba + i / BLOCK_SIZE, i % BLOCK_SIZE);
+
+	return EOK;
+}
+
+static errno_t tbd_write_blocks(bd_srv_t *bd, aoff64_t ba, size_t cnt,
+    const void *buf, size_t size)
+{
+	return ENOTSUP;
+}
+
+static errno_t tbd_get_block_size(bd_srv_t *bd, size_t *rsize)
+{
+	*rsize = BLOCK_SIZE;
+	return EOK;
+}
+
+static errno_t tbd_get_num_blocks(bd_srv_t *bd, aoff64_t *rnb)
+{
+	*rnb = BLOCK_COUNT;
+	return EOK;
+}
+
+/** Read the whole device block by block and verify its contents. */
+static void print_stats(block_cache_stats_t *stats)
+{
+	TPRINTF("Cache hits: %" PRIu64 ", misses: %" PRIu64 "\n",
+	    stats->hits, stats->misses);
+	TPRINTF("Read-ahead: %" PRIu64 " blocks prefetched, %" PRIu64
+	    " hits\n", stats->prefetched, stats->prefetch_hits);
+	TPRINTF("Write-behind: %" PRIu64 " blocks in %" PRIu64 " writes\n",
+	    stats->wb_blocks, stats->wb_writes);
+}
+
+static const char *read_device(service_id_t sid, block_cache_stats_t *stats)
+{
+	errno_t rc = block_init(sid, BLOCK_SIZE);
+	if (rc != EOK)
+		return "Failed initializing libblock";
+
+	rc = block_cache_init(sid, BLOCK_SIZE, 0, CACHE_MODE_WT);
+	if (rc != EOK) {
+		block_fini(sid);
+		return "Failed initializing block cache";
+	}
+
+	const char *err = NULL;
+	for (aoff64_t ba = 0; ba < BLOCK_COUNT; ba++) {
+		block_t *block;
+
+		rc = block_get(&block, sid, ba, BLOCK_FLAGS_NONE);
+		if (rc != EOK) {
+			TPRINTF("Block %" PRIuOFF64 ": %s\n", ba,
+			    str_error(rc));
+			err = "Failed getting block";
+			break;
+		}
+
+		uint8_t *data = block->data;
+		for (size_t i = 0; i < BLOCK_SIZE; i++) {
+			if (data[i] != block_byte(ba, i)) {
+				err = "Block data mismatch";
+				break;
+			}
+		}
+
+		(void) block_put(block);
+		if (err != NULL)
+			break;
+
+		/* Let the read-ahead proceed as with a real consumer. */
+		fibril_yield();
+	}
+
+	rc = block_cache_get_stats(sid, stats);
+	if ((rc != EOK) && (err == NULL))
+		err = "Failed getting block cache statistics";
+
+	(void) block_cache_fini(sid);
+	block_fini(sid);
+
+	return err;
+}
+
+const char *test_block1(void)
+{
+	block_cache_stats_t stats;
+	service_id_t sid;
+	const char *err;
+
+	bd_srvs_init(&bd_srvs);
+	bd_srvs.ops = &tbd_ops;
+
+	async_set_fallback_port_handler(tbd_client_conn, NULL);
+
+	errno_t rc = loc_server_register(NAME);
+	if (rc != EOK)
+		return "Failed registering server";
+
+	rc = loc_service_register(TEST_DEVICE, &sid);
+	if (rc != EOK)
+		return "Failed registering test device";
+
+	TPRINTF("Reading the whole device...\n");
+
+	fail_ba = BLOCK_COUNT;
+	err = read_device(sid, &stats);
+	if (err != NULL)
+		goto out;
+
+	print_stats(&stats);
+
+	/* All but the blocks which trigger the read-ahead are prefetched. */
+	if (stats.prefetch_hits != BLOCK_COUNT - 3) {
+		err = "Read-ahead did not cover the device";
+		goto out;
+	}
+
+	TPRINTF("Reading the device with a failing read-ahead...\n");
+
+	fail_ba = BLOCK_COUNT / 2;
+	fail_cnt = 0;
+	err = read_device(sid, &stats);
+	if (err != NULL)
+		goto out;
+
+	if (fail_cnt != 1) {
+		err = "Read-ahead failure not injected";
+		goto out;
+	}
+
+	print_stats(&stats);
+
+out:
+	(void) loc_service_unregister(sid);
+	return err;
+}
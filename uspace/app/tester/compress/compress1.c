@@ -0,0 +1,341 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <deflate.h>
+#include <gzip.h>
+#include <inflate.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+/** Size of each corpus file */
+#define CORPUS_SIZE  (1024 * 1024)
+
+/** Size of the chunks passed to the streaming API */
+#define CHUNK_SIZE  16384
+
+typedef enum {
+	CORPUS_TEXT,
+	CORPUS_RECORDS,
+	CORPUS_RANDOM
+} corpus_t;
+
+static const char *corpus_names[] = {
+	"text",
+	"records",
+	"random"
+};
+
+static const char *words[] = {
+	"the", "kernel", "task", "thread", "fibril", "server", "driver",
+	"message", "session", "exchange", "answer", "call", "page", "frame",
+	"address", "space", "of", "and", "to", "is", "a", "in", "file",
+	"system", "block", "device", "service", "location", "naming"
+};
+
+static unsigned int levels[] = {
+	DEFLATE_LEVEL_STORE,
+	DEFLATE_LEVEL_FAST,
+	DEFLATE_LEVEL_DEFAULT,
+	DEFLATE_LEVEL_MAX
+};
+
+/*
+ * Raw deflate stream which repeats "ABC...X" up to 32773 bytes and ends
+ * with a 12 byte match at distance 32761. The source of that match wraps
+ * around the end of the window right behind the destination.
+ */
+static const uint8_t wrap_head[] = {
+	0x73, 0x74, 0x72, 0x76, 0x71, 0x75, 0x73, 0xf7, 0xf0, 0xf4, 0xf2,
+	0xf6, 0xf1, 0xf5, 0xf3, 0x0f, 0x08, 0x0c, 0x0a, 0x0e, 0x09, 0x0d,
+	0x0b, 0x8f, 0x18
+};
+
+/** Pair of bytes repeated WRAP_REPEAT times after wrap_head */
+static const uint8_t wrap_body[] = { 0x15, 0x1f };
+
+static const uint8_t wrap_tail[] = {
+	0x71, 0xe2, 0xc8, 0x17, 0xff, 0x03, 0x00
+};
+
+#define WRAP_REPEAT  126
+#define WRAP_PERIOD  24
+#define WRAP_LEN     12
+#define WRAP_DIST    32761
+#define WRAP_SIZE    (32773 + WRAP_LEN)
+
+static uint32_t corpus_seed;
+
+/** Linear congruential generator (the corpus must be reproducible). */
+static uint32_t corpus_rand(void)
+{
+	corpus_seed = corpus_seed * 1103515245 + 12345;
+	return corpus_seed >> 8;
+}
+
+/** Generate the fixed corpus. */
+static void corpus_generate(corpus_t corpus, uint8_t *buf, size_t size)
+{
+	size_t pos = 0;
+
+	corpus_seed = corpus;
+
+	switch (corpus) {
+	case CORPUS_TEXT:
+		/* Word salad with line breaks */
+		while (pos < size) {
+			const char *word =
+			    words[corpus_rand() % ARRAY_SIZE(words)];
+
+			while ((*word != 0) && (pos < size))
+				buf[pos++] = *word++;
+
+			if (pos < size)
+				buf[pos++] =
+				    (corpus_rand() % 12 == 0) ? '\n' : ' ';
+		}
+		break;
+	case CORPUS_RECORDS:
+		/* Fixed-size binary records with slowly changing fields */
+		while (pos < size) {
+			uint32_t record[4];
+
+			record[0] = pos / 16;
+			record[1] = 0x48454c4e;
+			record[2] = corpus_rand() % 64;
+			record[3] = (pos / 4096) * 7;
+
+			size_t len = min(sizeof(record), size - pos);
+			memcpy(buf + pos, record, len);
+			pos += len;
+		}
+		break;
+	case CORPUS_RANDOM:
+		/* Incompressible data */
+		while (pos < size)
+			buf[pos++] = corpus_rand() & 0xff;
+		break;
+	}
+}
+
+/** Compress the data in chunks. */
+static errno_t compress_chunks(unsigned int level, uint8_t *src, size_t size,
+    uint8_t *dest, size_t destsize, size_t *destlen)
+{
+	gzip_writer_t *writer;
+	size_t inpos = 0;
+	size_t outpos = 0;
+	errno_t rc;
+
+	rc = gzip_writer_create(level, &writer);
+	if (rc != EOK)
+		return rc;
+
+	do {
+		size_t inlen = min(size - inpos, (size_t) CHUNK_SIZE);
+		size_t outlen = min(destsize - outpos, (size_t) CHUNK_SIZE);
+		size_t used;
+		size_t produced;
+
+		if (outlen == 0) {
+			rc = ENOMEM;
+			break;
+		}
+
+		rc = gzip_write(writer, src + inpos, inlen, &used,
+		    dest + outpos, outlen, &produced, inpos + inlen == size);
+		inpos += used;
+		outpos += produced;
+	} while (rc == EAGAIN);
+
+	gzip_writer_destroy(writer);
+
+	*destlen = outpos;
+	return rc;
+}
+
+/** Decompress the data in chunks. */
+static errno_t expand_chunks(uint8_t *src, size_t size, uint8_t *dest,
+    size_t destsize, size_t *destlen)
+{
+	gzip_reader_t *reader;
+	size_t inpos = 0;
+	size_t outpos = 0;
+	errno_t rc;
+
+	rc = gzip_reader_create(&reader);
+	if (rc != EOK)
+		return rc;
+
+	do {
+		size_t inlen = min(size - inpos, (size_t) CHUNK_SIZE);
+		size_t outlen = min(destsize - outpos, (size_t) CHUNK_SIZE);
+		size_t used;
+		size_t produced;
+
+		rc = gzip_read(reader, src + inpos, inlen, &used,
+		    dest + outpos, outlen, &produced);
+		inpos += used;
+		outpos += produced;
+
+		if ((rc == EAGAIN) && (used == 0) && (produced == 0)) {
+			rc = ELIMIT;
+			break;
+		}
+	} while (rc == EAGAIN);
+
+	gzip_reader_destroy(reader);
+
+	*destlen = outpos;
+	return rc;
+}
+
+/** Inflate a match whose source wraps around the end of the window. */
+static const char *test_window_wrap(void)
+{
+	uint8_t src[sizeof(wrap_head) + WRAP_REPEAT * sizeof(wrap_body) +
+	    sizeof(wrap_tail)];
+	size_t srclen = 0;
+
+	memcpy(src, wrap_head, sizeof(wrap_head));
+	srclen += sizeof(wrap_head);
+	for (size_t i = 0; i < WRAP_REPEAT; i++) {
+		memcpy(src + srclen, wrap_body, sizeof(wrap_body));
+		srclen += sizeof(wrap_body);
+	}
+	memcpy(src + srclen, wrap_tail, sizeof(wrap_tail));
+	srclen += sizeof(wrap_tail);
+
+	uint8_t *out = malloc(WRAP_SIZE);
+	if (out == NULL)
+		return "Failed allocating buffer";
+
+	const char *err = NULL;
+	if (inflate(src, srclen, out, WRAP_SIZE) != EOK) {
+		err = "Failed inflating wrapped match";
+		goto out;
+	}
+
+	for (size_t i = 0; i < WRAP_SIZE; i++) {
+		size_t pos = (i < WRAP_SIZE - WRAP_LEN) ? i : i - WRAP_DIST;
+		if (out[i] != 'A' + pos % WRAP_PERIOD) {
+			err = "Wrapped match mismatch";
+			break;
+		}
+	}
+
+out:
+	free(out);
+	return err;
+}
+
+static uint64_t rate(size_t size, uint64_t usecs)
+{
+	if (usecs == 0)
+		usecs = 1;
+
+	return (uint64_t) size * 1000000 / usecs / 1024;
+}
+
+const char *test_compress1(void)
+{
+	size_t bufsize = CORPUS_SIZE + CORPUS_SIZE / 512 + 128;
+	uint8_t *data = malloc(CORPUS_SIZE);
+	uint8_t *comp = malloc(bufsize);
+	uint8_t *out = malloc(CORPUS_SIZE);
+	const char *err = NULL;
+	struct timeval start;
+	struct timeval now;
+	size_t complen;
+	size_t outlen;
+	uint64_t cusecs;
+	uint64_t dusecs;
+	errno_t rc;
+
+	if ((data == NULL) || (comp == NULL) || (out == NULL)) {
+		err = "Failed allocating buffers";
+		goto out;
+	}
+
+	err = test_window_wrap();
+	if (err != NULL)
+		goto out;
+
+	for (size_t i = 0; i < ARRAY_SIZE(corpus_names); i++) {
+		corpus_generate(i, data, CORPUS_SIZE);
+
+		for (size_t j = 0; j < ARRAY_SIZE(levels); j++) {
+			gettimeofday(&start, NULL);
+			rc = compress_chunks(levels[j], data, CORPUS_SIZE, comp,
+			    bufsize, &complen);
+			gettimeofday(&now, NULL);
+			cusecs = tv_sub_diff(&now, &start);
+
+			if (rc != EOK) {
+				err = "Failed compressing data";
+				goto out;
+			}
+
+			gettimeofday(&start, NULL);
+			rc = expand_chunks(comp, complen, out, CORPUS_SIZE,
+			    &outlen);
+			gettimeofday(&now, NULL);
+			dusecs = tv_sub_diff(&now, &start);
+
+			if (rc != EOK) {
+				err = "Failed decompressing data";
+				goto out;
+			}
+
+			if ((outlen != CORPUS_SIZE) ||
+			    (memcmp(data, out, CORPUS_SIZE) != 0)) {
+				err = "Round trip mismatch";
+				goto out;
+			}
+
+			TPRINTF("%-8s level %u: %zu -> %zu B (%zu%%), "
+			    "deflate %" PRIu64 " KiB/s, inflate %" PRIu64
+			    " KiB/s\n", corpus_names[i], levels[j],
+			    (size_t) CORPUS_SIZE, complen,
+			    complen * 100 / CORPUS_SIZE,
+			    rate(CORPUS_SIZE, cusecs),
+			    rate(CORPUS_SIZE, dusecs));
+		}
+	}
+
+out:
+	free(data);
+	free(comp);
+	free(out);
+	return err;
+}
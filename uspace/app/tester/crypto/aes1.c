@@ -0,0 +1,187 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <crypto.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+/** Size of the benchmark buffer */
+#define BUFFER_SIZE  (1024 * 1024)
+
+/** Number of passes over the buffer */
+#define PASSES  4
+
+typedef enum {
+	MODE_LEGACY,
+	MODE_BLOCK,
+	MODE_CBC_ENCRYPT,
+	MODE_CBC_DECRYPT,
+	MODE_CTR
+} bench_mode_t;
+
+static const char *mode_names[] = {
+	"legacy",
+	"block",
+	"cbc-enc",
+	"cbc-dec",
+	"ctr"
+};
+
+static const char *impl_names[] = {
+	"table",
+	"aes-ni"
+};
+
+static uint8_t key[AES_CIPHER_LENGTH] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+/** Compute throughput in MiB/s. */
+static uint64_t rate(uint64_t size, uint64_t usecs)
+{
+	if (usecs == 0)
+		usecs = 1;
+
+	return size * 1000000 / usecs / (1024 * 1024);
+}
+
+/** Process the buffer once in given mode. */
+static errno_t run_mode(aes_ctx_t *ctx, bench_mode_t mode, uint8_t *buf)
+{
+	uint8_t iv[AES_CIPHER_LENGTH];
+	errno_t rc;
+
+	memset(iv, 0, sizeof(iv));
+
+	switch (mode) {
+	case MODE_LEGACY:
+		/* Expands the key for each block */
+		for (size_t off = 0; off < BUFFER_SIZE;
+		    off += AES_CIPHER_LENGTH) {
+			rc = aes_encrypt(key, buf + off, buf + off);
+			if (rc != EOK)
+				return rc;
+		}
+		break;
+	case MODE_BLOCK:
+		for (size_t off = 0; off < BUFFER_SIZE;
+		    off += AES_CIPHER_LENGTH)
+			aes_encrypt_block(ctx, buf + off, buf + off);
+		break;
+	case MODE_CBC_ENCRYPT:
+		return aes_cbc_encrypt(ctx, iv, buf, buf, BUFFER_SIZE);
+	case MODE_CBC_DECRYPT:
+		return aes_cbc_decrypt(ctx, iv, buf, buf, BUFFER_SIZE);
+	case MODE_CTR:
+		aes_ctr(ctx, iv, buf, buf, BUFFER_SIZE);
+		break;
+	}
+
+	return EOK;
+}
+
+const char *test_aes1(void)
+{
+	uint8_t *buf = malloc(BUFFER_SIZE);
+	uint8_t *ref = malloc(BUFFER_SIZE);
+	const char *err = NULL;
+	struct timeval start;
+	struct timeval now;
+	aes_ctx_t ctx;
+	uint8_t iv[AES_CIPHER_LENGTH];
+	errno_t rc;
+
+	if ((buf == NULL) || (ref == NULL)) {
+		err = "Failed allocating buffers";
+		goto out;
+	}
+
+	for (size_t i = 0; i < BUFFER_SIZE; i++)
+		ref[i] = i * 7 + (i >> 8);
+
+	for (size_t i = 0; i < ARRAY_SIZE(impl_names); i++) {
+		rc = aes_init_impl(&ctx, key, i);
+		if (rc == ENOTSUP) {
+			TPRINTF("%-6s not supported\n", impl_names[i]);
+			continue;
+		}
+
+		if (rc != EOK) {
+			err = "Failed initializing AES context";
+			goto out;
+		}
+
+		/* Sanity check: CBC round trip */
+		memcpy(buf, ref, BUFFER_SIZE);
+		memset(iv, 0, sizeof(iv));
+		rc = aes_cbc_encrypt(&ctx, iv, buf, buf, BUFFER_SIZE);
+		if (rc == EOK) {
+			memset(iv, 0, sizeof(iv));
+			rc = aes_cbc_decrypt(&ctx, iv, buf, buf, BUFFER_SIZE);
+		}
+
+		if ((rc != EOK) || (memcmp(buf, ref, BUFFER_SIZE) != 0)) {
+			err = "CBC round trip mismatch";
+			goto out;
+		}
+
+		for (size_t j = 0; j < ARRAY_SIZE(mode_names); j++) {
+			/* The legacy function does not depend on context */
+			if ((j == MODE_LEGACY) && (i != AES_IMPL_TABLE))
+				continue;
+
+			gettimeofday(&start, NULL);
+
+			for (size_t k = 0; k < PASSES; k++) {
+				rc = run_mode(&ctx, j, buf);
+				if (rc != EOK) {
+					err = "Failed processing data";
+					goto out;
+				}
+			}
+
+			gettimeofday(&now, NULL);
+
+			TPRINTF("%-6s %-8s %" PRIu64 " MiB/s\n", impl_names[i],
+			    mode_names[j], rate((uint64_t) BUFFER_SIZE * PASSES,
+			    tv_sub_diff(&now, &start)));
+		}
+	}
+
+out:
+	free(buf);
+	free(ref);
+	return err;
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <crypto.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+/** Size of the benchmark buffer */
+#define BUFFER_SIZE  (1024 * 1024)
+
+/** Size of the chunks the buffer is fed in */
+#define CHUNK_SIZE  4096
+
+/** Number of passes over the buffer */
+#define PASSES  4
+
+static const struct {
+	const char *name;
+	hash_func_t func;
+} hash_funcs[] = {
+	{ "md5", HASH_MD5 },
+	{ "sha1", HASH_SHA1 },
+	{ "sha256", HASH_SHA256 },
+	{ "sha512", HASH_SHA512 }
+};
+
+static const char *impl_names[] = {
+	"generic",
+	"sha-ni"
+};
+
+/** Compute throughput in MiB/s. */
+static uint64_t rate(uint64_t size, uint64_t usecs)
+{
+	if (usecs == 0)
+		usecs = 1;
+
+	return size * 1000000 / usecs / (1024 * 1024);
+}
+
+const char *test_hash1(void)
+{
+	uint8_t *buf = malloc(BUFFER_SIZE);
+	uint8_t digest[HASH_MAX_LENGTH];
+	uint8_t ref[HASH_MAX_LENGTH];
+	struct timeval start;
+	struct timeval now;
+	hash_ctx_t ctx;
+	errno_t rc;
+
+	if (buf == NULL)
+		return "Failed allocating buffer";
+
+	for (size_t i = 0; i < BUFFER_SIZE; i++)
+		buf[i] = i * 7 + (i >> 8);
+
+	for (size_t i = 0; i < ARRAY_SIZE(hash_funcs); i++) {
+		hash_func_t func = hash_funcs[i].func;
+
+		for (size_t j = 0; j < ARRAY_SIZE(impl_names); j++) {
+			rc = hash_init_impl(&ctx, func, j);
+			if (rc == ENOTSUP)
+				continue;
+
+			if (rc != EOK) {
+				free(buf);
+				return "Failed initializing hash context";
+			}
+
+			gettimeofday(&start, NULL);
+
+			for (size_t k = 0; k < PASSES; k++) {
+				for (size_t off = 0; off < BUFFER_SIZE;
+				    off += CHUNK_SIZE) {
+					hash_update(&ctx, buf + off,
+					    CHUNK_SIZE);
+				}
+			}
+
+			hash_final(&ctx, digest);
+			gettimeofday(&now, NULL);
+
+			/* All implementations must agree */
+			if (j == HASH_IMPL_GENERIC) {
+				memcpy(ref, digest, func);
+			} else if (memcmp(ref, digest, func) != 0) {
+				free(buf);
+				return "Implementations differ";
+			}
+
+			TPRINTF("%-6s %-7s %" PRIu64 " MiB/s\n",
+			    hash_funcs[i].name, impl_names[j],
+			    rate((uint64_t) BUFFER_SIZE * PASSES,
+			    tv_sub_diff(&now, &start)));
+		}
+	}
+
+	free(buf);
+	return NULL;
+}
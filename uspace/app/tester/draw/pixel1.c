@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <compose.h>
+#include <drawctx.h>
+#include <filter.h>
+#include <inttypes.h>
+#include <io/pixelmap.h>
+#include <macros.h>
+#include <mem.h>
+#include <pixconv.h>
+#include <source.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <surface.h>
+#include <sys/time.h>
+#include <transform.h>
+#include "../tester.h"
+
+/** Dimensions of the benchmark surfaces */
+#define WIDTH   512
+#define HEIGHT  256
+
+/** Number of passes over the surfaces */
+#define PASSES  8
+
+#define PIXELS  ((uint64_t) WIDTH * HEIGHT * PASSES)
+
+typedef struct {
+	const char *name;
+	double scale;
+	double angle;
+	uint8_t alpha;
+	filter_t filter;
+} transfer_case_t;
+
+static const transfer_case_t transfer_cases[] = {
+	{ "translate", 1, 0, 255, filter_nearest },
+	{ "translucent", 1, 0, 128, filter_nearest },
+	{ "scale nearest", 1.5, 0, 255, filter_nearest },
+	{ "scale bilinear", 1.5, 0, 255, filter_bilinear },
+	{ "rotate bilinear", 1, 0.3, 255, filter_bilinear }
+};
+
+/* Called through pointers, as the renderers do. */
+static compose_t volatile compose_fn = compose_over;
+static filter_t volatile filter_fn = filter_bilinear;
+static pixel2visual_t volatile pixel2visual_fn = pixel2rgb_0888;
+
+static struct timeval start;
+
+static void timer_start(void)
+{
+	gettimeofday(&start, NULL);
+}
+
+/** Stop the timer and return throughput in megapixels per second. */
+static uint64_t timer_rate(void)
+{
+	struct timeval now;
+	gettimeofday(&now, NULL);
+
+	uint64_t usecs = tv_sub_diff(&now, &start);
+	if (usecs == 0)
+		usecs = 1;
+
+	return PIXELS / usecs;
+}
+
+static void fill(pixel_t *pixels, uint32_t seed, bool mixed_alpha)
+{
+	for (size_t i = 0; i < WIDTH * HEIGHT; i++) {
+		seed = seed * 1103515245 + 12345;
+		pixel_t pixel = seed >> 4;
+
+		/* Mostly opaque or transparent, like window contents. */
+		if (mixed_alpha && (seed & 0x300) == 0)
+			pixels[i] = pixel;
+		else if (mixed_alpha && (seed & 0x300) == 0x100)
+			pixels[i] = pixel & 0x00ffffff;
+		else
+			pixels[i] = pixel | 0xff000000;
+	}
+}
+
+static const char *bench_compose(pixel_t *src, pixel_t *dst, pixel_t *ref)
+{
+	fill(src, 1, true);
+
+	fill(ref, 2, false);
+	timer_start();
+	for (size_t pass = 0; pass < PASSES; pass++) {
+		for (size_t i = 0; i < WIDTH * HEIGHT; i++)
+			ref[i] = compose_fn(src[i], ref[i]);
+	}
+	uint64_t pixel_rate = timer_rate();
+
+	fill(dst, 2, false);
+	timer_start();
+	for (size_t pass = 0; pass < PASSES; pass++) {
+		for (size_t y = 0; y < HEIGHT; y++) {
+			compose_row_over(dst + y * WIDTH, src + y * WIDTH,
+			    WIDTH);
+		}
+	}
+	uint64_t row_rate = timer_rate();
+
+	if (memcmp(dst, ref, WIDTH * HEIGHT * sizeof(pixel_t)) != 0)
+		return "Row composition differs from per-pixel composition";
+
+	TPRINTF("%-16s %6" PRIu64 " Mpx/s per pixel, %6" PRIu64
+	    " Mpx/s per row\n", "compose over", pixel_rate, row_rate);
+	return NULL;
+}
+
+static void bench_filter(pixel_t *src, pixel_t *dst)
+{
+	pixelmap_t pixmap = {
+		.width = WIDTH,
+		.height = HEIGHT,
+		.data = src
+	};
+
+	fill(src, 3, false);
+
+	timer_start();
+	for (size_t pass = 0; pass < PASSES; pass++) {
+		for (size_t y = 0; y < HEIGHT; y++) {
+			for (size_t x = 0; x < WIDTH; x++) {
+				dst[y * WIDTH + x] = filter_fn(&pixmap,
+				    x * 0.75, y * 0.75,
+				    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
+			}
+		}
+	}
+	uint64_t pixel_rate = timer_rate();
+
+	timer_start();
+	for (size_t pass = 0; pass < PASSES; pass++) {
+		for (size_t y = 0; y < HEIGHT; y++) {
+			filter_bilinear_row(&pixmap, 0, y * 0.75, 0.75, 0,
+			    PIXELMAP_EXTEND_TRANSPARENT_SIDES, dst + y * WIDTH,
+			    WIDTH);
+		}
+	}
+	uint64_t row_rate = timer_rate();
+
+	TPRINTF("%-16s %6" PRIu64 " Mpx/s per pixel, %6" PRIu64
+	    " Mpx/s per row\n", "filter bilinear", pixel_rate, row_rate);
+}
+
+static const char *bench_pixconv(pixel_t *src, pixel_t *dst, pixel_t *ref)
+{
+	fill(src, 4, false);
+
+	timer_start();
+	for (size_t pass = 0; pass < PASSES; pass++) {
+		for (size_t i = 0; i < WIDTH * HEIGHT; i++)
+			pixel2visual_fn(&ref[i], src[i]);
+	}
+	uint64_t pixel_rate = timer_rate();
+
+	timer_start();
+	for (size_t pass = 0; pass < PASSES; pass++) {
+		for (size_t y = 0; y < HEIGHT; y++) {
+			pixel2rgb_0888_row(dst + y * WIDTH, src + y * WIDTH,
+			    WIDTH);
+		}
+	}
+	uint64_t row_rate = timer_rate();
+
+	if (memcmp(dst, ref, WIDTH * HEIGHT * sizeof(pixel_t)) != 0)
+		return "Row conversion differs from per-pixel conversion";
+
+	TPRINTF("%-16s %6" PRIu64 " Mpx/s per pixel, %6" PRIu64
+	    " Mpx/s per row\n", "pixconv 0888", pixel_rate, row_rate);
+	return NULL;
+}
+
+static void bench_transfer(surface_t *texture, surface_t *target,
+    const transfer_case_t *tcase)
+{
+	transform_t transform;
+	transform_identity(&transform);
+	transform_translate(&transform, 3, 2);
+	transform_rotate(&transform, tcase->angle);
+	transform_scale(&transform, tcase->scale, tcase->scale);
+
+	source_t source;
+	source_init(&source);
+	source_set_transform(&source, transform);
+	source_set_texture(&source, texture,
+	    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
+	source_set_filter(&source, tcase->filter);
+	source_set_alpha(&source, PIXEL(tcase->alpha, 0, 0, 0));
+
+	drawctx_t context;
+	drawctx_init(&context, target);
+	drawctx_set_compose(&context, compose_over);
+	drawctx_set_source(&context, &source);
+
+	timer_start();
+	for (size_t pass = 0; pass < PASSES; pass++)
+		drawctx_transfer(&context, 0, 0, WIDTH, HEIGHT);
+	uint64_t transfer_rate = timer_rate();
+
+	TPRINTF("%-16s %6" PRIu64 " Mpx/s\n", tcase->name, transfer_rate);
+}
+
+const char *test_pixel1(void)
+{
+	const char *err = NULL;
+	size_t size = WIDTH * HEIGHT * sizeof(pixel_t);
+
+	pixel_t *src = malloc(size);
+	pixel_t *dst = malloc(size);
+	pixel_t *ref = malloc(size);
+	surface_t *texture = surface_create(WIDTH, HEIGHT, NULL,
+	    SURFACE_FLAG_NONE);
+	surface_t *target = surface_create(WIDTH, HEIGHT, NULL,
+	    SURFACE_FLAG_NONE);
+
+	if ((src == NULL) || (dst == NULL) || (ref == NULL) ||
+	    (texture == NULL) || (target == NULL)) {
+		err = "Failed allocating buffers";
+		goto out;
+	}
+
+	err = bench_compose(src, dst, ref);
+	if (err != NULL)
+		goto out;
+
+	bench_filter(src, dst);
+
+	err = bench_pixconv(src, dst, ref);
+	if (err != NULL)
+		goto out;
+
+	fill(surface_direct_access(texture), 5, true);
+	fill(surface_direct_access(target), 6, false);
+
+	for (size_t i = 0; i < ARRAY_SIZE(transfer_cases); i++)
+		bench_transfer(texture, target, &transfer_cases[i]);
+
+out:
+	if (target != NULL)
+		surface_destroy(target);
+	if (texture != NULL)
+		surface_destroy(texture);
+	free(ref);
+	free(dst);
+	free(src);
+	return err;
+}
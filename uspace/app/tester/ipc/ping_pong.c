@@ -32,11 +32,51 @@
 #include <ns.h>
 #include <async.h>
 #include <errno.h>
+#include <mem.h>
 #include "../tester.h"
 
 #define DURATION_SECS      10
 #define COUNT_GRANULARITY  100
 
+/** Round trip latencies are counted in buckets of one microsecond */
+#define LATENCY_BUCKETS  1000
+
+/** Round trip latency histogram, the last bucket counts the outliers */
+static uint64_t latency[LATENCY_BUCKETS + 1];
+
+/** Get the round trip latency below which a fraction of samples fall
+ *
+ * @param count    Total number of samples.
+ * @param permille Fraction of samples in permille.
+ *
+ * @return Latency in microseconds, LATENCY_BUCKETS if it is larger.
+ *
+ */
+static unsigned int latency_percentile(uint64_t count, unsigned int permille)
+{
+	uint64_t limit = (count * permille + 999) / 1000;
+	uint64_t sum = 0;
+
+	for (unsigned int i = 0; i < LATENCY_BUCKETS; i++) {
+		sum += latency[i];
+		if (sum >= limit)
+			return i;
+	}
+
+	return LATENCY_BUCKETS;
+}
+
+static void print_percentile(const char *name, uint64_t count,
+    unsigned int permille)
+{
+	unsigned int usec = latency_percentile(count, permille);
+
+	if (usec < LATENCY_BUCKETS)
+		TPRINTF("  %s: %u us\n", name, usec);
+	else
+		TPRINTF("  %s: >= %u us\n", name, LATENCY_BUCKETS);
+}
+
 const char *test_ping_pong(void)
 {
 	TPRINTF("Pinging ns server for %d seconds...", DURATION_SECS);
@@ -44,7 +84,10 @@ const char *test_ping_pong(void)
 	struct timeval start;
 	gettimeofday(&start, NULL);
 
+	memset(latency, 0, sizeof(latency));
+
 	uint64_t count = 0;
+	suseconds_t max = 0;
 	while (true) {
 		struct timeval now;
 		gettimeofday(&now, NULL);
@@ -54,12 +97,26 @@ const char *test_ping_pong(void)
 
 		size_t i;
 		for (i = 0; i < COUNT_GRANULARITY; i++) {
+			struct timeval sent;
+			gettimeofday(&sent, NULL);
+
 			errno_t retval = ns_ping();
 
+			gettimeofday(&now, NULL);
+
 			if (retval != EOK) {
 				TPRINTF("\n");
 				return "Failed to send ping message";
 			}
+
+			suseconds_t usec = tv_sub_diff(&now, &sent);
+			if (usec > max)
+				max = usec;
+
+			if (usec < LATENCY_BUCKETS)
+				latency[usec]++;
+			else
+				latency[LATENCY_BUCKETS]++;
 		}
 
 		count += COUNT_GRANULARITY;
@@ -68,5 +125,12 @@ const char *test_ping_pong(void)
 	TPRINTF("OK\nCompleted %" PRIu64 " round trips in %u seconds, %" PRIu64 " rt/s.\n",
 	    count, DURATION_SECS, count / DURATION_SECS);
 
+	TPRINTF("Round trip latency:\n");
+	print_percentile("50%", count, 500);
+	print_percentile("90%", count, 900);
+	print_percentile("99%", count, 990);
+	print_percentile("99.9%", count, 999);
+	TPRINTF("  max: %ld us\n", (long) max);
+
 	return NULL;
 }
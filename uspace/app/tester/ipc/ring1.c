@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <async.h>
+#include <errno.h>
+#include <ipc/ipc_test.h>
+#include <ipc/services.h>
+#include <loc.h>
+#include <macros.h>
+#include <mem.h>
+#include <shmring.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+#define RING_SLOTS  64
+#define RING_ARENA  (1024 * 1024)
+
+/** Amount of data transferred for each payload size */
+#define TOTAL_BYTES  (32 * 1024 * 1024)
+
+static size_t payload_sizes[] = {
+	512,
+	4096,
+	DATA_XFER_LIMIT,
+	4 * DATA_XFER_LIMIT
+};
+
+/** Send payload by IPC_M_DATA_WRITE in chunks of at most DATA_XFER_LIMIT. */
+static errno_t copy_send(async_sess_t *sess, const uint8_t *buf, size_t size)
+{
+	async_exch_t *exch;
+	size_t off;
+	size_t chunk;
+	errno_t retval;
+	errno_t rc;
+	aid_t req;
+
+	exch = async_exchange_begin(sess);
+
+	for (off = 0; off < size; off += chunk) {
+		chunk = min(size - off, DATA_XFER_LIMIT);
+
+		req = async_send_0(exch, IPC_TEST_DATA_WRITE, NULL);
+		rc = async_data_write_start(exch, buf + off, chunk);
+		if (rc != EOK) {
+			async_forget(req);
+			async_exchange_end(exch);
+			return rc;
+		}
+
+		async_wait_for(req, &retval);
+		if (retval != EOK) {
+			async_exchange_end(exch);
+			return retval;
+		}
+	}
+
+	async_exchange_end(exch);
+	return EOK;
+}
+
+static errno_t ring_setup(async_sess_t *sess, shmring_t *ring)
+{
+	async_exch_t *exch;
+	errno_t retval;
+	errno_t rc;
+	aid_t req;
+
+	exch = async_exchange_begin(sess);
+	req = async_send_0(exch, IPC_TEST_RING_SETUP, NULL);
+	rc = shmring_share(ring, exch);
+	async_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	async_wait_for(req, &retval);
+	if (retval != EOK)
+		return retval;
+
+	shmring_set_notify(ring, sess, IPC_TEST_RING_NOTIFY, 0);
+	return EOK;
+}
+
+static errno_t get_checksum(async_sess_t *sess, sysarg_t *checksum)
+{
+	async_exch_t *exch;
+	errno_t rc;
+
+	exch = async_exchange_begin(sess);
+	rc = async_req_0_1(exch, IPC_TEST_GET_CHECKSUM, checksum);
+	async_exchange_end(exch);
+
+	return rc;
+}
+
+static void print_rate(const char *name, size_t size, size_t count,
+    struct timeval *start)
+{
+	struct timeval now;
+	uint64_t usecs;
+	uint64_t bytes = (uint64_t) size * count;
+
+	gettimeofday(&now, NULL);
+	usecs = tv_sub_diff(&now, start);
+	if (usecs == 0)
+		usecs = 1;
+
+	TPRINTF("%s: %zu x %zu B in %" PRIu64 " us, %" PRIu64 " KiB/s\n",
+	    name, count, size, usecs, bytes * 1000000 / usecs / 1024);
+}
+
+/** Run one payload size through both paths and compare checksums. */
+static const char *bench_size(async_sess_t *sess, shmring_t *ring,
+    uint8_t *buf, size_t size)
+{
+	struct timeval start;
+	sysarg_t expected = 0;
+	sysarg_t checksum;
+	size_t count = TOTAL_BYTES / size;
+	void *rbuf;
+	size_t i;
+	errno_t rc;
+
+	for (i = 0; i < count; i++)
+		expected += (sysarg_t) (i & 0xff) * size;
+
+	/* Copy path */
+	gettimeofday(&start, NULL);
+	for (i = 0; i < count; i++) {
+		memset(buf, i & 0xff, size);
+		rc = copy_send(sess, buf, size);
+		if (rc != EOK)
+			return "Failed sending data by IPC_M_DATA_WRITE";
+	}
+
+	print_rate("copy", size, count, &start);
+
+	rc = get_checksum(sess, &checksum);
+	if (rc != EOK)
+		return "Failed getting checksum";
+	if (checksum != expected)
+		return "Checksum mismatch on the copy path";
+
+	/* Shared memory ring */
+	gettimeofday(&start, NULL);
+	for (i = 0; i < count; i++) {
+		rc = shmring_alloc(ring, size, &rbuf);
+		if (rc != EOK)
+			return "Failed allocating ring buffer";
+
+		memset(rbuf, i & 0xff, size);
+		rc = shmring_post(ring, size, 0);
+		if (rc != EOK)
+			return "Failed posting ring buffer";
+	}
+
+	rc = shmring_flush(ring);
+	if (rc != EOK)
+		return "Failed flushing ring";
+
+	print_rate("ring", size, count, &start);
+
+	rc = get_checksum(sess, &checksum);
+	if (rc != EOK)
+		return "Failed getting checksum";
+	if (checksum != expected)
+		return "Checksum mismatch on the ring path";
+
+	return NULL;
+}
+
+const char *test_ring1(void)
+{
+	service_id_t sid;
+	async_sess_t *sess;
+	shmring_t *ring;
+	uint8_t *buf;
+	const char *err = NULL;
+	size_t i;
+	errno_t rc;
+
+	rc = loc_service_get_id(SERVICE_NAME_IPC_TEST, &sid, 0);
+	if (rc != EOK)
+		return "Failed resolving " SERVICE_NAME_IPC_TEST " service";
+
+	sess = loc_service_connect(sid, INTERFACE_IPC_TEST, 0);
+	if (sess == NULL)
+		return "Failed connecting to " SERVICE_NAME_IPC_TEST " service";
+
+	buf = malloc(4 * DATA_XFER_LIMIT);
+	if (buf == NULL) {
+		async_hangup(sess);
+		return "Out of memory";
+	}
+
+	rc = shmring_create(RING_SLOTS, RING_ARENA, &ring);
+	if (rc != EOK) {
+		free(buf);
+		async_hangup(sess);
+		return "Failed creating ring";
+	}
+
+	rc = ring_setup(sess, ring);
+	if (rc != EOK) {
+		err = "Failed setting up ring";
+		goto out;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(payload_sizes); i++) {
+		err = bench_size(sess, ring, buf, payload_sizes[i]);
+		if (err != NULL)
+			break;
+	}
+
+out:
+	shmring_destroy(ring);
+	free(buf);
+	async_hangup(sess);
+	return err;
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+/*
+ * The test measures the allocator throughput with several fibrils
+ * running in parallel on separate runner threads. Each worker keeps
+ * a small working set of blocks and hands some of them over to its
+ * neighbour, so that a part of the blocks is freed by a different
+ * thread than the one which allocated them.
+ */
+
+#define MAX_WORKERS  4
+#define ROUNDS       200000
+#define SLOTS        64
+#define MAX_SIZE     1024
+
+typedef struct {
+	/** Blocks handed over by the previous worker */
+	void *handoff[SLOTS];
+
+	/** Successor in the handoff ring */
+	unsigned int next;
+
+	/** Set if the worker failed to allocate memory */
+	bool failed;
+} worker_t;
+
+static worker_t workers[MAX_WORKERS];
+
+static FIBRIL_SEMAPHORE_INITIALIZE(workers_done, 0);
+
+static errno_t malloc_worker(void *arg)
+{
+	worker_t *self = (worker_t *) arg;
+	worker_t *next = &workers[self->next];
+	void *local[SLOTS] = { NULL };
+	uint32_t seed = (uint32_t) (uintptr_t) self;
+
+	for (unsigned int i = 0; i < ROUNDS; i++) {
+		seed = seed * 1103515245 + 12345;
+
+		unsigned int slot = (seed >> 16) % SLOTS;
+		size_t size = 1 + (seed >> 4) % MAX_SIZE;
+
+		if (local[slot] != NULL) {
+			if ((seed & 0x100) != 0) {
+				/* Let the neighbour free the block. */
+				void *old = __atomic_exchange_n(&next->handoff[slot],
+				    local[slot], __ATOMIC_ACQ_REL);
+				free(old);
+			} else {
+				free(local[slot]);
+			}
+		}
+
+		local[slot] = malloc(size);
+		if (local[slot] == NULL) {
+			self->failed = true;
+			break;
+		}
+
+		*((uint8_t *) local[slot]) = (uint8_t) i;
+
+		void *remote = __atomic_exchange_n(&self->handoff[slot], NULL,
+		    __ATOMIC_ACQ_REL);
+		free(remote);
+	}
+
+	for (unsigned int slot = 0; slot < SLOTS; slot++)
+		free(local[slot]);
+
+	fibril_semaphore_up(&workers_done);
+	return EOK;
+}
+
+static const char *run_workers(unsigned int count)
+{
+	for (unsigned int i = 0; i < count; i++) {
+		for (unsigned int slot = 0; slot < SLOTS; slot++)
+			workers[i].handoff[slot] = NULL;
+
+		workers[i].next = (i + 1) % count;
+		workers[i].failed = false;
+	}
+
+	struct timeval start;
+	getuptime(&start);
+
+	for (unsigned int i = 0; i < count; i++) {
+		fid_t fid = fibril_create(malloc_worker, &workers[i]);
+		if (fid == 0)
+			return "Failed creating worker fibril";
+
+		fibril_add_ready(fid);
+	}
+
+	for (unsigned int i = 0; i < count; i++)
+		fibril_semaphore_down(&workers_done);
+
+	struct timeval end;
+	getuptime(&end);
+
+	const char *err = NULL;
+
+	for (unsigned int i = 0; i < count; i++) {
+		for (unsigned int slot = 0; slot < SLOTS; slot++)
+			free(workers[i].handoff[slot]);
+
+		if (workers[i].failed)
+			err = "Failed allocating memory";
+	}
+
+	if (err != NULL)
+		return err;
+
+	suseconds_t duration = tv_sub_diff(&end, &start);
+	if (duration <= 0)
+		duration = 1;
+
+	/* Every round consists of one allocation and (mostly) one free. */
+	uint64_t ops = 2 * (uint64_t) count * ROUNDS;
+
+	TPRINTF("%u thread(s): %" PRIu64 " ops in %ld us, %" PRIu64 " ops/s\n",
+	    count, ops, (long) duration, ops * 1000000 / duration);
+
+	return NULL;
+}
+
+const char *test_malloc4(void)
+{
+	if (fibril_test_spawn_runners(MAX_WORKERS) < MAX_WORKERS)
+		return "Failed spawning fibril runners";
+
+	for (unsigned int count = 1; count <= MAX_WORKERS; count *= 2) {
+		const char *err = run_workers(count);
+		if (err != NULL)
+			return err;
+	}
+
+	if (heap_check() != NULL)
+		return "Heap inconsistency detected";
+
+	return NULL;
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <nettl/checksum.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+/*
+ * Measures the throughput of the Internet checksum computation
+ * for buffer sizes ranging from a small packet header to the
+ * largest IP datagram and compares it with the straightforward
+ * word-by-word algorithm.
+ */
+
+#define MIN_SIZE  64
+#define MAX_SIZE  (64 * 1024)
+
+/** Amount of data to checksum for each buffer size */
+#define TOTAL_SIZE  (32 * 1024 * 1024)
+
+/** Straightforward word-by-word checksum computation. */
+static uint16_t checksum_words(uint16_t ivalue, const uint8_t *data,
+    size_t size)
+{
+	uint32_t sum = (uint16_t) ~ivalue;
+	size_t i;
+
+	for (i = 0; i + 1 < size; i += 2) {
+		sum += ((uint32_t) data[i] << 8) | data[i + 1];
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	if (size % 2 != 0) {
+		sum += (uint32_t) data[size - 1] << 8;
+		sum = (sum & 0xffff) + (sum >> 16);
+	}
+
+	return (uint16_t) ~sum;
+}
+
+/** Compute throughput in MiB/s */
+static uint64_t throughput(size_t bytes, suseconds_t duration)
+{
+	if (duration <= 0)
+		duration = 1;
+
+	return (uint64_t) bytes * 1000000 / duration / (1024 * 1024);
+}
+
+const char *test_checksum1(void)
+{
+	uint8_t *buf = malloc(MAX_SIZE);
+	if (buf == NULL)
+		return "Failed allocating buffer";
+
+	for (size_t i = 0; i < MAX_SIZE; i++)
+		buf[i] = (uint8_t) (i * 7 + (i >> 8));
+
+	TPRINTF("%8s %12s %12s\n", "size", "MiB/s", "words MiB/s");
+
+	for (size_t size = MIN_SIZE; size <= MAX_SIZE; size *= 4) {
+		size_t rounds = TOTAL_SIZE / size;
+		volatile uint16_t cs1 = 0;
+		volatile uint16_t cs2 = 0;
+		struct timeval t0, t1, t2;
+
+		getuptime(&t0);
+
+		for (size_t i = 0; i < rounds; i++)
+			cs1 = inet_checksum_calc(INET_CHECKSUM_INIT, buf, size);
+
+		getuptime(&t1);
+
+		for (size_t i = 0; i < rounds; i++)
+			cs2 = checksum_words(INET_CHECKSUM_INIT, buf, size);
+
+		getuptime(&t2);
+
+		if (cs1 != cs2) {
+			free(buf);
+			return "Checksum mismatch";
+		}
+
+		TPRINTF("%8zu %12" PRIu64 " %12" PRIu64 "\n", size,
+		    throughput(rounds * size, tv_sub_diff(&t1, &t0)),
+		    throughput(rounds * size, tv_sub_diff(&t2, &t1)));
+	}
+
+	free(buf);
+	return NULL;
+}
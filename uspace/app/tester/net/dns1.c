@@ -0,0 +1,481 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <inet/addr.h>
+#include <inet/dnsr.h>
+#include <inet/endpoint.h>
+#include <inet/udp.h>
+#include <inttypes.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdio.h>
+#include <str.h>
+#include "../tester.h"
+
+/*
+ * Points the resolver at a stand-in name server listening on the
+ * loopback interface and checks that repeated lookups are answered
+ * from the cache, that negative answers are cached, that records
+ * expire with their TTL and that concurrent identical lookups cause
+ * a single query.
+ */
+
+#define DNS_PORT  53
+
+#define MSG_MAX_SIZE  512
+
+#define HDR_SIZE  12
+
+#define LABEL_MAX_SIZE  63
+
+#define TYPE_A      1
+#define TYPE_CNAME  5
+#define TYPE_SOA    6
+
+#define RCODE_OK        0
+#define RCODE_NAME_ERR  3
+
+/** TTL and SOA minimum of negative answers (seconds) */
+#define NEG_TTL  60
+
+/** Number of concurrent lookups of the same name */
+#define CONCURRENT  8
+
+typedef struct {
+	/** Host name */
+	const char *name;
+	/** Canonical name if @c name is an alias */
+	const char *cname;
+	/** IPv4 address of the canonical name */
+	addr32_t addr;
+	/** Time to live of the records (seconds) */
+	uint32_t ttl;
+	/** Delay before answering (microseconds) */
+	suseconds_t delay;
+	/** Number of queries received */
+	unsigned int queries;
+} dns_host_t;
+
+static dns_host_t zone[] = {
+	{ "host.test", NULL, 0x0a000001, 300, 0, 0 },
+	{ "alias.test", "host.test", 0x0a000001, 300, 0, 0 },
+	{ "short.test", NULL, 0x0a000002, 1, 0, 0 },
+	{ "slow.test", NULL, 0x0a000003, 300, 500000, 0 }
+};
+
+/** Number of queries for names outside the zone */
+static unsigned int nx_queries;
+
+typedef struct {
+	uint8_t data[MSG_MAX_SIZE];
+	size_t size;
+} dns_buf_t;
+
+static void put_u16(dns_buf_t *buf, uint16_t val)
+{
+	buf->data[buf->size++] = val >> 8;
+	buf->data[buf->size++] = val & 0xff;
+}
+
+static void put_u32(dns_buf_t *buf, uint32_t val)
+{
+	put_u16(buf, val >> 16);
+	put_u16(buf, val & 0xffff);
+}
+
+static void put_name(dns_buf_t *buf, const char *name)
+{
+	while (*name != '\0') {
+		const char *dot = str_chr(name, '.');
+		size_t len = (dot != NULL) ? (size_t) (dot - name) :
+		    str_size(name);
+
+		buf->data[buf->size++] = len;
+		memcpy(buf->data + buf->size, name, len);
+		buf->size += len;
+
+		name += len;
+		if (*name == '.')
+			name++;
+	}
+
+	buf->data[buf->size++] = 0;
+}
+
+/** Start a resource record, return the offset of its RDLENGTH. */
+static size_t put_rr_start(dns_buf_t *buf, const char *name, uint16_t type,
+    uint32_t ttl)
+{
+	put_name(buf, name);
+	put_u16(buf, type);
+	put_u16(buf, 1);
+	put_u32(buf, ttl);
+
+	size_t rdlength = buf->size;
+	put_u16(buf, 0);
+	return rdlength;
+}
+
+static void put_rr_end(dns_buf_t *buf, size_t rdlength)
+{
+	size_t size = buf->size - rdlength - 2;
+
+	buf->data[rdlength] = size >> 8;
+	buf->data[rdlength + 1] = size & 0xff;
+}
+
+static void put_soa(dns_buf_t *buf)
+{
+	size_t rdlength = put_rr_start(buf, "test", TYPE_SOA, NEG_TTL);
+	put_name(buf, "ns.test");
+	put_name(buf, "admin.test");
+	put_u32(buf, 1);
+	put_u32(buf, 3600);
+	put_u32(buf, 600);
+	put_u32(buf, 86400);
+	put_u32(buf, NEG_TTL);
+	put_rr_end(buf, rdlength);
+}
+
+/** Decode the question of a query.
+ *
+ * @param query Query message
+ * @param name  Buffer for the queried name
+ * @param qtype Place to store the query type
+ *
+ * @return Size of the header and question or zero if malformed.
+ */
+static size_t get_question(dns_buf_t *query, char *name, uint16_t *qtype)
+{
+	size_t off = HDR_SIZE;
+	size_t noff = 0;
+
+	while (off < query->size && query->data[off] != 0) {
+		size_t len = query->data[off++];
+		if (len > LABEL_MAX_SIZE || off + len > query->size ||
+		    noff + len + 1 >= DNSR_NAME_MAX_SIZE)
+			return 0;
+
+		if (noff > 0)
+			name[noff++] = '.';
+
+		memcpy(name + noff, query->data + off, len);
+		noff += len;
+		off += len;
+	}
+
+	name[noff] = '\0';
+
+	if (off + 5 > query->size)
+		return 0;
+
+	*qtype = (query->data[off + 1] << 8) | query->data[off + 2];
+	return off + 5;
+}
+
+static void responder_recv_msg(udp_assoc_t *assoc, udp_rmsg_t *rmsg)
+{
+	dns_buf_t query;
+	dns_buf_t resp;
+	char name[DNSR_NAME_MAX_SIZE];
+	uint16_t qtype;
+
+	query.size = min(udp_rmsg_size(rmsg), MSG_MAX_SIZE);
+	if (udp_rmsg_read(rmsg, 0, query.data, query.size) != EOK)
+		return;
+
+	size_t qsize = get_question(&query, name, &qtype);
+	if (qsize == 0)
+		return;
+
+	dns_host_t *host = NULL;
+	for (size_t i = 0; i < ARRAY_SIZE(zone); i++) {
+		if (str_casecmp(zone[i].name, name) == 0)
+			host = &zone[i];
+	}
+
+	memcpy(resp.data, query.data, qsize);
+	resp.size = qsize;
+
+	uint8_t rcode = RCODE_OK;
+	uint16_t an_count = 0;
+	uint16_t ns_count = 0;
+
+	if (host == NULL) {
+		nx_queries++;
+		rcode = RCODE_NAME_ERR;
+		put_soa(&resp);
+		ns_count++;
+	} else {
+		host->queries++;
+
+		const char *cname = host->name;
+		if (host->cname != NULL) {
+			size_t rdlength = put_rr_start(&resp, host->name,
+			    TYPE_CNAME, host->ttl);
+			put_name(&resp, host->cname);
+			put_rr_end(&resp, rdlength);
+			an_count++;
+
+			cname = host->cname;
+		}
+
+		if (qtype == TYPE_A) {
+			size_t rdlength = put_rr_start(&resp, cname, TYPE_A,
+			    host->ttl);
+			put_u32(&resp, host->addr);
+			put_rr_end(&resp, rdlength);
+			an_count++;
+		} else {
+			/* No data of the requested type */
+			put_soa(&resp);
+			ns_count++;
+		}
+
+		if (host->delay != 0)
+			fibril_usleep(host->delay);
+	}
+
+	/* QR, opcode and RD of the query, RA and the response code */
+	resp.data[2] = 0x80 | (query.data[2] & 0x79);
+	resp.data[3] = 0x80 | rcode;
+	resp.data[4] = 0;
+	resp.data[5] = 1;
+	resp.data[6] = an_count >> 8;
+	resp.data[7] = an_count & 0xff;
+	resp.data[8] = ns_count >> 8;
+	resp.data[9] = ns_count & 0xff;
+	resp.data[10] = 0;
+	resp.data[11] = 0;
+
+	inet_ep_t remote;
+	udp_rmsg_remote_ep(rmsg, &remote);
+	(void) udp_assoc_send_msg(assoc, &remote, resp.data, resp.size);
+}
+
+static void responder_recv_err(udp_assoc_t *assoc, udp_rerr_t *rerr)
+{
+}
+
+static void responder_link_state(udp_assoc_t *assoc, udp_link_state_t ls)
+{
+}
+
+static udp_cb_t responder_cb = {
+	.recv_msg = responder_recv_msg,
+	.recv_err = responder_recv_err,
+	.link_state = responder_link_state
+};
+
+/** Resolve a name and check the result.
+ *
+ * @param name Host name
+ * @param ver  IP version
+ * @param addr Expected IPv4 address or zero if the lookup should fail
+ *
+ * @return NULL on success, error message otherwise.
+ */
+static const char *resolve(const char *name, ip_ver_t ver, addr32_t addr)
+{
+	dnsr_hostinfo_t *hinfo;
+	errno_t rc = dnsr_name2host(name, &hinfo, ver);
+
+	if (addr == 0)
+		return (rc == EOK) ? "Nonexistent name resolved" : NULL;
+
+	if (rc != EOK)
+		return "Name not resolved";
+
+	addr32_t v4;
+	ip_ver_t hver = inet_addr_get(&hinfo->addr, &v4, NULL);
+	dnsr_hostinfo_destroy(hinfo);
+
+	if (hver != ip_v4 || v4 != addr)
+		return "Name resolved to a wrong address";
+
+	return NULL;
+}
+
+static FIBRIL_MUTEX_INITIALIZE(concurrent_lock);
+static FIBRIL_CONDVAR_INITIALIZE(concurrent_cv);
+static size_t concurrent_left;
+static const char *concurrent_err;
+
+static errno_t concurrent_fibril(void *arg)
+{
+	const char *err = resolve("slow.test", ip_v4, 0x0a000003);
+
+	fibril_mutex_lock(&concurrent_lock);
+	if (err != NULL)
+		concurrent_err = err;
+	concurrent_left--;
+	fibril_mutex_unlock(&concurrent_lock);
+	fibril_condvar_broadcast(&concurrent_cv);
+
+	return EOK;
+}
+
+static const char *resolve_concurrent(void)
+{
+	concurrent_left = CONCURRENT;
+	concurrent_err = NULL;
+
+	for (size_t i = 0; i < CONCURRENT; i++) {
+		fid_t fid = fibril_create(concurrent_fibril, NULL);
+		if (fid == 0) {
+			fibril_mutex_lock(&concurrent_lock);
+			concurrent_left -= CONCURRENT - i;
+			concurrent_err = "Failed creating fibril";
+			fibril_mutex_unlock(&concurrent_lock);
+			break;
+		}
+
+		fibril_add_ready(fid);
+	}
+
+	fibril_mutex_lock(&concurrent_lock);
+	while (concurrent_left > 0)
+		fibril_condvar_wait(&concurrent_cv, &concurrent_lock);
+	fibril_mutex_unlock(&concurrent_lock);
+
+	return concurrent_err;
+}
+
+static const char *dns1_run(void)
+{
+	const char *err;
+
+	TPRINTF("Repeated lookup...\n");
+	if ((err = resolve("host.test", ip_v4, 0x0a000001)) != NULL)
+		return err;
+	if ((err = resolve("HOST.test", ip_v4, 0x0a000001)) != NULL)
+		return err;
+	if (zone[0].queries != 1)
+		return "Repeated lookup was not answered from the cache";
+
+	TPRINTF("Alias lookup...\n");
+	if ((err = resolve("alias.test", ip_v4, 0x0a000001)) != NULL)
+		return err;
+	if ((err = resolve("alias.test", ip_v4, 0x0a000001)) != NULL)
+		return err;
+	if (zone[1].queries != 1 || zone[0].queries != 1)
+		return "Alias lookup was not answered from the cache";
+
+	TPRINTF("Negative answers...\n");
+	if ((err = resolve("missing.test", ip_v4, 0)) != NULL)
+		return err;
+	if ((err = resolve("missing.test", ip_v4, 0)) != NULL)
+		return err;
+	if (nx_queries != 1)
+		return "Nonexistent name was not cached";
+
+	/* No AAAA record, the negative answer is cached as well */
+	if ((err = resolve("host.test", ip_any, 0x0a000001)) != NULL)
+		return err;
+	if ((err = resolve("host.test", ip_any, 0x0a000001)) != NULL)
+		return err;
+	if (zone[0].queries != 2)
+		return "Missing record type was not cached";
+
+	TPRINTF("Expiration...\n");
+	if ((err = resolve("short.test", ip_v4, 0x0a000002)) != NULL)
+		return err;
+	fibril_usleep(2 * 1000 * 1000);
+	if ((err = resolve("short.test", ip_v4, 0x0a000002)) != NULL)
+		return err;
+	if (zone[2].queries != 2)
+		return "Expired record was not queried again";
+
+	TPRINTF("Concurrent lookups...\n");
+	if ((err = resolve_concurrent()) != NULL)
+		return err;
+	if (zone[3].queries != 1)
+		return "Concurrent lookups were not coalesced";
+
+	return NULL;
+}
+
+const char *test_dns1(void)
+{
+	inet_addr_t saved_addr;
+	errno_t rc = dnsr_get_srvaddr(&saved_addr);
+	if (rc != EOK)
+		return "Failed getting name server address";
+
+	udp_t *udp;
+	rc = udp_create(&udp);
+	if (rc != EOK)
+		return "Failed creating UDP service";
+
+	inet_ep2_t epp;
+	inet_ep2_init(&epp);
+	epp.local.port = DNS_PORT;
+
+	udp_assoc_t *assoc;
+	rc = udp_assoc_create(udp, &epp, &responder_cb, NULL, &assoc);
+	if (rc != EOK) {
+		udp_destroy(udp);
+		return "Failed listening on the name server port";
+	}
+
+	inet_addr_t addr;
+	inet_addr(&addr, 127, 0, 0, 1);
+
+	/* Setting the server flushes the cache. */
+	const char *err = NULL;
+	rc = dnsr_set_srvaddr(&addr);
+	if (rc != EOK)
+		err = "Failed setting name server address";
+
+	dnsr_stats_t before;
+	if (err == NULL && dnsr_get_stats(&before) != EOK)
+		err = "Failed getting resolver statistics";
+
+	if (err == NULL)
+		err = dns1_run();
+
+	dnsr_stats_t after;
+	if (err == NULL && dnsr_get_stats(&after) == EOK) {
+		TPRINTF("Hits: %" PRIu64 " (negative: %" PRIu64 "), "
+		    "misses: %" PRIu64 " (coalesced: %" PRIu64 "), "
+		    "queries: %" PRIu64 ", entries: %" PRIu64 "\n",
+		    after.hits - before.hits, after.neg_hits - before.neg_hits,
+		    after.misses - before.misses,
+		    after.coalesced - before.coalesced,
+		    after.queries - before.queries, after.entries);
+	}
+
+	(void) dnsr_set_srvaddr(&saved_addr);
+	udp_assoc_destroy(assoc);
+	udp_destroy(udp);
+
+	return err;
+}
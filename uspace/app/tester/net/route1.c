@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <inet/addr.h>
+#include <nettl/rtrie.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+/*
+ * Populates a routing trie with 10000 random IPv4 and IPv6 routes and
+ * measures the longest prefix match lookup rate. The results are checked
+ * against a linear search of the route list, which is also timed for
+ * comparison.
+ */
+
+#define ROUTES    10000
+#define LOOKUPS   100000
+
+/** Number of lookups done using linear search */
+#define LINEAR_LOOKUPS  1000
+
+typedef struct {
+	/** Link to route trie */
+	link_t ltrie;
+	/** Destination network */
+	inet_naddr_t dest;
+} route_t;
+
+static route_t *routes;
+static inet_addr_t *addrs;
+static uint32_t seed = 1;
+
+static uint32_t route_rand(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return (seed >> 16) | (seed << 16);
+}
+
+/** Generate random address, biased so that the routes overlap. */
+static void random_addr(inet_addr_t *addr, bool v6)
+{
+	if (v6) {
+		inet_addr6(addr, 0x2001, 0xdb8, route_rand() & 0xff,
+		    route_rand(), route_rand(), route_rand(), route_rand(),
+		    route_rand());
+	} else {
+		inet_addr(addr, 10, route_rand() & 0x3f, route_rand(),
+		    route_rand());
+	}
+}
+
+/** Find most specific route by linear search. */
+static route_t *linear_lookup(inet_addr_t *addr)
+{
+	route_t *best = NULL;
+
+	for (size_t i = 0; i < ROUTES; i++) {
+		if (best != NULL && best->dest.prefix >= routes[i].dest.prefix)
+			continue;
+
+		if (inet_naddr_compare_mask(&routes[i].dest, addr))
+			best = &routes[i];
+	}
+
+	return best;
+}
+
+static uint8_t route_prefix(const route_t *route)
+{
+	return (route == NULL) ? 0 : route->dest.prefix;
+}
+
+/** Compute rate in operations per second */
+static uint64_t rate(size_t ops, suseconds_t duration)
+{
+	if (duration <= 0)
+		duration = 1;
+
+	return (uint64_t) ops * 1000000 / duration;
+}
+
+const char *test_route1(void)
+{
+	rtrie_t trie;
+	struct timeval t0, t1, t2, t3;
+	const char *err = NULL;
+
+	routes = calloc(ROUTES, sizeof(route_t));
+	addrs = calloc(LOOKUPS, sizeof(inet_addr_t));
+	if (routes == NULL || addrs == NULL) {
+		free(routes);
+		free(addrs);
+		return "Failed allocating memory";
+	}
+
+	rtrie_initialize(&trie);
+
+	for (size_t i = 0; i < ROUTES; i++) {
+		inet_addr_t addr;
+		bool v6 = (i % 4) == 3;
+
+		random_addr(&addr, v6);
+		inet_addr_naddr(&addr, v6 ? 40 + route_rand() % 89 :
+		    8 + route_rand() % 25, &routes[i].dest);
+	}
+
+	for (size_t i = 0; i < LOOKUPS; i++)
+		random_addr(&addrs[i], (i % 4) == 3);
+
+	getuptime(&t0);
+
+	for (size_t i = 0; i < ROUTES; i++) {
+		if (rtrie_insert(&trie, &routes[i].dest, &routes[i].ltrie) !=
+		    EOK) {
+			err = "Failed inserting route";
+			goto out;
+		}
+	}
+
+	getuptime(&t1);
+
+	size_t found = 0;
+	for (size_t i = 0; i < LOOKUPS; i++) {
+		if (rtrie_lookup(&trie, &addrs[i]) != NULL)
+			found++;
+	}
+
+	getuptime(&t2);
+
+	for (size_t i = 0; i < LINEAR_LOOKUPS; i++)
+		(void) linear_lookup(&addrs[i]);
+
+	getuptime(&t3);
+
+	for (size_t i = 0; i < LINEAR_LOOKUPS; i++) {
+		link_t *link = rtrie_lookup(&trie, &addrs[i]);
+		route_t *route = (link != NULL) ?
+		    list_get_instance(link, route_t, ltrie) : NULL;
+
+		if (route_prefix(route) !=
+		    route_prefix(linear_lookup(&addrs[i]))) {
+			err = "Lookup result differs from linear search";
+			goto out;
+		}
+	}
+
+	TPRINTF("%d routes inserted in %ld us\n", ROUTES,
+	    (long) tv_sub_diff(&t1, &t0));
+	TPRINTF("trie:   %" PRIu64 " lookups/s (%zu of %d matched)\n",
+	    rate(LOOKUPS, tv_sub_diff(&t2, &t1)), found, LOOKUPS);
+	TPRINTF("linear: %" PRIu64 " lookups/s\n",
+	    rate(LINEAR_LOOKUPS, tv_sub_diff(&t3, &t2)));
+
+	for (size_t i = 0; i < ROUTES; i++)
+		rtrie_remove(&trie, &routes[i].dest, &routes[i].ltrie);
+
+	if (trie.count != 0 || trie.root4 != NULL || trie.root6 != NULL)
+		err = "Routing trie not empty after removing all routes";
+
+out:
+	rtrie_clear(&trie);
+	free(routes);
+	free(addrs);
+	return err;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <io/log.h>
+#include <io/logctl.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include "../tester.h"
+
+/** Number of messages discarded by level */
+#define FILTERED_COUNT  1000000
+
+/** Number of messages passed to the logger */
+#define ACCEPTED_COUNT  2000
+
+static void print_rate(const char *name, size_t count, struct timeval *start)
+{
+	struct timeval now;
+	uint64_t usecs;
+
+	gettimeofday(&now, NULL);
+	usecs = tv_sub_diff(&now, start);
+	if (usecs == 0)
+		usecs = 1;
+
+	TPRINTF("%s: %zu messages in %" PRIu64 " us, %" PRIu64 " msg/s\n",
+	    name, count, usecs, (uint64_t) count * 1000000 / usecs);
+}
+
+const char *test_logger3(void)
+{
+	struct timeval start;
+	size_t i;
+	errno_t rc;
+
+	log_level_t old_level;
+
+	log_t log = log_create("logger3", LOG_DEFAULT);
+
+	rc = logctl_get_log_level("tester/logger3", &old_level);
+	if (rc != EOK)
+		return "Failed getting log level";
+
+	/* The new level is known to us once the call returns. */
+	rc = logctl_set_log_level("tester/logger3", LVL_NOTE);
+	if (rc != EOK)
+		return "Failed setting log level";
+
+	gettimeofday(&start, NULL);
+	for (i = 0; i < FILTERED_COUNT; i++) {
+		log_msg(log, LVL_DEBUG2, "Filtered message %zu of %d.", i,
+		    FILTERED_COUNT);
+	}
+
+	print_rate("filtered", FILTERED_COUNT, &start);
+
+	/*
+	 * Once the ring fills up, messages are accepted as fast as the
+	 * logger writes them out.
+	 */
+	gettimeofday(&start, NULL);
+	for (i = 0; i < ACCEPTED_COUNT; i++) {
+		log_msg(log, LVL_NOTE, "Accepted message %zu of %d.", i,
+		    ACCEPTED_COUNT);
+	}
+
+	print_rate("accepted", ACCEPTED_COUNT, &start);
+
+	rc = logctl_set_log_level("tester/logger3", old_level);
+	if (rc != EOK)
+		return "Failed restoring log level";
+
+	return NULL;
+}
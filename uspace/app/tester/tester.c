@@ -48,6 +48,7 @@ char **test_argv;
 
 test_t tests[] = {
 #include "thread/thread1.def"
+#include "thread/thread2.def"
 #include "thread/setjmp1.def"
 #include "print/print1.def"
 #include "print/print2.def"
@@ -60,6 +61,7 @@ test_t tests[] = {
 #include "stdio/stdio2.def"
 #include "stdio/logger1.def"
 #include "stdio/logger2.def"
+#include "stdio/logger3.def"
 #include "fault/fault1.def"
 #include "fault/fault2.def"
 #include "fault/fault3.def"
@@ -67,14 +69,26 @@ test_t tests[] = {
 #include "float/float2.def"
 #include "float/softfloat1.def"
 #include "vfs/vfs1.def"
+#include "vfs/vfs2.def"
 #include "ipc/ping_pong.def"
 #include "ipc/starve.def"
+#include "ipc/ring1.def"
 #include "loop/loop1.def"
 #include "mm/malloc1.def"
 #include "mm/malloc2.def"
 #include "mm/malloc3.def"
+#include "mm/malloc4.def"
 #include "mm/mapping1.def"
 #include "mm/pager1.def"
+#include "adt/hash_table1.def"
+#include "net/checksum1.def"
+#include "net/dns1.def"
+#include "net/route1.def"
+#include "compress/compress1.def"
+#include "crypto/aes1.def"
+#include "crypto/hash1.def"
+#include "draw/pixel1.def"
+#include "block/block1.def"
 #include "hw/serial/serial1.def"
 #include "chardev/chardev1.def"
 	{ NULL, NULL, NULL, false }
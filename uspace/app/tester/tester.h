@@ -79,6 +79,7 @@ typedef struct {
 } test_t;
 
 extern const char *test_thread1(void);
+extern const char *test_thread2(void);
 extern const char *test_setjmp1(void);
 extern const char *test_print1(void);
 extern const char *test_print2(void);
@@ -91,6 +92,7 @@ extern const char *test_stdio1(void);
 extern const char *test_stdio2(void);
 extern const char *test_logger1(void);
 extern const char *test_logger2(void);
+extern const char *test_logger3(void);
 extern const char *test_fault1(void);
 extern const char *test_fault2(void);
 extern const char *test_fault3(void);
@@ -98,14 +100,26 @@ extern const char *test_float1(void);
 extern const char *test_float2(void);
 extern const char *test_softfloat1(void);
 extern const char *test_vfs1(void);
+extern const char *test_vfs2(void);
 extern const char *test_ping_pong(void);
 extern const char *test_starve_ipc(void);
+extern const char *test_ring1(void);
 extern const char *test_loop1(void);
 extern const char *test_malloc1(void);
 extern const char *test_malloc2(void);
 extern const char *test_malloc3(void);
+extern const char *test_malloc4(void);
 extern const char *test_mapping1(void);
 extern const char *test_pager1(void);
+extern const char *test_hash_table1(void);
+extern const char *test_checksum1(void);
+extern const char *test_dns1(void);
+extern const char *test_route1(void);
+extern const char *test_compress1(void);
+extern const char *test_aes1(void);
+extern const char *test_hash1(void);
+extern const char *test_pixel1(void);
+extern const char *test_block1(void);
 extern const char *test_serial1(void);
 extern const char *test_devman1(void);
 extern const char *test_devman2(void);
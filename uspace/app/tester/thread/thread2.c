@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <atomic.h>
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <time.h>
+#include "../tester.h"
+
+#define RUNNERS  4
+#define FIBRILS  64
+#define ROUNDS   1000
+
+static atomic_t steps;
+
+static FIBRIL_SEMAPHORE_INITIALIZE(fibrils_finished, 0);
+
+static errno_t worker(void *arg)
+{
+	for (int i = 0; i < ROUNDS; i++) {
+		atomic_inc(&steps);
+
+		if (i % 100 == 0)
+			fibril_usleep(1000);
+		else
+			fibril_yield();
+	}
+
+	fibril_semaphore_up(&fibrils_finished);
+	return EOK;
+}
+
+const char *test_thread2(void)
+{
+	atomic_set(&steps, 0);
+
+	int spawned = fibril_spawn_runners(RUNNERS - 1);
+	TPRINTF("Spawned %d runners, %d threads run fibrils\n", spawned,
+	    fibril_runner_count());
+
+	struct timeval start;
+	getuptime(&start);
+
+	int total = 0;
+	for (int i = 0; i < FIBRILS; i++) {
+		fid_t f = fibril_create(worker, NULL);
+		if (!f) {
+			TPRINTF("Could not create fibril %d\n", i);
+			break;
+		}
+		fibril_add_ready(f);
+		total++;
+	}
+
+	for (int i = 0; i < total; i++)
+		fibril_semaphore_down(&fibrils_finished);
+
+	struct timeval end;
+	getuptime(&end);
+
+	TPRINTF("%d fibrils made %zu steps in %lld us\n", total,
+	    (size_t) atomic_get(&steps), (long long) tv_sub_diff(&end, &start));
+
+	if (atomic_get(&steps) != (atomic_count_t) total * ROUNDS)
+		return "Lost fibril steps";
+
+	if (total == 0)
+		return "Could not create any fibril";
+
+	return NULL;
+}
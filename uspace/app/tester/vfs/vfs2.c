@@ -0,0 +1,281 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <str_error.h>
+#include <sys/time.h>
+#include <vfs/vfs.h>
+#include "../tester.h"
+
+/*
+ * The test writes a set of small extents scattered over a file with a
+ * single vectored write, reads them back with a single vectored read and
+ * compares the results with plain reads. Then it compares the time
+ * needed to read all the extents using the two methods. Finally, it checks
+ * that a vectored write to a file open in append mode appends the data.
+ */
+
+#define TEST_FILE  "/tmp/vfs2file"
+
+#define EXTENTS      256
+#define EXT_SIZE     48
+#define EXT_STRIDE   100
+#define ROUNDS       20
+
+static uint8_t wdata[EXTENTS][EXT_SIZE];
+static uint8_t rdata[EXTENTS][EXT_SIZE];
+static vfs_iovec_t iov[EXTENTS];
+
+static void setup_iov(void *data)
+{
+	for (size_t i = 0; i < EXTENTS; i++) {
+		/* Write the extents out of order to exercise the batching. */
+		size_t e = (i * 7) % EXTENTS;
+
+		iov[i].pos = e * EXT_STRIDE;
+		iov[i].buf = (uint8_t *) data + e * EXT_SIZE;
+		iov[i].size = EXT_SIZE;
+	}
+}
+
+static const char *check_data(void)
+{
+	for (size_t e = 0; e < EXTENTS; e++) {
+		for (size_t j = 0; j < EXT_SIZE; j++) {
+			if (rdata[e][j] != wdata[e][j])
+				return "Data read differs from data written";
+		}
+	}
+
+	return NULL;
+}
+
+static const char *test_rdwrv(int fd)
+{
+	size_t cnt;
+	errno_t rc;
+
+	for (size_t e = 0; e < EXTENTS; e++) {
+		for (size_t j = 0; j < EXT_SIZE; j++)
+			wdata[e][j] = (uint8_t) (e * 7 + j);
+	}
+
+	setup_iov(wdata);
+	rc = vfs_writev(fd, iov, EXTENTS, &cnt);
+	if (rc != EOK) {
+		TPRINTF("rc=%s\n", str_error_name(rc));
+		return "vfs_writev() failed";
+	}
+	if (cnt != EXTENTS * EXT_SIZE)
+		return "vfs_writev() wrote less data than requested";
+	TPRINTF("Written %zu bytes in %u extents\n", cnt, EXTENTS);
+
+	setup_iov(rdata);
+	rc = vfs_readv(fd, iov, EXTENTS, &cnt);
+	if (rc != EOK) {
+		TPRINTF("rc=%s\n", str_error_name(rc));
+		return "vfs_readv() failed";
+	}
+	if (cnt != EXTENTS * EXT_SIZE)
+		return "vfs_readv() read less data than expected";
+
+	const char *err = check_data();
+	if (err != NULL)
+		return err;
+
+	/* The gaps between the extents must read as zeros. */
+	uint8_t gap[EXT_STRIDE - EXT_SIZE];
+	ssize_t nread;
+	rc = vfs_read_short(fd, EXT_SIZE, gap, sizeof(gap), &nread);
+	if (rc != EOK || nread != (ssize_t) sizeof(gap))
+		return "Reading a gap failed";
+	for (size_t j = 0; j < sizeof(gap); j++) {
+		if (gap[j] != 0)
+			return "Gap not filled with zeros";
+	}
+
+	/* Reading stops at the end of file. */
+	uint8_t tail[2 * EXT_SIZE];
+	vfs_iovec_t eof_iov[2] = {
+		{
+			.pos = (EXTENTS - 1) * EXT_STRIDE,
+			.buf = tail,
+			.size = sizeof(tail)
+		},
+		{
+			.pos = 0,
+			.buf = rdata,
+			.size = EXT_SIZE
+		}
+	};
+	rc = vfs_readv(fd, eof_iov, 2, &cnt);
+	if (rc != EOK)
+		return "vfs_readv() at the end of file failed";
+	if (cnt != EXT_SIZE)
+		return "vfs_readv() did not stop at the end of file";
+
+	return NULL;
+}
+
+/** Vectored writes to a file open in append mode ignore the positions. */
+static const char *test_append(int fd)
+{
+	vfs_stat_t st;
+	size_t cnt;
+	int afd;
+	errno_t rc;
+
+	rc = vfs_stat(fd, &st);
+	if (rc != EOK)
+		return "vfs_stat() failed";
+	aoff64_t size = st.size;
+
+	rc = vfs_lookup_open(TEST_FILE, WALK_REGULAR, MODE_WRITE | MODE_APPEND,
+	    &afd);
+	if (rc != EOK)
+		return "vfs_lookup_open() in append mode failed";
+
+	vfs_iovec_t app_iov[2] = {
+		{
+			.pos = 0,
+			.buf = wdata[1],
+			.size = EXT_SIZE
+		},
+		{
+			.pos = 0,
+			.buf = wdata[2],
+			.size = EXT_SIZE
+		}
+	};
+	rc = vfs_writev(afd, app_iov, 2, &cnt);
+	vfs_put(afd);
+	if (rc != EOK || cnt != 2 * EXT_SIZE)
+		return "vfs_writev() in append mode failed";
+
+	rc = vfs_stat(fd, &st);
+	if (rc != EOK || st.size != size + 2 * EXT_SIZE)
+		return "vfs_writev() in append mode did not append";
+
+	/* The first extent must be intact, the new data must follow. */
+	vfs_iovec_t chk_iov[3] = {
+		{
+			.pos = 0,
+			.buf = rdata[0],
+			.size = EXT_SIZE
+		},
+		{
+			.pos = size,
+			.buf = rdata[1],
+			.size = EXT_SIZE
+		},
+		{
+			.pos = size + EXT_SIZE,
+			.buf = rdata[2],
+			.size = EXT_SIZE
+		}
+	};
+	rc = vfs_readv(fd, chk_iov, 3, &cnt);
+	if (rc != EOK || cnt != 3 * EXT_SIZE)
+		return "vfs_readv() after append failed";
+
+	for (size_t e = 0; e < 3; e++) {
+		for (size_t j = 0; j < EXT_SIZE; j++) {
+			if (rdata[e][j] != wdata[e][j])
+				return "Appended data differs";
+		}
+	}
+
+	return NULL;
+}
+
+static const char *bench_rdwrv(int fd)
+{
+	struct timeval start;
+	struct timeval end;
+	ssize_t nread;
+	size_t cnt;
+	errno_t rc;
+
+	setup_iov(rdata);
+
+	getuptime(&start);
+	for (unsigned int r = 0; r < ROUNDS; r++) {
+		for (size_t i = 0; i < EXTENTS; i++) {
+			rc = vfs_read_short(fd, iov[i].pos, iov[i].buf,
+			    iov[i].size, &nread);
+			if (rc != EOK)
+				return "vfs_read_short() failed";
+		}
+	}
+	getuptime(&end);
+	suseconds_t plain = tv_sub_diff(&end, &start);
+
+	getuptime(&start);
+	for (unsigned int r = 0; r < ROUNDS; r++) {
+		rc = vfs_readv(fd, iov, EXTENTS, &cnt);
+		if (rc != EOK)
+			return "vfs_readv() failed";
+	}
+	getuptime(&end);
+	suseconds_t vectored = tv_sub_diff(&end, &start);
+
+	TPRINTF("%u x %u extents: plain reads %ld us, vectored reads %ld us\n",
+	    ROUNDS, EXTENTS, (long) plain, (long) vectored);
+
+	return check_data();
+}
+
+const char *test_vfs2(void)
+{
+	int fd;
+	errno_t rc;
+
+	rc = vfs_lookup_open(TEST_FILE, WALK_REGULAR | WALK_MAY_CREATE,
+	    MODE_READ | MODE_WRITE, &fd);
+	if (rc != EOK)
+		return "vfs_lookup_open() failed";
+	TPRINTF("Created file %s (fd=%d)\n", TEST_FILE, fd);
+
+	const char *err = test_rdwrv(fd);
+	if (err == NULL)
+		err = bench_rdwrv(fd);
+	if (err == NULL)
+		err = test_append(fd);
+
+	vfs_put(fd);
+
+	if (vfs_unlink_path(TEST_FILE) != EOK && err == NULL)
+		err = "vfs_unlink_path() failed";
+
+	return err;
+}
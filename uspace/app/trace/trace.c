@@ -714,6 +714,10 @@ static void main_init(void)
 	proto_add_oper(p, VFS_IN_READ, o);
 	o = oper_new("write", 3, arg_def, V_ERRNO, 1, resp_def);
 	proto_add_oper(p, VFS_IN_WRITE, o);
+	o = oper_new("readv", 1, arg_def, V_ERRNO, 1, resp_def);
+	proto_add_oper(p, VFS_IN_READV, o);
+	o = oper_new("writev", 1, arg_def, V_ERRNO, 1, resp_def);
+	proto_add_oper(p, VFS_IN_WRITEV, o);
 	o = oper_new("vfs_resize", 5, arg_def, V_ERRNO, 0, resp_def);
 	proto_add_oper(p, VFS_IN_RESIZE, o);
 	o = oper_new("vfs_stat", 1, arg_def, V_ERRNO, 0, resp_def);
@@ -0,0 +1,586 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup webload
+ * @brief HTTP load generator.
+ * @{
+ */
+/**
+ * @file
+ *
+ * Repeatedly fetches a document from a web server over several
+ * concurrent connections and reports the request rate and the
+ * distribution of response latencies.
+ */
+
+#include <errno.h>
+#include <fibril.h>
+#include <fibril_synch.h>
+#include <getopt.h>
+#include <inet/endpoint.h>
+#include <inet/hostport.h>
+#include <inet/tcp.h>
+#include <macros.h>
+#include <mem.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <str.h>
+#include <str_error.h>
+#include <sys/time.h>
+
+#define NAME  "webload"
+
+#define DEFAULT_CONNS     4
+#define DEFAULT_REQUESTS  1000
+
+/** Maximum number of requests sent ahead of responses */
+#define PIPELINE_MAX  16
+
+/** Size of the receive buffer */
+#define RECV_SIZE  16384
+
+/** Maximum length of a response line */
+#define LINE_SIZE  1024
+
+/** Connection of one worker */
+typedef struct {
+	tcp_conn_t *conn;
+
+	char rbuf[RECV_SIZE];
+	size_t rbuf_out;
+	size_t rbuf_in;
+
+	char lbuf[LINE_SIZE + 1];
+
+	/** Send times of the outstanding requests, oldest at @c head */
+	struct timeval sent[PIPELINE_MAX];
+	size_t head;
+	size_t inflight;
+} load_conn_t;
+
+static tcp_t *tcp;
+static inet_ep2_t epp;
+static char *request;
+static size_t request_size;
+
+static size_t pipeline = 1;
+static bool keep_alive = true;
+
+static FIBRIL_MUTEX_INITIALIZE(load_lock);
+static FIBRIL_CONDVAR_INITIALIZE(load_cv);
+/** Requests not yet sent */
+static size_t requests_left;
+/** Workers still running */
+static size_t workers;
+/** Latencies of completed requests in microseconds */
+static useconds_t *latency;
+static size_t completed;
+static size_t errors;
+static uint64_t body_bytes;
+
+static tcp_cb_t conn_cb = {
+	.connected = NULL
+};
+
+static void print_usage(void)
+{
+	printf("Usage: %s [-c <conns>] [-n <requests>] [-p <depth>] [-1] "
+	    "<host>:<port> [<path>]\n", NAME);
+	printf("Measure the performance of a web server.\n\n");
+	printf("  -c <conns>     Number of concurrent connections "
+	    "(default %d)\n", DEFAULT_CONNS);
+	printf("  -n <requests>  Total number of requests (default %d)\n",
+	    DEFAULT_REQUESTS);
+	printf("  -p <depth>     Requests sent ahead on a connection "
+	    "(1-%d, default 1)\n", PIPELINE_MAX);
+	printf("  -1             Open a new connection for every request\n");
+	printf("  -h             Print this help\n");
+}
+
+/** Take a request to send, if any is left. */
+static bool request_take(void)
+{
+	fibril_mutex_lock(&load_lock);
+	bool take = requests_left > 0;
+	if (take)
+		requests_left--;
+	fibril_mutex_unlock(&load_lock);
+
+	return take;
+}
+
+/** Return requests which were not answered by the server. */
+static void request_return(size_t count)
+{
+	fibril_mutex_lock(&load_lock);
+	requests_left += count;
+	fibril_mutex_unlock(&load_lock);
+}
+
+static void request_done(struct timeval *sent, size_t size)
+{
+	struct timeval now;
+	getuptime(&now);
+
+	fibril_mutex_lock(&load_lock);
+	latency[completed++] = tv_sub_diff(&now, sent);
+	body_bytes += size;
+	fibril_mutex_unlock(&load_lock);
+}
+
+static errno_t load_conn_open(load_conn_t *lc)
+{
+	lc->rbuf_out = 0;
+	lc->rbuf_in = 0;
+	lc->head = 0;
+	lc->inflight = 0;
+
+	errno_t rc = tcp_conn_create(tcp, &epp, &conn_cb, NULL, &lc->conn);
+	if (rc != EOK)
+		return rc;
+
+	rc = tcp_conn_wait_connected(lc->conn);
+	if (rc != EOK) {
+		tcp_conn_destroy(lc->conn);
+		lc->conn = NULL;
+		return rc;
+	}
+
+	return EOK;
+}
+
+static void load_conn_close(load_conn_t *lc)
+{
+	if (lc->conn == NULL)
+		return;
+
+	tcp_conn_destroy(lc->conn);
+	lc->conn = NULL;
+}
+
+static errno_t recv_fill(load_conn_t *lc)
+{
+	size_t nrecv;
+
+	if (lc->rbuf_out < lc->rbuf_in)
+		return EOK;
+
+	errno_t rc = tcp_conn_recv_wait(lc->conn, lc->rbuf, RECV_SIZE,
+	    &nrecv);
+	if (rc != EOK)
+		return rc;
+
+	/* Connection closed by the server */
+	if (nrecv == 0)
+		return EIO;
+
+	lc->rbuf_out = 0;
+	lc->rbuf_in = nrecv;
+	return EOK;
+}
+
+/** Receive one line of the response header without the terminator. */
+static errno_t recv_line(load_conn_t *lc, char **rline)
+{
+	size_t used = 0;
+
+	while (true) {
+		errno_t rc = recv_fill(lc);
+		if (rc != EOK)
+			return rc;
+
+		char *start = lc->rbuf + lc->rbuf_out;
+		size_t avail = lc->rbuf_in - lc->rbuf_out;
+		char *nl = memchr(start, '\n', avail);
+		size_t n = (nl != NULL) ? (size_t) (nl - start) + 1 : avail;
+
+		if (used + n > LINE_SIZE)
+			return ELIMIT;
+
+		memcpy(lc->lbuf + used, start, n);
+		lc->rbuf_out += n;
+		used += n;
+
+		if (nl != NULL)
+			break;
+	}
+
+	used--;
+	if (used > 0 && lc->lbuf[used - 1] == '\r')
+		used--;
+
+	lc->lbuf[used] = '\0';
+	*rline = lc->lbuf;
+	return EOK;
+}
+
+/** Receive one response.
+ *
+ * @param lc     Connection
+ * @param rclose Place to store @c true if the server closes the
+ *               connection after the response
+ * @param rsize  Place to store the size of the response body
+ */
+static errno_t response_recv(load_conn_t *lc, bool *rclose, size_t *rsize)
+{
+	char *line;
+	size_t length = 0;
+	bool have_length = false;
+	bool close = false;
+	errno_t rc;
+
+	rc = recv_line(lc, &line);
+	if (rc != EOK)
+		return rc;
+
+	if (str_lcmp(line, "HTTP/1.", 7) != 0)
+		return EIO;
+
+	if (str_lcmp(line, "HTTP/1.0", 8) == 0)
+		close = true;
+
+	char *status = str_chr(line, ' ');
+	if (status == NULL || str_lcmp(status + 1, "200", 3) != 0)
+		return EIO;
+
+	while (true) {
+		rc = recv_line(lc, &line);
+		if (rc != EOK)
+			return rc;
+
+		if (*line == '\0')
+			break;
+
+		if (str_lcasecmp(line, "Content-Length:", 15) == 0) {
+			length = strtoul(line + 15, NULL, 10);
+			have_length = true;
+		} else if (str_lcasecmp(line, "Connection:", 11) == 0) {
+			char *value = line + 11;
+			while (*value == ' ')
+				value++;
+			close = str_lcasecmp(value, "close", 5) == 0;
+		}
+	}
+
+	/* Without the length the body extends to the end of connection. */
+	if (!have_length)
+		return ENOTSUP;
+
+	size_t left = length;
+	while (left > 0) {
+		rc = recv_fill(lc);
+		if (rc != EOK)
+			return rc;
+
+		size_t n = min(left, lc->rbuf_in - lc->rbuf_out);
+		lc->rbuf_out += n;
+		left -= n;
+	}
+
+	*rclose = close;
+	*rsize = length;
+	return EOK;
+}
+
+static errno_t load_worker(void *arg)
+{
+	load_conn_t *lc;
+	errno_t rc = EOK;
+
+	lc = calloc(1, sizeof(load_conn_t));
+	if (lc == NULL) {
+		rc = ENOMEM;
+		goto out;
+	}
+
+	while (true) {
+		if (lc->conn == NULL) {
+			if (!request_take())
+				break;
+			request_return(1);
+
+			rc = load_conn_open(lc);
+			if (rc != EOK)
+				break;
+		}
+
+		/* Keep the pipeline full */
+		while (lc->inflight < pipeline && request_take()) {
+			rc = tcp_conn_send(lc->conn, request, request_size);
+			if (rc != EOK) {
+				request_return(1);
+				goto out;
+			}
+
+			getuptime(&lc->sent[(lc->head + lc->inflight) %
+			    PIPELINE_MAX]);
+			lc->inflight++;
+		}
+
+		if (lc->inflight == 0)
+			break;
+
+		bool close;
+		size_t size;
+		rc = response_recv(lc, &close, &size);
+		if (rc != EOK) {
+			request_return(lc->inflight);
+			break;
+		}
+
+		request_done(&lc->sent[lc->head], size);
+		lc->head = (lc->head + 1) % PIPELINE_MAX;
+		lc->inflight--;
+
+		if (close) {
+			/* Requests sent after this one will not be served. */
+			request_return(lc->inflight);
+			load_conn_close(lc);
+		}
+	}
+
+out:
+	if (lc != NULL)
+		load_conn_close(lc);
+	free(lc);
+
+	fibril_mutex_lock(&load_lock);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Request failed (%s).\n", NAME,
+		    str_error(rc));
+		errors++;
+		/* Leave the remaining requests to the other workers. */
+	}
+	workers--;
+	fibril_condvar_broadcast(&load_cv);
+	fibril_mutex_unlock(&load_lock);
+
+	return rc;
+}
+
+static int useconds_cmp(const void *a, const void *b)
+{
+	useconds_t ua = *(const useconds_t *) a;
+	useconds_t ub = *(const useconds_t *) b;
+
+	if (ua < ub)
+		return -1;
+	if (ua > ub)
+		return 1;
+	return 0;
+}
+
+/** Latency at a given percentile of the sorted samples. */
+static useconds_t percentile(unsigned int pct)
+{
+	size_t idx = (completed * pct + 99) / 100;
+	return latency[idx > 0 ? idx - 1 : 0];
+}
+
+static void print_results(useconds_t elapsed)
+{
+	printf("Completed %zu requests, %zu errors in %" PRIu64 " ms\n",
+	    completed, errors, (uint64_t) elapsed / 1000);
+
+	if (completed == 0)
+		return;
+
+	if (elapsed == 0)
+		elapsed = 1;
+
+	printf("Throughput: %" PRIu64 " req/s, %" PRIu64 " KiB/s\n",
+	    (uint64_t) completed * 1000000 / elapsed,
+	    body_bytes * 1000000 / elapsed / 1024);
+
+	qsort(latency, completed, sizeof(useconds_t), useconds_cmp);
+
+	printf("Latency (us): min %" PRIu64 ", p50 %" PRIu64 ", "
+	    "p90 %" PRIu64 ", p99 %" PRIu64 ", max %" PRIu64 "\n",
+	    (uint64_t) latency[0], (uint64_t) percentile(50),
+	    (uint64_t) percentile(90), (uint64_t) percentile(99),
+	    (uint64_t) latency[completed - 1]);
+}
+
+int main(int argc, char *argv[])
+{
+	size_t conns = DEFAULT_CONNS;
+	size_t requests = DEFAULT_REQUESTS;
+	const char *errmsg;
+	int optres, errflg = 0;
+	errno_t rc;
+
+	while ((optres = getopt(argc, argv, ":c:n:p:1h")) != -1) {
+		switch (optres) {
+		case 'h':
+			print_usage();
+			return 0;
+
+		case 'c':
+			conns = strtoul(optarg, NULL, 10);
+			if (conns == 0) {
+				fprintf(stderr, "Invalid number of "
+				    "connections: %s\n", optarg);
+				errflg++;
+			}
+			break;
+
+		case 'n':
+			requests = strtoul(optarg, NULL, 10);
+			if (requests == 0) {
+				fprintf(stderr, "Invalid number of "
+				    "requests: %s\n", optarg);
+				errflg++;
+			}
+			break;
+
+		case 'p':
+			pipeline = strtoul(optarg, NULL, 10);
+			if (pipeline == 0 || pipeline > PIPELINE_MAX) {
+				fprintf(stderr, "Invalid pipeline depth: %s\n",
+				    optarg);
+				errflg++;
+			}
+			break;
+
+		case '1':
+			keep_alive = false;
+			break;
+
+		case ':':
+			fprintf(stderr, "Option -%c requires an operand\n",
+			    optopt);
+			errflg++;
+			break;
+
+		case '?':
+			fprintf(stderr, "Unrecognized option: -%c\n", optopt);
+			errflg++;
+			break;
+
+		default:
+			fprintf(stderr,
+			    "Unknown error while parsing command line options");
+			errflg++;
+			break;
+		}
+	}
+
+	if (optind >= argc || argc - optind > 2) {
+		fprintf(stderr, "Missing or extra arguments\n");
+		errflg++;
+	}
+
+	if (errflg) {
+		print_usage();
+		return 1;
+	}
+
+	/* Every request needs its own connection. */
+	if (!keep_alive)
+		pipeline = 1;
+
+	const char *hostport = argv[optind];
+	const char *path = (optind + 1 < argc) ? argv[optind + 1] : "/";
+
+	inet_ep2_init(&epp);
+	rc = inet_hostport_plookup_one(hostport, ip_any, &epp.remote, NULL,
+	    &errmsg);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: %s (host:port %s).\n", NAME, errmsg,
+		    hostport);
+		return 1;
+	}
+
+	if (asprintf(&request, "GET %s HTTP/1.1\r\n"
+	    "Host: %s\r\n"
+	    "Connection: %s\r\n"
+	    "\r\n", path, hostport, keep_alive ? "keep-alive" : "close") < 0) {
+		fprintf(stderr, "%s: Out of memory.\n", NAME);
+		return 1;
+	}
+
+	request_size = str_size(request);
+
+	latency = calloc(requests, sizeof(useconds_t));
+	if (latency == NULL) {
+		fprintf(stderr, "%s: Out of memory.\n", NAME);
+		return 1;
+	}
+
+	rc = tcp_create(&tcp);
+	if (rc != EOK) {
+		fprintf(stderr, "%s: Error initializing TCP.\n", NAME);
+		return 1;
+	}
+
+	printf("%s: %zu requests for %s over %zu connections", NAME,
+	    requests, path, conns);
+	if (keep_alive)
+		printf(", pipeline depth %zu\n", pipeline);
+	else
+		printf(", without keep-alive\n");
+
+	struct timeval start;
+	struct timeval end;
+
+	requests_left = requests;
+	getuptime(&start);
+
+	for (size_t i = 0; i < conns; i++) {
+		fid_t fid = fibril_create(load_worker, NULL);
+		if (fid == 0) {
+			fprintf(stderr, "%s: Out of memory.\n", NAME);
+			break;
+		}
+
+		fibril_mutex_lock(&load_lock);
+		workers++;
+		fibril_mutex_unlock(&load_lock);
+
+		fibril_add_ready(fid);
+	}
+
+	fibril_mutex_lock(&load_lock);
+	while (workers > 0)
+		fibril_condvar_wait(&load_cv, &load_lock);
+	fibril_mutex_unlock(&load_lock);
+
+	getuptime(&end);
+
+	print_results(tv_sub_diff(&end, &start));
+
+	tcp_destroy(tcp);
+	free(latency);
+	free(request);
+	return (errors == 0 && completed == requests) ? 0 : 1;
+}
+
+/** @}
+ */
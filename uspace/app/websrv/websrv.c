@@ -31,15 +31,27 @@
  */
 /**
  * @file Skeletal web server.
+ *
+ * Serves files from the web root over HTTP/1.1. Connections are kept
+ * open for further (possibly pipelined) requests unless the client asks
+ * otherwise. Recently served files are kept in memory together with
+ * their response headers.
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
 #include <errno.h>
 #include <assert.h>
+#include <fibril_synch.h>
+#include <ipc/common.h>
+#include <mem.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include <task.h>
 
 #include <vfs/vfs.h>
@@ -60,7 +72,22 @@
 #define WEB_ROOT  "/data/web"
 
 /** Buffer for receiving the request. */
-#define BUFFER_SIZE  1024
+#define BUFFER_SIZE  4096
+
+/** Largest block of data the TCP service accepts in one send. */
+#define SEND_SIZE  DATA_XFER_LIMIT
+
+/** Maximum number of requests served over one connection. */
+#define KEEPALIVE_MAX  100
+
+/** Largest file kept in the cache. */
+#define CACHE_FILE_MAX  (256 * 1024)
+
+/** Maximum total size of cached files. */
+#define CACHE_SIZE_MAX  (4 * 1024 * 1024)
+
+/** Interval after which a cached file is checked for changes (usec). */
+#define CACHE_REVALIDATE  (1000 * 1000)
 
 static void websrv_new_conn(tcp_listener_t *, tcp_conn_t *);
 
@@ -80,22 +107,52 @@ typedef struct {
 	char rbuf[BUFFER_SIZE];
 	size_t rbuf_out;
 	size_t rbuf_in;
+	/** The peer has closed its side of the connection */
+	bool eof;
 
 	char lbuf[BUFFER_SIZE + 1];
 	size_t lbuf_used;
+
+	/** Requested URI */
+	char uri[BUFFER_SIZE + 1];
+
+	/** Buffer for assembling responses, SEND_SIZE bytes */
+	char *sbuf;
 } recv_t;
 
+/** Cached file */
+typedef struct {
+	/** Link to cache_list, least recently used first */
+	link_t cache_list;
+	/** Link to cache_hash */
+	ht_link_t cache_hash;
+	/** Path of the file */
+	char *fname;
+	/** Identity of the file when it was read */
+	vfs_stat_t stat;
+	/** Time when the file was last checked for changes */
+	struct timeval validated;
+	/** Number of responses using the entry, including the cache */
+	size_t refcnt;
+	/** Response header for persistent connections */
+	char *hdr_keep;
+	/** Response header for connections to be closed */
+	char *hdr_close;
+	/** File contents */
+	char *data;
+	size_t size;
+} cache_entry_t;
+
+static FIBRIL_MUTEX_INITIALIZE(cache_lock);
+static LIST_INITIALIZE(cache_list);
+static hash_table_t cache_hash;
+static size_t cache_size;
+
 static bool verbose = false;
 
 /** Responses to send to client. */
 
-static const char *msg_ok =
-    "HTTP/1.0 200 OK\r\n"
-    "\r\n";
-
 static const char *msg_bad_request =
-    "HTTP/1.0 400 Bad Request\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>400 Bad Request</title>\r\n"
@@ -107,8 +164,6 @@ static const char *msg_bad_request =
     "</html>\r\n";
 
 static const char *msg_not_found =
-    "HTTP/1.0 404 Not Found\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>404 Not Found</title>\r\n"
@@ -120,8 +175,6 @@ static const char *msg_not_found =
     "</html>\r\n";
 
 static const char *msg_not_implemented =
-    "HTTP/1.0 501 Not Implemented\r\n"
-    "\r\n"
     "<!DOCTYPE HTML PUBLIC \"-//IETF//DTD HTML 2.0//EN\">\r\n"
     "<html><head>\r\n"
     "<title>501 Not Implemented</title>\r\n"
@@ -132,6 +185,269 @@ static const char *msg_not_implemented =
     "</body>\r\n"
     "</html>\r\n";
 
+static const struct {
+	const char *ext;
+	const char *type;
+} content_types[] = {
+	{ ".html", "text/html" },
+	{ ".htm", "text/html" },
+	{ ".txt", "text/plain" },
+	{ ".css", "text/css" },
+	{ ".js", "application/javascript" },
+	{ ".png", "image/png" },
+	{ ".jpg", "image/jpeg" },
+	{ ".gif", "image/gif" },
+	{ ".svg", "image/svg+xml" }
+};
+
+static const char *content_type(const char *fname)
+{
+	size_t fsize = str_size(fname);
+
+	for (size_t i = 0; i < ARRAY_SIZE(content_types); i++) {
+		size_t esize = str_size(content_types[i].ext);
+		if (fsize >= esize && str_casecmp(fname + fsize - esize,
+		    content_types[i].ext) == 0)
+			return content_types[i].type;
+	}
+
+	return "application/octet-stream";
+}
+
+static const char *connection_token(bool keep_alive)
+{
+	return keep_alive ? "keep-alive" : "close";
+}
+
+static size_t cache_fname_hash(const char *fname)
+{
+	size_t hash = 0;
+
+	while (*fname != '\0')
+		hash = hash * 31 + (uint8_t) *fname++;
+
+	return hash_mix(hash);
+}
+
+static size_t cache_key_hash(void *key)
+{
+	return cache_fname_hash((const char *) key);
+}
+
+static size_t cache_hash_fn(const ht_link_t *item)
+{
+	cache_entry_t *entry = hash_table_get_inst(item, cache_entry_t,
+	    cache_hash);
+	return cache_fname_hash(entry->fname);
+}
+
+static bool cache_key_equal(void *key, const ht_link_t *item)
+{
+	cache_entry_t *entry = hash_table_get_inst(item, cache_entry_t,
+	    cache_hash);
+	return str_cmp(entry->fname, (const char *) key) == 0;
+}
+
+static hash_table_ops_t cache_hash_ops = {
+	.hash = cache_hash_fn,
+	.key_hash = cache_key_hash,
+	.key_equal = cache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+static void cache_entry_destroy(cache_entry_t *entry)
+{
+	free(entry->fname);
+	free(entry->hdr_keep);
+	free(entry->hdr_close);
+	free(entry->data);
+	free(entry);
+}
+
+/** Drop a reference to a cache entry. */
+static void cache_entry_release(cache_entry_t *entry)
+{
+	fibril_mutex_lock(&cache_lock);
+	bool last = --entry->refcnt == 0;
+	fibril_mutex_unlock(&cache_lock);
+
+	if (last)
+		cache_entry_destroy(entry);
+}
+
+/** Remove an entry from the cache, keeping it alive for its users. */
+static void cache_remove(cache_entry_t *entry)
+{
+	assert(fibril_mutex_is_locked(&cache_lock));
+
+	hash_table_remove_item(&cache_hash, &entry->cache_hash);
+	list_remove(&entry->cache_list);
+	cache_size -= entry->size;
+
+	if (--entry->refcnt == 0)
+		cache_entry_destroy(entry);
+}
+
+static bool stat_same_file(vfs_stat_t *a, vfs_stat_t *b)
+{
+	return a->service_id == b->service_id && a->index == b->index &&
+	    a->size == b->size;
+}
+
+/** Look up a file in the cache.
+ *
+ * Entries which have not been checked for a while are compared with
+ * the file system first.
+ *
+ * @param fname Path of the file
+ *
+ * @return Referenced cache entry or @c NULL if the file is not cached.
+ */
+static cache_entry_t *cache_get(const char *fname)
+{
+	struct timeval now;
+	getuptime(&now);
+
+	fibril_mutex_lock(&cache_lock);
+
+	ht_link_t *link = hash_table_find(&cache_hash, (void *) fname);
+	if (link == NULL) {
+		fibril_mutex_unlock(&cache_lock);
+		return NULL;
+	}
+
+	cache_entry_t *entry = hash_table_get_inst(link, cache_entry_t,
+	    cache_hash);
+	entry->refcnt++;
+
+	list_remove(&entry->cache_list);
+	list_append(&entry->cache_list, &cache_list);
+
+	bool revalidate = tv_sub_diff(&now, &entry->validated) >=
+	    CACHE_REVALIDATE;
+	fibril_mutex_unlock(&cache_lock);
+
+	if (!revalidate)
+		return entry;
+
+	vfs_stat_t stat;
+	errno_t rc = vfs_stat_path(fname, &stat);
+
+	fibril_mutex_lock(&cache_lock);
+
+	if (rc == EOK && stat_same_file(&stat, &entry->stat)) {
+		entry->validated = now;
+		fibril_mutex_unlock(&cache_lock);
+		return entry;
+	}
+
+	/* The file has changed, forget the cached copy. */
+	if (link_in_use(&entry->cache_list))
+		cache_remove(entry);
+
+	fibril_mutex_unlock(&cache_lock);
+	cache_entry_release(entry);
+	return NULL;
+}
+
+/** Insert a file into the cache.
+ *
+ * @param entry New cache entry, referenced by the caller
+ *
+ * @return Referenced entry to use, which is different from @a entry if
+ *         another request has cached the same file meanwhile.
+ */
+static cache_entry_t *cache_insert(cache_entry_t *entry)
+{
+	fibril_mutex_lock(&cache_lock);
+
+	ht_link_t *link = hash_table_find(&cache_hash, entry->fname);
+	if (link != NULL) {
+		cache_entry_t *cached = hash_table_get_inst(link,
+		    cache_entry_t, cache_hash);
+		cached->refcnt++;
+		fibril_mutex_unlock(&cache_lock);
+
+		cache_entry_release(entry);
+		return cached;
+	}
+
+	entry->refcnt++;
+	hash_table_insert(&cache_hash, &entry->cache_hash);
+	list_append(&entry->cache_list, &cache_list);
+	cache_size += entry->size;
+
+	while (cache_size > CACHE_SIZE_MAX) {
+		cache_remove(list_get_instance(list_first(&cache_list),
+		    cache_entry_t, cache_list));
+	}
+
+	fibril_mutex_unlock(&cache_lock);
+	return entry;
+}
+
+/** Format the header of a successful response. */
+static char *response_header(const char *fname, aoff64_t size,
+    bool keep_alive)
+{
+	char *hdr;
+
+	if (asprintf(&hdr,
+	    "HTTP/1.1 200 OK\r\n"
+	    "Content-Type: %s\r\n"
+	    "Content-Length: %" PRIu64 "\r\n"
+	    "Connection: %s\r\n"
+	    "\r\n", content_type(fname), size,
+	    connection_token(keep_alive)) < 0)
+		return NULL;
+
+	return hdr;
+}
+
+/** Read a file into a new cache entry.
+ *
+ * @param fname Path of the file
+ * @param fd    Open file
+ * @param stat  File status
+ *
+ * @return Referenced cache entry or @c NULL if out of memory or on
+ *         read error.
+ */
+static cache_entry_t *cache_entry_read(const char *fname, int fd,
+    vfs_stat_t *stat)
+{
+	cache_entry_t *entry = calloc(1, sizeof(cache_entry_t));
+	if (entry == NULL)
+		return NULL;
+
+	entry->refcnt = 1;
+	entry->stat = *stat;
+	entry->size = stat->size;
+	getuptime(&entry->validated);
+
+	entry->fname = str_dup(fname);
+	entry->hdr_keep = response_header(fname, stat->size, true);
+	entry->hdr_close = response_header(fname, stat->size, false);
+	entry->data = malloc(max(entry->size, 1));
+	if (entry->fname == NULL || entry->hdr_keep == NULL ||
+	    entry->hdr_close == NULL || entry->data == NULL)
+		goto error;
+
+	aoff64_t pos = 0;
+	while (pos < entry->size) {
+		size_t nr;
+		errno_t rc = vfs_read(fd, &pos, entry->data + pos,
+		    entry->size - pos, &nr);
+		if (rc != EOK || nr == 0)
+			goto error;
+	}
+
+	return entry;
+error:
+	cache_entry_destroy(entry);
+	return NULL;
+}
 
 static errno_t recv_create(tcp_conn_t *conn, recv_t **rrecv)
 {
@@ -141,9 +457,16 @@ static errno_t recv_create(tcp_conn_t *conn, recv_t **rrecv)
 	if (recv == NULL)
 		return ENOMEM;
 
+	recv->sbuf = malloc(SEND_SIZE);
+	if (recv->sbuf == NULL) {
+		free(recv);
+		return ENOMEM;
+	}
+
 	recv->conn = conn;
 	recv->rbuf_out = 0;
 	recv->rbuf_in = 0;
+	recv->eof = false;
 	recv->lbuf_used = 0;
 
 	*rrecv = recv;
@@ -152,55 +475,75 @@ static errno_t recv_create(tcp_conn_t *conn, recv_t **rrecv)
 
 static void recv_destroy(recv_t *recv)
 {
+	if (recv != NULL)
+		free(recv->sbuf);
 	free(recv);
 }
 
-/** Receive one character (with buffering) */
-static errno_t recv_char(recv_t *recv, char *c)
+/** Wait for more data if the receive buffer is empty */
+static errno_t recv_fill(recv_t *recv)
 {
 	size_t nrecv;
 	errno_t rc;
 
-	if (recv->rbuf_out == recv->rbuf_in) {
-		recv->rbuf_out = 0;
-		recv->rbuf_in = 0;
+	if (recv->rbuf_out < recv->rbuf_in)
+		return EOK;
 
-		rc = tcp_conn_recv_wait(recv->conn, recv->rbuf, BUFFER_SIZE, &nrecv);
-		if (rc != EOK) {
-			fprintf(stderr, "tcp_conn_recv() failed: %s\n", str_error(rc));
-			return rc;
-		}
+	recv->rbuf_out = 0;
+	recv->rbuf_in = 0;
 
-		recv->rbuf_in = nrecv;
+	rc = tcp_conn_recv_wait(recv->conn, recv->rbuf, BUFFER_SIZE, &nrecv);
+	if (rc != EOK) {
+		fprintf(stderr, "tcp_conn_recv() failed: %s\n", str_error(rc));
+		return rc;
 	}
 
-	*c = recv->rbuf[recv->rbuf_out++];
+	if (nrecv == 0) {
+		recv->eof = true;
+		return EIO;
+	}
+
+	recv->rbuf_in = nrecv;
 	return EOK;
 }
 
-/** Receive one line with length limit */
+/** Receive one line with length limit
+ *
+ * The line is scanned for in the buffered data as a whole. The line
+ * terminator is not included in the result.
+ */
 static errno_t recv_line(recv_t *recv, char **rbuf)
 {
-	char *bp = recv->lbuf;
-	char c = '\0';
-
-	while (bp < recv->lbuf + BUFFER_SIZE) {
-		char prev = c;
-		errno_t rc = recv_char(recv, &c);
+	size_t used = 0;
 
+	while (true) {
+		errno_t rc = recv_fill(recv);
 		if (rc != EOK)
 			return rc;
 
-		*bp++ = c;
-		if ((prev == '\r') && (c == '\n'))
+		char *start = recv->rbuf + recv->rbuf_out;
+		size_t avail = recv->rbuf_in - recv->rbuf_out;
+		char *nl = memchr(start, '\n', avail);
+		size_t n = (nl != NULL) ? (size_t) (nl - start) + 1 : avail;
+
+		if (used + n > BUFFER_SIZE)
+			return ELIMIT;
+
+		memcpy(recv->lbuf + used, start, n);
+		recv->rbuf_out += n;
+		used += n;
+
+		if (nl != NULL)
 			break;
 	}
 
-	recv->lbuf_used = bp - recv->lbuf;
-	*bp = '\0';
+	/* Strip LF and the preceding CR, if any */
+	used--;
+	if (used > 0 && recv->lbuf[used - 1] == '\r')
+		used--;
 
-	if (bp == recv->lbuf + BUFFER_SIZE)
-		return ELIMIT;
+	recv->lbuf[used] = '\0';
+	recv->lbuf_used = used;
 
 	*rbuf = recv->lbuf;
 	return EOK;
@@ -225,36 +568,115 @@ static bool uri_is_valid(char *uri)
 	return true;
 }
 
-static errno_t send_response(tcp_conn_t *conn, const char *msg)
+static errno_t send_data(tcp_conn_t *conn, const void *data, size_t size)
+{
+	const char *dp = data;
+
+	while (size > 0) {
+		size_t now = min(size, SEND_SIZE);
+
+		errno_t rc = tcp_conn_send(conn, dp, now);
+		if (rc != EOK) {
+			fprintf(stderr, "tcp_conn_send() failed\n");
+			return rc;
+		}
+
+		dp += now;
+		size -= now;
+	}
+
+	return EOK;
+}
+
+/** Send a response with header and body in one block if they fit. */
+static errno_t send_response(recv_t *recv, const char *hdr,
+    const void *body, size_t size)
 {
-	size_t response_size = str_size(msg);
+	size_t hdr_size = str_size(hdr);
 
 	if (verbose)
 		fprintf(stderr, "Sending response\n");
 
-	errno_t rc = tcp_conn_send(conn, (void *) msg, response_size);
-	if (rc != EOK) {
-		fprintf(stderr, "tcp_conn_send() failed\n");
+	if (hdr_size + size <= SEND_SIZE) {
+		memcpy(recv->sbuf, hdr, hdr_size);
+		memcpy(recv->sbuf + hdr_size, body, size);
+		return send_data(recv->conn, recv->sbuf, hdr_size + size);
+	}
+
+	errno_t rc = send_data(recv->conn, hdr, hdr_size);
+	if (rc != EOK)
 		return rc;
+
+	return send_data(recv->conn, body, size);
+}
+
+static errno_t send_error(recv_t *recv, const char *status, const char *msg,
+    bool keep_alive)
+{
+	char *hdr;
+
+	if (asprintf(&hdr,
+	    "HTTP/1.1 %s\r\n"
+	    "Content-Type: text/html\r\n"
+	    "Content-Length: %zu\r\n"
+	    "Connection: %s\r\n"
+	    "\r\n", status, str_size(msg), connection_token(keep_alive)) < 0)
+		return ENOMEM;
+
+	errno_t rc = send_response(recv, hdr, msg, str_size(msg));
+	free(hdr);
+	return rc;
+}
+
+/** Stream a file which is too large to be cached. */
+static errno_t send_file(recv_t *recv, const char *fname, int fd,
+    vfs_stat_t *stat, bool keep_alive)
+{
+	char *hdr = response_header(fname, stat->size, keep_alive);
+	if (hdr == NULL)
+		return ENOMEM;
+
+	/* The first block carries the header as well. */
+	size_t used = str_size(hdr);
+	memcpy(recv->sbuf, hdr, used);
+	free(hdr);
+
+	aoff64_t pos = 0;
+	while (true) {
+		size_t nr;
+		errno_t rc = vfs_read(fd, &pos, recv->sbuf + used,
+		    SEND_SIZE - used, &nr);
+		if (rc != EOK)
+			return rc;
+
+		used += nr;
+		if (used == 0)
+			break;
+
+		rc = send_data(recv->conn, recv->sbuf, used);
+		if (rc != EOK)
+			return rc;
+
+		if (nr == 0)
+			break;
+
+		used = 0;
 	}
 
+	/* The client cannot tell where the response ends otherwise. */
+	if (pos != stat->size)
+		return EIO;
+
 	return EOK;
 }
 
-static errno_t uri_get(const char *uri, tcp_conn_t *conn)
+static errno_t uri_get(recv_t *recv, const char *uri, bool keep_alive)
 {
-	char *fbuf = NULL;
 	char *fname = NULL;
+	cache_entry_t *entry = NULL;
 	errno_t rc;
-	size_t nr;
 	int fd = -1;
 
-	fbuf = calloc(BUFFER_SIZE, 1);
-	if (fbuf == NULL) {
-		rc = ENOMEM;
-		goto out;
-	}
-
 	if (str_cmp(uri, "/") == 0)
 		uri = "/index.html";
 
@@ -263,79 +685,126 @@ static errno_t uri_get(const char *uri, tcp_conn_t *conn)
 		goto out;
 	}
 
-	rc = vfs_lookup_open(fname, WALK_REGULAR, MODE_READ, &fd);
-	if (rc != EOK) {
-		rc = send_response(conn, msg_not_found);
-		goto out;
-	}
-
-	free(fname);
-	fname = NULL;
-
-	rc = send_response(conn, msg_ok);
-	if (rc != EOK)
-		goto out;
+	entry = cache_get(fname);
+	if (entry == NULL) {
+		rc = vfs_lookup_open(fname, WALK_REGULAR, MODE_READ, &fd);
+		if (rc != EOK) {
+			rc = send_error(recv, "404 Not Found", msg_not_found,
+			    keep_alive);
+			goto out;
+		}
 
-	aoff64_t pos = 0;
-	while (true) {
-		rc = vfs_read(fd, &pos, fbuf, BUFFER_SIZE, &nr);
+		vfs_stat_t stat;
+		rc = vfs_stat(fd, &stat);
 		if (rc != EOK)
 			goto out;
 
-		if (nr == 0)
-			break;
+		if (stat.size > CACHE_FILE_MAX) {
+			rc = send_file(recv, fname, fd, &stat, keep_alive);
+			goto out;
+		}
 
-		rc = tcp_conn_send(conn, fbuf, nr);
-		if (rc != EOK) {
-			fprintf(stderr, "tcp_conn_send() failed\n");
+		entry = cache_entry_read(fname, fd, &stat);
+		if (entry == NULL) {
+			rc = ENOMEM;
 			goto out;
 		}
+
+		entry = cache_insert(entry);
 	}
 
-	rc = EOK;
+	rc = send_response(recv, keep_alive ? entry->hdr_keep :
+	    entry->hdr_close, entry->data, entry->size);
 out:
+	if (entry != NULL)
+		cache_entry_release(entry);
 	if (fd >= 0)
 		vfs_put(fd);
 	free(fname);
-	free(fbuf);
 	return rc;
 }
 
-static errno_t req_process(tcp_conn_t *conn, recv_t *recv)
+/** Process one request
+ *
+ * @param recv       Receive buffer of the connection
+ * @param keep_alive On entry, whether the connection may be kept open.
+ *                   On exit, whether it is kept open.
+ */
+static errno_t req_process(recv_t *recv, bool *keep_alive)
 {
 	char *reqline = NULL;
+	errno_t rc;
 
-	errno_t rc = recv_line(recv, &reqline);
-	if (rc != EOK) {
-		fprintf(stderr, "recv_line() failed\n");
-		return rc;
-	}
+	/* Skip empty lines preceding the request (RFC 7230, 3.5) */
+	do {
+		rc = recv_line(recv, &reqline);
+		if (rc != EOK) {
+			if (!recv->eof)
+				fprintf(stderr, "recv_line() failed\n");
+			return rc;
+		}
+	} while (*reqline == '\0');
 
 	if (verbose)
-		fprintf(stderr, "Request: %s", reqline);
+		fprintf(stderr, "Request: %s\n", reqline);
 
-	if (str_lcmp(reqline, "GET ", 4) != 0) {
-		rc = send_response(conn, msg_not_implemented);
-		return rc;
-	}
+	bool get = str_lcmp(reqline, "GET ", 4) == 0;
+
+	char *uri = str_chr(reqline, ' ');
+	uri = (uri != NULL) ? uri + 1 : reqline + str_size(reqline);
 
-	char *uri = reqline + 4;
 	char *end_uri = str_chr(uri, ' ');
-	if (end_uri == NULL) {
-		end_uri = reqline + str_size(reqline) - 2;
-		assert(*end_uri == '\r');
+	const char *version = "";
+	if (end_uri != NULL) {
+		*end_uri = '\0';
+		version = end_uri + 1;
 	}
 
-	*end_uri = '\0';
+	/* Persistent connections are the default since HTTP/1.1 */
+	bool persistent = str_cmp(version, "HTTP/1.1") == 0;
+
+	str_cpy(recv->uri, sizeof(recv->uri), uri);
 	if (verbose)
-		fprintf(stderr, "Requested URI: %s\n", uri);
+		fprintf(stderr, "Requested URI: %s\n", recv->uri);
 
-	if (!uri_is_valid(uri)) {
-		rc = send_response(conn, msg_bad_request);
-		return rc;
+	/* Header fields follow until an empty line (not for HTTP/0.9). */
+	while (*version != '\0') {
+		char *line;
+		rc = recv_line(recv, &line);
+		if (rc != EOK)
+			return rc;
+
+		if (*line == '\0')
+			break;
+
+		if (str_lcasecmp(line, "Connection:", 11) != 0)
+			continue;
+
+		char *value = line + 11;
+		while (*value == ' ' || *value == '\t')
+			value++;
+
+		if (str_lcasecmp(value, "close", 5) == 0)
+			persistent = false;
+		else if (str_lcasecmp(value, "keep-alive", 10) == 0)
+			persistent = true;
+	}
+
+	*keep_alive = *keep_alive && persistent;
+
+	if (!get) {
+		/* The request may have a body we would not skip. */
+		*keep_alive = false;
+		return send_error(recv, "501 Not Implemented",
+		    msg_not_implemented, false);
 	}
 
-	return uri_get(uri, conn);
+	if (!uri_is_valid(recv->uri)) {
+		return send_error(recv, "400 Bad Request", msg_bad_request,
+		    *keep_alive);
+	}
+
+	return uri_get(recv, recv->uri, *keep_alive);
 }
 
 static void usage(void)
@@ -414,11 +883,27 @@ static void websrv_new_conn(tcp_listener_t *lst, tcp_conn_t *conn)
 		goto error;
 	}
 
-	rc = req_process(conn, recv);
-	if (rc != EOK) {
-		fprintf(stderr, "Error processing request (%s)\n",
-		    str_error(rc));
-		goto error;
+	/*
+	 * Requests are processed as long as the client keeps the
+	 * connection open. Pipelined requests wait in the receive
+	 * buffer while the previous response is being sent.
+	 */
+	for (unsigned int nreq = 0; nreq < KEEPALIVE_MAX; nreq++) {
+		bool keep_alive = nreq + 1 < KEEPALIVE_MAX;
+
+		rc = req_process(recv, &keep_alive);
+		if (rc != EOK) {
+			/* Closing between requests is not an error. */
+			if (recv->eof && nreq > 0)
+				break;
+
+			fprintf(stderr, "Error processing request (%s)\n",
+			    str_error(rc));
+			goto error;
+		}
+
+		if (!keep_alive)
+			break;
 	}
 
 	rc = tcp_conn_send_fin(conn);
@@ -458,6 +943,11 @@ int main(int argc, char *argv[])
 
 	printf("%s: HelenOS web server\n", NAME);
 
+	if (!hash_table_create(&cache_hash, 0, 0, &cache_hash_ops)) {
+		fprintf(stderr, "Out of memory.\n");
+		return 1;
+	}
+
 	if (verbose)
 		fprintf(stderr, "Creating listener\n");
 
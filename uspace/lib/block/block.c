@@ -58,6 +58,16 @@
 
 #define MAX_WRITE_RETRIES 10
 
+/** Number of sequential block_get() requests which trigger read-ahead */
+#define RA_TRIGGER	2
+/** Maximum number of blocks read ahead at once */
+#define RA_WINDOW	8
+
+/** Maximum number of dirty blocks collected in one write-behind pass */
+#define WB_BATCH	32
+/** Period of the write-behind fibril in microseconds */
+#define WB_INTERVAL	1000000
+
 /** Lock protecting the device connection list */
 static FIBRIL_MUTEX_INITIALIZE(dcl_lock);
 /** Device connection list head. */
@@ -73,6 +83,18 @@ typedef struct {
 	hash_table_t block_hash;
 	list_t free_list;
 	enum cache_mode mode;
+
+	aoff64_t ra_last;         /**< Last block requested by block_get(). */
+	unsigned ra_seq;          /**< Length of the current sequential run. */
+	aoff64_t ra_end;          /**< First block past the read-ahead window. */
+	unsigned ra_pending;      /**< Number of running read-ahead fibrils. */
+	fibril_condvar_t ra_cv;
+
+	bool wb_running;          /**< Write-behind fibril is running. */
+	bool wb_stop;             /**< Write-behind fibril should terminate. */
+	fibril_condvar_t wb_cv;
+
+	block_cache_stats_t stats;
 } cache_t;
 
 typedef struct {
@@ -87,9 +109,17 @@ typedef struct {
 	cache_t *cache;
 } devcon_t;
 
+/** Read-ahead request */
+typedef struct {
+	devcon_t *devcon;
+	aoff64_t ba;              /**< First logical block to read. */
+	size_t cnt;               /**< Number of logical blocks to read. */
+} cache_ra_t;
+
 static errno_t read_blocks(devcon_t *, aoff64_t, size_t, void *, size_t);
 static errno_t write_blocks(devcon_t *, aoff64_t, size_t, void *, size_t);
 static aoff64_t ba_ltop(devcon_t *, aoff64_t);
+static void block_initialize(block_t *);
 
 static devcon_t *devcon_search(service_id_t service_id)
 {
@@ -269,6 +299,189 @@ static hash_table_ops_t cache_ops = {
 	.remove_callback = NULL
 };
 
+static int cache_pba_cmp(const void *a, const void *b)
+{
+	const block_t *ba = *(const block_t **) a;
+	const block_t *bb = *(const block_t **) b;
+
+	if (ba->pba < bb->pba)
+		return -1;
+	if (ba->pba > bb->pba)
+		return 1;
+	return 0;
+}
+
+/** Write a run of physically adjacent blocks to the device.
+ *
+ * The caller holds the locks of all blocks in the run. The blocks are
+ * written using a single request whenever a bounce buffer can be
+ * allocated.
+ *
+ * @param devcon	Device connection.
+ * @param run		Array of blocks sorted by their physical address.
+ * @param cnt		Number of blocks in the run.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t cache_write_run(devcon_t *devcon, block_t **run, size_t cnt)
+{
+	cache_t *cache = devcon->cache;
+	errno_t rc;
+
+	if (cnt == 1) {
+		return write_blocks(devcon, run[0]->pba, cache->blocks_cluster,
+		    run[0]->data, run[0]->size);
+	}
+
+	uint8_t *buf = malloc(cnt * cache->lblock_size);
+	if (!buf) {
+		/* Fall back to writing the blocks one by one. */
+		for (size_t i = 0; i < cnt; i++) {
+			rc = cache_write_run(devcon, &run[i], 1);
+			if (rc != EOK)
+				return rc;
+		}
+		return EOK;
+	}
+
+	for (size_t i = 0; i < cnt; i++)
+		memcpy(buf + i * cache->lblock_size, run[i]->data,
+		    cache->lblock_size);
+
+	rc = write_blocks(devcon, run[0]->pba, cnt * cache->blocks_cluster,
+	    buf, cnt * cache->lblock_size);
+	free(buf);
+	return rc;
+}
+
+/** Write dirty unreferenced blocks back to the device.
+ *
+ * Collects up to WB_BATCH dirty blocks from the free list, sorts them by
+ * their physical address and writes each run of adjacent blocks using
+ * a single request.
+ *
+ * @param devcon	Device connection.
+ *
+ * @return		Number of blocks successfully written.
+ */
+static size_t cache_write_behind(devcon_t *devcon)
+{
+	cache_t *cache = devcon->cache;
+	block_t *blocks[WB_BATCH];
+	size_t nblocks = 0;
+	size_t written = 0;
+	size_t writes = 0;
+
+	fibril_mutex_lock(&cache->lock);
+	list_foreach(cache->free_list, free_link, block_t, b) {
+		if (nblocks == WB_BATCH)
+			break;
+		/*
+		 * A locked block on the free list is being recycled by
+		 * block_get(). Leave it alone.
+		 */
+		if (!fibril_mutex_trylock(&b->lock))
+			continue;
+		if (b->dirty && !b->toxic) {
+			b->refcnt++;
+			blocks[nblocks++] = b;
+		}
+		fibril_mutex_unlock(&b->lock);
+	}
+	for (size_t i = 0; i < nblocks; i++)
+		list_remove(&blocks[i]->free_link);
+	fibril_mutex_unlock(&cache->lock);
+
+	qsort(blocks, nblocks, sizeof(block_t *), cache_pba_cmp);
+
+	size_t i = 0;
+	while (i < nblocks) {
+		block_t *b = blocks[i++];
+
+		/*
+		 * Only write blocks which nobody else references. Holding the
+		 * block lock prevents new references from being taken, so the
+		 * contents cannot change under our hands.
+		 */
+		fibril_mutex_lock(&b->lock);
+		if (b->refcnt != 1 || !b->dirty) {
+			fibril_mutex_unlock(&b->lock);
+			continue;
+		}
+
+		block_t **run = &blocks[i - 1];
+		size_t cnt = 1;
+		while (i < nblocks && blocks[i]->pba ==
+		    b->pba + cnt * cache->blocks_cluster) {
+			block_t *next = blocks[i];
+
+			fibril_mutex_lock(&next->lock);
+			if (next->refcnt != 1 || !next->dirty) {
+				fibril_mutex_unlock(&next->lock);
+				break;
+			}
+			cnt++;
+			i++;
+		}
+
+		errno_t rc = cache_write_run(devcon, run, cnt);
+		writes++;
+		for (size_t j = 0; j < cnt; j++) {
+			if (rc == EOK) {
+				run[j]->dirty = false;
+				run[j]->write_failures = 0;
+			}
+			fibril_mutex_unlock(&run[j]->lock);
+		}
+		if (rc == EOK)
+			written += cnt;
+	}
+
+	if (writes > 0) {
+		fibril_mutex_lock(&cache->lock);
+		cache->stats.wb_blocks += written;
+		cache->stats.wb_writes += writes;
+		fibril_mutex_unlock(&cache->lock);
+	}
+
+	for (size_t j = 0; j < nblocks; j++)
+		(void) block_put(blocks[j]);
+
+	return written;
+}
+
+/** Write-behind fibril.
+ *
+ * Periodically writes dirty blocks of a write-back cache to the device
+ * so that they do not need to be written synchronously when they are
+ * being recycled.
+ *
+ * @param arg		Device connection.
+ */
+static errno_t cache_wb_fibril(void *arg)
+{
+	devcon_t *devcon = (devcon_t *) arg;
+	cache_t *cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+	while (!cache->wb_stop) {
+		(void) fibril_condvar_wait_timeout(&cache->wb_cv, &cache->lock,
+		    WB_INTERVAL);
+		if (cache->wb_stop)
+			break;
+
+		fibril_mutex_unlock(&cache->lock);
+		(void) cache_write_behind(devcon);
+		fibril_mutex_lock(&cache->lock);
+	}
+
+	cache->wb_running = false;
+	fibril_condvar_broadcast(&cache->wb_cv);
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
 errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
     enum cache_mode mode)
 {
@@ -288,6 +501,15 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 	cache->block_count = blocks;
 	cache->blocks_cached = 0;
 	cache->mode = mode;
+	cache->ra_last = 0;
+	cache->ra_seq = 0;
+	cache->ra_end = 0;
+	cache->ra_pending = 0;
+	fibril_condvar_initialize(&cache->ra_cv);
+	cache->wb_running = false;
+	cache->wb_stop = false;
+	fibril_condvar_initialize(&cache->wb_cv);
+	memset(&cache->stats, 0, sizeof(cache->stats));
 
 	/* Allow 1:1 or small-to-large block size translation */
 	if (cache->lblock_size % devcon->pblock_size != 0) {
@@ -303,6 +525,19 @@ errno_t block_cache_init(service_id_t service_id, size_t size, unsigned blocks,
 	}
 
 	devcon->cache = cache;
+
+	if (mode == CACHE_MODE_WB) {
+		/*
+		 * Failing to start the write-behind fibril is not fatal.
+		 * Dirty blocks get written when they are recycled.
+		 */
+		fid_t fid = fibril_create(cache_wb_fibril, devcon);
+		if (fid != 0) {
+			cache->wb_running = true;
+			fibril_add_ready(fid);
+		}
+	}
+
 	return EOK;
 }
 
@@ -318,6 +553,20 @@ errno_t block_cache_fini(service_id_t service_id)
 		return EOK;
 	cache = devcon->cache;
 
+	/* Stop the write-behind fibril and wait for pending read-ahead. */
+	fibril_mutex_lock(&cache->lock);
+	cache->wb_stop = true;
+	fibril_condvar_broadcast(&cache->wb_cv);
+	while (cache->wb_running)
+		fibril_condvar_wait(&cache->wb_cv, &cache->lock);
+	while (cache->ra_pending > 0)
+		fibril_condvar_wait(&cache->ra_cv, &cache->lock);
+	fibril_mutex_unlock(&cache->lock);
+
+	/* Write back dirty blocks in as few requests as possible. */
+	while (cache_write_behind(devcon) > 0)
+		;
+
 	/*
 	 * We are expecting to find all blocks for this device handle on the
 	 * free list, i.e. the block reference count should be zero. Do not
@@ -348,6 +597,30 @@ errno_t block_cache_fini(service_id_t service_id)
 	return EOK;
 }
 
+/** Get block cache statistics.
+ *
+ * @param service_id	Service ID of the block device.
+ * @param stats		Place to store the statistics.
+ *
+ * @return		EOK on success, ENOENT if the device is not known
+ *			or has no cache.
+ */
+errno_t block_cache_get_stats(service_id_t service_id,
+    block_cache_stats_t *stats)
+{
+	devcon_t *devcon = devcon_search(service_id);
+	if (!devcon || !devcon->cache)
+		return ENOENT;
+
+	cache_t *cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+	*stats = cache->stats;
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
 #define CACHE_LO_WATERMARK	10
 #define CACHE_HI_WATERMARK	20
 static bool cache_can_grow(cache_t *cache)
@@ -366,10 +639,201 @@ static void block_initialize(block_t *b)
 	b->write_failures = 0;
 	b->dirty = false;
 	b->toxic = false;
+	b->prefetched = false;
 	fibril_rwlock_initialize(&b->contents_lock);
 	link_initialize(&b->free_link);
 }
 
+/** Get a block for read-ahead.
+ *
+ * Unlike block_get(), read-ahead never waits for a dirty block to be
+ * written back. The cache may grow up to the high watermark; beyond that
+ * only clean unreferenced blocks are recycled.
+ *
+ * @param cache		Cache. The cache lock must be held.
+ *
+ * @return		Block or NULL if no block is readily available.
+ */
+static block_t *cache_ra_alloc(cache_t *cache)
+{
+	block_t *b;
+
+	if (cache->blocks_cached < CACHE_HI_WATERMARK) {
+		b = malloc(sizeof(block_t));
+		if (b) {
+			b->data = malloc(cache->lblock_size);
+			if (b->data) {
+				cache->blocks_cached++;
+				return b;
+			}
+			free(b);
+		}
+	}
+
+	if (list_empty(&cache->free_list))
+		return NULL;
+
+	b = list_get_instance(list_first(&cache->free_list), block_t,
+	    free_link);
+	if (!fibril_mutex_trylock(&b->lock))
+		return NULL;
+	if (b->dirty) {
+		fibril_mutex_unlock(&b->lock);
+		return NULL;
+	}
+	fibril_mutex_unlock(&b->lock);
+
+	list_remove(&b->free_link);
+	hash_table_remove_item(&cache->block_hash, &b->hash_link);
+	return b;
+}
+
+/** Read-ahead fibril.
+ *
+ * Instantiates the blocks of the read-ahead window which are not cached
+ * yet and reads them from the device using a single request.
+ *
+ * @param arg		Read-ahead request.
+ */
+static errno_t cache_ra_fibril(void *arg)
+{
+	cache_ra_t *ra = (cache_ra_t *) arg;
+	devcon_t *devcon = ra->devcon;
+	cache_t *cache = devcon->cache;
+	block_t *blocks[RA_WINDOW];
+	size_t cnt = 0;
+
+	uint8_t *buf = malloc(ra->cnt * cache->lblock_size);
+
+	fibril_mutex_lock(&cache->lock);
+	while (buf && cnt < ra->cnt) {
+		aoff64_t ba = ra->ba + cnt;
+
+		/* Stop at the first block which is already cached. */
+		if (hash_table_find(&cache->block_hash, &ba))
+			break;
+
+		block_t *b = cache_ra_alloc(cache);
+		if (!b)
+			break;
+
+		block_initialize(b);
+		b->service_id = devcon->service_id;
+		b->size = cache->lblock_size;
+		b->lba = ba;
+		b->pba = ba_ltop(devcon, b->lba);
+		b->prefetched = true;
+		hash_table_insert(&cache->block_hash, &b->hash_link);
+
+		/* Block concurrent block_get() until the data is read. */
+		fibril_mutex_lock(&b->lock);
+		blocks[cnt++] = b;
+	}
+	fibril_mutex_unlock(&cache->lock);
+
+	if (cnt > 0) {
+		errno_t rc = read_blocks(devcon, blocks[0]->pba,
+		    cnt * cache->blocks_cluster, buf, cnt * cache->lblock_size);
+
+		for (size_t i = 0; i < cnt; i++) {
+			if (rc == EOK) {
+				memcpy(blocks[i]->data,
+				    buf + i * cache->lblock_size,
+				    cache->lblock_size);
+			} else {
+				blocks[i]->toxic = true;
+			}
+			fibril_mutex_unlock(&blocks[i]->lock);
+		}
+
+		if (rc == EOK) {
+			fibril_mutex_lock(&cache->lock);
+			cache->stats.prefetched += cnt;
+			fibril_mutex_unlock(&cache->lock);
+		}
+
+		for (size_t i = 0; i < cnt; i++)
+			(void) block_put(blocks[i]);
+	}
+
+	free(buf);
+	free(ra);
+
+	fibril_mutex_lock(&cache->lock);
+	cache->ra_pending--;
+	fibril_condvar_broadcast(&cache->ra_cv);
+	fibril_mutex_unlock(&cache->lock);
+
+	return EOK;
+}
+
+/** Track sequential access and start read-ahead if appropriate.
+ *
+ * Once RA_TRIGGER consecutive blocks have been requested, the following
+ * RA_WINDOW blocks are read asynchronously. The window is advanced when
+ * the reader gets past its middle so that the device is kept busy while
+ * the reader consumes the data.
+ *
+ * @param devcon	Device connection.
+ * @param ba		Logical block address being requested.
+ */
+static void cache_read_ahead(devcon_t *devcon, aoff64_t ba)
+{
+	cache_t *cache = devcon->cache;
+
+	fibril_mutex_lock(&cache->lock);
+
+	if (ba == cache->ra_last + 1) {
+		cache->ra_seq++;
+	} else if (ba != cache->ra_last) {
+		cache->ra_seq = 0;
+		cache->ra_end = 0;
+	}
+	cache->ra_last = ba;
+
+	if (cache->ra_seq < RA_TRIGGER ||
+	    ba + RA_WINDOW / 2 < cache->ra_end) {
+		fibril_mutex_unlock(&cache->lock);
+		return;
+	}
+
+	aoff64_t start = max(ba + 1, cache->ra_end);
+	size_t cnt = ba + 1 + RA_WINDOW - start;
+
+	/* Do not read past the end of the device. */
+	while (cnt > 0 && ba_ltop(devcon, start + cnt - 1) +
+	    cache->blocks_cluster > devcon->pblocks)
+		cnt--;
+
+	if (cnt == 0) {
+		fibril_mutex_unlock(&cache->lock);
+		return;
+	}
+
+	cache_ra_t *ra = malloc(sizeof(cache_ra_t));
+	if (!ra) {
+		fibril_mutex_unlock(&cache->lock);
+		return;
+	}
+
+	ra->devcon = devcon;
+	ra->ba = start;
+	ra->cnt = cnt;
+
+	fid_t fid = fibril_create(cache_ra_fibril, ra);
+	if (fid == 0) {
+		fibril_mutex_unlock(&cache->lock);
+		free(ra);
+		return;
+	}
+
+	cache->ra_end = start + cnt;
+	cache->ra_pending++;
+	fibril_mutex_unlock(&cache->lock);
+
+	fibril_add_ready(fid);
+}
+
 /** Instantiate a block in memory and get a reference to it.
  *
  * @param block			Pointer to where the function will store the
@@ -404,11 +868,13 @@ errno_t block_get(block_t **block, service_id_t service_id, aoff64_t ba, int fla
 	 */
 	p_ba = ba_ltop(devcon, ba);
 	p_ba += cache->blocks_cluster;
-	if (p_ba >= devcon->pblocks) {
+	if (p_ba > devcon->pblocks) {
 		/* This request cannot be satisfied */
 		return EIO;
 	}
 
+	if (!(flags & BLOCK_FLAGS_NOREAD))
+		cache_read_ahead(devcon, ba);
 
 retry:
 	rc = EOK;
@@ -425,8 +891,35 @@ retry:
 		fibril_mutex_lock(&b->lock);
 		if (b->refcnt++ == 0)
 			list_remove(&b->free_link);
+		if (b->toxic && b->prefetched) {
+			/*
+			 * Read-ahead of the block failed. The block will be
+			 * dropped from the cache once the read-ahead fibril
+			 * releases it, but in the meantime read it on our own
+			 * rather than failing the request.
+			 */
+			b->prefetched = false;
+			cache->stats.misses++;
+			fibril_mutex_unlock(&cache->lock);
+
+			if (!(flags & BLOCK_FLAGS_NOREAD)) {
+				rc = read_blocks(devcon, b->pba,
+				    cache->blocks_cluster, b->data,
+				    cache->lblock_size);
+			}
+			if (rc == EOK)
+				b->toxic = false;
+
+			fibril_mutex_unlock(&b->lock);
+			goto out;
+		}
 		if (b->toxic)
 			rc = EIO;
+		cache->stats.hits++;
+		if (b->prefetched) {
+			b->prefetched = false;
+			cache->stats.prefetch_hits++;
+		}
 		fibril_mutex_unlock(&b->lock);
 		fibril_mutex_unlock(&cache->lock);
 	} else {
@@ -539,6 +1032,7 @@ retry:
 		b->lba = ba;
 		b->pba = ba_ltop(devcon, b->lba);
 		hash_table_insert(&cache->block_hash, &b->hash_link);
+		cache->stats.misses++;
 
 		/*
 		 * Lock the block before releasing the cache lock. Thus we don't
@@ -629,11 +1123,13 @@ retry:
 		 * free the block.
 		 */
 		if ((cache->blocks_cached > CACHE_HI_WATERMARK) ||
-		    (rc != EOK)) {
+		    (rc != EOK) || block->toxic) {
 			/*
-			 * Currently there are too many cached blocks or there
+			 * Currently there are too many cached blocks, there
 			 * was an I/O error when writing the block back to the
-			 * device.
+			 * device or the block could not be read. Do not keep
+			 * toxic blocks around so that the next block_get()
+			 * retries the read.
 			 */
 			if (block->dirty) {
 				/*
@@ -208,6 +208,78 @@ void rel_table_process(module_t *m, elf_rel_t *rt, size_t rt_size)
 
 }
 
+/** Prepare a PLT relocation table for lazy binding.
+ *
+ * The GOT entries of the PLT initially point back to the PLT, to the code
+ * which pushes the relocation offset and jumps to the first PLT entry.
+ * The first PLT entry pushes the second GOT entry and jumps to the address
+ * in the third one, which are set to the module and the resolver.
+ *
+ * @param m		Module
+ * @param rt		PLT relocation table
+ * @param rt_size	Size of the relocation table in bytes
+ * @param resolver	Address of the PLT resolver trampoline
+ * @return		@c true on success, @c false if the table contains
+ *			relocations which cannot be processed lazily
+ */
+bool rel_table_lazy(module_t *m, elf_rel_t *rt, size_t rt_size,
+    void *resolver)
+{
+	size_t rt_entries = rt_size / sizeof(elf_rel_t);
+	uint32_t *got = m->dyn.plt_got;
+	size_t i;
+
+	DPRINTF("lazy relocation table\n");
+
+	for (i = 0; i < rt_entries; ++i) {
+		if (ELF32_R_TYPE(rt[i].r_info) != R_386_JUMP_SLOT)
+			return false;
+	}
+
+	for (i = 0; i < rt_entries; ++i) {
+		uint32_t *r_ptr = (uint32_t *)(rt[i].r_offset + m->bias);
+		*r_ptr += m->bias;
+	}
+
+	got[1] = (uint32_t) m;
+	got[2] = (uint32_t) resolver;
+
+	return true;
+}
+
+/** Bind a PLT entry on its first use.
+ *
+ * Called by the PLT resolver trampoline.
+ *
+ * @param m		Module whose PLT entry is used
+ * @param reloc_off	Offset of the relocation in the PLT relocation table
+ * @return		Address of the called function
+ */
+void *rtld_plt_bind(module_t *m, size_t reloc_off)
+{
+	elf_rel_t *rel;
+	elf_symbol_t *sym;
+	elf_symbol_t *sym_def;
+	module_t *dest;
+	const char *name;
+	uint32_t sym_addr;
+
+	rel = (elf_rel_t *)((uint8_t *) m->dyn.jmp_rel + reloc_off);
+	sym = &((elf_symbol_t *) m->dyn.sym_tab)[ELF32_R_SYM(rel->r_info)];
+	name = m->dyn.str_tab + sym->st_name;
+
+	sym_def = symbol_def_find(name, m, ssf_none, &dest);
+	if (sym_def == NULL) {
+		printf("Definition of '%s' not found.\n", name);
+		exit(1);
+	}
+
+	sym_addr = (uint32_t) symbol_get_addr(sym_def, dest, NULL);
+	*(uint32_t *)(rel->r_offset + m->bias) = sym_addr;
+
+	return (void *) sym_addr;
+}
+
 void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size)
 {
 	/* Unused */
@@ -46,6 +46,13 @@
  * have fairly large (prime/odd) divisors. Having a prime table size
  * mitigates the use of suboptimal hash functions and distributes
  * items over the whole table.
+ *
+ * Resizing does not rehash all items at once. The old buckets are kept
+ * around and every mutating operation migrates a few of them to the new
+ * table, so that the cost of a resize is spread over many operations.
+ * Items with the same hash always reside in a single bucket, which is
+ * the old one until it has been migrated and the new one afterwards.
+ * Each item caches its hash, so migrating it does not call op->hash().
  */
 
 #include <adt/hash_table.h>
@@ -58,12 +65,16 @@
 #define HT_MIN_BUCKETS  89
 /* The table is resized when the average load per bucket exceeds this number. */
 #define HT_MAX_LOAD     2
+/* Number of old buckets migrated by each mutating operation. */
+#define HT_MIGRATE_BUCKETS  8
 
 
 static size_t round_up_size(size_t);
 static bool alloc_table(size_t, list_t **);
 static void clear_items(hash_table_t *);
 static void resize(hash_table_t *, size_t);
+static void migrate(hash_table_t *, size_t);
+static void migrate_all(hash_table_t *);
 static void grow_if_needed(hash_table_t *);
 static void shrink_if_needed(hash_table_t *);
 
@@ -73,6 +84,22 @@ static void nop_remove_callback(ht_link_t *item)
 	/* no-op */
 }
 
+/** Get the bucket in which items with the given hash reside.
+ *
+ * During a migration, items stay in their old bucket until the whole
+ * bucket is migrated to the new table.
+ */
+static inline list_t *get_bucket(const hash_table_t *h, size_t hash)
+{
+	if (h->old_bucket != NULL) {
+		size_t old_idx = hash % h->old_bucket_cnt;
+		if (h->migrate_idx <= old_idx)
+			return &h->old_bucket[old_idx];
+	}
+
+	return &h->bucket[hash % h->bucket_cnt];
+}
+
 
 /** Create chained hash table.
  *
@@ -105,6 +132,10 @@ bool hash_table_create(hash_table_t *h, size_t init_size, size_t max_load,
 	if (!alloc_table(h->bucket_cnt, &h->bucket))
 		return false;
 
+	h->old_bucket = NULL;
+	h->old_bucket_cnt = 0;
+	h->migrate_idx = 0;
+
 	h->max_load = (max_load == 0) ? HT_MAX_LOAD : max_load;
 	h->item_cnt = 0;
 	h->op = op;
@@ -129,6 +160,7 @@ void hash_table_destroy(hash_table_t *h)
 	assert(!h->apply_ongoing);
 
 	clear_items(h);
+	migrate_all(h);
 
 	free(h->bucket);
 
@@ -173,6 +205,8 @@ static void clear_items(hash_table_t *h)
 	if (h->item_cnt == 0)
 		return;
 
+	migrate_all(h);
+
 	for (size_t idx = 0; idx < h->bucket_cnt; ++idx) {
 		list_foreach_safe(h->bucket[idx], cur, next) {
 			assert(cur);
@@ -197,10 +231,11 @@ void hash_table_insert(hash_table_t *h, ht_link_t *item)
 	assert(h && h->bucket);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	item->hash = h->op->hash(item);
 
-	list_append(&item->link, &h->bucket[idx]);
+	list_append(&item->link, get_bucket(h, item->hash));
 	++h->item_cnt;
+	migrate(h, HT_MIGRATE_BUCKETS);
 	grow_if_needed(h);
 }
 
@@ -220,20 +255,20 @@ bool hash_table_insert_unique(hash_table_t *h, ht_link_t *item)
 	assert(h->op && h->op->hash && h->op->equal);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	item->hash = h->op->hash(item);
+	list_t *bucket = get_bucket(h, item->hash);
 
 	/* Check for duplicates. */
-	list_foreach(h->bucket[idx], link, ht_link_t, cur_link) {
-		/*
-		 * We could filter out items using their hashes first, but
-		 * calling equal() might very well be just as fast.
-		 */
-		if (h->op->equal(cur_link, item))
+	list_foreach(*bucket, link, ht_link_t, cur_link) {
+		/* Filter out items using their cached hashes first. */
+		if (cur_link->hash == item->hash &&
+		    h->op->equal(cur_link, item))
 			return false;
 	}
 
-	list_append(&item->link, &h->bucket[idx]);
+	list_append(&item->link, bucket);
 	++h->item_cnt;
+	migrate(h, HT_MIGRATE_BUCKETS);
 	grow_if_needed(h);
 
 	return true;
@@ -251,15 +286,14 @@ ht_link_t *hash_table_find(const hash_table_t *h, void *key)
 {
 	assert(h && h->bucket);
 
-	size_t idx = h->op->key_hash(key) % h->bucket_cnt;
+	size_t hash = h->op->key_hash(key);
 
-	list_foreach(h->bucket[idx], link, ht_link_t, cur_link) {
+	list_foreach(*get_bucket(h, hash), link, ht_link_t, cur_link) {
 		/*
-		 * Is this is the item we are looking for? We could have first
-		 * checked if the hashes match but op->key_equal() may very well be
-		 * just as fast as op->hash().
+		 * Is this is the item we are looking for? Comparing the cached
+		 * hashes first is cheap and spares most op->key_equal() calls.
 		 */
-		if (h->op->key_equal(key, cur_link)) {
+		if (cur_link->hash == hash && h->op->key_equal(key, cur_link)) {
 			return cur_link;
 		}
 	}
@@ -274,23 +308,23 @@ hash_table_find_next(const hash_table_t *h, ht_link_t *first, ht_link_t *item)
 	assert(item);
 	assert(h && h->bucket);
 
-	size_t idx = h->op->hash(item) % h->bucket_cnt;
+	list_t *bucket = get_bucket(h, item->hash);
 
 	/* Traverse the circular list until we reach the starting item again. */
 	for (link_t *cur = item->link.next; cur != &first->link;
 	    cur = cur->next) {
 		assert(cur);
 
-		if (cur == &h->bucket[idx].head)
+		if (cur == &bucket->head)
 			continue;
 
 		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
 		/*
-		 * Is this is the item we are looking for? We could have first
-		 * checked if the hashes match but op->equal() may very well be
-		 * just as fast as op->hash().
+		 * Is this is the item we are looking for? Comparing the cached
+		 * hashes first is cheap and spares most op->equal() calls.
 		 */
-		if (h->op->equal(cur_link, item)) {
+		if (cur_link->hash == item->hash &&
+		    h->op->equal(cur_link, item)) {
 			return cur_link;
 		}
 	}
@@ -314,14 +348,14 @@ size_t hash_table_remove(hash_table_t *h, void *key)
 	assert(h && h->bucket);
 	assert(!h->apply_ongoing);
 
-	size_t idx = h->op->key_hash(key) % h->bucket_cnt;
+	size_t hash = h->op->key_hash(key);
 
 	size_t removed = 0;
 
-	list_foreach_safe(h->bucket[idx], cur, next) {
+	list_foreach_safe(*get_bucket(h, hash), cur, next) {
 		ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
 
-		if (h->op->key_equal(key, cur_link)) {
+		if (cur_link->hash == hash && h->op->key_equal(key, cur_link)) {
 			++removed;
 			list_remove(cur);
 			h->op->remove_callback(cur_link);
@@ -329,6 +363,7 @@ size_t hash_table_remove(hash_table_t *h, void *key)
 	}
 
 	h->item_cnt -= removed;
+	migrate(h, HT_MIGRATE_BUCKETS);
 	shrink_if_needed(h);
 
 	return removed;
@@ -344,6 +379,7 @@ void hash_table_remove_item(hash_table_t *h, ht_link_t *item)
 	list_remove(&item->link);
 	--h->item_cnt;
 	h->op->remove_callback(item);
+	migrate(h, HT_MIGRATE_BUCKETS);
 	shrink_if_needed(h);
 }
 
@@ -364,6 +400,9 @@ void hash_table_apply(hash_table_t *h, bool (*f)(ht_link_t *, void *), void *arg
 	if (h->item_cnt == 0)
 		return;
 
+	/* All items are visited anyway, so finish any pending migration. */
+	migrate_all(h);
+
 	h->apply_ongoing = true;
 
 	for (size_t idx = 0; idx < h->bucket_cnt; ++idx) {
@@ -437,7 +476,11 @@ static inline void grow_if_needed(hash_table_t *h)
 	}
 }
 
-/** Allocates and rehashes items to a new table. Frees the old table. */
+/** Allocates a new table and starts migrating items to it.
+ *
+ * The items are moved to the new table gradually by migrate(). A migration
+ * still in progress from a previous resize is finished first.
+ */
 static void resize(hash_table_t *h, size_t new_bucket_cnt)
 {
 	assert(h && h->bucket);
@@ -453,25 +496,57 @@ static void resize(hash_table_t *h, size_t new_bucket_cnt)
 	if (!alloc_table(new_bucket_cnt, &new_buckets))
 		return;
 
+	migrate_all(h);
+
 	if (0 < h->item_cnt) {
-		/* Rehash all the items to the new table. */
-		for (size_t old_idx = 0; old_idx < h->bucket_cnt; ++old_idx) {
-			list_foreach_safe(h->bucket[old_idx], cur, next) {
-				ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
-
-				size_t new_idx = h->op->hash(cur_link) % new_bucket_cnt;
-				list_remove(cur);
-				list_append(cur, &new_buckets[new_idx]);
-			}
-		}
+		h->old_bucket = h->bucket;
+		h->old_bucket_cnt = h->bucket_cnt;
+		h->migrate_idx = 0;
+	} else {
+		free(h->bucket);
 	}
 
-	free(h->bucket);
 	h->bucket = new_buckets;
 	h->bucket_cnt = new_bucket_cnt;
 	h->full_item_cnt = h->max_load * h->bucket_cnt;
 }
 
+/** Migrates up to @a cnt old buckets to the new table.
+ *
+ * The old table is freed once all of its buckets have been migrated.
+ */
+static void migrate(hash_table_t *h, size_t cnt)
+{
+	/* Migrating would mess up the buckets of an ongoing traversal. */
+	if (h->old_bucket == NULL || h->apply_ongoing)
+		return;
+
+	size_t end = h->migrate_idx +
+	    min(cnt, h->old_bucket_cnt - h->migrate_idx);
+
+	for (; h->migrate_idx < end; ++h->migrate_idx) {
+		list_foreach_safe(h->old_bucket[h->migrate_idx], cur, next) {
+			ht_link_t *cur_link = member_to_inst(cur, ht_link_t, link);
+
+			size_t new_idx = cur_link->hash % h->bucket_cnt;
+			list_remove(cur);
+			list_append(cur, &h->bucket[new_idx]);
+		}
+	}
+
+	if (h->migrate_idx == h->old_bucket_cnt) {
+		free(h->old_bucket);
+		h->old_bucket = NULL;
+		h->old_bucket_cnt = 0;
+		h->migrate_idx = 0;
+	}
+}
+
+/** Finishes any migration in progress. */
+static void migrate_all(hash_table_t *h)
+{
+	migrate(h, h->old_bucket_cnt);
+}
 
 /** @}
  */
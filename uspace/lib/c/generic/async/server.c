@@ -159,6 +159,9 @@ typedef struct {
 	/** Link to the client tracking structure. */
 	client_t *client;
 
+	/** Protects msg_queue and close_chandle. */
+	futex_t lock;
+
 	/** Message event. */
 	fibril_event_t msg_arrived;
 
@@ -249,7 +252,11 @@ static long notification_freelist_used = 0;
 
 static sysarg_t notification_avail = 0;
 
-/* The remaining structures are guarded by async_futex. */
+/*
+ * The connection table has a lock of its own so that routing calls does not
+ * contend with fibril synchronization, which is serialized by async_futex.
+ */
+static futex_t conn_futex = FUTEX_INITIALIZER;
 static hash_table_t conn_hash_table;
 
 static size_t client_key_hash(void *key)
@@ -429,12 +436,19 @@ static errno_t connection_fibril(void *arg)
 	/*
 	 * Remove myself from the connection hash table.
 	 */
-	futex_lock(&async_futex);
+	futex_lock(&conn_futex);
 	hash_table_remove(&conn_hash_table, &(conn_key_t){
 		.task_id = fibril_connection->in_task_id,
 		.phone_hash = fibril_connection->in_phone_hash
 	});
-	futex_unlock(&async_futex);
+	futex_unlock(&conn_futex);
+
+	/*
+	 * Wait for route_call() that may have found the connection
+	 * before it was removed. No more messages can arrive after that.
+	 */
+	futex_lock(&fibril_connection->lock);
+	futex_unlock(&fibril_connection->lock);
 
 	/*
 	 * Answer all remaining messages with EHANGUP.
@@ -491,6 +505,7 @@ static fid_t async_new_connection(task_id_t in_task_id, sysarg_t in_phone_hash,
 
 	conn->in_task_id = in_task_id;
 	conn->in_phone_hash = in_phone_hash;
+	futex_initialize(&conn->lock, 1);
 	conn->msg_arrived = FIBRIL_EVENT_INIT;
 	list_initialize(&conn->msg_queue);
 	conn->close_chandle = CAP_NIL;
@@ -516,9 +531,9 @@ static fid_t async_new_connection(task_id_t in_task_id, sysarg_t in_phone_hash,
 
 	/* Add connection to the connection hash table */
 
-	futex_lock(&async_futex);
+	futex_lock(&conn_futex);
 	hash_table_insert(&conn_hash_table, &conn->link);
-	futex_unlock(&async_futex);
+	futex_unlock(&conn_futex);
 
 	fibril_add_ready(conn->fid);
 
@@ -617,27 +632,29 @@ static bool route_call(ipc_call_t *call)
 {
 	assert(call);
 
-	futex_lock(&async_futex);
+	msg_t *msg = malloc(sizeof(*msg));
+	if (!msg)
+		return false;
+
+	msg->call = *call;
+
+	futex_lock(&conn_futex);
 
 	ht_link_t *link = hash_table_find(&conn_hash_table, &(conn_key_t){
 		.task_id = call->in_task_id,
 		.phone_hash = call->in_phone_hash
 	});
 	if (!link) {
-		futex_unlock(&async_futex);
+		futex_unlock(&conn_futex);
+		free(msg);
 		return false;
 	}
 
 	connection_t *conn = hash_table_get_inst(link, connection_t, link);
 
-	// FIXME: malloc in critical section
-	msg_t *msg = malloc(sizeof(*msg));
-	if (!msg) {
-		futex_unlock(&async_futex);
-		return false;
-	}
+	futex_lock(&conn->lock);
+	futex_unlock(&conn_futex);
 
-	msg->call = *call;
 	list_append(&msg->link, &conn->msg_queue);
 
 	if (IPC_GET_IMETHOD(*call) == IPC_M_PHONE_HUNGUP)
@@ -646,7 +663,7 @@ static bool route_call(ipc_call_t *call)
 	/* If the connection fibril is waiting for an event, activate it */
 	fibril_notify(&conn->msg_arrived);
 
-	futex_unlock(&async_futex);
+	futex_unlock(&conn->lock);
 	return true;
 }
 
@@ -959,7 +976,7 @@ bool async_get_call_timeout(ipc_call_t *call, suseconds_t usecs)
 		expires = &tv;
 	}
 
-	futex_lock(&async_futex);
+	futex_lock(&conn->lock);
 
 	/* If nothing in queue, wait until something arrives */
 	while (list_empty(&conn->msg_queue)) {
@@ -973,18 +990,18 @@ bool async_get_call_timeout(ipc_call_t *call, suseconds_t usecs)
 			 */
 			memset(call, 0, sizeof(ipc_call_t));
 			IPC_SET_IMETHOD(*call, IPC_M_PHONE_HUNGUP);
-			futex_unlock(&async_futex);
+			futex_unlock(&conn->lock);
 			return true;
 		}
 
 		// TODO: replace with cvar
-		futex_unlock(&async_futex);
+		futex_unlock(&conn->lock);
 
 		errno_t rc = fibril_wait_timeout(&conn->msg_arrived, expires);
 		if (rc == ETIMEOUT)
 			return false;
 
-		futex_lock(&async_futex);
+		futex_lock(&conn->lock);
 	}
 
 	msg_t *msg = list_get_instance(list_first(&conn->msg_queue),
@@ -994,7 +1011,7 @@ bool async_get_call_timeout(ipc_call_t *call, suseconds_t usecs)
 	*call = msg->call;
 	free(msg);
 
-	futex_unlock(&async_futex);
+	futex_unlock(&conn->lock);
 	return true;
 }
 
@@ -1122,6 +1139,25 @@ fid_t async_create_manager(void)
 	return fid;
 }
 
+/** Spawn runner threads together with an IPC manager fibril for each.
+ *
+ * Servers call this at startup to process requests on several CPUs.
+ *
+ * @param n Number of runners to spawn.
+ *
+ * @return Number of runners successfully spawned.
+ *
+ */
+int async_spawn_runners(int n)
+{
+	int spawned = fibril_spawn_runners(n);
+
+	for (int i = 0; i < spawned; i++)
+		async_create_manager();
+
+	return spawned;
+}
+
 /** Initialize the async framework.
  *
  */
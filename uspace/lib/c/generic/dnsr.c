@@ -191,5 +191,35 @@ errno_t dnsr_set_srvaddr(inet_addr_t *srvaddr)
 	return retval;
 }
 
+errno_t dnsr_get_stats(dnsr_stats_t *stats)
+{
+	async_exch_t *exch = dnsr_exchange_begin();
+
+	ipc_call_t answer;
+	aid_t req = async_send_0(exch, DNSR_GET_STATS, &answer);
+	errno_t rc = async_data_read_start(exch, stats, sizeof(dnsr_stats_t));
+
+	dnsr_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_forget(req);
+		return rc;
+	}
+
+	errno_t retval;
+	async_wait_for(req, &retval);
+
+	return retval;
+}
+
+errno_t dnsr_flush_cache(void)
+{
+	async_exch_t *exch = dnsr_exchange_begin();
+	errno_t rc = async_req_0_0(exch, DNSR_FLUSH_CACHE);
+	dnsr_exchange_end(exch);
+
+	return rc;
+}
+
 /** @}
  */
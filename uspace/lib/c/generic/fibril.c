@@ -46,15 +46,41 @@
 
 #include <mem.h>
 #include <str.h>
+#include <sysinfo.h>
+#include <macros.h>
 #include <ipc/ipc.h>
 #include <libarch/faddr.h>
 #include "private/thread.h"
 #include "private/fibril.h"
 #include "private/libc.h"
+#include "private/malloc.h"
 
 #define DPRINTF(...) ((void)0)
 #undef READY_DEBUG
 
+/** Maximum number of distinct run queues. Further runners share them. */
+#define RUNNERS_MAX  64
+
+/** Default total number of runners in a multithreaded task. */
+#define RUNNERS_DEFAULT  4
+
+/** Per-thread queue of ready fibrils.
+ *
+ * A fibril made ready is queued in the run queue of the thread that made it
+ * ready, so that it is likely to run on the same thread (and CPU) again.
+ * A thread that runs out of work steals from the other queues.
+ */
+typedef struct fibril_runner {
+	/** Protects the ready list. Nests inside fibril_futex. */
+	futex_t lock;
+	list_t ready;
+	/**
+	 * Length of the ready list. Changed under the lock, but also peeked
+	 * at without it, hence accessed atomically.
+	 */
+	size_t count;
+} _runner_t;
+
 /** Member of timeout_list. */
 typedef struct {
 	link_t link;
@@ -89,7 +115,10 @@ static futex_t fibril_futex = FUTEX_INITIALIZER;
 static futex_t ready_semaphore = FUTEX_INITIALIZE(0);
 static long ready_st_count;
 
-static LIST_INITIALIZE(ready_list);
+static _runner_t runners[RUNNERS_MAX];
+static atomic_t runners_used = { 0 };
+static atomic_t runners_spawned = { 0 };
+
 static LIST_INITIALIZE(fibril_list);
 static LIST_INITIALIZE(timeout_list);
 
@@ -109,8 +138,9 @@ static inline void _ready_debug_check(void)
 {
 #ifdef READY_DEBUG
 	assert(!multithreaded);
-	long count = (long) list_count(&ready_list) +
-	    (long) list_count(&ipc_buffer_free_list);
+	long count = (long) list_count(&ipc_buffer_free_list);
+	for (size_t i = 0; i < RUNNERS_MAX; i++)
+		count += (long) list_count(&runners[i].ready);
 	assert(ready_st_count == count);
 #endif
 }
@@ -119,7 +149,7 @@ static inline long _ready_count(void)
 {
 	/*
 	 * The number of available tokens is always equal to the number
-	 * of fibrils in the ready list + the number of free IPC buffer
+	 * of fibrils in the run queues + the number of free IPC buffer
 	 * buckets.
 	 */
 
@@ -209,6 +239,8 @@ void fibril_teardown(fibril_t *fibril)
 	list_remove(&fibril->all_link);
 	futex_unlock(&fibril_futex);
 
+	__malloc_fibril_exit(fibril);
+
 	if (fibril->is_freeable) {
 		tls_free(fibril->tcb);
 		free(fibril);
@@ -251,6 +283,109 @@ static fibril_t *_fibril_trigger_internal(fibril_event_t *event, fibril_t *reaso
 	return f;
 }
 
+/** Assign a run queue to a newly started thread. */
+static _runner_t *_runner_assign(void)
+{
+	size_t i = (size_t) atomic_postinc(&runners_used);
+	return &runners[i % RUNNERS_MAX];
+}
+
+/**
+ * @return Run queue of the current thread. Threads that have never blocked
+ *         have no queue of their own yet and use the first one.
+ */
+static _runner_t *_runner_current(void)
+{
+	fibril_t *self = fibril_self();
+	fibril_t *owner = (self->thread_ctx != NULL) ? self->thread_ctx : self;
+	return (owner->runner != NULL) ? owner->runner : &runners[0];
+}
+
+/** Adjust the length of a ready list. Must hold the lock of @a r. */
+static void _runner_count_add(_runner_t *r, size_t delta)
+{
+	__atomic_store_n(&r->count, r->count + delta, __ATOMIC_RELAXED);
+}
+
+static fibril_t *_runner_pop(_runner_t *r)
+{
+	/* Avoid touching the lock of an empty queue. */
+	if (__atomic_load_n(&r->count, __ATOMIC_RELAXED) == 0)
+		return NULL;
+
+	futex_lock(&r->lock);
+	fibril_t *f = list_pop(&r->ready, fibril_t, link);
+	if (f)
+		_runner_count_add(r, -1);
+	futex_unlock(&r->lock);
+	return f;
+}
+
+/**
+ * Steal work from another run queue. Takes one fibril to run and moves
+ * half of the rest of the victim's queue to the thief's own queue.
+ */
+static fibril_t *_runner_steal(_runner_t *self, _runner_t *victim)
+{
+	if (__atomic_load_n(&victim->count, __ATOMIC_RELAXED) == 0)
+		return NULL;
+
+	list_t stolen;
+	list_initialize(&stolen);
+
+	futex_lock(&victim->lock);
+	fibril_t *f = list_pop(&victim->ready, fibril_t, link);
+	if (f)
+		_runner_count_add(victim, -1);
+
+	size_t n = victim->count / 2;
+	for (size_t i = 0; i < n; i++) {
+		link_t *link = list_first(&victim->ready);
+		list_remove(link);
+		list_append(link, &stolen);
+	}
+	_runner_count_add(victim, -n);
+	futex_unlock(&victim->lock);
+
+	if (n > 0) {
+		futex_lock(&self->lock);
+		list_concat(&self->ready, &stolen);
+		_runner_count_add(self, n);
+		futex_unlock(&self->lock);
+	}
+
+	return f;
+}
+
+/**
+ * Take a ready fibril from the current thread's queue, or steal one from
+ * the other queues.
+ */
+static fibril_t *_runner_take(void)
+{
+	_runner_t *self = _runner_current();
+	fibril_t *f = _runner_pop(self);
+	if (f)
+		return f;
+
+	size_t used = min((size_t) atomic_get(&runners_used), RUNNERS_MAX);
+	if (used == 0)
+		used = 1;
+
+	size_t start = self - runners;
+	for (size_t i = 0; i < used; i++) {
+		_runner_t *victim = &runners[(start + i) % used];
+		if (victim == self)
+			continue;
+
+		f = _runner_steal(self, victim);
+		if (f)
+			return f;
+	}
+
+	return NULL;
+}
+
 static errno_t _ipc_wait(ipc_call_t *call, const struct timeval *expires)
 {
 	if (!expires)
@@ -290,23 +425,42 @@ static fibril_t *_ready_list_pop(const struct timeval *expires, bool locked)
 
 	/*
 	 * Once we acquire a token from ready_semaphore, there are two options.
-	 * Either there is a ready fibril in the list, or it's our turn to
-	 * call `ipc_wait_cycle()`. There is one extra token on the semaphore
-	 * for each entry of the call buffer.
+	 * Either there is a ready fibril in one of the run queues, or it's our
+	 * turn to call `ipc_wait_cycle()`. There is one extra token on the
+	 * semaphore for each entry of the call buffer.
+	 *
+	 * The run queues are not scanned atomically, so not finding a fibril
+	 * does not mean the token is for a buffer bucket. We claim the bucket
+	 * before waiting for IPC, and if none is free, a fibril must be
+	 * queued somewhere and we look again.
 	 */
 
-
-	if (!locked)
-		futex_lock(&fibril_futex);
-	fibril_t *f = list_pop(&ready_list, fibril_t, link);
-	if (!f)
-		atomic_inc(&threads_in_ipc_wait);
-	if (!locked)
-		futex_unlock(&fibril_futex);
-
+	fibril_t *f = _runner_take();
 	if (f)
 		return f;
 
+	/*
+	 * Announce ourselves before looking again, so that a fibril queued
+	 * from now on either is found by us or pokes us out of IPC wait.
+	 */
+	atomic_inc(&threads_in_ipc_wait);
+
+	_ipc_buffer_t *buf;
+	while (true) {
+		f = _runner_take();
+		if (f) {
+			atomic_dec(&threads_in_ipc_wait);
+			return f;
+		}
+
+		futex_lock(&ipc_lists_futex);
+		buf = list_pop(&ipc_buffer_free_list, _ipc_buffer_t, link);
+		futex_unlock(&ipc_lists_futex);
+
+		if (buf)
+			break;
+	}
+
 	if (!multithreaded)
 		assert(list_empty(&ipc_buffer_list));
 
@@ -317,7 +471,10 @@ static fibril_t *_ready_list_pop(const struct timeval *expires, bool locked)
 	atomic_dec(&threads_in_ipc_wait);
 
 	if (rc != EOK && rc != ENOENT) {
-		/* Return token. */
+		/* Return the bucket and the token. */
+		futex_lock(&ipc_lists_futex);
+		list_append(&buf->link, &ipc_buffer_free_list);
+		futex_unlock(&ipc_lists_futex);
 		_ready_up();
 		return NULL;
 	}
@@ -330,10 +487,9 @@ static fibril_t *_ready_list_pop(const struct timeval *expires, bool locked)
 
 	/*
 	 * If a fibril is already waiting for IPC, we wake up the fibril,
-	 * and return the token to ready_semaphore.
-	 * If there is no fibril waiting, we pop a buffer bucket and
-	 * put our call there. The token then returns when the bucket is
-	 * returned.
+	 * and return the bucket and the token to ready_semaphore.
+	 * If there is no fibril waiting, we put our call in the claimed
+	 * bucket. The token then returns when the bucket is returned.
 	 */
 
 	if (!locked)
@@ -349,11 +505,10 @@ static fibril_t *_ready_list_pop(const struct timeval *expires, bool locked)
 		/* We switch to the woken up fibril immediately if possible. */
 		f = _fibril_trigger_internal(&w->event, _EVENT_TRIGGERED);
 
-		/* Return token. */
+		/* Return the bucket and the token. */
+		list_append(&buf->link, &ipc_buffer_free_list);
 		_ready_up();
 	} else {
-		_ipc_buffer_t *buf = list_pop(&ipc_buffer_free_list, _ipc_buffer_t, link);
-		assert(buf);
 		*buf = (_ipc_buffer_t) { .call = call, .rc = rc };
 		list_append(&buf->link, &ipc_buffer_list);
 	}
@@ -379,8 +534,12 @@ static void _ready_list_push(fibril_t *f)
 
 	futex_assert_is_locked(&fibril_futex);
 
-	/* Enqueue in ready_list. */
-	list_append(&f->link, &ready_list);
+	/* Enqueue in the run queue of the current thread. */
+	_runner_t *r = _runner_current();
+	futex_lock(&r->lock);
+	list_append(&f->link, &r->ready);
+	_runner_count_add(r, 1);
+	futex_unlock(&r->lock);
 	_ready_up();
 
 	if (atomic_get(&threads_in_ipc_wait)) {
@@ -528,6 +687,8 @@ static errno_t _helper_fibril_fn(void *arg)
 {
 	/* Set itself as the thread's own context. */
 	fibril_self()->thread_ctx = fibril_self();
+	if (!fibril_self()->runner)
+		fibril_self()->runner = _runner_assign();
 
 	(void) arg;
 
@@ -635,10 +796,16 @@ errno_t fibril_wait_timeout(fibril_event_t *event, const struct timeval *expires
 	DPRINTF("### Fibril %p sleeping on event %p.\n", fibril_self(), event);
 
 	if (!fibril_self()->thread_ctx) {
-		fibril_self()->thread_ctx =
+		fibril_t *helper = (fibril_t *)
 		    fibril_create_generic(_helper_fibril_fn, NULL, PAGE_SIZE);
-		if (!fibril_self()->thread_ctx)
+		if (!helper)
 			return ENOMEM;
+
+		/* The helper represents this thread from now on. */
+		helper->malloc_heap = fibril_self()->malloc_heap;
+		fibril_self()->malloc_heap = NULL;
+		helper->runner = _runner_assign();
+		fibril_self()->thread_ctx = helper;
 	}
 
 	futex_lock(&fibril_futex);
@@ -779,20 +946,25 @@ static void _runner_fn(void *arg)
 }
 
 /**
- * Spawn a given number of runners (i.e. OS threads) immediately, and
- * unconditionally. This is meant to be used for tests and debugging.
- * Regular programs should just use `fibril_enable_multithreaded()`.
+ * Spawn a given number of additional runners (i.e. OS threads) executing
+ * ready fibrils of this task. Each runner gets a run queue of its own and
+ * steals work from the others when its queue is empty.
+ *
+ * Servers that want to process requests in parallel should call this once
+ * at startup (or use async_spawn_runners(), which also adds IPC managers).
  *
  * @param n  Number of runners to spawn.
  * @return   Number of runners successfully spawned.
  */
-int fibril_test_spawn_runners(int n)
+int fibril_spawn_runners(int n)
 {
+	futex_lock(&fibril_futex);
 	if (!multithreaded) {
 		_ready_debug_check();
 		atomic_set(&ready_semaphore.val, ready_st_count);
 		multithreaded = true;
 	}
+	futex_unlock(&fibril_futex);
 
 	errno_t rc;
 
@@ -802,27 +974,53 @@ int fibril_test_spawn_runners(int n)
 		if (rc != EOK)
 			return i;
 		thread_detach(tid);
+		atomic_inc(&runners_spawned);
 	}
 
 	return n;
 }
 
+/**
+ * @return Number of threads executing fibrils of this task, counting the
+ *         main thread.
+ */
+int fibril_runner_count(void)
+{
+	return 1 + (int) atomic_get(&runners_spawned);
+}
+
+/**
+ * Spawn a given number of runners immediately, and unconditionally.
+ * This is meant to be used for tests and debugging.
+ *
+ * @param n  Number of runners to spawn.
+ * @return   Number of runners successfully spawned.
+ */
+int fibril_test_spawn_runners(int n)
+{
+	return fibril_spawn_runners(n);
+}
+
 /**
  * Opt-in to have more than one runner thread.
  *
  * Currently, a task only ever runs in one thread because multithreading
  * might break some existing code.
  *
- * Eventually, the number of runner threads for a given task should become
- * configurable in the environment and this function becomes no-op.
+ * The task gets one runner per CPU, but at least RUNNERS_DEFAULT of them,
+ * so that fibrils blocking in the kernel do not stall the others.
  */
 void fibril_enable_multithreaded(void)
 {
-	// TODO: Implement better.
-	//       For now, 4 total runners is a sensible default.
-	if (!multithreaded) {
-		fibril_test_spawn_runners(3);
-	}
+	if (multithreaded)
+		return;
+
+	size_t size = 0;
+	void *data = sysinfo_get_data("system.cpus", &size);
+	size_t cpus = size / sizeof(stats_cpu_t);
+	free(data);
+
+	fibril_spawn_runners((int) max(cpus, RUNNERS_DEFAULT) - 1);
 }
 
 /**
@@ -864,6 +1062,11 @@ void __fibrils_init(void)
 #define IPC_BUFFER_COUNT 1024
 	static _ipc_buffer_t buffers[IPC_BUFFER_COUNT];
 
+	for (int i = 0; i < RUNNERS_MAX; i++) {
+		futex_initialize(&runners[i].lock, 1);
+		list_initialize(&runners[i].ready);
+	}
+
 	for (int i = 0; i < IPC_BUFFER_COUNT; i++) {
 		list_append(&buffers[i].link, &ipc_buffer_free_list);
 		_ready_up();
@@ -31,20 +31,54 @@
  * @{
  */
 
+#include <as.h>
 #include <assert.h>
 #include <errno.h>
 #include <fibril_synch.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdarg.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <async.h>
 #include <io/log.h>
 #include <ipc/logger.h>
+#include <shmring.h>
 #include <str.h>
 #include <ns.h>
 
-/** Id of the first log we create at logger. */
-static sysarg_t default_log_id;
+/*
+ * Logs are identified by their slot at the logger plus one. The logger
+ * keeps the effective level of each slot in a table shared with us, so
+ * messages it would discard are dropped right away. Accepted messages
+ * are passed through a shared memory ring, which the logger drains in
+ * batches. Should either of them not be available, messages are sent
+ * one by one by IPC.
+ */
+
+/** Number of messages the ring can hold. */
+#define LOG_RING_SLOTS  256
+
+/** Size of the ring arena. */
+#define LOG_RING_ARENA  (64 * 1024)
+
+/** First log we create at logger. */
+static log_t default_log;
+
+/** Logger ids of our logs indexed by slot. */
+static sysarg_t log_ids[LOGGER_CLIENT_LOGS_MAX];
+
+/** Number of used log slots. */
+static size_t log_count;
+
+/** Effective levels shared with the logger or @c NULL. */
+static logger_levels_t *log_levels;
+
+/** Ring of messages shared with the logger or @c NULL. */
+static shmring_t *log_ring;
+
+/** Guards the log slots and the ring. */
+static FIBRIL_MUTEX_INITIALIZE(log_guard);
 
 /** Log messages are printed under this name. */
 static const char *log_prog_name;
@@ -64,7 +98,24 @@ static const char *log_level_names[] = {
 static async_sess_t *logger_session;
 
 /** Maximum length of a single log message (in bytes). */
-#define MESSAGE_BUFFER_SIZE 4096
+#define MESSAGE_BUFFER_SIZE LOGGER_MESSAGE_MAX
+
+/** Get logger id of a log.
+ *
+ * @param log Log handle.
+ * @return Logger id or zero if the log is not known.
+ */
+static sysarg_t log_get_id(log_t log)
+{
+	if (log == LOG_DEFAULT)
+		log = default_log;
+
+	fibril_mutex_lock(&log_guard);
+	sysarg_t id = (log >= 1 && log <= log_count) ? log_ids[log - 1] : 0;
+	fibril_mutex_unlock(&log_guard);
+
+	return id;
+}
 
 /** Send formatted message to the logger service.
  *
@@ -80,14 +131,11 @@ static errno_t logger_message(async_sess_t *session, log_t log, log_level_t leve
 	if (exchange == NULL) {
 		return ENOMEM;
 	}
-	if (log == LOG_DEFAULT)
-		log = default_log_id;
-
 	// FIXME: remove when all USB drivers use libc logging explicitly
 	str_rtrim(message, '\n');
 
 	aid_t reg_msg = async_send_2(exchange, LOGGER_WRITER_MESSAGE,
-	    log, level, NULL);
+	    log_get_id(log), level, NULL);
 	errno_t rc = async_data_write_start(exchange, message, str_size(message));
 	errno_t reg_msg_rc;
 	async_wait_for(reg_msg, &reg_msg_rc);
@@ -108,6 +156,48 @@ static errno_t logger_message(async_sess_t *session, log_t log, log_level_t leve
 	return reg_msg_rc;
 }
 
+/** Pass formatted message to the logger through the shared ring.
+ *
+ * The message is formatted directly into the ring.
+ *
+ * @param slot Log slot.
+ * @param level Verbosity level of the message.
+ * @param fmt Format string.
+ * @param args Arguments.
+ * @return EOK on success or an error code if the message has to be sent
+ *         by other means.
+ */
+static errno_t log_ring_message(size_t slot, log_level_t level,
+    const char *fmt, va_list args)
+{
+	void *buf;
+
+	fibril_mutex_lock(&log_guard);
+
+	errno_t rc = shmring_alloc(log_ring, MESSAGE_BUFFER_SIZE, &buf);
+	if (rc != EOK) {
+		/* Do not let the message overtake those in the ring. */
+		(void) shmring_flush(log_ring);
+		fibril_mutex_unlock(&log_guard);
+		return rc;
+	}
+
+	char *message = buf;
+	int len = vsnprintf(message, MESSAGE_BUFFER_SIZE, fmt, args);
+	size_t size = (len < 0) ? 0 : min((size_t) len,
+	    MESSAGE_BUFFER_SIZE - 1);
+
+	// FIXME: remove when all USB drivers use libc logging explicitly
+	while (size > 0 && message[size - 1] == '\n')
+		size--;
+
+	/* Once the message is posted, it is delivered or lost with the ring. */
+	(void) shmring_post(log_ring, size, LOGGER_RING_ARG(slot, level));
+
+	fibril_mutex_unlock(&log_guard);
+	return EOK;
+}
+
 /** Get name of the log level.
  *
  * @param level The log level.
@@ -156,6 +246,74 @@ errno_t log_level_from_str(const char *name, log_level_t *level_out)
 	return EOK;
 }
 
+/** Share table of effective log levels with the logger.
+ *
+ * Failure is not fatal, the messages are then filtered by the logger.
+ */
+static void log_levels_share(void)
+{
+	logger_levels_t *levels = as_area_create(AS_AREA_ANY,
+	    sizeof(logger_levels_t), AS_AREA_READ | AS_AREA_WRITE |
+	    AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (levels == AS_MAP_FAILED)
+		return;
+
+	/* Accept everything until told otherwise. */
+	memset(levels, 0xff, sizeof(logger_levels_t));
+
+	async_exch_t *exchange = async_exchange_begin(logger_session);
+	aid_t req = async_send_0(exchange, LOGGER_WRITER_SHARE_LEVELS, NULL);
+	errno_t rc = async_share_out_start(exchange, levels,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE);
+	async_exchange_end(exchange);
+
+	if (rc != EOK) {
+		async_forget(req);
+		as_area_destroy(levels);
+		return;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK) {
+		as_area_destroy(levels);
+		return;
+	}
+
+	log_levels = levels;
+}
+
+/** Share ring of messages with the logger.
+ *
+ * Failure is not fatal, the messages are then sent one by one.
+ */
+static void log_ring_share(void)
+{
+	shmring_t *ring;
+	errno_t rc = shmring_create(LOG_RING_SLOTS, LOG_RING_ARENA, &ring);
+	if (rc != EOK)
+		return;
+
+	async_exch_t *exchange = async_exchange_begin(logger_session);
+	aid_t req = async_send_0(exchange, LOGGER_WRITER_SHARE_RING, NULL);
+	rc = shmring_share(ring, exchange);
+	async_exchange_end(exchange);
+
+	if (rc != EOK) {
+		async_forget(req);
+		shmring_destroy(ring);
+		return;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK) {
+		shmring_destroy(ring);
+		return;
+	}
+
+	shmring_set_notify(ring, logger_session, LOGGER_WRITER_RING_NOTIFY, 0);
+	log_ring = ring;
+}
+
 /** Initialize the logging system.
  *
  * @param prog_name Program name, will be printed as part of message
@@ -172,7 +330,10 @@ errno_t log_init(const char *prog_name)
 		return ENOMEM;
 	}
 
-	default_log_id = log_create(prog_name, LOG_NO_PARENT);
+	default_log = log_create(prog_name, LOG_NO_PARENT);
+
+	log_levels_share();
+	log_ring_share();
 
 	return EOK;
 }
@@ -192,12 +353,9 @@ log_t log_create(const char *name, log_t parent)
 	if (exchange == NULL)
 		return parent;
 
-	if (parent == LOG_DEFAULT)
-		parent = default_log_id;
-
 	ipc_call_t answer;
 	aid_t reg_msg = async_send_1(exchange, LOGGER_WRITER_CREATE_LOG,
-	    parent, &answer);
+	    log_get_id(parent), &answer);
 	errno_t rc = async_data_write_start(exchange, name, str_size(name));
 	errno_t reg_msg_rc;
 	async_wait_for(reg_msg, &reg_msg_rc);
@@ -207,7 +365,16 @@ log_t log_create(const char *name, log_t parent)
 	if ((rc != EOK) || (reg_msg_rc != EOK))
 		return parent;
 
-	return IPC_GET_ARG1(answer);
+	size_t slot = IPC_GET_ARG2(answer);
+	if (slot >= LOGGER_CLIENT_LOGS_MAX)
+		return parent;
+
+	fibril_mutex_lock(&log_guard);
+	log_ids[slot] = IPC_GET_ARG1(answer);
+	log_count = max(log_count, slot + 1);
+	fibril_mutex_unlock(&log_guard);
+
+	return slot + 1;
 }
 
 /** Write an entry to the log.
@@ -239,6 +406,26 @@ void log_msgv(log_t ctx, log_level_t level, const char *fmt, va_list args)
 {
 	assert(level < LVL_LIMIT);
 
+	if (ctx == LOG_DEFAULT)
+		ctx = default_log;
+
+	/* Drop the message right away if the logger would discard it. */
+	if (log_levels != NULL && ctx >= 1 && ctx <= LOGGER_CLIENT_LOGS_MAX &&
+	    level > __atomic_load_n(&log_levels->level[ctx - 1],
+	    __ATOMIC_RELAXED))
+		return;
+
+	if (log_ring != NULL && ctx >= 1 && ctx <= LOGGER_CLIENT_LOGS_MAX) {
+		va_list args_copy;
+
+		va_copy(args_copy, args);
+		errno_t rc = log_ring_message(ctx - 1, level, fmt, args_copy);
+		va_end(args_copy);
+
+		if (rc == EOK)
+			return;
+	}
+
 	char *message_buffer = malloc(MESSAGE_BUFFER_SIZE);
 	if (message_buffer == NULL)
 		return;
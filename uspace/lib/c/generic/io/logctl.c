@@ -121,6 +121,42 @@ errno_t logctl_set_log_level(const char *logname, log_level_t new_level)
 	return (errno_t) reg_msg_rc;
 }
 
+/** Get reported log level set for a single log.
+ *
+ * If the log follows the level of its parent or the default level, the
+ * returned value is not a valid level, but passing it to
+ * logctl_set_log_level() makes the log follow it again.
+ *
+ * @param logname Log name.
+ * @param level Place to store the reported logging level.
+ * @return Error code of the conversion or EOK on success.
+ */
+errno_t logctl_get_log_level(const char *logname, log_level_t *level)
+{
+	async_exch_t *exchange = NULL;
+	errno_t rc = start_logger_exchange(&exchange);
+	if (rc != EOK)
+		return rc;
+
+	ipc_call_t answer;
+	aid_t reg_msg = async_send_0(exchange, LOGGER_CONTROL_GET_LOG_LEVEL,
+	    &answer);
+	rc = async_data_write_start(exchange, logname, str_size(logname));
+	errno_t reg_msg_rc;
+	async_wait_for(reg_msg, &reg_msg_rc);
+
+	async_exchange_end(exchange);
+
+	if (rc != EOK)
+		return rc;
+
+	if (reg_msg_rc != EOK)
+		return reg_msg_rc;
+
+	*level = (log_level_t) IPC_GET_ARG1(answer);
+	return EOK;
+}
+
 /** Set logger's VFS root.
  *
  * @return Error code or EOK on success.
@@ -46,7 +46,10 @@
 #include <fibril_synch.h>
 #include <stdlib.h>
 #include <adt/gcdlcm.h>
+#include <adt/list.h>
+#include <tls.h>
 #include "private/malloc.h"
+#include "private/fibril.h"
 
 /** Magic used in heap headers. */
 #define HEAP_BLOCK_HEAD_MAGIC  UINT32_C(0xBEEF0101)
@@ -75,6 +78,27 @@
  */
 #define SHRINK_GRANULARITY  (64 * PAGE_SIZE)
 
+/** Largest request served by the size-class front end. */
+#define SMALL_MAX  1024
+
+/** Number of size classes of the front end. */
+#define SMALL_CLASSES  20
+
+/** Size of a span, i.e. a run of objects of the same size class. */
+#define SPAN_SIZE  (16 * 1024)
+
+/** Initial size of a small object arena. */
+#define SMALL_ARENA_SIZE  (4 * SPAN_SIZE)
+
+/** Maximum growth step of a small object arena. */
+#define SMALL_ARENA_GROW_MAX  (64 * SPAN_SIZE)
+
+/** Maximum number of small object arenas. */
+#define SMALL_ARENAS  64
+
+/** Offset of the first object in a span. */
+#define SPAN_OBJECTS_OFFSET  ALIGN_UP(sizeof(span_t), BASE_ALIGN)
+
 /** Overhead of each heap block. */
 #define STRUCT_OVERHEAD \
 	(sizeof(heap_block_head_t) + sizeof(heap_block_foot_t))
@@ -155,6 +179,75 @@ typedef struct heap_area {
 	uint32_t magic;
 } heap_area_t;
 
+/** Span of small objects
+ *
+ * A span is a SPAN_SIZE run of memory inside a small object arena
+ * which starts with this header and is carved into objects of a
+ * single size class. Each span is owned by at most one thread heap.
+ * The owner allocates from and frees to the local free list without
+ * any locking. Other threads return objects to the span by pushing
+ * them atomically on the remote free list, which is collected by
+ * the owner once the local free list runs dry.
+ *
+ */
+typedef struct {
+	/** Link to the owner's span list or to a global span list */
+	link_t link;
+
+	/** Owning thread heap (NULL for free and abandoned spans) */
+	struct malloc_heap *heap;
+
+	/** Local free list (accessed only by the owner) */
+	void *free;
+
+	/** Remote free list (accessed atomically) */
+	void *thread_free;
+
+	/** Number of objects carved from the span so far */
+	size_t carved;
+
+	/** Number of objects in the span */
+	size_t capacity;
+
+	/** Number of objects not returned to the local free list */
+	size_t used;
+
+	/** Size class of the objects */
+	unsigned int class;
+
+	/** The span has no free object and is on the full list */
+	bool full;
+} span_t;
+
+/** Small object arena
+ *
+ * An address space area holding the small object spans. It is
+ * grown span by span like the heap areas, a new arena is created
+ * only if the last one cannot be enlarged.
+ *
+ */
+typedef struct {
+	/** Start of the arena (aligned on page boundary) */
+	void *start;
+
+	/** End of the arena (accessed atomically) */
+	void *end;
+} small_arena_t;
+
+/** Thread heap
+ *
+ * Per-thread front end of the allocator. Each thread (i.e. fibril
+ * runner) owns a set of spans for each size class.
+ *
+ */
+typedef struct malloc_heap {
+	/** Spans with free objects (the first one is used for allocation) */
+	list_t partial[SMALL_CLASSES];
+
+	/** Spans without any free object */
+	list_t full[SMALL_CLASSES];
+} malloc_heap_t;
+
 /** Header of a heap block
  *
  */
@@ -195,6 +288,21 @@ static heap_block_head_t *next_fit = NULL;
 /** Futex for thread-safe heap manipulation */
 static FIBRIL_RMUTEX_INITIALIZE(malloc_mutex);
 
+/** Futex for thread-safe span manipulation */
+static FIBRIL_RMUTEX_INITIALIZE(span_mutex);
+
+/** Small object arenas (only ever appended to) */
+static small_arena_t small_arenas[SMALL_ARENAS];
+
+/** Number of valid entries in small_arenas */
+static size_t small_arenas_count = 0;
+
+/** Spans not owned by any thread heap */
+static LIST_INITIALIZE(free_spans);
+
+/** Spans with live objects left behind by terminated threads */
+static list_t abandoned_spans[SMALL_CLASSES];
+
 #define malloc_assert(expr) safe_assert(expr)
 
 /** Serializes access to the heap from multiple threads. */
@@ -482,6 +590,9 @@ static void heap_shrink(heap_area_t *area)
  */
 void __malloc_init(void)
 {
+	for (unsigned int i = 0; i < SMALL_CLASSES; i++)
+		list_initialize(&abandoned_spans[i]);
+
 	if (!area_create(PAGE_SIZE))
 		abort();
 }
@@ -754,6 +865,475 @@ static void *malloc_internal(const size_t size, const size_t align)
 	return heap_grow_and_alloc(gross_size, falign);
 }
 
+/** Get size class of a small request
+ *
+ * Requests up to 128 bytes are served by classes spaced by
+ * BASE_ALIGN, larger requests by four classes per power of two.
+ *
+ * @param size Requested size (at most SMALL_MAX).
+ *
+ * @return Size class.
+ *
+ */
+static inline unsigned int small_class(size_t size)
+{
+	if (size <= 128)
+		return (size == 0) ? 0 : (size - 1) / BASE_ALIGN;
+
+	unsigned int order = fnzb32(size - 1);
+	return 8 + (order - 7) * 4 + (((size - 1) >> (order - 2)) & 3);
+}
+
+/** Get object size of a size class
+ *
+ * @param class Size class.
+ *
+ * @return Object size in bytes.
+ *
+ */
+static inline size_t small_class_size(unsigned int class)
+{
+	if (class < 8)
+		return (class + 1) * BASE_ALIGN;
+
+	size_t base = ((size_t) 128) << ((class - 8) / 4);
+	return base + ((class - 8) % 4 + 1) * (base / 4);
+}
+
+/** Find the span of a small object
+ *
+ * Arenas are never removed and never shrink, therefore the arena
+ * table can be searched without holding any lock.
+ *
+ * @param addr Address of the object.
+ *
+ * @return Span of the object or NULL if the address
+ *         does not belong to any small object arena.
+ *
+ */
+static span_t *span_find(void *addr)
+{
+	size_t count = __atomic_load_n(&small_arenas_count, __ATOMIC_ACQUIRE);
+
+	for (size_t i = 0; i < count; i++) {
+		small_arena_t *arena = &small_arenas[i];
+
+		if ((addr >= arena->start) &&
+		    (addr < __atomic_load_n(&arena->end, __ATOMIC_ACQUIRE)))
+			return (span_t *) (arena->start +
+			    ALIGN_DOWN((size_t) (addr - arena->start), SPAN_SIZE));
+	}
+
+	return NULL;
+}
+
+/** Put new spans on the free span list
+ *
+ * Should be called only inside the span critical section.
+ *
+ * @param start Start of the first span.
+ * @param end   End of the last span.
+ *
+ */
+static void spans_init(void *start, void *end)
+{
+	for (void *cur = start; cur < end; cur += SPAN_SIZE) {
+		span_t *span = (span_t *) cur;
+
+		link_initialize(&span->link);
+		span->heap = NULL;
+		list_append(&span->link, &free_spans);
+	}
+}
+
+/** Try to provide more free spans
+ *
+ * Enlarge the last small object arena or create a new one.
+ * Should be called only inside the span critical section.
+ *
+ * @return True if successful.
+ *
+ */
+static bool small_arena_grow(void)
+{
+	size_t grow = SMALL_ARENA_SIZE;
+
+	if (small_arenas_count > 0) {
+		small_arena_t *arena = &small_arenas[small_arenas_count - 1];
+
+		/* Double the arena, but do not grow it too much at once */
+		size_t size = (size_t) (arena->end - arena->start);
+		grow = min(size, (size_t) SMALL_ARENA_GROW_MAX);
+
+		if (as_area_resize(arena->start, size + grow, 0) == EOK) {
+			void *end = arena->end + grow;
+
+			spans_init(arena->end, end);
+			__atomic_store_n(&arena->end, end, __ATOMIC_RELEASE);
+			return true;
+		}
+	}
+
+	if (small_arenas_count == SMALL_ARENAS)
+		return false;
+
+	void *astart = as_area_create(AS_AREA_ANY, grow,
+	    AS_AREA_WRITE | AS_AREA_READ | AS_AREA_CACHEABLE, AS_AREA_UNPAGED);
+	if (astart == AS_MAP_FAILED)
+		return false;
+
+	small_arena_t *arena = &small_arenas[small_arenas_count];
+
+	arena->start = astart;
+	arena->end = astart + grow;
+	spans_init(arena->start, arena->end);
+
+	/* Publish the arena to span_find() */
+	__atomic_store_n(&small_arenas_count, small_arenas_count + 1,
+	    __ATOMIC_RELEASE);
+
+	return true;
+}
+
+/** Collect objects freed by other threads
+ *
+ * Should be called only by the owner of the span.
+ *
+ * @param span Span to collect.
+ *
+ */
+static void span_collect(span_t *span)
+{
+	void *obj = __atomic_exchange_n(&span->thread_free, NULL,
+	    __ATOMIC_ACQUIRE);
+
+	while (obj != NULL) {
+		void *next = *((void **) obj);
+
+		*((void **) obj) = span->free;
+		span->free = obj;
+		span->used--;
+
+		obj = next;
+	}
+}
+
+/** Allocate an object from a span
+ *
+ * Should be called only by the owner of the span.
+ *
+ * @param span Span to allocate from.
+ *
+ * @return Address of the object or NULL if the span is full.
+ *
+ */
+static void *span_alloc(span_t *span)
+{
+	if (span->free == NULL)
+		span_collect(span);
+
+	void *obj = span->free;
+	if (obj != NULL) {
+		span->free = *((void **) obj);
+		span->used++;
+		return obj;
+	}
+
+	/* Carve a fresh object from the untouched part of the span */
+	if (span->carved < span->capacity) {
+		obj = ((void *) span) + SPAN_OBJECTS_OFFSET +
+		    span->carved * small_class_size(span->class);
+		span->carved++;
+		span->used++;
+		return obj;
+	}
+
+	return NULL;
+}
+
+/** Get a span for a thread heap
+ *
+ * Prefer reclaiming a span abandoned by a terminated thread,
+ * then take a free span and eventually create a new arena.
+ *
+ * @param heap  Thread heap which becomes the owner of the span.
+ * @param class Size class of the span.
+ *
+ * @return Span or NULL on not enough memory.
+ *
+ */
+static span_t *span_acquire(malloc_heap_t *heap, unsigned int class)
+{
+	fibril_rmutex_lock(&span_mutex);
+
+	span_t *span = list_pop(&abandoned_spans[class], span_t, link);
+	if (span != NULL) {
+		__atomic_store_n(&span->heap, heap, __ATOMIC_RELEASE);
+		fibril_rmutex_unlock(&span_mutex);
+
+		span_collect(span);
+		return span;
+	}
+
+	span = list_pop(&free_spans, span_t, link);
+	if ((span == NULL) && (small_arena_grow()))
+		span = list_pop(&free_spans, span_t, link);
+
+	if (span != NULL) {
+		span->free = NULL;
+		span->thread_free = NULL;
+		span->carved = 0;
+		span->capacity = (SPAN_SIZE - SPAN_OBJECTS_OFFSET) /
+		    small_class_size(class);
+		span->used = 0;
+		span->class = class;
+		span->full = false;
+		__atomic_store_n(&span->heap, heap, __ATOMIC_RELEASE);
+	}
+
+	fibril_rmutex_unlock(&span_mutex);
+	return span;
+}
+
+/** Return an empty span to the free span list
+ *
+ * @param span Span without any live object.
+ *
+ */
+static void span_release(span_t *span)
+{
+	malloc_assert(span->used == 0);
+
+	fibril_rmutex_lock(&span_mutex);
+	__atomic_store_n(&span->heap, NULL, __ATOMIC_RELEASE);
+	list_append(&span->link, &free_spans);
+	fibril_rmutex_unlock(&span_mutex);
+}
+
+/** Get the heap of the current thread
+ *
+ * The heap is attached to the fibril representing the current
+ * thread, i.e. to the helper fibril of a fibril runner, or to the
+ * running fibril itself if the thread has not needed a helper yet.
+ * The fibril cannot migrate to another thread while it executes
+ * allocator code, because the allocator never blocks the fibril.
+ *
+ * @param create Create the heap if it does not exist yet.
+ *
+ * @return Heap of the current thread or NULL.
+ *
+ */
+static malloc_heap_t *heap_current(bool create)
+{
+	if (!__tcb_is_set())
+		return NULL;
+
+	fibril_t *self = __tcb_get()->fibril_data;
+	if (self == NULL)
+		return NULL;
+
+	fibril_t *owner = (self->thread_ctx != NULL) ? self->thread_ctx : self;
+	malloc_heap_t *heap = owner->malloc_heap;
+
+	if ((heap == NULL) && (create)) {
+		heap_lock();
+		heap = malloc_internal(sizeof(malloc_heap_t), BASE_ALIGN);
+		heap_unlock();
+
+		if (heap == NULL)
+			return NULL;
+
+		for (unsigned int i = 0; i < SMALL_CLASSES; i++) {
+			list_initialize(&heap->partial[i]);
+			list_initialize(&heap->full[i]);
+		}
+
+		owner->malloc_heap = heap;
+	}
+
+	return heap;
+}
+
+/** Allocate a small object
+ *
+ * @param size Number of bytes to allocate (at most SMALL_MAX).
+ *
+ * @return Allocated memory or NULL if the request has to be
+ *         served by the area-based heap.
+ *
+ */
+static void *small_alloc(size_t size)
+{
+	malloc_heap_t *heap = heap_current(true);
+	if (heap == NULL)
+		return NULL;
+
+	unsigned int class = small_class(size);
+	list_t *partial = &heap->partial[class];
+
+	while (true) {
+		link_t *link = list_first(partial);
+
+		if (link == NULL) {
+			/* Look for full spans which got remote frees */
+			list_foreach_safe(heap->full[class], cur, next) {
+				span_t *span = list_get_instance(cur, span_t, link);
+
+				if (__atomic_load_n(&span->thread_free,
+				    __ATOMIC_RELAXED) != NULL) {
+					list_remove(&span->link);
+					span->full = false;
+					list_append(&span->link, partial);
+				}
+			}
+
+			link = list_first(partial);
+		}
+
+		span_t *span;
+
+		if (link != NULL) {
+			span = list_get_instance(link, span_t, link);
+		} else {
+			span = span_acquire(heap, class);
+			if (span == NULL)
+				return NULL;
+
+			list_prepend(&span->link, partial);
+		}
+
+		void *obj = span_alloc(span);
+		if (obj != NULL)
+			return obj;
+
+		list_remove(&span->link);
+		span->full = true;
+		list_append(&span->link, &heap->full[class]);
+	}
+}
+
+/** Free a small object
+ *
+ * If the span is owned by the current thread, the object is
+ * returned to the local free list. Otherwise it is pushed on
+ * the remote free list of the span without taking any lock.
+ *
+ * @param span Span of the object.
+ * @param addr Address of the object.
+ *
+ */
+static void small_free(span_t *span, void *addr)
+{
+	malloc_heap_t *heap = heap_current(false);
+
+	/*
+	 * Only the current thread can make its heap the owner of
+	 * a span, therefore the comparison cannot be invalidated
+	 * by a concurrent change of the owner.
+	 */
+	if ((heap == NULL) ||
+	    (__atomic_load_n(&span->heap, __ATOMIC_ACQUIRE) != heap)) {
+		void *head = __atomic_load_n(&span->thread_free,
+		    __ATOMIC_RELAXED);
+
+		do {
+			*((void **) addr) = head;
+		} while (!__atomic_compare_exchange_n(&span->thread_free,
+		    &head, addr, false, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+
+		return;
+	}
+
+	*((void **) addr) = span->free;
+	span->free = addr;
+	span->used--;
+
+	list_t *partial = &heap->partial[span->class];
+
+	if (span->full) {
+		list_remove(&span->link);
+		span->full = false;
+		list_append(&span->link, partial);
+	}
+
+	/* Keep the span used for allocation, give back the others */
+	if ((span->used == 0) && (list_first(partial) != &span->link)) {
+		list_remove(&span->link);
+		span_release(span);
+	}
+}
+
+/** Abandon a heap which is not used anymore
+ *
+ * Empty spans are released, spans with live objects are left
+ * for other threads to reclaim.
+ *
+ * @param heap Heap to abandon.
+ *
+ */
+static void heap_abandon(malloc_heap_t *heap)
+{
+	fibril_rmutex_lock(&span_mutex);
+
+	for (unsigned int i = 0; i < SMALL_CLASSES; i++) {
+		list_t *lists[] = { &heap->partial[i], &heap->full[i] };
+
+		for (unsigned int j = 0; j < 2; j++) {
+			span_t *span;
+
+			while ((span = list_pop(lists[j], span_t, link)) != NULL) {
+				span_collect(span);
+				span->full = false;
+				__atomic_store_n(&span->heap, NULL, __ATOMIC_RELEASE);
+
+				if (span->used == 0)
+					list_append(&span->link, &free_spans);
+				else
+					list_append(&span->link, &abandoned_spans[i]);
+			}
+		}
+	}
+
+	fibril_rmutex_unlock(&span_mutex);
+
+	free(heap);
+}
+
+/** Abandon the heap of the terminating thread
+ *
+ */
+void __malloc_thread_exit(void)
+{
+	malloc_heap_t *heap = heap_current(false);
+	if (heap == NULL)
+		return;
+
+	fibril_t *self = __tcb_get()->fibril_data;
+	fibril_t *owner = (self->thread_ctx != NULL) ? self->thread_ctx : self;
+	owner->malloc_heap = NULL;
+
+	heap_abandon(heap);
+}
+
+/** Abandon the heap attached to a fibril being destroyed
+ *
+ * A fibril which runs before its thread got a helper fibril gets
+ * a heap of its own. The heap is not used by any thread once the
+ * fibril is dead.
+ *
+ * @param fibril Dead fibril.
+ *
+ */
+void __malloc_fibril_exit(fibril_t *fibril)
+{
+	malloc_heap_t *heap = fibril->malloc_heap;
+	if (heap == NULL)
+		return;
+
+	fibril->malloc_heap = NULL;
+	heap_abandon(heap);
+}
+
 /** Allocate memory by number of elements
  *
  * @param nmemb Number of members to allocate.
@@ -783,6 +1363,12 @@ void *calloc(const size_t nmemb, const size_t size)
  */
 void *malloc(const size_t size)
 {
+	if (size <= SMALL_MAX) {
+		void *block = small_alloc(size);
+		if (block != NULL)
+			return block;
+	}
+
 	heap_lock();
 	void *block = malloc_internal(size, BASE_ALIGN);
 	heap_unlock();
@@ -806,6 +1392,13 @@ void *memalign(const size_t align, const size_t size)
 	size_t palign =
 	    1 << (fnzb(max(sizeof(void *), align) - 1) + 1);
 
+	/* Small objects are naturally aligned on BASE_ALIGN */
+	if ((palign <= BASE_ALIGN) && (size <= SMALL_MAX)) {
+		void *block = small_alloc(size);
+		if (block != NULL)
+			return block;
+	}
+
 	heap_lock();
 	void *block = malloc_internal(size, palign);
 	heap_unlock();
@@ -831,6 +1424,23 @@ void *realloc(void *const addr, const size_t size)
 	if (addr == NULL)
 		return malloc(size);
 
+	span_t *span = span_find(addr);
+	if (span != NULL) {
+		size_t orig_size = small_class_size(span->class);
+
+		/* Stay in place as long as the size class matches */
+		if ((size <= SMALL_MAX) && (small_class(size) == span->class))
+			return addr;
+
+		void *ptr = malloc(size);
+		if (ptr != NULL) {
+			memcpy(ptr, addr, min(size, orig_size));
+			small_free(span, addr);
+		}
+
+		return ptr;
+	}
+
 	heap_lock();
 
 	/* Calculate the position of the header. */
@@ -940,6 +1550,12 @@ void free(void *const addr)
 	if (addr == NULL)
 		return;
 
+	span_t *span = span_find(addr);
+	if (span != NULL) {
+		small_free(span, addr);
+		return;
+	}
+
 	heap_lock();
 
 	/* Calculate the position of the header. */
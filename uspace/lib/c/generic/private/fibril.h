@@ -54,6 +54,12 @@ struct fibril {
 
 	fibril_t *thread_ctx;
 
+	/* Allocator cache of the thread this fibril represents (see malloc.c). */
+	void *malloc_heap;
+
+	/* Run queue of the thread this fibril represents (see fibril.c). */
+	struct fibril_runner *runner;
+
 	bool is_running : 1;
 	bool is_writer : 1;
 	/* In some places, we use fibril structs that can't be freed. */
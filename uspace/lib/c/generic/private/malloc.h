@@ -35,7 +35,11 @@
 #ifndef LIBC_PRIVATE_MALLOC_H_
 #define LIBC_PRIVATE_MALLOC_H_
 
+#include <fibril.h>
+
 extern void __malloc_init(void);
+extern void __malloc_thread_exit(void);
+extern void __malloc_fibril_exit(fibril_t *);
 
 #endif
 
@@ -39,15 +39,12 @@
 #include <abi/proc/uarg.h>
 #include <libarch/thread.h>
 #include <abi/proc/thread.h>
+#include <thread.h>
 
 extern void __thread_entry(void);
 extern void __thread_main(uspace_arg_t *);
 
-extern errno_t thread_create(void (*)(void *), void *, const char *,
-    thread_id_t *);
 extern void thread_exit(int) __attribute__((noreturn));
-extern void thread_detach(thread_id_t);
-extern thread_id_t thread_get_id(void);
 extern int thread_usleep(useconds_t);
 extern unsigned int thread_sleep(unsigned int);
 
@@ -49,6 +49,7 @@
 #include <rtld/dynamic.h>
 #include <rtld/rtld_arch.h>
 #include <rtld/module.h>
+#include <rtld/symbol.h>
 
 #include "../private/libc.h"
 
@@ -96,9 +97,42 @@ errno_t module_create_static_exec(rtld_t *rtld, module_t **rmodule)
 	return EOK;
 }
 
-/** (Eagerly) process all relocation tables in a module.
+/** Name of the PLT resolver trampoline in the C library */
+#define PLT_RESOLVER_NAME  "__rtld_plt_resolve"
+
+/** Try to set up lazy binding of the PLT of a module.
+ *
+ * Function calls through the PLT are bound on first use by the PLT
+ * resolver of the C library used by the program. The module which
+ * contains the resolver is always bound eagerly, so that the resolver
+ * itself never needs binding. Modules linked with -z now are bound
+ * eagerly as well.
  *
- * Currently works as if LD_BIND_NOW was specified.
+ * @param m Module
+ * @return @c true if the PLT is bound lazily, @c false if it needs to be
+ *         bound now
+ */
+static bool module_plt_lazy(module_t *m)
+{
+	elf_symbol_t *sym;
+	module_t *rm;
+
+	if (m->dyn.bind_now || m->dyn.plt_rel != DT_REL ||
+	    m->dyn.plt_got == NULL)
+		return false;
+
+	sym = symbol_def_find(PLT_RESOLVER_NAME, m, ssf_none, &rm);
+	if (sym == NULL || rm == m)
+		return false;
+
+	return rel_table_lazy(m, m->dyn.jmp_rel, m->dyn.plt_rel_sz,
+	    symbol_get_addr(sym, rm, NULL));
+}
+
+/** Process all relocation tables in a module.
+ *
+ * Relocations of the PLT are processed lazily if possible, all other
+ * relocations are processed right away.
  */
 void module_process_relocs(module_t *m)
 {
@@ -113,7 +147,9 @@ void module_process_relocs(module_t *m)
 	/* jmp_rel table */
 	if (m->dyn.jmp_rel != NULL) {
 		DPRINTF("jmp_rel table\n");
-		if (m->dyn.plt_rel == DT_REL) {
+		if (module_plt_lazy(m)) {
+			DPRINTF("jmp_rel table bound lazily\n");
+		} else if (m->dyn.plt_rel == DT_REL) {
 			DPRINTF("jmp_rel table type DT_REL\n");
 			rel_table_process(m, m->dyn.jmp_rel, m->dyn.plt_rel_sz);
 		} else {
@@ -232,6 +268,10 @@ module_t *module_load(rtld_t *rtld, const char *name, mlflags_t flags)
 	/* Insert into the list of loaded modules */
 	list_append(&m->modules_link, &rtld->modules);
 
+	/* A new global module can change the results of symbol lookups */
+	if (!m->local)
+		symbol_cache_flush(rtld);
+
 	/* Copy TLS info */
 	m->tdata = info.tls.tdata;
 	m->tdata_size = info.tls.tdata_size;
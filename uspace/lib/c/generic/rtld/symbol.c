@@ -34,6 +34,9 @@
  * @file
  */
 
+#include <futex.h>
+#include <mem.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str.h>
@@ -44,6 +47,46 @@
 #include <rtld/rtld_debug.h>
 #include <rtld/symbol.h>
 
+/** Number of entries in the symbol lookup cache, a power of two */
+#define SYMBOL_CACHE_SIZE  1024
+
+/** Result of a lookup of a symbol in the global modules */
+typedef struct {
+	/** Symbol name or @c NULL if the entry is unused */
+	const char *name;
+	/** GNU hash of the name */
+	elf_word hash;
+	/** Search flags used for the lookup */
+	symbol_search_flags_t flags;
+	/** Symbol definition or @c NULL if there is none */
+	elf_symbol_t *sym;
+	/** Module containing the definition */
+	module_t *mod;
+} symbol_cache_entry_t;
+
+/** Direct-mapped cache of global symbol lookups.
+ *
+ * Every imported function and variable of every module is looked up in
+ * the global modules, most of them many times over. The set of global
+ * modules does not change once the program is loaded, so the results,
+ * including failed lookups, can be kept.
+ */
+struct symbol_cache {
+	/** Protects the entries, lazy binding can run in any thread */
+	futex_t lock;
+	symbol_cache_entry_t entry[SYMBOL_CACHE_SIZE];
+};
+
+/** Hashes of a symbol name */
+typedef struct {
+	const char *name;
+	/** GNU hash, always computed */
+	elf_word gnu;
+	/** SysV hash, computed when needed */
+	elf_word sysv;
+	bool sysv_valid;
+} symbol_hash_t;
+
 /*
  * Hash tables are 32-bit (elf_word) even for 64-bit ELF files.
  */
@@ -62,38 +105,127 @@ static elf_word elf_hash(const unsigned char *name)
 	return h;
 }
 
-static elf_symbol_t *def_find_in_module(const char *name, module_t *m)
+/** Compute the hash used by DT_GNU_HASH tables. */
+static elf_word gnu_hash(const unsigned char *name)
+{
+	elf_word h = 5381;
+
+	while (*name)
+		h = (h << 5) + h + *name++;
+
+	return h;
+}
+
+static void symbol_hash_init(symbol_hash_t *hash, const char *name)
+{
+	hash->name = name;
+	hash->gnu = gnu_hash((const unsigned char *) name);
+	hash->sysv_valid = false;
+}
+
+/** Find a symbol using the DT_GNU_HASH table of a module.
+ *
+ * Most lookups are for symbols which the module does not define. These
+ * are usually rejected by the Bloom filter without touching the buckets
+ * or the symbol table.
+ */
+static elf_symbol_t *gnu_hash_find(symbol_hash_t *hash, module_t *m)
+{
+	elf_word *table = m->dyn.gnu_hash;
+	elf_word nbucket = table[0];
+	elf_word symoffset = table[1];
+	elf_word bloom_size = table[2];
+	elf_word bloom_shift = table[3];
+
+	/* Bloom filter words have the size of an address */
+	uintptr_t *bloom = (uintptr_t *) &table[4];
+	elf_word *buckets = (elf_word *) &bloom[bloom_size];
+	elf_word *chain = &buckets[nbucket];
+
+	const unsigned int bits = sizeof(uintptr_t) * 8;
+	elf_word h = hash->gnu;
+
+	uintptr_t word = bloom[(h / bits) & (bloom_size - 1)];
+	uintptr_t mask = ((uintptr_t) 1 << (h % bits)) |
+	    ((uintptr_t) 1 << ((h >> bloom_shift) % bits));
+
+	if ((word & mask) != mask)
+		return NULL;
+
+	elf_word i = buckets[h % nbucket];
+	if (i < symoffset)
+		return NULL;
+
+	elf_symbol_t *sym_table = m->dyn.sym_tab;
+
+	while (true) {
+		elf_word h2 = chain[i - symoffset];
+
+		/* The lowest bit marks the end of the chain */
+		if (((h ^ h2) >> 1) == 0) {
+			elf_symbol_t *s = &sym_table[i];
+			char *s_name = m->dyn.str_tab + s->st_name;
+
+			if (str_cmp(hash->name, s_name) == 0)
+				return s;
+		}
+
+		if ((h2 & 1) != 0)
+			return NULL;
+
+		i++;
+	}
+}
+
+/** Find a symbol using the DT_HASH table of a module. */
+static elf_symbol_t *sysv_hash_find(symbol_hash_t *hash, module_t *m)
 {
 	elf_symbol_t *sym_table;
-	elf_symbol_t *s, *sym;
+	elf_symbol_t *s;
 	elf_word nbucket;
 	/*elf_word nchain;*/
 	elf_word i;
 	char *s_name;
 	elf_word bucket;
 
-	DPRINTF("def_find_in_module('%s', %s)\n", name, m->dyn.soname);
+	if (!hash->sysv_valid) {
+		hash->sysv = elf_hash((const unsigned char *) hash->name);
+		hash->sysv_valid = true;
+	}
 
 	sym_table = m->dyn.sym_tab;
 	nbucket = m->dyn.hash[0];
 	/*nchain = m->dyn.hash[1]; XXX Use to check HT range*/
 
-	bucket = elf_hash((unsigned char *)name) % nbucket;
+	bucket = hash->sysv % nbucket;
 	i = m->dyn.hash[2 + bucket];
 
-	sym = NULL;
 	while (i != STN_UNDEF) {
 		s = &sym_table[i];
 		s_name = m->dyn.str_tab + s->st_name;
 
-		if (str_cmp(name, s_name) == 0) {
-			sym = s;
-			break;
-		}
+		if (str_cmp(hash->name, s_name) == 0)
+			return s;
 
 		i = m->dyn.hash[2 + nbucket + i];
 	}
 
+	return NULL;
+}
+
+static elf_symbol_t *def_find_in_module(symbol_hash_t *hash, module_t *m)
+{
+	elf_symbol_t *sym;
+
+	DPRINTF("def_find_in_module('%s', %s)\n", hash->name, m->dyn.soname);
+
+	if (m->dyn.gnu_hash != NULL)
+		sym = gnu_hash_find(hash, m);
+	else if (m->dyn.hash != NULL)
+		sym = sysv_hash_find(hash, m);
+	else
+		sym = NULL;
+
 	if (!sym)
 		return NULL;	/* Not found */
 
@@ -121,9 +253,12 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 {
 	module_t *m, *dm;
 	elf_symbol_t *sym, *s;
+	symbol_hash_t hash;
 	list_t queue;
 	size_t i;
 
+	symbol_hash_init(&hash, name);
+
 	/*
 	 * Do a BFS using the queue_link and bfs_tag fields.
 	 * Vertices (modules) are tagged the moment they are inserted
@@ -149,7 +284,7 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 		list_remove(&m->queue_link);
 
 		/* If ssf_noroot is specified, do not look in start module */
-		s = def_find_in_module(name, m);
+		s = def_find_in_module(&hash, m);
 		if (s != NULL) {
 			/* Symbol found */
 			sym = s;
@@ -183,6 +318,105 @@ elf_symbol_t *symbol_bfs_find(const char *name, module_t *start,
 }
 
 
+/** Find the definition of a symbol in the global modules.
+ *
+ * @param hash		Hashes of the symbol name.
+ * @param rtld		Run-time dynamic linker.
+ * @param flags		Symbol search flags.
+ * @param mod		(output) Will be filled with a pointer to the module
+ *			that contains the symbol.
+ */
+static elf_symbol_t *def_find_global(symbol_hash_t *hash, rtld_t *rtld,
+    symbol_search_flags_t flags, module_t **mod)
+{
+	list_foreach(rtld->modules, modules_link, module_t, m) {
+		DPRINTF("module '%s' local?\n", m->dyn.soname);
+		if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
+			DPRINTF("!local->find '%s' in module '%s'\n",
+			    hash->name, m->dyn.soname);
+			elf_symbol_t *s = def_find_in_module(hash, m);
+			if (s != NULL) {
+				/* Found */
+				*mod = m;
+				return s;
+			}
+		}
+	}
+
+	return NULL;
+}
+
+/** Find the definition of a symbol in the global modules using the cache.
+ *
+ * @param hash		Hashes of the symbol name.
+ * @param rtld		Run-time dynamic linker.
+ * @param flags		Symbol search flags.
+ * @param mod		(output) Will be filled with a pointer to the module
+ *			that contains the symbol.
+ */
+static elf_symbol_t *def_find_global_cached(symbol_hash_t *hash,
+    rtld_t *rtld, symbol_search_flags_t flags, module_t **mod)
+{
+	struct symbol_cache *cache = rtld->sym_cache;
+
+	if (cache == NULL) {
+		cache = calloc(1, sizeof(struct symbol_cache));
+		if (cache == NULL)
+			return def_find_global(hash, rtld, flags, mod);
+
+		futex_initialize(&cache->lock, 1);
+		rtld->sym_cache = cache;
+	}
+
+	symbol_cache_entry_t *entry =
+	    &cache->entry[hash->gnu & (SYMBOL_CACHE_SIZE - 1)];
+
+	futex_down(&cache->lock);
+
+	if ((entry->name != NULL) && (entry->hash == hash->gnu) &&
+	    (entry->flags == flags) &&
+	    (str_cmp(entry->name, hash->name) == 0)) {
+		elf_symbol_t *s = entry->sym;
+		*mod = entry->mod;
+		futex_up(&cache->lock);
+		return s;
+	}
+
+	futex_up(&cache->lock);
+
+	module_t *m = NULL;
+	elf_symbol_t *s = def_find_global(hash, rtld, flags, &m);
+
+	futex_down(&cache->lock);
+	entry->name = hash->name;
+	entry->hash = hash->gnu;
+	entry->flags = flags;
+	entry->sym = s;
+	entry->mod = m;
+	futex_up(&cache->lock);
+
+	*mod = m;
+	return s;
+}
+
+/** Forget the cached results of global symbol lookups.
+ *
+ * Must be called whenever a global module is added.
+ *
+ * @param rtld		Run-time dynamic linker.
+ */
+void symbol_cache_flush(rtld_t *rtld)
+{
+	struct symbol_cache *cache = rtld->sym_cache;
+
+	if (cache == NULL)
+		return;
+
+	futex_down(&cache->lock);
+	memset(cache->entry, 0, sizeof(cache->entry));
+	futex_up(&cache->lock);
+}
+
 /** Find the definition of a symbol.
  *
  * By definition in System V ABI, if module origin has the flag DT_SYMBOLIC,
@@ -200,6 +434,9 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
     symbol_search_flags_t flags, module_t **mod)
 {
 	elf_symbol_t *s;
+	symbol_hash_t hash;
+
+	symbol_hash_init(&hash, name);
 
 	DPRINTF("symbol_def_find('%s', origin='%s'\n",
 	    name, origin->dyn.soname);
@@ -209,7 +446,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 		 * Origin module has a DT_SYMBOLIC flag.
 		 * Try this module first
 		 */
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&hash, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
@@ -219,18 +456,9 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 
 	/* Not DT_SYMBOLIC or no match. Now try other locations. */
 
-	list_foreach(origin->rtld->modules, modules_link, module_t, m) {
-		DPRINTF("module '%s' local?\n", m->dyn.soname);
-		if (!m->local && (!m->exec || (flags & ssf_noexec) == 0)) {
-			DPRINTF("!local->find '%s' in module '%s'\n", name, m->dyn.soname);
-			s = def_find_in_module(name, m);
-			if (s != NULL) {
-				/* Found */
-				*mod = m;
-				return s;
-			}
-		}
-	}
+	s = def_find_global_cached(&hash, origin->rtld, flags, mod);
+	if (s != NULL)
+		return s;
 
 	/* Finally, try origin. */
 
@@ -238,7 +466,7 @@ elf_symbol_t *symbol_def_find(const char *name, module_t *origin,
 	    origin->dyn.soname);
 
 	if (!origin->exec || (flags & ssf_noexec) == 0) {
-		s = def_find_in_module(name, origin);
+		s = def_find_in_module(&hash, origin);
 		if (s != NULL) {
 			/* Found */
 			*mod = origin;
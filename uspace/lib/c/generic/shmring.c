@@ -0,0 +1,533 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/**
+ * @file
+ * @brief Shared memory ring channel.
+ *
+ * Bulk transfers through IPC_M_DATA_WRITE and IPC_M_DATA_READ are copied
+ * by the kernel and limited to DATA_XFER_LIMIT bytes per call. A shared
+ * memory ring is set up once between two tasks and then carries payload
+ * descriptors, with the payloads themselves staying in place in the
+ * shared arena.
+ *
+ * The producer allocates room in the arena, builds the payload there and
+ * posts a descriptor. The arena is used as a byte ring and payloads are
+ * released by the consumer in order, so the oldest unconsumed payload
+ * always marks the end of the free space. The consumer is notified by an
+ * IPC call only when the ring goes from empty to non-empty. It drains the
+ * ring and answers the call, which also serves as flow control for the
+ * producer when the ring fills up.
+ *
+ * Everything in the shared area can be modified by the peer at any time,
+ * so both sides validate what they read from it.
+ */
+
+#include <align.h>
+#include <as.h>
+#include <async.h>
+#include <errno.h>
+#include <mem.h>
+#include <shmring.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Set up local pointers into a shared ring area. */
+static void shmring_map(shmring_t *ring, void *area, size_t area_size,
+    size_t slots, size_t arena_offset, size_t arena_size)
+{
+	ring->hdr = (shmring_hdr_t *) area;
+	ring->area_size = area_size;
+	ring->desc = (shmring_desc_t *) (ring->hdr + 1);
+	ring->arena = (uint8_t *) area + arena_offset;
+	ring->slots = slots;
+	ring->arena_size = arena_size;
+}
+
+/** Create shared memory ring.
+ *
+ * The caller becomes the producer of the ring. The ring is handed over to
+ * the consumer using shmring_share().
+ *
+ * @param slots      Number of descriptor slots (power of two)
+ * @param arena_size Size of the payload arena in bytes
+ * @param rring      Place to store pointer to the new ring
+ *
+ * @return EOK on success or an error code
+ */
+errno_t shmring_create(size_t slots, size_t arena_size, shmring_t **rring)
+{
+	shmring_t *ring;
+	size_t arena_offset;
+	void *area;
+
+	if (slots == 0 || (slots & (slots - 1)) != 0 || arena_size == 0)
+		return EINVAL;
+
+	if (slots > (SIZE_MAX / 2 - sizeof(shmring_hdr_t)) /
+	    sizeof(shmring_desc_t))
+		return EINVAL;
+
+	if (arena_size > SIZE_MAX / 2)
+		return EINVAL;
+
+	arena_offset = ALIGN_UP(sizeof(shmring_hdr_t) +
+	    slots * sizeof(shmring_desc_t), PAGE_SIZE);
+	arena_size = ALIGN_UP(arena_size, PAGE_SIZE);
+
+	ring = calloc(1, sizeof(shmring_t));
+	if (ring == NULL)
+		return ENOMEM;
+
+	ring->slot_pos = calloc(slots, sizeof(uint64_t));
+	if (ring->slot_pos == NULL) {
+		free(ring);
+		return ENOMEM;
+	}
+
+	area = as_area_create(AS_AREA_ANY, arena_offset + arena_size,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE,
+	    AS_AREA_UNPAGED);
+	if (area == AS_MAP_FAILED) {
+		free(ring->slot_pos);
+		free(ring);
+		return ENOMEM;
+	}
+
+	shmring_map(ring, area, arena_offset + arena_size, slots,
+	    arena_offset, arena_size);
+
+	memset(ring->hdr, 0, sizeof(shmring_hdr_t));
+	ring->hdr->magic = SHMRING_MAGIC;
+	ring->hdr->slots = slots;
+	ring->hdr->arena_offset = arena_offset;
+	ring->hdr->arena_size = arena_size;
+
+	*rring = ring;
+	return EOK;
+}
+
+/** Share ring with the consumer.
+ *
+ * This is to be called in the context of a protocol-specific request
+ * which the consumer handles by shmring_accept().
+ *
+ * @param ring Shared memory ring
+ * @param exch Exchange for sending the area
+ *
+ * @return EOK on success or an error code
+ */
+errno_t shmring_share(shmring_t *ring, async_exch_t *exch)
+{
+	return async_share_out_start(exch, ring->hdr,
+	    AS_AREA_READ | AS_AREA_WRITE | AS_AREA_CACHEABLE);
+}
+
+/** Accept ring shared by the producer.
+ *
+ * Receives the IPC_M_SHARE_OUT call sent by shmring_share() and validates
+ * the ring header.
+ *
+ * @param rring Place to store pointer to the ring
+ *
+ * @return EOK on success or an error code
+ */
+errno_t shmring_accept(shmring_t **rring)
+{
+	ipc_call_t call;
+	shmring_t *ring;
+	shmring_hdr_t *hdr;
+	size_t size;
+	unsigned int flags;
+	uint64_t slots;
+	uint64_t arena_offset;
+	uint64_t arena_size;
+	void *area;
+	errno_t rc;
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (size < sizeof(shmring_hdr_t) ||
+	    (flags & (AS_AREA_READ | AS_AREA_WRITE)) !=
+	    (AS_AREA_READ | AS_AREA_WRITE)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	ring = calloc(1, sizeof(shmring_t));
+	if (ring == NULL) {
+		async_answer_0(&call, ENOMEM);
+		return ENOMEM;
+	}
+
+	rc = async_share_out_finalize(&call, &area);
+	if (rc != EOK || area == AS_MAP_FAILED) {
+		free(ring);
+		return ENOMEM;
+	}
+
+	hdr = (shmring_hdr_t *) area;
+	slots = hdr->slots;
+	arena_offset = hdr->arena_offset;
+	arena_size = hdr->arena_size;
+
+	if (hdr->magic != SHMRING_MAGIC || slots == 0 ||
+	    (slots & (slots - 1)) != 0 ||
+	    slots > (size - sizeof(shmring_hdr_t)) / sizeof(shmring_desc_t) ||
+	    arena_offset < sizeof(shmring_hdr_t) +
+	    slots * sizeof(shmring_desc_t) ||
+	    arena_offset > size || arena_size == 0 ||
+	    arena_size > size - arena_offset) {
+		as_area_destroy(area);
+		free(ring);
+		return EINVAL;
+	}
+
+	shmring_map(ring, area, size, slots, arena_offset, arena_size);
+	ring->head = __atomic_load_n(&hdr->head, __ATOMIC_ACQUIRE);
+	ring->tail = __atomic_load_n(&hdr->tail, __ATOMIC_ACQUIRE);
+	if (ring->head - ring->tail > ring->slots) {
+		as_area_destroy(area);
+		free(ring);
+		return EINVAL;
+	}
+
+	*rring = ring;
+	return EOK;
+}
+
+/** Destroy shared memory ring.
+ *
+ * On the producer side, waits for the pending notification first.
+ *
+ * @param ring Shared memory ring or @c NULL
+ */
+void shmring_destroy(shmring_t *ring)
+{
+	if (ring == NULL)
+		return;
+
+	(void) shmring_flush(ring);
+	as_area_destroy(ring->hdr);
+	free(ring->slot_pos);
+	free(ring);
+}
+
+/** Set up consumer notification.
+ *
+ * The consumer is notified by a @a method call with @a arg as the first
+ * argument. It should drain the ring using shmring_peek() and
+ * shmring_release() until shmring_peek() returns ENOENT and only then
+ * answer the call.
+ *
+ * Without a notification session, the consumer has to poll the ring and
+ * the producer gets EBUSY when the ring is full.
+ *
+ * @param ring   Shared memory ring
+ * @param sess   Session to the consumer or @c NULL
+ * @param method Notification method
+ * @param arg    Notification method argument
+ */
+void shmring_set_notify(shmring_t *ring, async_sess_t *sess, sysarg_t method,
+    sysarg_t arg)
+{
+	ring->sess = sess;
+	ring->method = method;
+	ring->method_arg = arg;
+}
+
+/** Refresh the consumer index as seen by the producer.
+ *
+ * @param ring Shared memory ring
+ * @return EOK on success or EIO if the consumer index is bogus
+ */
+static errno_t shmring_sync_tail(shmring_t *ring)
+{
+	uint64_t tail;
+
+	tail = __atomic_load_n(&ring->hdr->tail, __ATOMIC_ACQUIRE);
+
+	/* The consumer index can only advance towards the producer index */
+	if (ring->head - tail > ring->head - ring->tail)
+		return EIO;
+
+	ring->tail = tail;
+	return EOK;
+}
+
+/** Find room for a payload in the arena.
+ *
+ * Payloads are contiguous, so if the payload does not fit before the end
+ * of the arena, it is placed at its beginning and the space in between is
+ * wasted until the payload is released.
+ *
+ * @param ring Shared memory ring
+ * @param size Payload size
+ * @param rpos Place to store arena position of the payload
+ *
+ * @return @c true if the payload fits in the ring
+ */
+static bool shmring_fit(shmring_t *ring, size_t size, uint64_t *rpos)
+{
+	uint64_t used;
+	uint64_t skip;
+	uint64_t off;
+
+	if (ring->head - ring->tail == ring->slots)
+		return false;
+
+	if (ring->head == ring->tail) {
+		/* The ring is empty, restart from the beginning of the arena */
+		ring->apos += (ring->arena_size -
+		    ring->apos % ring->arena_size) % ring->arena_size;
+		used = 0;
+	} else {
+		used = ring->apos -
+		    ring->slot_pos[ring->tail & (ring->slots - 1)];
+	}
+
+	off = ring->apos % ring->arena_size;
+	skip = 0;
+	if (size > ring->arena_size - off)
+		skip = ring->arena_size - off;
+
+	if (used + skip + size > ring->arena_size)
+		return false;
+
+	*rpos = ring->apos + skip;
+	return true;
+}
+
+/** Allocate payload buffer in the ring.
+ *
+ * The payload is to be built directly in the returned buffer and then
+ * handed over to the consumer using shmring_post(). Only one buffer can be
+ * allocated at a time. If the ring is full, waits until the consumer
+ * drains it.
+ *
+ * @param ring Shared memory ring
+ * @param size Payload size
+ * @param rbuf Place to store pointer to the payload buffer
+ *
+ * @return EOK on success, ELIMIT if the payload can never fit in the ring,
+ *         EBUSY if the ring is full and there is no notification to wait
+ *         for or another error code
+ */
+errno_t shmring_alloc(shmring_t *ring, size_t size, void **rbuf)
+{
+	uint64_t pos;
+	errno_t rc;
+
+	if (size > ring->arena_size)
+		return ELIMIT;
+
+	/* The arena size is a multiple of the alignment */
+	size = ALIGN_UP(size, SHMRING_ALIGN);
+
+	while (true) {
+		rc = shmring_sync_tail(ring);
+		if (rc != EOK)
+			return rc;
+
+		if (shmring_fit(ring, size, &pos))
+			break;
+
+		if (ring->notify == 0)
+			return EBUSY;
+
+		rc = shmring_flush(ring);
+		if (rc != EOK)
+			return rc;
+	}
+
+	ring->alloc_pos = pos;
+	ring->alloc_size = size;
+
+	*rbuf = ring->arena + pos % ring->arena_size;
+	return EOK;
+}
+
+/** Notify the consumer that the ring is no longer empty.
+ *
+ * @param ring Shared memory ring
+ * @return EOK on success or an error code
+ */
+static errno_t shmring_notify(shmring_t *ring)
+{
+	async_exch_t *exch;
+	errno_t rc;
+
+	if (ring->sess == NULL)
+		return EOK;
+
+	/*
+	 * The previous notification is answered once the consumer sees the
+	 * ring empty, which it already did or is just about to.
+	 */
+	rc = shmring_flush(ring);
+	if (rc != EOK)
+		return rc;
+
+	exch = async_exchange_begin(ring->sess);
+	ring->notify = async_send_1(exch, ring->method, ring->method_arg,
+	    NULL);
+	async_exchange_end(exch);
+
+	if (ring->notify == 0)
+		return ENOMEM;
+
+	return EOK;
+}
+
+/** Post payload to the consumer.
+ *
+ * @param ring Shared memory ring
+ * @param size Actual payload size, at most the allocated size
+ * @param arg  Protocol-specific argument passed along with the payload
+ *
+ * @return EOK on success or an error code
+ */
+errno_t shmring_post(shmring_t *ring, size_t size, sysarg_t arg)
+{
+	shmring_desc_t *desc;
+	uint64_t head = ring->head;
+	size_t slot = head & (ring->slots - 1);
+
+	if (size > ring->alloc_size)
+		return EINVAL;
+
+	desc = &ring->desc[slot];
+	desc->offset = ring->alloc_pos % ring->arena_size;
+	desc->size = size;
+	desc->arg = arg;
+
+	/* The unused rest of the allocated buffer is returned to the arena */
+	ring->slot_pos[slot] = ring->alloc_pos;
+	ring->apos = ring->alloc_pos + ALIGN_UP(size, SHMRING_ALIGN);
+	ring->alloc_size = 0;
+
+	ring->head = head + 1;
+	__atomic_store_n(&ring->hdr->head, ring->head, __ATOMIC_RELEASE);
+
+	/*
+	 * Publish the new producer index before looking at the consumer
+	 * index. Together with the fence in shmring_release(), either the
+	 * consumer sees the new descriptor before it stops draining the
+	 * ring, or we see that the ring was empty and notify the consumer.
+	 */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+	if (__atomic_load_n(&ring->hdr->tail, __ATOMIC_RELAXED) != head)
+		return EOK;
+
+	return shmring_notify(ring);
+}
+
+/** Wait until the consumer drains the ring.
+ *
+ * Waits for the answer to the pending notification, i.e. until all
+ * payloads posted so far have been released by the consumer.
+ *
+ * @param ring Shared memory ring
+ * @return EOK on success or the error returned by the consumer
+ */
+errno_t shmring_flush(shmring_t *ring)
+{
+	errno_t retval;
+
+	if (ring->notify == 0)
+		return EOK;
+
+	async_wait_for(ring->notify, &retval);
+	ring->notify = 0;
+	return retval;
+}
+
+/** Get the oldest payload in the ring.
+ *
+ * The payload stays valid until it is released by shmring_release().
+ *
+ * @param ring  Shared memory ring
+ * @param rdata Place to store pointer to the payload
+ * @param rsize Place to store payload size
+ * @param rarg  Place to store protocol-specific argument or @c NULL
+ *
+ * @return EOK on success, ENOENT if the ring is empty or EIO if the ring
+ *         has been corrupted by the producer
+ */
+errno_t shmring_peek(shmring_t *ring, void **rdata, size_t *rsize,
+    sysarg_t *rarg)
+{
+	shmring_desc_t *desc;
+	uint64_t head;
+	uint64_t offset;
+	uint64_t size;
+
+	head = __atomic_load_n(&ring->hdr->head, __ATOMIC_ACQUIRE);
+	if (head == ring->tail)
+		return ENOENT;
+
+	if (head - ring->tail > ring->slots)
+		return EIO;
+
+	desc = &ring->desc[ring->tail & (ring->slots - 1)];
+	offset = __atomic_load_n(&desc->offset, __ATOMIC_RELAXED);
+	size = __atomic_load_n(&desc->size, __ATOMIC_RELAXED);
+
+	if (offset > ring->arena_size || size > ring->arena_size - offset)
+		return EIO;
+
+	*rdata = ring->arena + offset;
+	*rsize = size;
+	if (rarg != NULL)
+		*rarg = __atomic_load_n(&desc->arg, __ATOMIC_RELAXED);
+
+	return EOK;
+}
+
+/** Release the oldest payload in the ring.
+ *
+ * @param ring Shared memory ring
+ */
+void shmring_release(shmring_t *ring)
+{
+	ring->tail++;
+	__atomic_store_n(&ring->hdr->tail, ring->tail, __ATOMIC_RELEASE);
+
+	/* Pairs with the fence in shmring_post() */
+	__atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+/** @}
+ */
@@ -45,6 +45,7 @@
 #include <as.h>
 #include "private/thread.h"
 #include "private/fibril.h"
+#include "private/malloc.h"
 
 /** Main thread function.
  *
@@ -72,6 +73,7 @@ void __thread_main(uspace_arg_t *uarg)
 	 * free(uarg);
 	 */
 
+	__malloc_thread_exit();
 	fibril_teardown(fibril);
 	thread_exit(0);
 }
@@ -37,6 +37,7 @@
 #include <vfs/vfs_mtab.h>
 #include <vfs/vfs_sess.h>
 #include <macros.h>
+#include <mem.h>
 #include <stdlib.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -908,6 +909,260 @@ errno_t vfs_read_short(int file, aoff64_t pos, void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Transfer one batch of extents of a vectored read or write.
+ *
+ * @param file          File handle
+ * @param read          True for reading, false for writing
+ * @param ext           Extents
+ * @param cnt           Number of extents, at most VFS_IOV_MAX
+ * @param buf           Buffer holding the data of all extents in sequence
+ * @param size          Total size of the extents, at most DATA_XFER_LIMIT
+ * @param[out] nbytes   Number of bytes transferred
+ *
+ * @return              EOK on success, ENOTSUP if the file system does not
+ *                      support vectored I/O or another error code
+ */
+static errno_t vfs_rdwrv_batch(int file, bool read, vfs_extent_t *ext,
+    size_t cnt, void *buf, size_t size, size_t *nbytes)
+{
+	errno_t rc;
+	errno_t rc_orig;
+	ipc_call_t answer;
+	aid_t req;
+
+	async_exch_t *exch = vfs_exchange_begin();
+
+	req = async_send_1(exch, read ? VFS_IN_READV : VFS_IN_WRITEV, file,
+	    &answer);
+	rc = async_data_write_start(exch, ext, cnt * sizeof(vfs_extent_t));
+	if (rc == EOK) {
+		if (read)
+			rc = async_data_read_start(exch, buf, size);
+		else
+			rc = async_data_write_start(exch, buf, size);
+	}
+
+	vfs_exchange_end(exch);
+
+	if (rc != EOK) {
+		async_wait_for(req, &rc_orig);
+		return (rc_orig != EOK) ? rc_orig : rc;
+	}
+
+	async_wait_for(req, &rc);
+	if (rc != EOK)
+		return rc;
+
+	*nbytes = IPC_GET_ARG1(answer);
+	return EOK;
+}
+
+/** Transfer the rest of a vectored read or write extent by extent.
+ *
+ * Used with file systems which do not support vectored I/O.
+ *
+ * @param file          File handle
+ * @param read          True for reading, false for writing
+ * @param iov           Buffers
+ * @param iovcnt        Number of buffers
+ * @param off           Number of bytes of @a iov[0] already transferred
+ * @param[inout] nbytes Number of bytes transferred
+ *
+ * @return              EOK on success or an error code
+ */
+static errno_t vfs_rdwrv_fallback(int file, bool read, const vfs_iovec_t *iov,
+    size_t iovcnt, size_t off, size_t *nbytes)
+{
+	errno_t rc;
+
+	for (size_t i = 0; i < iovcnt; i++) {
+		aoff64_t pos = iov[i].pos + off;
+		uint8_t *buf = (uint8_t *) iov[i].buf + off;
+		size_t len = iov[i].size - off;
+		size_t n = 0;
+
+		if (read)
+			rc = vfs_read(file, &pos, buf, len, &n);
+		else
+			rc = vfs_write(file, &pos, buf, len, &n);
+
+		*nbytes += n;
+		if (rc != EOK)
+			return rc;
+
+		/* End of file */
+		if (n < len)
+			break;
+
+		off = 0;
+	}
+
+	return EOK;
+}
+
+/** Vectored read or write.
+ *
+ * The extents are transferred in batches of up to VFS_IOV_MAX extents and
+ * DATA_XFER_LIMIT bytes, each taking a single request.
+ *
+ * @param file          File handle
+ * @param read          True for reading, false for writing
+ * @param iov           Buffers
+ * @param iovcnt        Number of buffers
+ * @param[out] nbytes   Number of bytes transferred
+ *
+ * @return              EOK on success or an error code
+ */
+static errno_t vfs_rdwrv(int file, bool read, const vfs_iovec_t *iov,
+    size_t iovcnt, size_t *nbytes)
+{
+	vfs_extent_t ext[VFS_IOV_MAX];
+	uint8_t *bounce = NULL;
+	size_t done = 0;
+	size_t total = 0;
+	size_t i = 0;
+	size_t off = 0;
+	errno_t rc = EOK;
+
+	for (size_t j = 0; j < iovcnt; j++)
+		total += iov[j].size;
+
+	while (i < iovcnt) {
+		size_t cnt = 0;
+		size_t size = 0;
+		size_t bi;
+		size_t boff;
+
+		/* Skip exhausted buffers */
+		if (off == iov[i].size) {
+			i++;
+			off = 0;
+			continue;
+		}
+
+		/* Collect extents of the next batch */
+		bi = i;
+		boff = off;
+		while (bi < iovcnt && cnt < VFS_IOV_MAX &&
+		    size < DATA_XFER_LIMIT) {
+			size_t len = min(iov[bi].size - boff,
+			    DATA_XFER_LIMIT - size);
+
+			if (len > 0) {
+				ext[cnt].pos = iov[bi].pos + boff;
+				ext[cnt].size = len;
+				cnt++;
+				size += len;
+				boff += len;
+			}
+
+			if (boff == iov[bi].size) {
+				bi++;
+				boff = 0;
+			}
+		}
+
+		/* A single extent can be transferred directly. */
+		uint8_t *buf;
+		if (cnt == 1) {
+			buf = (uint8_t *) iov[i].buf + off;
+		} else {
+			if (bounce == NULL) {
+				bounce = malloc(min(total - done,
+				    DATA_XFER_LIMIT));
+				if (bounce == NULL) {
+					rc = ENOMEM;
+					break;
+				}
+			}
+			buf = bounce;
+		}
+
+		if (!read && buf == bounce) {
+			/* Gather the data to write */
+			bi = i;
+			boff = off;
+			for (size_t bpos = 0; bpos < size; ) {
+				size_t len = min(iov[bi].size - boff,
+				    size - bpos);
+				memcpy(bounce + bpos,
+				    (uint8_t *) iov[bi].buf + boff, len);
+				bpos += len;
+				boff += len;
+				if (boff == iov[bi].size) {
+					bi++;
+					boff = 0;
+				}
+			}
+		}
+
+		size_t n = 0;
+		rc = vfs_rdwrv_batch(file, read, ext, cnt, buf, size, &n);
+		if (rc == ENOTSUP) {
+			rc = vfs_rdwrv_fallback(file, read, &iov[i], iovcnt - i,
+			    off, &done);
+			break;
+		}
+		if (rc != EOK)
+			break;
+
+		if (n > size)
+			n = size;
+
+		/* Scatter the data read and advance */
+		for (size_t bpos = 0; bpos < n; ) {
+			size_t len = min(iov[i].size - off, n - bpos);
+			if (read && buf == bounce) {
+				memcpy((uint8_t *) iov[i].buf + off,
+				    bounce + bpos, len);
+			}
+			bpos += len;
+			off += len;
+			if (off == iov[i].size) {
+				i++;
+				off = 0;
+			}
+		}
+
+		done += n;
+
+		if (n < size) {
+			/* End of file */
+			if (read)
+				break;
+
+			/* Retry the rest of a short write unless stuck */
+			if (n == 0) {
+				rc = EIO;
+				break;
+			}
+		}
+	}
+
+	free(bounce);
+	*nbytes = done;
+	return rc;
+}
+
+/** Read data from several extents of a file
+ *
+ * Each buffer is filled from its own position in the file. The extents are
+ * read in order and reading stops at the first extent which reaches the end
+ * of file. Many small extents are read using only a few requests.
+ *
+ * @param file          File handle to read from
+ * @param iov           Buffers
+ * @param iovcnt        Number of buffers
+ * @param[out] nread    Total number of bytes read
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_readv(int file, const vfs_iovec_t *iov, size_t iovcnt,
+    size_t *nread)
+{
+	return vfs_rdwrv(file, true, iov, iovcnt, nread);
+}
+
 /** Rename a file or directory
  *
  * There is no file-handle-based variant to disallow attempts to introduce loops
@@ -1372,5 +1627,26 @@ errno_t vfs_write_short(int file, aoff64_t pos, const void *buf, size_t nbyte,
 	return EOK;
 }
 
+/** Write data to several extents of a file
+ *
+ * Each buffer is written to its own position in the file. The extents are
+ * written in order. Many small extents are written using only a few requests.
+ * If the file is open in append mode, the positions are ignored and the
+ * buffers are appended to the file one after another, just like with
+ * vfs_write(). This function fails if it cannot write all the data.
+ *
+ * @param file          File handle to write to
+ * @param iov           Buffers
+ * @param iovcnt        Number of buffers
+ * @param[out] nwritten Total number of bytes written
+ *
+ * @return              EOK on success or an error code
+ */
+errno_t vfs_writev(int file, const vfs_iovec_t *iov, size_t iovcnt,
+    size_t *nwritten)
+{
+	return vfs_rdwrv(file, false, iov, iovcnt, nwritten);
+}
+
 /** @}
  */
@@ -44,6 +44,8 @@
 /** Opaque hash table link type. */
 typedef struct ht_link {
 	link_t link;
+	/** Cached hash of the item's lookup key. */
+	size_t hash;
 } ht_link_t;
 
 /** Set of operations for hash table. */
@@ -74,6 +76,11 @@ typedef struct {
 	hash_table_ops_t *op;
 	list_t *bucket;
 	size_t bucket_cnt;
+	/** Buckets being migrated to @c bucket after a resize, or NULL. */
+	list_t *old_bucket;
+	size_t old_bucket_cnt;
+	/** Old buckets below this index have already been migrated. */
+	size_t migrate_idx;
 	size_t full_item_cnt;
 	size_t item_cnt;
 	size_t max_load;
@@ -69,6 +69,8 @@ extern void fibril_usleep(suseconds_t);
 extern void fibril_sleep(unsigned int);
 
 extern void fibril_enable_multithreaded(void);
+extern int fibril_spawn_runners(int);
+extern int fibril_runner_count(void);
 extern int fibril_test_spawn_runners(int);
 
 extern void fibril_detach(fid_t fid);
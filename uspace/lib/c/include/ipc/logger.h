@@ -34,6 +34,30 @@
 #define LIBC_IPC_LOGGER_H_
 
 #include <ipc/common.h>
+#include <stdint.h>
+
+/** Maximum number of logs created by one writer client. */
+#define LOGGER_CLIENT_LOGS_MAX  100
+
+/** Maximum size of a log message in bytes. */
+#define LOGGER_MESSAGE_MAX  4096
+
+/** Effective log levels of a writer client.
+ *
+ * The table is shared by the client with the logger, which keeps it up
+ * to date, so that the client can drop messages the logger would discard
+ * without contacting it.
+ */
+typedef struct {
+	/** Levels indexed by log slot, 0xff for unknown */
+	uint8_t level[LOGGER_CLIENT_LOGS_MAX];
+} logger_levels_t;
+
+/** Shared memory ring payload argument for a message. */
+#define LOGGER_RING_ARG(slot, level) \
+	(((sysarg_t) (slot) << 8) | (sysarg_t) (level))
+#define LOGGER_RING_ARG_SLOT(arg)   ((size_t) ((arg) >> 8))
+#define LOGGER_RING_ARG_LEVEL(arg)  ((unsigned int) ((arg) & 0xff))
 
 typedef enum {
 	/** Set (global) default displayed logging level.
@@ -54,14 +78,20 @@ typedef enum {
 	 * Returns: error code
 	 * Followed by: vfs_pass_handle() request.
 	 */
-	LOGGER_CONTROL_SET_ROOT
+	LOGGER_CONTROL_SET_ROOT,
+	/** Get displayed level set for given log.
+	 *
+	 * Returns: error code, log level
+	 * Followed by: string with full log name.
+	 */
+	LOGGER_CONTROL_GET_LOG_LEVEL
 } logger_control_request_t;
 
 typedef enum {
 	/** Create new log.
 	 *
 	 * Arguments: parent log id (0 for top-level log).
-	 * Returns: error code, log id
+	 * Returns: error code, log id, log slot
 	 * Followed by: string with log name.
 	 */
 	LOGGER_WRITER_CREATE_LOG = IPC_FIRST_USER_METHOD,
@@ -71,7 +101,28 @@ typedef enum {
 	 * Returns: error code
 	 * Followed by: string with the message.
 	 */
-	LOGGER_WRITER_MESSAGE
+	LOGGER_WRITER_MESSAGE,
+	/** Share table of effective log levels.
+	 *
+	 * Returns: error code
+	 * Followed by: IPC_M_SHARE_OUT of logger_levels_t.
+	 */
+	LOGGER_WRITER_SHARE_LEVELS,
+	/** Share ring of messages.
+	 *
+	 * Payloads are messages (not terminated), the payload argument is
+	 * LOGGER_RING_ARG() of the log slot and message level.
+	 *
+	 * Returns: error code
+	 * Followed by: shmring_share().
+	 */
+	LOGGER_WRITER_SHARE_RING,
+	/** Notification of messages in the ring.
+	 *
+	 * Answered once the ring has been drained.
+	 * Returns: error code
+	 */
+	LOGGER_WRITER_RING_NOTIFY
 } logger_writer_request_t;
 
 #endif
@@ -36,6 +36,7 @@
 #define LIBC_IPC_VFS_H_
 
 #include <ipc/common.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
 
@@ -46,6 +47,9 @@
 #define MAX_MNTOPTS_LEN 256
 #define PLB_SIZE        (2 * MAX_PATH_LEN)
 
+/** Maximum number of extents in a vectored read or write request */
+#define VFS_IOV_MAX     64
+
 /* Basic types. */
 typedef int16_t fs_handle_t;
 typedef uint32_t fs_index_t;
@@ -63,6 +67,14 @@ typedef struct {
 	bool write_retains_size;
 } vfs_info_t;
 
+/** File extent transferred by a vectored read or write request. */
+typedef struct {
+	/** Position in the file */
+	uint64_t pos;
+	/** Number of bytes */
+	size_t size;
+} vfs_extent_t;
+
 /** Data returned by filesystem probe regarding a specific volume. */
 typedef struct {
 	char label[FS_LABEL_MAXLEN + 1];
@@ -88,6 +100,8 @@ typedef enum {
 	VFS_IN_WAIT_HANDLE,
 	VFS_IN_WALK,
 	VFS_IN_WRITE,
+	VFS_IN_READV,
+	VFS_IN_WRITEV,
 } vfs_in_request_t;
 
 typedef enum {
@@ -106,6 +120,8 @@ typedef enum {
 	VFS_OUT_TRUNCATE,
 	VFS_OUT_UNMOUNTED,
 	VFS_OUT_WRITE,
+	VFS_OUT_READV,
+	VFS_OUT_WRITEV,
 	VFS_OUT_LAST
 } vfs_out_request_t;
 
@@ -42,6 +42,9 @@ void module_process_pre_arch(module_t *m);
 
 void rel_table_process(module_t *m, elf_rel_t *rt, size_t rt_size);
 void rela_table_process(module_t *m, elf_rela_t *rt, size_t rt_size);
+bool rel_table_lazy(module_t *m, elf_rel_t *rt, size_t rt_size,
+    void *resolver);
+void *rtld_plt_bind(module_t *m, size_t reloc_off);
 
 void program_run(void *entry, pcb_t *pcb);
 
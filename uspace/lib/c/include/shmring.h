@@ -0,0 +1,142 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libc
+ * @{
+ */
+/** @file Shared memory ring channel
+ */
+
+#ifndef LIBC_SHMRING_H_
+#define LIBC_SHMRING_H_
+
+#include <async.h>
+#include <errno.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SHMRING_MAGIC  0x52494e47
+
+/** Payload alignment within the ring arena */
+#define SHMRING_ALIGN  64
+
+/** Shared memory ring descriptor. */
+typedef struct {
+	/** Payload offset within the arena */
+	uint64_t offset;
+	/** Payload size */
+	uint64_t size;
+	/** Protocol-specific argument */
+	uint64_t arg;
+} shmring_desc_t;
+
+/** Shared memory ring header.
+ *
+ * The header is placed at the beginning of the shared area, followed by
+ * the descriptor array and the page-aligned payload arena. The producer
+ * and consumer indices live on separate cache lines.
+ */
+typedef struct {
+	uint32_t magic;
+	/** Number of descriptor slots (power of two) */
+	uint32_t slots;
+	/** Offset of the arena from the beginning of the area */
+	uint64_t arena_offset;
+	/** Size of the arena */
+	uint64_t arena_size;
+
+	/** Producer index, written only by the producer */
+	uint64_t head __attribute__((aligned(SHMRING_ALIGN)));
+	/** Consumer index, written only by the consumer */
+	uint64_t tail __attribute__((aligned(SHMRING_ALIGN)));
+} shmring_hdr_t;
+
+/** Shared memory ring.
+ *
+ * Each ring carries payloads in one direction, from exactly one producer
+ * to exactly one consumer. Payloads are written directly to the shared
+ * arena by the producer and read in place by the consumer, so nothing is
+ * copied by the kernel. The producer notifies the consumer by an IPC call
+ * only when the ring becomes non-empty and the consumer answers that call
+ * once it has drained the ring.
+ */
+typedef struct {
+	/** Shared area */
+	shmring_hdr_t *hdr;
+	/** Size of the shared area */
+	size_t area_size;
+	/** Descriptor array */
+	shmring_desc_t *desc;
+	/** Payload arena */
+	uint8_t *arena;
+	/** Number of descriptor slots */
+	size_t slots;
+	/** Size of the arena */
+	size_t arena_size;
+
+	/** Producer index */
+	uint64_t head;
+	/** Consumer index (as last seen by the producer) */
+	uint64_t tail;
+	/** Arena position of the next payload */
+	uint64_t apos;
+	/** Arena position of the payload in each slot */
+	uint64_t *slot_pos;
+	/** Allocated but not yet posted payload */
+	uint64_t alloc_pos;
+	size_t alloc_size;
+
+	/** Session used for notifying the consumer */
+	async_sess_t *sess;
+	/** Notification method */
+	sysarg_t method;
+	/** Notification method argument */
+	sysarg_t method_arg;
+	/** Pending notification or zero */
+	aid_t notify;
+} shmring_t;
+
+extern errno_t shmring_create(size_t, size_t, shmring_t **);
+extern errno_t shmring_share(shmring_t *, async_exch_t *);
+extern errno_t shmring_accept(shmring_t **);
+extern void shmring_destroy(shmring_t *);
+extern void shmring_set_notify(shmring_t *, async_sess_t *, sysarg_t,
+    sysarg_t);
+
+extern errno_t shmring_alloc(shmring_t *, size_t, void **);
+extern errno_t shmring_post(shmring_t *, size_t, sysarg_t);
+extern errno_t shmring_flush(shmring_t *);
+
+extern errno_t shmring_peek(shmring_t *, void **, size_t *, sysarg_t *);
+extern void shmring_release(shmring_t *);
+
+#endif
+
+/** @}
+ */
@@ -60,6 +60,9 @@ typedef struct rtld {
 
 	/** List of initial modules */
 	list_t imodules;
+
+	/** Cache of global symbol lookups, allocated on first use */
+	struct symbol_cache *sym_cache;
 } rtld_t;
 
 #endif
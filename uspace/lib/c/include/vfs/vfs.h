@@ -74,6 +74,16 @@ typedef struct {
 	uint64_t f_bfree;    /* free blocks in fs */
 } vfs_statfs_t;
 
+/** Buffer for vectored I/O */
+typedef struct {
+	/** Position in the file */
+	aoff64_t pos;
+	/** Buffer */
+	void *buf;
+	/** Size of the buffer in bytes */
+	size_t size;
+} vfs_iovec_t;
+
 /** List of file system types */
 typedef struct {
 	char **fstypes;
@@ -105,6 +115,7 @@ extern errno_t vfs_pass_handle(async_exch_t *, int, async_exch_t *);
 extern errno_t vfs_put(int);
 extern errno_t vfs_read(int, aoff64_t *, void *, size_t, size_t *);
 extern errno_t vfs_read_short(int, aoff64_t, void *, size_t, ssize_t *);
+extern errno_t vfs_readv(int, const vfs_iovec_t *, size_t, size_t *);
 extern errno_t vfs_receive_handle(bool, int *);
 extern errno_t vfs_rename_path(const char *, const char *);
 extern errno_t vfs_resize(int, aoff64_t);
@@ -122,6 +133,7 @@ extern errno_t vfs_unmount_path(const char *);
 extern errno_t vfs_walk(int, const char *, int, int *);
 extern errno_t vfs_write(int, aoff64_t *, const void *, size_t, size_t *);
 extern errno_t vfs_write_short(int, aoff64_t, const void *, size_t, ssize_t *);
+extern errno_t vfs_writev(int, const vfs_iovec_t *, size_t, size_t *);
 
 #endif
 
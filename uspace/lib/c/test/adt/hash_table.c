@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/hash_table.h>
+#include <pcut/pcut.h>
+
+/** Test entry */
+typedef struct {
+	ht_link_t link;
+	size_t key;
+	bool visited;
+} test_entry_t;
+
+enum {
+	/** Number of test entries, enough to cause several resizes */
+	test_entry_cnt = 5000,
+	/** Number of entries sharing a key in the duplicate test */
+	test_dup_cnt = 3
+};
+
+static test_entry_t entries[test_entry_cnt];
+
+static size_t test_key_hash(void *key)
+{
+	return *(size_t *) key;
+}
+
+static size_t test_hash(const ht_link_t *item)
+{
+	test_entry_t *e = hash_table_get_inst(item, test_entry_t, link);
+	return e->key;
+}
+
+static bool test_key_equal(void *key, const ht_link_t *item)
+{
+	test_entry_t *e = hash_table_get_inst(item, test_entry_t, link);
+	return e->key == *(size_t *) key;
+}
+
+static bool test_equal(const ht_link_t *item1, const ht_link_t *item2)
+{
+	test_entry_t *e1 = hash_table_get_inst(item1, test_entry_t, link);
+	test_entry_t *e2 = hash_table_get_inst(item2, test_entry_t, link);
+	return e1->key == e2->key;
+}
+
+static hash_table_ops_t test_ops = {
+	.hash = test_hash,
+	.key_hash = test_key_hash,
+	.key_equal = test_key_equal,
+	.equal = test_equal,
+	.remove_callback = NULL
+};
+
+/** Count items matching a key using hash_table_find_next(). */
+static size_t test_count(hash_table_t *h, size_t key)
+{
+	ht_link_t *first = hash_table_find(h, &key);
+	if (first == NULL)
+		return 0;
+
+	size_t cnt = 1;
+	ht_link_t *cur = first;
+	while ((cur = hash_table_find_next(h, first, cur)) != NULL)
+		cnt++;
+
+	return cnt;
+}
+
+static bool test_visit(ht_link_t *item, void *arg)
+{
+	test_entry_t *e = hash_table_get_inst(item, test_entry_t, link);
+	size_t *cnt = (size_t *) arg;
+
+	PCUT_ASSERT_FALSE(e->visited);
+	e->visited = true;
+	(*cnt)++;
+	return true;
+}
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(hash_table);
+
+/** Items can be found while the table grows and migrates buckets. */
+PCUT_TEST(insert_find)
+{
+	hash_table_t h;
+	size_t i;
+
+	PCUT_ASSERT_TRUE(hash_table_create(&h, 0, 0, &test_ops));
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		entries[i].key = i;
+		hash_table_insert(&h, &entries[i].link);
+
+		PCUT_ASSERT_EQUALS(&entries[i].link, hash_table_find(&h, &i));
+		PCUT_ASSERT_EQUALS(&entries[i / 2].link,
+		    hash_table_find(&h, &entries[i / 2].key));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_entry_cnt, hash_table_size(&h));
+
+	for (i = 0; i < test_entry_cnt; i++)
+		PCUT_ASSERT_EQUALS(&entries[i].link, hash_table_find(&h, &i));
+
+	i = test_entry_cnt;
+	PCUT_ASSERT_NULL(hash_table_find(&h, &i));
+
+	hash_table_destroy(&h);
+}
+
+/** Items can be removed while the table shrinks and migrates buckets. */
+PCUT_TEST(remove)
+{
+	hash_table_t h;
+	size_t i;
+
+	PCUT_ASSERT_TRUE(hash_table_create(&h, 0, 0, &test_ops));
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		entries[i].key = i;
+		hash_table_insert(&h, &entries[i].link);
+	}
+
+	for (i = 0; i < test_entry_cnt; i += 2)
+		PCUT_ASSERT_INT_EQUALS(1, hash_table_remove(&h, &i));
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		if (i % 2 == 0)
+			PCUT_ASSERT_NULL(hash_table_find(&h, &i));
+		else
+			PCUT_ASSERT_EQUALS(&entries[i].link,
+			    hash_table_find(&h, &i));
+	}
+
+	for (i = 1; i < test_entry_cnt; i += 2)
+		hash_table_remove_item(&h, &entries[i].link);
+
+	PCUT_ASSERT_TRUE(hash_table_empty(&h));
+
+	for (i = 0; i < test_entry_cnt; i++)
+		PCUT_ASSERT_NULL(hash_table_find(&h, &i));
+
+	hash_table_destroy(&h);
+}
+
+/** Items with equal keys are found together during migration. */
+PCUT_TEST(duplicates)
+{
+	hash_table_t h;
+	size_t i;
+
+	PCUT_ASSERT_TRUE(hash_table_create(&h, 0, 0, &test_ops));
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		entries[i].key = i / test_dup_cnt;
+		hash_table_insert(&h, &entries[i].link);
+
+		PCUT_ASSERT_INT_EQUALS(i % test_dup_cnt + 1,
+		    test_count(&h, entries[i].key));
+	}
+
+	for (i = 0; i < test_entry_cnt / test_dup_cnt; i++)
+		PCUT_ASSERT_INT_EQUALS(test_dup_cnt, test_count(&h, i));
+
+	hash_table_destroy(&h);
+}
+
+/** Duplicates are rejected even if the original has not been migrated. */
+PCUT_TEST(insert_unique)
+{
+	hash_table_t h;
+	test_entry_t dup;
+	size_t i;
+
+	PCUT_ASSERT_TRUE(hash_table_create(&h, 0, 0, &test_ops));
+
+	for (i = 0; i < test_entry_cnt; i++) {
+		entries[i].key = i;
+		PCUT_ASSERT_TRUE(hash_table_insert_unique(&h,
+		    &entries[i].link));
+
+		dup.key = i / 2;
+		PCUT_ASSERT_FALSE(hash_table_insert_unique(&h, &dup.link));
+	}
+
+	PCUT_ASSERT_INT_EQUALS(test_entry_cnt, hash_table_size(&h));
+
+	hash_table_destroy(&h);
+}
+
+/** Apply visits each item exactly once during migration. */
+PCUT_TEST(apply)
+{
+	hash_table_t h;
+	size_t cnt;
+	size_t i;
+
+	PCUT_ASSERT_TRUE(hash_table_create(&h, 0, 0, &test_ops));
+
+	/* The table has just grown, so most buckets are yet to be migrated. */
+	for (i = 0; i < 2 * 89 + 2; i++) {
+		entries[i].key = i;
+		entries[i].visited = false;
+		hash_table_insert(&h, &entries[i].link);
+	}
+
+	cnt = 0;
+	hash_table_apply(&h, test_visit, &cnt);
+	PCUT_ASSERT_INT_EQUALS(i, cnt);
+
+	hash_table_clear(&h);
+	PCUT_ASSERT_TRUE(hash_table_empty(&h));
+
+	hash_table_destroy(&h);
+}
+
+PCUT_EXPORT(hash_table);
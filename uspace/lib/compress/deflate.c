@@ -0,0 +1,1294 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file
+ * @brief Implementation of deflate compression
+ *
+ * A deflate compressor (RFC 1951) producing streams which can be
+ * decompressed by any conforming inflate implementation.
+ *
+ * The matches are found using hash chains over a 32 KiB sliding window.
+ * Low compression levels use greedy matching, higher levels use lazy
+ * evaluation of the matches (a match is emitted only if the match
+ * starting at the next byte is not longer). The level also bounds the
+ * length of the hash chains searched.
+ *
+ * For each block the exact cost of the stored, fixed and dynamic
+ * encoding is computed and the cheapest one is emitted. The dynamic
+ * Huffman codes are computed using the in-place minimum-redundancy
+ * algorithm of Moffat and Katajainen and then limited to the maximum
+ * code length allowed by the format.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <mem.h>
+#include <macros.h>
+#include "deflate.h"
+
+/** Maximum bits in the Huffman code */
+#define MAX_HUFFMAN_BIT  15
+/** Maximum bits in the code length code */
+#define MAX_CODE_LENGTH_BIT  7
+
+/** Number of length codes */
+#define MAX_LEN     29
+/** Number of distance codes */
+#define MAX_DIST    30
+/** Number of order codes */
+#define MAX_ORDER   19
+/** Number of literal/length codes */
+#define MAX_LITLEN  286
+/** Number of fixed literal/length codes */
+#define MAX_FIXED_LITLEN  288
+
+/** Number of all codes */
+#define MAX_CODE  (MAX_LITLEN + MAX_DIST)
+
+/** End-of-block symbol */
+#define END_BLOCK  256
+
+/** Minimum and maximum length of a match */
+#define MIN_MATCH  3
+#define MAX_MATCH  258
+
+/** Size of the sliding window (maximum distance) */
+#define WSIZE  32768
+#define WMASK  (WSIZE - 1)
+
+/** Minimum lookahead to find the longest match */
+#define MIN_LOOKAHEAD  (MAX_MATCH + MIN_MATCH + 1)
+
+/** Maximum distance of a match (to keep the lookahead in the window) */
+#define MAX_DIST_BACK  (WSIZE - MIN_LOOKAHEAD)
+
+/** Matches of minimal length are not worth it beyond this distance */
+#define TOO_FAR  4096
+
+/** Hash table parameters */
+#define HASH_BITS  15
+#define HASH_SIZE  (1 << HASH_BITS)
+#define HASH_MASK  (HASH_SIZE - 1)
+
+/** End of a hash chain */
+#define NIL  0
+
+/** Number of symbols buffered for a block */
+#define SYM_BUFSIZE  16384
+
+/** Maximum size of a stored block */
+#define MAX_STORED  65535
+
+/** Size of the output buffer (largest block plus headers) */
+#define OUT_BUFSIZE  (2 * WSIZE + 64)
+
+/** Compression configuration for a level
+ *
+ */
+typedef struct {
+	uint16_t good;   /**< Reduce the search above this match length */
+	uint16_t lazy;   /**< Do not search lazily above this match length */
+	uint16_t nice;   /**< Stop searching at this match length */
+	uint16_t chain;  /**< Maximum hash chain length searched */
+	bool greedy;     /**< Greedy matching (lazy is insertion limit) */
+} deflate_config_t;
+
+/** Configuration for the compression levels
+ *
+ */
+static const deflate_config_t config[DEFLATE_LEVEL_MAX + 1] = {
+	{ 0, 0, 0, 0, true },
+	{ 4, 4, 8, 4, true },
+	{ 4, 5, 16, 8, true },
+	{ 4, 6, 32, 32, true },
+	{ 4, 4, 16, 16, false },
+	{ 8, 16, 32, 32, false },
+	{ 8, 16, 128, 128, false },
+	{ 8, 32, 128, 256, false },
+	{ 32, 128, 258, 1024, false },
+	{ 32, 258, 258, 4096, false }
+};
+
+/** Length codes
+ *
+ */
+static const uint16_t lens[MAX_LEN] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+
+/** Extended length codes
+ *
+ */
+static const uint16_t lens_ext[MAX_LEN] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+	3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+/** Distance codes
+ *
+ */
+static const uint16_t dists[MAX_DIST] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145,
+	8193, 12289, 16385, 24577
+};
+
+/** Extended distance codes
+ *
+ */
+static const uint16_t dists_ext[MAX_DIST] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+	7, 7, 8, 8, 9, 9, 10, 10, 11, 11,
+	12, 12, 13, 13
+};
+
+/** Order codes
+ *
+ */
+static const uint8_t order[MAX_ORDER] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+/** Huffman code
+ *
+ */
+typedef struct {
+	uint8_t length[MAX_FIXED_LITLEN];  /**< Code lengths */
+	uint16_t code[MAX_FIXED_LITLEN];   /**< Bit-reversed codes */
+} huffman_t;
+
+/** Symbol frequency used for the code construction
+ *
+ */
+typedef struct {
+	uint32_t key;     /**< Frequency, later code length */
+	uint16_t symbol;  /**< Symbol */
+} huffman_freq_t;
+
+/** Deflate stream state
+ *
+ */
+struct deflate_stream {
+	deflate_config_t config;  /**< Compression configuration */
+	bool store;               /**< Store only (level 0) */
+	bool done;                /**< The final block has been emitted */
+
+	const uint8_t *in;     /**< Current input position */
+	const uint8_t *inend;  /**< End of the input buffer */
+
+	/** Window (two halves plus padding for match comparison) */
+	uint8_t window[2 * WSIZE + MAX_MATCH];
+	size_t strstart;    /**< Current position in the window */
+	size_t lookahead;   /**< Number of valid bytes ahead of strstart */
+	size_t block_start; /**< Window position of the current block */
+
+	uint16_t head[HASH_SIZE];  /**< Heads of the hash chains */
+	uint16_t prev[WSIZE];      /**< Links of the hash chains */
+
+	size_t match_start;    /**< Start of the current match */
+	size_t match_length;   /**< Length of the current match */
+	size_t prev_match;     /**< Start of the previous match */
+	size_t prev_length;    /**< Length of the previous match */
+	bool match_available;  /**< Previous byte not yet emitted */
+
+	uint8_t sym_lc[SYM_BUFSIZE];     /**< Literals or match lengths - 3 */
+	uint16_t sym_dist[SYM_BUFSIZE];  /**< Match distances (0 for literal) */
+	size_t sym_count;                /**< Number of buffered symbols */
+
+	uint32_t len_freq[MAX_FIXED_LITLEN];  /**< Literal/length frequencies */
+	uint32_t dist_freq[MAX_DIST];         /**< Distance frequencies */
+
+	/** Match length to length code */
+	uint8_t length_code[MAX_MATCH - MIN_MATCH + 1];
+	/** Match distance to distance code */
+	uint8_t dist_code[512];
+
+	huffman_t fixed_len_code;   /**< Fixed literal/length code */
+	huffman_t fixed_dist_code;  /**< Fixed distance code */
+	huffman_t dyn_len_code;     /**< Dynamic literal/length code */
+	huffman_t dyn_dist_code;    /**< Dynamic distance code */
+	huffman_t dyn_code_code;    /**< Dynamic code length code */
+
+	uint8_t out[OUT_BUFSIZE];  /**< Output buffer */
+	size_t outlen;             /**< Bytes in the output buffer */
+	size_t outpos;             /**< Bytes already passed to the caller */
+
+	uint64_t bitbuf;  /**< Bit buffer */
+	size_t bitlen;    /**< Number of bits in the bit buffer */
+};
+
+/** Put bits into the output
+ *
+ * @param stream Deflate stream.
+ * @param val    Bits to output (starting with the least significant).
+ * @param cnt    Number of bits (at most 32).
+ *
+ */
+static inline void put_bits(deflate_stream_t *stream, uint32_t val,
+    size_t cnt)
+{
+	stream->bitbuf |= ((uint64_t) val) << stream->bitlen;
+	stream->bitlen += cnt;
+
+	while (stream->bitlen >= 8) {
+		stream->out[stream->outlen] = (uint8_t) stream->bitbuf;
+		stream->outlen++;
+		stream->bitbuf >>= 8;
+		stream->bitlen -= 8;
+	}
+}
+
+/** Pad the output with zero bits to the byte boundary
+ *
+ * @param stream Deflate stream.
+ *
+ */
+static void put_align(deflate_stream_t *stream)
+{
+	if (stream->bitlen > 0)
+		put_bits(stream, 0, 8 - stream->bitlen);
+}
+
+/** Compare frequencies for sorting
+ *
+ */
+static int huffman_freq_cmp(const void *a, const void *b)
+{
+	const huffman_freq_t *fa = (const huffman_freq_t *) a;
+	const huffman_freq_t *fb = (const huffman_freq_t *) b;
+
+	if (fa->key != fb->key)
+		return (fa->key < fb->key) ? -1 : 1;
+
+	return (int) fa->symbol - (int) fb->symbol;
+}
+
+/** Compute minimum-redundancy code lengths
+ *
+ * In-place algorithm of Moffat and Katajainen. On input, the keys
+ * are the frequencies sorted in ascending order, on output they are
+ * the code lengths.
+ *
+ * @param freq Sorted frequencies.
+ * @param n    Number of frequencies.
+ *
+ */
+static void huffman_lengths(huffman_freq_t *freq, size_t n)
+{
+	if (n == 0)
+		return;
+
+	if (n == 1) {
+		freq[0].key = 1;
+		return;
+	}
+
+	/* Phase 1: Compute the parent pointers of the internal nodes */
+	size_t root = 0;
+	size_t leaf = 2;
+	size_t next;
+
+	freq[0].key += freq[1].key;
+
+	for (next = 1; next < n - 1; next++) {
+		if ((leaf >= n) || (freq[root].key < freq[leaf].key)) {
+			freq[next].key = freq[root].key;
+			freq[root].key = next;
+			root++;
+		} else {
+			freq[next].key = freq[leaf].key;
+			leaf++;
+		}
+
+		if ((leaf >= n) ||
+		    ((root < next) && (freq[root].key < freq[leaf].key))) {
+			freq[next].key += freq[root].key;
+			freq[root].key = next;
+			root++;
+		} else {
+			freq[next].key += freq[leaf].key;
+			leaf++;
+		}
+	}
+
+	/* Phase 2: Compute the depths of the internal nodes */
+	freq[n - 2].key = 0;
+	for (next = n - 2; next > 0; next--)
+		freq[next - 1].key = freq[freq[next - 1].key].key + 1;
+
+	/* Phase 3: Compute the depths of the leaves */
+	size_t avail = 1;
+	size_t used = 0;
+	uint32_t depth = 0;
+	size_t node = n - 1;
+	size_t inner = n - 1;
+
+	while (avail > 0) {
+		while ((inner > 0) && (freq[inner - 1].key == depth)) {
+			used++;
+			inner--;
+		}
+
+		while (avail > used) {
+			freq[node].key = depth;
+			node--;
+			avail--;
+		}
+
+		avail = 2 * used;
+		depth++;
+		used = 0;
+	}
+}
+
+/** Build a length-limited Huffman code
+ *
+ * @param huffman Huffman code to build.
+ * @param freq    Symbol frequencies.
+ * @param n       Number of symbols.
+ * @param maxbits Maximum code length.
+ *
+ */
+static void huffman_build(huffman_t *huffman, const uint32_t *freq,
+    size_t n, size_t maxbits)
+{
+	huffman_freq_t sorted[MAX_FIXED_LITLEN];
+	size_t used = 0;
+
+	for (size_t symbol = 0; symbol < n; symbol++) {
+		huffman->length[symbol] = 0;
+
+		if (freq[symbol] != 0) {
+			sorted[used].key = freq[symbol];
+			sorted[used].symbol = symbol;
+			used++;
+		}
+	}
+
+	/*
+	 * The format requires at least one code for each tree and
+	 * decoders may reject a single code of length zero. Force two
+	 * codes of non-zero length.
+	 */
+	for (size_t symbol = 0; (used < 2) && (symbol < n); symbol++) {
+		if ((used == 1) && (sorted[0].symbol == symbol))
+			continue;
+
+		sorted[used].key = 1;
+		sorted[used].symbol = symbol;
+		used++;
+	}
+
+	qsort(sorted, used, sizeof(huffman_freq_t), huffman_freq_cmp);
+	huffman_lengths(sorted, used);
+
+	/* Count the codes of each length, folding the overlong ones */
+	size_t count[MAX_HUFFMAN_BIT + 1];
+	for (size_t len = 0; len <= maxbits; len++)
+		count[len] = 0;
+
+	for (size_t i = 0; i < used; i++)
+		count[min((size_t) sorted[i].key, maxbits)]++;
+
+	/* Shorten codes until the Kraft inequality holds */
+	uint32_t total = 0;
+	for (size_t len = maxbits; len > 0; len--)
+		total += ((uint32_t) count[len]) << (maxbits - len);
+
+	while (total != (UINT32_C(1) << maxbits)) {
+		count[maxbits]--;
+
+		for (size_t len = maxbits - 1; len > 0; len--) {
+			if (count[len] != 0) {
+				count[len]--;
+				count[len + 1] += 2;
+				break;
+			}
+		}
+
+		total--;
+	}
+
+	/* The most frequent symbols get the shortest codes */
+	size_t i = used;
+	for (size_t len = 1; len <= maxbits; len++) {
+		for (size_t j = count[len]; j > 0; j--) {
+			i--;
+			huffman->length[sorted[i].symbol] = len;
+		}
+	}
+}
+
+/** Assign canonical codes to the code lengths
+ *
+ * The codes are stored bit-reversed, since the Huffman codes are
+ * packed starting with the most significant bit.
+ *
+ * @param huffman Huffman code.
+ * @param n       Number of symbols.
+ *
+ */
+static void huffman_codes(huffman_t *huffman, size_t n)
+{
+	uint16_t count[MAX_HUFFMAN_BIT + 1];
+	uint16_t next[MAX_HUFFMAN_BIT + 1];
+
+	for (size_t len = 0; len <= MAX_HUFFMAN_BIT; len++)
+		count[len] = 0;
+
+	for (size_t symbol = 0; symbol < n; symbol++)
+		count[huffman->length[symbol]]++;
+
+	uint16_t code = 0;
+	count[0] = 0;
+	for (size_t len = 1; len <= MAX_HUFFMAN_BIT; len++) {
+		code = (code + count[len - 1]) << 1;
+		next[len] = code;
+	}
+
+	for (size_t symbol = 0; symbol < n; symbol++) {
+		size_t len = huffman->length[symbol];
+		if (len == 0)
+			continue;
+
+		code = next[len];
+		next[len]++;
+
+		uint16_t rev = 0;
+		for (size_t bit = 0; bit < len; bit++) {
+			if ((code & (1 << bit)) != 0)
+				rev |= 1 << (len - 1 - bit);
+		}
+
+		huffman->code[symbol] = rev;
+	}
+}
+
+/** Insert a string into the hash chains
+ *
+ * @param stream Deflate stream.
+ * @param pos    Window position of the string.
+ *
+ * @return Previous head of the hash chain.
+ *
+ */
+static inline size_t insert_string(deflate_stream_t *stream, size_t pos)
+{
+	const uint8_t *str = stream->window + pos;
+	size_t hash = ((str[0] << 10) ^ (str[1] << 5) ^ str[2]) & HASH_MASK;
+
+	size_t head = stream->head[hash];
+	stream->prev[pos & WMASK] = head;
+	stream->head[hash] = pos;
+
+	return head;
+}
+
+/** Find the longest match
+ *
+ * @param stream   Deflate stream.
+ * @param cur      Head of the hash chain.
+ * @param best_len Length of the best match so far.
+ *
+ * @return Length of the longest match found (best_len if
+ *         no longer match has been found). The position of the
+ *         match is stored into match_start.
+ *
+ */
+static size_t longest_match(deflate_stream_t *stream, size_t cur,
+    size_t best_len)
+{
+	size_t chain = stream->config.chain;
+	size_t max_len = min((size_t) MAX_MATCH, stream->lookahead);
+	size_t nice = min((size_t) stream->config.nice, max_len);
+	size_t limit = (stream->strstart > MAX_DIST_BACK) ?
+	    stream->strstart - MAX_DIST_BACK : NIL;
+	const uint8_t *scan = stream->window + stream->strstart;
+
+	if (best_len >= max_len)
+		return best_len;
+
+	/* Do not waste too much time if we already have a good match */
+	if (best_len >= stream->config.good)
+		chain >>= 2;
+
+	do {
+		const uint8_t *match = stream->window + cur;
+
+		/* Skip quickly over the candidates which cannot be better */
+		if ((match[best_len] != scan[best_len]) ||
+		    (match[best_len - 1] != scan[best_len - 1]) ||
+		    (match[0] != scan[0]) || (match[1] != scan[1]))
+			continue;
+
+		size_t len = 2;
+		while ((len < max_len) && (match[len] == scan[len]))
+			len++;
+
+		if (len > best_len) {
+			stream->match_start = cur;
+			best_len = len;
+
+			if (len >= nice)
+				break;
+		}
+	} while (((cur = stream->prev[cur & WMASK]) > limit) &&
+	    (--chain != 0));
+
+	return best_len;
+}
+
+/** Record a literal
+ *
+ * @param stream Deflate stream.
+ * @param byte   Literal.
+ *
+ * @return True if the symbol buffer is full.
+ *
+ */
+static inline bool tally_literal(deflate_stream_t *stream, uint8_t byte)
+{
+	stream->sym_lc[stream->sym_count] = byte;
+	stream->sym_dist[stream->sym_count] = 0;
+	stream->sym_count++;
+	stream->len_freq[byte]++;
+
+	return (stream->sym_count == SYM_BUFSIZE);
+}
+
+/** Record a match
+ *
+ * @param stream Deflate stream.
+ * @param dist   Match distance.
+ * @param len    Match length.
+ *
+ * @return True if the symbol buffer is full.
+ *
+ */
+static inline bool tally_match(deflate_stream_t *stream, size_t dist,
+    size_t len)
+{
+	stream->sym_lc[stream->sym_count] = len - MIN_MATCH;
+	stream->sym_dist[stream->sym_count] = dist;
+	stream->sym_count++;
+
+	stream->len_freq[stream->length_code[len - MIN_MATCH] + 257]++;
+	dist--;
+	stream->dist_freq[(dist < 256) ? stream->dist_code[dist] :
+	    stream->dist_code[256 + (dist >> 7)]]++;
+
+	return (stream->sym_count == SYM_BUFSIZE);
+}
+
+/** Compute the cost of the buffered symbols
+ *
+ * @param stream    Deflate stream.
+ * @param len_code  Literal/length code.
+ * @param dist_code Distance code.
+ *
+ * @return Cost in bits (including the end-of-block code).
+ *
+ */
+static size_t block_cost(deflate_stream_t *stream, const huffman_t *len_code,
+    const huffman_t *dist_code)
+{
+	size_t cost = 0;
+
+	for (size_t symbol = 0; symbol < 257; symbol++)
+		cost += stream->len_freq[symbol] * len_code->length[symbol];
+
+	for (size_t code = 0; code < MAX_LEN; code++) {
+		cost += stream->len_freq[code + 257] *
+		    (len_code->length[code + 257] + lens_ext[code]);
+	}
+
+	for (size_t code = 0; code < MAX_DIST; code++) {
+		cost += stream->dist_freq[code] *
+		    (dist_code->length[code] + dists_ext[code]);
+	}
+
+	return cost;
+}
+
+/** Run-length encode the code lengths of the dynamic trees
+ *
+ * @param lengths Code lengths.
+ * @param n       Number of code lengths.
+ * @param syms    Code length symbols (with the extra bits in the
+ *                upper byte).
+ * @param freq    Frequencies of the code length symbols (updated).
+ *
+ * @return Number of code length symbols.
+ *
+ */
+static size_t encode_lengths(const uint8_t *lengths, size_t n,
+    uint16_t *syms, uint32_t *freq)
+{
+	size_t cnt = 0;
+	size_t i = 0;
+
+	while (i < n) {
+		uint8_t len = lengths[i];
+		size_t run = 1;
+		while ((i + run < n) && (lengths[i + run] == len))
+			run++;
+
+		i += run;
+
+		if (len == 0) {
+			while (run >= 11) {
+				size_t rep = min(run, (size_t) 138);
+				syms[cnt++] = 18 | ((rep - 11) << 8);
+				freq[18]++;
+				run -= rep;
+			}
+
+			if (run >= 3) {
+				syms[cnt++] = 17 | ((run - 3) << 8);
+				freq[17]++;
+				run = 0;
+			}
+		} else {
+			syms[cnt++] = len;
+			freq[len]++;
+			run--;
+
+			while (run >= 3) {
+				size_t rep = min(run, (size_t) 6);
+				syms[cnt++] = 16 | ((rep - 3) << 8);
+				freq[16]++;
+				run -= rep;
+			}
+		}
+
+		while (run > 0) {
+			syms[cnt++] = len;
+			freq[len]++;
+			run--;
+		}
+	}
+
+	return cnt;
+}
+
+/** Write the buffered symbols
+ *
+ * @param stream    Deflate stream.
+ * @param len_code  Literal/length code.
+ * @param dist_code Distance code.
+ *
+ */
+static void write_symbols(deflate_stream_t *stream, const huffman_t *len_code,
+    const huffman_t *dist_code)
+{
+	for (size_t i = 0; i < stream->sym_count; i++) {
+		size_t dist = stream->sym_dist[i];
+		size_t lc = stream->sym_lc[i];
+
+		if (dist == 0) {
+			put_bits(stream, len_code->code[lc],
+			    len_code->length[lc]);
+			continue;
+		}
+
+		size_t code = stream->length_code[lc];
+		put_bits(stream, len_code->code[code + 257],
+		    len_code->length[code + 257]);
+		put_bits(stream, lc + MIN_MATCH - lens[code], lens_ext[code]);
+
+		dist--;
+		code = (dist < 256) ? stream->dist_code[dist] :
+		    stream->dist_code[256 + (dist >> 7)];
+		put_bits(stream, dist_code->code[code],
+		    dist_code->length[code]);
+		put_bits(stream, dist + 1 - dists[code], dists_ext[code]);
+	}
+
+	put_bits(stream, len_code->code[END_BLOCK],
+	    len_code->length[END_BLOCK]);
+}
+
+/** Write stored blocks
+ *
+ * @param stream Deflate stream.
+ * @param data   Block data.
+ * @param size   Size of the data.
+ * @param last   Last block of the stream.
+ *
+ */
+static void write_stored(deflate_stream_t *stream, const uint8_t *data,
+    size_t size, bool last)
+{
+	do {
+		size_t len = min(size, (size_t) MAX_STORED);
+		bool final = last && (len == size);
+
+		put_bits(stream, final ? 1 : 0, 1);
+		put_bits(stream, 0, 2);
+		put_align(stream);
+		put_bits(stream, len, 16);
+		put_bits(stream, ~len & 0xffff, 16);
+
+		memcpy(stream->out + stream->outlen, data, len);
+		stream->outlen += len;
+
+		data += len;
+		size -= len;
+	} while (size > 0);
+}
+
+/** Emit the current block
+ *
+ * The block covers the window from block_start up to the current
+ * position (excluding the byte held back by the lazy evaluation).
+ * The output buffer is expected to be empty.
+ *
+ * @param stream Deflate stream.
+ * @param last   Last block of the stream.
+ *
+ */
+static void emit_block(deflate_stream_t *stream, bool last)
+{
+	size_t end = stream->strstart - (stream->match_available ? 1 : 0);
+	size_t size = end - stream->block_start;
+	const uint8_t *data = stream->window + stream->block_start;
+
+	/* Cost of stored blocks */
+	size_t chunks = (size + MAX_STORED - 1) / MAX_STORED;
+	size_t stored_cost = 3 + ((8 - ((stream->bitlen + 3) & 7)) & 7) +
+	    32 + 8 * size;
+	if (chunks > 1)
+		stored_cost += (chunks - 1) * (8 + 32);
+
+	if (stream->store) {
+		write_stored(stream, data, size, last);
+		goto done;
+	}
+
+	stream->len_freq[END_BLOCK] = 1;
+
+	/* Cost of fixed codes */
+	size_t fixed_cost = 3 + block_cost(stream, &stream->fixed_len_code,
+	    &stream->fixed_dist_code);
+
+	/* Build dynamic codes */
+	huffman_build(&stream->dyn_len_code, stream->len_freq, MAX_LITLEN,
+	    MAX_HUFFMAN_BIT);
+	huffman_build(&stream->dyn_dist_code, stream->dist_freq, MAX_DIST,
+	    MAX_HUFFMAN_BIT);
+
+	size_t nlen = MAX_LITLEN;
+	while ((nlen > 257) && (stream->dyn_len_code.length[nlen - 1] == 0))
+		nlen--;
+
+	size_t ndist = MAX_DIST;
+	while ((ndist > 1) && (stream->dyn_dist_code.length[ndist - 1] == 0))
+		ndist--;
+
+	/* Run-length encode the code lengths */
+	uint8_t lengths[MAX_CODE];
+	memcpy(lengths, stream->dyn_len_code.length, nlen);
+	memcpy(lengths + nlen, stream->dyn_dist_code.length, ndist);
+
+	uint16_t syms[MAX_CODE];
+	uint32_t code_freq[MAX_ORDER];
+	memset(code_freq, 0, sizeof(code_freq));
+
+	size_t nsyms = encode_lengths(lengths, nlen + ndist, syms, code_freq);
+
+	huffman_build(&stream->dyn_code_code, code_freq, MAX_ORDER,
+	    MAX_CODE_LENGTH_BIT);
+
+	size_t ncode = MAX_ORDER;
+	while ((ncode > 4) &&
+	    (stream->dyn_code_code.length[order[ncode - 1]] == 0))
+		ncode--;
+
+	/* Cost of dynamic codes */
+	size_t dynamic_cost = 3 + 5 + 5 + 4 + 3 * ncode;
+
+	for (size_t symbol = 0; symbol < MAX_ORDER; symbol++)
+		dynamic_cost += code_freq[symbol] *
+		    stream->dyn_code_code.length[symbol];
+
+	dynamic_cost += 2 * code_freq[16] + 3 * code_freq[17] +
+	    7 * code_freq[18];
+	dynamic_cost += block_cost(stream, &stream->dyn_len_code,
+	    &stream->dyn_dist_code);
+
+	if ((stored_cost <= fixed_cost) && (stored_cost <= dynamic_cost)) {
+		write_stored(stream, data, size, last);
+	} else if (fixed_cost <= dynamic_cost) {
+		put_bits(stream, last ? 1 : 0, 1);
+		put_bits(stream, 1, 2);
+		write_symbols(stream, &stream->fixed_len_code,
+		    &stream->fixed_dist_code);
+	} else {
+		huffman_codes(&stream->dyn_len_code, MAX_LITLEN);
+		huffman_codes(&stream->dyn_dist_code, MAX_DIST);
+		huffman_codes(&stream->dyn_code_code, MAX_ORDER);
+
+		put_bits(stream, last ? 1 : 0, 1);
+		put_bits(stream, 2, 2);
+		put_bits(stream, nlen - 257, 5);
+		put_bits(stream, ndist - 1, 5);
+		put_bits(stream, ncode - 4, 4);
+
+		for (size_t i = 0; i < ncode; i++) {
+			put_bits(stream,
+			    stream->dyn_code_code.length[order[i]], 3);
+		}
+
+		for (size_t i = 0; i < nsyms; i++) {
+			size_t symbol = syms[i] & 0xff;
+			size_t extra = syms[i] >> 8;
+
+			put_bits(stream, stream->dyn_code_code.code[symbol],
+			    stream->dyn_code_code.length[symbol]);
+
+			if (symbol == 16)
+				put_bits(stream, extra, 2);
+			else if (symbol == 17)
+				put_bits(stream, extra, 3);
+			else if (symbol == 18)
+				put_bits(stream, extra, 7);
+		}
+
+		write_symbols(stream, &stream->dyn_len_code,
+		    &stream->dyn_dist_code);
+	}
+
+done:
+	memset(stream->len_freq, 0, sizeof(stream->len_freq));
+	memset(stream->dist_freq, 0, sizeof(stream->dist_freq));
+	stream->sym_count = 0;
+	stream->block_start = end;
+}
+
+/** Fill the window from the input
+ *
+ * If the window is exhausted, the current block is emitted and
+ * the upper half of the window is moved down. The output buffer
+ * is expected to be empty.
+ *
+ * @param stream Deflate stream.
+ *
+ * @return True if a block has been emitted.
+ *
+ */
+static bool fill_window(deflate_stream_t *stream)
+{
+	bool emitted = false;
+
+	if ((stream->in == stream->inend) ||
+	    (stream->strstart + stream->lookahead < 2 * WSIZE))
+		goto copy;
+
+	if (stream->strstart < WSIZE + MAX_DIST_BACK)
+		return false;
+
+	/*
+	 * Emit the current block first, so that the data of a stored
+	 * block are still available in the window.
+	 */
+	if (stream->block_start + (stream->match_available ? 1 : 0) <
+	    stream->strstart) {
+		emit_block(stream, false);
+		emitted = true;
+	}
+
+	memcpy(stream->window, stream->window + WSIZE, WSIZE);
+	stream->strstart -= WSIZE;
+	stream->block_start -= WSIZE;
+	stream->match_start -= WSIZE;
+	stream->prev_match -= WSIZE;
+
+	for (size_t i = 0; i < HASH_SIZE; i++) {
+		size_t pos = stream->head[i];
+		stream->head[i] = (pos >= WSIZE) ? pos - WSIZE : NIL;
+	}
+
+	for (size_t i = 0; i < WSIZE; i++) {
+		size_t pos = stream->prev[i];
+		stream->prev[i] = (pos >= WSIZE) ? pos - WSIZE : NIL;
+	}
+
+copy:
+	{
+		size_t pos = stream->strstart + stream->lookahead;
+		size_t len = min(2 * WSIZE - pos,
+		    (size_t) (stream->inend - stream->in));
+
+		memcpy(stream->window + pos, stream->in, len);
+		stream->in += len;
+		stream->lookahead += len;
+	}
+
+	return emitted;
+}
+
+/** Compress the window with greedy matching
+ *
+ * @param stream Deflate stream.
+ * @param flush  Compress the whole lookahead.
+ *
+ * @return True if a block has been emitted.
+ *
+ */
+static bool deflate_greedy(deflate_stream_t *stream, bool flush)
+{
+	while ((stream->lookahead >= MIN_LOOKAHEAD) ||
+	    ((flush) && (stream->lookahead > 0))) {
+		size_t head = NIL;
+		if (stream->lookahead >= MIN_MATCH)
+			head = insert_string(stream, stream->strstart);
+
+		size_t len = MIN_MATCH - 1;
+		if ((head != NIL) &&
+		    (stream->strstart - head <= MAX_DIST_BACK))
+			len = longest_match(stream, head, MIN_MATCH - 1);
+
+		bool full;
+
+		if (len >= MIN_MATCH) {
+			full = tally_match(stream,
+			    stream->strstart - stream->match_start, len);
+			stream->lookahead -= len;
+
+			if ((len <= stream->config.lazy) &&
+			    (stream->lookahead >= MIN_MATCH)) {
+				/* Insert the strings covered by the match */
+				while (--len > 0) {
+					stream->strstart++;
+					insert_string(stream, stream->strstart);
+				}
+
+				stream->strstart++;
+			} else {
+				stream->strstart += len;
+			}
+		} else {
+			full = tally_literal(stream,
+			    stream->window[stream->strstart]);
+			stream->lookahead--;
+			stream->strstart++;
+		}
+
+		if (full) {
+			emit_block(stream, false);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** Compress the window with lazy matching
+ *
+ * @param stream Deflate stream.
+ * @param flush  Compress the whole lookahead.
+ *
+ * @return True if a block has been emitted.
+ *
+ */
+static bool deflate_lazy(deflate_stream_t *stream, bool flush)
+{
+	while ((stream->lookahead >= MIN_LOOKAHEAD) ||
+	    ((flush) && (stream->lookahead > 0))) {
+		size_t head = NIL;
+		if (stream->lookahead >= MIN_MATCH)
+			head = insert_string(stream, stream->strstart);
+
+		stream->prev_length = stream->match_length;
+		stream->prev_match = stream->match_start;
+		stream->match_length = MIN_MATCH - 1;
+
+		if ((head != NIL) &&
+		    (stream->prev_length < stream->config.lazy) &&
+		    (stream->strstart - head <= MAX_DIST_BACK)) {
+			stream->match_length = longest_match(stream, head,
+			    stream->prev_length);
+
+			if ((stream->match_length == MIN_MATCH) &&
+			    (stream->strstart - stream->match_start > TOO_FAR))
+				stream->match_length = MIN_MATCH - 1;
+		}
+
+		bool full = false;
+
+		if ((stream->prev_length >= MIN_MATCH) &&
+		    (stream->match_length <= stream->prev_length)) {
+			/* The previous match is better, emit it */
+			size_t max_insert = stream->strstart +
+			    stream->lookahead - MIN_MATCH;
+
+			full = tally_match(stream,
+			    stream->strstart - 1 - stream->prev_match,
+			    stream->prev_length);
+
+			/* Insert the strings covered by the match */
+			stream->lookahead -= stream->prev_length - 1;
+			size_t len = stream->prev_length - 2;
+
+			while (len > 0) {
+				stream->strstart++;
+				if (stream->strstart <= max_insert)
+					insert_string(stream, stream->strstart);
+
+				len--;
+			}
+
+			stream->match_available = false;
+			stream->match_length = MIN_MATCH - 1;
+			stream->strstart++;
+		} else if (stream->match_available) {
+			/* The current match is better, emit a literal */
+			full = tally_literal(stream,
+			    stream->window[stream->strstart - 1]);
+			stream->strstart++;
+			stream->lookahead--;
+		} else {
+			/* Wait for the next step to decide */
+			stream->match_available = true;
+			stream->strstart++;
+			stream->lookahead--;
+		}
+
+		if (full) {
+			emit_block(stream, false);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/** Create deflate stream
+ *
+ * @param level   Compression level (0 for no compression up to
+ *                DEFLATE_LEVEL_MAX for the best compression).
+ * @param rstream Place to store pointer to the new stream.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression level.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t deflate_stream_create(unsigned int level, deflate_stream_t **rstream)
+{
+	if (level > DEFLATE_LEVEL_MAX)
+		return EINVAL;
+
+	deflate_stream_t *stream = malloc(sizeof(deflate_stream_t));
+	if (stream == NULL)
+		return ENOMEM;
+
+	stream->config = config[level];
+	stream->store = (level == 0);
+	stream->done = false;
+	stream->in = NULL;
+	stream->inend = NULL;
+
+	memset(stream->window, 0, sizeof(stream->window));
+	stream->strstart = 0;
+	stream->lookahead = 0;
+	stream->block_start = 0;
+
+	memset(stream->head, 0, sizeof(stream->head));
+	memset(stream->prev, 0, sizeof(stream->prev));
+
+	stream->match_start = 0;
+	stream->match_length = MIN_MATCH - 1;
+	stream->prev_match = 0;
+	stream->prev_length = MIN_MATCH - 1;
+	stream->match_available = false;
+
+	stream->sym_count = 0;
+	memset(stream->len_freq, 0, sizeof(stream->len_freq));
+	memset(stream->dist_freq, 0, sizeof(stream->dist_freq));
+
+	stream->outlen = 0;
+	stream->outpos = 0;
+	stream->bitbuf = 0;
+	stream->bitlen = 0;
+
+	/* Map the match lengths and distances to codes */
+	size_t code;
+	for (code = 0; code < MAX_LEN; code++) {
+		size_t end = (code + 1 < MAX_LEN) ?
+		    lens[code + 1] : lens[code] + 1;
+		for (size_t len = lens[code]; len < end; len++)
+			stream->length_code[len - MIN_MATCH] = code;
+	}
+
+	for (code = 0; code < MAX_DIST; code++) {
+		size_t end = dists[code] + (1 << dists_ext[code]);
+		for (size_t dist = dists[code]; dist < end; dist++) {
+			if (dist <= 256)
+				stream->dist_code[dist - 1] = code;
+			else
+				stream->dist_code[256 + ((dist - 1) >> 7)] =
+				    code;
+		}
+	}
+
+	/* Construct the fixed codes */
+	size_t symbol;
+	for (symbol = 0; symbol < 144; symbol++)
+		stream->fixed_len_code.length[symbol] = 8;
+	for (; symbol < 256; symbol++)
+		stream->fixed_len_code.length[symbol] = 9;
+	for (; symbol < 280; symbol++)
+		stream->fixed_len_code.length[symbol] = 7;
+	for (; symbol < MAX_FIXED_LITLEN; symbol++)
+		stream->fixed_len_code.length[symbol] = 8;
+
+	huffman_codes(&stream->fixed_len_code, MAX_FIXED_LITLEN);
+
+	for (symbol = 0; symbol < MAX_DIST; symbol++)
+		stream->fixed_dist_code.length[symbol] = 5;
+
+	huffman_codes(&stream->fixed_dist_code, MAX_DIST);
+
+	*rstream = stream;
+	return EOK;
+}
+
+/** Destroy deflate stream
+ *
+ * @param stream Deflate stream (can be NULL).
+ *
+ */
+void deflate_stream_destroy(deflate_stream_t *stream)
+{
+	free(stream);
+}
+
+/** Deflate a chunk of data
+ *
+ * Compress as much of the input as possible into the output
+ * buffer. The input which has not been consumed has to be passed
+ * again in the next call. Once all the input has been passed,
+ * the stream is finished by calls with the finish flag set until
+ * EOK is returned.
+ *
+ * @param stream   Deflate stream.
+ * @param src      Source data buffer.
+ * @param srclen   Source buffer size (bytes).
+ * @param srcused  Place to store the number of input bytes consumed.
+ * @param dest     Destination data buffer.
+ * @param destlen  Destination buffer size (bytes).
+ * @param destused Place to store the number of output bytes produced.
+ * @param finish   No more input follows.
+ *
+ * @return EOK if the stream has been finished and all the compressed
+ *         data have been stored.
+ * @return EAGAIN if more input or more output space is needed.
+ *
+ */
+errno_t deflate_stream(deflate_stream_t *stream, const void *src,
+    size_t srclen, size_t *srcused, void *dest, size_t destlen,
+    size_t *destused, bool finish)
+{
+	uint8_t *out = (uint8_t *) dest;
+	uint8_t *outend = out + destlen;
+	errno_t rc;
+
+	stream->in = (const uint8_t *) src;
+	stream->inend = stream->in + srclen;
+
+	while (true) {
+		/* Pass the pending output to the caller */
+		size_t len = min(stream->outlen - stream->outpos,
+		    (size_t) (outend - out));
+
+		memcpy(out, stream->out + stream->outpos, len);
+		out += len;
+		stream->outpos += len;
+
+		if (stream->outpos < stream->outlen) {
+			rc = EAGAIN;
+			break;
+		}
+
+		stream->outlen = 0;
+		stream->outpos = 0;
+
+		if (stream->done) {
+			rc = EOK;
+			break;
+		}
+
+		if (fill_window(stream))
+			continue;
+
+		bool flush = finish && (stream->in == stream->inend);
+		if ((!flush) && (stream->lookahead < MIN_LOOKAHEAD)) {
+			rc = EAGAIN;
+			break;
+		}
+
+		bool emitted;
+		if (stream->store) {
+			/* Take the lookahead as it is */
+			stream->strstart += stream->lookahead;
+			stream->lookahead = 0;
+			emitted = false;
+		} else if (stream->config.greedy) {
+			emitted = deflate_greedy(stream, flush);
+		} else {
+			emitted = deflate_lazy(stream, flush);
+		}
+
+		if ((emitted) || (!flush) || (stream->lookahead > 0))
+			continue;
+
+		/* Finish the stream */
+		if (stream->match_available) {
+			(void) tally_literal(stream,
+			    stream->window[stream->strstart - 1]);
+			stream->match_available = false;
+		}
+
+		emit_block(stream, true);
+		put_align(stream);
+		stream->done = true;
+	}
+
+	*srcused = stream->in - (const uint8_t *) src;
+	*destused = out - (uint8_t *) dest;
+
+	stream->in = NULL;
+	stream->inend = NULL;
+
+	return rc;
+}
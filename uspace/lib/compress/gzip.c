@@ -28,12 +28,16 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include <errno.h>
 #include <mem.h>
+#include <macros.h>
 #include <byteorder.h>
 #include <stdlib.h>
+#include <adt/checksum.h>
 #include "gzip.h"
 #include "inflate.h"
+#include "deflate.h"
 
 #define GZIP_ID1  UINT8_C(0x1f)
 #define GZIP_ID2  UINT8_C(0x8b)
@@ -46,6 +50,11 @@
 #define GZIP_FLAG_FNAME     UINT8_C(1 << 3)
 #define GZIP_FLAG_FCOMMENT  UINT8_C(1 << 4)
 
+#define GZIP_XFL_BEST     UINT8_C(2)
+#define GZIP_XFL_FASTEST  UINT8_C(4)
+
+#define GZIP_OS_UNKNOWN  UINT8_C(0xff)
+
 typedef struct {
 	uint8_t id1;
 	uint8_t id2;
@@ -61,6 +70,464 @@ typedef struct {
 	uint32_t size;
 } __attribute__((packed)) gzip_footer_t;
 
+/** GZIP reader state
+ *
+ */
+typedef enum {
+	GZIP_READ_HEADER,      /**< Fixed header */
+	GZIP_READ_EXTRA_LEN,   /**< Length of the extra field */
+	GZIP_READ_EXTRA,       /**< Extra field */
+	GZIP_READ_NAME,        /**< File name */
+	GZIP_READ_COMMENT,     /**< File comment */
+	GZIP_READ_HCRC,        /**< Header CRC */
+	GZIP_READ_DATA,        /**< Compressed data */
+	GZIP_READ_FOOTER,      /**< Footer */
+	GZIP_READ_DONE         /**< Member verified */
+} gzip_read_state_t;
+
+/** GZIP reader
+ *
+ */
+struct gzip_reader {
+	gzip_read_state_t state;  /**< Reader state */
+	uint8_t flags;            /**< Header flags */
+	size_t skip;              /**< Bytes of the extra field to skip */
+
+	/** Buffer for the fixed-size parts of the member */
+	uint8_t buf[sizeof(gzip_header_t)];
+	size_t buflen;  /**< Number of bytes in the buffer */
+
+	inflate_stream_t *inflate;  /**< Inflate stream */
+	uint32_t crc;               /**< CRC of the decompressed data */
+	uint32_t size;              /**< Size of the decompressed data */
+};
+
+/** GZIP writer state
+ *
+ */
+typedef enum {
+	GZIP_WRITE_HEADER,  /**< Header */
+	GZIP_WRITE_DATA,    /**< Compressed data */
+	GZIP_WRITE_FOOTER,  /**< Footer */
+	GZIP_WRITE_DONE     /**< Member finished */
+} gzip_write_state_t;
+
+/** GZIP writer
+ *
+ */
+struct gzip_writer {
+	gzip_write_state_t state;  /**< Writer state */
+
+	/** Buffer for the header and the footer */
+	uint8_t buf[sizeof(gzip_header_t)];
+	size_t buflen;  /**< Number of bytes in the buffer */
+	size_t bufpos;  /**< Number of bytes already written */
+
+	deflate_stream_t *deflate;  /**< Deflate stream */
+	uint32_t crc;               /**< CRC of the uncompressed data */
+	uint32_t size;              /**< Size of the uncompressed data */
+};
+
+/** Collect a fixed-size part of the member
+ *
+ * @param reader GZIP reader.
+ * @param src    Source data (updated).
+ * @param srclen Source data size (updated).
+ * @param size   Size of the part.
+ *
+ * @return True if the part has been collected completely.
+ *
+ */
+static bool gzip_collect(gzip_reader_t *reader, const uint8_t **src,
+    size_t *srclen, size_t size)
+{
+	size_t len = min(size - reader->buflen, *srclen);
+
+	memcpy(reader->buf + reader->buflen, *src, len);
+	reader->buflen += len;
+	*src += len;
+	*srclen -= len;
+
+	if (reader->buflen < size)
+		return false;
+
+	reader->buflen = 0;
+	return true;
+}
+
+/** Skip a zero-terminated string
+ *
+ * @param src    Source data (updated).
+ * @param srclen Source data size (updated).
+ *
+ * @return True if the terminating zero has been skipped.
+ *
+ */
+static bool gzip_skip_string(const uint8_t **src, size_t *srclen)
+{
+	while (*srclen > 0) {
+		uint8_t byte = **src;
+
+		(*src)++;
+		(*srclen)--;
+
+		if (byte == 0)
+			return true;
+	}
+
+	return false;
+}
+
+/** Create GZIP reader
+ *
+ * @param rreader Place to store pointer to the new reader.
+ *
+ * @return EOK on success.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t gzip_reader_create(gzip_reader_t **rreader)
+{
+	gzip_reader_t *reader = malloc(sizeof(gzip_reader_t));
+	if (reader == NULL)
+		return ENOMEM;
+
+	errno_t rc = inflate_stream_create(&reader->inflate);
+	if (rc != EOK) {
+		free(reader);
+		return rc;
+	}
+
+	reader->state = GZIP_READ_HEADER;
+	reader->flags = 0;
+	reader->skip = 0;
+	reader->buflen = 0;
+	reader->crc = 0;
+	reader->size = 0;
+
+	*rreader = reader;
+	return EOK;
+}
+
+/** Destroy GZIP reader
+ *
+ * @param reader GZIP reader (can be NULL).
+ *
+ */
+void gzip_reader_destroy(gzip_reader_t *reader)
+{
+	if (reader == NULL)
+		return;
+
+	inflate_stream_destroy(reader->inflate);
+	free(reader);
+}
+
+/** Read a chunk of GZIP compressed data
+ *
+ * Parse the header, decompress as much of the input as possible
+ * into the output buffer and verify the CRC and the size of the
+ * decompressed data. The input which has not been consumed has to be
+ * passed again in the next call. Only a single member is decoded,
+ * the input following the member is left unused.
+ *
+ * @param reader   GZIP reader.
+ * @param src      Source data buffer.
+ * @param srclen   Source buffer size (bytes).
+ * @param srcused  Place to store the number of input bytes consumed.
+ * @param dest     Destination data buffer.
+ * @param destlen  Destination buffer size (bytes).
+ * @param destused Place to store the number of output bytes produced.
+ *
+ * @return EOK if the whole member has been decompressed and verified.
+ * @return EAGAIN if more input or more output space is needed.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code, invalid deflate data,
+ *                   invalid compression method, invalid stream
+ *                   or checksum mismatch.
+ *
+ */
+errno_t gzip_read(gzip_reader_t *reader, const void *src, size_t srclen,
+    size_t *srcused, void *dest, size_t destlen, size_t *destused)
+{
+	const uint8_t *in = (const uint8_t *) src;
+	size_t inlen = srclen;
+	size_t outlen = 0;
+	errno_t rc = EAGAIN;
+
+	while (rc == EAGAIN) {
+		gzip_header_t header;
+		gzip_footer_t footer;
+		uint16_t extra_length;
+		uint8_t *out;
+		size_t used;
+		size_t produced;
+
+		switch (reader->state) {
+		case GZIP_READ_HEADER:
+			if (!gzip_collect(reader, &in, &inlen, sizeof(header)))
+				goto out;
+
+			memcpy(&header, reader->buf, sizeof(header));
+
+			if ((header.id1 != GZIP_ID1) ||
+			    (header.id2 != GZIP_ID2) ||
+			    (header.method != GZIP_METHOD_DEFLATE) ||
+			    ((header.flags & (~GZIP_FLAGS_MASK)) != 0)) {
+				rc = EINVAL;
+				break;
+			}
+
+			reader->flags = header.flags;
+			reader->state = GZIP_READ_EXTRA_LEN;
+			break;
+		case GZIP_READ_EXTRA_LEN:
+			/* Ignore extra metadata */
+			if ((reader->flags & GZIP_FLAG_FEXTRA) == 0) {
+				reader->state = GZIP_READ_NAME;
+				break;
+			}
+
+			if (!gzip_collect(reader, &in, &inlen,
+			    sizeof(extra_length)))
+				goto out;
+
+			memcpy(&extra_length, reader->buf,
+			    sizeof(extra_length));
+			reader->skip = uint16_t_le2host(extra_length);
+			reader->state = GZIP_READ_EXTRA;
+			break;
+		case GZIP_READ_EXTRA:
+			used = min(reader->skip, inlen);
+			in += used;
+			inlen -= used;
+			reader->skip -= used;
+
+			if (reader->skip > 0)
+				goto out;
+
+			reader->state = GZIP_READ_NAME;
+			break;
+		case GZIP_READ_NAME:
+			if (((reader->flags & GZIP_FLAG_FNAME) != 0) &&
+			    (!gzip_skip_string(&in, &inlen)))
+				goto out;
+
+			reader->state = GZIP_READ_COMMENT;
+			break;
+		case GZIP_READ_COMMENT:
+			if (((reader->flags & GZIP_FLAG_FCOMMENT) != 0) &&
+			    (!gzip_skip_string(&in, &inlen)))
+				goto out;
+
+			reader->state = GZIP_READ_HCRC;
+			break;
+		case GZIP_READ_HCRC:
+			if (((reader->flags & GZIP_FLAG_FHCRC) != 0) &&
+			    (!gzip_collect(reader, &in, &inlen, 2)))
+				goto out;
+
+			reader->state = GZIP_READ_DATA;
+			break;
+		case GZIP_READ_DATA:
+			out = (uint8_t *) dest + outlen;
+			rc = inflate_stream(reader->inflate, in, inlen, &used,
+			    out, destlen - outlen, &produced);
+
+			reader->crc = compute_crc32_seed(out, produced,
+			    reader->crc);
+			reader->size += produced;
+
+			in += used;
+			inlen -= used;
+			outlen += produced;
+
+			if (rc == EOK) {
+				reader->state = GZIP_READ_FOOTER;
+				rc = EAGAIN;
+			} else if (rc == EAGAIN) {
+				goto out;
+			}
+			break;
+		case GZIP_READ_FOOTER:
+			if (!gzip_collect(reader, &in, &inlen, sizeof(footer)))
+				goto out;
+
+			memcpy(&footer, reader->buf, sizeof(footer));
+
+			if ((uint32_t_le2host(footer.crc32) != reader->crc) ||
+			    (uint32_t_le2host(footer.size) != reader->size)) {
+				rc = EINVAL;
+				break;
+			}
+
+			reader->state = GZIP_READ_DONE;
+			break;
+		case GZIP_READ_DONE:
+			rc = EOK;
+			break;
+		}
+	}
+
+out:
+	*srcused = in - (const uint8_t *) src;
+	*destused = outlen;
+	return rc;
+}
+
+/** Create GZIP writer
+ *
+ * @param level   Compression level (see deflate_stream_create()).
+ * @param rwriter Place to store pointer to the new writer.
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression level.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t gzip_writer_create(unsigned int level, gzip_writer_t **rwriter)
+{
+	gzip_writer_t *writer = malloc(sizeof(gzip_writer_t));
+	if (writer == NULL)
+		return ENOMEM;
+
+	errno_t rc = deflate_stream_create(level, &writer->deflate);
+	if (rc != EOK) {
+		free(writer);
+		return rc;
+	}
+
+	gzip_header_t header;
+
+	header.id1 = GZIP_ID1;
+	header.id2 = GZIP_ID2;
+	header.method = GZIP_METHOD_DEFLATE;
+	header.flags = 0;
+	header.mtime = 0;
+	header.os = GZIP_OS_UNKNOWN;
+
+	if (level == DEFLATE_LEVEL_MAX)
+		header.extra_flags = GZIP_XFL_BEST;
+	else if (level == DEFLATE_LEVEL_FAST)
+		header.extra_flags = GZIP_XFL_FASTEST;
+	else
+		header.extra_flags = 0;
+
+	memcpy(writer->buf, &header, sizeof(header));
+	writer->buflen = sizeof(header);
+	writer->bufpos = 0;
+
+	writer->state = GZIP_WRITE_HEADER;
+	writer->crc = 0;
+	writer->size = 0;
+
+	*rwriter = writer;
+	return EOK;
+}
+
+/** Destroy GZIP writer
+ *
+ * @param writer GZIP writer (can be NULL).
+ *
+ */
+void gzip_writer_destroy(gzip_writer_t *writer)
+{
+	if (writer == NULL)
+		return;
+
+	deflate_stream_destroy(writer->deflate);
+	free(writer);
+}
+
+/** Write a chunk of data into GZIP compressed stream
+ *
+ * Compress as much of the input as possible into the output
+ * buffer. The input which has not been consumed has to be passed
+ * again in the next call. Once all the input has been passed,
+ * the member is finished by calls with the finish flag set until
+ * EOK is returned.
+ *
+ * @param writer   GZIP writer.
+ * @param src      Source data buffer.
+ * @param srclen   Source buffer size (bytes).
+ * @param srcused  Place to store the number of input bytes consumed.
+ * @param dest     Destination data buffer.
+ * @param destlen  Destination buffer size (bytes).
+ * @param destused Place to store the number of output bytes produced.
+ * @param finish   No more input follows.
+ *
+ * @return EOK if the member has been finished and all the compressed
+ *         data have been stored.
+ * @return EAGAIN if more input or more output space is needed.
+ *
+ */
+errno_t gzip_write(gzip_writer_t *writer, const void *src, size_t srclen,
+    size_t *srcused, void *dest, size_t destlen, size_t *destused,
+    bool finish)
+{
+	uint8_t *out = (uint8_t *) dest;
+	size_t outlen = destlen;
+	size_t inused = 0;
+	errno_t rc = EAGAIN;
+
+	while (rc == EAGAIN) {
+		gzip_footer_t footer;
+		size_t used;
+		size_t produced;
+
+		switch (writer->state) {
+		case GZIP_WRITE_HEADER:
+		case GZIP_WRITE_FOOTER:
+			produced = min(writer->buflen - writer->bufpos, outlen);
+			memcpy(out, writer->buf + writer->bufpos, produced);
+			writer->bufpos += produced;
+			out += produced;
+			outlen -= produced;
+
+			if (writer->bufpos < writer->buflen)
+				goto out;
+
+			writer->state = (writer->state == GZIP_WRITE_HEADER) ?
+			    GZIP_WRITE_DATA : GZIP_WRITE_DONE;
+			break;
+		case GZIP_WRITE_DATA:
+			rc = deflate_stream(writer->deflate, src, srclen, &used,
+			    out, outlen, &produced, finish);
+
+			writer->crc = compute_crc32_seed((uint8_t *) src, used,
+			    writer->crc);
+			writer->size += used;
+
+			inused = used;
+			out += produced;
+			outlen -= produced;
+
+			if (rc == EOK) {
+				footer.crc32 = host2uint32_t_le(writer->crc);
+				footer.size = host2uint32_t_le(writer->size);
+
+				memcpy(writer->buf, &footer, sizeof(footer));
+				writer->buflen = sizeof(footer);
+				writer->bufpos = 0;
+
+				writer->state = GZIP_WRITE_FOOTER;
+				rc = EAGAIN;
+			} else {
+				goto out;
+			}
+			break;
+		case GZIP_WRITE_DONE:
+			rc = EOK;
+			break;
+		}
+	}
+
+out:
+	*srcused = inused;
+	*destused = destlen - outlen;
+	return rc;
+}
+
 /** Expand GZIP compressed data
  *
  * The routine allocates the output buffer based
@@ -69,7 +536,7 @@ typedef struct {
  * data to 4 GiB (expanding input streams that actually
  * encode more data will always fail).
  *
- * So far, no CRC is perfomed.
+ * The CRC and the size of the uncompressed data are verified.
  *
  * @param[in]  src     Source data buffer.
  * @param[in]  srclen  Source buffer size (bytes).
@@ -79,7 +546,8 @@ typedef struct {
  * @return EOK on success.
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code, invalid deflate data,
- *                   invalid compression method or invalid stream.
+ *                   invalid compression method, invalid stream
+ *                   or checksum mismatch.
  * @return ELIMIT on input buffer overrun.
  * @return ENOMEM on output buffer overrun.
  *
@@ -105,79 +573,85 @@ errno_t gzip_expand(void *src, size_t srclen, void **dest, size_t *destlen)
 
 	*destlen = uint32_t_le2host(footer.size);
 
-	/* Ignore extra metadata */
-
-	void *stream = src + sizeof(header);
-	size_t stream_length = srclen - sizeof(header) - sizeof(footer);
-
-	if ((header.flags & GZIP_FLAG_FEXTRA) != 0) {
-		uint16_t extra_length;
-
-		if (stream_length < sizeof(extra_length))
-			return EINVAL;
-
-		memcpy(&extra_length, stream, sizeof(extra_length));
-		stream += sizeof(extra_length);
-		stream_length -= sizeof(extra_length);
+	gzip_reader_t *reader;
+	errno_t ret = gzip_reader_create(&reader);
+	if (ret != EOK)
+		return ret;
 
-		if (stream_length < extra_length)
-			return EINVAL;
+	/* Allocate output buffer and inflate the data */
 
-		stream += extra_length;
-		stream_length -= extra_length;
+	*dest = malloc(*destlen);
+	if (*dest == NULL) {
+		gzip_reader_destroy(reader);
+		return ENOMEM;
 	}
 
-	if ((header.flags & GZIP_FLAG_FNAME) != 0) {
-		while (*((uint8_t *) stream) != 0) {
-			if (stream_length == 0)
-				return EINVAL;
-
-			stream++;
-			stream_length--;
-		}
-
-		if (stream_length == 0)
-			return EINVAL;
-
-		stream++;
-		stream_length--;
+	size_t srcused;
+	size_t destused;
+	ret = gzip_read(reader, src, srclen, &srcused, *dest, *destlen,
+	    &destused);
+	if (ret == EAGAIN) {
+		/* Either the output is full or the input is truncated */
+		ret = (destused == *destlen) ? ENOMEM : ELIMIT;
 	}
 
-	if ((header.flags & GZIP_FLAG_FCOMMENT) != 0) {
-		while (*((uint8_t *) stream) != 0) {
-			if (stream_length == 0)
-				return EINVAL;
+	gzip_reader_destroy(reader);
 
-			stream++;
-			stream_length--;
-		}
-
-		if (stream_length == 0)
-			return EINVAL;
-
-		stream++;
-		stream_length--;
+	if (ret != EOK) {
+		free(*dest);
+		*dest = NULL;
+		return ret;
 	}
 
-	if ((header.flags & GZIP_FLAG_FHCRC) != 0) {
-		if (stream_length < 2)
-			return EINVAL;
+	return EOK;
+}
 
-		stream += 2;
-		stream_length -= 2;
+/** Compress data into GZIP format
+ *
+ * @param[in]  src     Source data buffer.
+ * @param[in]  srclen  Source buffer size (bytes).
+ * @param[in]  level   Compression level (see deflate_stream_create()).
+ * @param[out] dest    Destination data buffer (allocated).
+ * @param[out] destlen Destination data size (bytes).
+ *
+ * @return EOK on success.
+ * @return EINVAL on invalid compression level.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t gzip_compress(void *src, size_t srclen, unsigned int level,
+    void **dest, size_t *destlen)
+{
+	gzip_writer_t *writer;
+	errno_t ret = gzip_writer_create(level, &writer);
+	if (ret != EOK)
+		return ret;
+
+	/*
+	 * Stored blocks are the worst case. Each block adds a few bytes
+	 * of framing and there are at most a few blocks per 32 KiB of
+	 * input. The rest is the header and the footer.
+	 */
+	size_t size = srclen + srclen / 512 + 128;
+	uint8_t *buf = malloc(size);
+	if (buf == NULL) {
+		gzip_writer_destroy(writer);
+		return ENOMEM;
 	}
 
-	/* Allocate output buffer and inflate the data */
+	size_t srcused;
+	size_t destused;
+	ret = gzip_write(writer, src, srclen, &srcused, buf, size,
+	    &destused, true);
 
-	*dest = malloc(*destlen);
-	if (*dest == NULL)
-		return ENOMEM;
+	gzip_writer_destroy(writer);
 
-	errno_t ret = inflate(stream, stream_length, *dest, *destlen);
 	if (ret != EOK) {
-		free(dest);
-		return ret;
+		free(buf);
+		return (ret == EAGAIN) ? ENOMEM : ret;
 	}
 
+	*dest = buf;
+	*destlen = destused;
 	return EOK;
 }
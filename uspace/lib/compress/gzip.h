@@ -29,8 +29,27 @@
 #ifndef LIBCOMPRESS_GZIP_H_
 #define LIBCOMPRESS_GZIP_H_
 
+#include <errno.h>
+#include <stdbool.h>
 #include <stddef.h>
 
+/** GZIP reader (opaque) */
+typedef struct gzip_reader gzip_reader_t;
+
+/** GZIP writer (opaque) */
+typedef struct gzip_writer gzip_writer_t;
+
 extern errno_t gzip_expand(void *, size_t, void **, size_t *);
+extern errno_t gzip_compress(void *, size_t, unsigned int, void **, size_t *);
+
+extern errno_t gzip_reader_create(gzip_reader_t **);
+extern void gzip_reader_destroy(gzip_reader_t *);
+extern errno_t gzip_read(gzip_reader_t *, const void *, size_t, size_t *,
+    void *, size_t, size_t *);
+
+extern errno_t gzip_writer_create(unsigned int, gzip_writer_t **);
+extern void gzip_writer_destroy(gzip_writer_t *);
+extern errno_t gzip_write(gzip_writer_t *, const void *, size_t, size_t *,
+    void *, size_t, size_t *, bool);
 
 #endif
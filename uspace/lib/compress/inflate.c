@@ -30,12 +30,20 @@
 /** @file
  * @brief Implementation of inflate decompression
  *
- * A simple inflate implementation (decompression of `deflate' stream as
- * described by RFC 1951) based on puff.c by Mark Adler. This code is
- * currently not optimized for speed but for readability.
+ * An inflate implementation (decompression of `deflate' stream as
+ * described by RFC 1951) originally based on puff.c by Mark Adler.
  *
- * All dynamically allocated memory memory is taken from the stack. The
- * stack usage should be typically bounded by 2 KB.
+ * The decoder is a resumable state machine, so that both the compressed
+ * input and the decompressed output can be processed in chunks of
+ * arbitrary size. The decoded data pass through a 32 KiB circular window
+ * which serves as the dictionary for back-references, thus the memory
+ * footprint is bounded regardless of the size of the stream.
+ *
+ * The Huffman codes are decoded using a lookup table indexed by the next
+ * FAST_BITS bits of the input. Only the codes which are longer than that
+ * fall back to the canonical bit-by-bit decoding. The bulk of the
+ * literal/length and distance codes is decoded by a tight loop which
+ * refills the 64-bit bit buffer only once per symbol pair.
  *
  * Original copyright notice:
  *
@@ -66,8 +74,10 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdlib.h>
 #include <errno.h>
 #include <mem.h>
+#include <macros.h>
 #include "inflate.h"
 
 /** Maximum bits in the Huffman code */
@@ -87,40 +97,100 @@
 /** Number of all codes */
 #define MAX_CODE  (MAX_LITLEN + MAX_DIST)
 
-/** Check for input buffer overrun condition */
-#define CHECK_OVERRUN(state) \
-	do { \
-		if ((state).overrun) \
-			return ELIMIT; \
-	} while (false)
+/** Maximum length of a match */
+#define MAX_MATCH  258
 
+/** Size of the sliding window (maximum distance) */
+#define WSIZE  32768
+#define WMASK  (WSIZE - 1)
 
-/** Inflate algorithm state
- *
- */
-typedef struct {
-	uint8_t *dest;    /**< Output buffer */
-	size_t destlen;   /**< Output buffer size */
-	size_t destcnt;   /**< Position in the output buffer */
+/** Number of bits resolved by the Huffman lookup table */
+#define FAST_BITS  10
+#define FAST_SIZE  (1 << FAST_BITS)
+#define FAST_MASK  (FAST_SIZE - 1)
 
-	uint8_t *src;     /**< Input buffer */
-	size_t srclen;    /**< Input buffer size */
-	size_t srccnt;    /**< Position in the input buffer */
+/** Lookup table entry layout (code length, symbol) */
+#define FAST_SHIFT        9
+#define FAST_SYMBOL_MASK  ((1 << FAST_SHIFT) - 1)
 
-	uint16_t bitbuf;  /**< Bit buffer */
-	size_t bitlen;    /**< Number of bits in the bit buffer */
+/** Minimal input available to the fast decoding loop
+ *
+ * The fast loop refills the bit buffer up to 57 bits at once,
+ * which takes at most 8 bytes of input.
+ *
+ */
+#define FAST_MIN_INPUT  8
 
-	bool overrun;     /**< Overrun condition */
-} inflate_state_t;
+/** Decoder state
+ *
+ */
+typedef enum {
+	INFLATE_HEADER,         /**< Block header */
+	INFLATE_STORED_LEN,     /**< Stored block length */
+	INFLATE_STORED_COPY,    /**< Stored block data */
+	INFLATE_TABLE_SIZES,    /**< Dynamic block table sizes */
+	INFLATE_TABLE_ORDER,    /**< Code length code lengths */
+	INFLATE_TABLE_LENGTHS,  /**< Literal/length and distance code lengths */
+	INFLATE_TABLE_REPEAT,   /**< Repeated code length */
+	INFLATE_CODES,          /**< Literal/length symbol */
+	INFLATE_LEN_EXTRA,      /**< Length extra bits */
+	INFLATE_DIST,           /**< Distance symbol */
+	INFLATE_DIST_EXTRA,     /**< Distance extra bits */
+	INFLATE_COPY,           /**< Copying a match */
+	INFLATE_DONE            /**< End of the last block */
+} inflate_mode_t;
 
 /** Huffman code description
  *
  */
 typedef struct {
-	uint16_t *count;   /**< Array of symbol counts */
-	uint16_t *symbol;  /**< Array of symbols */
+	/** Lookup table for codes up to FAST_BITS long (zero if longer) */
+	uint16_t fast[FAST_SIZE];
+	uint16_t count[MAX_HUFFMAN_BIT + 1];  /**< Array of symbol counts */
+	uint16_t symbol[MAX_FIXED_LITLEN];    /**< Array of symbols */
 } huffman_t;
 
+/** Inflate stream state
+ *
+ */
+struct inflate_stream {
+	inflate_mode_t mode;  /**< Decoder state */
+	bool last;            /**< Current block is the last one */
+
+	const uint8_t *in;     /**< Current input position */
+	const uint8_t *inend;  /**< End of the input buffer */
+
+	uint64_t bitbuf;  /**< Bit buffer */
+	size_t bitlen;    /**< Number of bits in the bit buffer */
+
+	uint8_t window[WSIZE];  /**< Sliding window */
+	size_t wpos;            /**< Next write position in the window */
+	size_t whave;           /**< Number of valid bytes in the window */
+	size_t pending;         /**< Bytes in the window not yet flushed */
+	bool window_full;       /**< Decoding stalled on window space */
+
+	size_t stored_left;  /**< Bytes left in the stored block */
+
+	uint16_t nlen;   /**< Number of literal/length code lengths */
+	uint16_t ndist;  /**< Number of distance code lengths */
+	uint16_t ncode;  /**< Number of code length code lengths */
+	uint16_t index;  /**< Index of the next code length */
+	uint16_t length[MAX_CODE];  /**< Code lengths */
+
+	uint16_t symbol;    /**< Symbol awaiting extra bits */
+	size_t copy_len;    /**< Length of the current match */
+	size_t copy_dist;   /**< Distance of the current match */
+
+	const huffman_t *len_code;   /**< Current literal/length code */
+	const huffman_t *dist_code;  /**< Current distance code */
+
+	huffman_t fixed_len_code;   /**< Fixed literal/length code */
+	huffman_t fixed_dist_code;  /**< Fixed distance code */
+	huffman_t dyn_len_code;     /**< Dynamic literal/length code */
+	huffman_t dyn_dist_code;    /**< Dynamic distance code */
+	huffman_t dyn_code_code;    /**< Dynamic code length code */
+};
+
 /** Length codes
  *
  */
@@ -162,162 +232,82 @@ static const short order[MAX_ORDER] = {
 	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
 };
 
-/** Static length symbol counts
- *
- */
-static uint16_t len_count[MAX_HUFFMAN_BIT + 1] = {
-	0, 0, 0, 0, 0, 0, 0, 24, 152, 112, 0, 0, 0, 0, 0, 0
-};
-
-/** Static length symbols
- *
- */
-static uint16_t len_symbol[MAX_FIXED_LITLEN] = {
-	256, 257, 258, 259, 260, 261, 262, 263, 264, 265, 266, 267, 268,
-	269, 270, 271, 272, 273, 274, 275, 276, 277, 278, 279, 0, 1, 2,
-	3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20,
-	21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36,
-	37, 38, 39, 40, 41, 42, 43, 44, 45, 46, 47, 48, 49, 50, 51, 52,
-	53, 54, 55, 56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67, 68,
-	69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79, 80, 81, 82, 83, 84,
-	85, 86, 87, 88, 89, 90, 91, 92, 93, 94, 95, 96, 97, 98, 99, 100,
-	101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111, 112, 113,
-	114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126,
-	127, 128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139,
-	140, 141, 142, 143, 280, 281, 282, 283, 284, 285, 286, 287, 144,
-	145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157,
-	158, 159, 160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170,
-	171, 172, 173, 174, 175, 176, 177, 178, 179, 180, 181, 182, 183,
-	184, 185, 186, 187, 188, 189, 190, 191, 192, 193, 194, 195, 196,
-	197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207, 208, 209,
-	210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222,
-	223, 224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235,
-	236, 237, 238, 239, 240, 241, 242, 243, 244, 245, 246, 247, 248,
-	249, 250, 251, 252, 253, 254, 255
-};
-
-/** Static distance symbol counts
- *
- */
-static uint16_t dist_count[MAX_HUFFMAN_BIT + 1] = {
-	0, 0, 0, 0, 0, 30, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-};
-
-/** Static distance symbols
- *
- */
-static uint16_t dist_symbol[MAX_DIST] = {
-	0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
-	16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29
-};
-
-/** Huffman code for lengths
+/** Make sure there are at least cnt bits in the bit buffer
  *
- */
-static huffman_t len_code = {
-	.count = len_count,
-	.symbol = len_symbol
-};
-
-/** Huffman code for distances
- *
- */
-static huffman_t dist_code = {
-	.count = dist_count,
-	.symbol = dist_symbol
-};
-
-/** Get bits from the bit buffer
+ * The input is consumed byte by byte, so that the bit buffer
+ * never holds more than 7 bits beyond the requested count.
  *
- * @param state Inflate state.
- * @param cnt   Number of bits to return (at most 16).
+ * @param stream Inflate stream.
+ * @param cnt    Number of bits requested (at most 57).
  *
- * @return Returned bits.
+ * @return True if the bits are available.
+ * @return False if the input has been exhausted.
  *
  */
-static inline uint16_t get_bits(inflate_state_t *state, size_t cnt)
+static inline bool need_bits(inflate_stream_t *stream, size_t cnt)
 {
-	/* Bit accumulator for at least 20 bits */
-	uint32_t val = state->bitbuf;
-
-	while (state->bitlen < cnt) {
-		if (state->srccnt == state->srclen) {
-			state->overrun = true;
-			return 0;
-		}
+	while (stream->bitlen < cnt) {
+		if (stream->in == stream->inend)
+			return false;
 
-		/* Load 8 more bits */
-		val |= ((uint32_t) state->src[state->srccnt]) << state->bitlen;
-		state->srccnt++;
-		state->bitlen += 8;
+		stream->bitbuf |= ((uint64_t) *stream->in) << stream->bitlen;
+		stream->in++;
+		stream->bitlen += 8;
 	}
 
-	/* Update bits in the buffer */
-	state->bitbuf = (uint16_t) (val >> cnt);
-	state->bitlen -= cnt;
-
-	return ((uint16_t) (val & ((1 << cnt) - 1)));
+	return true;
 }
 
-/** Decode `stored' block
+/** Get bits from the bit buffer
  *
- * @param state Inflate state.
+ * The caller is responsible for making the bits available.
  *
- * @return EOK on success.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
- * @return EINVAL on invalid data.
+ * @param stream Inflate stream.
+ * @param cnt    Number of bits to return (at most 32).
+ *
+ * @return Returned bits.
  *
  */
-static errno_t inflate_stored(inflate_state_t *state)
+static inline uint32_t get_bits(inflate_stream_t *stream, size_t cnt)
 {
-	/* Discard bits in the bit buffer */
-	state->bitbuf = 0;
-	state->bitlen = 0;
-
-	if (state->srccnt + 4 > state->srclen)
-		return ELIMIT;
-
-	uint16_t len =
-	    state->src[state->srccnt] | (state->src[state->srccnt + 1] << 8);
-	uint16_t len_compl =
-	    state->src[state->srccnt + 2] | (state->src[state->srccnt + 3] << 8);
-
-	/* Check block length and its complement */
-	if (((int16_t) len) != ~((int16_t) len_compl))
-		return EINVAL;
-
-	state->srccnt += 4;
-
-	/* Check input buffer size */
-	if (state->srccnt + len > state->srclen)
-		return ELIMIT;
-
-	/* Check output buffer size */
-	if (state->destcnt + len > state->destlen)
-		return ENOMEM;
+	uint32_t val = (uint32_t) (stream->bitbuf & ((UINT64_C(1) << cnt) - 1));
 
-	/* Copy data */
-	memcpy(state->dest + state->destcnt, state->src + state->srccnt, len);
-	state->srccnt += len;
-	state->destcnt += len;
+	stream->bitbuf >>= cnt;
+	stream->bitlen -= cnt;
 
-	return EOK;
+	return val;
 }
 
 /** Decode a symbol using the Huffman code
  *
- * @param state   Inflate state.
+ * The symbol is decoded from the bits already present in the bit
+ * buffer. Codes of up to FAST_BITS bits are resolved by a single table
+ * lookup, longer codes are decoded canonically bit by bit.
+ *
+ * @param stream  Inflate stream.
  * @param huffman Huffman code.
  * @param symbol  Decoded symbol.
  *
- * @param EOK on success.
- * @param EINVAL on invalid Huffman code.
+ * @return EOK on success.
+ * @return EAGAIN if more bits are needed to decode the symbol.
+ * @return EINVAL on invalid Huffman code.
  *
  */
-static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
-    uint16_t *symbol)
+static inline errno_t huffman_decode(inflate_stream_t *stream,
+    const huffman_t *huffman, uint16_t *symbol)
 {
+	uint16_t entry = huffman->fast[stream->bitbuf & FAST_MASK];
+	if (entry != 0) {
+		size_t len = entry >> FAST_SHIFT;
+		if (len > stream->bitlen)
+			return EAGAIN;
+
+		stream->bitbuf >>= len;
+		stream->bitlen -= len;
+		*symbol = entry & FAST_SYMBOL_MASK;
+		return EOK;
+	}
+
 	/* Decode bits */
 	uint16_t code = 0;
 
@@ -334,13 +324,17 @@ static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
 	size_t len;
 
 	for (len = 1; len <= MAX_HUFFMAN_BIT; len++) {
+		if (len > stream->bitlen)
+			return EAGAIN;
+
 		/* Get next bit */
-		code |= get_bits(state, 1);
-		CHECK_OVERRUN(*state);
+		code |= (stream->bitbuf >> (len - 1)) & 1;
 
 		uint16_t count = huffman->count[len];
 		if (code < first + count) {
 			/* Return decoded symbol */
+			stream->bitbuf >>= len;
+			stream->bitlen -= len;
 			*symbol = huffman->symbol[index + code - first];
 			return EOK;
 		}
@@ -355,6 +349,30 @@ static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
 	return EINVAL;
 }
 
+/** Decode a symbol, consuming more input as needed
+ *
+ * @param stream  Inflate stream.
+ * @param huffman Huffman code.
+ * @param symbol  Decoded symbol.
+ *
+ * @return EOK on success.
+ * @return EAGAIN if the input has been exhausted.
+ * @return EINVAL on invalid Huffman code.
+ *
+ */
+static errno_t huffman_decode_input(inflate_stream_t *stream,
+    const huffman_t *huffman, uint16_t *symbol)
+{
+	while (true) {
+		errno_t rc = huffman_decode(stream, huffman, symbol);
+		if (rc != EAGAIN)
+			return rc;
+
+		if (!need_bits(stream, stream->bitlen + 1))
+			return EAGAIN;
+	}
+}
+
 /** Construct Huffman tables from canonical Huffman code
  *
  * @param huffman Constructed Huffman tables.
@@ -366,13 +384,16 @@ static errno_t huffman_decode(inflate_state_t *state, huffman_t *huffman,
  * @return Positive value for an incomplete code set.
  *
  */
-static int16_t huffman_construct(huffman_t *huffman, uint16_t *length, size_t n)
+static int16_t huffman_construct(huffman_t *huffman, const uint16_t *length,
+    size_t n)
 {
 	/* Count number of codes for each length */
 	size_t len;
 	for (len = 0; len <= MAX_HUFFMAN_BIT; len++)
 		huffman->count[len] = 0;
 
+	memset(huffman->fast, 0, sizeof(huffman->fast));
+
 	/* We assume that the lengths are within bounds */
 	size_t symbol;
 	for (symbol = 0; symbol < n; symbol++)
@@ -408,268 +429,680 @@ static int16_t huffman_construct(huffman_t *huffman, uint16_t *length, size_t n)
 		}
 	}
 
+	/*
+	 * Fill the lookup table. The canonical codes are assigned
+	 * in the order of the symbol table. Since the codes are stored
+	 * in the stream starting with the most significant bit, each code
+	 * is bit-reversed and replicated for all the possible values of
+	 * the trailing bits.
+	 */
+	uint16_t code = 0;
+	size_t index = 0;
+
+	for (len = 1; len <= FAST_BITS; len++) {
+		for (size_t i = 0; i < huffman->count[len]; i++) {
+			uint16_t rev = 0;
+			for (size_t bit = 0; bit < len; bit++) {
+				if ((code & (1 << bit)) != 0)
+					rev |= 1 << (len - 1 - bit);
+			}
+
+			uint16_t entry = (len << FAST_SHIFT) |
+			    huffman->symbol[index];
+
+			for (size_t j = rev; j < FAST_SIZE; j += 1 << len)
+				huffman->fast[j] = entry;
+
+			code++;
+			index++;
+		}
+
+		code <<= 1;
+	}
+
 	return left;
 }
 
-/** Decode literal/length and distance codes
+/** Write a literal into the window
  *
- * Decode until end-of-block code.
+ * @param stream Inflate stream.
+ * @param byte   Literal.
  *
- * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
+ */
+static inline void window_put(inflate_stream_t *stream, uint8_t byte)
+{
+	stream->window[stream->wpos] = byte;
+	stream->wpos = (stream->wpos + 1) & WMASK;
+	stream->pending++;
+
+	if (stream->whave < WSIZE)
+		stream->whave++;
+}
+
+/** Copy a match within the window
  *
- * @return EOK on success.
- * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @param stream Inflate stream.
+ * @param dist   Distance of the match (at most whave).
+ * @param len    Length of the match (at most WSIZE - pending).
  *
  */
-static errno_t inflate_codes(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static inline void window_copy(inflate_stream_t *stream, size_t dist,
+    size_t len)
 {
-	uint16_t symbol;
+	size_t from = (stream->wpos - dist) & WMASK;
+	uint8_t *window = stream->window;
 
-	do {
-		errno_t err = huffman_decode(state, len_code, &symbol);
-		if (err != EOK) {
-			/* Error decoding */
-			return err;
+	/*
+	 * The source range lies behind the destination range if it wraps
+	 * around the end of the window, hence the second distance check.
+	 */
+	if ((dist >= len) && (dist <= WSIZE - len) &&
+	    (from + len <= WSIZE) && (stream->wpos + len <= WSIZE)) {
+		/* Non-overlapping and not wrapping around */
+		memcpy(window + stream->wpos, window + from, len);
+	} else if ((dist == 1) && (stream->wpos + len <= WSIZE)) {
+		/* Run of a single byte */
+		memset(window + stream->wpos, window[from], len);
+	} else {
+		size_t to = stream->wpos;
+		for (size_t i = 0; i < len; i++) {
+			window[to] = window[from];
+			to = (to + 1) & WMASK;
+			from = (from + 1) & WMASK;
 		}
+	}
 
-		if (symbol < 256) {
-			/* Write out literal */
-			if (state->destcnt == state->destlen)
-				return ENOMEM;
-
-			state->dest[state->destcnt] = (uint8_t) symbol;
-			state->destcnt++;
-		} else if (symbol > 256) {
-			/* Compute length */
-			symbol -= 257;
-			if (symbol >= 29)
-				return EINVAL;
+	stream->wpos = (stream->wpos + len) & WMASK;
+	stream->pending += len;
 
-			size_t len = lens[symbol] + get_bits(state, lens_ext[symbol]);
-			CHECK_OVERRUN(*state);
+	stream->whave += len;
+	if (stream->whave > WSIZE)
+		stream->whave = WSIZE;
+}
 
-			/* Get distance */
-			err = huffman_decode(state, dist_code, &symbol);
-			if (err != EOK)
-				return err;
+/** Copy stored data from the input into the window
+ *
+ * @param stream Inflate stream.
+ * @param len    Number of bytes (at most WSIZE - pending).
+ *
+ */
+static void window_write(inflate_stream_t *stream, size_t len)
+{
+	while (len > 0) {
+		size_t chunk = min(len, WSIZE - stream->wpos);
 
-			size_t dist = dists[symbol] + get_bits(state, dists_ext[symbol]);
-			if (dist > state->destcnt)
-				return ENOENT;
+		memcpy(stream->window + stream->wpos, stream->in, chunk);
+		stream->in += chunk;
+		stream->wpos = (stream->wpos + chunk) & WMASK;
+		stream->pending += chunk;
 
-			if (state->destcnt + len > state->destlen)
-				return ENOMEM;
+		stream->whave += chunk;
+		if (stream->whave > WSIZE)
+			stream->whave = WSIZE;
 
-			while (len > 0) {
-				/* Copy len bytes from distance bytes back */
-				state->dest[state->destcnt] =
-				    state->dest[state->destcnt - dist];
-				state->destcnt++;
-				len--;
-			}
-		}
-	} while (symbol != 256);
+		len -= chunk;
+	}
+}
 
-	return EOK;
+/** Flush pending window data into the output buffer
+ *
+ * @param stream Inflate stream.
+ * @param out    Output position (updated).
+ * @param outend End of the output buffer.
+ *
+ * @return Number of bytes flushed.
+ *
+ */
+static size_t inflate_flush(inflate_stream_t *stream, uint8_t **out,
+    uint8_t *outend)
+{
+	size_t flushed = 0;
+
+	while ((stream->pending > 0) && (*out < outend)) {
+		size_t start = (stream->wpos - stream->pending) & WMASK;
+		size_t chunk = min(stream->pending, WSIZE - start);
+		chunk = min(chunk, (size_t) (outend - *out));
+
+		memcpy(*out, stream->window + start, chunk);
+		*out += chunk;
+		stream->pending -= chunk;
+		flushed += chunk;
+	}
+
+	return flushed;
 }
 
-/** Decode `fixed codes' block
+/** Finish the current block
  *
- * @param state     Inflate state.
- * @param len_code  Huffman code for literal/length.
- * @param dist_code Huffman code for distance.
+ * @param stream Inflate stream.
+ *
+ */
+static void inflate_block_end(inflate_stream_t *stream)
+{
+	if (stream->last) {
+		/* Discard the padding up to the byte boundary */
+		get_bits(stream, stream->bitlen & 7);
+		stream->mode = INFLATE_DONE;
+	} else {
+		stream->mode = INFLATE_HEADER;
+	}
+}
+
+/** Decode literal/length and distance codes in bulk
+ *
+ * The fast path is used while there is enough input to decode
+ * a complete symbol pair without checking for the end of the input
+ * and enough room in the window to store the longest match. Bytes
+ * loaded into the bit buffer in excess are returned to the input
+ * on exit.
+ *
+ * @param stream Inflate stream.
  *
  * @return EOK on success.
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
  *
  */
-static errno_t inflate_fixed(inflate_state_t *state, huffman_t *len_code,
-    huffman_t *dist_code)
+static errno_t inflate_fast(inflate_stream_t *stream)
 {
-	return inflate_codes(state, len_code, dist_code);
+	const huffman_t *len_code = stream->len_code;
+	const huffman_t *dist_code = stream->dist_code;
+	errno_t rc = EOK;
+
+	while ((stream->inend - stream->in >= FAST_MIN_INPUT) &&
+	    (stream->pending <= WSIZE - MAX_MATCH)) {
+		/* Refill the bit buffer to at least 57 bits */
+		while (stream->bitlen <= 56) {
+			stream->bitbuf |=
+			    ((uint64_t) *stream->in) << stream->bitlen;
+			stream->in++;
+			stream->bitlen += 8;
+		}
+
+		/*
+		 * The bit buffer now holds enough bits for the longest
+		 * literal/length code, length extra bits, distance code
+		 * and distance extra bits (15 + 5 + 15 + 13 bits).
+		 */
+		uint16_t symbol;
+		rc = huffman_decode(stream, len_code, &symbol);
+		if (rc != EOK) {
+			rc = EINVAL;
+			break;
+		}
+
+		if (symbol < 256) {
+			window_put(stream, (uint8_t) symbol);
+			continue;
+		}
+
+		if (symbol == 256) {
+			inflate_block_end(stream);
+			break;
+		}
+
+		symbol -= 257;
+		if (symbol >= MAX_LEN) {
+			rc = EINVAL;
+			break;
+		}
+
+		size_t len = lens[symbol] + get_bits(stream, lens_ext[symbol]);
+
+		rc = huffman_decode(stream, dist_code, &symbol);
+		if ((rc != EOK) || (symbol >= MAX_DIST)) {
+			rc = EINVAL;
+			break;
+		}
+
+		size_t dist = dists[symbol] +
+		    get_bits(stream, dists_ext[symbol]);
+		if (dist > stream->whave) {
+			rc = ENOENT;
+			break;
+		}
+
+		window_copy(stream, dist, len);
+	}
+
+	/* Return unused whole bytes to the input */
+	size_t unused = stream->bitlen >> 3;
+	stream->in -= unused;
+	stream->bitlen -= unused << 3;
+	stream->bitbuf &= (UINT64_C(1) << stream->bitlen) - 1;
+
+	return rc;
 }
 
-/** Decode `dynamic codes' block
+/** Run the decoder
  *
- * @param state     Inflate state.
+ * Decode as much as possible from the available input
+ * into the available window space.
  *
- * @return EOK on success.
+ * @param stream Inflate stream.
+ *
+ * @return EOK if the end of the stream has been reached.
+ * @return EAGAIN if the input has been exhausted or the window is full.
  * @return ENOENT on distance too large.
- * @return EINVAL on invalid Huffman code.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
  *
  */
-static errno_t inflate_dynamic(inflate_state_t *state)
+static errno_t inflate_run(inflate_stream_t *stream)
 {
-	uint16_t length[MAX_CODE];
-	uint16_t dyn_len_count[MAX_HUFFMAN_BIT + 1];
-	uint16_t dyn_len_symbol[MAX_LITLEN];
-	uint16_t dyn_dist_count[MAX_HUFFMAN_BIT + 1];
-	uint16_t dyn_dist_symbol[MAX_DIST];
-	huffman_t dyn_len_code;
-	huffman_t dyn_dist_code;
-
-	dyn_len_code.count = dyn_len_count;
-	dyn_len_code.symbol = dyn_len_symbol;
-
-	dyn_dist_code.count = dyn_dist_count;
-	dyn_dist_code.symbol = dyn_dist_symbol;
-
-	/* Get number of bits in each table */
-	uint16_t nlen = get_bits(state, 5) + 257;
-	CHECK_OVERRUN(*state);
-
-	uint16_t ndist = get_bits(state, 5) + 1;
-	CHECK_OVERRUN(*state);
-
-	uint16_t ncode = get_bits(state, 4) + 4;
-	CHECK_OVERRUN(*state);
-
-	if ((nlen > MAX_LITLEN) || (ndist > MAX_DIST) ||
-	    (ncode > MAX_ORDER))
-		return EINVAL;
-
-	/* Read code length code lengths */
-	uint16_t index;
-	for (index = 0; index < ncode; index++) {
-		length[order[index]] = get_bits(state, 3);
-		CHECK_OVERRUN(*state);
-	}
+	errno_t rc;
+	int16_t ret;
+	uint16_t rlen;
+	size_t len;
 
-	/* Set missing lengths to zero */
-	for (index = ncode; index < MAX_ORDER; index++)
-		length[order[index]] = 0;
+	stream->window_full = false;
+
+	while (true) {
+		switch (stream->mode) {
+		case INFLATE_HEADER:
+			if (!need_bits(stream, 3))
+				return EAGAIN;
+
+			/* Last block is indicated by a non-zero bit */
+			stream->last = get_bits(stream, 1);
+
+			/* Block type */
+			switch (get_bits(stream, 2)) {
+			case 0:
+				/* Discard bits up to the byte boundary */
+				get_bits(stream, stream->bitlen & 7);
+				stream->mode = INFLATE_STORED_LEN;
+				break;
+			case 1:
+				stream->len_code = &stream->fixed_len_code;
+				stream->dist_code = &stream->fixed_dist_code;
+				stream->mode = INFLATE_CODES;
+				break;
+			case 2:
+				stream->mode = INFLATE_TABLE_SIZES;
+				break;
+			default:
+				return EINVAL;
+			}
+			break;
+		case INFLATE_STORED_LEN:
+			if (!need_bits(stream, 32))
+				return EAGAIN;
 
-	/* Build Huffman code */
-	int16_t rc = huffman_construct(&dyn_len_code, length, MAX_ORDER);
-	if (rc != 0)
-		return EINVAL;
+			len = get_bits(stream, 16);
 
-	/* Read length/literal and distance code length tables */
-	index = 0;
-	while (index < nlen + ndist) {
-		uint16_t symbol;
-		errno_t err = huffman_decode(state, &dyn_len_code, &symbol);
-		if (err != EOK)
-			return EOK;
+			/* Check block length and its complement */
+			if (len != (~get_bits(stream, 16) & 0xffff))
+				return EINVAL;
 
-		if (symbol < 16) {
-			length[index] = symbol;
-			index++;
-		} else {
-			uint16_t len = 0;
+			stream->stored_left = len;
+			stream->mode = INFLATE_STORED_COPY;
+			break;
+		case INFLATE_STORED_COPY:
+			/* The bit buffer is empty at this point */
+			while (stream->stored_left > 0) {
+				len = min(stream->stored_left,
+				    (size_t) (stream->inend - stream->in));
+				len = min(len, WSIZE - stream->pending);
+
+				if (len == 0) {
+					stream->window_full =
+					    (stream->pending == WSIZE);
+					return EAGAIN;
+				}
+
+				window_write(stream, len);
+				stream->stored_left -= len;
+			}
+
+			inflate_block_end(stream);
+			break;
+		case INFLATE_TABLE_SIZES:
+			if (!need_bits(stream, 14))
+				return EAGAIN;
+
+			/* Get number of bits in each table */
+			stream->nlen = get_bits(stream, 5) + 257;
+			stream->ndist = get_bits(stream, 5) + 1;
+			stream->ncode = get_bits(stream, 4) + 4;
+
+			if ((stream->nlen > MAX_LITLEN) ||
+			    (stream->ndist > MAX_DIST) ||
+			    (stream->ncode > MAX_ORDER))
+				return EINVAL;
+
+			stream->index = 0;
+			stream->mode = INFLATE_TABLE_ORDER;
+			break;
+		case INFLATE_TABLE_ORDER:
+			/* Read code length code lengths */
+			while (stream->index < stream->ncode) {
+				if (!need_bits(stream, 3))
+					return EAGAIN;
+
+				stream->length[order[stream->index]] =
+				    get_bits(stream, 3);
+				stream->index++;
+			}
+
+			/* Set missing lengths to zero */
+			for (len = stream->ncode; len < MAX_ORDER; len++)
+				stream->length[order[len]] = 0;
+
+			/* Build Huffman code */
+			ret = huffman_construct(&stream->dyn_code_code,
+			    stream->length, MAX_ORDER);
+			if (ret != 0)
+				return EINVAL;
+
+			stream->index = 0;
+			stream->mode = INFLATE_TABLE_LENGTHS;
+			break;
+		case INFLATE_TABLE_LENGTHS:
+			/* Read literal/length and distance code lengths */
+			while (stream->index < stream->nlen + stream->ndist) {
+				rc = huffman_decode_input(stream,
+				    &stream->dyn_code_code, &stream->symbol);
+				if (rc != EOK)
+					return rc;
+
+				if (stream->symbol >= 16) {
+					stream->mode = INFLATE_TABLE_REPEAT;
+					break;
+				}
+
+				stream->length[stream->index] = stream->symbol;
+				stream->index++;
+			}
+
+			if (stream->mode == INFLATE_TABLE_REPEAT)
+				break;
 
-			if (symbol == 16) {
-				if (index == 0)
+			/* Check for end-of-block code */
+			if (stream->length[256] == 0)
+				return EINVAL;
+
+			/* Build Huffman tables for literal/length codes */
+			ret = huffman_construct(&stream->dyn_len_code,
+			    stream->length, stream->nlen);
+			if ((ret < 0) || ((ret > 0) &&
+			    (stream->dyn_len_code.count[0] + 1 !=
+			    stream->nlen)))
+				return EINVAL;
+
+			/* Build Huffman tables for distance codes */
+			ret = huffman_construct(&stream->dyn_dist_code,
+			    stream->length + stream->nlen, stream->ndist);
+			if ((ret < 0) || ((ret > 0) &&
+			    (stream->dyn_dist_code.count[0] + 1 !=
+			    stream->ndist)))
+				return EINVAL;
+
+			stream->len_code = &stream->dyn_len_code;
+			stream->dist_code = &stream->dyn_dist_code;
+			stream->mode = INFLATE_CODES;
+			break;
+		case INFLATE_TABLE_REPEAT:
+			rlen = 0;
+
+			if (stream->symbol == 16) {
+				if (stream->index == 0)
 					return EINVAL;
 
-				len = length[index - 1];
-				symbol = get_bits(state, 2) + 3;
-				CHECK_OVERRUN(*state);
-			} else if (symbol == 17) {
-				symbol = get_bits(state, 3) + 3;
-				CHECK_OVERRUN(*state);
+				if (!need_bits(stream, 2))
+					return EAGAIN;
+
+				rlen = stream->length[stream->index - 1];
+				len = get_bits(stream, 2) + 3;
+			} else if (stream->symbol == 17) {
+				if (!need_bits(stream, 3))
+					return EAGAIN;
+
+				len = get_bits(stream, 3) + 3;
+			} else {
+				if (!need_bits(stream, 7))
+					return EAGAIN;
+
+				len = get_bits(stream, 7) + 11;
+			}
+
+			if (stream->index + len >
+			    (size_t) (stream->nlen + stream->ndist))
+				return EINVAL;
+
+			while (len > 0) {
+				stream->length[stream->index] = rlen;
+				stream->index++;
+				len--;
+			}
+
+			stream->mode = INFLATE_TABLE_LENGTHS;
+			break;
+		case INFLATE_CODES:
+			rc = inflate_fast(stream);
+			if (rc != EOK)
+				return rc;
+
+			if (stream->mode != INFLATE_CODES)
+				break;
+
+			if (stream->pending == WSIZE) {
+				stream->window_full = true;
+				return EAGAIN;
+			}
+
+			rc = huffman_decode_input(stream, stream->len_code,
+			    &stream->symbol);
+			if (rc != EOK)
+				return rc;
+
+			if (stream->symbol < 256) {
+				window_put(stream, (uint8_t) stream->symbol);
+			} else if (stream->symbol == 256) {
+				inflate_block_end(stream);
 			} else {
-				symbol = get_bits(state, 7) + 11;
-				CHECK_OVERRUN(*state);
+				stream->symbol -= 257;
+				if (stream->symbol >= MAX_LEN)
+					return EINVAL;
+
+				stream->mode = INFLATE_LEN_EXTRA;
 			}
+			break;
+		case INFLATE_LEN_EXTRA:
+			if (!need_bits(stream, lens_ext[stream->symbol]))
+				return EAGAIN;
 
-			if (index + symbol > nlen + ndist)
+			stream->copy_len = lens[stream->symbol] +
+			    get_bits(stream, lens_ext[stream->symbol]);
+			stream->mode = INFLATE_DIST;
+			break;
+		case INFLATE_DIST:
+			rc = huffman_decode_input(stream, stream->dist_code,
+			    &stream->symbol);
+			if (rc != EOK)
+				return rc;
+
+			if (stream->symbol >= MAX_DIST)
 				return EINVAL;
 
-			while (symbol > 0) {
-				length[index] = len;
-				index++;
-				symbol--;
+			stream->mode = INFLATE_DIST_EXTRA;
+			break;
+		case INFLATE_DIST_EXTRA:
+			if (!need_bits(stream, dists_ext[stream->symbol]))
+				return EAGAIN;
+
+			stream->copy_dist = dists[stream->symbol] +
+			    get_bits(stream, dists_ext[stream->symbol]);
+			if (stream->copy_dist > stream->whave)
+				return ENOENT;
+
+			stream->mode = INFLATE_COPY;
+			break;
+		case INFLATE_COPY:
+			len = min(stream->copy_len, WSIZE - stream->pending);
+			if (len == 0) {
+				stream->window_full = true;
+				return EAGAIN;
 			}
+
+			window_copy(stream, stream->copy_dist, len);
+			stream->copy_len -= len;
+
+			if (stream->copy_len == 0)
+				stream->mode = INFLATE_CODES;
+			break;
+		case INFLATE_DONE:
+			return EOK;
 		}
 	}
+}
+
+/** Create inflate stream
+ *
+ * @param rstream Place to store pointer to the new stream.
+ *
+ * @return EOK on success.
+ * @return ENOMEM if out of memory.
+ *
+ */
+errno_t inflate_stream_create(inflate_stream_t **rstream)
+{
+	inflate_stream_t *stream = malloc(sizeof(inflate_stream_t));
+	if (stream == NULL)
+		return ENOMEM;
 
-	/* Check for end-of-block code */
-	if (length[256] == 0)
-		return EINVAL;
+	stream->mode = INFLATE_HEADER;
+	stream->last = false;
+	stream->in = NULL;
+	stream->inend = NULL;
+	stream->bitbuf = 0;
+	stream->bitlen = 0;
+	stream->wpos = 0;
+	stream->whave = 0;
+	stream->pending = 0;
+	stream->window_full = false;
+	stream->len_code = NULL;
+	stream->dist_code = NULL;
+
+	/* Construct the fixed codes */
+	size_t symbol;
+	for (symbol = 0; symbol < 144; symbol++)
+		stream->length[symbol] = 8;
+	for (; symbol < 256; symbol++)
+		stream->length[symbol] = 9;
+	for (; symbol < 280; symbol++)
+		stream->length[symbol] = 7;
+	for (; symbol < MAX_FIXED_LITLEN; symbol++)
+		stream->length[symbol] = 8;
 
-	/* Build Huffman tables for literal/length codes */
-	rc = huffman_construct(&dyn_len_code, length, nlen);
-	if ((rc < 0) || ((rc > 0) && (dyn_len_code.count[0] + 1 != nlen)))
-		return EINVAL;
+	(void) huffman_construct(&stream->fixed_len_code, stream->length,
+	    MAX_FIXED_LITLEN);
 
-	/* Build Huffman tables for distance codes */
-	rc = huffman_construct(&dyn_dist_code, length + nlen, ndist);
-	if ((rc < 0) || ((rc > 0) && (dyn_dist_code.count[0] + 1 != ndist)))
-		return EINVAL;
+	for (symbol = 0; symbol < MAX_DIST; symbol++)
+		stream->length[symbol] = 5;
 
-	return inflate_codes(state, &dyn_len_code, &dyn_dist_code);
+	(void) huffman_construct(&stream->fixed_dist_code, stream->length,
+	    MAX_DIST);
+
+	*rstream = stream;
+	return EOK;
 }
 
-/** Inflate data
+/** Destroy inflate stream
  *
- * @param src     Source data buffer.
- * @param srclen  Source buffer size (bytes).
- * @param dest    Destination data buffer.
- * @param destlen Destination buffer size (bytes).
+ * @param stream Inflate stream (can be NULL).
  *
- * @return EOK on success.
+ */
+void inflate_stream_destroy(inflate_stream_t *stream)
+{
+	free(stream);
+}
+
+/** Inflate a chunk of data
+ *
+ * Decompress as much of the input as possible into the output
+ * buffer. The input which has not been consumed (because of
+ * insufficient output space) has to be passed again in the next
+ * call. The input is never consumed beyond the end of the deflate
+ * stream, thus any data following the stream (such as a trailer
+ * of an enclosing format) are left unused.
+ *
+ * @param stream   Inflate stream.
+ * @param src      Source data buffer.
+ * @param srclen   Source buffer size (bytes).
+ * @param srcused  Place to store the number of input bytes consumed.
+ * @param dest     Destination data buffer.
+ * @param destlen  Destination buffer size (bytes).
+ * @param destused Place to store the number of output bytes produced.
+ *
+ * @return EOK if the end of the stream has been reached and all
+ *         the decompressed data have been stored.
+ * @return EAGAIN if more input or more output space is needed.
  * @return ENOENT on distance too large.
  * @return EINVAL on invalid Huffman code or invalid deflate data.
- * @return ELIMIT on input buffer overrun.
- * @return ENOMEM on output buffer overrun.
  *
  */
-errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
+errno_t inflate_stream(inflate_stream_t *stream, const void *src,
+    size_t srclen, size_t *srcused, void *dest, size_t destlen,
+    size_t *destused)
 {
-	/* Initialize the state */
-	inflate_state_t state;
+	uint8_t *out = (uint8_t *) dest;
+	uint8_t *outend = out + destlen;
+	errno_t rc;
 
-	state.dest = (uint8_t *) dest;
-	state.destlen = destlen;
-	state.destcnt = 0;
+	stream->in = (const uint8_t *) src;
+	stream->inend = stream->in + srclen;
 
-	state.src = (uint8_t *) src;
-	state.srclen = srclen;
-	state.srccnt = 0;
+	while (true) {
+		rc = inflate_run(stream);
+		size_t flushed = inflate_flush(stream, &out, outend);
 
-	state.bitbuf = 0;
-	state.bitlen = 0;
+		/* Continue if flushing made room in the window */
+		if ((rc != EAGAIN) || (!stream->window_full) || (flushed == 0))
+			break;
+	}
 
-	state.overrun = false;
+	if ((rc == EOK) && (stream->pending > 0))
+		rc = EAGAIN;
 
-	uint16_t last;
-	errno_t ret = EOK;
+	*srcused = stream->in - (const uint8_t *) src;
+	*destused = out - (uint8_t *) dest;
 
-	do {
-		/* Last block is indicated by a non-zero bit */
-		last = get_bits(&state, 1);
-		CHECK_OVERRUN(state);
+	stream->in = NULL;
+	stream->inend = NULL;
 
-		/* Block type */
-		uint16_t type = get_bits(&state, 2);
-		CHECK_OVERRUN(state);
+	return rc;
+}
 
-		switch (type) {
-		case 0:
-			ret = inflate_stored(&state);
-			break;
-		case 1:
-			ret = inflate_fixed(&state, &len_code, &dist_code);
-			break;
-		case 2:
-			ret = inflate_dynamic(&state);
-			break;
-		default:
-			ret = EINVAL;
-		}
-	} while ((!last) && (ret == 0));
+/** Inflate data
+ *
+ * @param src     Source data buffer.
+ * @param srclen  Source buffer size (bytes).
+ * @param dest    Destination data buffer.
+ * @param destlen Destination buffer size (bytes).
+ *
+ * @return EOK on success.
+ * @return ENOENT on distance too large.
+ * @return EINVAL on invalid Huffman code or invalid deflate data.
+ * @return ELIMIT on input buffer overrun.
+ * @return ENOMEM on output buffer overrun or if out of memory.
+ *
+ */
+errno_t inflate(void *src, size_t srclen, void *dest, size_t destlen)
+{
+	inflate_stream_t *stream;
+	errno_t rc = inflate_stream_create(&stream);
+	if (rc != EOK)
+		return rc;
+
+	size_t srcused;
+	size_t destused;
+	rc = inflate_stream(stream, src, srclen, &srcused, dest, destlen,
+	    &destused);
+	if (rc == EAGAIN) {
+		/* Either the output is full or the input is truncated */
+		rc = (destused == destlen) ? ENOMEM : ELIMIT;
+	}
 
-	return ret;
+	inflate_stream_destroy(stream);
+	return rc;
 }
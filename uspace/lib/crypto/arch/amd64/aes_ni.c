@@ -0,0 +1,374 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file aes_ni.c
+ *
+ * AES-128 using the AES-NI instruction set extension.
+ *
+ * The round keys are expected as byte sequences in the order of the state
+ * bytes, the decryption round keys as prepared for the equivalent inverse
+ * cipher. The instructions are emitted via inline assembly so that the
+ * library can be compiled without enabling AES code generation globally.
+ * The processor support is detected at run time by aes_ni_supported().
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <mem.h>
+#include "../../aes_ni.h"
+
+/* Number of round keys. */
+#define ROUND_KEYS  11
+
+/* Length of AES block. */
+#define BLOCK_LEN  16
+
+/* CPUID leaf 1 ECX bit indicating AES-NI support. */
+#define CPUID_AES  (1 << 25)
+
+typedef long long aes_block_t __attribute__((vector_size(16)));
+
+static inline aes_block_t load_block(const uint8_t *data)
+{
+	aes_block_t block;
+
+	memcpy(&block, data, sizeof(block));
+	return block;
+}
+
+static inline void store_block(uint8_t *data, aes_block_t block)
+{
+	memcpy(data, &block, sizeof(block));
+}
+
+static inline aes_block_t aesenc(aes_block_t state, aes_block_t key)
+{
+	asm ("aesenc %[key], %[state]"
+	    : [state] "+x" (state)
+	    : [key] "x" (key));
+	return state;
+}
+
+static inline aes_block_t aesenclast(aes_block_t state, aes_block_t key)
+{
+	asm ("aesenclast %[key], %[state]"
+	    : [state] "+x" (state)
+	    : [key] "x" (key));
+	return state;
+}
+
+static inline aes_block_t aesdec(aes_block_t state, aes_block_t key)
+{
+	asm ("aesdec %[key], %[state]"
+	    : [state] "+x" (state)
+	    : [key] "x" (key));
+	return state;
+}
+
+static inline aes_block_t aesdeclast(aes_block_t state, aes_block_t key)
+{
+	asm ("aesdeclast %[key], %[state]"
+	    : [state] "+x" (state)
+	    : [key] "x" (key));
+	return state;
+}
+
+static inline void load_keys(const uint8_t *round_keys, aes_block_t *keys)
+{
+	for (size_t i = 0; i < ROUND_KEYS; i++)
+		keys[i] = load_block(round_keys + i * BLOCK_LEN);
+}
+
+static inline aes_block_t encrypt_block(const aes_block_t *keys,
+    aes_block_t state)
+{
+	state ^= keys[0];
+
+	for (size_t i = 1; i < ROUND_KEYS - 1; i++)
+		state = aesenc(state, keys[i]);
+
+	return aesenclast(state, keys[ROUND_KEYS - 1]);
+}
+
+static inline aes_block_t decrypt_block(const aes_block_t *keys,
+    aes_block_t state)
+{
+	state ^= keys[0];
+
+	for (size_t i = 1; i < ROUND_KEYS - 1; i++)
+		state = aesdec(state, keys[i]);
+
+	return aesdeclast(state, keys[ROUND_KEYS - 1]);
+}
+
+/** Check whether the processor supports AES-NI.
+ *
+ * @return True if the AES-NI instructions are available.
+ *
+ */
+bool aes_ni_supported(void)
+{
+	uint32_t eax, ebx, ecx, edx;
+
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (1), "c" (0)
+	);
+
+	return (ecx & CPUID_AES) != 0;
+}
+
+/** Encrypt blocks independently (ECB).
+ *
+ * @param round_keys Encryption round keys.
+ * @param input      Input blocks.
+ * @param output     Output blocks.
+ * @param blocks     Number of blocks.
+ *
+ */
+void aes_ni_encrypt(const uint8_t *round_keys, const uint8_t *input,
+    uint8_t *output, size_t blocks)
+{
+	aes_block_t keys[ROUND_KEYS];
+	load_keys(round_keys, keys);
+
+	for (size_t i = 0; i < blocks; i++) {
+		store_block(output + i * BLOCK_LEN,
+		    encrypt_block(keys, load_block(input + i * BLOCK_LEN)));
+	}
+}
+
+/** Decrypt blocks independently (ECB).
+ *
+ * @param round_keys Decryption round keys.
+ * @param input      Input blocks.
+ * @param output     Output blocks.
+ * @param blocks     Number of blocks.
+ *
+ */
+void aes_ni_decrypt(const uint8_t *round_keys, const uint8_t *input,
+    uint8_t *output, size_t blocks)
+{
+	aes_block_t keys[ROUND_KEYS];
+	load_keys(round_keys, keys);
+
+	for (size_t i = 0; i < blocks; i++) {
+		store_block(output + i * BLOCK_LEN,
+		    decrypt_block(keys, load_block(input + i * BLOCK_LEN)));
+	}
+}
+
+/** Encrypt blocks in CBC mode.
+ *
+ * The chaining makes each block depend on the previous one, hence
+ * the blocks are processed one by one.
+ *
+ * @param round_keys Encryption round keys.
+ * @param iv         Initialization vector, updated to the last cipher block.
+ * @param input      Input blocks.
+ * @param output     Output blocks.
+ * @param blocks     Number of blocks.
+ *
+ */
+void aes_ni_cbc_encrypt(const uint8_t *round_keys, uint8_t *iv,
+    const uint8_t *input, uint8_t *output, size_t blocks)
+{
+	aes_block_t keys[ROUND_KEYS];
+	load_keys(round_keys, keys);
+
+	aes_block_t chain = load_block(iv);
+
+	for (size_t i = 0; i < blocks; i++) {
+		chain = encrypt_block(keys,
+		    chain ^ load_block(input + i * BLOCK_LEN));
+		store_block(output + i * BLOCK_LEN, chain);
+	}
+
+	store_block(iv, chain);
+}
+
+/** Decrypt blocks in CBC mode.
+ *
+ * Unlike encryption, decryption of the blocks is independent, so four
+ * blocks are kept in flight to hide the latency of the instructions.
+ *
+ * @param round_keys Decryption round keys.
+ * @param iv         Initialization vector, updated to the last cipher block.
+ * @param input      Input blocks.
+ * @param output     Output blocks (can be the same as input).
+ * @param blocks     Number of blocks.
+ *
+ */
+void aes_ni_cbc_decrypt(const uint8_t *round_keys, uint8_t *iv,
+    const uint8_t *input, uint8_t *output, size_t blocks)
+{
+	aes_block_t keys[ROUND_KEYS];
+	load_keys(round_keys, keys);
+
+	aes_block_t chain = load_block(iv);
+	size_t i = 0;
+
+	for (; i + 4 <= blocks; i += 4) {
+		const uint8_t *in = input + i * BLOCK_LEN;
+		uint8_t *out = output + i * BLOCK_LEN;
+
+		aes_block_t c0 = load_block(in);
+		aes_block_t c1 = load_block(in + BLOCK_LEN);
+		aes_block_t c2 = load_block(in + 2 * BLOCK_LEN);
+		aes_block_t c3 = load_block(in + 3 * BLOCK_LEN);
+
+		aes_block_t s0 = c0 ^ keys[0];
+		aes_block_t s1 = c1 ^ keys[0];
+		aes_block_t s2 = c2 ^ keys[0];
+		aes_block_t s3 = c3 ^ keys[0];
+
+		for (size_t k = 1; k < ROUND_KEYS - 1; k++) {
+			s0 = aesdec(s0, keys[k]);
+			s1 = aesdec(s1, keys[k]);
+			s2 = aesdec(s2, keys[k]);
+			s3 = aesdec(s3, keys[k]);
+		}
+
+		s0 = aesdeclast(s0, keys[ROUND_KEYS - 1]);
+		s1 = aesdeclast(s1, keys[ROUND_KEYS - 1]);
+		s2 = aesdeclast(s2, keys[ROUND_KEYS - 1]);
+		s3 = aesdeclast(s3, keys[ROUND_KEYS - 1]);
+
+		store_block(out, s0 ^ chain);
+		store_block(out + BLOCK_LEN, s1 ^ c0);
+		store_block(out + 2 * BLOCK_LEN, s2 ^ c1);
+		store_block(out + 3 * BLOCK_LEN, s3 ^ c2);
+
+		chain = c3;
+	}
+
+	for (; i < blocks; i++) {
+		aes_block_t cipher = load_block(input + i * BLOCK_LEN);
+
+		store_block(output + i * BLOCK_LEN,
+		    decrypt_block(keys, cipher) ^ chain);
+		chain = cipher;
+	}
+
+	store_block(iv, chain);
+}
+
+/** Load big-endian counter block into two host-order halves. */
+static inline void counter_load(const uint8_t *counter, uint64_t *hi,
+    uint64_t *lo)
+{
+	memcpy(hi, counter, sizeof(*hi));
+	memcpy(lo, counter + sizeof(*hi), sizeof(*lo));
+
+	*hi = __builtin_bswap64(*hi);
+	*lo = __builtin_bswap64(*lo);
+}
+
+/** Produce counter block from host-order halves and increment it. */
+static inline aes_block_t counter_next(uint64_t *hi, uint64_t *lo)
+{
+	aes_block_t block = {
+		(long long) __builtin_bswap64(*hi),
+		(long long) __builtin_bswap64(*lo)
+	};
+
+	(*lo)++;
+	if (*lo == 0)
+		(*hi)++;
+
+	return block;
+}
+
+/** Encrypt or decrypt whole blocks in CTR mode.
+ *
+ * The counter blocks are independent, so four blocks are kept in flight
+ * to hide the latency of the instructions.
+ *
+ * @param round_keys Encryption round keys.
+ * @param counter    Big-endian counter block, updated for the next block.
+ * @param input      Input blocks.
+ * @param output     Output blocks (can be the same as input).
+ * @param blocks     Number of blocks.
+ *
+ */
+void aes_ni_ctr(const uint8_t *round_keys, uint8_t *counter,
+    const uint8_t *input, uint8_t *output, size_t blocks)
+{
+	aes_block_t keys[ROUND_KEYS];
+	load_keys(round_keys, keys);
+
+	uint64_t hi;
+	uint64_t lo;
+	counter_load(counter, &hi, &lo);
+
+	size_t i = 0;
+
+	for (; i + 4 <= blocks; i += 4) {
+		const uint8_t *in = input + i * BLOCK_LEN;
+		uint8_t *out = output + i * BLOCK_LEN;
+
+		aes_block_t s0 = counter_next(&hi, &lo) ^ keys[0];
+		aes_block_t s1 = counter_next(&hi, &lo) ^ keys[0];
+		aes_block_t s2 = counter_next(&hi, &lo) ^ keys[0];
+		aes_block_t s3 = counter_next(&hi, &lo) ^ keys[0];
+
+		for (size_t k = 1; k < ROUND_KEYS - 1; k++) {
+			s0 = aesenc(s0, keys[k]);
+			s1 = aesenc(s1, keys[k]);
+			s2 = aesenc(s2, keys[k]);
+			s3 = aesenc(s3, keys[k]);
+		}
+
+		s0 = aesenclast(s0, keys[ROUND_KEYS - 1]);
+		s1 = aesenclast(s1, keys[ROUND_KEYS - 1]);
+		s2 = aesenclast(s2, keys[ROUND_KEYS - 1]);
+		s3 = aesenclast(s3, keys[ROUND_KEYS - 1]);
+
+		store_block(out, s0 ^ load_block(in));
+		store_block(out + BLOCK_LEN, s1 ^ load_block(in + BLOCK_LEN));
+		store_block(out + 2 * BLOCK_LEN,
+		    s2 ^ load_block(in + 2 * BLOCK_LEN));
+		store_block(out + 3 * BLOCK_LEN,
+		    s3 ^ load_block(in + 3 * BLOCK_LEN));
+	}
+
+	for (; i < blocks; i++) {
+		aes_block_t stream = encrypt_block(keys,
+		    counter_next(&hi, &lo));
+
+		store_block(output + i * BLOCK_LEN,
+		    stream ^ load_block(input + i * BLOCK_LEN));
+	}
+
+	hi = __builtin_bswap64(hi);
+	lo = __builtin_bswap64(lo);
+	memcpy(counter, &hi, sizeof(hi));
+	memcpy(counter + sizeof(hi), &lo, sizeof(lo));
+}
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file sha_ni.c
+ *
+ * SHA-256 using the SHA instruction set extension.
+ *
+ * Besides the rounds, the instructions also compute the message schedule
+ * four words at a time. As with AES-NI, the instructions are emitted
+ * via inline assembly and the processor support is detected at run time
+ * by sha_ni_supported().
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <mem.h>
+#include "../../sha_ni.h"
+
+/* Length of SHA-256 block. */
+#define BLOCK_LEN  64
+
+/* CPUID leaf 1 ECX bits indicating SSSE3 and SSE4.1 support. */
+#define CPUID_SSSE3  (1 << 9)
+#define CPUID_SSE41  (1 << 19)
+
+/* CPUID leaf 7 EBX bit indicating SHA extensions support. */
+#define CPUID_SHA  (1 << 29)
+
+typedef uint32_t sha_block_t __attribute__((vector_size(16)));
+
+/* Shuffle 32-bit words within the block. */
+#define PSHUFD(src, imm) ({ \
+	sha_block_t _res; \
+	asm ("pshufd %[i], %[s], %[d]" \
+	    : [d] "=x" (_res) \
+	    : [s] "x" (src), [i] "i" (imm)); \
+	_res; \
+})
+
+/* Concatenate the blocks (hi:lo) and extract 16 bytes at given offset. */
+#define PALIGNR(hi, lo, imm) ({ \
+	sha_block_t _res = (hi); \
+	asm ("palignr %[i], %[s], %[d]" \
+	    : [d] "+x" (_res) \
+	    : [s] "x" (lo), [i] "i" (imm)); \
+	_res; \
+})
+
+/* Blend 16-bit words of the blocks according to the mask. */
+#define PBLENDW(dst, src, imm) ({ \
+	sha_block_t _res = (dst); \
+	asm ("pblendw %[i], %[s], %[d]" \
+	    : [d] "+x" (_res) \
+	    : [s] "x" (src), [i] "i" (imm)); \
+	_res; \
+})
+
+static inline sha_block_t load_block(const void *data)
+{
+	sha_block_t block;
+
+	memcpy(&block, data, sizeof(block));
+	return block;
+}
+
+static inline void store_block(void *data, sha_block_t block)
+{
+	memcpy(data, &block, sizeof(block));
+}
+
+static inline sha_block_t pshufb(sha_block_t block, sha_block_t mask)
+{
+	asm ("pshufb %[mask], %[block]"
+	    : [block] "+x" (block)
+	    : [mask] "x" (mask));
+	return block;
+}
+
+static inline sha_block_t sha256rnds2(sha_block_t cdgh, sha_block_t abef,
+    sha_block_t msg)
+{
+	asm ("sha256rnds2 %[msg], %[abef], %[cdgh]"
+	    : [cdgh] "+x" (cdgh)
+	    : [abef] "x" (abef), [msg] "Yz" (msg));
+	return cdgh;
+}
+
+static inline sha_block_t sha256msg1(sha_block_t msg, sha_block_t next)
+{
+	asm ("sha256msg1 %[next], %[msg]"
+	    : [msg] "+x" (msg)
+	    : [next] "x" (next));
+	return msg;
+}
+
+static inline sha_block_t sha256msg2(sha_block_t msg, sha_block_t prev)
+{
+	asm ("sha256msg2 %[prev], %[msg]"
+	    : [msg] "+x" (msg)
+	    : [prev] "x" (prev));
+	return msg;
+}
+
+/** Check whether the processor supports the SHA extensions.
+ *
+ * @return True if the SHA instructions (and SSSE3 and SSE4.1 needed
+ *         to prepare their operands) are available.
+ *
+ */
+bool sha_ni_supported(void)
+{
+	uint32_t eax, ebx, ecx, edx;
+
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (0), "c" (0)
+	);
+
+	if (eax < 7)
+		return false;
+
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (1), "c" (0)
+	);
+
+	if (((ecx & CPUID_SSSE3) == 0) || ((ecx & CPUID_SSE41) == 0))
+		return false;
+
+	asm volatile (
+	    "cpuid\n"
+	    : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx)
+	    : "a" (7), "c" (0)
+	);
+
+	return (ebx & CPUID_SHA) != 0;
+}
+
+/** Four rounds of SHA-256 with the message schedule.
+ *
+ * The message schedule of the later rounds is computed in the four
+ * message registers while the earlier rounds are processed.
+ *
+ * @param i    Index of the group of four rounds (0 to 15).
+ * @param abef State words A, B, E, F.
+ * @param cdgh State words C, D, G, H.
+ * @param msg  Message schedule registers.
+ * @param data Input block.
+ *
+ */
+static inline __attribute__((always_inline)) void sha256_rounds4(size_t i,
+    sha_block_t *abef, sha_block_t *cdgh, sha_block_t *msg,
+    const uint8_t *data)
+{
+	/* Byte swap of each 32-bit word */
+	const sha_block_t bswap = {
+		0x00010203, 0x04050607, 0x08090a0b, 0x0c0d0e0f
+	};
+
+	if (i < 4)
+		msg[i] = pshufb(load_block(data + 16 * i), bswap);
+
+	sha_block_t wk = msg[i % 4] + load_block(sha256_k + 4 * i);
+
+	*cdgh = sha256rnds2(*cdgh, *abef, wk);
+
+	if ((i >= 3) && (i < 15)) {
+		msg[(i + 1) % 4] += PALIGNR(msg[i % 4], msg[(i + 3) % 4], 4);
+		msg[(i + 1) % 4] = sha256msg2(msg[(i + 1) % 4], msg[i % 4]);
+	}
+
+	*abef = sha256rnds2(*abef, *cdgh, PSHUFD(wk, 0x0e));
+
+	if ((i >= 1) && (i < 13))
+		msg[(i + 3) % 4] = sha256msg1(msg[(i + 3) % 4], msg[i % 4]);
+}
+
+/** Working procedure of SHA-256 using the SHA extensions.
+ *
+ * @param h      Working array with interim hash parts values.
+ * @param data   Input blocks.
+ * @param blocks Number of blocks.
+ *
+ */
+void sha_ni_sha256_blocks(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	sha_block_t msg[4];
+
+	/* The instructions expect the state as ABEF and CDGH */
+	sha_block_t tmp = PSHUFD(load_block(h), 0xb1);
+	sha_block_t cdgh = PSHUFD(load_block(h + 4), 0x1b);
+	sha_block_t abef = PALIGNR(tmp, cdgh, 8);
+	cdgh = PBLENDW(cdgh, tmp, 0xf0);
+
+	for (; blocks > 0; blocks--, data += BLOCK_LEN) {
+		sha_block_t abef_save = abef;
+		sha_block_t cdgh_save = cdgh;
+
+		/* Unrolled so that the schedule stays in registers */
+		sha256_rounds4(0, &abef, &cdgh, msg, data);
+		sha256_rounds4(1, &abef, &cdgh, msg, data);
+		sha256_rounds4(2, &abef, &cdgh, msg, data);
+		sha256_rounds4(3, &abef, &cdgh, msg, data);
+		sha256_rounds4(4, &abef, &cdgh, msg, data);
+		sha256_rounds4(5, &abef, &cdgh, msg, data);
+		sha256_rounds4(6, &abef, &cdgh, msg, data);
+		sha256_rounds4(7, &abef, &cdgh, msg, data);
+		sha256_rounds4(8, &abef, &cdgh, msg, data);
+		sha256_rounds4(9, &abef, &cdgh, msg, data);
+		sha256_rounds4(10, &abef, &cdgh, msg, data);
+		sha256_rounds4(11, &abef, &cdgh, msg, data);
+		sha256_rounds4(12, &abef, &cdgh, msg, data);
+		sha256_rounds4(13, &abef, &cdgh, msg, data);
+		sha256_rounds4(14, &abef, &cdgh, msg, data);
+		sha256_rounds4(15, &abef, &cdgh, msg, data);
+
+		abef += abef_save;
+		cdgh += cdgh_save;
+	}
+
+	/* Convert the state back to ABCD and EFGH */
+	tmp = PSHUFD(abef, 0x1b);
+	cdgh = PSHUFD(cdgh, 0xb1);
+	store_block(h, PBLENDW(tmp, cdgh, 0xf0));
+	store_block(h + 4, PALIGNR(cdgh, tmp, 8));
+}
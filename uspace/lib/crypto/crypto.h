@@ -34,7 +34,10 @@
 #include <stdint.h>
 
 #define AES_CIPHER_LENGTH  16
+#define AES_KEY_EXP_LENGTH  44
 #define PBKDF2_KEY_LENGTH  32
+#define HASH_MAX_LENGTH  64
+#define HASH_MAX_BLOCK_LENGTH  128
 
 /* Left rotation for uint32_t. */
 #define rotl_uint32(val, shift) \
@@ -47,12 +50,68 @@
 /** Hash function selector and also result hash length indicator. */
 typedef enum {
 	HASH_MD5 =  16,
-	HASH_SHA1 = 20
+	HASH_SHA1 = 20,
+	HASH_SHA256 = 32,
+	HASH_SHA512 = 64
 } hash_func_t;
 
+/** Hash implementation selector. */
+typedef enum {
+	/** Portable implementation. */
+	HASH_IMPL_GENERIC,
+	/** SHA instruction set extension (amd64 SHA-256 only). */
+	HASH_IMPL_SHA_NI
+} hash_impl_t;
+
+/** Incremental hash computation context. */
+typedef struct {
+	hash_func_t func;
+	hash_impl_t impl;
+	/** Interim hash parts values. */
+	union {
+		uint32_t h32[HASH_MAX_LENGTH / 4];
+		uint64_t h64[HASH_MAX_LENGTH / 8];
+	} state;
+	/** Incomplete block of input data. */
+	uint8_t buffer[HASH_MAX_BLOCK_LENGTH];
+	size_t buffer_used;
+	/** Total length of input data. */
+	uint64_t length;
+} hash_ctx_t;
+
+/** AES implementation selector. */
+typedef enum {
+	/** Portable table-driven implementation. */
+	AES_IMPL_TABLE,
+	/** AES-NI instruction set extension (amd64 only). */
+	AES_IMPL_NI
+} aes_impl_t;
+
+/** AES-128 context with expanded encryption and decryption keys. */
+typedef struct {
+	uint32_t key_exp[AES_KEY_EXP_LENGTH] __attribute__((aligned(16)));
+	uint32_t key_dec[AES_KEY_EXP_LENGTH] __attribute__((aligned(16)));
+	aes_impl_t impl;
+} aes_ctx_t;
+
 extern errno_t rc4(uint8_t *, size_t, uint8_t *, size_t, size_t, uint8_t *);
 extern errno_t aes_encrypt(uint8_t *, uint8_t *, uint8_t *);
 extern errno_t aes_decrypt(uint8_t *, uint8_t *, uint8_t *);
+extern errno_t aes_init(aes_ctx_t *, const uint8_t *);
+extern errno_t aes_init_impl(aes_ctx_t *, const uint8_t *, aes_impl_t);
+extern void aes_encrypt_block(const aes_ctx_t *, const uint8_t *, uint8_t *);
+extern void aes_decrypt_block(const aes_ctx_t *, const uint8_t *, uint8_t *);
+extern errno_t aes_cbc_encrypt(const aes_ctx_t *, uint8_t *, const uint8_t *,
+    uint8_t *, size_t);
+extern errno_t aes_cbc_decrypt(const aes_ctx_t *, uint8_t *, const uint8_t *,
+    uint8_t *, size_t);
+extern void aes_ctr(const aes_ctx_t *, uint8_t *, const uint8_t *, uint8_t *,
+    size_t);
+extern size_t hash_block_length(hash_func_t);
+extern errno_t hash_init(hash_ctx_t *, hash_func_t);
+extern errno_t hash_init_impl(hash_ctx_t *, hash_func_t, hash_impl_t);
+extern void hash_update(hash_ctx_t *, const void *, size_t);
+extern void hash_final(hash_ctx_t *, uint8_t *);
 extern errno_t create_hash(uint8_t *, size_t, uint8_t *, hash_func_t);
 extern errno_t hmac(uint8_t *, size_t, uint8_t *, size_t, uint8_t *, hash_func_t);
 extern errno_t pbkdf2(uint8_t *, size_t, uint8_t *, size_t, uint8_t *);
@@ -0,0 +1,682 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @file hash.c
+ *
+ * Incremental cryptographic hash functions.
+ *
+ * MD5 (RFC 1321), SHA-1, SHA-256 and SHA-512 (FIPS 180-4) are computed
+ * using a context which is fed by arbitrarily sized chunks of data, so the
+ * message does not need to be held in memory as a whole. Whole blocks are
+ * compressed directly from the caller's buffer, only the incomplete tail
+ * is copied into the context.
+ *
+ * On amd64, SHA-256 uses the SHA extensions (including the vectorized
+ * message schedule) if the processor supports them.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <macros.h>
+#include <byteorder.h>
+#include "crypto.h"
+#ifdef CRYPTO_SHA_NI
+#include "sha_ni.h"
+#endif
+
+/** Right rotation for uint64_t. */
+#define rotr_uint64(val, shift) \
+	(((val) >> (shift)) | ((val) << (64 - (shift))))
+
+/** Length of MD5, SHA-1 and SHA-256 block. */
+#define BLOCK_LENGTH_32  64
+
+/** Length of SHA-512 block. */
+#define BLOCK_LENGTH_64  128
+
+/** Init values used in SHA-1 and MD5 functions. */
+static const uint32_t hash_init_values[] = {
+	0x67452301, 0xefcdab89, 0x98badcfe, 0x10325476, 0xc3d2e1f0
+};
+
+/** Init values used in SHA-256 function. */
+static const uint32_t sha256_init_values[] = {
+	0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+	0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/** Init values used in SHA-512 function. */
+static const uint64_t sha512_init_values[] = {
+	0x6a09e667f3bcc908, 0xbb67ae8584caa73b,
+	0x3c6ef372fe94f82b, 0xa54ff53a5f1d36f1,
+	0x510e527fade682d1, 0x9b05688c2b3e6c1f,
+	0x1f83d9abfb41bd6b, 0x5be0cd19137e2179
+};
+
+/** Shift amount array for MD5 algorithm. */
+static const uint32_t md5_shift[] = {
+	7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,  7, 12, 17, 22,
+	5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,  5,  9, 14, 20,
+	4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,  4, 11, 16, 23,
+	6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21,  6, 10, 15, 21
+};
+
+/** Substitution box for MD5 algorithm. */
+static const uint32_t md5_sbox[] = {
+	0xd76aa478, 0xe8c7b756, 0x242070db, 0xc1bdceee,
+	0xf57c0faf, 0x4787c62a, 0xa8304613, 0xfd469501,
+	0x698098d8, 0x8b44f7af, 0xffff5bb1, 0x895cd7be,
+	0x6b901122, 0xfd987193, 0xa679438e, 0x49b40821,
+	0xf61e2562, 0xc040b340, 0x265e5a51, 0xe9b6c7aa,
+	0xd62f105d, 0x02441453, 0xd8a1e681, 0xe7d3fbc8,
+	0x21e1cde6, 0xc33707d6, 0xf4d50d87, 0x455a14ed,
+	0xa9e3e905, 0xfcefa3f8, 0x676f02d9, 0x8d2a4c8a,
+	0xfffa3942, 0x8771f681, 0x6d9d6122, 0xfde5380c,
+	0xa4beea44, 0x4bdecfa9, 0xf6bb4b60, 0xbebfbc70,
+	0x289b7ec6, 0xeaa127fa, 0xd4ef3085, 0x04881d05,
+	0xd9d4d039, 0xe6db99e5, 0x1fa27cf8, 0xc4ac5665,
+	0xf4292244, 0x432aff97, 0xab9423a7, 0xfc93a039,
+	0x655b59c3, 0x8f0ccc92, 0xffeff47d, 0x85845dd1,
+	0x6fa87e4f, 0xfe2ce6e0, 0xa3014314, 0x4e0811a1,
+	0xf7537e82, 0xbd3af235, 0x2ad7d2bb, 0xeb86d391
+};
+
+/** Round constants for SHA-256 algorithm. */
+const uint32_t sha256_k[] __attribute__((aligned(16))) = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+	0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+	0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+	0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+	0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+	0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+	0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+	0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+	0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/** Round constants for SHA-512 algorithm. */
+static const uint64_t sha512_k[] = {
+	0x428a2f98d728ae22, 0x7137449123ef65cd,
+	0xb5c0fbcfec4d3b2f, 0xe9b5dba58189dbbc,
+	0x3956c25bf348b538, 0x59f111f1b605d019,
+	0x923f82a4af194f9b, 0xab1c5ed5da6d8118,
+	0xd807aa98a3030242, 0x12835b0145706fbe,
+	0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+	0x72be5d74f27b896f, 0x80deb1fe3b1696b1,
+	0x9bdc06a725c71235, 0xc19bf174cf692694,
+	0xe49b69c19ef14ad2, 0xefbe4786384f25e3,
+	0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65,
+	0x2de92c6f592b0275, 0x4a7484aa6ea6e483,
+	0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+	0x983e5152ee66dfab, 0xa831c66d2db43210,
+	0xb00327c898fb213f, 0xbf597fc7beef0ee4,
+	0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+	0x06ca6351e003826f, 0x142929670a0e6e70,
+	0x27b70a8546d22ffc, 0x2e1b21385c26c926,
+	0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+	0x650a73548baf63de, 0x766a0abb3c77b2a8,
+	0x81c2c92e47edaee6, 0x92722c851482353b,
+	0xa2bfe8a14cf10364, 0xa81a664bbc423001,
+	0xc24b8b70d0f89791, 0xc76c51a30654be30,
+	0xd192e819d6ef5218, 0xd69906245565a910,
+	0xf40e35855771202a, 0x106aa07032bbd1b8,
+	0x19a4c116b8d2d0c8, 0x1e376c085141ab53,
+	0x2748774cdf8eeb99, 0x34b0bcb5e19b48a8,
+	0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb,
+	0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3,
+	0x748f82ee5defb2fc, 0x78a5636f43172f60,
+	0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+	0x90befffa23631e28, 0xa4506cebde82bde9,
+	0xbef9a3f7b2c67915, 0xc67178f2e372532b,
+	0xca273eceea26619c, 0xd186b8c721c0c207,
+	0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178,
+	0x06f067aa72176fba, 0x0a637dc5a2c898a6,
+	0x113f9804bef90dae, 0x1b710b35131c471b,
+	0x28db77f523047d84, 0x32caab7b40c72493,
+	0x3c9ebe0a15c9bebc, 0x431d67c49c100d4c,
+	0x4cc5d4becb3e42b6, 0x597f299cfc657e2a,
+	0x5fcb6fab3ad6faec, 0x6c44198c4a475817
+};
+
+static inline uint32_t load_uint32_le(const uint8_t *data)
+{
+	uint32_t val;
+
+	memcpy(&val, data, sizeof(val));
+	return uint32_t_le2host(val);
+}
+
+static inline uint32_t load_uint32_be(const uint8_t *data)
+{
+	uint32_t val;
+
+	memcpy(&val, data, sizeof(val));
+	return uint32_t_be2host(val);
+}
+
+static inline uint64_t load_uint64_be(const uint8_t *data)
+{
+	uint64_t val;
+
+	memcpy(&val, data, sizeof(val));
+	return uint64_t_be2host(val);
+}
+
+/** Working procedure of MD5 cryptographic hash function.
+ *
+ * @param h      Working array with interim hash parts values.
+ * @param data   Input blocks.
+ * @param blocks Number of blocks.
+ *
+ */
+static void md5_blocks(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	uint32_t f, g, temp;
+	uint32_t w[HASH_MD5 / 4];
+	uint32_t m[16];
+
+	for (; blocks > 0; blocks--, data += BLOCK_LENGTH_32) {
+		for (size_t k = 0; k < 16; k++)
+			m[k] = load_uint32_le(data + 4 * k);
+
+		memcpy(w, h, sizeof(w));
+
+		for (size_t k = 0; k < 64; k++) {
+			if (k < 16) {
+				f = (w[1] & w[2]) | (~w[1] & w[3]);
+				g = k;
+			} else if (k < 32) {
+				f = (w[1] & w[3]) | (w[2] & ~w[3]);
+				g = (5 * k + 1) % 16;
+			} else if (k < 48) {
+				f = w[1] ^ w[2] ^ w[3];
+				g = (3 * k + 5) % 16;
+			} else {
+				f = w[2] ^ (w[1] | ~w[3]);
+				g = 7 * k % 16;
+			}
+
+			temp = w[3];
+			w[3] = w[2];
+			w[2] = w[1];
+			w[1] += rotl_uint32(w[0] + f + md5_sbox[k] + m[g],
+			    md5_shift[k]);
+			w[0] = temp;
+		}
+
+		for (size_t k = 0; k < HASH_MD5 / 4; k++)
+			h[k] += w[k];
+	}
+}
+
+/** One round of SHA-1 with given function value, constant and input word. */
+#define SHA1_ROUND(w, f, cf, word) \
+	do { \
+		uint32_t _temp = rotl_uint32((w)[0], 5) + (f) + (w)[4] + \
+		    (cf) + (word); \
+		(w)[4] = (w)[3]; \
+		(w)[3] = (w)[2]; \
+		(w)[2] = rotl_uint32((w)[1], 30); \
+		(w)[1] = (w)[0]; \
+		(w)[0] = _temp; \
+	} while (0)
+
+/** Working procedure of SHA-1 cryptographic hash function.
+ *
+ * @param h      Working array with interim hash parts values.
+ * @param data   Input blocks.
+ * @param blocks Number of blocks.
+ *
+ */
+static void sha1_blocks(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	uint32_t f;
+	uint32_t w[HASH_SHA1 / 4];
+	uint32_t sched_arr[80];
+
+	for (; blocks > 0; blocks--, data += BLOCK_LENGTH_32) {
+		for (size_t k = 0; k < 16; k++)
+			sched_arr[k] = load_uint32_be(data + 4 * k);
+
+		for (size_t k = 16; k < 80; k++) {
+			sched_arr[k] = rotl_uint32(
+			    sched_arr[k - 3] ^
+			    sched_arr[k - 8] ^
+			    sched_arr[k - 14] ^
+			    sched_arr[k - 16],
+			    1);
+		}
+
+		memcpy(w, h, sizeof(w));
+
+		/* The rounds are split by the function used */
+		for (size_t k = 0; k < 20; k++) {
+			f = (w[1] & w[2]) | (~w[1] & w[3]);
+			SHA1_ROUND(w, f, 0x5a827999, sched_arr[k]);
+		}
+
+		for (size_t k = 20; k < 40; k++) {
+			f = w[1] ^ w[2] ^ w[3];
+			SHA1_ROUND(w, f, 0x6ed9eba1, sched_arr[k]);
+		}
+
+		for (size_t k = 40; k < 60; k++) {
+			f = (w[1] & w[2]) | (w[1] & w[3]) | (w[2] & w[3]);
+			SHA1_ROUND(w, f, 0x8f1bbcdc, sched_arr[k]);
+		}
+
+		for (size_t k = 60; k < 80; k++) {
+			f = w[1] ^ w[2] ^ w[3];
+			SHA1_ROUND(w, f, 0xca62c1d6, sched_arr[k]);
+		}
+
+		for (size_t k = 0; k < HASH_SHA1 / 4; k++)
+			h[k] += w[k];
+	}
+}
+
+/** Working procedure of SHA-256 cryptographic hash function.
+ *
+ * @param h      Working array with interim hash parts values.
+ * @param data   Input blocks.
+ * @param blocks Number of blocks.
+ *
+ */
+static void sha256_blocks(uint32_t *h, const uint8_t *data, size_t blocks)
+{
+	uint32_t w[8];
+	uint32_t sched_arr[64];
+	uint32_t s0, s1, t1, t2;
+
+	for (; blocks > 0; blocks--, data += BLOCK_LENGTH_32) {
+		for (size_t k = 0; k < 16; k++)
+			sched_arr[k] = load_uint32_be(data + 4 * k);
+
+		for (size_t k = 16; k < 64; k++) {
+			s0 = rotr_uint32(sched_arr[k - 15], 7) ^
+			    rotr_uint32(sched_arr[k - 15], 18) ^
+			    (sched_arr[k - 15] >> 3);
+			s1 = rotr_uint32(sched_arr[k - 2], 17) ^
+			    rotr_uint32(sched_arr[k - 2], 19) ^
+			    (sched_arr[k - 2] >> 10);
+			sched_arr[k] = sched_arr[k - 16] + s0 +
+			    sched_arr[k - 7] + s1;
+		}
+
+		memcpy(w, h, sizeof(w));
+
+		for (size_t k = 0; k < 64; k++) {
+			s1 = rotr_uint32(w[4], 6) ^ rotr_uint32(w[4], 11) ^
+			    rotr_uint32(w[4], 25);
+			t1 = w[7] + s1 + ((w[4] & w[5]) ^ (~w[4] & w[6])) +
+			    sha256_k[k] + sched_arr[k];
+			s0 = rotr_uint32(w[0], 2) ^ rotr_uint32(w[0], 13) ^
+			    rotr_uint32(w[0], 22);
+			t2 = s0 + ((w[0] & w[1]) ^ (w[0] & w[2]) ^
+			    (w[1] & w[2]));
+
+			w[7] = w[6];
+			w[6] = w[5];
+			w[5] = w[4];
+			w[4] = w[3] + t1;
+			w[3] = w[2];
+			w[2] = w[1];
+			w[1] = w[0];
+			w[0] = t1 + t2;
+		}
+
+		for (size_t k = 0; k < 8; k++)
+			h[k] += w[k];
+	}
+}
+
+/** Working procedure of SHA-512 cryptographic hash function.
+ *
+ * @param h      Working array with interim hash parts values.
+ * @param data   Input blocks.
+ * @param blocks Number of blocks.
+ *
+ */
+static void sha512_blocks(uint64_t *h, const uint8_t *data, size_t blocks)
+{
+	uint64_t w[8];
+	uint64_t sched_arr[80];
+	uint64_t s0, s1, t1, t2;
+
+	for (; blocks > 0; blocks--, data += BLOCK_LENGTH_64) {
+		for (size_t k = 0; k < 16; k++)
+			sched_arr[k] = load_uint64_be(data + 8 * k);
+
+		for (size_t k = 16; k < 80; k++) {
+			s0 = rotr_uint64(sched_arr[k - 15], 1) ^
+			    rotr_uint64(sched_arr[k - 15], 8) ^
+			    (sched_arr[k - 15] >> 7);
+			s1 = rotr_uint64(sched_arr[k - 2], 19) ^
+			    rotr_uint64(sched_arr[k - 2], 61) ^
+			    (sched_arr[k - 2] >> 6);
+			sched_arr[k] = sched_arr[k - 16] + s0 +
+			    sched_arr[k - 7] + s1;
+		}
+
+		memcpy(w, h, sizeof(w));
+
+		for (size_t k = 0; k < 80; k++) {
+			s1 = rotr_uint64(w[4], 14) ^ rotr_uint64(w[4], 18) ^
+			    rotr_uint64(w[4], 41);
+			t1 = w[7] + s1 + ((w[4] & w[5]) ^ (~w[4] & w[6])) +
+			    sha512_k[k] + sched_arr[k];
+			s0 = rotr_uint64(w[0], 28) ^ rotr_uint64(w[0], 34) ^
+			    rotr_uint64(w[0], 39);
+			t2 = s0 + ((w[0] & w[1]) ^ (w[0] & w[2]) ^
+			    (w[1] & w[2]));
+
+			w[7] = w[6];
+			w[6] = w[5];
+			w[5] = w[4];
+			w[4] = w[3] + t1;
+			w[3] = w[2];
+			w[2] = w[1];
+			w[1] = w[0];
+			w[0] = t1 + t2;
+		}
+
+		for (size_t k = 0; k < 8; k++)
+			h[k] += w[k];
+	}
+}
+
+/** Compress whole blocks of data into the hash state.
+ *
+ * @param ctx    Hash context.
+ * @param data   Input blocks.
+ * @param blocks Number of blocks.
+ *
+ */
+static void hash_blocks(hash_ctx_t *ctx, const uint8_t *data, size_t blocks)
+{
+	switch (ctx->func) {
+	case HASH_MD5:
+		md5_blocks(ctx->state.h32, data, blocks);
+		break;
+	case HASH_SHA1:
+		sha1_blocks(ctx->state.h32, data, blocks);
+		break;
+	case HASH_SHA256:
+#ifdef CRYPTO_SHA_NI
+		if (ctx->impl == HASH_IMPL_SHA_NI) {
+			sha_ni_sha256_blocks(ctx->state.h32, data, blocks);
+			break;
+		}
+#endif
+		sha256_blocks(ctx->state.h32, data, blocks);
+		break;
+	case HASH_SHA512:
+		sha512_blocks(ctx->state.h64, data, blocks);
+		break;
+	}
+}
+
+/** Get block length of hash function.
+ *
+ * @param hash_sel Hash function selector.
+ *
+ * @return Length of the block processed by the compression function
+ *         (in bytes), or zero if the function is not known.
+ *
+ */
+size_t hash_block_length(hash_func_t hash_sel)
+{
+	switch (hash_sel) {
+	case HASH_MD5:
+	case HASH_SHA1:
+	case HASH_SHA256:
+		return BLOCK_LENGTH_32;
+	case HASH_SHA512:
+		return BLOCK_LENGTH_64;
+	}
+
+	return 0;
+}
+
+/** Initialize hash context using given implementation.
+ *
+ * @param ctx      Hash context.
+ * @param hash_sel Hash function selector.
+ * @param impl     Implementation to use.
+ *
+ * @return EINVAL when context not specified or hash function not known,
+ *         ENOTSUP when the implementation is not available for the hash
+ *         function, otherwise EOK.
+ *
+ */
+errno_t hash_init_impl(hash_ctx_t *ctx, hash_func_t hash_sel,
+    hash_impl_t impl)
+{
+	if ((!ctx) || (hash_block_length(hash_sel) == 0))
+		return EINVAL;
+
+	switch (impl) {
+	case HASH_IMPL_GENERIC:
+		break;
+	case HASH_IMPL_SHA_NI:
+#ifdef CRYPTO_SHA_NI
+		if ((hash_sel == HASH_SHA256) && (sha_ni_supported()))
+			break;
+#endif
+		return ENOTSUP;
+	default:
+		return EINVAL;
+	}
+
+	ctx->func = hash_sel;
+	ctx->impl = impl;
+	ctx->buffer_used = 0;
+	ctx->length = 0;
+
+	switch (hash_sel) {
+	case HASH_MD5:
+	case HASH_SHA1:
+		memcpy(ctx->state.h32, hash_init_values, hash_sel);
+		break;
+	case HASH_SHA256:
+		memcpy(ctx->state.h32, sha256_init_values, HASH_SHA256);
+		break;
+	case HASH_SHA512:
+		memcpy(ctx->state.h64, sha512_init_values, HASH_SHA512);
+		break;
+	}
+
+	return EOK;
+}
+
+/** Initialize hash context.
+ *
+ * The fastest implementation available is selected.
+ *
+ * @param ctx      Hash context.
+ * @param hash_sel Hash function selector.
+ *
+ * @return EINVAL when context not specified or hash function not known,
+ *         otherwise EOK.
+ *
+ */
+errno_t hash_init(hash_ctx_t *ctx, hash_func_t hash_sel)
+{
+	errno_t rc = hash_init_impl(ctx, hash_sel, HASH_IMPL_SHA_NI);
+	if (rc == ENOTSUP)
+		rc = hash_init_impl(ctx, hash_sel, HASH_IMPL_GENERIC);
+
+	return rc;
+}
+
+/** Feed data into hash context.
+ *
+ * @param ctx  Hash context.
+ * @param data Input data.
+ * @param size Size of the input data.
+ *
+ */
+void hash_update(hash_ctx_t *ctx, const void *data, size_t size)
+{
+	const uint8_t *input = data;
+	size_t block_length = hash_block_length(ctx->func);
+
+	ctx->length += size;
+
+	if (ctx->buffer_used > 0) {
+		size_t len = min(size, block_length - ctx->buffer_used);
+
+		memcpy(ctx->buffer + ctx->buffer_used, input, len);
+		ctx->buffer_used += len;
+		input += len;
+		size -= len;
+
+		if (ctx->buffer_used < block_length)
+			return;
+
+		hash_blocks(ctx, ctx->buffer, 1);
+		ctx->buffer_used = 0;
+	}
+
+	size_t blocks = size / block_length;
+	if (blocks > 0) {
+		hash_blocks(ctx, input, blocks);
+		input += blocks * block_length;
+		size -= blocks * block_length;
+	}
+
+	memcpy(ctx->buffer, input, size);
+	ctx->buffer_used = size;
+}
+
+/** Finish hash computation.
+ *
+ * The context needs to be initialized again to be reused.
+ *
+ * @param ctx    Hash context.
+ * @param output Result hash byte sequence (length given by the hash
+ *               function selector).
+ *
+ */
+void hash_final(hash_ctx_t *ctx, uint8_t *output)
+{
+	size_t block_length = hash_block_length(ctx->func);
+	size_t length_size = (ctx->func == HASH_SHA512) ? 16 : 8;
+	uint64_t bits_size = ctx->length * 8;
+
+	/* Append the padding bit and the message length in bits */
+	ctx->buffer[ctx->buffer_used++] = 0x80;
+
+	if (ctx->buffer_used > block_length - length_size) {
+		memset(ctx->buffer + ctx->buffer_used, 0,
+		    block_length - ctx->buffer_used);
+		hash_blocks(ctx, ctx->buffer, 1);
+		ctx->buffer_used = 0;
+	}
+
+	memset(ctx->buffer + ctx->buffer_used, 0,
+	    block_length - ctx->buffer_used);
+
+	if (ctx->func == HASH_MD5) {
+		bits_size = host2uint64_t_le(bits_size);
+		memcpy(ctx->buffer + block_length - 8, &bits_size, 8);
+	} else {
+		if (ctx->func == HASH_SHA512) {
+			uint64_t bits_high;
+
+			bits_high = host2uint64_t_be(ctx->length >> 61);
+			memcpy(ctx->buffer + block_length - 16, &bits_high, 8);
+		}
+
+		bits_size = host2uint64_t_be(bits_size);
+		memcpy(ctx->buffer + block_length - 8, &bits_size, 8);
+	}
+
+	hash_blocks(ctx, ctx->buffer, 1);
+
+	/* Copy hash parts into final result. */
+	if (ctx->func == HASH_SHA512) {
+		for (size_t i = 0; i < HASH_SHA512 / 8; i++) {
+			uint64_t val = host2uint64_t_be(ctx->state.h64[i]);
+			memcpy(output + i * sizeof(uint64_t), &val,
+			    sizeof(uint64_t));
+		}
+
+		return;
+	}
+
+	for (size_t i = 0; i < ctx->func / 4; i++) {
+		uint32_t val;
+
+		if (ctx->func == HASH_MD5)
+			val = host2uint32_t_le(ctx->state.h32[i]);
+		else
+			val = host2uint32_t_be(ctx->state.h32[i]);
+
+		memcpy(output + i * sizeof(uint32_t), &val, sizeof(uint32_t));
+	}
+}
+
+/** Create hash based on selected algorithm.
+ *
+ * @param input      Input message byte sequence.
+ * @param input_size Size of message sequence.
+ * @param output     Result hash byte sequence.
+ * @param hash_sel   Hash function selector.
+ *
+ * @return EINVAL when input not specified or hash function not known,
+ *         ENOMEM when pointer for output hash result
+ *         is not allocated, otherwise EOK.
+ *
+ */
+errno_t create_hash(uint8_t *input, size_t input_size, uint8_t *output,
+    hash_func_t hash_sel)
+{
+	if (!input)
+		return EINVAL;
+
+	if (!output)
+		return ENOMEM;
+
+	hash_ctx_t ctx;
+	errno_t rc = hash_init(&ctx, hash_sel);
+	if (rc != EOK)
+		return rc;
+
+	hash_update(&ctx, input, input_size);
+	hash_final(&ctx, output);
+
+	return EOK;
+}
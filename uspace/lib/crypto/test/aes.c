@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include "../crypto.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(aes);
+
+/** Key of the FIPS 197 appendix C.1 example */
+static const uint8_t fips_key[AES_CIPHER_LENGTH] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static const uint8_t fips_plain[AES_CIPHER_LENGTH] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff
+};
+
+static const uint8_t fips_cipher[AES_CIPHER_LENGTH] = {
+	0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+	0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a
+};
+
+/** Key of the NIST SP 800-38A examples */
+static const uint8_t sp_key[AES_CIPHER_LENGTH] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+static const uint8_t sp_plain[4 * AES_CIPHER_LENGTH] = {
+	0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+	0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+	0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+	0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+	0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+	0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+	0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+	0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+static const uint8_t sp_ecb[AES_CIPHER_LENGTH] = {
+	0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60,
+	0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97
+};
+
+static const uint8_t sp_cbc_iv[AES_CIPHER_LENGTH] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+static const uint8_t sp_cbc[4 * AES_CIPHER_LENGTH] = {
+	0x76, 0x49, 0xab, 0xac, 0x81, 0x19, 0xb2, 0x46,
+	0xce, 0xe9, 0x8e, 0x9b, 0x12, 0xe9, 0x19, 0x7d,
+	0x50, 0x86, 0xcb, 0x9b, 0x50, 0x72, 0x19, 0xee,
+	0x95, 0xdb, 0x11, 0x3a, 0x91, 0x76, 0x78, 0xb2,
+	0x73, 0xbe, 0xd6, 0xb8, 0xe3, 0xc1, 0x74, 0x3b,
+	0x71, 0x16, 0xe6, 0x9e, 0x22, 0x22, 0x95, 0x16,
+	0x3f, 0xf1, 0xca, 0xa1, 0x68, 0x1f, 0xac, 0x09,
+	0x12, 0x0e, 0xca, 0x30, 0x75, 0x86, 0xe1, 0xa7
+};
+
+static const uint8_t sp_ctr_counter[AES_CIPHER_LENGTH] = {
+	0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+	0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+static const uint8_t sp_ctr[4 * AES_CIPHER_LENGTH] = {
+	0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26,
+	0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+	0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff,
+	0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+	0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e,
+	0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+	0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1,
+	0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+/** Run known answer tests on a context initialized with given key. */
+static void check_block(aes_impl_t impl, const uint8_t *key,
+    const uint8_t *plain, const uint8_t *cipher)
+{
+	aes_ctx_t ctx;
+	uint8_t buf[AES_CIPHER_LENGTH];
+
+	errno_t rc = aes_init_impl(&ctx, key, impl);
+	if (rc == ENOTSUP)
+		return;
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	aes_encrypt_block(&ctx, plain, buf);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, cipher, AES_CIPHER_LENGTH));
+
+	aes_decrypt_block(&ctx, buf, buf);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, plain, AES_CIPHER_LENGTH));
+}
+
+/** Check CBC mode on the SP 800-38A example with given implementation. */
+static void check_cbc(aes_impl_t impl)
+{
+	aes_ctx_t ctx;
+	uint8_t iv[AES_CIPHER_LENGTH];
+	uint8_t buf[sizeof(sp_plain)];
+
+	errno_t rc = aes_init_impl(&ctx, sp_key, impl);
+	if (rc == ENOTSUP)
+		return;
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	memcpy(iv, sp_cbc_iv, sizeof(iv));
+	rc = aes_cbc_encrypt(&ctx, iv, sp_plain, buf, sizeof(buf));
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, sp_cbc, sizeof(buf)));
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(iv,
+	    sp_cbc + sizeof(sp_cbc) - AES_CIPHER_LENGTH, sizeof(iv)));
+
+	/* In place, split into two calls to check the chaining */
+	memcpy(iv, sp_cbc_iv, sizeof(iv));
+	rc = aes_cbc_decrypt(&ctx, iv, buf, buf, AES_CIPHER_LENGTH);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = aes_cbc_decrypt(&ctx, iv, buf + AES_CIPHER_LENGTH,
+	    buf + AES_CIPHER_LENGTH, sizeof(buf) - AES_CIPHER_LENGTH);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, sp_plain, sizeof(buf)));
+
+	rc = aes_cbc_encrypt(&ctx, iv, sp_plain, buf, AES_CIPHER_LENGTH - 1);
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, rc);
+}
+
+/** Check CTR mode on the SP 800-38A example with given implementation. */
+static void check_ctr(aes_impl_t impl)
+{
+	aes_ctx_t ctx;
+	uint8_t counter[AES_CIPHER_LENGTH];
+	uint8_t buf[sizeof(sp_plain)];
+
+	errno_t rc = aes_init_impl(&ctx, sp_key, impl);
+	if (rc == ENOTSUP)
+		return;
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	memcpy(counter, sp_ctr_counter, sizeof(counter));
+	aes_ctr(&ctx, counter, sp_plain, buf, sizeof(buf));
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, sp_ctr, sizeof(buf)));
+
+	/* The carry propagates into the next byte of the counter */
+	PCUT_ASSERT_INT_EQUALS(0xf0, counter[0]);
+	PCUT_ASSERT_INT_EQUALS(0xff, counter[14]);
+	PCUT_ASSERT_INT_EQUALS(0x03, counter[15]);
+
+	/* In place with a partial final block */
+	memcpy(counter, sp_ctr_counter, sizeof(counter));
+	aes_ctr(&ctx, counter, buf, buf, sizeof(buf) - 5);
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, sp_plain, sizeof(buf) - 5));
+}
+
+/** FIPS 197 appendix C.1 with the portable implementation */
+PCUT_TEST(fips197_table)
+{
+	check_block(AES_IMPL_TABLE, fips_key, fips_plain, fips_cipher);
+	check_block(AES_IMPL_TABLE, sp_key, sp_plain, sp_ecb);
+}
+
+/** FIPS 197 appendix C.1 with AES-NI (if available) */
+PCUT_TEST(fips197_ni)
+{
+	check_block(AES_IMPL_NI, fips_key, fips_plain, fips_cipher);
+	check_block(AES_IMPL_NI, sp_key, sp_plain, sp_ecb);
+}
+
+/** SP 800-38A F.2.1 and F.2.2 with the portable implementation */
+PCUT_TEST(cbc_table)
+{
+	check_cbc(AES_IMPL_TABLE);
+}
+
+/** SP 800-38A F.2.1 and F.2.2 with AES-NI (if available) */
+PCUT_TEST(cbc_ni)
+{
+	check_cbc(AES_IMPL_NI);
+}
+
+/** SP 800-38A F.5.1 with the portable implementation */
+PCUT_TEST(ctr_table)
+{
+	check_ctr(AES_IMPL_TABLE);
+}
+
+/** SP 800-38A F.5.1 with AES-NI (if available) */
+PCUT_TEST(ctr_ni)
+{
+	check_ctr(AES_IMPL_NI);
+}
+
+/** Single block functions without a context */
+PCUT_TEST(legacy)
+{
+	uint8_t key[AES_CIPHER_LENGTH];
+	uint8_t plain[AES_CIPHER_LENGTH];
+	uint8_t buf[AES_CIPHER_LENGTH];
+
+	memcpy(key, fips_key, sizeof(key));
+	memcpy(plain, fips_plain, sizeof(plain));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, aes_encrypt(key, plain, buf));
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, fips_cipher, sizeof(buf)));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, aes_decrypt(key, buf, buf));
+	PCUT_ASSERT_INT_EQUALS(0, memcmp(buf, fips_plain, sizeof(buf)));
+
+	PCUT_ASSERT_ERRNO_VAL(EINVAL, aes_encrypt(NULL, plain, buf));
+	PCUT_ASSERT_ERRNO_VAL(ENOMEM, aes_decrypt(key, plain, NULL));
+}
+
+PCUT_EXPORT(aes);
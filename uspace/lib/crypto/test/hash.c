@@ -0,0 +1,304 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <str.h>
+#include "../crypto.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(hash);
+
+typedef struct {
+	hash_func_t func;
+	const char *msg;
+	const char *digest;
+} hash_test_t;
+
+/** Message of the FIPS 180-4 two block examples */
+#define MSG_448  "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"
+
+static hash_test_t hash_tests[] = {
+	{ HASH_MD5, "", "d41d8cd98f00b204e9800998ecf8427e" },
+	{ HASH_MD5, "abc", "900150983cd24fb0d6963f7d28e17f72" },
+	{ HASH_MD5, MSG_448, "8215ef0796a20bcaaae116d3876c664a" },
+	{
+		HASH_SHA1, "",
+		"da39a3ee5e6b4b0d3255bfef95601890afd80709"
+	},
+	{
+		HASH_SHA1, "abc",
+		"a9993e364706816aba3e25717850c26c9cd0d89d"
+	},
+	{
+		HASH_SHA1, MSG_448,
+		"84983e441c3bd26ebaae4aa1f95129e5e54670f1"
+	},
+	{
+		HASH_SHA256, "",
+		"e3b0c44298fc1c149afbf4c8996fb924"
+		"27ae41e4649b934ca495991b7852b855"
+	},
+	{
+		HASH_SHA256, "abc",
+		"ba7816bf8f01cfea414140de5dae2223"
+		"b00361a396177a9cb410ff61f20015ad"
+	},
+	{
+		HASH_SHA256, MSG_448,
+		"248d6a61d20638b8e5c026930c3e6039"
+		"a33ce45964ff2167f6ecedd419db06c1"
+	},
+	{
+		HASH_SHA512, "",
+		"cf83e1357eefb8bdf1542850d66d8007"
+		"d620e4050b5715dc83f4a921d36ce9ce"
+		"47d0d13c5d85f2b0ff8318d2877eec2f"
+		"63b931bd47417a81a538327af927da3e"
+	},
+	{
+		HASH_SHA512, "abc",
+		"ddaf35a193617abacc417349ae204131"
+		"12e6fa4e89a97ea20a9eeee64b55d39a"
+		"2192992a274fc1a836ba3c23a3feebbd"
+		"454d4423643ce80e2a9ac94fa54ca49f"
+	},
+	{
+		HASH_SHA512, MSG_448,
+		"204a8fc6dda82f0a0ced7beb8e08a416"
+		"57c16ef468b228a8279be331a703c335"
+		"96fd15c13b1b07f9aa1d3bea57789ca0"
+		"31ad85c7a71dd70354ec631238ca3445"
+	}
+};
+
+/** Digests of one million repetitions of 'a' */
+static hash_test_t million_tests[] = {
+	{ HASH_MD5, "a", "7707d6ae4e027c70eea2a935c2296f21" },
+	{
+		HASH_SHA1, "a",
+		"34aa973cd4c4daa4f61eeb2bdbad27316534016f"
+	},
+	{
+		HASH_SHA256, "a",
+		"cdc76e5c9914fb9281a1c7e284d73e67"
+		"f1809a48a497200e046d39ccc7112cd0"
+	},
+	{
+		HASH_SHA512, "a",
+		"e718483d0ce769644e2e42c7bc15b463"
+		"8e1f98b13b2044285632a803afa973eb"
+		"de0ff244877ea60a4cb0432ce577c31b"
+		"eb009c5c2c49aa2e4eadb217ad8cc09b"
+	}
+};
+
+/** Message length of the million tests */
+#define MILLION  1000000
+
+/** Size of the chunks the million tests are fed in (not block aligned) */
+#define CHUNK_SIZE  997
+
+/** Compare binary digest with its hexadecimal representation. */
+static bool digest_equals(const uint8_t *digest, size_t size,
+    const char *hex)
+{
+	static const char digits[] = "0123456789abcdef";
+
+	if (str_size(hex) != size * 2)
+		return false;
+
+	for (size_t i = 0; i < size; i++) {
+		if ((hex[2 * i] != digits[digest[i] >> 4]) ||
+		    (hex[2 * i + 1] != digits[digest[i] & 0x0f]))
+			return false;
+	}
+
+	return true;
+}
+
+/** Check the known answers using given implementation. */
+static void check_known(hash_impl_t impl)
+{
+	uint8_t digest[HASH_MAX_LENGTH];
+	hash_ctx_t ctx;
+
+	for (size_t i = 0; i < sizeof(hash_tests) / sizeof(hash_test_t);
+	    i++) {
+		hash_test_t *test = &hash_tests[i];
+
+		errno_t rc = hash_init_impl(&ctx, test->func, impl);
+		if (rc == ENOTSUP)
+			continue;
+
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		hash_update(&ctx, test->msg, str_size(test->msg));
+		hash_final(&ctx, digest);
+
+		PCUT_ASSERT_TRUE(digest_equals(digest, test->func,
+		    test->digest));
+	}
+}
+
+/** Check the million tests using given implementation. */
+static void check_million(hash_impl_t impl)
+{
+	uint8_t chunk[CHUNK_SIZE];
+	uint8_t digest[HASH_MAX_LENGTH];
+	hash_ctx_t ctx;
+
+	memset(chunk, 'a', sizeof(chunk));
+
+	for (size_t i = 0; i < sizeof(million_tests) / sizeof(hash_test_t);
+	    i++) {
+		hash_test_t *test = &million_tests[i];
+
+		errno_t rc = hash_init_impl(&ctx, test->func, impl);
+		if (rc == ENOTSUP)
+			continue;
+
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+		for (size_t done = 0; done < MILLION; done += CHUNK_SIZE) {
+			size_t len = MILLION - done;
+			if (len > CHUNK_SIZE)
+				len = CHUNK_SIZE;
+
+			hash_update(&ctx, chunk, len);
+		}
+
+		hash_final(&ctx, digest);
+
+		PCUT_ASSERT_TRUE(digest_equals(digest, test->func,
+		    test->digest));
+	}
+}
+
+/** FIPS 180-4 and RFC 1321 examples with the portable implementation */
+PCUT_TEST(known_generic)
+{
+	check_known(HASH_IMPL_GENERIC);
+}
+
+/** FIPS 180-4 examples with the SHA extensions (if available) */
+PCUT_TEST(known_sha_ni)
+{
+	check_known(HASH_IMPL_SHA_NI);
+}
+
+/** Long message fed in chunks with the portable implementation */
+PCUT_TEST(million_generic)
+{
+	check_million(HASH_IMPL_GENERIC);
+}
+
+/** Long message fed in chunks with the SHA extensions (if available) */
+PCUT_TEST(million_sha_ni)
+{
+	check_million(HASH_IMPL_SHA_NI);
+}
+
+/** Feeding data byte by byte gives the same result as the one-shot hash */
+PCUT_TEST(byte_by_byte)
+{
+	static const hash_func_t funcs[] = {
+		HASH_MD5, HASH_SHA1, HASH_SHA256, HASH_SHA512
+	};
+
+	uint8_t data[300];
+	uint8_t digest[HASH_MAX_LENGTH];
+	uint8_t ref[HASH_MAX_LENGTH];
+	hash_ctx_t ctx;
+
+	for (size_t i = 0; i < sizeof(data); i++)
+		data[i] = i * 31 + 7;
+
+	for (size_t i = 0; i < sizeof(funcs) / sizeof(hash_func_t); i++) {
+		PCUT_ASSERT_ERRNO_VAL(EOK, create_hash(data, sizeof(data),
+		    ref, funcs[i]));
+
+		PCUT_ASSERT_ERRNO_VAL(EOK, hash_init(&ctx, funcs[i]));
+
+		for (size_t j = 0; j < sizeof(data); j++)
+			hash_update(&ctx, data + j, 1);
+
+		hash_final(&ctx, digest);
+
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(digest, ref, funcs[i]));
+	}
+}
+
+/** HMAC examples from RFC 2202 and RFC 4231 */
+PCUT_TEST(hmac_known)
+{
+	uint8_t key[] = "Jefe";
+	uint8_t msg[] = "what do ya want for nothing?";
+	uint8_t long_key[131];
+	uint8_t long_msg[] =
+	    "Test Using Larger Than Block-Size Key - Hash Key First";
+	uint8_t digest[HASH_MAX_LENGTH];
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, hmac(key, 4, msg, 28, digest, HASH_MD5));
+	PCUT_ASSERT_TRUE(digest_equals(digest, HASH_MD5,
+	    "750c783e6ab0b503eaa86e310a5db738"));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, hmac(key, 4, msg, 28, digest, HASH_SHA1));
+	PCUT_ASSERT_TRUE(digest_equals(digest, HASH_SHA1,
+	    "effcdf6ae5eb2fa2d27416d5f184df9c259a7c79"));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, hmac(key, 4, msg, 28, digest,
+	    HASH_SHA256));
+	PCUT_ASSERT_TRUE(digest_equals(digest, HASH_SHA256,
+	    "5bdcc146bf60754e6a042426089575c7"
+	    "5a003f089d2739839dec58b964ec3843"));
+
+	PCUT_ASSERT_ERRNO_VAL(EOK, hmac(key, 4, msg, 28, digest,
+	    HASH_SHA512));
+	PCUT_ASSERT_TRUE(digest_equals(digest, HASH_SHA512,
+	    "164b7a7bfcf819e2e395fbe73b56e0a3"
+	    "87bd64222e831fd610270cd7ea250554"
+	    "9758bf75c05a994a6d034f65f8f0e6fd"
+	    "caeab1a34d4a6b4b636e070a38bce737"));
+
+	/* The key is longer than the SHA-512 block */
+	memset(long_key, 0xaa, sizeof(long_key));
+	PCUT_ASSERT_ERRNO_VAL(EOK, hmac(long_key, sizeof(long_key), long_msg,
+	    sizeof(long_msg) - 1, digest, HASH_SHA512));
+	PCUT_ASSERT_TRUE(digest_equals(digest, HASH_SHA512,
+	    "80b24263c7c1a3ebb71493c1dd7be8b4"
+	    "9b46d1f41b4aeec1121b013783f8f352"
+	    "6b56d037e05f2598bd0fd2215d6a1e52"
+	    "95e64f73f63f0aec8b915a985d786598"));
+}
+
+PCUT_EXPORT(hash);
@@ -35,10 +35,14 @@
 
 #include <assert.h>
 #include <adt/list.h>
+#include <macros.h>
 #include <stdlib.h>
 
 #include "drawctx.h"
 
+/** Number of pixels determined and composed at once by the row path. */
+#define TRANSFER_CHUNK  256
+
 void drawctx_init(drawctx_t *context, surface_t *surface)
 {
 	assert(surface);
@@ -147,6 +151,45 @@ void drawctx_transfer(drawctx_t *context,
 		}
 		surface_add_damaged_region(context->surface, x, y, width, height);
 
+	} else if ((context->shall_clip == false) && (context->mask == NULL)) {
+
+		surface_coord_t surface_width;
+		surface_coord_t surface_height;
+		surface_get_resolution(context->surface, &surface_width,
+		    &surface_height);
+		if ((x >= surface_width) || (y >= surface_height))
+			return;
+
+		width = min(width, surface_width - x);
+		height = min(height, surface_height - y);
+
+		/* Determine and compose the pixels in row chunks. */
+		compose_row_t compose_row = compose_get_row(context->compose);
+		pixel_t row[TRANSFER_CHUNK];
+
+		for (sysarg_t _y = y; _y < y + height; ++_y) {
+			pixel_t *dst = pixelmap_pixel_at(
+			    surface_pixmap_access(context->surface), x, _y);
+
+			for (sysarg_t done = 0; done < width; ) {
+				size_t count = min(width - done, TRANSFER_CHUNK);
+				source_determine_row(context->source, x + done, _y,
+				    row, count);
+
+				if (compose_row != NULL) {
+					compose_row(dst + done, row, count);
+				} else {
+					for (size_t i = 0; i < count; i++) {
+						dst[done + i] = context->compose(row[i],
+						    dst[done + i]);
+					}
+				}
+
+				done += count;
+			}
+		}
+		surface_add_damaged_region(context->surface, x, y, width, height);
+
 	} else {
 
 		bool clipped = false;
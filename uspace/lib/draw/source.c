@@ -34,6 +34,8 @@
  */
 
 #include <assert.h>
+#include <macros.h>
+#include <mem.h>
 
 #include "source.h"
 
@@ -148,5 +150,109 @@ pixel_t source_determine_pixel(source_t *source, double x, double y)
 	}
 }
 
+/** Copy a row of texture pixels translated by an integer offset.
+ *
+ * @param source Source with a texture and a fast transformation.
+ * @param x      Horizontal coordinate of the first pixel.
+ * @param y      Vertical coordinate of the row.
+ * @param row    Row receiving the pixels.
+ * @param count  Number of pixels.
+ */
+static void source_copy_row(source_t *source, double x, double y,
+    pixel_t *row, size_t count)
+{
+	pixelmap_t *pixmap = surface_pixmap_access(source->texture);
+
+	native_t tx = (native_t) (x + source->transform.matrix[0][2]);
+	native_t ty = (native_t) (y + source->transform.matrix[1][2]);
+
+	/* Determine the part of the row lying inside of the texture. */
+	size_t first = count;
+	size_t last = count;
+
+	if ((ty >= 0) && ((sysarg_t) ty < pixmap->height)) {
+		native_t lo = max(tx, 0);
+		native_t hi = min(tx + (native_t) count, (native_t) pixmap->width);
+
+		if (lo < hi) {
+			first = lo - tx;
+			last = hi - tx;
+		}
+	}
+
+	for (size_t i = 0; i < first; i++) {
+		row[i] = pixelmap_get_extended_pixel(pixmap, tx + i, ty,
+		    source->texture_extend);
+	}
+
+	if (last > first) {
+		memcpy(row + first, pixelmap_pixel_at(pixmap, tx + first, ty),
+		    (last - first) * sizeof(pixel_t));
+	}
+
+	for (size_t i = last; i < count; i++) {
+		row[i] = pixelmap_get_extended_pixel(pixmap, tx + i, ty,
+		    source->texture_extend);
+	}
+}
+
+/** Determine a row of source pixels.
+ *
+ * The result is the same as of calling source_determine_pixel() for
+ * @a count horizontally adjacent pixels. Textures without a mask are
+ * sampled row by row, copying them directly if the transformation is
+ * a mere integer translation.
+ *
+ * @param source Source.
+ * @param x      Horizontal coordinate of the first pixel.
+ * @param y      Vertical coordinate of the row.
+ * @param row    Row receiving the pixels.
+ * @param count  Number of pixels.
+ */
+void source_determine_row(source_t *source, double x, double y,
+    pixel_t *row, size_t count)
+{
+	if ((source->mask != NULL) || (source->texture == NULL)) {
+		for (size_t i = 0; i < count; i++)
+			row[i] = source_determine_pixel(source, x + i, y);
+		return;
+	}
+
+	unsigned int alpha = ALPHA(source->alpha);
+	if (alpha == 0) {
+		memset(row, 0, count * sizeof(pixel_t));
+		return;
+	}
+
+	if (transform_is_fast(&source->transform)) {
+		source_copy_row(source, x, y, row, count);
+	} else {
+		pixelmap_t *pixmap = surface_pixmap_access(source->texture);
+		filter_row_t filter_row = filter_get_row(source->filter);
+
+		/* Step of texture coordinates per destination pixel. */
+		double dx = source->transform.matrix[0][0];
+		double dy = source->transform.matrix[1][0];
+		transform_apply_affine(&source->transform, &x, &y);
+
+		if (filter_row != NULL) {
+			filter_row(pixmap, x, y, dx, dy, source->texture_extend,
+			    row, count);
+		} else {
+			for (size_t i = 0; i < count; i++) {
+				row[i] = source->filter(pixmap, x + i * dx,
+				    y + i * dy, source->texture_extend);
+			}
+		}
+	}
+
+	if (alpha < 255) {
+		for (size_t i = 0; i < count; i++) {
+			row[i] = (row[i] & 0x00ffffff) |
+			    (((ALPHA(row[i]) * alpha) / 255) << 24);
+		}
+	}
+}
+
 /** @}
  */
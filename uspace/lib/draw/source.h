@@ -37,6 +37,7 @@
 #define DRAW_SOURCE_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 
 #include <transform.h>
 #include <filter.h>
@@ -73,6 +74,8 @@ extern void source_set_mask(source_t *, surface_t *, pixelmap_extend_t);
 extern bool source_is_fast(source_t *);
 extern pixel_t *source_direct_access(source_t *, double, double);
 extern pixel_t source_determine_pixel(source_t *, double, double);
+extern void source_determine_row(source_t *, double, double, pixel_t *,
+    size_t);
 
 #endif
 
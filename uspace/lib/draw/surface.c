@@ -96,7 +96,9 @@ void surface_destroy(surface_t *surface)
 {
 	pixel_t *pixbuf = surface->pixmap.data;
 
-	if ((surface->flags & SURFACE_FLAG_SHARED) == SURFACE_FLAG_SHARED)
+	if ((surface->flags & SURFACE_FLAG_EXTERNAL) == SURFACE_FLAG_EXTERNAL) {
+		/* The caller owns the pixel buffer. */
+	} else if ((surface->flags & SURFACE_FLAG_SHARED) == SURFACE_FLAG_SHARED)
 		as_area_destroy((void *) pixbuf);
 	else
 		free(pixbuf);
@@ -47,7 +47,9 @@ typedef sysarg_t surface_coord_t;
 
 typedef enum {
 	SURFACE_FLAG_NONE = 0,
-	SURFACE_FLAG_SHARED = 1
+	SURFACE_FLAG_SHARED = 1,
+	/** Pixel buffer is owned by the caller and is not freed on destroy. */
+	SURFACE_FLAG_EXTERNAL = 2
 } surface_flags_t;
 
 extern surface_t *surface_create(surface_coord_t, surface_coord_t, pixel_t *, surface_flags_t);
@@ -59,8 +59,10 @@
 
 static errno_t ext4_read_directory(ipc_call_t *, aoff64_t, size_t,
     ext4_instance_t *, ext4_inode_ref_t *, size_t *);
-static errno_t ext4_read_file(ipc_call_t *, aoff64_t, size_t, ext4_instance_t *,
-    ext4_inode_ref_t *, size_t *);
+static errno_t ext4_read_file(ipc_call_t *, void *, aoff64_t, size_t,
+    ext4_instance_t *, ext4_inode_ref_t *, size_t *);
+static errno_t ext4_write_file(ipc_call_t *, const void *, aoff64_t, size_t,
+    ext4_node_t *, size_t *);
 static bool ext4_is_dots(const uint8_t *, size_t);
 static errno_t ext4_instance_get(service_id_t, ext4_instance_t **);
 
@@ -1045,7 +1047,7 @@ static errno_t ext4_read(service_id_t service_id, fs_index_t index, aoff64_t pos
 	/* Read from i-node by type */
 	if (ext4_inode_is_type(inst->filesystem->superblock, inode_ref->inode,
 	    EXT4_INODE_MODE_FILE)) {
-		rc = ext4_read_file(&call, pos, size, inst, inode_ref,
+		rc = ext4_read_file(&call, NULL, pos, size, inst, inode_ref,
 		    rbytes);
 	} else if (ext4_inode_is_type(inst->filesystem->superblock,
 	    inode_ref->inode, EXT4_INODE_MODE_DIRECTORY)) {
@@ -1174,7 +1176,8 @@ errno_t ext4_read_directory(ipc_call_t *call, aoff64_t pos, size_t size,
 
 /** Read data from file.
  *
- * @param call      IPC call
+ * @param call      IPC call or NULL
+ * @param dst       Destination buffer used if @a call is NULL
  * @param pos       Position to start reading from
  * @param size      How many bytes to read
  * @param inst      Filesystem instance
@@ -1184,7 +1187,7 @@ errno_t ext4_read_directory(ipc_call_t *call, aoff64_t pos, size_t size,
  * @return Error code
  *
  */
-errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
+errno_t ext4_read_file(ipc_call_t *call, void *dst, aoff64_t pos, size_t size,
     ext4_instance_t *inst, ext4_inode_ref_t *inode_ref, size_t *rbytes)
 {
 	ext4_superblock_t *sb = inst->filesystem->superblock;
@@ -1192,7 +1195,8 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 
 	if (pos >= file_size) {
 		/* Read 0 bytes successfully */
-		async_data_read_finalize(call, NULL, 0);
+		if (call != NULL)
+			async_data_read_finalize(call, NULL, 0);
 		*rbytes = 0;
 		return EOK;
 	}
@@ -1212,7 +1216,8 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 	errno_t rc = ext4_filesystem_get_inode_data_block_index(inode_ref,
 	    file_block, &fs_block);
 	if (rc != EOK) {
-		async_answer_0(call, rc);
+		if (call != NULL)
+			async_answer_0(call, rc);
 		return rc;
 	}
 
@@ -1223,7 +1228,11 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 	 * file and we need to return a buffer of zeros
 	 */
 	uint8_t *buffer;
-	if (fs_block == 0) {
+	if (fs_block == 0 && call == NULL) {
+		memset(dst, 0, bytes);
+		*rbytes = bytes;
+		return EOK;
+	} else if (fs_block == 0) {
 		buffer = malloc(bytes);
 		if (buffer == NULL) {
 			async_answer_0(call, ENOMEM);
@@ -1243,12 +1252,18 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 	block_t *block;
 	rc = block_get(&block, inst->service_id, fs_block, BLOCK_FLAGS_NONE);
 	if (rc != EOK) {
-		async_answer_0(call, rc);
+		if (call != NULL)
+			async_answer_0(call, rc);
 		return rc;
 	}
 
 	assert(offset_in_block + bytes <= block_size);
-	rc = async_data_read_finalize(call, block->data + offset_in_block, bytes);
+	if (call != NULL) {
+		rc = async_data_read_finalize(call,
+		    block->data + offset_in_block, bytes);
+	} else {
+		memcpy(dst, block->data + offset_in_block, bytes);
+	}
 	if (rc != EOK) {
 		block_put(block);
 		return rc;
@@ -1262,36 +1277,23 @@ errno_t ext4_read_file(ipc_call_t *call, aoff64_t pos, size_t size,
 	return EOK;
 }
 
-/** Write bytes to file
+/** Write at most one block of data to file.
  *
- * @param service_id Device identifier
- * @param index      I-node number of file
- * @param pos        Position in file to start reading from
- * @param wbytes     Output value - real number of written bytes
- * @param nsize      Output value - new size of i-node
+ * @param call      IPC call or NULL
+ * @param src       Source buffer used if @a call is NULL
+ * @param pos       Position to start writing at
+ * @param len       How many bytes to write
+ * @param enode     Node to write data to
+ * @param wbytes    Output value to return real number of bytes written
  *
  * @return Error code
  *
  */
-static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
-    size_t *wbytes, aoff64_t *nsize)
+errno_t ext4_write_file(ipc_call_t *call, const void *src, aoff64_t pos,
+    size_t len, ext4_node_t *enode, size_t *wbytes)
 {
-	fs_node_t *fn;
-	errno_t rc2;
-	errno_t rc = ext4_node_get(&fn, service_id, index);
-	if (rc != EOK)
-		return rc;
-
-	ipc_call_t call;
-	size_t len;
-	if (!async_data_write_receive(&call, &len)) {
-		rc = EINVAL;
-		async_answer_0(&call, rc);
-		goto exit;
-	}
-
-	ext4_node_t *enode = EXT4_NODE(fn);
 	ext4_filesystem_t *fs = enode->instance->filesystem;
+	errno_t rc;
 
 	uint32_t block_size = ext4_superblock_get_block_size(fs->superblock);
 
@@ -1309,10 +1311,8 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 	ext4_inode_ref_t *inode_ref = enode->inode_ref;
 	rc = ext4_filesystem_get_inode_data_block_index(inode_ref, iblock,
 	    &fblock);
-	if (rc != EOK) {
-		async_answer_0(&call, rc);
-		goto exit;
-	}
+	if (rc != EOK)
+		goto error;
 
 	/* Check for sparse file */
 	if (fblock == 0) {
@@ -1326,31 +1326,24 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 			while (last_iblock < iblock) {
 				rc = ext4_extent_append_block(inode_ref, &last_iblock,
 				    &fblock, true);
-				if (rc != EOK) {
-					async_answer_0(&call, rc);
-					goto exit;
-				}
+				if (rc != EOK)
+					goto error;
 			}
 
 			rc = ext4_extent_append_block(inode_ref, &last_iblock,
 			    &fblock, false);
-			if (rc != EOK) {
-				async_answer_0(&call, rc);
-				goto exit;
-			}
+			if (rc != EOK)
+				goto error;
 		} else {
 			rc = ext4_balloc_alloc_block(inode_ref, &fblock);
-			if (rc != EOK) {
-				async_answer_0(&call, rc);
-				goto exit;
-			}
+			if (rc != EOK)
+				goto error;
 
 			rc = ext4_filesystem_set_inode_data_block_index(inode_ref,
 			    iblock, fblock);
 			if (rc != EOK) {
 				ext4_balloc_free_block(inode_ref, fblock);
-				async_answer_0(&call, rc);
-				goto exit;
+				goto error;
 			}
 		}
 
@@ -1360,27 +1353,30 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 
 	/* Load target block */
 	block_t *write_block;
-	rc = block_get(&write_block, service_id, fblock, flags);
-	if (rc != EOK) {
-		async_answer_0(&call, rc);
-		goto exit;
-	}
+	rc = block_get(&write_block, enode->instance->service_id, fblock,
+	    flags);
+	if (rc != EOK)
+		goto error;
 
 	if (flags == BLOCK_FLAGS_NOREAD)
 		memset(write_block->data, 0, block_size);
 
-	rc = async_data_write_finalize(&call, write_block->data +
-	    (pos % block_size), bytes);
-	if (rc != EOK) {
-		block_put(write_block);
-		goto exit;
+	if (call != NULL) {
+		rc = async_data_write_finalize(call, write_block->data +
+		    (pos % block_size), bytes);
+		if (rc != EOK) {
+			block_put(write_block);
+			return rc;
+		}
+	} else {
+		memcpy(write_block->data + (pos % block_size), src, bytes);
 	}
 
 	write_block->dirty = true;
 
 	rc = block_put(write_block);
 	if (rc != EOK)
-		goto exit;
+		return rc;
 
 	/* Do some counting */
 	uint32_t old_inode_size = ext4_inode_get_size(fs->superblock,
@@ -1390,8 +1386,182 @@ static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t po
 		inode_ref->dirty = true;
 	}
 
-	*nsize = ext4_inode_get_size(fs->superblock, inode_ref->inode);
 	*wbytes = bytes;
+	return EOK;
+
+error:
+	if (call != NULL)
+		async_answer_0(call, rc);
+	return rc;
+}
+
+/** Write bytes to file
+ *
+ * @param service_id Device identifier
+ * @param index      I-node number of file
+ * @param pos        Position in file to start reading from
+ * @param wbytes     Output value - real number of written bytes
+ * @param nsize      Output value - new size of i-node
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
+    size_t *wbytes, aoff64_t *nsize)
+{
+	fs_node_t *fn;
+	errno_t rc2;
+	errno_t rc = ext4_node_get(&fn, service_id, index);
+	if (rc != EOK)
+		return rc;
+
+	ipc_call_t call;
+	size_t len;
+	if (!async_data_write_receive(&call, &len)) {
+		rc = EINVAL;
+		async_answer_0(&call, rc);
+		goto exit;
+	}
+
+	ext4_node_t *enode = EXT4_NODE(fn);
+	ext4_filesystem_t *fs = enode->instance->filesystem;
+
+	rc = ext4_write_file(&call, NULL, pos, len, enode, wbytes);
+	if (rc != EOK)
+		goto exit;
+
+	*nsize = ext4_inode_get_size(fs->superblock, enode->inode_ref->inode);
+
+exit:
+	rc2 = ext4_node_put(fn);
+	return rc == EOK ? rc2 : rc;
+}
+
+/** Read data from several extents of a file.
+ *
+ * Reading stops at the end of file.
+ *
+ * @param service_id Device identifier
+ * @param index      I-node number of file
+ * @param ext        Extents to read
+ * @param cnt        Number of extents
+ * @param buf        Buffer for the data of all extents
+ * @param rbytes     Output value - real number of read bytes
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_readv(service_id_t service_id, fs_index_t index,
+    const vfs_extent_t *ext, size_t cnt, void *buf, size_t *rbytes)
+{
+	ext4_instance_t *inst;
+	errno_t rc = ext4_instance_get(service_id, &inst);
+	if (rc != EOK)
+		return rc;
+
+	/* Load i-node */
+	ext4_inode_ref_t *inode_ref;
+	rc = ext4_filesystem_get_inode_ref(inst->filesystem, index, &inode_ref);
+	if (rc != EOK)
+		return rc;
+
+	if (!ext4_inode_is_type(inst->filesystem->superblock, inode_ref->inode,
+	    EXT4_INODE_MODE_FILE)) {
+		ext4_filesystem_put_inode_ref(inode_ref);
+		return EINVAL;
+	}
+
+	size_t done = 0;
+	for (size_t i = 0; i < cnt; i++) {
+		size_t off = 0;
+
+		while (off < ext[i].size) {
+			size_t bytes;
+
+			rc = ext4_read_file(NULL, (uint8_t *) buf + done,
+			    ext[i].pos + off, ext[i].size - off, inst,
+			    inode_ref, &bytes);
+			if (rc != EOK)
+				goto exit;
+
+			/* End of file */
+			if (bytes == 0)
+				goto exit;
+
+			off += bytes;
+			done += bytes;
+		}
+	}
+
+exit:
+	*rbytes = done;
+
+	errno_t const rc2 = ext4_filesystem_put_inode_ref(inode_ref);
+
+	return rc == EOK ? rc2 : rc;
+}
+
+/** Write data to several extents of a file.
+ *
+ * @param service_id Device identifier
+ * @param index      I-node number of file
+ * @param ext        Extents to write
+ * @param cnt        Number of extents
+ * @param buf        Data of all extents
+ * @param wbytes     Output value - real number of written bytes
+ * @param nsize      Output value - new size of i-node
+ *
+ * @return Error code
+ *
+ */
+static errno_t ext4_writev(service_id_t service_id, fs_index_t index,
+    const vfs_extent_t *ext, size_t cnt, const void *buf, size_t *wbytes,
+    aoff64_t *nsize)
+{
+	fs_node_t *fn;
+	errno_t rc2;
+	errno_t rc = ext4_node_get(&fn, service_id, index);
+	if (rc != EOK)
+		return rc;
+
+	ext4_node_t *enode = EXT4_NODE(fn);
+	ext4_filesystem_t *fs = enode->instance->filesystem;
+
+	if (!ext4_inode_is_type(fs->superblock, enode->inode_ref->inode,
+	    EXT4_INODE_MODE_FILE)) {
+		rc = EINVAL;
+		goto exit;
+	}
+
+	size_t done = 0;
+	for (size_t i = 0; i < cnt; i++) {
+		size_t off = 0;
+
+		while (off < ext[i].size) {
+			size_t bytes;
+
+			rc = ext4_write_file(NULL, (const uint8_t *) buf + done,
+			    ext[i].pos + off, ext[i].size - off, enode, &bytes);
+			if (rc != EOK)
+				break;
+
+			off += bytes;
+			done += bytes;
+		}
+
+		if (rc != EOK)
+			break;
+	}
+
+	/* Report a partial write, fail only if nothing was written. */
+	if (rc != EOK) {
+		if (done == 0)
+			goto exit;
+		rc = EOK;
+	}
+
+	*wbytes = done;
+	*nsize = ext4_inode_get_size(fs->superblock, enode->inode_ref->inode);
 
 exit:
 	rc2 = ext4_node_put(fn);
@@ -1486,6 +1656,8 @@ vfs_out_ops_t ext4_ops = {
 	.unmounted = ext4_unmounted,
 	.read = ext4_read,
 	.write = ext4_write,
+	.readv = ext4_readv,
+	.writev = ext4_writev,
 	.truncate = ext4_truncate,
 	.close = ext4_close,
 	.destroy = ext4_destroy,
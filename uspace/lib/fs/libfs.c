@@ -42,6 +42,7 @@
 #include <assert.h>
 #include <dirent.h>
 #include <mem.h>
+#include <stdint.h>
 #include <str.h>
 #include <stdlib.h>
 #include <fibril_synch.h>
@@ -185,6 +186,157 @@ static void vfs_out_write(ipc_call_t *req)
 		async_answer_0(req, rc);
 }
 
+/** Receive the extent table and the data call of a vectored request.
+ *
+ * The extent table is sent first, followed by an IPC_M_DATA_READ or
+ * IPC_M_DATA_WRITE request covering the data of all extents. On failure,
+ * the data call is answered here, the request itself is left to the caller.
+ *
+ * @param read       True for reading, false for writing
+ * @param[out] ext   Extent table
+ * @param[out] cnt   Number of extents
+ * @param[out] call  Data call
+ * @param[out] buf   Buffer for the data of all extents
+ * @param[out] size  Size of the data
+ *
+ * @return           EOK on success or an error code
+ */
+static errno_t vfs_out_rdwrv_receive(bool read, vfs_extent_t **ext,
+    size_t *cnt, ipc_call_t *call, void **buf, size_t *size)
+{
+	size_t tsize;
+	size_t total = 0;
+	bool ok;
+	errno_t rc;
+
+	rc = async_data_write_accept((void **) ext, false,
+	    sizeof(vfs_extent_t), VFS_IOV_MAX * sizeof(vfs_extent_t),
+	    sizeof(vfs_extent_t), &tsize);
+
+	ok = read ? async_data_read_receive(call, size) :
+	    async_data_write_receive(call, size);
+	if (!ok) {
+		if (rc == EOK)
+			free(*ext);
+		async_answer_0(call, EINVAL);
+		return EINVAL;
+	}
+
+	if (rc != EOK) {
+		async_answer_0(call, rc);
+		return rc;
+	}
+
+	*cnt = tsize / sizeof(vfs_extent_t);
+	for (size_t i = 0; i < *cnt; i++) {
+		if ((*ext)[i].size > DATA_XFER_LIMIT) {
+			total = SIZE_MAX;
+			break;
+		}
+
+		total += (*ext)[i].size;
+	}
+
+	if (total != *size || *size == 0 || *size > DATA_XFER_LIMIT) {
+		free(*ext);
+		async_answer_0(call, EINVAL);
+		return EINVAL;
+	}
+
+	*buf = malloc(*size);
+	if (*buf == NULL) {
+		free(*ext);
+		async_answer_0(call, ENOMEM);
+		return ENOMEM;
+	}
+
+	if (!read) {
+		rc = async_data_write_finalize(call, *buf, *size);
+		if (rc != EOK) {
+			free(*buf);
+			free(*ext);
+			return rc;
+		}
+	}
+
+	return EOK;
+}
+
+static void vfs_out_readv(ipc_call_t *req)
+{
+	service_id_t service_id = (service_id_t) IPC_GET_ARG1(*req);
+	fs_index_t index = (fs_index_t) IPC_GET_ARG2(*req);
+	vfs_extent_t *ext;
+	ipc_call_t call;
+	size_t cnt;
+	void *buf;
+	size_t size;
+	size_t rbytes;
+	errno_t rc;
+
+	rc = vfs_out_rdwrv_receive(true, &ext, &cnt, &call, &buf, &size);
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		return;
+	}
+
+	if (vfs_out_ops->readv != NULL) {
+		rc = vfs_out_ops->readv(service_id, index, ext, cnt, buf,
+		    &rbytes);
+	} else {
+		rc = ENOTSUP;
+	}
+
+	if (rc == EOK)
+		rc = async_data_read_finalize(&call, buf, min(rbytes, size));
+	else
+		async_answer_0(&call, rc);
+
+	free(buf);
+	free(ext);
+
+	if (rc == EOK)
+		async_answer_1(req, EOK, rbytes);
+	else
+		async_answer_0(req, rc);
+}
+
+static void vfs_out_writev(ipc_call_t *req)
+{
+	service_id_t service_id = (service_id_t) IPC_GET_ARG1(*req);
+	fs_index_t index = (fs_index_t) IPC_GET_ARG2(*req);
+	vfs_extent_t *ext;
+	ipc_call_t call;
+	size_t cnt;
+	void *buf;
+	size_t size;
+	size_t wbytes;
+	aoff64_t nsize;
+	errno_t rc;
+
+	rc = vfs_out_rdwrv_receive(false, &ext, &cnt, &call, &buf, &size);
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		return;
+	}
+
+	if (vfs_out_ops->writev != NULL) {
+		rc = vfs_out_ops->writev(service_id, index, ext, cnt, buf,
+		    &wbytes, &nsize);
+	} else {
+		rc = ENOTSUP;
+	}
+
+	free(buf);
+	free(ext);
+
+	if (rc == EOK) {
+		async_answer_3(req, EOK, wbytes, LOWER32(nsize),
+		    UPPER32(nsize));
+	} else
+		async_answer_0(req, rc);
+}
+
 static void vfs_out_truncate(ipc_call_t *req)
 {
 	service_id_t service_id = (service_id_t) IPC_GET_ARG1(*req);
@@ -314,6 +466,12 @@ static void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_OUT_WRITE:
 			vfs_out_write(&call);
 			break;
+		case VFS_OUT_READV:
+			vfs_out_readv(&call);
+			break;
+		case VFS_OUT_WRITEV:
+			vfs_out_writev(&call);
+			break;
 		case VFS_OUT_TRUNCATE:
 			vfs_out_truncate(&call);
 			break;
@@ -48,6 +48,10 @@ typedef struct {
 	errno_t (*read)(service_id_t, fs_index_t, aoff64_t, size_t *);
 	errno_t (*write)(service_id_t, fs_index_t, aoff64_t, size_t *,
 	    aoff64_t *);
+	errno_t (*readv)(service_id_t, fs_index_t, const vfs_extent_t *, size_t,
+	    void *, size_t *);
+	errno_t (*writev)(service_id_t, fs_index_t, const vfs_extent_t *,
+	    size_t, const void *, size_t *, aoff64_t *);
 	errno_t (*truncate)(service_id_t, fs_index_t, aoff64_t);
 	errno_t (*close)(service_id_t, fs_index_t);
 	errno_t (*destroy)(service_id_t, fs_index_t);
@@ -238,6 +238,11 @@ errno_t ieee80211_aes_key_unwrap(uint8_t *kek, uint8_t *data, size_t data_size,
 	uint64_t mask = 0xff;
 	uint8_t shift, shb;
 
+	aes_ctx_t ctx;
+	errno_t rc = aes_init(&ctx, kek);
+	if (rc != EOK)
+		return rc;
+
 	memcpy(work_data, data + 8, n * 8);
 	for (int j = 5; j >= 0; j--) {
 		for (int i = n; i > 0; i--) {
@@ -250,7 +255,7 @@ errno_t ieee80211_aes_key_unwrap(uint8_t *kek, uint8_t *data, size_t data_size,
 			work_block = work_data + (i - 1) * 8;
 			memcpy(work_input, a, 8);
 			memcpy(work_input + 8, work_block, 8);
-			aes_decrypt(kek, work_input, work_output);
+			aes_decrypt_block(&ctx, work_input, work_output);
 			memcpy(a, work_output, 8);
 			memcpy(work_data + (i - 1) * 8, work_output + 8, 8);
 		}
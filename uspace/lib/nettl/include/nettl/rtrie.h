@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libnettl
+ * @{
+ */
+/**
+ * @file Routing trie.
+ */
+
+#ifndef LIBNETTL_RTRIE_H_
+#define LIBNETTL_RTRIE_H_
+
+#include <adt/list.h>
+#include <inet/addr.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** Maximum key size in bytes */
+#define RTRIE_KEY_SIZE  16
+
+/** Routing trie node */
+typedef struct rtrie_node {
+	/** Children for the next bit being zero and one */
+	struct rtrie_node *child[2];
+	/** Prefix (bits past @c bits are zero) */
+	uint8_t key[RTRIE_KEY_SIZE];
+	/** Prefix length in bits */
+	unsigned bits;
+	/** Entries with this prefix, empty for internal nodes */
+	list_t entries;
+} rtrie_node_t;
+
+/** Routing trie
+ *
+ * Path-compressed binary trie mapping network prefixes to entries.
+ * Entries are embedded links, several entries may share the same prefix.
+ * Lookup returns the first entry with the longest prefix matching the
+ * address.
+ */
+typedef struct {
+	/** Root node for IPv4 prefixes */
+	rtrie_node_t *root4;
+	/** Root node for IPv6 prefixes */
+	rtrie_node_t *root6;
+	/** Number of entries */
+	size_t count;
+} rtrie_t;
+
+extern void rtrie_initialize(rtrie_t *);
+extern void rtrie_clear(rtrie_t *);
+extern errno_t rtrie_insert(rtrie_t *, inet_naddr_t *, link_t *);
+extern void rtrie_remove(rtrie_t *, inet_naddr_t *, link_t *);
+extern link_t *rtrie_lookup(rtrie_t *, inet_addr_t *);
+
+#endif
+
+/** @}
+ */
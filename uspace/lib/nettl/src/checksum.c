@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libnettl
+ * @{
+ */
+
+/**
+ * @file Internet checksum
+ *
+ * Computes the Internet checksum (RFC 1071) shared by IP, ICMP, UDP
+ * and TCP. Since the one's complement sum does not depend on byte order,
+ * the data is summed in native byte order using the widest words
+ * available and the result is byte-swapped at the end if needed.
+ * Checksums can also be updated incrementally (RFC 1624) when only
+ * a few fields of the checksummed data change.
+ */
+
+#include <byteorder.h>
+#include <mem.h>
+#include <nettl/checksum.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __SSE2__
+
+/** Two 64-bit lanes, mapped to SSE2 registers by the compiler. */
+typedef uint64_t checksum_vec_t __attribute__((vector_size(16)));
+
+/** Sum data in 16-byte blocks using vector instructions.
+ *
+ * Each 128-bit block is split into four 32-bit words which are added
+ * to two 64-bit lanes. The lanes cannot overflow for any feasible
+ * buffer size.
+ *
+ * @param sum   Sum so far
+ * @param data  Data
+ * @param size  Size of data in bytes, will be decreased by the number
+ *              of bytes processed
+ * @return Updated sum
+ */
+static uint64_t checksum_sum_vec(uint64_t sum, const uint8_t **data,
+    size_t *size)
+{
+	const checksum_vec_t low = { 0xffffffff, 0xffffffff };
+	checksum_vec_t acc0 = { 0, 0 };
+	checksum_vec_t acc1 = { 0, 0 };
+	checksum_vec_t v[4];
+	const uint8_t *p = *data;
+	size_t n = *size;
+
+	/* Process 64 bytes per iteration to hide latencies. */
+	while (n >= sizeof(v)) {
+		memcpy(v, p, sizeof(v));
+
+		acc0 += (v[0] & low) + (v[0] >> 32);
+		acc1 += (v[1] & low) + (v[1] >> 32);
+		acc0 += (v[2] & low) + (v[2] >> 32);
+		acc1 += (v[3] & low) + (v[3] >> 32);
+
+		p += sizeof(v);
+		n -= sizeof(v);
+	}
+
+	while (n >= sizeof(v[0])) {
+		memcpy(v, p, sizeof(v[0]));
+		acc0 += (v[0] & low) + (v[0] >> 32);
+
+		p += sizeof(v[0]);
+		n -= sizeof(v[0]);
+	}
+
+	acc0 += acc1;
+
+	*data = p;
+	*size = n;
+
+	/* Add the lanes, preserving the carry. */
+	uint64_t s = acc0[0] + acc0[1];
+	if (s < acc0[0])
+		s++;
+
+	sum += s;
+	if (sum < s)
+		sum++;
+
+	return sum;
+}
+
+#endif
+
+/** Compute one's complement sum of data in native byte order.
+ *
+ * @param data Data
+ * @param size Size of data in bytes
+ * @return 64-bit one's complement sum of 16-bit words of @a data
+ */
+static uint64_t checksum_sum(const uint8_t *data, size_t size)
+{
+	uint64_t sum = 0;
+	uint32_t w[4];
+
+#ifdef __SSE2__
+	if (size >= 64)
+		sum = checksum_sum_vec(sum, &data, &size);
+#endif
+
+	/*
+	 * Adding 32-bit words to a 64-bit accumulator cannot overflow
+	 * for any buffer which fits in the address space.
+	 */
+	while (size >= sizeof(w)) {
+		memcpy(w, data, sizeof(w));
+		sum += (uint64_t) w[0] + w[1] + w[2] + w[3];
+
+		data += sizeof(w);
+		size -= sizeof(w);
+	}
+
+	while (size >= sizeof(uint32_t)) {
+		memcpy(w, data, sizeof(uint32_t));
+		sum += w[0];
+
+		data += sizeof(uint32_t);
+		size -= sizeof(uint32_t);
+	}
+
+	uint8_t tail[2] = { 0, 0 };
+	uint16_t t;
+
+	if (size >= 2) {
+		memcpy(&t, data, sizeof(t));
+		sum += t;
+
+		data += 2;
+		size -= 2;
+	}
+
+	if (size > 0) {
+		/* Odd trailing byte is padded with zero. */
+		tail[0] = data[0];
+		memcpy(&t, tail, sizeof(t));
+		sum += t;
+	}
+
+	return sum;
+}
+
+/** Fold a one's complement sum into 16 bits.
+ *
+ * @param sum Wide sum
+ * @return 16-bit one's complement sum
+ */
+static uint16_t checksum_fold(uint64_t sum)
+{
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffffffff) + (sum >> 32);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+	sum = (sum & 0xffff) + (sum >> 16);
+
+	return (uint16_t) sum;
+}
+
+/** Compute Internet checksum.
+ *
+ * The checksum of data made of several pieces can be computed by
+ * passing the checksum of the preceding pieces as @a ivalue. All
+ * pieces but the last one need to be of even size.
+ *
+ * @param ivalue Initial value (INET_CHECKSUM_INIT or checksum
+ *               of the preceding data)
+ * @param data   Data
+ * @param size   Size of data in bytes
+ * @return Checksum in host byte order
+ */
+uint16_t inet_checksum_calc(uint16_t ivalue, const void *data, size_t size)
+{
+	uint64_t sum;
+
+	sum = checksum_sum((const uint8_t *) data, size);
+	sum += host2uint16_t_be((uint16_t) ~ivalue);
+
+	return (uint16_t) ~uint16_t_be2host(checksum_fold(sum));
+}
+
+/** Update Internet checksum after a 16-bit word changed.
+ *
+ * Uses equation 3 of RFC 1624, i.e. HC' = ~(~HC + ~m + m').
+ *
+ * @param checksum Old checksum in host byte order
+ * @param old      Old value of the word in host byte order
+ * @param new      New value of the word in host byte order
+ * @return New checksum in host byte order
+ */
+uint16_t inet_checksum_update16(uint16_t checksum, uint16_t old, uint16_t new)
+{
+	uint64_t sum;
+
+	sum = (uint16_t) ~checksum;
+	sum += (uint16_t) ~old;
+	sum += new;
+
+	return (uint16_t) ~checksum_fold(sum);
+}
+
+/** Update Internet checksum after a 32-bit word changed.
+ *
+ * The word must be aligned on 16 bits within the checksummed data,
+ * such as an IPv4 address in a header.
+ *
+ * @param checksum Old checksum in host byte order
+ * @param old      Old value of the word in host byte order
+ * @param new      New value of the word in host byte order
+ * @return New checksum in host byte order
+ */
+uint16_t inet_checksum_update32(uint16_t checksum, uint32_t old, uint32_t new)
+{
+	uint64_t sum;
+
+	sum = (uint16_t) ~checksum;
+	sum += (uint16_t) ~(old >> 16);
+	sum += (uint16_t) ~(old & 0xffff);
+	sum += new >> 16;
+	sum += new & 0xffff;
+
+	return (uint16_t) ~checksum_fold(sum);
+}
+
+/** @}
+ */
@@ -0,0 +1,381 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup libnettl
+ * @{
+ */
+
+/**
+ * @file Routing trie
+ *
+ * Longest prefix match lookup of network prefixes. IPv4 and IPv6 prefixes
+ * are kept in separate path-compressed binary tries (a variant of the
+ * Patricia trie). Each node carries the full prefix it represents, so
+ * a lookup visits at most one node per distinct prefix length on the
+ * path to the address, regardless of the number of prefixes stored.
+ *
+ * Nodes without entries are only kept where two subtrees branch off.
+ */
+
+#include <adt/list.h>
+#include <assert.h>
+#include <errno.h>
+#include <inet/addr.h>
+#include <mem.h>
+#include <nettl/rtrie.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+/** Get bit @a bit of key (counting from the most significant bit). */
+static unsigned rtrie_key_bit(const uint8_t *key, unsigned bit)
+{
+	return (key[bit / 8] >> (7 - bit % 8)) & 1;
+}
+
+/** Determine number of leading bits two keys have in common.
+ *
+ * @param a First key
+ * @param b Second key
+ * @param bits Maximum number of bits to compare
+ * @return Number of common leading bits, at most @a bits
+ */
+static unsigned rtrie_key_common(const uint8_t *a, const uint8_t *b,
+    unsigned bits)
+{
+	unsigned i;
+
+	for (i = 0; i < bits; i += 8) {
+		uint8_t diff = a[i / 8] ^ b[i / 8];
+		if (diff != 0) {
+			while ((diff & 0x80) == 0) {
+				diff <<= 1;
+				i++;
+			}
+
+			return (i < bits) ? i : bits;
+		}
+	}
+
+	return bits;
+}
+
+/** Convert address to key.
+ *
+ * @param addr Address
+ * @param key Place to store key
+ * @param rbits Place to store number of bits of the address
+ * @return IP version of the address
+ */
+static ip_ver_t rtrie_addr_key(inet_addr_t *addr, uint8_t *key,
+    unsigned *rbits)
+{
+	switch (addr->version) {
+	case ip_v4:
+		memset(key, 0, RTRIE_KEY_SIZE);
+		key[0] = addr->addr >> 24;
+		key[1] = addr->addr >> 16;
+		key[2] = addr->addr >> 8;
+		key[3] = addr->addr;
+		*rbits = 32;
+		break;
+	case ip_v6:
+		memcpy(key, addr->addr6, RTRIE_KEY_SIZE);
+		*rbits = 128;
+		break;
+	default:
+		*rbits = 0;
+		break;
+	}
+
+	return addr->version;
+}
+
+/** Convert network address to key.
+ *
+ * @param naddr Network address
+ * @param key Place to store key
+ * @param rbits Place to store prefix length
+ * @return IP version of the network address
+ */
+static ip_ver_t rtrie_naddr_key(inet_naddr_t *naddr, uint8_t *key,
+    unsigned *rbits)
+{
+	inet_addr_t addr;
+	uint8_t prefix;
+	unsigned abits;
+
+	inet_naddr_addr(naddr, &addr);
+	(void) inet_naddr_get(naddr, NULL, NULL, &prefix);
+	ip_ver_t ver = rtrie_addr_key(&addr, key, &abits);
+
+	*rbits = (prefix < abits) ? prefix : abits;
+	return ver;
+}
+
+/** Get pointer to the root of the trie for a given IP version. */
+static rtrie_node_t **rtrie_root(rtrie_t *trie, ip_ver_t ver)
+{
+	switch (ver) {
+	case ip_v4:
+		return &trie->root4;
+	case ip_v6:
+		return &trie->root6;
+	default:
+		return NULL;
+	}
+}
+
+/** Create trie node.
+ *
+ * @param key Prefix
+ * @param bits Prefix length
+ * @return New node or @c NULL if out of memory
+ */
+static rtrie_node_t *rtrie_node_create(const uint8_t *key, unsigned bits)
+{
+	rtrie_node_t *node = calloc(1, sizeof(rtrie_node_t));
+	if (node == NULL)
+		return NULL;
+
+	memcpy(node->key, key, (bits + 7) / 8);
+	if (bits % 8 != 0)
+		node->key[bits / 8] &= 0xff << (8 - bits % 8);
+	node->bits = bits;
+	list_initialize(&node->entries);
+	return node;
+}
+
+/** Destroy subtree. */
+static void rtrie_node_destroy(rtrie_node_t *node)
+{
+	if (node == NULL)
+		return;
+
+	rtrie_node_destroy(node->child[0]);
+	rtrie_node_destroy(node->child[1]);
+	free(node);
+}
+
+/** Remove node if it is no longer needed.
+ *
+ * A node is needed if it has entries or if two subtrees branch off it.
+ *
+ * @param plink Link pointing to the node
+ */
+static void rtrie_node_prune(rtrie_node_t **plink)
+{
+	rtrie_node_t *node = *plink;
+
+	if (!list_empty(&node->entries))
+		return;
+	if (node->child[0] != NULL && node->child[1] != NULL)
+		return;
+
+	*plink = (node->child[0] != NULL) ? node->child[0] : node->child[1];
+	free(node);
+}
+
+/** Initialize routing trie.
+ *
+ * @param trie Routing trie
+ */
+void rtrie_initialize(rtrie_t *trie)
+{
+	trie->root4 = NULL;
+	trie->root6 = NULL;
+	trie->count = 0;
+}
+
+/** Remove all entries from routing trie.
+ *
+ * The entries themselves are not touched.
+ *
+ * @param trie Routing trie
+ */
+void rtrie_clear(rtrie_t *trie)
+{
+	rtrie_node_destroy(trie->root4);
+	rtrie_node_destroy(trie->root6);
+	rtrie_initialize(trie);
+}
+
+/** Insert entry into routing trie.
+ *
+ * Entries with the same prefix are kept in the order of insertion.
+ *
+ * @param trie Routing trie
+ * @param naddr Network prefix of the entry
+ * @param entry Link embedded in the entry
+ * @return EOK on success, EINVAL if the address family is not supported,
+ *         ENOMEM if out of memory
+ */
+errno_t rtrie_insert(rtrie_t *trie, inet_naddr_t *naddr, link_t *entry)
+{
+	uint8_t key[RTRIE_KEY_SIZE];
+	unsigned bits;
+	rtrie_node_t **plink;
+	rtrie_node_t *node;
+
+	plink = rtrie_root(trie, rtrie_naddr_key(naddr, key, &bits));
+	if (plink == NULL)
+		return EINVAL;
+
+	while (*plink != NULL) {
+		node = *plink;
+
+		unsigned limit = (node->bits < bits) ? node->bits : bits;
+		unsigned common = rtrie_key_common(node->key, key, limit);
+
+		if (common == node->bits) {
+			if (node->bits == bits) {
+				/* Node with the same prefix */
+				list_append(entry, &node->entries);
+				trie->count++;
+				return EOK;
+			}
+
+			/* Node prefix is a prefix of the key, descend */
+			plink = &node->child[rtrie_key_bit(key, node->bits)];
+			continue;
+		}
+
+		/* The new prefix diverges from the node or is shorter. */
+		if (common == bits) {
+			/* New node becomes the parent of @a node */
+			rtrie_node_t *nnode = rtrie_node_create(key, bits);
+			if (nnode == NULL)
+				return ENOMEM;
+
+			nnode->child[rtrie_key_bit(node->key, bits)] = node;
+			list_append(entry, &nnode->entries);
+			*plink = nnode;
+			trie->count++;
+			return EOK;
+		}
+
+		/* Branch off at the first differing bit */
+		rtrie_node_t *branch = rtrie_node_create(key, common);
+		if (branch == NULL)
+			return ENOMEM;
+
+		rtrie_node_t *nnode = rtrie_node_create(key, bits);
+		if (nnode == NULL) {
+			free(branch);
+			return ENOMEM;
+		}
+
+		branch->child[rtrie_key_bit(node->key, common)] = node;
+		branch->child[rtrie_key_bit(key, common)] = nnode;
+		list_append(entry, &nnode->entries);
+		*plink = branch;
+		trie->count++;
+		return EOK;
+	}
+
+	node = rtrie_node_create(key, bits);
+	if (node == NULL)
+		return ENOMEM;
+
+	list_append(entry, &node->entries);
+	*plink = node;
+	trie->count++;
+	return EOK;
+}
+
+/** Remove entry from routing trie.
+ *
+ * @param trie Routing trie
+ * @param naddr Network prefix the entry was inserted with
+ * @param entry Link embedded in the entry
+ */
+void rtrie_remove(rtrie_t *trie, inet_naddr_t *naddr, link_t *entry)
+{
+	uint8_t key[RTRIE_KEY_SIZE];
+	unsigned bits;
+	rtrie_node_t **plink;
+	rtrie_node_t **pplink = NULL;
+
+	plink = rtrie_root(trie, rtrie_naddr_key(naddr, key, &bits));
+	assert(plink != NULL);
+
+	while ((*plink)->bits < bits) {
+		pplink = plink;
+		plink = &(*plink)->child[rtrie_key_bit(key, (*plink)->bits)];
+		assert(*plink != NULL);
+	}
+
+	assert((*plink)->bits == bits);
+
+	list_remove(entry);
+	trie->count--;
+
+	rtrie_node_prune(plink);
+	if (pplink != NULL)
+		rtrie_node_prune(pplink);
+}
+
+/** Find entry with the longest prefix matching an address.
+ *
+ * @param trie Routing trie
+ * @param addr Address
+ * @return First entry with the longest matching prefix or @c NULL
+ */
+link_t *rtrie_lookup(rtrie_t *trie, inet_addr_t *addr)
+{
+	uint8_t key[RTRIE_KEY_SIZE];
+	unsigned bits;
+	rtrie_node_t **plink;
+	rtrie_node_t *node;
+	rtrie_node_t *best = NULL;
+
+	plink = rtrie_root(trie, rtrie_addr_key(addr, key, &bits));
+	if (plink == NULL)
+		return NULL;
+
+	node = *plink;
+	while (node != NULL && node->bits <= bits) {
+		if (rtrie_key_common(node->key, key, node->bits) != node->bits)
+			break;
+
+		if (!list_empty(&node->entries))
+			best = node;
+
+		if (node->bits == bits)
+			break;
+
+		node = node->child[rtrie_key_bit(key, node->bits)];
+	}
+
+	if (best == NULL)
+		return NULL;
+
+	return list_first(&best->entries);
+}
+
+/** @}
+ */
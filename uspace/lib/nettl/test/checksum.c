@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <mem.h>
+#include <nettl/checksum.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(checksum);
+
+enum {
+	/** Size of test buffer */
+	test_buf_size = 4096
+};
+
+/** Straightforward checksum computation to compare with. */
+static uint16_t ref_checksum(uint16_t ivalue, const uint8_t *data, size_t size)
+{
+	uint32_t sum = (uint16_t) ~ivalue;
+	size_t i;
+
+	for (i = 0; i + 1 < size; i += 2)
+		sum += ((uint32_t) data[i] << 8) | data[i + 1];
+
+	if (size % 2 != 0)
+		sum += (uint32_t) data[size - 1] << 8;
+
+	while ((sum >> 16) != 0)
+		sum = (sum & 0xffff) + (sum >> 16);
+
+	return (uint16_t) ~sum;
+}
+
+/** Fill buffer with pseudo-random data. */
+static void fill_buffer(uint8_t *buf, size_t size, uint32_t seed)
+{
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		seed = seed * 1103515245 + 12345;
+		buf[i] = seed >> 16;
+	}
+}
+
+/** Checksum of the example data from RFC 1071 section 3 */
+PCUT_TEST(rfc1071_example)
+{
+	uint8_t data[] = { 0x00, 0x01, 0xf2, 0x03, 0xf4, 0xf5, 0xf6, 0xf7 };
+
+	PCUT_ASSERT_INT_EQUALS((uint16_t) ~0xddf2,
+	    inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data)));
+}
+
+/** Checksum of empty and zero data */
+PCUT_TEST(empty)
+{
+	uint8_t data[3] = { 0, 0, 0 };
+
+	PCUT_ASSERT_INT_EQUALS(0xffff,
+	    inet_checksum_calc(INET_CHECKSUM_INIT, data, 0));
+	PCUT_ASSERT_INT_EQUALS(0xffff,
+	    inet_checksum_calc(INET_CHECKSUM_INIT, data, sizeof(data)));
+}
+
+/** Checksum of various sizes and alignments matches the reference */
+PCUT_TEST(sizes_alignments)
+{
+	uint8_t *buf = malloc(test_buf_size + 8);
+	PCUT_ASSERT_NOT_NULL(buf);
+
+	fill_buffer(buf, test_buf_size + 8, 42);
+
+	size_t offs;
+	size_t size;
+	for (offs = 0; offs < 8; offs++) {
+		for (size = 0; size <= test_buf_size; size += (size < 200) ? 1 : 61) {
+			PCUT_ASSERT_INT_EQUALS(
+			    ref_checksum(INET_CHECKSUM_INIT, buf + offs, size),
+			    inet_checksum_calc(INET_CHECKSUM_INIT, buf + offs,
+			    size));
+		}
+	}
+
+	/* All ones exercise the end-around carry */
+	memset(buf, 0xff, test_buf_size);
+	PCUT_ASSERT_INT_EQUALS(ref_checksum(INET_CHECKSUM_INIT, buf,
+	    test_buf_size), inet_checksum_calc(INET_CHECKSUM_INIT, buf,
+	    test_buf_size));
+	PCUT_ASSERT_INT_EQUALS(ref_checksum(INET_CHECKSUM_INIT, buf,
+	    test_buf_size - 1), inet_checksum_calc(INET_CHECKSUM_INIT, buf,
+	    test_buf_size - 1));
+
+	free(buf);
+}
+
+/** Checksum can be computed piecewise */
+PCUT_TEST(chained)
+{
+	uint8_t buf[301];
+	uint16_t cs;
+
+	fill_buffer(buf, sizeof(buf), 7);
+
+	cs = inet_checksum_calc(INET_CHECKSUM_INIT, buf, 100);
+	cs = inet_checksum_calc(cs, buf + 100, 36);
+	cs = inet_checksum_calc(cs, buf + 136, sizeof(buf) - 136);
+
+	PCUT_ASSERT_INT_EQUALS(ref_checksum(INET_CHECKSUM_INIT, buf,
+	    sizeof(buf)), cs);
+}
+
+/** Incremental update of a 16-bit word matches full computation */
+PCUT_TEST(update16)
+{
+	uint8_t buf[64];
+	unsigned int i;
+
+	fill_buffer(buf, sizeof(buf), 1);
+
+	for (i = 0; i < sizeof(buf) / 2; i++) {
+		uint16_t cs = inet_checksum_calc(INET_CHECKSUM_INIT, buf,
+		    sizeof(buf));
+		uint16_t old = ((uint16_t) buf[2 * i] << 8) | buf[2 * i + 1];
+		uint16_t new = (i % 2 == 0) ? 0xffff - old : old + 0x1234;
+
+		buf[2 * i] = new >> 8;
+		buf[2 * i + 1] = new & 0xff;
+
+		PCUT_ASSERT_INT_EQUALS(inet_checksum_calc(INET_CHECKSUM_INIT,
+		    buf, sizeof(buf)), inet_checksum_update16(cs, old, new));
+	}
+}
+
+/** Incremental update of a 32-bit word matches full computation */
+PCUT_TEST(update32)
+{
+	uint8_t buf[20];
+	unsigned int i;
+
+	fill_buffer(buf, sizeof(buf), 2);
+
+	for (i = 0; i + 4 <= sizeof(buf); i += 2) {
+		uint16_t cs = inet_checksum_calc(INET_CHECKSUM_INIT, buf,
+		    sizeof(buf));
+		uint32_t old = ((uint32_t) buf[i] << 24) |
+		    ((uint32_t) buf[i + 1] << 16) |
+		    ((uint32_t) buf[i + 2] << 8) | buf[i + 3];
+		uint32_t new = old ^ 0x0a0b0c0d;
+
+		buf[i] = new >> 24;
+		buf[i + 1] = (new >> 16) & 0xff;
+		buf[i + 2] = (new >> 8) & 0xff;
+		buf[i + 3] = new & 0xff;
+
+		PCUT_ASSERT_INT_EQUALS(inet_checksum_calc(INET_CHECKSUM_INIT,
+		    buf, sizeof(buf)), inet_checksum_update32(cs, old, new));
+	}
+}
+
+PCUT_EXPORT(checksum);
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <adt/list.h>
+#include <inet/addr.h>
+#include <nettl/rtrie.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(rtrie);
+
+enum {
+	/** Number of random prefixes */
+	test_prefixes = 1000,
+	/** Number of random lookups */
+	test_lookups = 2000
+};
+
+/** Test entry */
+typedef struct {
+	/** Link to rtrie_t */
+	link_t ltrie;
+	/** Network prefix */
+	inet_naddr_t naddr;
+	/** Entry is in the trie */
+	bool present;
+} test_entry_t;
+
+static test_entry_t entries[test_prefixes];
+
+static uint32_t seed;
+
+static uint32_t test_rand(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed;
+}
+
+/** Get entry from link returned by rtrie_lookup(). */
+static test_entry_t *test_entry(link_t *link)
+{
+	if (link == NULL)
+		return NULL;
+
+	return list_get_instance(link, test_entry_t, ltrie);
+}
+
+/** Find longest matching prefix by linear search to compare with. */
+static test_entry_t *ref_lookup(inet_addr_t *addr)
+{
+	test_entry_t *best = NULL;
+	uint8_t best_bits = 0;
+	uint8_t bits;
+	size_t i;
+
+	for (i = 0; i < test_prefixes; i++) {
+		if (!entries[i].present)
+			continue;
+
+		(void) inet_naddr_get(&entries[i].naddr, NULL, NULL, &bits);
+		if (best != NULL && best_bits >= bits)
+			continue;
+
+		if (inet_naddr_compare_mask(&entries[i].naddr, addr)) {
+			best = &entries[i];
+			best_bits = bits;
+		}
+	}
+
+	return best;
+}
+
+/** Lookup in empty trie */
+PCUT_TEST(empty)
+{
+	rtrie_t trie;
+	inet_addr_t addr;
+
+	rtrie_initialize(&trie);
+	inet_addr(&addr, 10, 0, 0, 1);
+	PCUT_ASSERT_NULL(rtrie_lookup(&trie, &addr));
+	inet_addr6(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+	PCUT_ASSERT_NULL(rtrie_lookup(&trie, &addr));
+	rtrie_clear(&trie);
+}
+
+/** Most specific IPv4 prefix wins, default route matches the rest */
+PCUT_TEST(longest_match4)
+{
+	rtrie_t trie;
+	test_entry_t e0, e8, e16, e24;
+	inet_addr_t addr;
+	errno_t rc;
+
+	rtrie_initialize(&trie);
+
+	inet_naddr(&e16.naddr, 10, 1, 0, 0, 16);
+	inet_naddr(&e0.naddr, 0, 0, 0, 0, 0);
+	inet_naddr(&e24.naddr, 10, 1, 2, 0, 24);
+	inet_naddr(&e8.naddr, 10, 0, 0, 0, 8);
+
+	rc = rtrie_insert(&trie, &e16.naddr, &e16.ltrie);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, &e0.naddr, &e0.ltrie);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, &e24.naddr, &e24.ltrie);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, &e8.naddr, &e8.ltrie);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(4, trie.count);
+
+	inet_addr(&addr, 10, 1, 2, 3);
+	PCUT_ASSERT_EQUALS(&e24, test_entry(rtrie_lookup(&trie, &addr)));
+	inet_addr(&addr, 10, 1, 3, 3);
+	PCUT_ASSERT_EQUALS(&e16, test_entry(rtrie_lookup(&trie, &addr)));
+	inet_addr(&addr, 10, 2, 3, 3);
+	PCUT_ASSERT_EQUALS(&e8, test_entry(rtrie_lookup(&trie, &addr)));
+	inet_addr(&addr, 192, 168, 0, 1);
+	PCUT_ASSERT_EQUALS(&e0, test_entry(rtrie_lookup(&trie, &addr)));
+
+	/* IPv6 addresses do not match IPv4 prefixes */
+	inet_addr6(&addr, 0xfe80, 0, 0, 0, 0, 0, 0, 1);
+	PCUT_ASSERT_NULL(rtrie_lookup(&trie, &addr));
+
+	rtrie_remove(&trie, &e16.naddr, &e16.ltrie);
+	inet_addr(&addr, 10, 1, 3, 3);
+	PCUT_ASSERT_EQUALS(&e8, test_entry(rtrie_lookup(&trie, &addr)));
+	inet_addr(&addr, 10, 1, 2, 3);
+	PCUT_ASSERT_EQUALS(&e24, test_entry(rtrie_lookup(&trie, &addr)));
+
+	rtrie_remove(&trie, &e24.naddr, &e24.ltrie);
+	rtrie_remove(&trie, &e0.naddr, &e0.ltrie);
+	rtrie_remove(&trie, &e8.naddr, &e8.ltrie);
+	PCUT_ASSERT_INT_EQUALS(0, trie.count);
+	PCUT_ASSERT_NULL(trie.root4);
+
+	rtrie_clear(&trie);
+}
+
+/** Most specific IPv6 prefix wins */
+PCUT_TEST(longest_match6)
+{
+	rtrie_t trie;
+	test_entry_t e32, e64;
+	inet_addr_t addr;
+	errno_t rc;
+
+	rtrie_initialize(&trie);
+
+	inet_naddr6(&e32.naddr, 0x2001, 0xdb8, 0, 0, 0, 0, 0, 0, 32);
+	inet_naddr6(&e64.naddr, 0x2001, 0xdb8, 0, 1, 0, 0, 0, 0, 64);
+
+	rc = rtrie_insert(&trie, &e32.naddr, &e32.ltrie);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, &e64.naddr, &e64.ltrie);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr6(&addr, 0x2001, 0xdb8, 0, 1, 0, 0, 0, 1);
+	PCUT_ASSERT_EQUALS(&e64, test_entry(rtrie_lookup(&trie, &addr)));
+	inet_addr6(&addr, 0x2001, 0xdb8, 0, 2, 0, 0, 0, 1);
+	PCUT_ASSERT_EQUALS(&e32, test_entry(rtrie_lookup(&trie, &addr)));
+	inet_addr6(&addr, 0x2001, 0xdb9, 0, 1, 0, 0, 0, 1);
+	PCUT_ASSERT_NULL(rtrie_lookup(&trie, &addr));
+
+	rtrie_remove(&trie, &e32.naddr, &e32.ltrie);
+	rtrie_remove(&trie, &e64.naddr, &e64.ltrie);
+	PCUT_ASSERT_NULL(trie.root6);
+
+	rtrie_clear(&trie);
+}
+
+/** Entries with the same prefix are returned in order of insertion */
+PCUT_TEST(same_prefix)
+{
+	rtrie_t trie;
+	test_entry_t e1, e2;
+	inet_addr_t addr;
+	errno_t rc;
+
+	rtrie_initialize(&trie);
+
+	inet_naddr(&e1.naddr, 10, 0, 0, 0, 8);
+	inet_naddr(&e2.naddr, 10, 0, 0, 0, 8);
+
+	rc = rtrie_insert(&trie, &e1.naddr, &e1.ltrie);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	rc = rtrie_insert(&trie, &e2.naddr, &e2.ltrie);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+
+	inet_addr(&addr, 10, 1, 2, 3);
+	PCUT_ASSERT_EQUALS(&e1, test_entry(rtrie_lookup(&trie, &addr)));
+
+	rtrie_remove(&trie, &e1.naddr, &e1.ltrie);
+	PCUT_ASSERT_EQUALS(&e2, test_entry(rtrie_lookup(&trie, &addr)));
+
+	rtrie_remove(&trie, &e2.naddr, &e2.ltrie);
+	PCUT_ASSERT_NULL(rtrie_lookup(&trie, &addr));
+
+	rtrie_clear(&trie);
+}
+
+/** Random prefixes give the same results as linear search */
+PCUT_TEST(random)
+{
+	rtrie_t trie;
+	inet_addr_t addr;
+	errno_t rc;
+	size_t i;
+
+	rtrie_initialize(&trie);
+	seed = 42;
+
+	for (i = 0; i < test_prefixes; i++) {
+		/* Use few leading bits so that the prefixes overlap. */
+		addr32_t a = (test_rand() & 0xf0000000) | (test_rand() >> 8);
+		uint8_t bits = 1 + test_rand() % 32;
+
+		inet_naddr_set(a, bits, &entries[i].naddr);
+		rc = rtrie_insert(&trie, &entries[i].naddr, &entries[i].ltrie);
+		PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+		entries[i].present = true;
+	}
+
+	for (i = 0; i < test_lookups; i++) {
+		inet_addr_set((test_rand() & 0xf0000000) | (test_rand() >> 8),
+		    &addr);
+		test_entry_t *ref = ref_lookup(&addr);
+		test_entry_t *e = test_entry(rtrie_lookup(&trie, &addr));
+
+		/*
+		 * Both entries match the address, so equal prefix length
+		 * means equal prefix.
+		 */
+		if (ref == NULL || e == NULL)
+			PCUT_ASSERT_EQUALS(ref, e);
+		else
+			PCUT_ASSERT_INT_EQUALS(ref->naddr.prefix,
+			    e->naddr.prefix);
+	}
+
+	/* Remove every other entry and compare again */
+	for (i = 0; i < test_prefixes; i += 2) {
+		rtrie_remove(&trie, &entries[i].naddr, &entries[i].ltrie);
+		entries[i].present = false;
+	}
+
+	for (i = 0; i < test_lookups; i++) {
+		inet_addr_set((test_rand() & 0xf0000000) | (test_rand() >> 8),
+		    &addr);
+		test_entry_t *ref = ref_lookup(&addr);
+		test_entry_t *e = test_entry(rtrie_lookup(&trie, &addr));
+
+		if (ref == NULL || e == NULL)
+			PCUT_ASSERT_EQUALS(ref, e);
+		else
+			PCUT_ASSERT_INT_EQUALS(ref->naddr.prefix,
+			    e->naddr.prefix);
+	}
+
+	for (i = 1; i < test_prefixes; i += 2)
+		rtrie_remove(&trie, &entries[i].naddr, &entries[i].ltrie);
+
+	PCUT_ASSERT_INT_EQUALS(0, trie.count);
+	PCUT_ASSERT_NULL(trie.root4);
+
+	rtrie_clear(&trie);
+}
+
+PCUT_EXPORT(rtrie);
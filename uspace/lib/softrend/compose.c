@@ -33,8 +33,101 @@
  * @file
  */
 
+#include <mem.h>
+#include <stdint.h>
 #include "compose.h"
 
+#ifdef __SSE2__
+
+/*
+ * Four pixels are processed at once. The generic vector operations and
+ * the builtins used below map directly to SSE2 instructions.
+ */
+typedef uint32_t pixel_vec_t __attribute__((vector_size(16)));
+typedef int32_t vec_i32_t __attribute__((vector_size(16)));
+typedef int16_t vec_i16_t __attribute__((vector_size(16)));
+typedef uint16_t vec_u16_t __attribute__((vector_size(16)));
+typedef char vec_i8_t __attribute__((vector_size(16)));
+
+#define PIXEL_VEC_COUNT  (sizeof(pixel_vec_t) / sizeof(pixel_t))
+
+/** Divide by 255 rounding down, exact for values up to 2 * 255 * 255. */
+static inline vec_i32_t div255_vec(vec_i32_t val)
+{
+	vec_i32_t tmp = val + 128;
+	vec_i32_t quot = (tmp + (tmp >> 8)) >> 8;
+
+	/* The estimate is at most one too high. */
+	return quot + (((quot << 8) - quot) > val);
+}
+
+/** Blend the interleaved foreground and background channels of a pixel.
+ *
+ * @param chan    Channels as pairs of 16-bit foreground and background
+ *                values (blue, green, red, alpha).
+ * @param weights Pairs of 16-bit weights matching @a chan.
+ *
+ * @return Blended blue, green, red and alpha channels.
+ */
+static inline vec_i32_t blend_vec(vec_i16_t chan, pixel_vec_t weights)
+{
+	vec_i32_t sum = __builtin_ia32_pmaddwd128(chan, (vec_i16_t) weights);
+	return div255_vec(sum) & 0xff;
+}
+
+/** Vector version of compose_over() producing bit-identical results. */
+static inline pixel_vec_t compose_over_vec(pixel_vec_t fg, pixel_vec_t bg)
+{
+	pixel_vec_t fa = fg >> 24;
+	pixel_vec_t ba = bg >> 24;
+
+	/* The product of two 8-bit values fits into a 16-bit lane. */
+	pixel_vec_t fba = (pixel_vec_t) ((vec_u16_t) fa * (vec_u16_t) ba);
+	pixel_vec_t mb =
+	    (pixel_vec_t) div255_vec((vec_i32_t) (255 * 255 - fba));
+
+	/* Weights of color channels and of the alpha channel. */
+	pixel_vec_t wc = fa | (mb << 16);
+	pixel_vec_t wa = 255 | ((255 - fa) << 16);
+
+	/* Zero-extend the bytes of the low and high halves to 16 bits. */
+	const vec_i8_t zero = { 0 };
+	const vec_i8_t unpack_lo = {
+		0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23
+	};
+	const vec_i8_t unpack_hi = {
+		8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31
+	};
+
+	vec_i16_t flo = (vec_i16_t) __builtin_shuffle((vec_i8_t) fg, zero,
+	    unpack_lo);
+	vec_i16_t fhi = (vec_i16_t) __builtin_shuffle((vec_i8_t) fg, zero,
+	    unpack_hi);
+	vec_i16_t blo = (vec_i16_t) __builtin_shuffle((vec_i8_t) bg, zero,
+	    unpack_lo);
+	vec_i16_t bhi = (vec_i16_t) __builtin_shuffle((vec_i8_t) bg, zero,
+	    unpack_hi);
+
+	vec_i32_t res0 = blend_vec(__builtin_shuffle(flo, blo,
+	    (vec_i16_t) { 0, 8, 1, 9, 2, 10, 3, 11 }),
+	    __builtin_shuffle(wc, wa, (pixel_vec_t) { 0, 0, 0, 4 }));
+	vec_i32_t res1 = blend_vec(__builtin_shuffle(flo, blo,
+	    (vec_i16_t) { 4, 12, 5, 13, 6, 14, 7, 15 }),
+	    __builtin_shuffle(wc, wa, (pixel_vec_t) { 1, 1, 1, 5 }));
+	vec_i32_t res2 = blend_vec(__builtin_shuffle(fhi, bhi,
+	    (vec_i16_t) { 0, 8, 1, 9, 2, 10, 3, 11 }),
+	    __builtin_shuffle(wc, wa, (pixel_vec_t) { 2, 2, 2, 6 }));
+	vec_i32_t res3 = blend_vec(__builtin_shuffle(fhi, bhi,
+	    (vec_i16_t) { 4, 12, 5, 13, 6, 14, 7, 15 }),
+	    __builtin_shuffle(wc, wa, (pixel_vec_t) { 3, 3, 3, 7 }));
+
+	return (pixel_vec_t) __builtin_ia32_packuswb128(
+	    __builtin_ia32_packssdw128(res0, res1),
+	    __builtin_ia32_packssdw128(res2, res3));
+}
+
+#endif
+
 pixel_t compose_clr(pixel_t fg, pixel_t bg)
 {
 	return 0;
@@ -71,6 +164,90 @@ pixel_t compose_over(pixel_t fg, pixel_t bg)
 	return PIXEL(res_a, res_r, res_g, res_b);
 }
 
+/** Copy a row of source pixels.
+ *
+ * @param dst   Destination row.
+ * @param src   Source row.
+ * @param count Number of pixels.
+ */
+void compose_row_src(pixel_t *dst, const pixel_t *src, size_t count)
+{
+	memcpy(dst, src, count * sizeof(pixel_t));
+}
+
+/** Compose a row of source pixels over a row of destination pixels.
+ *
+ * The result is identical to applying compose_over() to each pixel. Runs
+ * of fully transparent source pixels and of opaque pixels over opaque
+ * destination are recognized, since they are by far the most common.
+ *
+ * @param dst   Destination row.
+ * @param src   Source row.
+ * @param count Number of pixels.
+ */
+void compose_row_over(pixel_t *dst, const pixel_t *src, size_t count)
+{
+	size_t i = 0;
+
+#ifdef __SSE2__
+	for (; i + PIXEL_VEC_COUNT <= count; i += PIXEL_VEC_COUNT) {
+		pixel_vec_t fg;
+		pixel_vec_t bg;
+
+		memcpy(&fg, src + i, sizeof(fg));
+		memcpy(&bg, dst + i, sizeof(bg));
+
+		pixel_vec_t any_fg = fg | __builtin_shuffle(fg,
+		    (pixel_vec_t) { 2, 3, 0, 1 });
+		any_fg |= __builtin_shuffle(any_fg,
+		    (pixel_vec_t) { 1, 0, 3, 2 });
+		if ((any_fg[0] >> 24) == 0)
+			continue;
+
+		pixel_vec_t all = fg & bg;
+		all &= __builtin_shuffle(all, (pixel_vec_t) { 2, 3, 0, 1 });
+		all &= __builtin_shuffle(all, (pixel_vec_t) { 1, 0, 3, 2 });
+		if ((all[0] >> 24) == 255) {
+			memcpy(dst + i, &fg, sizeof(fg));
+			continue;
+		}
+
+		bg = compose_over_vec(fg, bg);
+		memcpy(dst + i, &bg, sizeof(bg));
+	}
+#endif
+
+	for (; i < count; i++) {
+		pixel_t fg = src[i];
+		pixel_t bg = dst[i];
+
+		if (ALPHA(fg) == 0)
+			continue;
+
+		if ((ALPHA(fg) & ALPHA(bg)) == 255)
+			dst[i] = fg;
+		else
+			dst[i] = compose_over(fg, bg);
+	}
+}
+
+/** Get the row version of a composition function.
+ *
+ * @param compose Composition function.
+ *
+ * @return Row composition function or NULL if there is none.
+ */
+compose_row_t compose_get_row(compose_t compose)
+{
+	if (compose == compose_src)
+		return compose_row_src;
+
+	if (compose == compose_over)
+		return compose_row_over;
+
+	return NULL;
+}
+
 pixel_t compose_in(pixel_t fg, pixel_t bg)
 {
 	// TODO
@@ -34,9 +34,13 @@
  * @file
  */
 
+#include <stdint.h>
 #include "filter.h"
 #include <io/pixel.h>
 
+/** Number of fractional bits of fixed point coordinates. */
+#define FIXED_SHIFT  16
+
 
 static long _round(double val)
 {
@@ -60,6 +64,35 @@ static long _ceil(double val)
 }
 
 
+/** Convert a coordinate to fixed point, rounding towards minus infinity. */
+static int64_t _fixed(double val)
+{
+	double scaled = val * (1 << FIXED_SHIFT);
+	int64_t ival = (int64_t) scaled;
+	if (scaled < 0 && ival != scaled)
+		return ival - 1;
+	return ival;
+}
+
+/** Interpolate between two pixels.
+ *
+ * The red and blue, and the alpha and green channels are processed in
+ * pairs, one channel per 16 bits of a 32-bit word.
+ *
+ * @param pix0   First pixel.
+ * @param pix1   Second pixel.
+ * @param weight Weight of the second pixel in 1/256 units (0 to 255).
+ */
+static inline pixel_t lerp_pixels(pixel_t pix0, pixel_t pix1, uint32_t weight)
+{
+	uint32_t rb = ((pix0 & 0x00ff00ff) * (256 - weight) +
+	    (pix1 & 0x00ff00ff) * weight) >> 8;
+	uint32_t ag = ((pix0 >> 8) & 0x00ff00ff) * (256 - weight) +
+	    ((pix1 >> 8) & 0x00ff00ff) * weight;
+
+	return (rb & 0x00ff00ff) | (ag & 0xff00ff00);
+}
+
 static inline pixel_t blend_pixels(size_t count, float *weights,
     pixel_t *pixels)
 {
@@ -119,5 +152,113 @@ pixel_t filter_bicubic(pixelmap_t *pixmap, double x, double y,
 	return 0;
 }
 
+/** Sample a row of pixels using the nearest neighbour filter.
+ *
+ * @param pixmap Pixel map to sample.
+ * @param x      Horizontal coordinate of the first sample.
+ * @param y      Vertical coordinate of the first sample.
+ * @param dx     Horizontal distance between samples.
+ * @param dy     Vertical distance between samples.
+ * @param extend Handling of coordinates outside of the pixel map.
+ * @param row    Row receiving the samples.
+ * @param count  Number of samples.
+ */
+void filter_nearest_row(pixelmap_t *pixmap, double x, double y, double dx,
+    double dy, pixelmap_extend_t extend, pixel_t *row, size_t count)
+{
+	int64_t fx = _fixed(x) + (1 << (FIXED_SHIFT - 1));
+	int64_t fy = _fixed(y) + (1 << (FIXED_SHIFT - 1));
+	int64_t step_x = _fixed(dx);
+	int64_t step_y = _fixed(dy);
+
+	for (size_t i = 0; i < count; i++) {
+		native_t px = fx >> FIXED_SHIFT;
+		native_t py = fy >> FIXED_SHIFT;
+
+		if ((px >= 0) && ((sysarg_t) px < pixmap->width) &&
+		    (py >= 0) && ((sysarg_t) py < pixmap->height)) {
+			row[i] = pixmap->data[py * pixmap->width + px];
+		} else {
+			row[i] = pixelmap_get_extended_pixel(pixmap, px, py,
+			    extend);
+		}
+
+		fx += step_x;
+		fy += step_y;
+	}
+}
+
+/** Sample a row of pixels using the bilinear filter.
+ *
+ * The coordinates are stepped in fixed point and the interpolation is
+ * done in integer arithmetic with 8-bit weights.
+ *
+ * @param pixmap Pixel map to sample.
+ * @param x      Horizontal coordinate of the first sample.
+ * @param y      Vertical coordinate of the first sample.
+ * @param dx     Horizontal distance between samples.
+ * @param dy     Vertical distance between samples.
+ * @param extend Handling of coordinates outside of the pixel map.
+ * @param row    Row receiving the samples.
+ * @param count  Number of samples.
+ */
+void filter_bilinear_row(pixelmap_t *pixmap, double x, double y, double dx,
+    double dy, pixelmap_extend_t extend, pixel_t *row, size_t count)
+{
+	int64_t fx = _fixed(x);
+	int64_t fy = _fixed(y);
+	int64_t step_x = _fixed(dx);
+	int64_t step_y = _fixed(dy);
+
+	for (size_t i = 0; i < count; i++) {
+		native_t x1 = fx >> FIXED_SHIFT;
+		native_t y1 = fy >> FIXED_SHIFT;
+		uint32_t wx = (fx >> (FIXED_SHIFT - 8)) & 0xff;
+		uint32_t wy = (fy >> (FIXED_SHIFT - 8)) & 0xff;
+
+		pixel_t pixels[4];
+		if ((x1 >= 0) && ((sysarg_t) x1 + 1 < pixmap->width) &&
+		    (y1 >= 0) && ((sysarg_t) y1 + 1 < pixmap->height)) {
+			pixel_t *src = pixmap->data + y1 * pixmap->width + x1;
+			pixels[0] = src[0];
+			pixels[1] = src[1];
+			pixels[2] = src[pixmap->width];
+			pixels[3] = src[pixmap->width + 1];
+		} else {
+			pixels[0] = pixelmap_get_extended_pixel(pixmap,
+			    x1, y1, extend);
+			pixels[1] = pixelmap_get_extended_pixel(pixmap,
+			    x1 + 1, y1, extend);
+			pixels[2] = pixelmap_get_extended_pixel(pixmap,
+			    x1, y1 + 1, extend);
+			pixels[3] = pixelmap_get_extended_pixel(pixmap,
+			    x1 + 1, y1 + 1, extend);
+		}
+
+		row[i] = lerp_pixels(lerp_pixels(pixels[0], pixels[1], wx),
+		    lerp_pixels(pixels[2], pixels[3], wx), wy);
+
+		fx += step_x;
+		fy += step_y;
+	}
+}
+
+/** Get the row version of a filter.
+ *
+ * @param filter Filter function.
+ *
+ * @return Row filter function or NULL if there is none.
+ */
+filter_row_t filter_get_row(filter_t filter)
+{
+	if (filter == filter_nearest)
+		return filter_nearest_row;
+
+	if (filter == filter_bilinear)
+		return filter_bilinear_row;
+
+	return NULL;
+}
+
 /** @}
  */
@@ -36,14 +36,25 @@
 #ifndef SOFTREND_FILTER_H_
 #define SOFTREND_FILTER_H_
 
+#include <stddef.h>
 #include <io/pixelmap.h>
 
 typedef pixel_t (*filter_t)(pixelmap_t *, double, double, pixelmap_extend_t);
 
+/** Sample a row of pixels at evenly spaced points of a line. */
+typedef void (*filter_row_t)(pixelmap_t *, double, double, double, double,
+    pixelmap_extend_t, pixel_t *, size_t);
+
 extern pixel_t filter_nearest(pixelmap_t *, double, double, pixelmap_extend_t);
 extern pixel_t filter_bilinear(pixelmap_t *, double, double, pixelmap_extend_t);
 extern pixel_t filter_bicubic(pixelmap_t *, double, double, pixelmap_extend_t);
 
+extern void filter_nearest_row(pixelmap_t *, double, double, double, double,
+    pixelmap_extend_t, pixel_t *, size_t);
+extern void filter_bilinear_row(pixelmap_t *, double, double, double, double,
+    pixelmap_extend_t, pixel_t *, size_t);
+extern filter_row_t filter_get_row(filter_t);
+
 #endif
 
 /** @}
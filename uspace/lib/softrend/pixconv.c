@@ -147,6 +147,38 @@ void pixel2gray_8(void *dst, pixel_t pix)
 	*((uint8_t *) dst) = (red + green + blue) >> 24;
 }
 
+/*
+ * Row versions of the conversion functions. Having the per-pixel
+ * conversion inlined into a loop over the row avoids an indirect call per
+ * pixel and lets the compiler vectorize the simple formats.
+ */
+#define PIXEL2VISUAL_ROW(visual, bytes) \
+	void pixel2##visual##_row(void *dst, const pixel_t *src, size_t count) \
+	{ \
+		uint8_t *target = (uint8_t *) dst; \
+		for (size_t i = 0; i < count; i++) { \
+			pixel2##visual(target, src[i]); \
+			target += (bytes); \
+		} \
+	}
+
+PIXEL2VISUAL_ROW(argb_8888, 4)
+PIXEL2VISUAL_ROW(abgr_8888, 4)
+PIXEL2VISUAL_ROW(rgba_8888, 4)
+PIXEL2VISUAL_ROW(bgra_8888, 4)
+PIXEL2VISUAL_ROW(rgb_0888, 4)
+PIXEL2VISUAL_ROW(bgr_0888, 4)
+PIXEL2VISUAL_ROW(rgb_8880, 4)
+PIXEL2VISUAL_ROW(bgr_8880, 4)
+PIXEL2VISUAL_ROW(rgb_888, 3)
+PIXEL2VISUAL_ROW(bgr_888, 3)
+PIXEL2VISUAL_ROW(rgb_555_be, 2)
+PIXEL2VISUAL_ROW(rgb_555_le, 2)
+PIXEL2VISUAL_ROW(rgb_565_be, 2)
+PIXEL2VISUAL_ROW(rgb_565_le, 2)
+PIXEL2VISUAL_ROW(bgr_323, 1)
+PIXEL2VISUAL_ROW(gray_8, 1)
+
 void visual_mask_8888(void *dst, bool mask)
 {
 	pixel2abgr_8888(dst, mask ? 0xffffffff : 0);
@@ -38,6 +38,7 @@
 #define SOFTREND_PIXCONV_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <io/pixel.h>
 
 /** Function to render a pixel. */
@@ -49,6 +50,9 @@ typedef void (*visual_mask_t)(void *, bool);
 /** Function to retrieve a pixel. */
 typedef pixel_t (*visual2pixel_t)(void *);
 
+/** Function to render a row of pixels. */
+typedef void (*pixel2visual_row_t)(void *, const pixel_t *, size_t);
+
 extern void pixel2argb_8888(void *, pixel_t);
 extern void pixel2abgr_8888(void *, pixel_t);
 extern void pixel2rgba_8888(void *, pixel_t);
@@ -66,6 +70,23 @@ extern void pixel2rgb_565_le(void *, pixel_t);
 extern void pixel2bgr_323(void *, pixel_t);
 extern void pixel2gray_8(void *, pixel_t);
 
+extern void pixel2argb_8888_row(void *, const pixel_t *, size_t);
+extern void pixel2abgr_8888_row(void *, const pixel_t *, size_t);
+extern void pixel2rgba_8888_row(void *, const pixel_t *, size_t);
+extern void pixel2bgra_8888_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_0888_row(void *, const pixel_t *, size_t);
+extern void pixel2bgr_0888_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_8880_row(void *, const pixel_t *, size_t);
+extern void pixel2bgr_8880_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_888_row(void *, const pixel_t *, size_t);
+extern void pixel2bgr_888_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_555_be_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_555_le_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_565_be_row(void *, const pixel_t *, size_t);
+extern void pixel2rgb_565_le_row(void *, const pixel_t *, size_t);
+extern void pixel2bgr_323_row(void *, const pixel_t *, size_t);
+extern void pixel2gray_8_row(void *, const pixel_t *, size_t);
+
 extern void visual_mask_8888(void *, bool);
 extern void visual_mask_0888(void *, bool);
 extern void visual_mask_8880(void *, bool);
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <io/pixel.h>
+#include <io/pixelmap.h>
+#include <mem.h>
+#include <pcut/pcut.h>
+#include <stdint.h>
+#include "../compose.h"
+#include "../filter.h"
+#include "../pixconv.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(row);
+
+/** Row length not divisible by the vector width to exercise the tails. */
+#define COUNT  61
+
+#define TEX_WIDTH   16
+#define TEX_HEIGHT  8
+
+static uint32_t seed;
+
+static pixel_t random_pixel(void)
+{
+	seed = seed * 1103515245 + 12345;
+	pixel_t pixel = (seed >> 4) ^ (seed << 20);
+
+	/* Include the transparent and opaque special cases. */
+	switch ((seed >> 8) & 3) {
+	case 0:
+		return pixel & 0x00ffffff;
+	case 1:
+		return pixel | 0xff000000;
+	default:
+		return pixel;
+	}
+}
+
+static void random_row(pixel_t *row, size_t count)
+{
+	for (size_t i = 0; i < count; i++)
+		row[i] = random_pixel();
+}
+
+static unsigned int channel_diff(pixel_t a, pixel_t b, unsigned int shift)
+{
+	unsigned int ca = (a >> shift) & 0xff;
+	unsigned int cb = (b >> shift) & 0xff;
+
+	return (ca > cb) ? ca - cb : cb - ca;
+}
+
+/** Row over composition matches per-pixel composition exactly */
+PCUT_TEST(compose_over_exact)
+{
+	pixel_t src[COUNT];
+	pixel_t dst[COUNT];
+	pixel_t ref[COUNT];
+
+	seed = 1;
+	for (unsigned int round = 0; round < 64; round++) {
+		random_row(src, COUNT);
+		random_row(dst, COUNT);
+
+		for (size_t i = 0; i < COUNT; i++)
+			ref[i] = compose_over(src[i], dst[i]);
+
+		compose_row_over(dst, src, COUNT);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(dst, ref, sizeof(ref)));
+	}
+}
+
+/** Row kernels are found for the operators that have them */
+PCUT_TEST(kernel_lookup)
+{
+	PCUT_ASSERT_TRUE(compose_get_row(compose_src) == compose_row_src);
+	PCUT_ASSERT_TRUE(compose_get_row(compose_over) == compose_row_over);
+	PCUT_ASSERT_TRUE(compose_get_row(compose_xor) == NULL);
+
+	PCUT_ASSERT_TRUE(filter_get_row(filter_nearest) == filter_nearest_row);
+	PCUT_ASSERT_TRUE(filter_get_row(filter_bilinear) ==
+	    filter_bilinear_row);
+	PCUT_ASSERT_TRUE(filter_get_row(filter_bicubic) == NULL);
+}
+
+/** Nearest neighbour row sampling matches per-pixel sampling */
+PCUT_TEST(nearest_exact)
+{
+	pixel_t data[TEX_WIDTH * TEX_HEIGHT];
+	pixelmap_t pixmap = {
+		.width = TEX_WIDTH,
+		.height = TEX_HEIGHT,
+		.data = data
+	};
+	pixel_t row[COUNT];
+
+	seed = 2;
+	random_row(data, TEX_WIDTH * TEX_HEIGHT);
+
+	filter_nearest_row(&pixmap, -2.25, 1.5, 0.375, 0.125,
+	    PIXELMAP_EXTEND_TRANSPARENT_SIDES, row, COUNT);
+
+	for (size_t i = 0; i < COUNT; i++) {
+		pixel_t ref = filter_nearest(&pixmap, -2.25 + i * 0.375,
+		    1.5 + i * 0.125, PIXELMAP_EXTEND_TRANSPARENT_SIDES);
+		PCUT_ASSERT_INT_EQUALS(ref, row[i]);
+	}
+}
+
+/** Bilinear row sampling stays within rounding of per-pixel sampling */
+PCUT_TEST(bilinear_rounding)
+{
+	pixel_t data[TEX_WIDTH * TEX_HEIGHT];
+	pixelmap_t pixmap = {
+		.width = TEX_WIDTH,
+		.height = TEX_HEIGHT,
+		.data = data
+	};
+	pixel_t row[COUNT];
+
+	seed = 3;
+	random_row(data, TEX_WIDTH * TEX_HEIGHT);
+
+	filter_bilinear_row(&pixmap, -1.75, 0.5, 0.3, 0.1,
+	    PIXELMAP_EXTEND_TRANSPARENT_SIDES, row, COUNT);
+
+	for (size_t i = 0; i < COUNT; i++) {
+		pixel_t ref = filter_bilinear(&pixmap, -1.75 + i * 0.3,
+		    0.5 + i * 0.1, PIXELMAP_EXTEND_TRANSPARENT_SIDES);
+
+		for (unsigned int shift = 0; shift < 32; shift += 8)
+			PCUT_ASSERT_TRUE(channel_diff(ref, row[i], shift) <= 3);
+	}
+}
+
+/** Row conversion produces the same visual data as per-pixel conversion */
+PCUT_TEST(pixel2visual_exact)
+{
+	static const struct {
+		pixel2visual_t pixel;
+		pixel2visual_row_t row;
+		size_t bytes;
+	} visuals[] = {
+		{ pixel2argb_8888, pixel2argb_8888_row, 4 },
+		{ pixel2rgb_0888, pixel2rgb_0888_row, 4 },
+		{ pixel2bgr_888, pixel2bgr_888_row, 3 },
+		{ pixel2rgb_565_le, pixel2rgb_565_le_row, 2 },
+		{ pixel2rgb_555_be, pixel2rgb_555_be_row, 2 },
+		{ pixel2gray_8, pixel2gray_8_row, 1 }
+	};
+	pixel_t src[COUNT];
+	uint8_t ref[COUNT * 4];
+	uint8_t dst[COUNT * 4];
+
+	seed = 4;
+	random_row(src, COUNT);
+
+	for (size_t v = 0; v < sizeof(visuals) / sizeof(visuals[0]); v++) {
+		memset(ref, 0, sizeof(ref));
+		memset(dst, 0, sizeof(dst));
+
+		for (size_t i = 0; i < COUNT; i++)
+			visuals[v].pixel(ref + i * visuals[v].bytes, src[i]);
+
+		visuals[v].row(dst, src, COUNT);
+		PCUT_ASSERT_INT_EQUALS(0, memcmp(dst, ref, sizeof(ref)));
+	}
+}
+
+PCUT_EXPORT(row);
@@ -222,6 +222,16 @@ typedef struct {
 	struct fat_node	*nodep;
 } fat_idx_t;
 
+/** Run of physically contiguous clusters of a node. */
+typedef struct {
+	/** Index of the first cluster of the run within the node. */
+	uint32_t	fcl;
+	/** First cluster of the run on the volume. */
+	fat_cluster_t	clst;
+	/** Number of clusters in the run. */
+	uint32_t	len;
+} fat_extent_t;
+
 /** FAT in-core node. */
 typedef struct fat_node {
 	/** Back pointer to the FS node. */
@@ -254,10 +264,35 @@ typedef struct fat_node {
 	bool		currc_cached_valid;
 	aoff64_t	currc_cached_bn;
 	fat_cluster_t	currc_cached_value;
+
+	/*
+	 * Map of the node's cluster chain to runs of contiguous clusters,
+	 * sorted by the cluster index within the node. It is built on the
+	 * first access that is not served by the caches above and extended
+	 * when clusters are appended to the node.
+	 */
+	bool		extents_valid;
+	fat_extent_t	*extents;
+	size_t		extents_count;
+	size_t		extents_alloc;
+	/* Number of clusters covered by the map. */
+	uint32_t	extents_clusters;
 } fat_node_t;
 
-typedef struct {
+typedef struct fat_instance {
 	bool lfn_enabled;
+
+	/** Serializes allocation of clusters and updates of the free map. */
+	fibril_mutex_t alloc_lock;
+	/**
+	 * Bitmap of free clusters, built at mount time. Bit N is set if
+	 * cluster FAT_CLST_FIRST + N is free.
+	 */
+	uint32_t *free_map;
+	/** Number of free clusters. */
+	uint32_t free_count;
+	/** Cluster where the next allocation starts searching. */
+	fat_cluster_t next_free;
 } fat_instance_t;
 
 extern vfs_out_ops_t fat_ops;
@@ -52,12 +52,11 @@
 
 #define IS_ODD(number)	(number & 0x1)
 
-/**
- * The fat_alloc_lock mutex protects all copies of the File Allocation Table
- * during allocation of clusters. The lock does not have to be held durring
- * deallocation of clusters.
- */
-static FIBRIL_MUTEX_INITIALIZE(fat_alloc_lock);
+/** Initial number of entries in a node's extent map. */
+#define FAT_EXTENTS_MIN	8
+
+/** Number of clusters tracked by one word of the free cluster bitmap. */
+#define FAT_MAP_BITS	32
 
 /** Walk the cluster chain.
  *
@@ -112,6 +111,219 @@ fat_cluster_walk(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc,
 	return EOK;
 }
 
+/** Add a cluster to the end of an array of extents.
+ *
+ * @param extp		Pointer to the extent array.
+ * @param countp	Pointer to the number of extents in the array.
+ * @param allocp	Pointer to the number of allocated array entries.
+ * @param fcl		Index of the cluster within the node.
+ * @param clst		Cluster number.
+ *
+ * @return		EOK on success or ENOMEM.
+ */
+static errno_t fat_extent_add(fat_extent_t **extp, size_t *countp,
+    size_t *allocp, uint32_t fcl, fat_cluster_t clst)
+{
+	fat_extent_t *ext = *extp;
+	size_t count = *countp;
+
+	if (count > 0 && ext[count - 1].fcl + ext[count - 1].len == fcl &&
+	    ext[count - 1].clst + ext[count - 1].len == clst) {
+		/* The cluster continues the last run. */
+		ext[count - 1].len++;
+		return EOK;
+	}
+
+	if (count == *allocp) {
+		size_t nalloc = max(2 * *allocp, FAT_EXTENTS_MIN);
+
+		ext = realloc(ext, nalloc * sizeof(fat_extent_t));
+		if (!ext)
+			return ENOMEM;
+		*extp = ext;
+		*allocp = nalloc;
+	}
+
+	ext[count].fcl = fcl;
+	ext[count].clst = clst;
+	ext[count].len = 1;
+	*countp = count + 1;
+
+	return EOK;
+}
+
+/** Walk a cluster chain and add its clusters to an array of extents.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param firstc	First cluster of the chain.
+ * @param fcl		Index of the first cluster within the node.
+ * @param extp		Pointer to the extent array.
+ * @param countp	Pointer to the number of extents in the array.
+ * @param allocp	Pointer to the number of allocated array entries.
+ * @param clustersp	Output argument holding the number of clusters
+ *			in the chain.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t fat_extents_collect(fat_bs_t *bs, service_id_t service_id,
+    fat_cluster_t firstc, uint32_t fcl, fat_extent_t **extp, size_t *countp,
+    size_t *allocp, uint32_t *clustersp)
+{
+	fat_cluster_t clst = firstc;
+	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
+	fat_cluster_t clst_bad = FAT_CLST_BAD(bs);
+	uint32_t clusters = 0;
+	errno_t rc;
+
+	while (clst < clst_last1) {
+		/* Do not loop forever on a corrupted chain. */
+		if (clst < FAT_CLST_FIRST || clst >= clst_bad ||
+		    clusters >= CC(bs))
+			return EIO;
+
+		rc = fat_extent_add(extp, countp, allocp, fcl + clusters, clst);
+		if (rc != EOK)
+			return rc;
+
+		rc = fat_get_cluster(bs, service_id, FAT1, clst, &clst);
+		if (rc != EOK)
+			return rc;
+
+		clusters++;
+	}
+
+	*clustersp = clusters;
+	return EOK;
+}
+
+/** Drop the extent map of a node.
+ *
+ * @param nodep		FAT node.
+ */
+void fat_extents_clear(fat_node_t *nodep)
+{
+	free(nodep->extents);
+	nodep->extents = NULL;
+	nodep->extents_count = 0;
+	nodep->extents_alloc = 0;
+	nodep->extents_clusters = 0;
+	nodep->extents_valid = false;
+}
+
+/** Build the extent map of a node from its cluster chain.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		FAT node.
+ *
+ * @return		EOK on success or an error code.
+ */
+static errno_t fat_extents_build(fat_bs_t *bs, fat_node_t *nodep)
+{
+	fat_extent_t *ext = NULL;
+	size_t count = 0;
+	size_t alloc = 0;
+	uint32_t clusters = 0;
+	errno_t rc;
+
+	if (nodep->firstc != FAT_CLST_RES0) {
+		rc = fat_extents_collect(bs, nodep->idx->service_id,
+		    nodep->firstc, 0, &ext, &count, &alloc, &clusters);
+		if (rc != EOK) {
+			free(ext);
+			return rc;
+		}
+	}
+
+	/*
+	 * Another reader may have built the map while we were walking
+	 * the chain.
+	 */
+	if (nodep->extents_valid) {
+		free(ext);
+		return EOK;
+	}
+
+	fat_extents_clear(nodep);
+	nodep->extents = ext;
+	nodep->extents_count = count;
+	nodep->extents_alloc = alloc;
+	nodep->extents_clusters = clusters;
+	nodep->extents_valid = true;
+
+	return EOK;
+}
+
+/** Extend the extent map of a node by an appended cluster chain.
+ *
+ * If the map cannot be extended, it is dropped and rebuilt on demand.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		FAT node.
+ * @param mcl		First cluster of the appended chain.
+ */
+static void fat_extents_extend(fat_bs_t *bs, fat_node_t *nodep,
+    fat_cluster_t mcl)
+{
+	uint32_t clusters;
+	errno_t rc;
+
+	if (!nodep->extents_valid)
+		return;
+
+	rc = fat_extents_collect(bs, nodep->idx->service_id, mcl,
+	    nodep->extents_clusters, &nodep->extents, &nodep->extents_count,
+	    &nodep->extents_alloc, &clusters);
+	if (rc != EOK) {
+		fat_extents_clear(nodep);
+		return;
+	}
+
+	nodep->extents_clusters += clusters;
+}
+
+/** Translate a cluster index within a node to a cluster number.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param nodep		FAT node.
+ * @param fcl		Index of the cluster within the node.
+ * @param clst		Output argument holding the cluster number.
+ *
+ * @return		EOK on success, ENOENT if the node does not have
+ *			that many clusters or another error code.
+ */
+static errno_t fat_extents_lookup(fat_bs_t *bs, fat_node_t *nodep,
+    uint32_t fcl, fat_cluster_t *clst)
+{
+	fat_extent_t *ext;
+	size_t lo, hi, mid;
+	errno_t rc;
+
+	if (!nodep->extents_valid) {
+		rc = fat_extents_build(bs, nodep);
+		if (rc != EOK)
+			return rc;
+	}
+
+	if (fcl >= nodep->extents_clusters)
+		return ENOENT;
+
+	/* Find the last extent starting at or before fcl. */
+	ext = nodep->extents;
+	lo = 0;
+	hi = nodep->extents_count;
+	while (hi - lo > 1) {
+		mid = lo + (hi - lo) / 2;
+		if (ext[mid].fcl <= fcl)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	*clst = ext[lo].clst + (fcl - ext[lo].fcl);
+	return EOK;
+}
+
 /** Read block from file located on a FAT file system.
  *
  * @param block		Pointer to a block pointer for storing result.
@@ -147,6 +359,18 @@ fat_block_get(block_t **block, struct fat_bs *bs, fat_node_t *nodep,
 		    CLBN2PBN(bs, nodep->lastc_cached_value, bn), flags);
 	}
 
+	/*
+	 * Find the cluster in the extent map. The chain is walked below only
+	 * if there is not enough memory for the map.
+	 */
+	rc = fat_extents_lookup(bs, nodep, bn / SPC(bs), &currc);
+	if (rc == EOK) {
+		return block_get(block, nodep->idx->service_id,
+		    CLBN2PBN(bs, currc, bn), flags);
+	}
+	if (rc != ENOMEM)
+		return rc;
+
 	if (nodep->currc_cached_valid && bn >= nodep->currc_cached_bn) {
 		/*
 		 * We can start with the cluster cached by the previous call to
@@ -655,6 +879,243 @@ errno_t fat_alloc_shadow_clusters(fat_bs_t *bs, service_id_t service_id,
 	return EOK;
 }
 
+/** Find the next cluster with the given state in the free cluster bitmap.
+ *
+ * @param instance	FAT instance.
+ * @param bit		Bit where to start the search.
+ * @param end		Bit where to end the search.
+ * @param is_free	Search for a free cluster if true, for a used one
+ *			otherwise.
+ *
+ * @return		Bit of the cluster found or @a end if there is none.
+ */
+static uint32_t fat_free_map_next(fat_instance_t *instance, uint32_t bit,
+    uint32_t end, bool is_free)
+{
+	uint32_t word;
+
+	while (bit < end) {
+		word = instance->free_map[bit / FAT_MAP_BITS];
+		if (!is_free)
+			word = ~word;
+		word >>= bit % FAT_MAP_BITS;
+
+		if (word != 0)
+			return min(bit + __builtin_ctz(word), end);
+
+		/* Skip the rest of the word. */
+		bit = ALIGN_DOWN(bit, FAT_MAP_BITS) + FAT_MAP_BITS;
+	}
+
+	return end;
+}
+
+/** Find a run of free clusters in the free cluster bitmap.
+ *
+ * @param instance	FAT instance.
+ * @param bit		Bit where to start the search.
+ * @param end		Bit where to end the search.
+ * @param nclsts	Length of the run.
+ *
+ * @return		First bit of the run or @a end if there is none.
+ */
+static uint32_t fat_free_map_run(fat_instance_t *instance, uint32_t bit,
+    uint32_t end, unsigned nclsts)
+{
+	uint32_t used;
+
+	while ((bit = fat_free_map_next(instance, bit, end, true)) < end) {
+		if (end - bit < nclsts)
+			break;
+
+		used = fat_free_map_next(instance, bit, bit + nclsts, false);
+		if (used - bit == nclsts)
+			return bit;
+
+		bit = used;
+	}
+
+	return end;
+}
+
+/** Mark a cluster free or used in the free cluster bitmap.
+ *
+ * @param instance	FAT instance with alloc_lock held.
+ * @param clst		Cluster number.
+ * @param is_free	New state of the cluster.
+ */
+static void fat_free_map_update(fat_instance_t *instance, fat_cluster_t clst,
+    bool is_free)
+{
+	uint32_t bit = clst - FAT_CLST_FIRST;
+	uint32_t *word = &instance->free_map[bit / FAT_MAP_BITS];
+	uint32_t mask = 1U << (bit % FAT_MAP_BITS);
+
+	/* Tolerate inconsistencies such as cross-linked chains. */
+	if (((*word & mask) != 0) == is_free)
+		return;
+
+	if (is_free) {
+		*word |= mask;
+		instance->free_count++;
+	} else {
+		*word &= ~mask;
+		instance->free_count--;
+	}
+}
+
+/** Take free clusters from the free cluster bitmap.
+ *
+ * Next-fit allocation which prefers a contiguous run of clusters. The search
+ * starts where the previous allocation ended. If there is no run long enough,
+ * the first free clusters found are taken.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param instance	FAT instance with alloc_lock held.
+ * @param nclsts	Number of clusters to take.
+ * @param lifo		Array where to store the taken clusters, the first
+ *			cluster of the future chain last.
+ *
+ * @return		EOK on success or ENOSPC.
+ */
+static errno_t fat_free_map_take(fat_bs_t *bs, fat_instance_t *instance,
+    unsigned nclsts, fat_cluster_t *lifo)
+{
+	uint32_t clusters = CC(bs);
+	uint32_t start;
+	uint32_t bit;
+	unsigned found;
+	bool wrapped = false;
+
+	if (instance->free_count < nclsts)
+		return ENOSPC;
+
+	start = instance->next_free - FAT_CLST_FIRST;
+	if (start >= clusters)
+		start = 0;
+
+	bit = fat_free_map_run(instance, start, clusters, nclsts);
+	if (bit == clusters)
+		bit = fat_free_map_run(instance, 0, clusters, nclsts);
+
+	if (bit < clusters) {
+		for (found = 0; found < nclsts; found++)
+			lifo[nclsts - 1 - found] = FAT_CLST_FIRST + bit + found;
+	} else {
+		bit = start;
+		for (found = 0; found < nclsts; found++) {
+			bit = fat_free_map_next(instance, bit, clusters, true);
+			if (bit == clusters) {
+				if (wrapped)
+					return ENOSPC;
+				wrapped = true;
+				bit = fat_free_map_next(instance, 0, clusters,
+				    true);
+				if (bit == clusters)
+					return ENOSPC;
+			}
+			lifo[nclsts - 1 - found] = FAT_CLST_FIRST + bit++;
+		}
+	}
+
+	for (found = 0; found < nclsts; found++)
+		fat_free_map_update(instance, lifo[found], false);
+
+	instance->next_free = lifo[0] + 1;
+	return EOK;
+}
+
+/** Build the free cluster bitmap of a file system instance.
+ *
+ * @param bs		Buffer holding the boot sector of the file system.
+ * @param service_id	Service ID of the file system.
+ * @param instance	FAT instance.
+ *
+ * @return		EOK on success or an error code.
+ */
+errno_t fat_free_map_init(fat_bs_t *bs, service_id_t service_id,
+    fat_instance_t *instance)
+{
+	uint32_t clusters = CC(bs);
+	fat_cluster_t end = FAT_CLST_FIRST + clusters;
+	fat_cluster_t clst;
+	fat_cluster_t value;
+	block_t *b;
+	errno_t rc;
+
+	fibril_mutex_initialize(&instance->alloc_lock);
+	instance->free_count = 0;
+	instance->next_free = FAT_CLST_FIRST;
+	instance->free_map = calloc(clusters / FAT_MAP_BITS + 1,
+	    sizeof(uint32_t));
+	if (!instance->free_map)
+		return ENOMEM;
+
+	/* Clusters beyond the end of the FAT cannot be allocated. */
+	if (FAT_IS_FAT12(bs))
+		end = min(end, (fat_cluster_t) (SF(bs) * BPS(bs) * 2 / 3));
+	else
+		end = min(end, SF(bs) * BPS(bs) / FAT_CLST_SIZE(bs));
+
+	clst = FAT_CLST_FIRST;
+	while (clst < end) {
+		if (FAT_IS_FAT12(bs)) {
+			/* FAT12 entries may span sector boundaries. */
+			rc = fat_get_cluster(bs, service_id, FAT1, clst,
+			    &value);
+			if (rc != EOK)
+				goto error;
+			if (value == FAT_CLST_RES0)
+				fat_free_map_update(instance, clst, true);
+			clst++;
+			continue;
+		}
+
+		/* Process all entries in this sector of the FAT at once. */
+		aoff64_t bn = (clst * FAT_CLST_SIZE(bs)) / BPS(bs);
+		rc = block_get(&b, service_id, RSCNT(bs) + bn,
+		    BLOCK_FLAGS_NONE);
+		if (rc != EOK)
+			goto error;
+
+		for (; clst < end &&
+		    (clst * FAT_CLST_SIZE(bs)) / BPS(bs) == bn; clst++) {
+			uint8_t *ep = b->data +
+			    (clst * FAT_CLST_SIZE(bs)) % BPS(bs);
+
+			if (FAT_IS_FAT32(bs)) {
+				value = uint32_t_le2host(*(uint32_t *) ep) &
+				    FAT32_MASK;
+			} else {
+				value = uint16_t_le2host(*(uint16_t *) ep);
+			}
+			if (value == FAT_CLST_RES0)
+				fat_free_map_update(instance, clst, true);
+		}
+
+		rc = block_put(b);
+		if (rc != EOK)
+			goto error;
+	}
+
+	return EOK;
+
+error:
+	fat_free_map_fini(instance);
+	return rc;
+}
+
+/** Destroy the free cluster bitmap of a file system instance.
+ *
+ * @param instance	FAT instance.
+ */
+void fat_free_map_fini(fat_instance_t *instance)
+{
+	free(instance->free_map);
+	instance->free_map = NULL;
+	instance->free_count = 0;
+}
+
 /** Allocate clusters in all copies of FAT.
  *
  * This function will attempt to allocate the requested number of clusters in
@@ -662,6 +1123,9 @@ errno_t fat_alloc_shadow_clusters(fat_bs_t *bs, service_id_t service_id,
  * clusters form an independent chain (i.e. a chain which does not belong to any
  * file yet).
  *
+ * Free clusters are found in the in-memory free cluster bitmap rather than by
+ * scanning the FAT.
+ *
  * @param bs		Buffer holding the boot sector of the file system.
  * @param service_id	Device service ID of the file system.
  * @param nclsts	Number of clusters to allocate.
@@ -676,63 +1140,62 @@ errno_t
 fat_alloc_clusters(fat_bs_t *bs, service_id_t service_id, unsigned nclsts,
     fat_cluster_t *mcl, fat_cluster_t *lcl)
 {
+	fat_instance_t *instance;
 	fat_cluster_t *lifo;    /* stack for storing free cluster numbers */
-	unsigned found = 0;     /* top of the free cluster number stack */
-	fat_cluster_t clst;
-	fat_cluster_t value = 0;
 	fat_cluster_t clst_last1 = FAT_CLST_LAST1(bs);
-	errno_t rc = EOK;
+	unsigned c;
+	void *data;
+	errno_t rc;
+
+	rc = fs_instance_get(service_id, &data);
+	if (rc != EOK)
+		return rc;
+	instance = (fat_instance_t *) data;
 
 	lifo = (fat_cluster_t *) malloc(nclsts * sizeof(fat_cluster_t));
 	if (!lifo)
 		return ENOMEM;
 
-	/*
-	 * Search FAT1 for unused clusters.
-	 */
-	fibril_mutex_lock(&fat_alloc_lock);
-	for (clst = FAT_CLST_FIRST; clst < CC(bs) + 2 && found < nclsts;
-	    clst++) {
-		rc = fat_get_cluster(bs, service_id, FAT1, clst, &value);
+	fibril_mutex_lock(&instance->alloc_lock);
+	rc = fat_free_map_take(bs, instance, nclsts, lifo);
+	if (rc != EOK) {
+		fibril_mutex_unlock(&instance->alloc_lock);
+		free(lifo);
+		return rc;
+	}
+
+	/* Link the clusters into an independent chain in FAT1. */
+	for (c = 0; c < nclsts; c++) {
+		rc = fat_set_cluster(bs, service_id, FAT1, lifo[c],
+		    (c == 0) ? clst_last1 : lifo[c - 1]);
 		if (rc != EOK)
 			break;
-
-		if (value == FAT_CLST_RES0) {
-			/*
-			 * The cluster is free. Put it into our stack
-			 * of found clusters and mark it as non-free.
-			 */
-			lifo[found] = clst;
-			rc = fat_set_cluster(bs, service_id, FAT1, clst,
-			    (found == 0) ?  clst_last1 : lifo[found - 1]);
-			if (rc != EOK)
-				break;
-
-			found++;
-		}
 	}
 
-	if (rc == EOK && found == nclsts) {
+	if (rc == EOK) {
 		rc = fat_alloc_shadow_clusters(bs, service_id, lifo, nclsts);
 		if (rc == EOK) {
-			*mcl = lifo[found - 1];
+			*mcl = lifo[nclsts - 1];
 			*lcl = lifo[0];
+			fibril_mutex_unlock(&instance->alloc_lock);
 			free(lifo);
-			fibril_mutex_unlock(&fat_alloc_lock);
 			return EOK;
 		}
 	}
 
 	/* If something wrong - free the clusters */
-	while (found--) {
-		(void) fat_set_cluster(bs, service_id, FAT1, lifo[found],
+	while (c--) {
+		(void) fat_set_cluster(bs, service_id, FAT1, lifo[c],
 		    FAT_CLST_RES0);
 	}
 
+	for (c = 0; c < nclsts; c++)
+		fat_free_map_update(instance, lifo[c], true);
+
+	fibril_mutex_unlock(&instance->alloc_lock);
 	free(lifo);
-	fibril_mutex_unlock(&fat_alloc_lock);
 
-	return ENOSPC;
+	return rc;
 }
 
 /** Free clusters forming a cluster chain in all copies of FAT.
@@ -749,8 +1212,13 @@ fat_free_clusters(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc)
 	unsigned fatno;
 	fat_cluster_t nextc = 0;
 	fat_cluster_t clst_bad = FAT_CLST_BAD(bs);
+	fat_instance_t *instance = NULL;
+	void *data;
 	errno_t rc;
 
+	if (fs_instance_get(service_id, &data) == EOK)
+		instance = (fat_instance_t *) data;
+
 	/* Mark all clusters in the chain as free in all copies of FAT. */
 	while (firstc < FAT_CLST_LAST1(bs)) {
 		assert(firstc >= FAT_CLST_FIRST && firstc < clst_bad);
@@ -766,6 +1234,16 @@ fat_free_clusters(fat_bs_t *bs, service_id_t service_id, fat_cluster_t firstc)
 				return rc;
 		}
 
+		/*
+		 * Only now that the cluster is free in all copies of FAT can
+		 * it be handed out again.
+		 */
+		if (instance && firstc - FAT_CLST_FIRST < CC(bs)) {
+			fibril_mutex_lock(&instance->alloc_lock);
+			fat_free_map_update(instance, firstc, true);
+			fibril_mutex_unlock(&instance->alloc_lock);
+		}
+
 		firstc = nextc;
 	}
 
@@ -793,6 +1271,10 @@ errno_t fat_append_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t mcl,
 		/* No clusters allocated to the node yet. */
 		nodep->firstc = mcl;
 		nodep->dirty = true;	/* need to sync node */
+
+		/* Start with an empty extent map. */
+		fat_extents_clear(nodep);
+		nodep->extents_valid = true;
 	} else {
 		if (nodep->lastc_cached_valid) {
 			lastc = nodep->lastc_cached_value;
@@ -815,6 +1297,8 @@ errno_t fat_append_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t mcl,
 	nodep->lastc_cached_valid = true;
 	nodep->lastc_cached_value = lcl;
 
+	fat_extents_extend(bs, nodep, mcl);
+
 	return EOK;
 }
 
@@ -840,6 +1324,7 @@ errno_t fat_chop_clusters(fat_bs_t *bs, fat_node_t *nodep, fat_cluster_t lcl)
 	nodep->lastc_cached_valid = false;
 	if (nodep->currc_cached_value != lcl)
 		nodep->currc_cached_valid = false;
+	fat_extents_clear(nodep);
 
 	if (lcl == FAT_CLST_RES0) {
 		/* The node will have zero size and no clusters allocated. */
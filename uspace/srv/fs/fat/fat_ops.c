@@ -48,6 +48,7 @@
 #include <macros.h>
 #include <async.h>
 #include <errno.h>
+#include <mem.h>
 #include <str.h>
 #include <byteorder.h>
 #include <adt/hash_table.h>
@@ -111,6 +112,11 @@ static void fat_node_initialize(fat_node_t *node)
 	node->currc_cached_valid = false;
 	node->currc_cached_bn = 0;
 	node->currc_cached_value = 0;
+	node->extents_valid = false;
+	node->extents = NULL;
+	node->extents_count = 0;
+	node->extents_alloc = 0;
+	node->extents_clusters = 0;
 }
 
 static errno_t fat_node_sync(fat_node_t *node)
@@ -192,6 +198,7 @@ restart:
 				return rc;
 		}
 		nodep->idx->nodep = NULL;
+		fat_extents_clear(nodep);
 		free(nodep->bp);
 		free(nodep);
 
@@ -230,6 +237,7 @@ static errno_t fat_node_get_new(fat_node_t **nodepp)
 				idxp_tmp->nodep = NULL;
 				fibril_mutex_unlock(&nodep->lock);
 				fibril_mutex_unlock(&idxp_tmp->lock);
+				fat_extents_clear(nodep);
 				free(nodep->bp);
 				free(nodep);
 				return rc;
@@ -238,6 +246,7 @@ static errno_t fat_node_get_new(fat_node_t **nodepp)
 		idxp_tmp->nodep = NULL;
 		fibril_mutex_unlock(&nodep->lock);
 		fibril_mutex_unlock(&idxp_tmp->lock);
+		fat_extents_clear(nodep);
 		fn = FS_NODE(nodep);
 	} else {
 	skip_cache:
@@ -476,6 +485,7 @@ errno_t fat_node_put(fs_node_t *fn)
 	}
 	fibril_mutex_unlock(&nodep->lock);
 	if (destroy) {
+		fat_extents_clear(nodep);
 		free(nodep->bp);
 		free(nodep);
 	}
@@ -569,6 +579,7 @@ errno_t fat_destroy_node(fs_node_t *fn)
 	}
 
 	fat_idx_destroy(nodep->idx);
+	fat_extents_clear(nodep);
 	free(nodep->bp);
 	free(nodep);
 	return rc;
@@ -864,12 +875,22 @@ errno_t fat_total_block_count(service_id_t service_id, uint64_t *count)
 
 errno_t fat_free_block_count(service_id_t service_id, uint64_t *count)
 {
+	fat_instance_t *instance;
 	fat_bs_t *bs;
 	fat_cluster_t e0;
 	uint64_t block_count;
+	void *data;
 	errno_t rc;
 	uint32_t cluster_no, clusters;
 
+	if (fs_instance_get(service_id, &data) == EOK) {
+		instance = (fat_instance_t *) data;
+		fibril_mutex_lock(&instance->alloc_lock);
+		*count = instance->free_count;
+		fibril_mutex_unlock(&instance->alloc_lock);
+		return EOK;
+	}
+
 	block_count = 0;
 	bs = block_bb_get(service_id);
 	clusters = (SPC(bs)) ? TS(bs) / SPC(bs) : 0;
@@ -1025,6 +1046,7 @@ static errno_t fat_fs_open(service_id_t service_id, enum cache_mode cmode,
 
 static void fat_fs_close(service_id_t service_id, fs_node_t *rfn)
 {
+	fat_extents_clear(FAT_NODE(rfn));
 	free(rfn->data);
 	free(rfn);
 	(void) block_cache_fini(service_id);
@@ -1106,12 +1128,20 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 		return rc;
 	}
 
+	rc = fat_free_map_init(block_bb_get(service_id), service_id, instance);
+	if (rc != EOK) {
+		fat_fs_close(service_id, rfn);
+		free(instance);
+		return rc;
+	}
+
 	fibril_mutex_lock(&ridxp->lock);
 
 	rc = fs_instance_create(service_id, instance);
 	if (rc != EOK) {
 		fibril_mutex_unlock(&ridxp->lock);
 		fat_fs_close(service_id, rfn);
+		fat_free_map_fini(instance);
 		free(instance);
 		return rc;
 	}
@@ -1124,7 +1154,8 @@ fat_mounted(service_id_t service_id, const char *opts, fs_index_t *index,
 	return EOK;
 }
 
-static errno_t fat_update_fat32_fsinfo(service_id_t service_id)
+static errno_t fat_update_fat32_fsinfo(service_id_t service_id,
+    fat_instance_t *instance)
 {
 	fat_bs_t *bs;
 	fat32_fsinfo_t *info;
@@ -1148,8 +1179,11 @@ static errno_t fat_update_fat32_fsinfo(service_id_t service_id)
 		return EINVAL;
 	}
 
-	/* For now, invalidate the counter. */
-	info->free_clusters = host2uint16_t_le(-1);
+	/* Record the free cluster count and hint kept by the allocator. */
+	fibril_mutex_lock(&instance->alloc_lock);
+	info->free_clusters = host2uint32_t_le(instance->free_count);
+	info->last_allocated_cluster = host2uint32_t_le(instance->next_free);
+	fibril_mutex_unlock(&instance->alloc_lock);
 
 	b->dirty = true;
 	return block_put(b);
@@ -1160,6 +1194,7 @@ static errno_t fat_unmounted(service_id_t service_id)
 	fs_node_t *fn;
 	fat_node_t *nodep;
 	fat_bs_t *bs;
+	void *data;
 	errno_t rc;
 
 	bs = block_bb_get(service_id);
@@ -1178,11 +1213,12 @@ static errno_t fat_unmounted(service_id_t service_id)
 		return EBUSY;
 	}
 
-	if (FAT_IS_FAT32(bs)) {
+	if (FAT_IS_FAT32(bs) && fs_instance_get(service_id, &data) == EOK) {
 		/*
 		 * Attempt to update the FAT32 FS info.
 		 */
-		(void) fat_update_fat32_fsinfo(service_id);
+		(void) fat_update_fat32_fsinfo(service_id,
+		    (fat_instance_t *) data);
 	}
 
 	/*
@@ -1198,15 +1234,67 @@ static errno_t fat_unmounted(service_id_t service_id)
 	(void) fat_node_fini_by_service_id(service_id);
 	fat_fs_close(service_id, fn);
 
-	void *data;
 	if (fs_instance_get(service_id, &data) == EOK) {
 		fs_instance_destroy(service_id);
+		fat_free_map_fini((fat_instance_t *) data);
 		free(data);
 	}
 
 	return EOK;
 }
 
+/** Read at most one block worth of data from a regular file.
+ *
+ * @param bs      Buffer holding the boot sector of the file system
+ * @param nodep   File node
+ * @param pos     Position in the file
+ * @param len     Maximum number of bytes to read
+ * @param call    Data read call to finalize or NULL
+ * @param dst     Destination buffer used if @a call is NULL
+ * @param rbytes  Place to store the number of bytes read, zero at EOF
+ *
+ * @return        EOK on success or an error code. On failure, @a call
+ *                is answered with the error code.
+ */
+static errno_t fat_read_block(fat_bs_t *bs, fat_node_t *nodep, aoff64_t pos,
+    size_t len, ipc_call_t *call, void *dst, size_t *rbytes)
+{
+	size_t bytes;
+	block_t *b;
+	errno_t rc;
+
+	if (pos >= nodep->size) {
+		/* reading beyond the EOF */
+		if (call != NULL)
+			(void) async_data_read_finalize(call, NULL, 0);
+		*rbytes = 0;
+		return EOK;
+	}
+
+	bytes = min(len, BPS(bs) - pos % BPS(bs));
+	bytes = min(bytes, nodep->size - pos);
+	rc = fat_block_get(&b, bs, nodep, pos / BPS(bs), BLOCK_FLAGS_NONE);
+	if (rc != EOK) {
+		if (call != NULL)
+			async_answer_0(call, rc);
+		return rc;
+	}
+
+	if (call != NULL) {
+		(void) async_data_read_finalize(call, b->data + pos % BPS(bs),
+		    bytes);
+	} else {
+		memcpy(dst, b->data + pos % BPS(bs), bytes);
+	}
+
+	rc = block_put(b);
+	if (rc != EOK)
+		return rc;
+
+	*rbytes = bytes;
+	return EOK;
+}
+
 static errno_t
 fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
     size_t *rbytes)
@@ -1215,7 +1303,6 @@ fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 	fat_node_t *nodep;
 	fat_bs_t *bs;
 	size_t bytes;
-	block_t *b;
 	errno_t rc;
 
 	rc = fat_node_get(&fn, service_id, index);
@@ -1241,27 +1328,10 @@ fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		 * most and make use of the possibility to return less data than
 		 * requested. This keeps the code very simple.
 		 */
-		if (pos >= nodep->size) {
-			/* reading beyond the EOF */
-			bytes = 0;
-			(void) async_data_read_finalize(&call, NULL, 0);
-		} else {
-			bytes = min(len, BPS(bs) - pos % BPS(bs));
-			bytes = min(bytes, nodep->size - pos);
-			rc = fat_block_get(&b, bs, nodep, pos / BPS(bs),
-			    BLOCK_FLAGS_NONE);
-			if (rc != EOK) {
-				fat_node_put(fn);
-				async_answer_0(&call, rc);
-				return rc;
-			}
-			(void) async_data_read_finalize(&call,
-			    b->data + pos % BPS(bs), bytes);
-			rc = block_put(b);
-			if (rc != EOK) {
-				fat_node_put(fn);
-				return rc;
-			}
+		rc = fat_read_block(bs, nodep, pos, len, &call, NULL, &bytes);
+		if (rc != EOK) {
+			fat_node_put(fn);
+			return rc;
 		}
 	} else {
 		aoff64_t spos = pos;
@@ -1317,36 +1387,31 @@ fat_read(service_id_t service_id, fs_index_t index, aoff64_t pos,
 	return rc;
 }
 
-static errno_t
-fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
-    size_t *wbytes, aoff64_t *nsize)
+/** Write at most one block worth of data to a file.
+ *
+ * The node size may grow, new clusters are allocated as needed.
+ *
+ * @param bs      Buffer holding the boot sector of the file system
+ * @param nodep   File node
+ * @param pos     Position in the file
+ * @param len     Maximum number of bytes to write
+ * @param call    Data write call to finalize or NULL
+ * @param src     Source buffer used if @a call is NULL
+ * @param wbytes  Place to store the number of bytes written
+ *
+ * @return        EOK on success or an error code. On failure, @a call
+ *                is answered with the error code unless already finalized.
+ */
+static errno_t fat_write_block(fat_bs_t *bs, fat_node_t *nodep, aoff64_t pos,
+    size_t len, ipc_call_t *call, const void *src, size_t *wbytes)
 {
-	fs_node_t *fn;
-	fat_node_t *nodep;
-	fat_bs_t *bs;
+	service_id_t service_id = nodep->idx->service_id;
 	size_t bytes;
 	block_t *b;
 	aoff64_t boundary;
 	int flags = BLOCK_FLAGS_NONE;
 	errno_t rc;
 
-	rc = fat_node_get(&fn, service_id, index);
-	if (rc != EOK)
-		return rc;
-	if (!fn)
-		return ENOENT;
-	nodep = FAT_NODE(fn);
-
-	ipc_call_t call;
-	size_t len;
-	if (!async_data_write_receive(&call, &len)) {
-		(void) fat_node_put(fn);
-		async_answer_0(&call, EINVAL);
-		return EINVAL;
-	}
-
-	bs = block_bb_get(service_id);
-
 	/*
 	 * In all scenarios, we will attempt to write out only one block worth
 	 * of data at maximum. There might be some more efficient approaches,
@@ -1368,32 +1433,32 @@ fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		 */
 		rc = fat_fill_gap(bs, nodep, FAT_CLST_RES0, pos);
 		if (rc != EOK) {
-			(void) fat_node_put(fn);
-			async_answer_0(&call, rc);
+			if (call != NULL)
+				async_answer_0(call, rc);
 			return rc;
 		}
 		rc = fat_block_get(&b, bs, nodep, pos / BPS(bs), flags);
 		if (rc != EOK) {
-			(void) fat_node_put(fn);
-			async_answer_0(&call, rc);
+			if (call != NULL)
+				async_answer_0(call, rc);
 			return rc;
 		}
-		(void) async_data_write_finalize(&call,
-		    b->data + pos % BPS(bs), bytes);
+		if (call != NULL) {
+			(void) async_data_write_finalize(call,
+			    b->data + pos % BPS(bs), bytes);
+		} else {
+			memcpy(b->data + pos % BPS(bs), src, bytes);
+		}
 		b->dirty = true;		/* need to sync block */
 		rc = block_put(b);
-		if (rc != EOK) {
-			(void) fat_node_put(fn);
+		if (rc != EOK)
 			return rc;
-		}
 		if (pos + bytes > nodep->size) {
 			nodep->size = pos + bytes;
 			nodep->dirty = true;	/* need to sync node */
 		}
 		*wbytes = bytes;
-		*nsize = nodep->size;
-		rc = fat_node_put(fn);
-		return rc;
+		return EOK;
 	} else {
 		/*
 		 * This is the more difficult case. We must allocate new
@@ -1407,33 +1472,36 @@ fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		rc = fat_alloc_clusters(bs, service_id, nclsts, &mcl, &lcl);
 		if (rc != EOK) {
 			/* could not allocate a chain of nclsts clusters */
-			(void) fat_node_put(fn);
-			async_answer_0(&call, rc);
+			if (call != NULL)
+				async_answer_0(call, rc);
 			return rc;
 		}
 		/* zero fill any gaps */
 		rc = fat_fill_gap(bs, nodep, mcl, pos);
 		if (rc != EOK) {
 			(void) fat_free_clusters(bs, service_id, mcl);
-			(void) fat_node_put(fn);
-			async_answer_0(&call, rc);
+			if (call != NULL)
+				async_answer_0(call, rc);
 			return rc;
 		}
 		rc = _fat_block_get(&b, bs, service_id, lcl, NULL,
 		    (pos / BPS(bs)) % SPC(bs), flags);
 		if (rc != EOK) {
 			(void) fat_free_clusters(bs, service_id, mcl);
-			(void) fat_node_put(fn);
-			async_answer_0(&call, rc);
+			if (call != NULL)
+				async_answer_0(call, rc);
 			return rc;
 		}
-		(void) async_data_write_finalize(&call,
-		    b->data + pos % BPS(bs), bytes);
+		if (call != NULL) {
+			(void) async_data_write_finalize(call,
+			    b->data + pos % BPS(bs), bytes);
+		} else {
+			memcpy(b->data + pos % BPS(bs), src, bytes);
+		}
 		b->dirty = true;		/* need to sync block */
 		rc = block_put(b);
 		if (rc != EOK) {
 			(void) fat_free_clusters(bs, service_id, mcl);
-			(void) fat_node_put(fn);
 			return rc;
 		}
 		/*
@@ -1443,15 +1511,158 @@ fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		rc = fat_append_clusters(bs, nodep, mcl, lcl);
 		if (rc != EOK) {
 			(void) fat_free_clusters(bs, service_id, mcl);
-			(void) fat_node_put(fn);
 			return rc;
 		}
-		*nsize = nodep->size = pos + bytes;
-		rc = fat_node_put(fn);
+		nodep->size = pos + bytes;
 		nodep->dirty = true;		/* need to sync node */
 		*wbytes = bytes;
+		return EOK;
+	}
+}
+
+static errno_t
+fat_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
+    size_t *wbytes, aoff64_t *nsize)
+{
+	fs_node_t *fn;
+	fat_node_t *nodep;
+	fat_bs_t *bs;
+	errno_t rc;
+
+	rc = fat_node_get(&fn, service_id, index);
+	if (rc != EOK)
 		return rc;
+	if (!fn)
+		return ENOENT;
+	nodep = FAT_NODE(fn);
+
+	ipc_call_t call;
+	size_t len;
+	if (!async_data_write_receive(&call, &len)) {
+		(void) fat_node_put(fn);
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
 	}
+
+	bs = block_bb_get(service_id);
+
+	rc = fat_write_block(bs, nodep, pos, len, &call, NULL, wbytes);
+	if (rc != EOK) {
+		(void) fat_node_put(fn);
+		return rc;
+	}
+
+	*nsize = nodep->size;
+	return fat_node_put(fn);
+}
+
+static errno_t
+fat_readv(service_id_t service_id, fs_index_t index, const vfs_extent_t *ext,
+    size_t cnt, void *buf, size_t *rbytes)
+{
+	fs_node_t *fn;
+	fat_node_t *nodep;
+	fat_bs_t *bs;
+	size_t done = 0;
+	errno_t rc;
+
+	rc = fat_node_get(&fn, service_id, index);
+	if (rc != EOK)
+		return rc;
+	if (!fn)
+		return ENOENT;
+	nodep = FAT_NODE(fn);
+
+	if (nodep->type != FAT_FILE) {
+		(void) fat_node_put(fn);
+		return EINVAL;
+	}
+
+	bs = block_bb_get(service_id);
+
+	/*
+	 * Read the extents block by block, stopping at the end of file. The
+	 * blocks come from the block cache, so adjacent extents sharing a
+	 * block cost only a lookup.
+	 */
+	for (size_t i = 0; i < cnt; i++) {
+		size_t off = 0;
+
+		while (off < ext[i].size) {
+			size_t bytes;
+
+			rc = fat_read_block(bs, nodep, ext[i].pos + off,
+			    ext[i].size - off, NULL, (uint8_t *) buf + done,
+			    &bytes);
+			if (rc != EOK) {
+				(void) fat_node_put(fn);
+				return rc;
+			}
+
+			if (bytes == 0)
+				goto eof;
+
+			off += bytes;
+			done += bytes;
+		}
+	}
+
+eof:
+	*rbytes = done;
+	return fat_node_put(fn);
+}
+
+static errno_t
+fat_writev(service_id_t service_id, fs_index_t index, const vfs_extent_t *ext,
+    size_t cnt, const void *buf, size_t *wbytes, aoff64_t *nsize)
+{
+	fs_node_t *fn;
+	fat_node_t *nodep;
+	fat_bs_t *bs;
+	size_t done = 0;
+	errno_t rc;
+
+	rc = fat_node_get(&fn, service_id, index);
+	if (rc != EOK)
+		return rc;
+	if (!fn)
+		return ENOENT;
+	nodep = FAT_NODE(fn);
+
+	if (nodep->type != FAT_FILE) {
+		(void) fat_node_put(fn);
+		return EINVAL;
+	}
+
+	bs = block_bb_get(service_id);
+
+	rc = EOK;
+	for (size_t i = 0; (i < cnt) && (rc == EOK); i++) {
+		size_t off = 0;
+
+		while (off < ext[i].size) {
+			size_t bytes;
+
+			rc = fat_write_block(bs, nodep, ext[i].pos + off,
+			    ext[i].size - off, NULL,
+			    (const uint8_t *) buf + done, &bytes);
+			if (rc != EOK)
+				break;
+
+			off += bytes;
+			done += bytes;
+		}
+	}
+
+	/* Report a partial write, fail only if nothing was written. */
+	if ((rc != EOK) && (done == 0)) {
+		(void) fat_node_put(fn);
+		return rc;
+	}
+
+	*wbytes = done;
+	*nsize = nodep->size;
+	return fat_node_put(fn);
 }
 
 static errno_t
@@ -1565,6 +1776,8 @@ vfs_out_ops_t fat_ops = {
 	.unmounted = fat_unmounted,
 	.read = fat_read,
 	.write = fat_write,
+	.readv = fat_readv,
+	.writev = fat_writev,
 	.truncate = fat_truncate,
 	.close = fat_close,
 	.destroy = fat_destroy,
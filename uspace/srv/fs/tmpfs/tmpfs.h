@@ -34,6 +34,7 @@
 #define TMPFS_TMPFS_H_
 
 #include <libfs.h>
+#include <errno.h>
 #include <atomic.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -42,6 +43,10 @@
 #define TMPFS_NODE(node)	((node) ? (tmpfs_node_t *)(node)->data : NULL)
 #define FS_NODE(node)		((node) ? (node)->bp : NULL)
 
+/** Number of page index bits resolved by one level of the page tree. */
+#define TMPFS_RADIX_BITS	6
+#define TMPFS_RADIX_FANOUT	(1 << TMPFS_RADIX_BITS)
+
 typedef enum {
 	TMPFS_NONE,
 	TMPFS_FILE,
@@ -57,6 +62,11 @@ typedef struct tmpfs_dentry {
 	char *name;		/**< Name of dentry. */
 } tmpfs_dentry_t;
 
+/** Interior node of the radix tree of file pages. */
+typedef struct tmpfs_radix {
+	void *slot[TMPFS_RADIX_FANOUT];
+} tmpfs_radix_t;
+
 typedef struct tmpfs_node {
 	fs_node_t *bp;		/**< Back pointer to the FS node. */
 	fs_index_t index;	/**< TMPFS node index. */
@@ -64,8 +74,13 @@ typedef struct tmpfs_node {
 	ht_link_t nh_link;		/**< Nodes hash table link. */
 	tmpfs_dentry_type_t type;
 	unsigned lnkcnt;	/**< Link count. */
-	size_t size;		/**< File size if type is TMPFS_FILE. */
-	void *data;		/**< File content's if type is TMPFS_FILE. */
+	aoff64_t size;		/**< File size if type is TMPFS_FILE. */
+	/**
+	 * Radix tree of the file's pages if type is TMPFS_FILE. Missing
+	 * pages are holes which read as zeros.
+	 */
+	void *pages;
+	unsigned height;	/**< Number of interior levels of pages. */
 	list_t cs_list;		/**< Child's siblings list. */
 } tmpfs_node_t;
 
@@ -74,6 +89,14 @@ extern libfs_ops_t tmpfs_libfs_ops;
 
 extern bool tmpfs_init(void);
 
+extern const void *tmpfs_page_peek(tmpfs_node_t *, aoff64_t);
+extern void *tmpfs_page_get(tmpfs_node_t *, aoff64_t);
+extern errno_t tmpfs_pages_alloc(tmpfs_node_t *, aoff64_t, size_t);
+extern void tmpfs_pages_read(tmpfs_node_t *, aoff64_t, void *, size_t);
+extern errno_t tmpfs_pages_write(tmpfs_node_t *, aoff64_t, const void *,
+    size_t);
+extern void tmpfs_pages_truncate(tmpfs_node_t *, aoff64_t);
+
 #endif
 
 /**
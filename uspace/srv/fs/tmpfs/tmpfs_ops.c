@@ -56,6 +56,9 @@
 /** All root nodes have index 0. */
 #define TMPFS_SOME_ROOT  0
 
+/** Largest read or write spanning several pages served by one request. */
+#define TMPFS_RDWR_MAX  (16 * PAGE_SIZE)
+
 /** Global counter for assigning node indices. Shared by all instances. */
 fs_index_t tmpfs_next_index = 1;
 
@@ -180,9 +183,9 @@ static void nodes_remove_callback(ht_link_t *item)
 		free(dentryp);
 	}
 
-	if (nodep->data) {
+	if (nodep->pages) {
 		assert(nodep->type == TMPFS_FILE);
-		free(nodep->data);
+		tmpfs_pages_truncate(nodep, 0);
 	}
 	free(nodep->bp);
 	free(nodep);
@@ -205,7 +208,8 @@ static void tmpfs_node_initialize(tmpfs_node_t *nodep)
 	nodep->type = TMPFS_NONE;
 	nodep->lnkcnt = 0;
 	nodep->size = 0;
-	nodep->data = NULL;
+	nodep->pages = NULL;
+	nodep->height = 0;
 	list_initialize(&nodep->cs_list);
 }
 
@@ -492,9 +496,29 @@ static errno_t tmpfs_read(service_id_t service_id, fs_index_t index, aoff64_t po
 
 	size_t bytes;
 	if (nodep->type == TMPFS_FILE) {
-		bytes = min(nodep->size - pos, size);
-		(void) async_data_read_finalize(&call, nodep->data + pos,
-		    bytes);
+		bytes = 0;
+		if (pos < nodep->size)
+			bytes = min(nodep->size - pos, size);
+
+		size_t off = pos % PAGE_SIZE;
+		if (off + bytes <= PAGE_SIZE) {
+			/* Transfer directly from the page. */
+			(void) async_data_read_finalize(&call,
+			    tmpfs_page_peek(nodep, pos / PAGE_SIZE) + off,
+			    bytes);
+		} else {
+			bytes = min(bytes, TMPFS_RDWR_MAX);
+
+			void *buf = malloc(bytes);
+			if (!buf) {
+				async_answer_0(&call, ENOMEM);
+				return ENOMEM;
+			}
+
+			tmpfs_pages_read(nodep, pos, buf, bytes);
+			(void) async_data_read_finalize(&call, buf, bytes);
+			free(buf);
+		}
 	} else {
 		tmpfs_dentry_t *dentryp;
 		link_t *lnk;
@@ -553,34 +577,44 @@ tmpfs_write(service_id_t service_id, fs_index_t index, aoff64_t pos,
 		return EINVAL;
 	}
 
-	/*
-	 * Check whether the file needs to grow.
-	 */
-	if (pos + size <= nodep->size) {
-		/* The file size is not changing. */
-		(void) async_data_write_finalize(&call, nodep->data + pos,
-		    size);
-		goto out;
+	/* The end of the written range must be representable. */
+	if (pos + size < pos) {
+		async_answer_0(&call, EOVERFLOW);
+		return EOVERFLOW;
 	}
-	size_t delta = (pos + size) - nodep->size;
-	/*
-	 * At this point, we are deliberately extremely straightforward and
-	 * simply realloc the contents of the file on every write that grows the
-	 * file. In the end, the situation might not be as bad as it may look:
-	 * our heap allocator can save us and just grow the block whenever
-	 * possible.
-	 */
-	void *newdata = realloc(nodep->data, nodep->size + delta);
-	if (!newdata) {
-		async_answer_0(&call, ENOMEM);
-		size = 0;
-		goto out;
+
+	size_t off = pos % PAGE_SIZE;
+	if (off + size <= PAGE_SIZE) {
+		/* Transfer directly to the page. */
+		void *page = tmpfs_page_get(nodep, pos / PAGE_SIZE);
+		if (!page) {
+			async_answer_0(&call, ENOMEM);
+			size = 0;
+			goto out;
+		}
+
+		(void) async_data_write_finalize(&call, page + off, size);
+	} else {
+		/*
+		 * Only the pages which are written to are allocated, so
+		 * appending to a file does not copy its previous contents.
+		 */
+		size = min(size, TMPFS_RDWR_MAX);
+
+		void *buf = malloc(size);
+		if (!buf || tmpfs_pages_alloc(nodep, pos, size) != EOK) {
+			free(buf);
+			async_answer_0(&call, ENOMEM);
+			size = 0;
+			goto out;
+		}
+
+		(void) async_data_write_finalize(&call, buf, size);
+		(void) tmpfs_pages_write(nodep, pos, buf, size);
+		free(buf);
 	}
-	/* Clear any newly allocated memory in order to emulate gaps. */
-	memset(newdata + nodep->size, 0, delta);
-	nodep->size += delta;
-	nodep->data = newdata;
-	(void) async_data_write_finalize(&call, nodep->data + pos, size);
+
+	nodep->size = max(nodep->size, pos + size);
 
 out:
 	*wbytes = size;
@@ -588,6 +622,83 @@ out:
 	return EOK;
 }
 
+static errno_t tmpfs_readv(service_id_t service_id, fs_index_t index,
+    const vfs_extent_t *ext, size_t cnt, void *buf, size_t *rbytes)
+{
+	node_key_t key = {
+		.service_id = service_id,
+		.index = index
+	};
+
+	ht_link_t *hlp = hash_table_find(&nodes, &key);
+	if (!hlp)
+		return ENOENT;
+
+	tmpfs_node_t *nodep = hash_table_get_inst(hlp, tmpfs_node_t, nh_link);
+	if (nodep->type != TMPFS_FILE)
+		return EINVAL;
+
+	/* Fill the buffer extent by extent until the end of file. */
+	size_t bytes = 0;
+	for (size_t i = 0; i < cnt; i++) {
+		size_t len = 0;
+
+		if (ext[i].pos < nodep->size)
+			len = min(nodep->size - ext[i].pos, ext[i].size);
+
+		tmpfs_pages_read(nodep, ext[i].pos, buf + bytes, len);
+		bytes += len;
+
+		if (len < ext[i].size)
+			break;
+	}
+
+	*rbytes = bytes;
+	return EOK;
+}
+
+static errno_t tmpfs_writev(service_id_t service_id, fs_index_t index,
+    const vfs_extent_t *ext, size_t cnt, const void *buf, size_t *wbytes,
+    aoff64_t *nsize)
+{
+	node_key_t key = {
+		.service_id = service_id,
+		.index = index
+	};
+
+	ht_link_t *hlp = hash_table_find(&nodes, &key);
+	if (!hlp)
+		return ENOENT;
+
+	tmpfs_node_t *nodep = hash_table_get_inst(hlp, tmpfs_node_t, nh_link);
+	if (nodep->type != TMPFS_FILE)
+		return EINVAL;
+
+	/* Reject the whole request if the end of any extent overflows. */
+	for (size_t i = 0; i < cnt; i++) {
+		if (ext[i].pos + ext[i].size < ext[i].pos)
+			return EOVERFLOW;
+	}
+
+	/* Write extent by extent, stop at the first one out of memory. */
+	size_t bytes = 0;
+	for (size_t i = 0; i < cnt; i++) {
+		if (tmpfs_pages_write(nodep, ext[i].pos, buf + bytes,
+		    ext[i].size) != EOK)
+			break;
+
+		nodep->size = max(nodep->size, ext[i].pos + ext[i].size);
+		bytes += ext[i].size;
+	}
+
+	if ((bytes == 0) && (cnt > 0))
+		return ENOMEM;
+
+	*wbytes = bytes;
+	*nsize = nodep->size;
+	return EOK;
+}
+
 static errno_t tmpfs_truncate(service_id_t service_id, fs_index_t index,
     aoff64_t size)
 {
@@ -607,20 +718,9 @@ static errno_t tmpfs_truncate(service_id_t service_id, fs_index_t index,
 	if (size == nodep->size)
 		return EOK;
 
-	if (size > SIZE_MAX)
-		return ENOMEM;
-
-	void *newdata = realloc(nodep->data, size);
-	if (!newdata && size)
-		return ENOMEM;
-
-	if (size > nodep->size) {
-		size_t delta = size - nodep->size;
-		memset(newdata + nodep->size, 0, delta);
-	}
-
+	/* Growing the file only creates a hole. */
+	tmpfs_pages_truncate(nodep, size);
 	nodep->size = size;
-	nodep->data = newdata;
 	return EOK;
 }
 
@@ -659,6 +759,8 @@ vfs_out_ops_t tmpfs_ops = {
 	.unmounted = tmpfs_unmounted,
 	.read = tmpfs_read,
 	.write = tmpfs_write,
+	.readv = tmpfs_readv,
+	.writev = tmpfs_writev,
 	.truncate = tmpfs_truncate,
 	.close = tmpfs_close,
 	.destroy = tmpfs_destroy,
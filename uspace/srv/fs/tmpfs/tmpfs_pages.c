@@ -0,0 +1,296 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup fs
+ * @{
+ */
+
+/**
+ * @file	tmpfs_pages.c
+ * @brief	Page storage of tmpfs files.
+ *
+ * The contents of a file are kept in page-sized blocks indexed by a radix
+ * tree. Appending to a file only allocates the new pages and a hole in a
+ * sparse file costs no memory at all. Missing pages read as zeros.
+ *
+ * The bytes of the last page past the end of the file are always zero, so
+ * that growing the file does not need to clear them.
+ */
+
+#include "tmpfs.h"
+#include <as.h>
+#include <malloc.h>
+#include <mem.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <macros.h>
+
+/** Contents of holes. */
+static const uint8_t tmpfs_zero_page[PAGE_SIZE];
+
+/** @return Number of pages covered by a page tree of the given height. */
+static aoff64_t tmpfs_pages_span(unsigned height)
+{
+	return (aoff64_t) 1 << (height * TMPFS_RADIX_BITS);
+}
+
+/** Find a page of a file, creating it and the path to it if needed.
+ *
+ * @param nodep  TMPFS node of the file.
+ * @param idx    Page index.
+ * @param create Whether to allocate a missing page.
+ *
+ * @return The page, or NULL if it is missing and either create is false or
+ *         there is not enough memory.
+ */
+static void *tmpfs_page_find(tmpfs_node_t *nodep, aoff64_t idx, bool create)
+{
+	/* Grow the tree until it covers the page. */
+	while ((nodep->height * TMPFS_RADIX_BITS < 64) &&
+	    (idx >= tmpfs_pages_span(nodep->height))) {
+		if (!create)
+			return NULL;
+
+		if (nodep->pages != NULL) {
+			tmpfs_radix_t *radix = calloc(1, sizeof(tmpfs_radix_t));
+			if (!radix)
+				return NULL;
+
+			radix->slot[0] = nodep->pages;
+			nodep->pages = radix;
+		}
+
+		nodep->height++;
+	}
+
+	void **slot = &nodep->pages;
+	for (unsigned level = nodep->height; level > 0; level--) {
+		if (*slot == NULL) {
+			if (!create)
+				return NULL;
+
+			*slot = calloc(1, sizeof(tmpfs_radix_t));
+			if (*slot == NULL)
+				return NULL;
+		}
+
+		tmpfs_radix_t *radix = *slot;
+		unsigned shift = (level - 1) * TMPFS_RADIX_BITS;
+		slot = &radix->slot[(idx >> shift) & (TMPFS_RADIX_FANOUT - 1)];
+	}
+
+	if ((*slot == NULL) && create) {
+		void *page = memalign(PAGE_SIZE, PAGE_SIZE);
+		if (page) {
+			memset(page, 0, PAGE_SIZE);
+			*slot = page;
+		}
+	}
+
+	return *slot;
+}
+
+/** Get a page of a file for reading.
+ *
+ * @param nodep TMPFS node of the file.
+ * @param idx   Page index.
+ *
+ * @return The page, or a page of zeros if the page is a hole.
+ */
+const void *tmpfs_page_peek(tmpfs_node_t *nodep, aoff64_t idx)
+{
+	void *page = tmpfs_page_find(nodep, idx, false);
+	return (page != NULL) ? page : tmpfs_zero_page;
+}
+
+/** Get a page of a file for writing, allocating it if it is a hole.
+ *
+ * @param nodep TMPFS node of the file.
+ * @param idx   Page index.
+ *
+ * @return The page or NULL if there is not enough memory.
+ */
+void *tmpfs_page_get(tmpfs_node_t *nodep, aoff64_t idx)
+{
+	return tmpfs_page_find(nodep, idx, true);
+}
+
+/** Copy file contents to a buffer.
+ *
+ * @param nodep TMPFS node of the file.
+ * @param pos   Position in the file.
+ * @param buf   Destination buffer.
+ * @param size  Number of bytes to copy.
+ */
+void tmpfs_pages_read(tmpfs_node_t *nodep, aoff64_t pos, void *buf,
+    size_t size)
+{
+	while (size > 0) {
+		size_t off = pos % PAGE_SIZE;
+		size_t len = min(size, PAGE_SIZE - off);
+
+		memcpy(buf, tmpfs_page_peek(nodep, pos / PAGE_SIZE) + off, len);
+
+		buf += len;
+		pos += len;
+		size -= len;
+	}
+}
+
+/** Allocate the missing pages of a range of a file.
+ *
+ * @param nodep TMPFS node of the file.
+ * @param pos   Position in the file.
+ * @param size  Size of the range.
+ *
+ * @return EOK on success, EOVERFLOW if the range does not fit into
+ *         the file offset type or ENOMEM.
+ */
+errno_t tmpfs_pages_alloc(tmpfs_node_t *nodep, aoff64_t pos, size_t size)
+{
+	if (size == 0)
+		return EOK;
+
+	if (pos + size < pos)
+		return EOVERFLOW;
+
+	aoff64_t last = (pos + size - 1) / PAGE_SIZE;
+	for (aoff64_t idx = pos / PAGE_SIZE; idx <= last; idx++) {
+		if (tmpfs_page_get(nodep, idx) == NULL)
+			return ENOMEM;
+	}
+
+	return EOK;
+}
+
+/** Copy a buffer to file contents.
+ *
+ * All the pages are allocated before anything is copied, so the file is
+ * left unchanged if there is not enough memory. The file size is not
+ * updated.
+ *
+ * @param nodep TMPFS node of the file.
+ * @param pos   Position in the file.
+ * @param buf   Source buffer.
+ * @param size  Number of bytes to copy.
+ *
+ * @return EOK on success, EOVERFLOW if the range does not fit into
+ *         the file offset type or ENOMEM.
+ */
+errno_t tmpfs_pages_write(tmpfs_node_t *nodep, aoff64_t pos, const void *buf,
+    size_t size)
+{
+	errno_t rc = tmpfs_pages_alloc(nodep, pos, size);
+	if (rc != EOK)
+		return rc;
+
+	while (size > 0) {
+		size_t off = pos % PAGE_SIZE;
+		size_t len = min(size, PAGE_SIZE - off);
+
+		memcpy(tmpfs_page_find(nodep, pos / PAGE_SIZE, false) + off,
+		    buf, len);
+
+		buf += len;
+		pos += len;
+		size -= len;
+	}
+
+	return EOK;
+}
+
+/** Free the pages of a subtree starting with a given page index.
+ *
+ * @param slot  Slot pointing to the subtree.
+ * @param level Height of the subtree.
+ * @param base  Index of the first page covered by the subtree.
+ * @param first Index of the first page to free.
+ */
+static void tmpfs_pages_free(void **slot, unsigned level, aoff64_t base,
+    aoff64_t first)
+{
+	if (*slot == NULL)
+		return;
+
+	if (level == 0) {
+		if (base >= first) {
+			free(*slot);
+			*slot = NULL;
+		}
+		return;
+	}
+
+	tmpfs_radix_t *radix = *slot;
+	aoff64_t span = tmpfs_pages_span(level - 1);
+	bool empty = true;
+
+	for (unsigned i = 0; i < TMPFS_RADIX_FANOUT; i++) {
+		aoff64_t child = base + i * span;
+
+		if (child + span > first) {
+			tmpfs_pages_free(&radix->slot[i], level - 1, child,
+			    first);
+		}
+
+		if (radix->slot[i] != NULL)
+			empty = false;
+	}
+
+	if (empty) {
+		free(radix);
+		*slot = NULL;
+	}
+}
+
+/** Change the size of a file's contents.
+ *
+ * Pages past the new end of the file are freed and the rest of the last
+ * page is cleared. Growing the file only creates a hole. Truncating to
+ * zero frees all memory of the file. The file size is not updated.
+ *
+ * @param nodep TMPFS node of the file.
+ * @param size  New size of the file.
+ */
+void tmpfs_pages_truncate(tmpfs_node_t *nodep, aoff64_t size)
+{
+	tmpfs_pages_free(&nodep->pages, nodep->height, 0,
+	    (size + PAGE_SIZE - 1) / PAGE_SIZE);
+	if (nodep->pages == NULL)
+		nodep->height = 0;
+
+	size_t off = size % PAGE_SIZE;
+	if (off != 0) {
+		void *page = tmpfs_page_find(nodep, size / PAGE_SIZE, false);
+		if (page)
+			memset(page + off, 0, PAGE_SIZE - off);
+	}
+}
+
+/**
+ * @}
+ */
@@ -39,6 +39,9 @@
 #include <str_error.h>
 #include <byteorder.h>
 #include <stdio.h>
+#include <inttypes.h>
+#include <macros.h>
+#include <mem.h>
 #include <libc.h>
 
 #include <align.h>
@@ -46,7 +49,12 @@
 #include <stdlib.h>
 
 #include <atomic.h>
+#include <fibril.h>
 #include <fibril_synch.h>
+#include <futex.h>
+#include <stats.h>
+#include <thread.h>
+#include <sys/time.h>
 #include <adt/prodcons.h>
 #include <adt/list.h>
 #include <io/input.h>
@@ -72,6 +80,7 @@
 #include <codec/tga.h>
 
 #include "compositor.h"
+#include "region.h"
 
 #define NAME       "compositor"
 #define NAMESPACE  "comp"
@@ -140,6 +149,7 @@ typedef struct {
 	async_sess_t *sess;
 	desktop_point_t pos;
 	surface_t *surface;
+	region_t damage;
 } viewport_t;
 
 static desktop_rect_t viewport_bound_rect;
@@ -148,6 +158,64 @@ static LIST_INITIALIZE(viewport_list);
 
 static FIBRIL_MUTEX_INITIALIZE(discovery_mtx);
 
+/** Height of a composition tile (band of viewport rows) in pixels. */
+#define TILE_HEIGHT  64
+
+/** Maximum number of threads composing tiles besides the damaging one. */
+#define TILE_WORKERS_MAX  15
+
+typedef struct {
+	uint64_t damaged;
+	uint64_t painted;
+	uint64_t culled;
+} comp_frame_stats_t;
+
+/** Composition of a viewport split into tiles. */
+typedef struct {
+	/** Viewport being composed. */
+	viewport_t *vp;
+	/** Damage clipped to the viewport (global coordinates). */
+	region_t *damage;
+	/** Filter to use for transformed windows. */
+	filter_t filter;
+	/** Viewport row of the first tile. */
+	sysarg_t row;
+	/** Number of tiles. */
+	size_t tiles;
+	/** Next tile to be composed. */
+	size_t next;
+	/** Some tile could not be composed. */
+	bool failed;
+	/** Pixel counters accumulated over all tiles. */
+	comp_frame_stats_t stats;
+} comp_frame_t;
+
+/*
+ * Tiles are composed by dedicated threads rather than by fibrils, so that
+ * no other compositor state is ever accessed in parallel. The threads do
+ * not run fibrils, hence they are synchronized using futexes. The
+ * composing fibril blocks its thread until the workers are done, so the
+ * state they read cannot change in the meantime.
+ */
+static size_t tile_workers = 0;
+/** Protects frame_cur and the progress of the frame. */
+static futex_t frame_futex = FUTEX_INITIALIZER;
+/** Counts the workers requested to help with the current frame. */
+static futex_t frame_start = FUTEX_INITIALIZE(0);
+/** Counts the workers which are done with the current frame. */
+static futex_t frame_done = FUTEX_INITIALIZE(0);
+static comp_frame_t *frame_cur = NULL;
+
+/** Composition statistics (protected by viewport_list_mtx). */
+static struct {
+	uint64_t frames;
+	uint64_t usecs;
+	uint64_t usecs_max;
+	uint64_t damaged;
+	uint64_t painted;
+	uint64_t culled;
+} comp_stats;
+
 /** Input server proxy */
 static input_t *input;
 static bool active = false;
@@ -379,88 +447,333 @@ static void comp_restrict_pointers(void)
 	fibril_mutex_unlock(&pointer_list_mtx);
 }
 
-static void comp_damage(sysarg_t x_dmg_glob, sysarg_t y_dmg_glob,
-    sysarg_t w_dmg_glob, sysarg_t h_dmg_glob)
+/** Determine whether a window is known to cover its bounding rectangle.
+ *
+ * Only windows whose client promised opaque contents and which are drawn
+ * without blending, scaling or rotation can hide the windows below them.
+ */
+static bool comp_window_opaque(window_t *win)
+{
+	return ((win->flags & WINDOW_OPAQUE) == WINDOW_OPAQUE) &&
+	    (win->surface != NULL) && (win->opacity == 255) &&
+	    (win->angle == 0) && (win->fx == 1) && (win->fy == 1) &&
+	    (win->dx == (double) (native_t) win->dx) &&
+	    (win->dy == (double) (native_t) win->dy);
+}
+
+static void comp_window_bounds(window_t *win, sysarg_t *x, sysarg_t *y,
+    sysarg_t *w, sysarg_t *h)
+{
+	sysarg_t width, height;
+	surface_get_resolution(win->surface, &width, &height);
+	comp_coord_bounding_rect(0, 0, width, height, win->transform,
+	    x, y, w, h);
+}
+
+/** Remove the parts of a region hidden by opaque windows.
+ *
+ * @param region Region in global coordinates.
+ * @param stop   Link of the first window (counting from the top) which
+ *               shall not be considered.
+ */
+static void comp_cull_opaque(region_t *region, link_t *stop)
+{
+	/* window_list_mtx locked by caller */
+
+	for (link_t *link = window_list.head.next; link != stop;
+	    link = link->next) {
+		window_t *win = list_get_instance(link, window_t, link);
+		if (!comp_window_opaque(win))
+			continue;
+
+		sysarg_t x, y, w, h;
+		comp_window_bounds(win, &x, &y, &w, &h);
+
+		/*
+		 * Should the region become too fragmented, it is left as is,
+		 * which only results in some overdraw.
+		 */
+		(void) region_subtract_rect(region, x, y, w, h);
+
+		if (region_empty(region))
+			break;
+	}
+}
+
+/** Compose a band of viewport rows.
+ *
+ * @param frame   Frame being composed.
+ * @param surface Surface to draw into. Its first row corresponds to the
+ *                viewport row @a row_off.
+ * @param row_off Viewport row of the first surface row.
+ * @param row     First viewport row to compose.
+ * @param rows    Number of viewport rows to compose.
+ * @param stats   Pixel counters to update.
+ */
+static void comp_compose_rows(comp_frame_t *frame, surface_t *surface,
+    sysarg_t row_off, sysarg_t row, sysarg_t rows, comp_frame_stats_t *stats)
+{
+	/* window_list_mtx locked by the composing fibril */
+
+	viewport_t *vp = frame->vp;
+	sysarg_t x_org = vp->pos.x;
+	sysarg_t y_org = vp->pos.y + row_off;
+
+	sysarg_t vp_width, vp_height;
+	surface_get_resolution(vp->surface, &vp_width, &vp_height);
+
+	region_t damage;
+	region_intersect_rect(frame->damage, vp->pos.x, vp->pos.y + row,
+	    vp_width, rows, &damage);
+	if (region_empty(&damage))
+		return;
+
+	uint64_t damaged = region_area(&damage);
+	stats->damaged += damaged;
+
+	/* Paint background color where no opaque window covers it. */
+	region_t bg = damage;
+	comp_cull_opaque(&bg, &window_list.head);
+
+	for (size_t i = 0; i < bg.count; i++) {
+		region_rect_t *rect = &bg.rects[i];
+		for (sysarg_t y = rect->y0; y < rect->y1; ++y) {
+			pixel_t *dst = pixelmap_pixel_at(
+			    surface_pixmap_access(surface), rect->x0 - x_org,
+			    y - y_org);
+			sysarg_t count = rect->x1 - rect->x0;
+			while (count-- != 0) {
+				*dst++ = bg_color;
+			}
+		}
+	}
+
+	uint64_t bg_area = region_area(&bg);
+	stats->painted += bg_area;
+	stats->culled += damaged - bg_area;
+
+	transform_t transform;
+	source_t source;
+	drawctx_t context;
+
+	source_init(&source);
+	source_set_filter(&source, frame->filter);
+	drawctx_init(&context, surface);
+	drawctx_set_compose(&context, compose_over);
+	drawctx_set_source(&context, &source);
+
+	/* For each window. */
+	for (link_t *link = window_list.head.prev;
+	    link != &window_list.head; link = link->prev) {
+
+		/*
+		 * Determine what part of the window intersects with the
+		 * updated area and is not hidden by opaque windows above it.
+		 */
+		window_t *win = list_get_instance(link, window_t, link);
+		if (!win->surface) {
+			continue;
+		}
+
+		sysarg_t x_win, y_win, w_win, h_win;
+		comp_window_bounds(win, &x_win, &y_win, &w_win, &h_win);
+
+		region_t clip;
+		region_intersect_rect(&damage, x_win, y_win, w_win, h_win,
+		    &clip);
+		if (region_empty(&clip))
+			continue;
+
+		uint64_t visible = region_area(&clip);
+		comp_cull_opaque(&clip, link);
+		uint64_t painted = region_area(&clip);
+
+		stats->painted += painted;
+		stats->culled += visible - painted;
+
+		if (painted == 0)
+			continue;
+
+		/*
+		 * Prepare conversion from global coordinates to surface
+		 * coordinates.
+		 */
+		transform = win->transform;
+		double_point_t pos;
+		pos.x = x_org;
+		pos.y = y_org;
+		transform_translate(&transform, -pos.x, -pos.y);
+
+		source_set_transform(&source, transform);
+		source_set_texture(&source, win->surface,
+		    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
+		source_set_alpha(&source, PIXEL(win->opacity, 0, 0, 0));
+
+		for (size_t i = 0; i < clip.count; i++) {
+			region_rect_t *rect = &clip.rects[i];
+			drawctx_transfer(&context, rect->x0 - x_org,
+			    rect->y0 - y_org, rect->x1 - rect->x0,
+			    rect->y1 - rect->y0);
+		}
+	}
+}
+
+/** Compose a single tile of a frame.
+ *
+ * The tile is drawn through a surface aliasing its rows of the viewport,
+ * so that tiles composed in parallel never touch shared surface state.
+ *
+ * @return False if the tile could not be composed.
+ */
+static bool comp_compose_tile(comp_frame_t *frame, size_t tile,
+    comp_frame_stats_t *stats)
+{
+	viewport_t *vp = frame->vp;
+
+	sysarg_t vp_width, vp_height;
+	surface_get_resolution(vp->surface, &vp_width, &vp_height);
+
+	sysarg_t row = frame->row + tile * TILE_HEIGHT;
+	sysarg_t rows = min(TILE_HEIGHT, vp_height - row);
+
+	surface_t *surface = surface_create(vp_width, rows,
+	    pixelmap_pixel_at(surface_pixmap_access(vp->surface), 0, row),
+	    SURFACE_FLAG_EXTERNAL);
+	if (surface == NULL)
+		return false;
+
+	comp_compose_rows(frame, surface, row, row, rows, stats);
+	surface_destroy(surface);
+
+	return true;
+}
+
+/** Compose remaining tiles of the current frame.
+ *
+ * Called with frame_futex held, which is released while composing.
+ */
+static void comp_frame_run(comp_frame_t *frame)
+{
+	while (frame->next < frame->tiles) {
+		size_t tile = frame->next++;
+		futex_unlock(&frame_futex);
+
+		comp_frame_stats_t stats = { 0 };
+		bool composed = comp_compose_tile(frame, tile, &stats);
+
+		futex_lock(&frame_futex);
+		frame->stats.damaged += stats.damaged;
+		frame->stats.painted += stats.painted;
+		frame->stats.culled += stats.culled;
+		if (!composed)
+			frame->failed = true;
+	}
+}
+
+static void comp_tile_worker(void *arg)
+{
+	while (true) {
+		(void) futex_down(&frame_start);
+
+		futex_lock(&frame_futex);
+		comp_frame_run(frame_cur);
+		futex_unlock(&frame_futex);
+
+		(void) futex_up(&frame_done);
+	}
+}
+
+/** Compose the damaged part of a viewport.
+ *
+ * @param vp     Viewport.
+ * @param damage Damage clipped to the viewport (global coordinates).
+ */
+static void comp_compose_viewport(viewport_t *vp, region_t *damage)
+{
+	/* window_list_mtx locked by caller */
+
+	region_rect_t bounds;
+	if (!region_bounds(damage, &bounds))
+		return;
+
+	comp_frame_t frame;
+	memset(&frame, 0, sizeof(frame));
+	frame.vp = vp;
+	frame.damage = damage;
+	frame.filter = filter;
+	frame.row = ((bounds.y0 - vp->pos.y) / TILE_HEIGHT) * TILE_HEIGHT;
+	frame.tiles = (bounds.y1 - vp->pos.y - frame.row + TILE_HEIGHT - 1) /
+	    TILE_HEIGHT;
+
+	size_t helpers = (frame.tiles > 1) ?
+	    min(tile_workers, frame.tiles - 1) : 0;
+	bool parallel = (helpers > 0);
+	if (parallel) {
+		futex_lock(&frame_futex);
+		frame_cur = &frame;
+		futex_unlock(&frame_futex);
+
+		for (size_t i = 0; i < helpers; i++)
+			(void) futex_up(&frame_start);
+
+		futex_lock(&frame_futex);
+		comp_frame_run(&frame);
+		futex_unlock(&frame_futex);
+
+		/* Wait for the workers, blocking the whole compositor. */
+		for (size_t i = 0; i < helpers; i++)
+			(void) futex_down(&frame_done);
+
+		futex_lock(&frame_futex);
+		frame_cur = NULL;
+		futex_unlock(&frame_futex);
+	}
+
+	if ((!parallel) || (frame.failed)) {
+		/* Compose everything directly into the viewport. */
+		memset(&frame.stats, 0, sizeof(frame.stats));
+		comp_compose_rows(&frame, vp->surface, 0, frame.row,
+		    frame.tiles * TILE_HEIGHT, &frame.stats);
+	}
+
+	comp_stats.damaged += frame.stats.damaged;
+	comp_stats.painted += frame.stats.painted;
+	comp_stats.culled += frame.stats.culled;
+}
+
+static void comp_damage_region(region_t *damage)
 {
 	fibril_mutex_lock(&viewport_list_mtx);
 	fibril_mutex_lock(&window_list_mtx);
 	fibril_mutex_lock(&pointer_list_mtx);
 
+	struct timeval start;
+	getuptime(&start);
+	bool composed = false;
+
 	list_foreach(viewport_list, link, viewport_t, vp) {
 		/* Determine what part of the viewport must be updated. */
-		sysarg_t x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp;
-		surface_get_resolution(vp->surface, &w_dmg_vp, &h_dmg_vp);
-		bool isec_vp = rectangle_intersect(
-		    x_dmg_glob, y_dmg_glob, w_dmg_glob, h_dmg_glob,
-		    vp->pos.x, vp->pos.y, w_dmg_vp, h_dmg_vp,
-		    &x_dmg_vp, &y_dmg_vp, &w_dmg_vp, &h_dmg_vp);
-
-		if (isec_vp) {
-
-			/* Paint background color. */
-			for (sysarg_t y = y_dmg_vp - vp->pos.y; y <  y_dmg_vp - vp->pos.y + h_dmg_vp; ++y) {
-				pixel_t *dst = pixelmap_pixel_at(
-				    surface_pixmap_access(vp->surface), x_dmg_vp - vp->pos.x, y);
-				sysarg_t count = w_dmg_vp;
-				while (count-- != 0) {
-					*dst++ = bg_color;
-				}
-			}
-			surface_add_damaged_region(vp->surface,
-			    x_dmg_vp - vp->pos.x, y_dmg_vp - vp->pos.y, w_dmg_vp, h_dmg_vp);
-
-			transform_t transform;
-			source_t source;
-			drawctx_t context;
+		sysarg_t vp_width, vp_height;
+		surface_get_resolution(vp->surface, &vp_width, &vp_height);
 
-			source_init(&source);
-			source_set_filter(&source, filter);
-			drawctx_init(&context, vp->surface);
-			drawctx_set_compose(&context, compose_over);
-			drawctx_set_source(&context, &source);
+		region_t vp_damage;
+		region_intersect_rect(damage, vp->pos.x, vp->pos.y,
+		    vp_width, vp_height, &vp_damage);
+		if (region_empty(&vp_damage))
+			continue;
 
-			/* For each window. */
-			for (link_t *link = window_list.head.prev;
-			    link != &window_list.head; link = link->prev) {
+		comp_compose_viewport(vp, &vp_damage);
+		composed = true;
 
-				/*
-				 * Determine what part of the window intersects with the
-				 * updated area of the current viewport.
-				 */
-				window_t *win = list_get_instance(link, window_t, link);
-				if (!win->surface) {
-					continue;
-				}
-				sysarg_t x_dmg_win, y_dmg_win, w_dmg_win, h_dmg_win;
-				surface_get_resolution(win->surface, &w_dmg_win, &h_dmg_win);
-				comp_coord_bounding_rect(0, 0, w_dmg_win, h_dmg_win, win->transform,
-				    &x_dmg_win, &y_dmg_win, &w_dmg_win, &h_dmg_win);
-				bool isec_win = rectangle_intersect(
-				    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp,
-				    x_dmg_win, y_dmg_win, w_dmg_win, h_dmg_win,
-				    &x_dmg_win, &y_dmg_win, &w_dmg_win, &h_dmg_win);
-
-				if (isec_win) {
-					/*
-					 * Prepare conversion from global coordinates to viewport
-					 * coordinates.
-					 */
-					transform = win->transform;
-					double_point_t pos;
-					pos.x = vp->pos.x;
-					pos.y = vp->pos.y;
-					transform_translate(&transform, -pos.x, -pos.y);
-
-					source_set_transform(&source, transform);
-					source_set_texture(&source, win->surface,
-					    PIXELMAP_EXTEND_TRANSPARENT_SIDES);
-					source_set_alpha(&source, PIXEL(win->opacity, 0, 0, 0));
-
-					drawctx_transfer(&context,
-					    x_dmg_win - vp->pos.x, y_dmg_win - vp->pos.y, w_dmg_win, h_dmg_win);
-				}
-			}
+		for (size_t i = 0; i < vp_damage.count; i++) {
+			region_rect_t *rect = &vp_damage.rects[i];
+			sysarg_t x_dmg_vp = rect->x0;
+			sysarg_t y_dmg_vp = rect->y0;
+			sysarg_t w_dmg_vp = rect->x1 - rect->x0;
+			sysarg_t h_dmg_vp = rect->y1 - rect->y0;
 
+			region_add_rect(&vp->damage, x_dmg_vp - vp->pos.x,
+			    y_dmg_vp - vp->pos.y, w_dmg_vp, h_dmg_vp);
 			list_foreach(pointer_list, link, pointer_t, ptr) {
 				if (ptr->ghost.surface) {
 
@@ -584,23 +897,66 @@ static void comp_damage(sysarg_t x_dmg_glob, sysarg_t y_dmg_glob,
 		}
 	}
 
+	if (composed) {
+		struct timeval end;
+		getuptime(&end);
+		uint64_t usecs = tv_sub_diff(&end, &start);
+
+		comp_stats.frames++;
+		comp_stats.usecs += usecs;
+		if (usecs > comp_stats.usecs_max)
+			comp_stats.usecs_max = usecs;
+	}
+
 	fibril_mutex_unlock(&pointer_list_mtx);
 	fibril_mutex_unlock(&window_list_mtx);
 
 	/* Notify visualizers about updated regions. */
 	if (active) {
 		list_foreach(viewport_list, link, viewport_t, vp) {
-			sysarg_t x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp;
-			surface_get_damaged_region(vp->surface, &x_dmg_vp, &y_dmg_vp, &w_dmg_vp, &h_dmg_vp);
 			surface_reset_damaged_region(vp->surface);
-			visualizer_update_damaged_region(vp->sess,
-			    x_dmg_vp, y_dmg_vp, w_dmg_vp, h_dmg_vp, 0, 0);
+			for (size_t i = 0; i < vp->damage.count; i++) {
+				region_rect_t *rect = &vp->damage.rects[i];
+				visualizer_update_damaged_region(vp->sess,
+				    rect->x0, rect->y0, rect->x1 - rect->x0,
+				    rect->y1 - rect->y0, 0, 0);
+			}
+			region_init(&vp->damage);
 		}
 	}
 
 	fibril_mutex_unlock(&viewport_list_mtx);
 }
 
+static void comp_damage(sysarg_t x_dmg_glob, sysarg_t y_dmg_glob,
+    sysarg_t w_dmg_glob, sysarg_t h_dmg_glob)
+{
+	region_t damage;
+	region_init(&damage);
+	region_add_rect(&damage, x_dmg_glob, y_dmg_glob, w_dmg_glob,
+	    h_dmg_glob);
+	comp_damage_region(&damage);
+}
+
+/** Print composition statistics. */
+static void comp_stats_print(void)
+{
+	/* viewport_list_mtx locked by caller */
+
+	uint64_t avg = comp_stats.frames > 0 ?
+	    comp_stats.usecs / comp_stats.frames : 0;
+	uint64_t overdraw = comp_stats.damaged > 0 ?
+	    comp_stats.painted * 100 / comp_stats.damaged : 0;
+
+	printf("%s: %" PRIu64 " frames, %" PRIu64 " us average, "
+	    "%" PRIu64 " us max, %zu tile workers\n", NAME, comp_stats.frames,
+	    avg, comp_stats.usecs_max, tile_workers);
+	printf("%s: %" PRIu64 " px damaged, %" PRIu64 " px painted "
+	    "(overdraw %" PRIu64 ".%02" PRIu64 "), %" PRIu64 " px culled\n",
+	    NAME, comp_stats.damaged, comp_stats.painted, overdraw / 100,
+	    overdraw % 100, comp_stats.culled);
+}
+
 static void comp_window_get_event(window_t *win, ipc_call_t *icall)
 {
 	window_event_t *event = (window_event_t *) prodcons_consume(&win->queue);
@@ -804,17 +1160,14 @@ static void comp_window_resize(window_t *win, ipc_call_t *icall)
 	comp_coord_bounding_rect(0, 0, new_width, new_height, win->transform,
 	    &x2, &y2, &width2, &height2);
 
-	sysarg_t x;
-	sysarg_t y;
-	sysarg_t width;
-	sysarg_t height;
-
-	rectangle_union(x1, y1, width1, height1, x2, y2, width2, height2,
-	    &x, &y, &width, &height);
+	region_t damage;
+	region_init(&damage);
+	region_add_rect(&damage, x1, y1, width1, height1);
+	region_add_rect(&damage, x2, y2, width2, height2);
 
 	fibril_mutex_unlock(&window_list_mtx);
 
-	comp_damage(x, y, width, height);
+	comp_damage_region(&damage);
 
 	async_answer_0(icall, EOK);
 }
@@ -1092,6 +1445,7 @@ static void comp_mode_change(viewport_t *vp, ipc_call_t *icall)
 	surface_destroy(vp->surface);
 	vp->mode = new_mode;
 	vp->surface = new_surface;
+	region_init(&vp->damage);
 
 	fibril_mutex_unlock(&viewport_list_mtx);
 	async_answer_0(icall, EOK);
@@ -1235,6 +1589,7 @@ static viewport_t *viewport_create(service_id_t sid)
 	link_initialize(&vp->link);
 	vp->pos.x = coord_origin;
 	vp->pos.y = coord_origin;
+	region_init(&vp->damage);
 
 	/* Establish output bidirectional connection. */
 	vp->dsid = sid;
@@ -1572,8 +1927,13 @@ static errno_t comp_mouse_move(input_t *input, int dx, int dy)
 	pointer->pos.x += dx;
 	pointer->pos.y += dy;
 	fibril_mutex_unlock(&pointer_list_mtx);
-	comp_damage(old_pos.x, old_pos.y, cursor_width, cursor_height);
-	comp_damage(old_pos.x + dx, old_pos.y + dy, cursor_width, cursor_height);
+	region_t damage;
+	region_init(&damage);
+	region_add_rect(&damage, old_pos.x, old_pos.y, cursor_width,
+	    cursor_height);
+	region_add_rect(&damage, old_pos.x + dx, old_pos.y + dy, cursor_width,
+	    cursor_height);
+	comp_damage_region(&damage);
 
 	fibril_mutex_lock(&window_list_mtx);
 	fibril_mutex_lock(&pointer_list_mtx);
@@ -1636,10 +1996,17 @@ static errno_t comp_mouse_move(input_t *input, int dx, int dy)
 			fibril_mutex_unlock(&pointer_list_mtx);
 			fibril_mutex_unlock(&window_list_mtx);
 #if ANIMATE_WINDOW_TRANSFORMS == 0
-			comp_damage(dmg_rect1.x, dmg_rect1.y, dmg_rect1.w, dmg_rect1.h);
-			comp_damage(dmg_rect2.x, dmg_rect2.y, dmg_rect2.w, dmg_rect2.h);
-			comp_damage(dmg_rect3.x, dmg_rect3.y, dmg_rect3.w, dmg_rect3.h);
-			comp_damage(dmg_rect4.x, dmg_rect4.y, dmg_rect4.w, dmg_rect4.h);
+			region_t ghost_damage;
+			region_init(&ghost_damage);
+			region_add_rect(&ghost_damage, dmg_rect1.x, dmg_rect1.y,
+			    dmg_rect1.w, dmg_rect1.h);
+			region_add_rect(&ghost_damage, dmg_rect2.x, dmg_rect2.y,
+			    dmg_rect2.w, dmg_rect2.h);
+			region_add_rect(&ghost_damage, dmg_rect3.x, dmg_rect3.y,
+			    dmg_rect3.w, dmg_rect3.h);
+			region_add_rect(&ghost_damage, dmg_rect4.x, dmg_rect4.y,
+			    dmg_rect4.w, dmg_rect4.h);
+			comp_damage_region(&ghost_damage);
 #endif
 #if ANIMATE_WINDOW_TRANSFORMS == 1
 			comp_damage(x, y, width, height);
@@ -1816,15 +2183,25 @@ static errno_t comp_mouse_button(input_t *input, int bnum, int bpress)
 	fibril_mutex_unlock(&pointer_list_mtx);
 	fibril_mutex_unlock(&window_list_mtx);
 
+	region_t damage;
+	region_init(&damage);
+
 #if ANIMATE_WINDOW_TRANSFORMS == 0
-	comp_damage(dmg_rect1.x, dmg_rect1.y, dmg_rect1.w, dmg_rect1.h);
-	comp_damage(dmg_rect2.x, dmg_rect2.y, dmg_rect2.w, dmg_rect2.h);
-	comp_damage(dmg_rect3.x, dmg_rect3.y, dmg_rect3.w, dmg_rect3.h);
-	comp_damage(dmg_rect4.x, dmg_rect4.y, dmg_rect4.w, dmg_rect4.h);
+	region_add_rect(&damage, dmg_rect1.x, dmg_rect1.y, dmg_rect1.w,
+	    dmg_rect1.h);
+	region_add_rect(&damage, dmg_rect2.x, dmg_rect2.y, dmg_rect2.w,
+	    dmg_rect2.h);
+	region_add_rect(&damage, dmg_rect3.x, dmg_rect3.y, dmg_rect3.w,
+	    dmg_rect3.h);
+	region_add_rect(&damage, dmg_rect4.x, dmg_rect4.y, dmg_rect4.w,
+	    dmg_rect4.h);
 #endif
 
-	if (dmg_width > 0 && dmg_height > 0) {
-		comp_damage(dmg_x, dmg_y, dmg_width, dmg_height);
+	if (dmg_width > 0 && dmg_height > 0)
+		region_add_rect(&damage, dmg_x, dmg_y, dmg_width, dmg_height);
+
+	if (!region_empty(&damage)) {
+		comp_damage_region(&damage);
 	}
 
 	if (event_unfocus && win_unfocus) {
@@ -1868,10 +2245,11 @@ static errno_t comp_key_press(input_t *input, kbd_event_type_t type, keycode_t k
 	bool viewport_change = (mods & KM_ALT) && (key == KC_O || key == KC_P);
 	bool kconsole_switch = (key == KC_PAUSE) || (key == KC_BREAK);
 	bool filter_switch = (mods & KM_ALT) && (key == KC_Y);
+	bool stats_print = (mods & KM_ALT) && (key == KC_U);
 
 	bool key_filter = (type == KEY_RELEASE) && (win_transform || win_resize ||
 	    win_opacity || win_close || win_switch || viewport_move ||
-	    viewport_change || kconsole_switch || filter_switch);
+	    viewport_change || kconsole_switch || filter_switch || stats_print);
 
 	if (key_filter) {
 		/* no-op */
@@ -1911,7 +2289,7 @@ static errno_t comp_key_press(input_t *input, kbd_event_type_t type, keycode_t k
 			}
 
 			/* Transform the window and calculate damage. */
-			sysarg_t x, y, width, height;
+			sysarg_t width, height;
 			surface_get_resolution(win->surface, &width, &height);
 			sysarg_t x1, y1, width1, height1;
 			sysarg_t x2, y2, width2, height2;
@@ -1920,11 +2298,14 @@ static errno_t comp_key_press(input_t *input, kbd_event_type_t type, keycode_t k
 			comp_recalc_transform(win);
 			comp_coord_bounding_rect(0, 0, width, height, win->transform,
 			    &x2, &y2, &width2, &height2);
-			rectangle_union(x1, y1, width1, height1, x2, y2, width2, height2,
-			    &x, &y, &width, &height);
+
+			region_t damage;
+			region_init(&damage);
+			region_add_rect(&damage, x1, y1, width1, height1);
+			region_add_rect(&damage, x2, y2, width2, height2);
 			fibril_mutex_unlock(&window_list_mtx);
 
-			comp_damage(x, y, width, height);
+			comp_damage_region(&damage);
 		} else {
 			fibril_mutex_unlock(&window_list_mtx);
 		}
@@ -2058,9 +2439,10 @@ static errno_t comp_key_press(input_t *input, kbd_event_type_t type, keycode_t k
 				    &x2, &y2, &width2, &height2);
 			}
 
-			sysarg_t x, y, width, height;
-			rectangle_union(x1, y1, width1, height1, x2, y2, width2, height2,
-			    &x, &y, &width, &height);
+			region_t damage;
+			region_init(&damage);
+			region_add_rect(&damage, x1, y1, width1, height1);
+			region_add_rect(&damage, x2, y2, width2, height2);
 
 			fibril_mutex_unlock(&window_list_mtx);
 
@@ -2072,7 +2454,7 @@ static errno_t comp_key_press(input_t *input, kbd_event_type_t type, keycode_t k
 				comp_post_event_win(event2, win2);
 			}
 
-			comp_damage(x, y, width, height);
+			comp_damage_region(&damage);
 		} else {
 			fibril_mutex_unlock(&window_list_mtx);
 		}
@@ -2151,6 +2533,10 @@ static errno_t comp_key_press(input_t *input, kbd_event_type_t type, keycode_t k
 			filter = filter_bilinear;
 		}
 		comp_damage(0, 0, UINT32_MAX, UINT32_MAX);
+	} else if (stats_print) {
+		fibril_mutex_lock(&viewport_list_mtx);
+		comp_stats_print();
+		fibril_mutex_unlock(&viewport_list_mtx);
 	} else {
 		window_event_t *event = (window_event_t *) malloc(sizeof(window_event_t));
 		if (event == NULL)
@@ -2266,6 +2652,30 @@ static void category_change_cb(void *arg)
 	discover_viewports();
 }
 
+/** Start threads composing tiles on the other processors. */
+static void comp_start_tile_workers(void)
+{
+	size_t cpus = 0;
+	stats_cpu_t *stats = stats_get_cpus(&cpus);
+	free(stats);
+
+	if (cpus < 2)
+		return;
+
+	size_t workers = min(cpus - 1, TILE_WORKERS_MAX);
+
+	for (size_t i = 0; i < workers; i++) {
+		thread_id_t tid;
+		errno_t rc = thread_create(comp_tile_worker, NULL,
+		    "compositor tile worker", &tid);
+		if (rc != EOK)
+			break;
+
+		thread_detach(tid);
+		tile_workers++;
+	}
+}
+
 static errno_t compositor_srv_init(char *input_svc, char *name)
 {
 	/* Coordinates of the central pixel. */
@@ -2318,6 +2728,7 @@ static errno_t compositor_srv_init(char *input_svc, char *name)
 	}
 
 	discover_viewports();
+	comp_start_tile_workers();
 
 	comp_restrict_pointers();
 	comp_damage(0, 0, UINT32_MAX, UINT32_MAX);
@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup compositor
+ * @{
+ */
+/** @file Damage region sets.
+ */
+
+#include <errno.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "region.h"
+
+#define COORD_MAX  ((sysarg_t) -1)
+
+/** Maximum number of pieces produced by subtracting one rectangle. */
+#define SUBTRACT_PIECES  4
+
+static bool rect_make(sysarg_t x, sysarg_t y, sysarg_t w, sysarg_t h,
+    region_rect_t *rect)
+{
+	if (w == 0 || h == 0)
+		return false;
+
+	rect->x0 = x;
+	rect->y0 = y;
+	rect->x1 = (w > COORD_MAX - x) ? COORD_MAX : x + w;
+	rect->y1 = (h > COORD_MAX - y) ? COORD_MAX : y + h;
+
+	return (rect->x1 > rect->x0) && (rect->y1 > rect->y0);
+}
+
+static bool rect_intersect(region_rect_t *a, region_rect_t *b,
+    region_rect_t *isec)
+{
+	isec->x0 = a->x0 > b->x0 ? a->x0 : b->x0;
+	isec->y0 = a->y0 > b->y0 ? a->y0 : b->y0;
+	isec->x1 = a->x1 < b->x1 ? a->x1 : b->x1;
+	isec->y1 = a->y1 < b->y1 ? a->y1 : b->y1;
+
+	return (isec->x1 > isec->x0) && (isec->y1 > isec->y0);
+}
+
+static bool rect_contains(region_rect_t *outer, region_rect_t *inner)
+{
+	return (inner->x0 >= outer->x0) && (inner->x1 <= outer->x1) &&
+	    (inner->y0 >= outer->y0) && (inner->y1 <= outer->y1);
+}
+
+/** Subtract rectangle @a b from rectangle @a a.
+ *
+ * @param a      Minuend.
+ * @param b      Subtrahend.
+ * @param pieces Array of at least SUBTRACT_PIECES rectangles receiving
+ *               the disjoint remainder.
+ *
+ * @return Number of pieces stored.
+ */
+static size_t rect_subtract(region_rect_t *a, region_rect_t *b,
+    region_rect_t *pieces)
+{
+	region_rect_t isec;
+	if (!rect_intersect(a, b, &isec)) {
+		pieces[0] = *a;
+		return 1;
+	}
+
+	size_t count = 0;
+
+	/* Full-width band above the intersection. */
+	if (isec.y0 > a->y0) {
+		pieces[count++] = (region_rect_t) {
+			a->x0, a->y0, a->x1, isec.y0
+		};
+	}
+
+	/* Full-width band below the intersection. */
+	if (isec.y1 < a->y1) {
+		pieces[count++] = (region_rect_t) {
+			a->x0, isec.y1, a->x1, a->y1
+		};
+	}
+
+	/* Left and right remainders of the intersecting band. */
+	if (isec.x0 > a->x0) {
+		pieces[count++] = (region_rect_t) {
+			a->x0, isec.y0, isec.x0, isec.y1
+		};
+	}
+
+	if (isec.x1 < a->x1) {
+		pieces[count++] = (region_rect_t) {
+			isec.x1, isec.y0, a->x1, isec.y1
+		};
+	}
+
+	return count;
+}
+
+static void region_collapse(region_t *region, region_rect_t *rect)
+{
+	region_rect_t bounds;
+	if (region_bounds(region, &bounds)) {
+		if (rect->x0 < bounds.x0)
+			bounds.x0 = rect->x0;
+		if (rect->y0 < bounds.y0)
+			bounds.y0 = rect->y0;
+		if (rect->x1 > bounds.x1)
+			bounds.x1 = rect->x1;
+		if (rect->y1 > bounds.y1)
+			bounds.y1 = rect->y1;
+	} else {
+		bounds = *rect;
+	}
+
+	region->rects[0] = bounds;
+	region->count = 1;
+}
+
+/** Initialize an empty region. */
+void region_init(region_t *region)
+{
+	region->count = 0;
+}
+
+/** Determine whether the region covers no pixels. */
+bool region_empty(region_t *region)
+{
+	return region->count == 0;
+}
+
+/** Add a rectangle to the region.
+ *
+ * The part of the rectangle already covered by the region is discarded,
+ * so the rectangles of the region stay pairwise disjoint. Should the
+ * result not fit into REGION_MAX_RECTS rectangles, the region is replaced
+ * by the bounding box of the union.
+ *
+ * @param region Region to extend.
+ * @param x      Left edge of the rectangle.
+ * @param y      Top edge of the rectangle.
+ * @param w      Width of the rectangle (clamped at the coordinate range).
+ * @param h      Height of the rectangle (clamped at the coordinate range).
+ */
+void region_add_rect(region_t *region, sysarg_t x, sysarg_t y, sysarg_t w,
+    sysarg_t h)
+{
+	region_rect_t rect;
+	if (!rect_make(x, y, w, h, &rect))
+		return;
+
+	region_rect_t pieces[REGION_MAX_RECTS];
+	region_rect_t next[REGION_MAX_RECTS];
+	size_t count = 1;
+	pieces[0] = rect;
+
+	for (size_t i = 0; (i < region->count) && (count > 0); i++) {
+		region_rect_t *cur = &region->rects[i];
+
+		if (rect_contains(cur, &rect))
+			return;
+
+		size_t next_count = 0;
+		for (size_t j = 0; j < count; j++) {
+			region_rect_t sub[SUBTRACT_PIECES];
+			size_t sub_count = rect_subtract(&pieces[j], cur, sub);
+
+			if (next_count + sub_count > REGION_MAX_RECTS) {
+				region_collapse(region, &rect);
+				return;
+			}
+
+			for (size_t k = 0; k < sub_count; k++)
+				next[next_count++] = sub[k];
+		}
+
+		for (size_t j = 0; j < next_count; j++)
+			pieces[j] = next[j];
+
+		count = next_count;
+	}
+
+	if (region->count + count > REGION_MAX_RECTS) {
+		region_collapse(region, &rect);
+		return;
+	}
+
+	for (size_t i = 0; i < count; i++)
+		region->rects[region->count++] = pieces[i];
+}
+
+/** Add all rectangles of @a src to @a region. */
+void region_add_region(region_t *region, region_t *src)
+{
+	for (size_t i = 0; i < src->count; i++) {
+		region_rect_t *rect = &src->rects[i];
+		region_add_rect(region, rect->x0, rect->y0,
+		    rect->x1 - rect->x0, rect->y1 - rect->y0);
+	}
+}
+
+/** Remove a rectangle from the region.
+ *
+ * Unlike addition, subtraction cannot fall back to a coarser result
+ * without losing pixels, so the region is left untouched if the
+ * remainder would not fit.
+ *
+ * @param region Region to shrink.
+ * @param x      Left edge of the rectangle.
+ * @param y      Top edge of the rectangle.
+ * @param w      Width of the rectangle.
+ * @param h      Height of the rectangle.
+ *
+ * @return EOK on success, ELIMIT if the result exceeds REGION_MAX_RECTS
+ *         rectangles.
+ */
+errno_t region_subtract_rect(region_t *region, sysarg_t x, sysarg_t y,
+    sysarg_t w, sysarg_t h)
+{
+	region_rect_t rect;
+	if (!rect_make(x, y, w, h, &rect))
+		return EOK;
+
+	region_rect_t result[REGION_MAX_RECTS];
+	size_t count = 0;
+
+	for (size_t i = 0; i < region->count; i++) {
+		region_rect_t sub[SUBTRACT_PIECES];
+		size_t sub_count = rect_subtract(&region->rects[i], &rect, sub);
+
+		if (count + sub_count > REGION_MAX_RECTS)
+			return ELIMIT;
+
+		for (size_t k = 0; k < sub_count; k++)
+			result[count++] = sub[k];
+	}
+
+	for (size_t i = 0; i < count; i++)
+		region->rects[i] = result[i];
+
+	region->count = count;
+	return EOK;
+}
+
+/** Clip the region by a rectangle.
+ *
+ * @param region Source region.
+ * @param x      Left edge of the clipping rectangle.
+ * @param y      Top edge of the clipping rectangle.
+ * @param w      Width of the clipping rectangle.
+ * @param h      Height of the clipping rectangle.
+ * @param isec   Region receiving the intersection (may not alias
+ *               @a region).
+ */
+void region_intersect_rect(region_t *region, sysarg_t x, sysarg_t y,
+    sysarg_t w, sysarg_t h, region_t *isec)
+{
+	region_init(isec);
+
+	region_rect_t rect;
+	if (!rect_make(x, y, w, h, &rect))
+		return;
+
+	for (size_t i = 0; i < region->count; i++) {
+		region_rect_t *out = &isec->rects[isec->count];
+		if (rect_intersect(&region->rects[i], &rect, out))
+			isec->count++;
+	}
+}
+
+/** Number of pixels covered by the region. */
+uint64_t region_area(region_t *region)
+{
+	uint64_t area = 0;
+
+	for (size_t i = 0; i < region->count; i++) {
+		region_rect_t *rect = &region->rects[i];
+		area += (uint64_t) (rect->x1 - rect->x0) *
+		    (uint64_t) (rect->y1 - rect->y0);
+	}
+
+	return area;
+}
+
+/** Get the bounding box of the region.
+ *
+ * @return False if the region is empty.
+ */
+bool region_bounds(region_t *region, region_rect_t *bounds)
+{
+	if (region->count == 0)
+		return false;
+
+	*bounds = region->rects[0];
+
+	for (size_t i = 1; i < region->count; i++) {
+		region_rect_t *rect = &region->rects[i];
+
+		if (rect->x0 < bounds->x0)
+			bounds->x0 = rect->x0;
+		if (rect->y0 < bounds->y0)
+			bounds->y0 = rect->y0;
+		if (rect->x1 > bounds->x1)
+			bounds->x1 = rect->x1;
+		if (rect->y1 > bounds->y1)
+			bounds->y1 = rect->y1;
+	}
+
+	return true;
+}
+
+/** @}
+ */
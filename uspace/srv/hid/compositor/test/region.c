@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <errno.h>
+#include <pcut/pcut.h>
+
+#include "../region.h"
+
+PCUT_INIT;
+
+PCUT_TEST_SUITE(region);
+
+/** Adding disjoint and overlapping rectangles keeps the area exact. */
+PCUT_TEST(add_overlapping)
+{
+	region_t region;
+
+	region_init(&region);
+	PCUT_ASSERT_TRUE(region_empty(&region));
+
+	region_add_rect(&region, 0, 0, 10, 10);
+	region_add_rect(&region, 5, 5, 10, 10);
+	PCUT_ASSERT_INT_EQUALS(175, region_area(&region));
+
+	/* Fully covered rectangle does not change anything. */
+	size_t count = region.count;
+	region_add_rect(&region, 2, 2, 3, 3);
+	PCUT_ASSERT_INT_EQUALS(count, region.count);
+	PCUT_ASSERT_INT_EQUALS(175, region_area(&region));
+
+	/* Empty rectangles are ignored. */
+	region_add_rect(&region, 100, 100, 0, 10);
+	PCUT_ASSERT_INT_EQUALS(175, region_area(&region));
+
+	region_rect_t bounds;
+	PCUT_ASSERT_TRUE(region_bounds(&region, &bounds));
+	PCUT_ASSERT_INT_EQUALS(0, bounds.x0);
+	PCUT_ASSERT_INT_EQUALS(0, bounds.y0);
+	PCUT_ASSERT_INT_EQUALS(15, bounds.x1);
+	PCUT_ASSERT_INT_EQUALS(15, bounds.y1);
+}
+
+/** Subtracting a rectangle punches a hole into the region. */
+PCUT_TEST(subtract_hole)
+{
+	region_t region;
+
+	region_init(&region);
+	region_add_rect(&region, 0, 0, 10, 10);
+
+	errno_t rc = region_subtract_rect(&region, 3, 3, 4, 4);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_INT_EQUALS(4, region.count);
+	PCUT_ASSERT_INT_EQUALS(84, region_area(&region));
+
+	/* Subtracting everything leaves the region empty. */
+	rc = region_subtract_rect(&region, 0, 0, 10, 10);
+	PCUT_ASSERT_ERRNO_VAL(EOK, rc);
+	PCUT_ASSERT_TRUE(region_empty(&region));
+}
+
+/** Clipping yields only the parts inside the clipping rectangle. */
+PCUT_TEST(intersect)
+{
+	region_t region;
+	region_t isec;
+
+	region_init(&region);
+	region_add_rect(&region, 0, 0, 10, 10);
+	region_add_rect(&region, 20, 0, 10, 10);
+
+	region_intersect_rect(&region, 5, 5, 20, 20, &isec);
+	PCUT_ASSERT_INT_EQUALS(2, isec.count);
+	PCUT_ASSERT_INT_EQUALS(50, region_area(&isec));
+
+	region_intersect_rect(&region, 10, 0, 10, 10, &isec);
+	PCUT_ASSERT_TRUE(region_empty(&isec));
+}
+
+/** Huge rectangles are clamped rather than wrapping around. */
+PCUT_TEST(clamp)
+{
+	region_t region;
+	region_t isec;
+
+	region_init(&region);
+	region_add_rect(&region, 16, 16, (sysarg_t) -1, (sysarg_t) -1);
+
+	region_intersect_rect(&region, 0, 0, 32, 32, &isec);
+	PCUT_ASSERT_INT_EQUALS(256, region_area(&isec));
+}
+
+/** Overflowing the capacity degrades to the bounding box. */
+PCUT_TEST(add_overflow)
+{
+	region_t region;
+
+	region_init(&region);
+
+	for (sysarg_t i = 0; i < REGION_MAX_RECTS + 1; i++)
+		region_add_rect(&region, i * 2, 0, 1, 1);
+
+	PCUT_ASSERT_INT_EQUALS(1, region.count);
+	PCUT_ASSERT_INT_EQUALS(REGION_MAX_RECTS * 2 + 1,
+	    region_area(&region));
+}
+
+/** Subtraction that would overflow leaves the region intact. */
+PCUT_TEST(subtract_overflow)
+{
+	region_t region;
+
+	region_init(&region);
+
+	for (sysarg_t i = 0; i < REGION_MAX_RECTS; i++)
+		region_add_rect(&region, i * 4, 0, 3, 3);
+
+	uint64_t area = region_area(&region);
+
+	/* Splits every rectangle into two pieces. */
+	errno_t rc = region_subtract_rect(&region, 0, 1, 4 * REGION_MAX_RECTS,
+	    1);
+	PCUT_ASSERT_ERRNO_VAL(ELIMIT, rc);
+	PCUT_ASSERT_INT_EQUALS(REGION_MAX_RECTS, region.count);
+	PCUT_ASSERT_INT_EQUALS(area, region_area(&region));
+}
+
+PCUT_EXPORT(region);
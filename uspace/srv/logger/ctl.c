@@ -59,6 +59,27 @@ static errno_t handle_log_level_change(sysarg_t new_level)
 
 	log_unlock(log);
 
+	writers_update_levels();
+	return EOK;
+}
+
+static errno_t handle_log_level_get(log_level_t *level)
+{
+	void *full_name;
+	errno_t rc = async_data_write_accept(&full_name, true, 0, 0, 0, NULL);
+	if (rc != EOK) {
+		return rc;
+	}
+
+	logger_log_t *log = find_log_by_name_and_lock(full_name);
+	free(full_name);
+	if (log == NULL)
+		return ENOENT;
+
+	*level = log->logged_level;
+
+	log_unlock(log);
+
 	return EOK;
 }
 
@@ -66,6 +87,7 @@ void logger_connection_handler_control(ipc_call_t *icall)
 {
 	errno_t rc;
 	int fd;
+	log_level_t level = LVL_FATAL;
 
 	async_answer_0(icall, EOK);
 	logger_log("control: new client.\n");
@@ -80,12 +102,18 @@ void logger_connection_handler_control(ipc_call_t *icall)
 		switch (IPC_GET_IMETHOD(call)) {
 		case LOGGER_CONTROL_SET_DEFAULT_LEVEL:
 			rc = set_default_logging_level(IPC_GET_ARG1(call));
+			if (rc == EOK)
+				writers_update_levels();
 			async_answer_0(&call, rc);
 			break;
 		case LOGGER_CONTROL_SET_LOG_LEVEL:
 			rc = handle_log_level_change(IPC_GET_ARG1(call));
 			async_answer_0(&call, rc);
 			break;
+		case LOGGER_CONTROL_GET_LOG_LEVEL:
+			rc = handle_log_level_get(&level);
+			async_answer_1(&call, rc, level);
+			break;
 		case LOGGER_CONTROL_SET_ROOT:
 			rc = vfs_receive_handle(true, &fd);
 			if (rc == EOK) {
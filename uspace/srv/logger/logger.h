@@ -38,10 +38,12 @@
 #include <adt/list.h>
 #include <adt/prodcons.h>
 #include <io/log.h>
+#include <ipc/logger.h>
 #include <async.h>
 #include <stdbool.h>
 #include <fibril_synch.h>
 #include <stdio.h>
+#include <shmring.h>
 
 #define NAME "logger"
 #define LOG_LEVEL_USE_DEFAULT (LVL_LIMIT + 1)
@@ -74,19 +76,35 @@ struct logger_log {
 	logger_dest_t *dest;
 };
 
-#define MAX_REFERENCED_LOGS_PER_CLIENT 100
+#define MAX_REFERENCED_LOGS_PER_CLIENT LOGGER_CLIENT_LOGS_MAX
 
 typedef struct {
 	size_t logs_count;
 	logger_log_t *logs[MAX_REFERENCED_LOGS_PER_CLIENT];
 } logger_registered_logs_t;
 
+/** Writer client. */
+typedef struct {
+	/** Link to the list of writers */
+	link_t link;
+	/** Logs of the client, indexed by slot */
+	logger_registered_logs_t registered_logs;
+	/** Effective levels shared by the client or @c NULL */
+	logger_levels_t *levels;
+	/** Ring of messages shared by the client or @c NULL */
+	shmring_t *ring;
+	/** Message taken from the ring */
+	char message[LOGGER_MESSAGE_MAX + 1];
+} logger_writer_t;
+
 logger_log_t *find_log_by_name_and_lock(const char *name);
 logger_log_t *find_or_create_log_and_lock(const char *, sysarg_t);
 logger_log_t *find_log_by_id_and_lock(sysarg_t);
+log_level_t get_log_level(logger_log_t *);
 bool shall_log_message(logger_log_t *, log_level_t);
 void log_unlock(logger_log_t *);
 void write_to_log(logger_log_t *, log_level_t, const char *);
+void flush_log(logger_log_t *);
 void log_release(logger_log_t *);
 
 void registered_logs_init(logger_registered_logs_t *);
@@ -99,6 +117,7 @@ errno_t set_default_logging_level(log_level_t);
 
 void logger_connection_handler_control(ipc_call_t *);
 void logger_connection_handler_writer(ipc_call_t *);
+void writers_update_levels(void);
 
 void parse_initial_settings(void);
 void parse_level_settings(char *);
@@ -185,14 +185,19 @@ static log_level_t get_actual_log_level(logger_log_t *log)
 	return log->logged_level;
 }
 
-bool shall_log_message(logger_log_t *log, log_level_t level)
+log_level_t get_log_level(logger_log_t *log)
 {
 	fibril_mutex_lock(&log_list_guard);
-	bool result = level <= get_actual_log_level(log);
+	log_level_t result = get_actual_log_level(log);
 	fibril_mutex_unlock(&log_list_guard);
 	return result;
 }
 
+bool shall_log_message(logger_log_t *log, log_level_t level)
+{
+	return level <= get_log_level(log);
+}
+
 void log_unlock(logger_log_t *log)
 {
 	assert(fibril_mutex_is_locked(&log->guard));
@@ -297,12 +302,27 @@ void write_to_log(logger_log_t *log, log_level_t level, const char *message)
 		fprintf(log->dest->logfile, "[%s] %s: %s\n",
 		    log->full_name, log_level_str(level),
 		    (const char *) message);
-		fflush(log->dest->logfile);
 	}
 
 	fibril_mutex_unlock(&log->dest->guard);
 }
 
+/** Write messages buffered by write_to_log() to the log file.
+ *
+ * Precondition: log is locked.
+ *
+ * @param log Log to flush.
+ */
+void flush_log(logger_log_t *log)
+{
+	assert(fibril_mutex_is_locked(&log->guard));
+	assert(log->dest != NULL);
+	fibril_mutex_lock(&log->dest->guard);
+	if (log->dest->logfile != NULL)
+		fflush(log->dest->logfile);
+	fibril_mutex_unlock(&log->dest->guard);
+}
+
 void registered_logs_init(logger_registered_logs_t *logs)
 {
 	logs->logs_count = 0;
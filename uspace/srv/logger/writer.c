@@ -41,26 +41,94 @@
 #include <io/logctl.h>
 #include <io/klog.h>
 #include <ns.h>
+#include <as.h>
+#include <assert.h>
 #include <async.h>
 #include <errno.h>
+#include <macros.h>
+#include <mem.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <str_error.h>
 #include "logger.h"
 
+/** Guards the list of writers, their logs and level tables. */
+static FIBRIL_MUTEX_INITIALIZE(writers_guard);
+static LIST_INITIALIZE(writers);
 
-static logger_log_t *handle_create_log(sysarg_t parent)
+/** Publish effective level of a log to the writer.
+ *
+ * Precondition: writers_guard is locked.
+ */
+static void writer_update_level(logger_writer_t *writer, size_t slot)
+{
+	assert(fibril_mutex_is_locked(&writers_guard));
+
+	if (writer->levels == NULL)
+		return;
+
+	log_level_t level = get_log_level(writer->registered_logs.logs[slot]);
+	__atomic_store_n(&writer->levels->level[slot],
+	    (uint8_t) min(level, LVL_LIMIT), __ATOMIC_RELAXED);
+}
+
+/** Publish effective levels of all logs to all writers.
+ *
+ * To be called whenever a logging level changes.
+ */
+void writers_update_levels(void)
+{
+	fibril_mutex_lock(&writers_guard);
+	list_foreach(writers, link, logger_writer_t, writer) {
+		for (size_t i = 0; i < writer->registered_logs.logs_count; i++)
+			writer_update_level(writer, i);
+	}
+	fibril_mutex_unlock(&writers_guard);
+}
+
+static errno_t handle_create_log(logger_writer_t *writer, sysarg_t parent,
+    logger_log_t **rlog, size_t *rslot)
 {
 	void *name;
 	errno_t rc = async_data_write_accept(&name, true, 1, 0, 0, NULL);
 	if (rc != EOK)
-		return NULL;
+		return ENOMEM;
 
-	logger_log_t *log = find_or_create_log_and_lock(name, parent);
+	fibril_mutex_lock(&writers_guard);
 
+	logger_log_t *log = find_or_create_log_and_lock(name, parent);
 	free(name);
+	if (log == NULL) {
+		fibril_mutex_unlock(&writers_guard);
+		return ENOMEM;
+	}
+
+	if (!register_log(&writer->registered_logs, log)) {
+		log_unlock(log);
+		fibril_mutex_unlock(&writers_guard);
+		return ELIMIT;
+	}
+
+	log_unlock(log);
 
-	return log;
+	*rlog = log;
+	*rslot = writer->registered_logs.logs_count - 1;
+	writer_update_level(writer, *rslot);
+
+	fibril_mutex_unlock(&writers_guard);
+	return EOK;
+}
+
+/** Write message to the log.
+ *
+ * Precondition: log is locked.
+ */
+static void log_message(logger_log_t *log, log_level_t level,
+    const char *message)
+{
+	KLOG_PRINTF(level, "[%s] %s: %s",
+	    log->full_name, log_level_str(level), message);
+	write_to_log(log, level, message);
 }
 
 static errno_t handle_receive_message(sysarg_t log_id, sysarg_t level)
@@ -79,10 +147,8 @@ static errno_t handle_receive_message(sysarg_t log_id, sysarg_t level)
 		goto leave;
 	}
 
-	KLOG_PRINTF(level, "[%s] %s: %s",
-	    log->full_name, log_level_str(level),
-	    (const char *) message);
-	write_to_log(log, level, message);
+	log_message(log, level, message);
+	flush_log(log);
 
 	rc = EOK;
 
@@ -93,18 +159,125 @@ leave:
 	return rc;
 }
 
+static errno_t handle_share_levels(logger_writer_t *writer)
+{
+	ipc_call_t call;
+	size_t size;
+	unsigned int flags;
+	void *area;
+
+	if (!async_share_out_receive(&call, &size, &flags)) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (size < sizeof(logger_levels_t) || (flags & AS_AREA_WRITE) == 0) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	errno_t rc = async_share_out_finalize(&call, &area);
+	if (rc != EOK || area == AS_MAP_FAILED)
+		return ENOMEM;
+
+	fibril_mutex_lock(&writers_guard);
+
+	if (writer->levels != NULL)
+		as_area_destroy(writer->levels);
+
+	writer->levels = area;
+	for (size_t i = 0; i < writer->registered_logs.logs_count; i++)
+		writer_update_level(writer, i);
+
+	fibril_mutex_unlock(&writers_guard);
+	return EOK;
+}
+
+/** Write out all messages in the writer's ring.
+ *
+ * The log files are flushed once the whole batch has been written.
+ */
+static errno_t writer_drain(logger_writer_t *writer)
+{
+	logger_registered_logs_t *logs = &writer->registered_logs;
+	bool written[MAX_REFERENCED_LOGS_PER_CLIENT] = { false };
+	void *data;
+	size_t size;
+	sysarg_t arg;
+	errno_t rc;
+
+	while ((rc = shmring_peek(writer->ring, &data, &size, &arg)) == EOK) {
+		size_t slot = LOGGER_RING_ARG_SLOT(arg);
+		log_level_t level = LOGGER_RING_ARG_LEVEL(arg);
+
+		if (slot < logs->logs_count && level < LVL_LIMIT &&
+		    shall_log_message(logs->logs[slot], level)) {
+			/* The client can change the message at any time. */
+			size = min(size, LOGGER_MESSAGE_MAX);
+			memcpy(writer->message, data, size);
+			writer->message[size] = '\0';
+
+			fibril_mutex_lock(&logs->logs[slot]->guard);
+			log_message(logs->logs[slot], level, writer->message);
+			log_unlock(logs->logs[slot]);
+			written[slot] = true;
+		}
+
+		shmring_release(writer->ring);
+	}
+
+	for (size_t i = 0; i < logs->logs_count; i++) {
+		if (!written[i])
+			continue;
+
+		fibril_mutex_lock(&logs->logs[i]->guard);
+		flush_log(logs->logs[i]);
+		log_unlock(logs->logs[i]);
+	}
+
+	return (rc == ENOENT) ? EOK : rc;
+}
+
+static errno_t handle_share_ring(logger_writer_t *writer)
+{
+	shmring_t *ring;
+	errno_t rc = shmring_accept(&ring);
+	if (rc != EOK)
+		return rc;
+
+	if (writer->ring != NULL) {
+		(void) writer_drain(writer);
+		shmring_destroy(writer->ring);
+	}
+
+	writer->ring = ring;
+	return EOK;
+}
+
 void logger_connection_handler_writer(ipc_call_t *icall)
 {
+	logger_writer_t *writer;
 	logger_log_t *log;
+	size_t slot;
 	errno_t rc;
 
+	writer = calloc(1, sizeof(logger_writer_t));
+	if (writer == NULL) {
+		async_answer_0(icall, ENOMEM);
+		return;
+	}
+
 	/* Acknowledge the connection. */
 	async_answer_0(icall, EOK);
 
 	logger_log("writer: new client.\n");
 
-	logger_registered_logs_t registered_logs;
-	registered_logs_init(&registered_logs);
+	registered_logs_init(&writer->registered_logs);
+	link_initialize(&writer->link);
+
+	fibril_mutex_lock(&writers_guard);
+	list_append(&writer->link, &writers);
+	fibril_mutex_unlock(&writers_guard);
 
 	while (true) {
 		ipc_call_t call;
@@ -115,31 +288,52 @@ void logger_connection_handler_writer(ipc_call_t *icall)
 
 		switch (IPC_GET_IMETHOD(call)) {
 		case LOGGER_WRITER_CREATE_LOG:
-			log = handle_create_log(IPC_GET_ARG1(call));
-			if (log == NULL) {
-				async_answer_0(&call, ENOMEM);
-				break;
-			}
-			if (!register_log(&registered_logs, log)) {
-				log_unlock(log);
-				async_answer_0(&call, ELIMIT);
+			rc = handle_create_log(writer, IPC_GET_ARG1(call),
+			    &log, &slot);
+			if (rc != EOK) {
+				async_answer_0(&call, rc);
 				break;
 			}
-			log_unlock(log);
-			async_answer_1(&call, EOK, (sysarg_t) log);
+			async_answer_2(&call, EOK, (sysarg_t) log, slot);
 			break;
 		case LOGGER_WRITER_MESSAGE:
 			rc = handle_receive_message(IPC_GET_ARG1(call),
 			    IPC_GET_ARG2(call));
 			async_answer_0(&call, rc);
 			break;
+		case LOGGER_WRITER_SHARE_LEVELS:
+			rc = handle_share_levels(writer);
+			async_answer_0(&call, rc);
+			break;
+		case LOGGER_WRITER_SHARE_RING:
+			rc = handle_share_ring(writer);
+			async_answer_0(&call, rc);
+			break;
+		case LOGGER_WRITER_RING_NOTIFY:
+			rc = (writer->ring != NULL) ? writer_drain(writer) :
+			    ENOENT;
+			async_answer_0(&call, rc);
+			break;
 		default:
 			async_answer_0(&call, EINVAL);
 			break;
 		}
 	}
 
-	unregister_logs(&registered_logs);
+	/* Messages left behind by a terminated client are still valid. */
+	if (writer->ring != NULL) {
+		(void) writer_drain(writer);
+		shmring_destroy(writer->ring);
+	}
+
+	fibril_mutex_lock(&writers_guard);
+	list_remove(&writer->link);
+	if (writer->levels != NULL)
+		as_area_destroy(writer->levels);
+	unregister_logs(&writer->registered_logs);
+	fibril_mutex_unlock(&writers_guard);
+
+	free(writer);
 	logger_log("writer: client terminated.\n");
 }
 
@@ -0,0 +1,391 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/** @addtogroup dnsres
+ * @{
+ */
+/**
+ * @file
+ * @brief Resource record cache.
+ *
+ * Caches address and canonical name records and negative answers
+ * (RFC 2308) for the time given by their TTL. The number of entries
+ * is bounded, the least recently used entries are evicted first.
+ */
+
+#include <adt/hash.h>
+#include <adt/hash_table.h>
+#include <adt/list.h>
+#include <errno.h>
+#include <fibril_synch.h>
+#include <io/log.h>
+#include <macros.h>
+#include <stdlib.h>
+#include <str.h>
+#include <sys/time.h>
+
+#include "cache.h"
+#include "dns_std.h"
+#include "dns_type.h"
+
+/** Maximum number of cache entries */
+#define CACHE_MAX_ENTRIES  512
+
+/** Maximum time to live of a cached record (seconds) */
+#define CACHE_TTL_MAX  (24 * 60 * 60)
+
+/** Maximum time to live of a negative answer (seconds, RFC 2308) */
+#define CACHE_NEG_TTL_MAX  (3 * 60 * 60)
+
+/** Maximum length of a chain of canonical names followed in the cache */
+#define CACHE_CNAME_MAX  8
+
+/** Cache entries, least recently used first */
+static FIBRIL_MUTEX_INITIALIZE(cache_lock);
+static LIST_INITIALIZE(cache_list);
+
+/** Cache entries hashed by owner name and type */
+static hash_table_t cache_hash;
+
+/** Number of entries evicted to respect CACHE_MAX_ENTRIES */
+static uint64_t cache_evictions;
+
+typedef struct {
+	const char *name;
+	dns_type_t rtype;
+} cache_key_t;
+
+static size_t cache_name_hash(const char *name, dns_type_t rtype)
+{
+	size_t hash = rtype;
+
+	/* Domain names are compared case-insensitively. */
+	for (const char *c = name; *c != '\0'; c++) {
+		char ch = *c;
+		if (ch >= 'A' && ch <= 'Z')
+			ch = ch - 'A' + 'a';
+
+		hash = hash * 31 + (uint8_t) ch;
+	}
+
+	return hash_mix(hash);
+}
+
+static size_t cache_key_hash(void *key)
+{
+	cache_key_t *ckey = (cache_key_t *) key;
+	return cache_name_hash(ckey->name, ckey->rtype);
+}
+
+static size_t cache_hash_fn(const ht_link_t *item)
+{
+	dns_cache_entry_t *entry = hash_table_get_inst(item,
+	    dns_cache_entry_t, cache_hash);
+	return cache_name_hash(entry->name, entry->rtype);
+}
+
+static bool cache_key_equal(void *key, const ht_link_t *item)
+{
+	cache_key_t *ckey = (cache_key_t *) key;
+	dns_cache_entry_t *entry = hash_table_get_inst(item,
+	    dns_cache_entry_t, cache_hash);
+	return entry->rtype == ckey->rtype &&
+	    str_casecmp(entry->name, ckey->name) == 0;
+}
+
+static hash_table_ops_t cache_hash_ops = {
+	.hash = cache_hash_fn,
+	.key_hash = cache_key_hash,
+	.key_equal = cache_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+errno_t dns_cache_init(void)
+{
+	if (!hash_table_create(&cache_hash, 0, 0, &cache_hash_ops))
+		return ENOMEM;
+
+	return EOK;
+}
+
+static void cache_entry_destroy(dns_cache_entry_t *entry)
+{
+	hash_table_remove_item(&cache_hash, &entry->cache_hash);
+	list_remove(&entry->cache_list);
+	free(entry->name);
+	free(entry->cname);
+	free(entry);
+}
+
+/** Find a live cache entry.
+ *
+ * Expired entries are removed as they are found. A found entry becomes
+ * the most recently used one.
+ *
+ * @param name  Owner name
+ * @param rtype Record type
+ * @param now   Current time
+ *
+ * @return Cache entry or @c NULL if there is none.
+ */
+static dns_cache_entry_t *cache_find(const char *name, dns_type_t rtype,
+    struct timeval *now)
+{
+	assert(fibril_mutex_is_locked(&cache_lock));
+
+	cache_key_t key = {
+		.name = name,
+		.rtype = rtype
+	};
+
+	ht_link_t *link = hash_table_find(&cache_hash, &key);
+	if (link == NULL)
+		return NULL;
+
+	dns_cache_entry_t *entry = hash_table_get_inst(link,
+	    dns_cache_entry_t, cache_hash);
+
+	if (tv_gteq(now, &entry->expires)) {
+		cache_entry_destroy(entry);
+		return NULL;
+	}
+
+	list_remove(&entry->cache_list);
+	list_append(&entry->cache_list, &cache_list);
+	return entry;
+}
+
+/** Look up an address in the cache.
+ *
+ * Canonical names cached for @a name are followed the same way as in
+ * an answer from the name server.
+ *
+ * @param name  Host name
+ * @param qtype DTYPE_A or DTYPE_AAAA
+ * @param info  Host information to fill in
+ *
+ * @return EOK if found, EIO if a negative answer is cached,
+ *         ENOENT if the cache cannot answer, ENOMEM if out of memory.
+ */
+errno_t dns_cache_lookup(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info)
+{
+	struct timeval now;
+	getuptime(&now);
+
+	fibril_mutex_lock(&cache_lock);
+
+	const char *sname = name;
+	errno_t rc = ENOENT;
+
+	for (size_t depth = 0; depth < CACHE_CNAME_MAX; depth++) {
+		dns_cache_entry_t *entry = cache_find(sname, qtype, &now);
+		if (entry != NULL) {
+			if (entry->negative) {
+				rc = EIO;
+				break;
+			}
+
+			info->cname = str_dup(entry->name);
+			if (info->cname == NULL) {
+				rc = ENOMEM;
+				break;
+			}
+
+			info->addr = entry->addr;
+			rc = EOK;
+			break;
+		}
+
+		entry = cache_find(sname, DTYPE_CNAME, &now);
+		if (entry == NULL)
+			break;
+
+		/* Continue looking for the more canonical name */
+		sname = entry->cname;
+	}
+
+	fibril_mutex_unlock(&cache_lock);
+	return rc;
+}
+
+/** Insert or refresh a cache entry.
+ *
+ * @param name     Owner name
+ * @param rtype    Record type or query type of a negative answer
+ * @param negative Entry records a negative answer
+ * @param cname    Canonical name or @c NULL
+ * @param addr     Host address or @c NULL
+ * @param ttl      Time to live (seconds), must be non-zero
+ *
+ * @return EOK on success, ENOMEM if out of memory.
+ */
+static errno_t cache_add(const char *name, dns_type_t rtype, bool negative,
+    const char *cname, inet_addr_t *addr, uint32_t ttl)
+{
+	struct timeval now;
+	getuptime(&now);
+
+	char *cname_copy = NULL;
+	if (cname != NULL) {
+		cname_copy = str_dup(cname);
+		if (cname_copy == NULL)
+			return ENOMEM;
+	}
+
+	fibril_mutex_lock(&cache_lock);
+
+	dns_cache_entry_t *entry = cache_find(name, rtype, &now);
+	if (entry != NULL) {
+		/* Refresh existing entry */
+		free(entry->cname);
+	} else {
+		entry = calloc(1, sizeof(dns_cache_entry_t));
+		if (entry == NULL) {
+			fibril_mutex_unlock(&cache_lock);
+			free(cname_copy);
+			return ENOMEM;
+		}
+
+		entry->name = str_dup(name);
+		if (entry->name == NULL) {
+			fibril_mutex_unlock(&cache_lock);
+			free(entry);
+			free(cname_copy);
+			return ENOMEM;
+		}
+
+		entry->rtype = rtype;
+		hash_table_insert(&cache_hash, &entry->cache_hash);
+		list_append(&entry->cache_list, &cache_list);
+	}
+
+	entry->negative = negative;
+	entry->cname = cname_copy;
+	if (addr != NULL)
+		entry->addr = *addr;
+	else
+		inet_addr_any(&entry->addr);
+
+	/* The TTL in microseconds would overflow a 32-bit suseconds_t. */
+	entry->expires = now;
+	entry->expires.tv_sec += ttl;
+
+	while (hash_table_size(&cache_hash) > CACHE_MAX_ENTRIES) {
+		dns_cache_entry_t *lru = list_get_instance(
+		    list_first(&cache_list), dns_cache_entry_t, cache_list);
+		cache_entry_destroy(lru);
+		cache_evictions++;
+	}
+
+	fibril_mutex_unlock(&cache_lock);
+	return EOK;
+}
+
+/** Cache a canonical name record.
+ *
+ * @param name  Alias
+ * @param cname Canonical name
+ * @param ttl   Time to live (seconds)
+ *
+ * @return EOK on success, ENOMEM if out of memory.
+ */
+errno_t dns_cache_add_cname(const char *name, const char *cname, uint32_t ttl)
+{
+	if (ttl == 0)
+		return EOK;
+
+	return cache_add(name, DTYPE_CNAME, false, cname, NULL,
+	    min(ttl, CACHE_TTL_MAX));
+}
+
+/** Cache an address record.
+ *
+ * @param name  Host name
+ * @param rtype DTYPE_A or DTYPE_AAAA
+ * @param addr  Host address
+ * @param ttl   Time to live (seconds)
+ *
+ * @return EOK on success, ENOMEM if out of memory.
+ */
+errno_t dns_cache_add_addr(const char *name, dns_type_t rtype,
+    inet_addr_t *addr, uint32_t ttl)
+{
+	if (ttl == 0)
+		return EOK;
+
+	return cache_add(name, rtype, false, NULL, addr,
+	    min(ttl, CACHE_TTL_MAX));
+}
+
+/** Cache a negative answer.
+ *
+ * @param name  Queried name
+ * @param qtype Query type
+ * @param ttl   Time to live (seconds)
+ *
+ * @return EOK on success, ENOMEM if out of memory.
+ */
+errno_t dns_cache_add_negative(const char *name, dns_qtype_t qtype,
+    uint32_t ttl)
+{
+	if (ttl == 0)
+		return EOK;
+
+	return cache_add(name, qtype, true, NULL, NULL,
+	    min(ttl, CACHE_NEG_TTL_MAX));
+}
+
+/** Remove all entries from the cache. */
+void dns_cache_flush(void)
+{
+	fibril_mutex_lock(&cache_lock);
+
+	while (!list_empty(&cache_list)) {
+		cache_entry_destroy(list_get_instance(list_first(&cache_list),
+		    dns_cache_entry_t, cache_list));
+	}
+
+	fibril_mutex_unlock(&cache_lock);
+}
+
+/** Fill in the cache part of resolver statistics.
+ *
+ * @param stats Statistics structure
+ */
+void dns_cache_get_stats(dnsr_stats_t *stats)
+{
+	fibril_mutex_lock(&cache_lock);
+	stats->evictions = cache_evictions;
+	stats->entries = hash_table_size(&cache_hash);
+	fibril_mutex_unlock(&cache_lock);
+}
+
+/** @}
+ */
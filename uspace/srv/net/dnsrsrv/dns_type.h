@@ -36,11 +36,13 @@
 #ifndef DNS_TYPE_H
 #define DNS_TYPE_H
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <inet/inet.h>
 #include <inet/addr.h>
 #include <stdbool.h>
 #include <stdint.h>
+#include <sys/time.h>
 #include "dns_std.h"
 
 /** Encoded DNS PDU */
@@ -118,6 +120,26 @@ typedef struct {
 	inet_addr_t addr;
 } dns_host_info_t;
 
+/** Cached resource record or negative answer */
+typedef struct {
+	/** Link to cache_list, least recently used first */
+	link_t cache_list;
+	/** Link to cache_hash */
+	ht_link_t cache_hash;
+	/** Owner name, compared case-insensitively */
+	char *name;
+	/** Record type or, for a negative entry, the query type */
+	dns_type_t rtype;
+	/** The name has no record of type @c rtype */
+	bool negative;
+	/** Canonical name for DTYPE_CNAME records */
+	char *cname;
+	/** Host address for DTYPE_A and DTYPE_AAAA records */
+	inet_addr_t addr;
+	/** Time at which the entry expires */
+	struct timeval expires;
+} dns_cache_entry_t;
+
 typedef struct {
 } dnsr_client_t;
 
@@ -33,11 +33,15 @@
  * @file
  */
 
+#include <adt/list.h>
 #include <errno.h>
+#include <fibril_synch.h>
 #include <io/log.h>
+#include <macros.h>
 #include <mem.h>
 #include <stdlib.h>
 #include <str.h>
+#include "cache.h"
 #include "dns_msg.h"
 #include "dns_std.h"
 #include "dns_type.h"
@@ -46,7 +50,100 @@
 
 static uint16_t msg_id;
 
-static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
+/** Query sent to the name server, shared by identical lookups */
+typedef struct {
+	/** Link to inflight_list */
+	link_t inflight_list;
+	/** Queried name */
+	char *name;
+	/** Query type */
+	dns_qtype_t qtype;
+	/** Number of lookups waiting for the query, including the sender */
+	size_t refcnt;
+	/** The query has completed */
+	bool done;
+	/** Result of the query */
+	errno_t rc;
+	/** Resolved host information if @c rc is EOK */
+	dns_host_info_t info;
+} dns_inflight_t;
+
+/** Queries in progress (of dns_inflight_t) */
+static FIBRIL_MUTEX_INITIALIZE(inflight_lock);
+static FIBRIL_CONDVAR_INITIALIZE(inflight_cv);
+static LIST_INITIALIZE(inflight_list);
+
+/** Resolver statistics, protected by inflight_lock */
+static dnsr_stats_t query_stats;
+
+/** Store address and canonical name records of an answer in the cache. */
+static void dns_cache_answer(dns_message_t *amsg)
+{
+	list_foreach(amsg->answer, msg, dns_rr_t, rr) {
+		if (rr->rclass != DC_IN)
+			continue;
+
+		if (rr->rtype == DTYPE_CNAME) {
+			char *cname;
+			size_t eoff;
+			if (dns_name_decode(&amsg->pdu, rr->roff, &cname,
+			    &eoff) != EOK)
+				continue;
+
+			(void) dns_cache_add_cname(rr->name, cname, rr->ttl);
+			free(cname);
+		} else if ((rr->rtype == DTYPE_A) &&
+		    (rr->rdata_size == sizeof(addr32_t))) {
+			inet_addr_t addr;
+			inet_addr_set(dns_uint32_t_decode(rr->rdata,
+			    rr->rdata_size), &addr);
+
+			(void) dns_cache_add_addr(rr->name, DTYPE_A, &addr,
+			    rr->ttl);
+		} else if ((rr->rtype == DTYPE_AAAA) &&
+		    (rr->rdata_size == sizeof(addr128_t))) {
+			addr128_t addr6;
+			dns_addr128_t_decode(rr->rdata, rr->rdata_size, addr6);
+
+			inet_addr_t addr;
+			inet_addr_set6(addr6, &addr);
+
+			(void) dns_cache_add_addr(rr->name, DTYPE_AAAA, &addr,
+			    rr->ttl);
+		}
+	}
+}
+
+/** Store a negative answer in the cache.
+ *
+ * Following RFC 2308, the answer is cached for the lesser of the TTL
+ * and the MINIMUM field of the SOA record in the authority section.
+ * Answers without an SOA record are not cached.
+ */
+static void dns_cache_negative(dns_message_t *amsg, const char *name,
+    dns_qtype_t qtype)
+{
+	if ((amsg->rcode != RC_OK) && (amsg->rcode != RC_NAME_ERR))
+		return;
+
+	list_foreach(amsg->authority, msg, dns_rr_t, rr) {
+		if ((rr->rtype != DTYPE_SOA) || (rr->rclass != DC_IN))
+			continue;
+
+		/* MINIMUM is the last field of the SOA RDATA */
+		if (rr->rdata_size < 5 * sizeof(uint32_t))
+			continue;
+
+		uint32_t minimum = dns_uint32_t_decode((uint8_t *) rr->rdata +
+		    rr->rdata_size - sizeof(uint32_t), sizeof(uint32_t));
+
+		(void) dns_cache_add_negative(name, qtype,
+		    min(rr->ttl, minimum));
+		return;
+	}
+}
+
+static errno_t dns_name_query_send(const char *name, dns_qtype_t qtype,
     dns_host_info_t *info)
 {
 	/* Start with the caller-provided name */
@@ -89,6 +186,10 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 	list_append(&question->msg, &msg->question);
 
+	fibril_mutex_lock(&inflight_lock);
+	query_stats.queries++;
+	fibril_mutex_unlock(&inflight_lock);
+
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "dns_name_query: send DNS request");
 	dns_message_t *amsg;
 	errno_t rc = dns_request(msg, &amsg);
@@ -98,6 +199,8 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 		return rc;
 	}
 
+	dns_cache_answer(amsg);
+
 	list_foreach(amsg->answer, msg, dns_rr_t, rr) {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, " - '%s' %u/%u, dsize %zu",
 		    rr->name, rr->rtype, rr->rclass, rr->rdata_size);
@@ -182,6 +285,8 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 
 	log_msg(LOG_DEFAULT, LVL_DEBUG, "'%s' not resolved, fail", sname);
 
+	dns_cache_negative(amsg, name, qtype);
+
 	dns_message_destroy(msg);
 	dns_message_destroy(amsg);
 	free(sname);
@@ -189,6 +294,121 @@ static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
 	return EIO;
 }
 
+static dns_inflight_t *dns_inflight_find(const char *name, dns_qtype_t qtype)
+{
+	assert(fibril_mutex_is_locked(&inflight_lock));
+
+	list_foreach(inflight_list, inflight_list, dns_inflight_t, inflight) {
+		if ((inflight->qtype == qtype) &&
+		    (str_casecmp(inflight->name, name) == 0))
+			return inflight;
+	}
+
+	return NULL;
+}
+
+/** Drop a reference to a query, destroying it with the last one. */
+static void dns_inflight_release(dns_inflight_t *inflight)
+{
+	assert(fibril_mutex_is_locked(&inflight_lock));
+
+	if (--inflight->refcnt > 0)
+		return;
+
+	free(inflight->info.cname);
+	free(inflight->name);
+	free(inflight);
+}
+
+/** Copy the result of a completed query. */
+static errno_t dns_inflight_result(dns_inflight_t *inflight,
+    dns_host_info_t *info)
+{
+	assert(inflight->done);
+
+	if (inflight->rc != EOK)
+		return inflight->rc;
+
+	info->cname = str_dup(inflight->info.cname);
+	if (info->cname == NULL)
+		return ENOMEM;
+
+	info->addr = inflight->info.addr;
+	return EOK;
+}
+
+/** Resolve a name, using the cache where possible.
+ *
+ * A lookup which misses the cache while an identical query is already
+ * in progress waits for and shares the result of that query instead of
+ * sending another one.
+ */
+static errno_t dns_name_query(const char *name, dns_qtype_t qtype,
+    dns_host_info_t *info)
+{
+	errno_t rc = dns_cache_lookup(name, qtype, info);
+
+	fibril_mutex_lock(&inflight_lock);
+
+	if (rc != ENOENT) {
+		if (rc == EOK)
+			query_stats.hits++;
+		else if (rc == EIO)
+			query_stats.neg_hits++;
+
+		fibril_mutex_unlock(&inflight_lock);
+		return rc;
+	}
+
+	query_stats.misses++;
+
+	dns_inflight_t *inflight = dns_inflight_find(name, qtype);
+	if (inflight != NULL) {
+		query_stats.coalesced++;
+		inflight->refcnt++;
+
+		while (!inflight->done)
+			fibril_condvar_wait(&inflight_cv, &inflight_lock);
+
+		rc = dns_inflight_result(inflight, info);
+		dns_inflight_release(inflight);
+		fibril_mutex_unlock(&inflight_lock);
+		return rc;
+	}
+
+	inflight = calloc(1, sizeof(dns_inflight_t));
+	if (inflight == NULL) {
+		fibril_mutex_unlock(&inflight_lock);
+		return ENOMEM;
+	}
+
+	inflight->name = str_dup(name);
+	if (inflight->name == NULL) {
+		fibril_mutex_unlock(&inflight_lock);
+		free(inflight);
+		return ENOMEM;
+	}
+
+	inflight->qtype = qtype;
+	inflight->refcnt = 1;
+	list_append(&inflight->inflight_list, &inflight_list);
+	fibril_mutex_unlock(&inflight_lock);
+
+	rc = dns_name_query_send(name, qtype, &inflight->info);
+
+	fibril_mutex_lock(&inflight_lock);
+	list_remove(&inflight->inflight_list);
+	inflight->done = true;
+	inflight->rc = rc;
+	fibril_condvar_broadcast(&inflight_cv);
+
+	rc = dns_inflight_result(inflight, info);
+	dns_inflight_release(inflight);
+	fibril_mutex_unlock(&inflight_lock);
+
+	return rc;
+}
+
 errno_t dns_name2host(const char *name, dns_host_info_t **rinfo, ip_ver_t ver)
 {
 	dns_host_info_t *info = calloc(1, sizeof(dns_host_info_t));
@@ -229,5 +449,15 @@ void dns_hostinfo_destroy(dns_host_info_t *info)
 	free(info);
 }
 
+/** Get resolver and cache statistics. */
+void dns_get_stats(dnsr_stats_t *stats)
+{
+	fibril_mutex_lock(&inflight_lock);
+	*stats = query_stats;
+	fibril_mutex_unlock(&inflight_lock);
+
+	dns_cache_get_stats(stats);
+}
+
 /** @}
  */
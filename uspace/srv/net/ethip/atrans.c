@@ -34,50 +34,134 @@
  * @brief
  */
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/iplink_srv.h>
 #include <stdlib.h>
+#include <sys/time.h>
 
 #include "atrans.h"
 #include "ethip.h"
 
-/** Address translation list (of ethip_atrans_t) */
+/** Time after which an address translation entry expires (microseconds) */
+#define ATRANS_MAX_AGE  (300 * 1000 * 1000)
+
+/** Maximum number of address translation entries */
+#define ATRANS_MAX_ENTRIES  1024
+
+/** Address translation list (of ethip_atrans_t), oldest entries first */
 static FIBRIL_MUTEX_INITIALIZE(atrans_list_lock);
 static LIST_INITIALIZE(atrans_list);
 static FIBRIL_CONDVAR_INITIALIZE(atrans_cv);
 
+/** Address translation entries hashed by IP address */
+static hash_table_t atrans_hash;
+
+static size_t atrans_key_hash(void *key)
+{
+	addr32_t *ip_addr = (addr32_t *) key;
+	return *ip_addr;
+}
+
+static size_t atrans_hash_fn(const ht_link_t *item)
+{
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    atrans_hash);
+	return atrans->ip_addr;
+}
+
+static bool atrans_key_equal(void *key, const ht_link_t *item)
+{
+	addr32_t *ip_addr = (addr32_t *) key;
+	ethip_atrans_t *atrans = hash_table_get_inst(item, ethip_atrans_t,
+	    atrans_hash);
+	return atrans->ip_addr == *ip_addr;
+}
+
+static hash_table_ops_t atrans_hash_ops = {
+	.hash = atrans_hash_fn,
+	.key_hash = atrans_key_hash,
+	.key_equal = atrans_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+errno_t atrans_init(void)
+{
+	if (!hash_table_create(&atrans_hash, 0, 0, &atrans_hash_ops))
+		return ENOMEM;
+
+	return EOK;
+}
+
 static ethip_atrans_t *atrans_find(addr32_t ip_addr)
 {
-	list_foreach(atrans_list, atrans_list, ethip_atrans_t, atrans) {
-		if (atrans->ip_addr == ip_addr)
-			return atrans;
-	}
+	ht_link_t *link = hash_table_find(&atrans_hash, &ip_addr);
+	if (link == NULL)
+		return NULL;
+
+	return hash_table_get_inst(link, ethip_atrans_t, atrans_hash);
+}
+
+static void atrans_destroy(ethip_atrans_t *atrans)
+{
+	hash_table_remove_item(&atrans_hash, &atrans->atrans_hash);
+	list_remove(&atrans->atrans_list);
+	free(atrans);
+}
+
+/** Remove expired entries and entries exceeding the table size.
+ *
+ * Entries are kept in the order of their last update, so it suffices
+ * to look at the beginning of the list.
+ *
+ * @param now Current time
+ */
+static void atrans_expire(struct timeval *now)
+{
+	while (!list_empty(&atrans_list)) {
+		ethip_atrans_t *atrans = list_get_instance(
+		    list_first(&atrans_list), ethip_atrans_t, atrans_list);
+
+		if (hash_table_size(&atrans_hash) <= ATRANS_MAX_ENTRIES &&
+		    tv_gt(&atrans->expires, now))
+			break;
 
-	return NULL;
+		atrans_destroy(atrans);
+	}
 }
 
 errno_t atrans_add(addr32_t ip_addr, addr48_t mac_addr)
 {
 	ethip_atrans_t *atrans;
-	ethip_atrans_t *prev;
-
-	atrans = calloc(1, sizeof(ethip_atrans_t));
-	if (atrans == NULL)
-		return ENOMEM;
+	struct timeval now;
 
-	atrans->ip_addr = ip_addr;
-	addr48(mac_addr, atrans->mac_addr);
+	getuptime(&now);
 
 	fibril_mutex_lock(&atrans_list_lock);
-	prev = atrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->atrans_list);
-		free(prev);
+	atrans = atrans_find(ip_addr);
+	if (atrans != NULL) {
+		/* Refresh existing entry */
+		list_remove(&atrans->atrans_list);
+	} else {
+		atrans = calloc(1, sizeof(ethip_atrans_t));
+		if (atrans == NULL) {
+			fibril_mutex_unlock(&atrans_list_lock);
+			return ENOMEM;
+		}
+
+		atrans->ip_addr = ip_addr;
+		hash_table_insert(&atrans_hash, &atrans->atrans_hash);
 	}
 
+	addr48(mac_addr, atrans->mac_addr);
+	atrans->expires = now;
+	tv_add_diff(&atrans->expires, ATRANS_MAX_AGE);
 	list_append(&atrans->atrans_list, &atrans_list);
+
+	atrans_expire(&now);
 	fibril_mutex_unlock(&atrans_list_lock);
 	fibril_condvar_broadcast(&atrans_cv);
 
@@ -95,9 +179,8 @@ errno_t atrans_remove(addr32_t ip_addr)
 		return ENOENT;
 	}
 
-	list_remove(&atrans->atrans_list);
+	atrans_destroy(atrans);
 	fibril_mutex_unlock(&atrans_list_lock);
-	free(atrans);
 
 	return EOK;
 }
@@ -108,6 +191,15 @@ static errno_t atrans_lookup_locked(addr32_t ip_addr, addr48_t mac_addr)
 	if (atrans == NULL)
 		return ENOENT;
 
+	struct timeval now;
+	getuptime(&now);
+
+	if (tv_gteq(&now, &atrans->expires)) {
+		/* Stale entry, the address needs to be resolved again. */
+		atrans_destroy(atrans);
+		return ENOENT;
+	}
+
 	addr48(atrans->mac_addr, mac_addr);
 	return EOK;
 }
@@ -41,6 +41,7 @@
 #include <inet/addr.h>
 #include "ethip.h"
 
+extern errno_t atrans_init(void);
 extern errno_t atrans_add(addr32_t, addr48_t);
 extern errno_t atrans_remove(addr32_t);
 extern errno_t atrans_lookup(addr32_t, addr48_t);
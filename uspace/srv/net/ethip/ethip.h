@@ -37,6 +37,7 @@
 #ifndef ETHIP_H_
 #define ETHIP_H_
 
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <async.h>
 #include <inet/iplink_srv.h>
@@ -44,6 +45,7 @@
 #include <loc.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <sys/time.h>
 
 typedef struct {
 	link_t link;
@@ -110,9 +112,14 @@ typedef struct {
 
 /** Address translation table element */
 typedef struct {
+	/** Link to atrans_list, ordered by time of last update */
 	link_t atrans_list;
+	/** Link to atrans_hash */
+	ht_link_t atrans_hash;
 	addr32_t ip_addr;
 	addr48_t mac_addr;
+	/** Time when the entry expires */
+	struct timeval expires;
 } ethip_atrans_t;
 
 extern errno_t ethip_iplink_init(ethip_nic_t *);
@@ -38,6 +38,7 @@
 #include <errno.h>
 #include <io/log.h>
 #include <mem.h>
+#include <nettl/checksum.h>
 #include <stdlib.h>
 #include <types/inetping.h>
 #include "icmp.h"
@@ -99,9 +100,14 @@ static errno_t icmp_recv_echo_request(inet_dgram_t *dgram)
 
 	reply->type = ICMP_ECHO_REPLY;
 	reply->code = 0;
-	reply->checksum = 0;
 
-	checksum = inet_checksum_calc(INET_CHECKSUM_INIT, reply, size);
+	/*
+	 * Only the type and code change, so update the checksum
+	 * of the request instead of computing it from scratch.
+	 */
+	checksum = inet_checksum_update16(uint16_t_be2host(request->checksum),
+	    ((uint16_t) request->type << 8) | request->code,
+	    ((uint16_t) reply->type << 8) | reply->code);
 	reply->checksum = host2uint16_t_be(checksum);
 
 	rdgram.iplink = 0;
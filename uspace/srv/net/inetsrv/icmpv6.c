@@ -38,6 +38,7 @@
 #include <errno.h>
 #include <io/log.h>
 #include <mem.h>
+#include <nettl/checksum.h>
 #include <stdlib.h>
 #include <types/inetping.h>
 #include "icmpv6.h"
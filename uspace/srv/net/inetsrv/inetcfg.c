@@ -203,7 +203,13 @@ static errno_t inetcfg_sroute_create(char *name, inet_naddr_t *dest,
 	sroute->dest = *dest;
 	sroute->router = *router;
 	sroute->name = str_dup(name);
-	inet_sroute_add(sroute);
+
+	errno_t rc = inet_sroute_add(sroute);
+	if (rc != EOK) {
+		inet_sroute_delete(sroute);
+		*sroute_id = 0;
+		return rc;
+	}
 
 	*sroute_id = sroute->id;
 	return EOK;
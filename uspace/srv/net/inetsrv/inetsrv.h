@@ -123,6 +123,8 @@ typedef struct {
 /** Static route configuration */
 typedef struct {
 	link_t sroute_list;
+	/** Link to routing trie */
+	link_t sroute_trie;
 	sysarg_t id;
 	/** Destination network */
 	inet_naddr_t dest;
@@ -34,18 +34,84 @@
  * @brief
  */
 
+#include <adt/hash.h>
+#include <adt/hash_table.h>
 #include <adt/list.h>
 #include <errno.h>
 #include <fibril_synch.h>
 #include <inet/iplink_srv.h>
 #include <stdlib.h>
+#include <sys/time.h>
 #include "ntrans.h"
 
-/** Address translation list (of inet_ntrans_t) */
+/** Time after which a translation table entry expires (microseconds) */
+#define NTRANS_MAX_AGE  (300 * 1000 * 1000)
+
+/** Maximum number of translation table entries */
+#define NTRANS_MAX_ENTRIES  1024
+
+/** Address translation list (of inet_ntrans_t), oldest entries first */
 static FIBRIL_MUTEX_INITIALIZE(ntrans_list_lock);
 static LIST_INITIALIZE(ntrans_list);
 static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
 
+/** Address translation entries hashed by IPv6 address */
+static hash_table_t ntrans_hash;
+
+static size_t ntrans_addr_hash(const addr128_t ip_addr)
+{
+	size_t hash = 0;
+
+	for (size_t i = 0; i < 16; i += 4) {
+		hash = hash_combine(hash, ((uint32_t) ip_addr[i] << 24) |
+		    ((uint32_t) ip_addr[i + 1] << 16) |
+		    ((uint32_t) ip_addr[i + 2] << 8) | ip_addr[i + 3]);
+	}
+
+	return hash;
+}
+
+static size_t ntrans_key_hash(void *key)
+{
+	return ntrans_addr_hash(*(addr128_t *) key);
+}
+
+static size_t ntrans_hash_fn(const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    ntrans_hash);
+	return ntrans_addr_hash(ntrans->ip_addr);
+}
+
+static bool ntrans_key_equal(void *key, const ht_link_t *item)
+{
+	inet_ntrans_t *ntrans = hash_table_get_inst(item, inet_ntrans_t,
+	    ntrans_hash);
+	return addr128_compare(ntrans->ip_addr, *(addr128_t *) key);
+}
+
+static hash_table_ops_t ntrans_hash_ops = {
+	.hash = ntrans_hash_fn,
+	.key_hash = ntrans_key_hash,
+	.key_equal = ntrans_key_equal,
+	.equal = NULL,
+	.remove_callback = NULL
+};
+
+/** Initialize translation table
+ *
+ * @return EOK on success
+ * @return ENOMEM if not enough memory
+ *
+ */
+errno_t ntrans_init(void)
+{
+	if (!hash_table_create(&ntrans_hash, 0, 0, &ntrans_hash_ops))
+		return ENOMEM;
+
+	return EOK;
+}
+
 /** Look for address in translation table
  *
  * @param ip_addr IPv6 address
@@ -55,12 +121,45 @@ static FIBRIL_CONDVAR_INITIALIZE(ntrans_cv);
  */
 static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 {
-	list_foreach(ntrans_list, ntrans_list, inet_ntrans_t, ntrans) {
-		if (addr128_compare(ntrans->ip_addr, ip_addr))
-			return ntrans;
-	}
+	ht_link_t *link = hash_table_find(&ntrans_hash, ip_addr);
+	if (link == NULL)
+		return NULL;
 
-	return NULL;
+	return hash_table_get_inst(link, inet_ntrans_t, ntrans_hash);
+}
+
+/** Remove entry from translation table and free it
+ *
+ * @param ntrans Translation table entry
+ *
+ */
+static void ntrans_destroy(inet_ntrans_t *ntrans)
+{
+	hash_table_remove_item(&ntrans_hash, &ntrans->ntrans_hash);
+	list_remove(&ntrans->ntrans_list);
+	free(ntrans);
+}
+
+/** Remove expired entries and entries exceeding the table size
+ *
+ * Entries are kept in the order of their last update, so it suffices
+ * to look at the beginning of the list.
+ *
+ * @param now Current time
+ *
+ */
+static void ntrans_expire(struct timeval *now)
+{
+	while (!list_empty(&ntrans_list)) {
+		inet_ntrans_t *ntrans = list_get_instance(
+		    list_first(&ntrans_list), inet_ntrans_t, ntrans_list);
+
+		if (hash_table_size(&ntrans_hash) <= NTRANS_MAX_ENTRIES &&
+		    tv_gt(&ntrans->expires, now))
+			break;
+
+		ntrans_destroy(ntrans);
+	}
 }
 
 /** Add entry to translation table
@@ -75,23 +174,32 @@ static inet_ntrans_t *ntrans_find(addr128_t ip_addr)
 errno_t ntrans_add(addr128_t ip_addr, addr48_t mac_addr)
 {
 	inet_ntrans_t *ntrans;
-	inet_ntrans_t *prev;
+	struct timeval now;
 
-	ntrans = calloc(1, sizeof(inet_ntrans_t));
-	if (ntrans == NULL)
-		return ENOMEM;
-
-	addr128(ip_addr, ntrans->ip_addr);
-	addr48(mac_addr, ntrans->mac_addr);
+	getuptime(&now);
 
 	fibril_mutex_lock(&ntrans_list_lock);
-	prev = ntrans_find(ip_addr);
-	if (prev != NULL) {
-		list_remove(&prev->ntrans_list);
-		free(prev);
+	ntrans = ntrans_find(ip_addr);
+	if (ntrans != NULL) {
+		/* Refresh existing entry */
+		list_remove(&ntrans->ntrans_list);
+	} else {
+		ntrans = calloc(1, sizeof(inet_ntrans_t));
+		if (ntrans == NULL) {
+			fibril_mutex_unlock(&ntrans_list_lock);
+			return ENOMEM;
+		}
+
+		addr128(ip_addr, ntrans->ip_addr);
+		hash_table_insert(&ntrans_hash, &ntrans->ntrans_hash);
 	}
 
+	addr48(mac_addr, ntrans->mac_addr);
+	ntrans->expires = now;
+	tv_add_diff(&ntrans->expires, NTRANS_MAX_AGE);
 	list_append(&ntrans->ntrans_list, &ntrans_list);
+
+	ntrans_expire(&now);
 	fibril_mutex_unlock(&ntrans_list_lock);
 	fibril_condvar_broadcast(&ntrans_cv);
 
@@ -117,9 +225,8 @@ errno_t ntrans_remove(addr128_t ip_addr)
 		return ENOENT;
 	}
 
-	list_remove(&ntrans->ntrans_list);
+	ntrans_destroy(ntrans);
 	fibril_mutex_unlock(&ntrans_list_lock);
-	free(ntrans);
 
 	return EOK;
 }
@@ -130,11 +237,15 @@ errno_t ntrans_remove(addr128_t ip_addr)
  * @param mac_addr MAC address to be assigned
  *
  * @return EOK on success
- * @return ENOENT when no such address found
+ * @return ENOENT when no such address found or the entry expired
  *
  */
 errno_t ntrans_lookup(addr128_t ip_addr, addr48_t mac_addr)
 {
+	struct timeval now;
+
+	getuptime(&now);
+
 	fibril_mutex_lock(&ntrans_list_lock);
 	inet_ntrans_t *ntrans = ntrans_find(ip_addr);
 	if (ntrans == NULL) {
@@ -142,8 +253,15 @@ errno_t ntrans_lookup(addr128_t ip_addr, addr48_t mac_addr)
 		return ENOENT;
 	}
 
-	fibril_mutex_unlock(&ntrans_list_lock);
+	if (tv_gteq(&now, &ntrans->expires)) {
+		/* Stale entry, the address needs to be resolved again. */
+		ntrans_destroy(ntrans);
+		fibril_mutex_unlock(&ntrans_list_lock);
+		return ENOENT;
+	}
+
 	addr48(ntrans->mac_addr, mac_addr);
+	fibril_mutex_unlock(&ntrans_list_lock);
 	return EOK;
 }
 
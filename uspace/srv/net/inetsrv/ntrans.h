@@ -37,16 +37,24 @@
 #ifndef NTRANS_H_
 #define NTRANS_H_
 
+#include <adt/hash_table.h>
 #include <inet/iplink_srv.h>
 #include <inet/addr.h>
+#include <sys/time.h>
 
 /** Address translation table element */
 typedef struct {
+	/** Link to ntrans_list, ordered by time of last update */
 	link_t ntrans_list;
+	/** Link to ntrans_hash */
+	ht_link_t ntrans_hash;
 	addr128_t ip_addr;
 	addr48_t mac_addr;
+	/** Time when the entry expires */
+	struct timeval expires;
 } inet_ntrans_t;
 
+extern errno_t ntrans_init(void);
 extern errno_t ntrans_add(addr128_t, addr48_t);
 extern errno_t ntrans_remove(addr128_t);
 extern errno_t ntrans_lookup(addr128_t, addr48_t);
@@ -39,6 +39,7 @@
 #include <fibril_synch.h>
 #include <io/log.h>
 #include <ipc/loc.h>
+#include <nettl/rtrie.h>
 #include <stdlib.h>
 #include <str.h>
 #include "sroute.h"
@@ -49,6 +50,13 @@ static FIBRIL_MUTEX_INITIALIZE(sroute_list_lock);
 static LIST_INITIALIZE(sroute_list);
 static sysarg_t sroute_id = 0;
 
+/** Static routes indexed by destination network */
+static rtrie_t sroute_trie = {
+	.root4 = NULL,
+	.root6 = NULL,
+	.count = 0
+};
+
 inet_sroute_t *inet_sroute_new(void)
 {
 	inet_sroute_t *sroute = calloc(1, sizeof(inet_sroute_t));
@@ -60,6 +68,7 @@ inet_sroute_t *inet_sroute_new(void)
 	}
 
 	link_initialize(&sroute->sroute_list);
+	link_initialize(&sroute->sroute_trie);
 	fibril_mutex_lock(&sroute_list_lock);
 	sroute->id = ++sroute_id;
 	fibril_mutex_unlock(&sroute_list_lock);
@@ -74,57 +83,52 @@ void inet_sroute_delete(inet_sroute_t *sroute)
 	free(sroute);
 }
 
-void inet_sroute_add(inet_sroute_t *sroute)
+errno_t inet_sroute_add(inet_sroute_t *sroute)
 {
 	fibril_mutex_lock(&sroute_list_lock);
+
+	errno_t rc = rtrie_insert(&sroute_trie, &sroute->dest,
+	    &sroute->sroute_trie);
+	if (rc != EOK) {
+		fibril_mutex_unlock(&sroute_list_lock);
+		return rc;
+	}
+
 	list_append(&sroute->sroute_list, &sroute_list);
 	fibril_mutex_unlock(&sroute_list_lock);
+
+	return EOK;
 }
 
 void inet_sroute_remove(inet_sroute_t *sroute)
 {
 	fibril_mutex_lock(&sroute_list_lock);
+	rtrie_remove(&sroute_trie, &sroute->dest, &sroute->sroute_trie);
 	list_remove(&sroute->sroute_list);
 	fibril_mutex_unlock(&sroute_list_lock);
 }
 
 /** Find static route object matching address @a addr.
+ *
+ * Returns the route with the most specific destination network. Of several
+ * routes with the same destination, the one added first is returned.
  *
  * @param addr	Address
  */
 inet_sroute_t *inet_sroute_find(inet_addr_t *addr)
 {
-	ip_ver_t addr_ver = inet_addr_get(addr, NULL, NULL);
-
 	inet_sroute_t *best = NULL;
-	uint8_t best_bits = 0;
 
 	fibril_mutex_lock(&sroute_list_lock);
 
-	list_foreach(sroute_list, sroute_list, inet_sroute_t, sroute) {
-		uint8_t dest_bits;
-		ip_ver_t dest_ver = inet_naddr_get(&sroute->dest, NULL, NULL,
-		    &dest_bits);
-
-		/* Skip comparison with different address family */
-		if (addr_ver != dest_ver)
-			continue;
-
-		/* Look for the most specific route */
-		if ((best != NULL) && (best_bits >= dest_bits))
-			continue;
-
-		if (inet_naddr_compare_mask(&sroute->dest, addr)) {
-			log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found candidate %p",
-			    sroute);
-
-			best = sroute;
-			best_bits = dest_bits;
-		}
-	}
-
-	if (best == NULL)
+	link_t *link = rtrie_lookup(&sroute_trie, addr);
+	if (link != NULL) {
+		best = list_get_instance(link, inet_sroute_t, sroute_trie);
+		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: found %p",
+		    best);
+	} else {
 		log_msg(LOG_DEFAULT, LVL_DEBUG, "inet_sroute_find: Not found");
+	}
 
 	fibril_mutex_unlock(&sroute_list_lock);
 
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2026 HelenOS contributors
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * - Redistributions of source code must retain the above copyright
+ *   notice, this list of conditions and the following disclaimer.
+ * - Redistributions in binary form must reproduce the above copyright
+ *   notice, this list of conditions and the following disclaimer in the
+ *   documentation and/or other materials provided with the distribution.
+ * - The name of the author may not be used to endorse or promote products
+ *   derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE AUTHOR ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+ * OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT
+ * NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF
+ * THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * @file
+ * @brief IPC test service
+ *
+ * Peer for the IPC bulk transfer tests and benchmarks. Receives data either
+ * by IPC_M_DATA_WRITE or through a shared memory ring and keeps a checksum
+ * of everything it has received.
+ */
+
+#include <async.h>
+#include <errno.h>
+#include <str_error.h>
+#include <ipc/ipc_test.h>
+#include <ipc/services.h>
+#include <loc.h>
+#include <shmring.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <task.h>
+
+#define NAME  "ipc-test"
+
+/** Per-connection state */
+typedef struct {
+	/** Buffer for IPC_M_DATA_WRITE */
+	void *buf;
+	/** Shared memory ring or @c NULL */
+	shmring_t *ring;
+	/** Checksum of the received data */
+	uint64_t checksum;
+} ipc_test_conn_t;
+
+static uint64_t ipc_test_sum(const void *data, size_t size)
+{
+	const uint8_t *bp = (const uint8_t *) data;
+	uint64_t sum = 0;
+	size_t i;
+
+	for (i = 0; i < size; i++)
+		sum += bp[i];
+
+	return sum;
+}
+
+static void ipc_test_data_write(ipc_test_conn_t *conn, ipc_call_t *icall)
+{
+	ipc_call_t call;
+	size_t size;
+	errno_t rc;
+
+	if (!async_data_write_receive(&call, &size)) {
+		async_answer_0(&call, EREFUSED);
+		async_answer_0(icall, EREFUSED);
+		return;
+	}
+
+	if (size > DATA_XFER_LIMIT) {
+		async_answer_0(&call, ELIMIT);
+		async_answer_0(icall, ELIMIT);
+		return;
+	}
+
+	if (conn->buf == NULL) {
+		conn->buf = malloc(DATA_XFER_LIMIT);
+		if (conn->buf == NULL) {
+			async_answer_0(&call, ENOMEM);
+			async_answer_0(icall, ENOMEM);
+			return;
+		}
+	}
+
+	rc = async_data_write_finalize(&call, conn->buf, size);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	conn->checksum += ipc_test_sum(conn->buf, size);
+	async_answer_0(icall, EOK);
+}
+
+static void ipc_test_ring_setup(ipc_test_conn_t *conn, ipc_call_t *icall)
+{
+	shmring_t *ring;
+	errno_t rc;
+
+	rc = shmring_accept(&ring);
+	if (rc != EOK) {
+		async_answer_0(icall, rc);
+		return;
+	}
+
+	shmring_destroy(conn->ring);
+	conn->ring = ring;
+	async_answer_0(icall, EOK);
+}
+
+static void ipc_test_ring_notify(ipc_test_conn_t *conn, ipc_call_t *icall)
+{
+	void *data;
+	size_t size;
+	errno_t rc;
+
+	if (conn->ring == NULL) {
+		async_answer_0(icall, ENOENT);
+		return;
+	}
+
+	while ((rc = shmring_peek(conn->ring, &data, &size, NULL)) == EOK) {
+		conn->checksum += ipc_test_sum(data, size);
+		shmring_release(conn->ring);
+	}
+
+	async_answer_0(icall, rc == ENOENT ? EOK : rc);
+}
+
+static void ipc_test_connection(ipc_call_t *icall, void *arg)
+{
+	ipc_test_conn_t conn;
+
+	conn.buf = NULL;
+	conn.ring = NULL;
+	conn.checksum = 0;
+
+	/* Accept the connection */
+	async_answer_0(icall, EOK);
+
+	while (true) {
+		ipc_call_t call;
+		async_get_call(&call);
+		sysarg_t method = IPC_GET_IMETHOD(call);
+
+		if (!method) {
+			/* The other side has hung up */
+			async_answer_0(&call, EOK);
+			break;
+		}
+
+		switch (method) {
+		case IPC_TEST_DATA_WRITE:
+			ipc_test_data_write(&conn, &call);
+			break;
+		case IPC_TEST_RING_SETUP:
+			ipc_test_ring_setup(&conn, &call);
+			break;
+		case IPC_TEST_RING_NOTIFY:
+			ipc_test_ring_notify(&conn, &call);
+			break;
+		case IPC_TEST_GET_CHECKSUM:
+			async_answer_1(&call, EOK, (sysarg_t) conn.checksum);
+			conn.checksum = 0;
+			break;
+		default:
+			async_answer_0(&call, ENOTSUP);
+			break;
+		}
+	}
+
+	shmring_destroy(conn.ring);
+	free(conn.buf);
+}
+
+int main(int argc, char *argv[])
+{
+	service_id_t svc_id;
+	errno_t rc;
+
+	printf("%s: IPC test service\n", NAME);
+	async_set_fallback_port_handler(ipc_test_connection, NULL);
+
+	rc = loc_server_register(NAME);
+	if (rc != EOK) {
+		printf("%s: Failed registering server: %s\n", NAME,
+		    str_error(rc));
+		return rc;
+	}
+
+	rc = loc_service_register(SERVICE_NAME_IPC_TEST, &svc_id);
+	if (rc != EOK) {
+		printf("%s: Failed registering service: %s\n", NAME,
+		    str_error(rc));
+		return rc;
+	}
+
+	printf("%s: Accepting connections\n", NAME);
+	task_retval(0);
+	async_manager();
+
+	/* Not reached */
+	return 0;
+}
@@ -210,6 +210,7 @@ extern errno_t vfs_op_mtab_get(void);
 extern errno_t vfs_op_open(int fd, int flags);
 extern errno_t vfs_op_put(int fd);
 extern errno_t vfs_op_read(int fd, aoff64_t, size_t *out_bytes);
+extern errno_t vfs_op_readv(int fd, vfs_extent_t *, size_t, size_t *out_bytes);
 extern errno_t vfs_op_rename(int basefd, char *old, char *new);
 extern errno_t vfs_op_resize(int fd, int64_t size);
 extern errno_t vfs_op_stat(int fd);
@@ -220,6 +221,8 @@ extern errno_t vfs_op_unmount(int mpfd);
 extern errno_t vfs_op_wait_handle(bool high_fd, int *out_fd);
 extern errno_t vfs_op_walk(int parentfd, int flags, char *path, int *out_fd);
 extern errno_t vfs_op_write(int fd, aoff64_t, size_t *out_bytes);
+extern errno_t vfs_op_writev(int fd, vfs_extent_t *, size_t,
+    size_t *out_bytes);
 
 extern void vfs_register(ipc_call_t *);
 
@@ -183,6 +183,26 @@ static void vfs_in_read(ipc_call_t *req)
 	async_answer_1(req, rc, bytes);
 }
 
+static void vfs_in_readv(ipc_call_t *req)
+{
+	int fd = IPC_GET_ARG1(*req);
+	vfs_extent_t *ext;
+	size_t size;
+
+	errno_t rc = async_data_write_accept((void **) &ext, false,
+	    sizeof(vfs_extent_t), VFS_IOV_MAX * sizeof(vfs_extent_t),
+	    sizeof(vfs_extent_t), &size);
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		return;
+	}
+
+	size_t bytes = 0;
+	rc = vfs_op_readv(fd, ext, size / sizeof(vfs_extent_t), &bytes);
+	free(ext);
+	async_answer_1(req, rc, bytes);
+}
+
 static void vfs_in_rename(ipc_call_t *req)
 {
 	/* The common base directory. */
@@ -315,6 +335,26 @@ static void vfs_in_write(ipc_call_t *req)
 	async_answer_1(req, rc, bytes);
 }
 
+static void vfs_in_writev(ipc_call_t *req)
+{
+	int fd = IPC_GET_ARG1(*req);
+	vfs_extent_t *ext;
+	size_t size;
+
+	errno_t rc = async_data_write_accept((void **) &ext, false,
+	    sizeof(vfs_extent_t), VFS_IOV_MAX * sizeof(vfs_extent_t),
+	    sizeof(vfs_extent_t), &size);
+	if (rc != EOK) {
+		async_answer_0(req, rc);
+		return;
+	}
+
+	size_t bytes = 0;
+	rc = vfs_op_writev(fd, ext, size / sizeof(vfs_extent_t), &bytes);
+	free(ext);
+	async_answer_1(req, rc, bytes);
+}
+
 void vfs_connection(ipc_call_t *icall, void *arg)
 {
 	bool cont = true;
@@ -354,6 +394,9 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_IN_READ:
 			vfs_in_read(&call);
 			break;
+		case VFS_IN_READV:
+			vfs_in_readv(&call);
+			break;
 		case VFS_IN_REGISTER:
 			vfs_register(&call);
 			cont = false;
@@ -388,6 +431,9 @@ void vfs_connection(ipc_call_t *icall, void *arg)
 		case VFS_IN_WRITE:
 			vfs_in_write(&call);
 			break;
+		case VFS_IN_WRITEV:
+			vfs_in_writev(&call);
+			break;
 		default:
 			async_answer_0(&call, ENOTSUP);
 			break;
@@ -405,6 +405,114 @@ static errno_t rdwr_ipc_internal(async_exch_t *exch, vfs_file_t *file, aoff64_t
 	return (errno_t) rc;
 }
 
+typedef struct {
+	/** Extents to transfer */
+	vfs_extent_t *ext;
+	/** Number of extents */
+	size_t cnt;
+	/** Number of bytes transferred */
+	size_t bytes;
+} rdwr_vec_t;
+
+static errno_t rdwr_ipc_vec(async_exch_t *exch, vfs_file_t *file,
+    aoff64_t pos, ipc_call_t *answer, bool read, void *data)
+{
+	rdwr_vec_t *vec = (rdwr_vec_t *) data;
+	ipc_call_t call;
+	size_t total = 0;
+	size_t size;
+	errno_t rc;
+
+	vec->bytes = 0;
+
+	/*
+	 * Receive the client's IPC_M_DATA_READ/IPC_M_DATA_WRITE request for
+	 * the data of all extents. Unlike with VFS_READ/VFS_WRITE, it cannot
+	 * be forwarded as it must follow the extent table sent by ourselves.
+	 */
+	bool ok = read ? async_data_read_receive(&call, &size) :
+	    async_data_write_receive(&call, &size);
+	if (!ok) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	for (size_t i = 0; i < vec->cnt; i++) {
+		if (vec->ext[i].size > DATA_XFER_LIMIT) {
+			total = SIZE_MAX;
+			break;
+		}
+
+		total += vec->ext[i].size;
+	}
+
+	if (total != size || size == 0 || size > DATA_XFER_LIMIT ||
+	    file->node->type == VFS_NODE_DIRECTORY) {
+		async_answer_0(&call, EINVAL);
+		return EINVAL;
+	}
+
+	if (exch == NULL) {
+		async_answer_0(&call, ENOENT);
+		return ENOENT;
+	}
+
+	if (!read && file->append) {
+		/*
+		 * Just like with VFS_WRITE, the data is appended to the file
+		 * regardless of the requested positions.
+		 */
+		for (size_t i = 0; i < vec->cnt; i++) {
+			vec->ext[i].pos = pos;
+			pos += vec->ext[i].size;
+		}
+	}
+
+	void *buf = malloc(size);
+	if (buf == NULL) {
+		async_answer_0(&call, ENOMEM);
+		return ENOMEM;
+	}
+
+	if (!read) {
+		rc = async_data_write_finalize(&call, buf, size);
+		if (rc != EOK) {
+			free(buf);
+			return rc;
+		}
+	}
+
+	aid_t msg = async_send_2(exch, read ? VFS_OUT_READV : VFS_OUT_WRITEV,
+	    file->node->service_id, file->node->index, answer);
+
+	rc = async_data_write_start(exch, vec->ext,
+	    vec->cnt * sizeof(vfs_extent_t));
+	if (rc == EOK) {
+		if (read)
+			rc = async_data_read_start(exch, buf, size);
+		else
+			rc = async_data_write_start(exch, buf, size);
+	}
+
+	errno_t rc_orig;
+	async_wait_for(msg, &rc_orig);
+	if (rc_orig != EOK)
+		rc = rc_orig;
+
+	if (rc == EOK)
+		vec->bytes = min(IPC_GET_ARG1(*answer), size);
+
+	if (read) {
+		if (rc == EOK)
+			rc = async_data_read_finalize(&call, buf, vec->bytes);
+		else
+			async_answer_0(&call, rc);
+	}
+
+	free(buf);
+	return rc;
+}
+
 static errno_t vfs_rdwr(int fd, aoff64_t pos, bool read, rdwr_ipc_cb_t ipc_cb,
     void *ipc_cb_data)
 {
@@ -508,6 +616,18 @@ errno_t vfs_op_read(int fd, aoff64_t pos, size_t *out_bytes)
 	return vfs_rdwr(fd, pos, true, rdwr_ipc_client, out_bytes);
 }
 
+errno_t vfs_op_readv(int fd, vfs_extent_t *ext, size_t cnt, size_t *out_bytes)
+{
+	rdwr_vec_t vec = {
+		.ext = ext,
+		.cnt = cnt
+	};
+
+	errno_t rc = vfs_rdwr(fd, 0, true, rdwr_ipc_vec, &vec);
+	*out_bytes = vec.bytes;
+	return rc;
+}
+
 errno_t vfs_op_rename(int basefd, char *old, char *new)
 {
 	vfs_file_t *base_file = vfs_file_get(basefd);
@@ -915,6 +1035,19 @@ errno_t vfs_op_write(int fd, aoff64_t pos, size_t *out_bytes)
 	return vfs_rdwr(fd, pos, false, rdwr_ipc_client, out_bytes);
 }
 
+errno_t vfs_op_writev(int fd, vfs_extent_t *ext, size_t cnt,
+    size_t *out_bytes)
+{
+	rdwr_vec_t vec = {
+		.ext = ext,
+		.cnt = cnt
+	};
+
+	errno_t rc = vfs_rdwr(fd, 0, false, rdwr_ipc_vec, &vec);
+	*out_bytes = vec.bytes;
+	return rc;
+}
+
 /**
  * @}
  */